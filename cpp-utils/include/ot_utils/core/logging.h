@@ -22,6 +22,11 @@ void log_init(const char* app_name, logging_task_name_get task_getter);
 
 /**
  * Log message function. Not to be used directly. Use LOG macro.
+ *
+ * The message is recorded with its raw arguments and formatted later on a
+ * background thread, so the format must be a string literal. Strings passed
+ * for a %s are copied when the message is logged, and truncated if they are
+ * long.
  */
 void log_message(const char* format, ...);
 
@@ -0,0 +1,413 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Binary tracing with deferred formatting.
+ *
+ * Recording an event stores a tick, a pointer to its printf-style format
+ * string and its raw arguments in a ring, which costs a few stores. The
+ * format string pointer doubles as the event id, so format strings must be
+ * string literals (or otherwise live as long as the program). Strings
+ * passed for a %s are copied into the record, up to STRING_BYTES between
+ * them, so they only have to live until the event is recorded.
+ *
+ * Formatting into text happens later, wherever the ring is drained: a
+ * background thread on the host, or a debug dump on firmware.
+ *
+ * Each ring has one producer and one consumer and is lock-free between
+ * them, so give every thread or task its own ring.
+ * */
+namespace ot_utils {
+namespace trace {
+
+static constexpr size_t MAX_ARGS = 6;
+// Room in each record for the strings of its %s arguments, terminators
+// included. Strings that don't fit are truncated.
+static constexpr size_t STRING_BYTES = 48;
+// Stored in place of a string offset when a %s argument is null
+static constexpr uint64_t NULL_STRING = UINT64_MAX;
+
+struct Record {
+    // Monotonic timestamp, in whatever unit the producer's clock uses
+    uint64_t tick;
+    // The format string, which is also the event id
+    const char* format;
+    uint8_t arg_count;
+    // Integers are sign- or zero-extended, floats are stored as the bits
+    // of a double, pointers as their address and strings as their offset
+    // into strings
+    std::array<uint64_t, MAX_ARGS> args;
+    std::array<char, STRING_BYTES> strings;
+};
+
+/**
+ * Copy a string into the first free byte of a record's string storage,
+ * truncating it to whatever room is left. The last byte of the storage is
+ * never written with anything but a terminator, so a string that finds no
+ * room at all reads back as empty.
+ *
+ * @param used the bytes of storage already used, updated by the copy
+ * @return the argument to store for the string
+ */
+inline auto store_string(Record& record, size_t& used, const char* value)
+    -> uint64_t {
+    if (value == nullptr) {
+        return NULL_STRING;
+    }
+    auto offset = std::min(used, STRING_BYTES - 1);
+    size_t length = 0;
+    while (offset + length < STRING_BYTES - 1 && value[length] != '\0') {
+        record.strings[offset + length] = value[length];
+        ++length;
+    }
+    record.strings[offset + length] = '\0';
+    used = offset + length + 1;
+    return offset;
+}
+
+template <typename T>
+auto encode(T value) -> uint64_t {
+    if constexpr (std::is_floating_point_v<T>) {
+        auto as_double = static_cast<double>(value);
+        uint64_t bits = 0;
+        std::memcpy(&bits, &as_double, sizeof(bits));
+        return bits;
+    } else if constexpr (std::is_pointer_v<T>) {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+    } else if constexpr (std::is_enum_v<T>) {
+        return encode(static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_signed_v<T>) {
+        return static_cast<uint64_t>(static_cast<int64_t>(value));
+    } else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+/**
+ * Build a record from typed arguments, without looking at the format.
+ * Character pointers are always recorded as strings, so pass anything
+ * meant for a %p as a void pointer.
+ */
+template <typename... Args>
+auto make_record(uint64_t tick, const char* format, Args... args) -> Record {
+    static_assert(sizeof...(Args) <= MAX_ARGS, "Too many trace arguments");
+    auto ret = Record{.tick = tick,
+                      .format = format,
+                      .arg_count = static_cast<uint8_t>(sizeof...(Args)),
+                      .args{},
+                      .strings{}};
+    size_t next_arg = 0;
+    size_t used = 0;
+    auto add = [&ret, &next_arg, &used](auto value) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(value)>>;
+        if constexpr (std::is_pointer_v<decltype(value)> &&
+                      std::is_same_v<T, char>) {
+            ret.args[next_arg++] = store_string(ret, used, value);
+        } else {
+            ret.args[next_arg++] = encode(value);
+        }
+    };
+    (add(args), ...);
+    static_cast<void>(add);
+    return ret;
+}
+
+/**
+ * A single-producer, single-consumer ring of records. When it is full, new
+ * records are dropped and counted rather than blocking the producer.
+ */
+template <size_t Capacity>
+requires(Capacity > 1 && (Capacity & (Capacity - 1)) == 0) class Ring {
+  public:
+    Ring() = default;
+    Ring(const Ring&) = delete;
+    Ring(Ring&&) = delete;
+    auto operator=(const Ring&) -> Ring& = delete;
+    auto operator=(Ring&&) -> Ring& = delete;
+    ~Ring() = default;
+
+    /** Add a record. Only the producer may call this. */
+    auto push(const Record& record) -> bool {
+        auto head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Capacity) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _records[head & (Capacity - 1)] = record;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename... Args>
+    auto record(uint64_t tick, const char* format, Args... args) -> bool {
+        return push(make_record(tick, format, args...));
+    }
+
+    /** Take the oldest record. Only the consumer may call this. */
+    auto pop(Record& record) -> bool {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        record = _records[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** The number of records dropped because the ring was full. */
+    [[nodiscard]] auto dropped() const -> size_t {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<Record, Capacity> _records{};
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+    std::atomic<size_t> _dropped{0};
+};
+
+namespace detail {
+
+/** One printf conversion, parsed from just after its '%'. */
+struct Conversion {
+    const char* end;
+    char type;
+    // Size of the argument for integer conversions
+    size_t int_size;
+    bool star_width;
+    bool star_precision;
+};
+
+inline auto parse(const char* spec) -> Conversion {
+    auto ret = Conversion{.end = spec,
+                          .type = '\0',
+                          .int_size = sizeof(int),
+                          .star_width = false,
+                          .star_precision = false};
+    const char* c = spec;
+    while (*c != '\0' && std::strchr("-+ #0", *c) != nullptr) {
+        ++c;
+    }
+    if (*c == '*') {
+        ret.star_width = true;
+        ++c;
+    }
+    while (*c >= '0' && *c <= '9') {
+        ++c;
+    }
+    if (*c == '.') {
+        ++c;
+        if (*c == '*') {
+            ret.star_precision = true;
+            ++c;
+        }
+        while (*c >= '0' && *c <= '9') {
+            ++c;
+        }
+    }
+    if (c[0] == 'h' && c[1] == 'h') {
+        ret.int_size = sizeof(char);
+        c += 2;
+    } else if (c[0] == 'l' && c[1] == 'l') {
+        ret.int_size = sizeof(long long);
+        c += 2;
+    } else if (*c == 'h') {
+        ret.int_size = sizeof(short);
+        ++c;
+    } else if (*c == 'l') {
+        ret.int_size = sizeof(long);
+        ++c;
+    } else if (*c == 'z') {
+        ret.int_size = sizeof(size_t);
+        ++c;
+    } else if (*c == 'j') {
+        ret.int_size = sizeof(intmax_t);
+        ++c;
+    } else if (*c == 't') {
+        ret.int_size = sizeof(ptrdiff_t);
+        ++c;
+    } else if (*c == 'L') {
+        ++c;
+    }
+    ret.type = *c;
+    ret.end = (*c == '\0') ? c : c + 1;
+    return ret;
+}
+
+inline auto is_signed(char type) -> bool { return type == 'd' || type == 'i'; }
+
+inline auto is_unsigned(char type) -> bool {
+    return type == 'u' || type == 'o' || type == 'x' || type == 'X';
+}
+
+inline auto is_float(char type) -> bool {
+    return std::strchr("fFeEgGaA", type) != nullptr;
+}
+
+}  // namespace detail
+
+/**
+ * Build a record from a printf-style format and its variadic arguments,
+ * using the conversions in the format to find the type of each argument.
+ * Arguments past MAX_ARGS are not recorded.
+ */
+inline auto capture(uint64_t tick, const char* format, va_list args)
+    -> Record {
+    auto ret = Record{
+        .tick = tick, .format = format, .arg_count = 0, .args{}, .strings{}};
+    size_t used = 0;
+    auto add = [&ret](uint64_t value) {
+        if (ret.arg_count < MAX_ARGS) {
+            ret.args[ret.arg_count++] = value;
+        }
+    };
+    for (const char* c = format; *c != '\0'; ++c) {
+        if (*c != '%') {
+            continue;
+        }
+        if (c[1] == '%') {
+            ++c;
+            continue;
+        }
+        auto conv = detail::parse(c + 1);
+        if (conv.star_width) {
+            add(encode(va_arg(args, int)));
+        }
+        if (conv.star_precision) {
+            add(encode(va_arg(args, int)));
+        }
+        if (detail::is_signed(conv.type) || conv.type == 'c') {
+            add(conv.int_size > sizeof(int) ? encode(va_arg(args, long long))
+                                            : encode(va_arg(args, int)));
+        } else if (detail::is_unsigned(conv.type)) {
+            add(conv.int_size > sizeof(int)
+                    ? encode(va_arg(args, unsigned long long))
+                    : encode(va_arg(args, unsigned int)));
+        } else if (detail::is_float(conv.type)) {
+            add(encode(va_arg(args, double)));
+        } else if (conv.type == 's') {
+            const auto* value = va_arg(args, const char*);
+            if (ret.arg_count < MAX_ARGS) {
+                add(store_string(ret, used, value));
+            }
+        } else if (conv.type == 'p') {
+            add(encode(va_arg(args, const void*)));
+        }
+        c = conv.end - 1;
+    }
+    return ret;
+}
+
+/**
+ * Format a record into a buffer like snprintf would have when it was
+ * recorded. Always null-terminates when length is nonzero.
+ *
+ * @return the number of characters written, not counting the terminator
+ */
+inline auto format(const Record& record, char* buffer, size_t length)
+    -> size_t {
+    if (length == 0) {
+        return 0;
+    }
+    size_t written = 0;
+    size_t next_arg = 0;
+    auto next = [&record, &next_arg]() -> uint64_t {
+        return next_arg < record.arg_count ? record.args[next_arg++] : 0;
+    };
+    auto emit = [length, &written](int count) {
+        if (count > 0) {
+            written = std::min(written + static_cast<size_t>(count),
+                               length - 1);
+        }
+    };
+    for (const char* c = record.format; *c != '\0' && written < length - 1;
+         ++c) {
+        if (*c != '%') {
+            buffer[written++] = *c;
+            continue;
+        }
+        if (c[1] == '%') {
+            buffer[written++] = '%';
+            ++c;
+            continue;
+        }
+        auto conv = detail::parse(c + 1);
+        // Rebuild the conversion with star widths filled in and any length
+        // modifier replaced by one that matches the stored argument
+        std::array<char, 32> spec{};
+        size_t spec_length = 0;
+        auto put = [&spec, &spec_length](char ch) {
+            if (spec_length < spec.size() - 4) {
+                spec[spec_length++] = ch;
+            }
+        };
+        for (const char* s = c; s < conv.end - 1; ++s) {
+            if (*s == '*') {
+                std::array<char, 12> digits{};
+                std::snprintf(digits.data(), digits.size(), "%d",
+                              static_cast<int>(static_cast<int64_t>(next())));
+                for (const char* d = digits.data(); *d != '\0'; ++d) {
+                    put(*d);
+                }
+            } else if (std::strchr("hlzjtL", *s) == nullptr) {
+                put(*s);
+            }
+        }
+        auto* out = buffer + written;
+        auto left = length - written;
+        if (detail::is_signed(conv.type)) {
+            put('l');
+            put('l');
+            put(conv.type);
+            emit(std::snprintf(out, left, spec.data(),
+                               static_cast<long long>(next())));
+        } else if (detail::is_unsigned(conv.type)) {
+            auto value = next();
+            if (conv.int_size < sizeof(uint64_t)) {
+                value &= (uint64_t(1) << (conv.int_size * 8)) - 1;
+            }
+            put('l');
+            put('l');
+            put(conv.type);
+            emit(std::snprintf(out, left, spec.data(),
+                               static_cast<unsigned long long>(value)));
+        } else if (conv.type == 'c') {
+            put('c');
+            emit(std::snprintf(out, left, spec.data(),
+                               static_cast<int>(next())));
+        } else if (detail::is_float(conv.type)) {
+            auto bits = next();
+            double value = 0;
+            std::memcpy(&value, &bits, sizeof(value));
+            put(conv.type);
+            emit(std::snprintf(out, left, spec.data(), value));
+        } else if (conv.type == 's') {
+            auto offset = next();
+            const char* value = offset < STRING_BYTES
+                                    ? &record.strings[offset]
+                                    : "(null)";
+            put('s');
+            emit(std::snprintf(out, left, spec.data(), value));
+        } else if (conv.type == 'p') {
+            put('p');
+            emit(std::snprintf(
+                out, left, spec.data(),
+                reinterpret_cast<const void*>(static_cast<uintptr_t>(next()))));
+        }
+        c = conv.end - 1;
+    }
+    buffer[written] = '\0';
+    return written;
+}
+
+}  // namespace trace
+}  // namespace ot_utils
@@ -4,48 +4,193 @@
 
 #include <stdio.h>
 
+#include <array>
+#include <atomic>
 #include <boost/asio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
-#include "boost/date_time/posix_time/posix_time.hpp"
+#include "ot_utils/core/trace.hpp"
+
+/**
+ * Messages are not formatted where they are logged. Each thread records
+ * them into its own trace ring, and a drain thread formats and prints them,
+ * so logging from a task costs a handful of stores and never blocks on
+ * stdout.
+ *
+ * The drain sleeps until a message is logged. Only the first message after
+ * it wakes has to signal it; the rest are picked up in the same pass. At
+ * exit it prints whatever is left before the program ends.
+ */
+
+// Records per thread. A thread that logs faster than the drain keeps up
+// drops messages, and the drops are reported.
+static constexpr size_t LOG_RING_LENGTH = 256;
+
+using LogRing = ot_utils::trace::Ring<LOG_RING_LENGTH>;
+
+struct ThreadLog {
+    std::string task_name{};
+    LogRing ring{};
+    size_t dropped_reported{0};
+};
 
 struct FormatSpecs {
     std::string app_name{};
     logging_task_name_get task_name_getter{nullptr};
+    std::chrono::steady_clock::time_point start{
+        std::chrono::steady_clock::now()};
+    std::mutex lock{};
+    // Kept after their threads exit, so their last messages still print
+    std::vector<std::shared_ptr<ThreadLog>> logs{};
+    std::once_flag drain_started{};
+    // Set by the first message since the drain last woke
+    std::atomic_bool pending{false};
+    bool stopping{false};
+    std::mutex wake_lock{};
+    std::condition_variable wake{};
+    std::thread drain_thread{};
+
+    FormatSpecs() = default;
+    FormatSpecs(const FormatSpecs&) = delete;
+    FormatSpecs(FormatSpecs&&) = delete;
+    auto operator=(const FormatSpecs&) -> FormatSpecs& = delete;
+    auto operator=(FormatSpecs&&) -> FormatSpecs& = delete;
+    // Flush whatever is left to print before the rest of this goes away
+    ~FormatSpecs() {
+        if (!drain_thread.joinable()) {
+            return;
+        }
+        {
+            auto lock = std::lock_guard(wake_lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        drain_thread.join();
+    }
 };
 
 static auto format_specs = FormatSpecs{};
 
+static auto print(const ThreadLog& log, const ot_utils::trace::Record& record)
+    -> void {
+    std::array<char, 256> buff{};
+    ot_utils::trace::format(record, buff.data(), buff.size());
+    auto seconds = record.tick / 1000000;
+    auto micros = record.tick % 1000000;
+    printf("[%llu.%06llu] [%s] [%s] %s\n",
+           static_cast<unsigned long long>(seconds),
+           static_cast<unsigned long long>(micros),
+           format_specs.app_name.c_str(), log.task_name.c_str(),
+           buff.data());
+}
+
+static auto print_pending() -> void {
+    auto record = ot_utils::trace::Record{};
+    bool printed = false;
+    auto lock = std::lock_guard(format_specs.lock);
+    for (auto& log : format_specs.logs) {
+        while (log->ring.pop(record)) {
+            print(*log, record);
+            printed = true;
+        }
+        auto dropped = log->ring.dropped();
+        if (dropped != log->dropped_reported) {
+            printf("[%s] [%s] dropped %zu log messages\n",
+                   format_specs.app_name.c_str(), log->task_name.c_str(),
+                   dropped - log->dropped_reported);
+            log->dropped_reported = dropped;
+            printed = true;
+        }
+    }
+    if (printed) {
+        fflush(stdout);
+    }
+}
+
+static auto drain() -> void {
+    while (true) {
+        bool stopping = false;
+        {
+            auto lock = std::unique_lock(format_specs.wake_lock);
+            format_specs.wake.wait(lock, [] {
+                return format_specs.pending.load() || format_specs.stopping;
+            });
+            stopping = format_specs.stopping;
+        }
+        // Cleared before printing, so a message logged while this prints
+        // wakes the next pass
+        format_specs.pending.store(false);
+        print_pending();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+static auto start_drain() -> void {
+    std::call_once(format_specs.drain_started, [] {
+        // The drain thread inherits the blocked mask, so signals keep going
+        // to the application's own threads
+        auto sigblock = boost::asio::detail::posix_signal_blocker{};
+        format_specs.drain_thread = std::thread(drain);
+    });
+}
+
+static auto wake_drain() -> void {
+    if (!format_specs.pending.exchange(true)) {
+        // Taking the lock orders this with the drain checking whether to
+        // sleep, so the wakeup can't fall between the check and the wait
+        auto lock = std::lock_guard(format_specs.wake_lock);
+        format_specs.wake.notify_one();
+    }
+}
+
+static auto thread_log() -> ThreadLog& {
+    thread_local auto log = [] {
+        auto log = std::make_shared<ThreadLog>();
+        log->task_name = format_specs.task_name_getter
+                             ? format_specs.task_name_getter()
+                             : "none";
+        auto lock = std::lock_guard(format_specs.lock);
+        format_specs.logs.push_back(log);
+        return log;
+    }();
+    return *log;
+}
+
 /**
  * Initialize logging
  * @param app_name  Name of the application.
  * @param task_getter Callback to get the current task name.
  */
 void log_init(const char* app_name, logging_task_name_get task_getter) {
-    format_specs.app_name = app_name;
-    format_specs.task_name_getter = task_getter;
+    {
+        auto lock = std::lock_guard(format_specs.lock);
+        format_specs.app_name = app_name;
+        format_specs.task_name_getter = task_getter;
+    }
+    start_drain();
 }
 
 void log_message(const char* format, ...) {
+    auto& log = thread_log();
+    start_drain();
+
     va_list argp;
     va_start(argp, format);
-
-    char buff[256];
-
-    auto sigblock = boost::asio::detail::posix_signal_blocker{};
-    vsnprintf(buff, sizeof(buff), format, argp);
-
-    const char* task_name = format_specs.task_name_getter
-                                ? format_specs.task_name_getter()
-                                : "none";
-
-    using namespace boost::posix_time;
-
-    auto time = microsec_clock::local_time();
-
-    printf("[%s] [%s] [%s] %s\n", to_iso_extended_string(time).c_str(),
-           format_specs.app_name.c_str(), task_name, buff);
-
+    auto tick = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - format_specs.start)
+                    .count();
+    log.ring.push(
+        ot_utils::trace::capture(static_cast<uint64_t>(tick), format, argp));
     va_end(argp);
+    wake_drain();
 }
 
 #endif
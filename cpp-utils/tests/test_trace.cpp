@@ -0,0 +1,143 @@
+#include <cstdarg>
+#include <string>
+#include <thread>
+
+#include "catch2/catch.hpp"
+#include "ot_utils/core/trace.hpp"
+
+using namespace ot_utils::trace;
+
+static auto formatted(const Record& record) -> std::string {
+    std::array<char, 128> buff{};
+    auto length = format(record, buff.data(), buff.size());
+    return std::string(buff.data(), length);
+}
+
+static auto captured(const char* fmt, ...) -> Record {
+    va_list args;
+    va_start(args, fmt);
+    auto ret = capture(7, fmt, args);
+    va_end(args);
+    return ret;
+}
+
+SCENARIO("trace records format like printf") {
+    GIVEN("records built from typed arguments") {
+        THEN("integers, floats and strings format as they would have") {
+            REQUIRE(formatted(make_record(0, "plain")) == "plain");
+            REQUIRE(formatted(make_record(0, "%d and %u", -12, 34U)) ==
+                    "-12 and 34");
+            REQUIRE(formatted(make_record(0, "%5.2f|%-4d|", 3.14159, 7)) ==
+                    " 3.14|7   |");
+            REQUIRE(formatted(make_record(0, "%s=%x", "reg", 0xbeefU)) ==
+                    "reg=beef");
+            REQUIRE(formatted(make_record(0, "100%%")) == "100%");
+            REQUIRE(formatted(make_record(0, "%c%c", 'o', 'k')) == "ok");
+        }
+        THEN("negative values printed as unsigned keep their width") {
+            REQUIRE(formatted(make_record(0, "%x", -1)) == "ffffffff");
+            REQUIRE(formatted(make_record(0, "%hhx", -1)) == "ff");
+            REQUIRE(formatted(make_record(0, "%llx", int64_t(-1))) ==
+                    "ffffffffffffffff");
+        }
+    }
+    GIVEN("records captured from a va_list") {
+        THEN("each argument is read with the type its conversion implies") {
+            auto record =
+                captured("%s: %ld %lld %.1f %zu", "mixed", 5L, -6LL, 0.25,
+                         size_t(9));
+            REQUIRE(record.tick == 7);
+            REQUIRE(record.arg_count == 5);
+            REQUIRE(formatted(record) == "mixed: 5 -6 0.2 9");
+        }
+        THEN("star widths are recorded as arguments of their own") {
+            auto record = captured("[%*d|%.*f]", 4, 12, 2, 1.5);
+            REQUIRE(record.arg_count == 4);
+            REQUIRE(formatted(record) == "[  12|1.50]");
+        }
+        THEN("arguments past the limit are left out") {
+            auto record = captured("%d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7);
+            REQUIRE(record.arg_count == MAX_ARGS);
+            REQUIRE(formatted(record) == "1 2 3 4 5 6 0");
+        }
+    }
+    GIVEN("a string that changes after it is recorded") {
+        std::array<char, 16> name{"first"};
+        auto typed = make_record(0, "name %s", name.data());
+        auto record = captured("name %s", name.data());
+        std::snprintf(name.data(), name.size(), "second");
+        THEN("the record keeps the string as it was") {
+            REQUIRE(formatted(typed) == "name first");
+            REQUIRE(formatted(record) == "name first");
+        }
+    }
+    GIVEN("strings longer than a record holds") {
+        auto longer = std::string(STRING_BYTES * 2, 'a');
+        auto record = captured("%s|%s|%d", longer.c_str(), "b", 3);
+        THEN("the strings are truncated and the other arguments kept") {
+            REQUIRE(formatted(record) ==
+                    std::string(STRING_BYTES - 1, 'a') + "||3");
+        }
+    }
+    GIVEN("a null string") {
+        THEN("it formats as null") {
+            REQUIRE(formatted(captured("[%s]", static_cast<char*>(nullptr))) ==
+                    "[(null)]");
+        }
+    }
+    GIVEN("a buffer too short for the message") {
+        auto record = make_record(0, "value %d", 123456);
+        std::array<char, 10> buff{};
+        THEN("the message is truncated and terminated") {
+            REQUIRE(format(record, buff.data(), buff.size()) == 9);
+            REQUIRE(std::string(buff.data()) == "value 123");
+        }
+    }
+}
+
+SCENARIO("trace ring") {
+    GIVEN("an empty ring") {
+        auto ring = Ring<4>{};
+        auto record = Record{};
+        THEN("nothing can be popped") { REQUIRE(!ring.pop(record)); }
+        WHEN("more records are pushed than fit") {
+            for (int i = 0; i < 6; ++i) {
+                static_cast<void>(ring.record(i, "%d", i));
+            }
+            THEN("the newest ones are dropped and counted") {
+                REQUIRE(ring.dropped() == 2);
+                for (uint64_t i = 0; i < 4; ++i) {
+                    REQUIRE(ring.pop(record));
+                    REQUIRE(record.tick == i);
+                }
+                REQUIRE(!ring.pop(record));
+            }
+        }
+    }
+    GIVEN("a producer and a consumer on different threads") {
+        auto ring = Ring<16>{};
+        static constexpr uint64_t COUNT = 10000;
+        WHEN("the producer records every tick") {
+            auto producer = std::thread([&ring] {
+                for (uint64_t i = 0; i < COUNT; ++i) {
+                    while (!ring.record(i, "%llu", i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            uint64_t expected = 0;
+            auto record = Record{};
+            while (expected < COUNT) {
+                if (ring.pop(record)) {
+                    REQUIRE(record.tick == expected);
+                    REQUIRE(record.args[0] == expected);
+                    ++expected;
+                }
+            }
+            producer.join();
+            THEN("the consumer sees every record in order") {
+                REQUIRE(expected == COUNT);
+            }
+        }
+    }
+}
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+Script to report how the static RAM of a firmware image is split between
+its subsystems.
+
+The script reads the map file written by the linker and adds up every input
+section that was placed in .data or .bss. Sections are grouped by the
+subsystem they came from: the source directory of an object file built for
+the firmware itself (system, host_comms_task, thermal...), or the name of
+the library an archive member came from. The largest single sections are
+listed after the totals, since those are usually the task stacks and
+queues that are worth right-sizing.
+"""
+import argparse
+import re
+import sys
+from collections import defaultdict
+from pathlib import Path
+from typing import Dict, Iterator, List, NamedTuple, TextIO
+
+# The output sections that hold static RAM
+RAM_SECTIONS = ('.data', '.bss')
+
+# An input section with its name, address, size and source on one line
+_FULL_LINE = re.compile(
+    r'^ (?P<name>\S+)\s+0x(?P<addr>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)'
+    r'\s+(?P<source>\S.*)$')
+# An input section name that was too long, so the rest is on the next line
+_NAME_LINE = re.compile(r'^ (?P<name>[.\w$]\S*)$')
+# The address, size and source of an input section named on the line before
+_REST_LINE = re.compile(
+    r'^\s+0x(?P<addr>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)'
+    r'\s+(?P<source>\S.*)$')
+# The start of an output section
+_OUTPUT_LINE = re.compile(r'^(?P<name>\.\S+)(\s+0x[0-9a-fA-F]+)?')
+# An archive member, libfoo.a(bar.o)
+_ARCHIVE = re.compile(r'(?P<archive>[^/\\]+)\.a\((?P<member>[^)]+)\)$')
+# An object file built for a CMake target, target.dir/subdir/file.obj
+_TARGET_OBJECT = re.compile(r'\.dir/(?P<path>.+)$')
+
+
+class InputSection(NamedTuple):
+    """One input section that the linker placed in an output section."""
+    output: str
+    name: str
+    address: int
+    size: int
+    source: str
+
+
+def parse_map(map_file: TextIO) -> Iterator[InputSection]:
+    """
+    Yield every input section in the memory map part of a GNU ld map file.
+
+    Args:
+        map_file: The open map file
+    """
+    in_memory_map = False
+    output = None
+    pending_name = None
+    for line in map_file:
+        line = line.rstrip('\n')
+        if not in_memory_map:
+            in_memory_map = line.startswith('Linker script and memory map')
+            continue
+        if pending_name:
+            rest = _REST_LINE.match(line)
+            name, pending_name = pending_name, None
+            if rest:
+                yield InputSection(output, name, int(rest['addr'], 16),
+                                   int(rest['size'], 16),
+                                   rest['source'].strip())
+                continue
+        if not line.startswith(' '):
+            out = _OUTPUT_LINE.match(line)
+            output = out['name'] if out else None
+            continue
+        if output is None or line.startswith(' *'):
+            # Fill and linker script patterns aren't code or data
+            continue
+        full = _FULL_LINE.match(line)
+        if full:
+            yield InputSection(output, full['name'], int(full['addr'], 16),
+                               int(full['size'], 16), full['source'].strip())
+            continue
+        named = _NAME_LINE.match(line)
+        if named:
+            pending_name = named['name']
+
+
+def subsystem_of(source: str) -> str:
+    """
+    Name the subsystem that an input section came from.
+
+    Args:
+        source: The object file or archive member named in the map
+    """
+    archive = _ARCHIVE.search(source)
+    if archive:
+        name = archive['archive']
+        return name[3:] if name.startswith('lib') else name
+    target_object = _TARGET_OBJECT.search(source)
+    if target_object:
+        parts = Path(target_object['path']).parts
+        return parts[0] if len(parts) > 1 else 'main'
+    return Path(source).stem
+
+
+def ram_by_subsystem(sections: List[InputSection]) -> Dict[str, Dict[str, int]]:
+    """
+    Add up the sizes of static RAM input sections by subsystem.
+
+    Args:
+        sections: Input sections from parse_map
+    """
+    totals: Dict[str, Dict[str, int]] = defaultdict(
+        lambda: {section: 0 for section in RAM_SECTIONS})
+    for section in sections:
+        if section.output in RAM_SECTIONS:
+            totals[subsystem_of(section.source)][section.output] += \
+                section.size
+    return totals
+
+
+def write_report(sections: List[InputSection], out: TextIO,
+                 largest: int) -> None:
+    """
+    Write the static RAM of each subsystem, then the largest sections.
+
+    Args:
+        sections: Input sections from parse_map
+        out: Where to write the report
+        largest: How many of the largest sections to list
+    """
+    totals = ram_by_subsystem(sections)
+    width = max([len('Subsystem')] + [len(name) for name in totals])
+    out.write(f'{"Subsystem":<{width}} {".data":>8} {".bss":>8} {"total":>8}\n')
+    by_size = sorted(totals.items(), key=lambda item: -sum(item[1].values()))
+    for name, sizes in by_size:
+        out.write(f'{name:<{width}} {sizes[".data"]:>8} {sizes[".bss"]:>8} '
+                  f'{sum(sizes.values()):>8}\n')
+    all_data = sum(sizes['.data'] for sizes in totals.values())
+    all_bss = sum(sizes['.bss'] for sizes in totals.values())
+    out.write(f'{"total":<{width}} {all_data:>8} {all_bss:>8} '
+              f'{all_data + all_bss:>8}\n')
+
+    ram = [section for section in sections if section.output in RAM_SECTIONS]
+    ram.sort(key=lambda section: -section.size)
+    out.write(f'\nLargest {largest} sections\n')
+    for section in ram[:largest]:
+        out.write(f'{section.size:>8} {subsystem_of(section.source):<{width}} '
+                  f'{section.name}\n')
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(
+        description='Report the static RAM of each subsystem of a firmware')
+    parser.add_argument('map', type=Path, help='Map file written by the linker')
+    parser.add_argument('output', type=Path, nargs='?',
+                        help='Where to write the report (default stdout)')
+    parser.add_argument('--largest', type=int, default=20,
+                        help='How many of the largest sections to list')
+    args = parser.parse_args()
+
+    with open(args.map, 'r') as map_file:
+        sections = list(parse_map(map_file))
+    if args.output:
+        with open(args.output, 'w') as out:
+            write_report(sections, out, args.largest)
+    else:
+        write_report(sections, sys.stdout, args.largest)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""
+Script to report how the flash and RAM of a firmware image are split
+between the namespaces of its code.
+
+Every sized symbol in the ELF is listed with the cross nm and counted as
+text (code and read-only data), data or bss by its symbol type, the same
+split that GNU size makes. Each symbol is charged to the outermost C++
+namespace it was declared in. Symbols outside of any namespace - the C
+drivers, FreeRTOS, newlib and anonymous namespaces - are charged to the
+library or firmware directory they were linked from, which is found from
+the input section that holds them in the linker map. The map also gives
+the memory regions of the image, so the totals for FLASH and RAM are
+reported next to the length of each region.
+"""
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+from collections import defaultdict
+from pathlib import Path
+from typing import Dict, Iterator, List, NamedTuple, Optional, TextIO
+
+from ram_usage import InputSection, parse_map, subsystem_of
+
+# The kinds of memory that a symbol can use
+KINDS = ('text', 'data', 'bss')
+# The nm symbol types that make up each kind
+_KIND_OF_TYPE = {
+    **{t: 'text' for t in 'TtWwRr'},
+    **{t: 'data' for t in 'DdVvGg'},
+    **{t: 'bss' for t in 'BbSs'},
+}
+# Prefixes that nm puts on the special symbols that belong to a class
+_SPECIAL_PREFIXES = (
+    'vtable for ', 'construction vtable for ', 'VTT for ',
+    'typeinfo for ', 'typeinfo name for ', 'guard variable for ',
+    'non-virtual thunk to ', 'virtual thunk to ',
+    'covariant return thunk to ')
+_ANONYMOUS = '(anonymous namespace)'
+
+# A sized symbol from nm --print-size
+_NM_LINE = re.compile(
+    r'^(?P<addr>[0-9a-fA-F]+) (?P<size>[0-9a-fA-F]+) (?P<type>\w) '
+    r'(?P<name>.+)$')
+# A memory region from the memory configuration of the map
+_REGION_LINE = re.compile(
+    r'^(?P<name>\w+)\s+0x(?P<origin>[0-9a-fA-F]+)\s+0x(?P<length>[0-9a-fA-F]+)')
+# An output section, with its address and size if they fit on the line
+_OUTPUT_LINE = re.compile(
+    r'^(?P<name>\.\S+)(\s+0x(?P<addr>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)'
+    r'(\s+load address 0x(?P<load>[0-9a-fA-F]+))?)?\s*$')
+# The address and size of an output section named on the line before
+_OUTPUT_REST_LINE = re.compile(
+    r'^\s+0x(?P<addr>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)'
+    r'(\s+load address 0x(?P<load>[0-9a-fA-F]+))?\s*$')
+
+
+class Symbol(NamedTuple):
+    """One sized symbol in the ELF."""
+    name: str
+    address: int
+    size: int
+    kind: str
+
+
+class Region(NamedTuple):
+    """One memory region from the MEMORY command of the linker script."""
+    name: str
+    origin: int
+    length: int
+
+    def holds(self, address: int) -> bool:
+        return self.origin <= address < self.origin + self.length
+
+
+class OutputSection(NamedTuple):
+    """One output section of the image."""
+    name: str
+    address: int
+    size: int
+    # Where the section is stored, if it is copied somewhere else at startup
+    load_address: Optional[int]
+
+
+def read_symbols(nm: str, elf: Path) -> Iterator[Symbol]:
+    """
+    Yield every sized symbol of an ELF that takes up flash or RAM.
+
+    Args:
+        nm: The nm to run, which has to understand the ELF
+        elf: The linked firmware
+    """
+    listing = subprocess.run(
+        [nm, '--print-size', '--demangle', '--defined-only', str(elf)],
+        check=True, capture_output=True, text=True).stdout
+    for line in listing.splitlines():
+        symbol = _NM_LINE.match(line)
+        if not symbol or symbol['type'] not in _KIND_OF_TYPE:
+            continue
+        size = int(symbol['size'], 16)
+        if size:
+            yield Symbol(symbol['name'], int(symbol['addr'], 16), size,
+                         _KIND_OF_TYPE[symbol['type']])
+
+
+def read_layout(map_file: TextIO):
+    """
+    Read the memory regions and output sections from a GNU ld map file.
+
+    Args:
+        map_file: The open map file
+
+    Returns:
+        The regions and the output sections that take up space in them
+    """
+    regions: List[Region] = []
+    sections: List[OutputSection] = []
+    in_memory_config = False
+    in_memory_map = False
+    pending_name = None
+    for line in map_file:
+        line = line.rstrip('\n')
+        if line.startswith('Memory Configuration'):
+            in_memory_config = True
+            continue
+        if line.startswith('Linker script and memory map'):
+            in_memory_config, in_memory_map = False, True
+            continue
+        if in_memory_config:
+            region = _REGION_LINE.match(line)
+            if region and region['name'] != 'Name':
+                regions.append(Region(region['name'],
+                                      int(region['origin'], 16),
+                                      int(region['length'], 16)))
+            continue
+        if not in_memory_map:
+            continue
+        if pending_name:
+            rest = _OUTPUT_REST_LINE.match(line)
+            name, pending_name = pending_name, None
+            if rest:
+                sections.append(_output_section(name, rest))
+                continue
+        output = _OUTPUT_LINE.match(line)
+        if not output:
+            continue
+        if output['addr'] is None:
+            pending_name = output['name']
+        else:
+            sections.append(_output_section(output['name'], output))
+    return regions, [section for section in sections if section.size]
+
+
+def _output_section(name: str, match: re.Match) -> OutputSection:
+    load = match['load']
+    return OutputSection(name, int(match['addr'], 16), int(match['size'], 16),
+                         int(load, 16) if load else None)
+
+
+def region_usage(regions: List[Region],
+                 sections: List[OutputSection]) -> Dict[str, int]:
+    """
+    Add up the space that the output sections take in each region. A section
+    that is copied out of flash at startup counts against both regions.
+
+    Args:
+        regions: The memory regions of the image
+        sections: The output sections of the image
+    """
+    used = {region.name: 0 for region in regions}
+    for section in sections:
+        for address in (section.address, section.load_address):
+            if address is None:
+                continue
+            for region in regions:
+                if region.holds(address):
+                    used[region.name] += section.size
+                    break
+    return used
+
+
+def namespace_of(symbol: str) -> Optional[str]:
+    """
+    Find the outermost namespace of a demangled symbol, if it has one.
+
+    Args:
+        symbol: The demangled name of the symbol
+    """
+    stripped = True
+    while stripped:
+        stripped = False
+        for prefix in _SPECIAL_PREFIXES:
+            if symbol.startswith(prefix):
+                symbol = symbol[len(prefix):]
+                stripped = True
+    if symbol.startswith(_ANONYMOUS):
+        return None
+    depth = 0
+    start = 0
+    for index, char in enumerate(symbol):
+        if char in '<(':
+            depth += 1
+        elif char in '>)':
+            depth -= 1
+        elif depth == 0 and char == ' ':
+            # Whatever came before was the return type of a template
+            start = index + 1
+        elif depth == 0 and symbol.startswith('::', index):
+            namespace = symbol[start:index]
+            # A static local of a function outside any namespace
+            if not namespace or '(' in namespace:
+                return None
+            return namespace
+    return None
+
+
+class SourceIndex:
+    """Finds the input section of the map that holds an address."""
+
+    def __init__(self, sections: List[InputSection]):
+        self._sections = sorted(
+            (section for section in sections if section.size),
+            key=lambda section: section.address)
+        self._starts = [section.address for section in self._sections]
+
+    def subsystem_at(self, address: int) -> Optional[str]:
+        index = bisect.bisect_right(self._starts, address) - 1
+        if index < 0:
+            return None
+        section = self._sections[index]
+        if address >= section.address + section.size:
+            return None
+        return subsystem_of(section.source)
+
+
+def group_of(symbol: Symbol, sources: SourceIndex) -> str:
+    """
+    Name the group that a symbol is charged to: its namespace, or the
+    subsystem it was linked from in brackets.
+    """
+    namespace = namespace_of(symbol.name)
+    if namespace:
+        return namespace
+    return f'[{sources.subsystem_at(symbol.address) or "unknown"}]'
+
+
+def usage_by_group(symbols: List[Symbol],
+                   sources: SourceIndex) -> Dict[str, Dict[str, int]]:
+    """
+    Add up the sizes of the symbols in each group.
+
+    Args:
+        symbols: The sized symbols of the image
+        sources: Where each address was linked from
+    """
+    totals: Dict[str, Dict[str, int]] = defaultdict(
+        lambda: {kind: 0 for kind in KINDS})
+    for symbol in symbols:
+        totals[group_of(symbol, sources)][symbol.kind] += symbol.size
+    return totals
+
+
+def write_report(regions: List[Region], used: Dict[str, int],
+                 groups: Dict[str, Dict[str, int]], out: TextIO) -> None:
+    """Write the usage of each region and group."""
+    out.write(f'{"Region":<10} {"used":>8} {"length":>8}\n')
+    for region in regions:
+        out.write(f'{region.name:<10} {used[region.name]:>8} '
+                  f'{region.length:>8}\n')
+
+    width = max([len('Group')] + [len(name) for name in groups])
+    out.write(f'\n{"Group":<{width}} {"text":>8} {"data":>8} {"bss":>8}\n')
+    by_size = sorted(groups.items(), key=lambda item: -sum(item[1].values()))
+    for name, sizes in by_size:
+        out.write(f'{name:<{width}} {sizes["text"]:>8} {sizes["data"]:>8} '
+                  f'{sizes["bss"]:>8}\n')
+    out.write(f'{"total":<{width}} ' + ' '.join(
+        f'{sum(sizes[kind] for sizes in groups.values()):>8}'
+        for kind in KINDS) + '\n')
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(
+        description='Report the flash and RAM of each namespace of a '
+                    'firmware')
+    parser.add_argument('elf', type=Path, help='The linked firmware')
+    parser.add_argument('map', type=Path, help='Map file written by the linker')
+    parser.add_argument('--nm', default='nm',
+                        help='The nm to list the symbols of the firmware with')
+    parser.add_argument('--report', type=Path,
+                        help='Where to write the report (default stdout)')
+    args = parser.parse_args()
+
+    with open(args.map, 'r') as map_file:
+        regions, output_sections = read_layout(map_file)
+    with open(args.map, 'r') as map_file:
+        sources = SourceIndex(list(parse_map(map_file)))
+    used = region_usage(regions, output_sections)
+    groups = usage_by_group(list(read_symbols(args.nm, args.elf)), sources)
+
+    if args.report:
+        with open(args.report, 'w') as out:
+            write_report(regions, used, groups, out)
+    else:
+        write_report(regions, used, groups, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
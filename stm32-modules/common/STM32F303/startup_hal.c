@@ -59,3 +59,26 @@ bool startup_lock_pages(uint32_t start_page, uint32_t page_count) {
     // If we were succesful, we shouldn't return at all
     return false;
 }
+
+bool startup_dma_init(DMA_HandleTypeDef *dma) {
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    dma->Instance = DMA1_Channel1;
+    dma->Init.Direction = DMA_MEMORY_TO_MEMORY;
+    // In memory-to-memory mode the "peripheral" is the source
+    dma->Init.PeriphInc = DMA_PINC_ENABLE;
+    dma->Init.MemInc = DMA_MINC_DISABLE;
+    dma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    dma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    dma->Init.Mode = DMA_NORMAL;
+    dma->Init.Priority = DMA_PRIORITY_LOW;
+    return HAL_DMA_Init(dma) == HAL_OK;
+}
+
+void startup_dma_deinit() {
+    // The F303 has no reset for its DMA controller, so just clear the
+    // channel used here
+    DMA1_Channel1->CCR = 0;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    __HAL_RCC_DMA1_CLK_DISABLE();
+}
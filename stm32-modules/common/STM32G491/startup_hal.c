@@ -66,3 +66,27 @@ bool startup_lock_pages(uint32_t start_page, uint32_t page_count) {
     // If we were succesful, we shouldn't return at all
     return false;
 }
+
+bool startup_dma_init(DMA_HandleTypeDef *dma) {
+    __HAL_RCC_DMAMUX1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    dma->Instance = DMA1_Channel1;
+    dma->Init.Request = DMA_REQUEST_MEM2MEM;
+    dma->Init.Direction = DMA_MEMORY_TO_MEMORY;
+    // In memory-to-memory mode the "peripheral" is the source
+    dma->Init.PeriphInc = DMA_PINC_ENABLE;
+    dma->Init.MemInc = DMA_MINC_DISABLE;
+    dma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    dma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    dma->Init.Mode = DMA_NORMAL;
+    dma->Init.Priority = DMA_PRIORITY_LOW;
+    return HAL_DMA_Init(dma) == HAL_OK;
+}
+
+void startup_dma_deinit() {
+    __HAL_RCC_DMA1_FORCE_RESET();
+    __HAL_RCC_DMA1_RELEASE_RESET();
+    __HAL_RCC_DMA1_CLK_DISABLE();
+    __HAL_RCC_DMAMUX1_CLK_DISABLE();
+}
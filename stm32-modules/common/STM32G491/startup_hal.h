@@ -33,4 +33,10 @@ bool startup_erase_flash_pages(uint32_t start_page, uint32_t page_count);
 // Each target has a different method to lock pages
 bool startup_lock_pages(uint32_t start_page, uint32_t page_count);
 
+// Set up a DMA channel to copy words from flash to a fixed address
+bool startup_dma_init(DMA_HandleTypeDef *dma);
+
+// Reset the DMA channels before leaving the startup app
+void startup_dma_deinit();
+
 #endif /* STARTUP_HAL_H_ */
@@ -0,0 +1,45 @@
+/**
+ * @file allocation_counter.cpp
+ * @brief Replacement global operator new and delete that count every heap
+ * allocation, for the benchmarks to report.
+ */
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark/gcode_benchmark.hpp"
+
+namespace {
+std::atomic<uint64_t> allocation_count{0};
+
+auto counted_allocate(std::size_t size) -> void* {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+}  // namespace
+
+auto gcode_benchmark::allocations() -> uint64_t {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+auto operator new(std::size_t size) -> void* { return counted_allocate(size); }
+
+auto operator new[](std::size_t size) -> void* {
+    return counted_allocate(size);
+}
+
+auto operator delete(void* memory) noexcept -> void { std::free(memory); }
+
+auto operator delete[](void* memory) noexcept -> void { std::free(memory); }
+
+auto operator delete(void* memory, std::size_t) noexcept -> void {
+    std::free(memory);
+}
+
+auto operator delete[](void* memory, std::size_t) noexcept -> void {
+    std::free(memory);
+}
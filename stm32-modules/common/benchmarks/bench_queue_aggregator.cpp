@@ -0,0 +1,176 @@
+/**
+ * @file bench_queue_aggregator.cpp
+ * @brief Measures the cost of sending through a QueueAggregator.
+ *
+ * @details Two things are measured:
+ * - Sending to a runtime address with the table of send thunks, compared
+ *   with the recursion through every index that it replaced.
+ * - Sending several messages under one lock with send_batch, compared with
+ *   taking the lock around each message.
+ *
+ * The queues only count what they are sent, so that the time measured is
+ * the time spent finding the queue rather than the time spent queueing.
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "core/queue_aggregator.hpp"
+
+namespace {
+
+constexpr int SENDS = 10'000'000;
+constexpr int BATCHES = 2'000'000;
+
+// Every queue can hold a Ping, so it can be sent to any address
+struct Ping {
+    uint32_t value = 0;
+};
+
+// Only the queue with the same index can hold one of these
+template <size_t Idx>
+struct Only {
+    uint32_t value = 0;
+};
+
+template <size_t Idx>
+class CountingQueue {
+  public:
+    using Message = std::variant<Ping, Only<Idx>>;
+    struct Tag {};
+
+    [[nodiscard]] auto try_send(const Message& message,
+                                uint32_t /*timeout*/ = 0) -> bool {
+        _last = message;
+        ++_sent;
+        return true;
+    }
+    auto recv(Message* message) -> void { *message = _last; }
+    [[nodiscard]] auto try_recv(Message* message, uint32_t /*timeout*/ = 0)
+        -> bool {
+        *message = _last;
+        return true;
+    }
+    [[nodiscard]] auto has_message() const -> bool { return _sent > 0; }
+    [[nodiscard]] auto sent() const -> uint64_t { return _sent; }
+
+  private:
+    Message _last{};
+    uint64_t _sent = 0;
+};
+
+using Aggregator = queue_aggregator::QueueAggregator<
+    CountingQueue<0>, CountingQueue<1>, CountingQueue<2>, CountingQueue<3>,
+    CountingQueue<4>, CountingQueue<5>, CountingQueue<6>, CountingQueue<7>>;
+
+/**
+ * The runtime address resolution that the send table replaced: compare the
+ * address against each index in turn, from the last one down.
+ */
+template <size_t N>
+struct RecursiveSend {
+    static auto send(Aggregator& aggregator, const Ping& msg, size_t idx)
+        -> bool {
+        if (N - 1 == idx) {
+            return aggregator.send(msg, 0,
+                                   typename CountingQueue<N - 1>::Tag());
+        }
+        return RecursiveSend<N - 1>::send(aggregator, msg, idx);
+    }
+};
+
+template <>
+struct RecursiveSend<0> {
+    static auto send(Aggregator& /*unused*/, const Ping& /*unused*/,
+                     size_t /*unused*/) -> bool {
+        return false;
+    }
+};
+
+class MutexLock {
+  public:
+    auto acquire() -> void { _mutex.lock(); }
+    auto release() -> void { _mutex.unlock(); }
+
+  private:
+    std::mutex _mutex{};
+};
+
+template <typename Function>
+auto nanoseconds_per(int count, Function&& function) -> double {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        function(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / count;
+}
+
+}  // namespace
+
+auto main() -> int {
+    auto queues = std::make_tuple(
+        CountingQueue<0>(), CountingQueue<1>(), CountingQueue<2>(),
+        CountingQueue<3>(), CountingQueue<4>(), CountingQueue<5>(),
+        CountingQueue<6>(), CountingQueue<7>());
+    auto aggregator = std::apply(
+        [](auto&... queue) { return Aggregator(queue...); }, queues);
+
+    // Send to addresses in an order the branch predictor can't learn
+    auto random = std::mt19937(1);
+    auto addresses = std::vector<size_t>(1024);
+    for (auto& address : addresses) {
+        address = random() % Aggregator::TaskCount;
+    }
+    auto address_at = [&](int i) { return addresses[i % addresses.size()]; };
+
+    printf("Queue aggregator with %zu queues\n", Aggregator::TaskCount);
+    printf("%-28s %10s\n", "operation", "ns/op");
+
+    auto recursive = nanoseconds_per(SENDS, [&](int i) {
+        static_cast<void>(RecursiveSend<Aggregator::TaskCount>::send(
+            aggregator, Ping{static_cast<uint32_t>(i)}, address_at(i)));
+    });
+    printf("%-28s %10.2f\n", "send to address (recursive)", recursive);
+    auto table = nanoseconds_per(SENDS, [&](int i) {
+        static_cast<void>(aggregator.send_to_address(
+            Ping{static_cast<uint32_t>(i)}, address_at(i)));
+    });
+    printf("%-28s %10.2f\n", "send to address (table)", table);
+
+    auto lock = MutexLock();
+    auto locked_each = nanoseconds_per(BATCHES, [&](int i) {
+        auto value = static_cast<uint32_t>(i);
+        lock.acquire();
+        static_cast<void>(aggregator.send(Only<0>{value}));
+        lock.release();
+        lock.acquire();
+        static_cast<void>(aggregator.send(Only<3>{value}));
+        lock.release();
+        lock.acquire();
+        static_cast<void>(aggregator.send(Only<5>{value}));
+        lock.release();
+        lock.acquire();
+        static_cast<void>(aggregator.send(Only<7>{value}));
+        lock.release();
+    });
+    printf("%-28s %10.2f\n", "4 sends, lock each", locked_each);
+    auto batched = nanoseconds_per(BATCHES, [&](int i) {
+        auto value = static_cast<uint32_t>(i);
+        static_cast<void>(aggregator.send_batch(lock, Only<0>{value},
+                                                Only<3>{value}, Only<5>{value},
+                                                Only<7>{value}));
+    });
+    printf("%-28s %10.2f\n", "4 sends, send_batch", batched);
+
+    uint64_t sent = 0;
+    std::apply([&](auto&... queue) { ((sent += queue.sent()), ...); },
+               queues);
+    printf("(%llu messages sent)\n", static_cast<unsigned long long>(sent));
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file bench_simulator_queue.cpp
+ * @brief Compares the condition variable based SimulatorMessageQueue with
+ * the polling queue it replaced.
+ *
+ * @details Two things are measured for each queue:
+ * - The round trip latency of a message bounced between two threads, the
+ *   way a gcode bounces between the comms task and the task that handles it.
+ * - The CPU time used by a set of threads that sit waiting for messages that
+ *   never arrive, the way most simulator tasks spend most of their time.
+ */
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <boost/lockfree/queue.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "hal/message_queue.hpp"
+#include "simulator/simulator_queue.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+/**
+ * The simulator queue as it was before it blocked on condition variables:
+ * a lock free queue that waiting threads poll once a millisecond.
+ */
+template <typename M, size_t queue_size = 8>
+class PollingMessageQueue {
+  public:
+    using clock = std::chrono::steady_clock;
+    using Message = M;
+    using QueueType =
+        boost::lockfree::queue<Message, boost::lockfree::capacity<queue_size>>;
+    class StopDuringMsgWait : public std::exception {};
+    PollingMessageQueue() : queue(), mythread_stop_token() {}
+
+    auto set_stop_token(std::stop_token st) { mythread_stop_token = st; }
+
+    [[nodiscard]] auto try_send(const Message& message,
+                                const uint32_t timeout_ticks = 0) -> bool {
+        auto at_start = clock::now();
+        while (true) {
+            if (queue.push(message)) {
+                return true;
+            }
+            if ((clock::now() - at_start) >
+                std::chrono::milliseconds(timeout_ticks)) {
+                return false;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    [[nodiscard]] auto try_recv(Message* message, uint32_t timeout_ticks = 0)
+        -> bool {
+        auto at_start = clock::now();
+        while (true) {
+            if (queue.pop(*message)) {
+                return true;
+            }
+            if ((clock::now() - at_start) >
+                std::chrono::milliseconds(timeout_ticks)) {
+                return false;
+            }
+            if (mythread_stop_token.stop_requested()) {
+                throw StopDuringMsgWait();
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    auto recv(Message* message) -> void {
+        static_cast<void>(
+            try_recv(message, std::numeric_limits<uint32_t>::max()));
+    }
+
+    [[nodiscard]] auto has_message() const -> bool { return !queue.empty(); }
+
+  private:
+    QueueType queue;
+    std::stop_token mythread_stop_token;
+};
+
+static_assert(MessageQueue<PollingMessageQueue<int>, int>);
+static_assert(MessageQueue<SimulatorMessageQueue<int>, int>);
+
+constexpr int ROUND_TRIPS = 2000;
+constexpr int IDLE_THREADS = 8;
+constexpr auto IDLE_PERIOD = 1s;
+constexpr int STOP_MESSAGE = -1;
+
+struct RoundTripResult {
+    double mean_us;
+    double p50_us;
+    double p99_us;
+};
+
+template <template <typename, size_t> typename Queue>
+auto measure_round_trip() -> RoundTripResult {
+    auto to_echo = Queue<int, 8>();
+    auto from_echo = Queue<int, 8>();
+    auto echo = std::jthread([&]() {
+        int message = 0;
+        while (true) {
+            to_echo.recv(&message);
+            if (message == STOP_MESSAGE) {
+                return;
+            }
+            static_cast<void>(from_echo.try_send(message, 1000));
+        }
+    });
+    auto latencies = std::vector<double>();
+    latencies.reserve(ROUND_TRIPS);
+    int reply = 0;
+    for (int i = 0; i < ROUND_TRIPS; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        static_cast<void>(to_echo.try_send(i, 1000));
+        from_echo.recv(&reply);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        latencies.push_back(
+            std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+    static_cast<void>(to_echo.try_send(STOP_MESSAGE, 1000));
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (auto latency : latencies) {
+        total += latency;
+    }
+    return RoundTripResult{
+        .mean_us = total / static_cast<double>(latencies.size()),
+        .p50_us = latencies[latencies.size() / 2],
+        .p99_us = latencies[(latencies.size() * 99) / 100]};
+}
+
+auto process_cpu_seconds() -> double {
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    auto to_seconds = [](const timeval& time) {
+        return static_cast<double>(time.tv_sec) +
+               static_cast<double>(time.tv_usec) / 1e6;
+    };
+    return to_seconds(usage.ru_utime) + to_seconds(usage.ru_stime);
+}
+
+/** @return The CPU used by the idle threads, as a percentage of one core*/
+template <template <typename, size_t> typename Queue>
+auto measure_idle_cpu() -> double {
+    auto queues = std::vector<Queue<int, 8>>(IDLE_THREADS);
+    auto threads = std::vector<std::jthread>();
+    auto cpu_start = process_cpu_seconds();
+    auto wall_start = std::chrono::steady_clock::now();
+    for (auto& queue : queues) {
+        threads.emplace_back([&queue](std::stop_token st) {
+            queue.set_stop_token(st);
+            int message = 0;
+            try {
+                queue.recv(&message);
+            } catch (const typename Queue<int, 8>::StopDuringMsgWait&) {
+                return;
+            }
+        });
+    }
+    std::this_thread::sleep_for(IDLE_PERIOD);
+    for (auto& thread : threads) {
+        thread.request_stop();
+    }
+    threads.clear();
+    auto wall = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - wall_start)
+                    .count();
+    return 100.0 * (process_cpu_seconds() - cpu_start) / wall;
+}
+
+template <template <typename, size_t> typename Queue>
+auto report(const char* name) -> void {
+    auto round_trip = measure_round_trip<Queue>();
+    auto idle_cpu = measure_idle_cpu<Queue>();
+    printf("%-10s %10.1f %10.1f %10.1f %16.2f\n", name, round_trip.mean_us,
+           round_trip.p50_us, round_trip.p99_us, idle_cpu);
+}
+
+}  // namespace
+
+auto main() -> int {
+    printf("Simulator queue: %d round trips, %d threads idle for %lld ms\n",
+           ROUND_TRIPS, IDLE_THREADS,
+           static_cast<long long>(
+               std::chrono::milliseconds(IDLE_PERIOD).count()));
+    printf("%-10s %10s %10s %10s %16s\n", "queue", "mean (us)", "p50 (us)",
+           "p99 (us)", "idle CPU (%core)");
+    report<PollingMessageQueue>("polling");
+    report<SimulatorMessageQueue>("condvar");
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "startup_boot.h"
+
+#include "startup_checks.h"
+#include "startup_memory.h"
+
+bool boot_check_slot(APP_SLOT_ENUM slot) {
+    // The vector table and the name are quick to check, so a marked slot
+    // only skips the CRC
+    if(check_app_exists(slot) && 
+       check_name(slot) && 
+       check_verified_marker(slot)) {
+        return true;
+    }
+    if(!check_slot(slot)) {
+        return false;
+    }
+    // If the marker can't be written, the slot gets every check next time
+    (void)memory_mark_verified(slot);
+    return true;
+}
+
+bool boot_backup_matches_main() {
+    if(check_verified_marker(APP_SLOT_MAIN) && 
+       check_verified_marker(APP_SLOT_BACKUP)) {
+        return check_integrity_regions_match();
+    }
+    return check_backup_matches_main();
+}
+
+bool boot_prepare_application() {
+    bool ok_to_start_app = true;
+
+    bool main_app_exists = boot_check_slot(APP_SLOT_MAIN);
+    bool backup_app_exists = boot_check_slot(APP_SLOT_BACKUP);
+
+    if(backup_app_exists && check_update_requested()) {
+        // The app staged a new image in the backup slot. The request is only
+        // cleared once the image is installed, so if the copy is interrupted
+        // it gets retried on the next boot.
+        bool installed = main_app_exists && boot_backup_matches_main();
+        if(installed || memory_copy_backup_to_main()) {
+            (void)memory_clear_update_request();
+        }
+        main_app_exists = boot_check_slot(APP_SLOT_MAIN);
+    }
+    
+    if(!main_app_exists && backup_app_exists) {
+        // No main app but backup app = try to recover with backup app
+        (void)memory_copy_backup_to_main();
+        if(!boot_check_slot(APP_SLOT_MAIN)) {
+            // We failed to recover, jump to bootloader
+            ok_to_start_app = false;
+        }
+    }
+    else if(!main_app_exists) {
+        // In this case, we don't have any backup app
+        ok_to_start_app = false;
+    } else {
+        // We have a main app, tbd backup
+        if(!backup_app_exists || !boot_backup_matches_main()) {
+            // Try to update the backup. If this fails we boot to the main app
+            // anyways.
+            (void)memory_copy_main_to_backup();
+        }
+    }
+
+    return ok_to_start_app;
+}
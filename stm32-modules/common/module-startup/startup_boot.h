@@ -0,0 +1,37 @@
+/**
+ * @file startup_boot.h
+ * @brief Decides what to boot. This only uses the functions in
+ * startup_checks.h and startup_memory.h, and nothing from the HAL, so it
+ * can be tested on the host.
+ */
+
+#ifndef STARTUP_BOOT_H_
+#define STARTUP_BOOT_H_
+
+#include <stdbool.h>
+
+#include "startup_checks.h"
+
+/**
+ * Checks a slot, trusting its verified marker if it has one. Otherwise
+ * runs every check, and marks the slot if it passes.
+ */
+bool boot_check_slot(APP_SLOT_ENUM slot);
+
+/**
+ * Checks if the main app and the backup slot are identical. Two marked
+ * slots are compared by their integrity regions alone. This check assumes
+ * that both regions have had their integrity verified.
+ */
+bool boot_backup_matches_main();
+
+/**
+ * Checks both slots, installs a requested update, and recovers the main
+ * app from the backup slot or refreshes the backup slot as needed.
+ *
+ * @return true if the main app can be started, false to go to the
+ * bootloader instead
+ */
+bool boot_prepare_application();
+
+#endif /* STARTUP_BOOT_H_ */
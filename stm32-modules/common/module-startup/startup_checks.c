@@ -16,6 +16,9 @@
 
 #define APPLICATION_FOOTER_TOTAL_LENGTH (0x400)
 
+// The most words one DMA transfer can move
+#define DMA_MAX_TRANSFER (0xFFFF)
+
 // Take the start address and filter out to just the page
 #define APPLICATION_VTABLE_START(address) (address & 0xFFFFF800)
 // Application integrity region starts 0x200 from vtable
@@ -33,7 +36,9 @@
 
 typedef struct {
     bool init;
+    bool dma_ready;
     CRC_HandleTypeDef crc;
+    DMA_HandleTypeDef dma;
 } CheckHardware_t;
 
 typedef struct __packed {
@@ -45,7 +50,9 @@ typedef struct __packed {
 
 static CheckHardware_t check_hardware = {
     .init = false,
-    .crc = {0}
+    .dma_ready = false,
+    .crc = {0},
+    .dma = {0}
 };
 
 static const char application_firmware_name[] __attribute__((used))  
@@ -56,6 +63,7 @@ static const char application_firmware_name[] __attribute__((used))
 static void init_hardware();
 static void init_crc();
 static uint32_t calculate_crc(uint32_t start, uint32_t count);
+static bool calculate_crc_dma(uint32_t start, uint32_t count, uint32_t *crc);
 
 /** PUBLIC FUNCTION IMPLEMENTATIONS */
 
@@ -144,14 +152,58 @@ bool check_backup_matches_main() {
     // Get the byte count from the main region
     const IntegrityRegion_t  *const main_integrity_region = 
         (IntegrityRegion_t *)APPLICATION_INTEGRITY_REGION(start_main);
+    const uint32_t after_marker = 
+        VERIFIED_MARKER_OFFSET + VERIFIED_MARKER_LENGTH;
 
+    // Each slot has its own verified marker, so it isn't compared
     return memcmp(
         (void *)start_main,
         (void *)start_backup,
+        VERIFIED_MARKER_OFFSET) == 0 &&
+        memcmp(
+        (void *)(start_main + after_marker),
+        (void *)(start_backup + after_marker),
         main_integrity_region->app_length + APPLICATION_FOOTER_TOTAL_LENGTH
+            - after_marker
         ) == 0;
 }
 
+bool check_integrity_regions_match() {
+    const IntegrityRegion_t  *const main_integrity_region = 
+        (IntegrityRegion_t *)APPLICATION_INTEGRITY_REGION(
+            slot_start_address(APP_SLOT_MAIN));
+    const IntegrityRegion_t  *const backup_integrity_region = 
+        (IntegrityRegion_t *)APPLICATION_INTEGRITY_REGION(
+            slot_start_address(APP_SLOT_BACKUP));
+
+    return main_integrity_region->crc == backup_integrity_region->crc &&
+           main_integrity_region->app_length == 
+                backup_integrity_region->app_length;
+}
+
+uint32_t verified_marker_address(APP_SLOT_ENUM slot) {
+    return slot_start_address(slot) + VERIFIED_MARKER_OFFSET;
+}
+
+uint64_t verified_marker(APP_SLOT_ENUM slot) {
+    const IntegrityRegion_t  *const integrity_region = 
+        (IntegrityRegion_t *)APPLICATION_INTEGRITY_REGION(slot_start_address(slot));
+    return ((uint64_t)VERIFIED_MARKER_KEY << 32) | integrity_region->crc;
+}
+
+bool check_verified_marker(APP_SLOT_ENUM slot) {
+    return *(uint64_t*)verified_marker_address(slot) == verified_marker(slot);
+}
+
+uint32_t update_request_flag_address() {
+    return slot_start_address(APP_SLOT_BACKUP) + APPLICATION_MAX_SIZE -
+            UPDATE_REQUEST_FLAG_LENGTH;
+}
+
+bool check_update_requested() {
+    return *(uint64_t*)update_request_flag_address() == UPDATE_REQUEST_FLAG;
+}
+
 /** STATIC FUNCTION IMPLEMENTATIONS */
 
 static void init_hardware() {
@@ -160,6 +212,7 @@ static void init_hardware() {
     }
 
     init_crc();
+    check_hardware.dma_ready = startup_dma_init(&check_hardware.dma);
 
     check_hardware.init = true;
 }
@@ -178,13 +231,63 @@ static void init_crc() {
 static uint32_t calculate_crc(uint32_t start, uint32_t count) {
     init_hardware();
 
-    __HAL_CRC_DR_RESET(&check_hardware.crc);
+    uint32_t crc = 0;
+    if(!check_hardware.dma_ready || 
+       !calculate_crc_dma(start, count, &crc)) {
+        // Feed the peripheral from the CPU instead
+        __HAL_CRC_DR_RESET(&check_hardware.crc);
+        crc = HAL_CRC_Calculate(
+            &check_hardware.crc, 
+            (uint32_t *)start,
+            count);
+    }
     // We return the INVERTED calculated checksum in order to match
     // standard crc32 calculations
-    return ~HAL_CRC_Calculate(
-        &check_hardware.crc, 
-        (uint32_t *)start,
-        count);
+    return ~crc;
+}
+
+static bool calculate_crc_dma(uint32_t start, uint32_t count, uint32_t *crc) {
+    const uint32_t words = count / sizeof(uint32_t);
+    bool ok = true;
+
+    __HAL_CRC_DR_RESET(&check_hardware.crc);
+    // The DMA writes whole little-endian words, so reversing the bits of
+    // the whole word feeds the bytes in the same order as the byte-wise
+    // input that the HAL uses
+    (void) HAL_CRCEx_Input_Data_Reverse(
+        &check_hardware.crc, CRC_INPUTDATA_INVERSION_WORD);
+    for(uint32_t done = 0; ok && done < words; ) {
+        uint32_t transfer = words - done;
+        if(transfer > DMA_MAX_TRANSFER) {
+            transfer = DMA_MAX_TRANSFER;
+        }
+        ok = HAL_DMA_Start(
+                &check_hardware.dma,
+                start + (done * sizeof(uint32_t)),
+                (uint32_t)&check_hardware.crc.Instance->DR,
+                transfer) == HAL_OK &&
+             HAL_DMA_PollForTransfer(
+                &check_hardware.dma, 
+                HAL_DMA_FULL_TRANSFER, 
+                HAL_MAX_DELAY) == HAL_OK;
+        done += transfer;
+    }
+    __HAL_DMA_DISABLE(&check_hardware.dma);
+
+    // The last few bytes are fed in one at a time, which is also the mode
+    // the CPU path expects
+    (void) HAL_CRCEx_Input_Data_Reverse(
+        &check_hardware.crc, CRC_INPUTDATA_INVERSION_BYTE);
+    for(uint32_t i = words * sizeof(uint32_t); ok && i < count; ++i) {
+        *(__IO uint8_t *)(__IO void *)(&check_hardware.crc.Instance->DR) = 
+            *(uint8_t *)(start + i);
+    }
+    if(!ok) {
+        check_hardware.dma_ready = false;
+        return false;
+    }
+    *crc = check_hardware.crc.Instance->DR;
+    return true;
 }
 
 /** OVERWRITTEN HAL FUNCTIONS */
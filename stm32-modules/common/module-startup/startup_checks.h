@@ -9,6 +9,29 @@ typedef enum {
     APP_SLOT_BACKUP = 1,
 } APP_SLOT_ENUM;
 
+/**
+ * The application sets this in the last doubleword of the backup slot once
+ * it has written and verified a new image there. Must match
+ * UPDATE_REQUEST_FLAG in core/firmware_update.hpp.
+ */
+#define UPDATE_REQUEST_FLAG (0x5152455441445055ULL)
+#define UPDATE_REQUEST_FLAG_LENGTH (8)
+
+/**
+ * The startup app marks a slot once it has passed every check, in the last
+ * doubleword before the application. Anything that writes a slot starts by
+ * erasing its first page, which clears the marker, so a marked slot hasn't
+ * changed since it was checked. The marker holds the CRC from the slot's
+ * integrity region under the key "VRFD" in ASCII.
+ *
+ * Only memory_mark_verified may program this doubleword; every other
+ * writer leaves it erased. Must match VERIFIED_MARKER_OFFSET in
+ * core/firmware_update.hpp.
+ */
+#define VERIFIED_MARKER_OFFSET (0x3F8)
+#define VERIFIED_MARKER_LENGTH (8)
+#define VERIFIED_MARKER_KEY (0x44465256UL)
+
 /** Get the starting address of a slot */
 uint32_t slot_start_address(APP_SLOT_ENUM slot);
 
@@ -37,9 +60,36 @@ bool check_crc(APP_SLOT_ENUM slot);
 bool check_name(APP_SLOT_ENUM slot);
 
 /**
- * Checks if the main app and the backup slot are identical. This check
- * assumes that both regions have had their integrity verified.
+ * Checks if the main app and the backup slot are identical, apart from their
+ * verified markers. This check assumes that both regions have had their
+ * integrity verified.
  */
 bool check_backup_matches_main();
 
+/**
+ * Checks if the main app and the backup slot have the same CRC and length
+ * in their integrity regions.
+ */
+bool check_integrity_regions_match();
+
+/** Get the address of the verified marker of a slot */
+uint32_t verified_marker_address(APP_SLOT_ENUM slot);
+
+/** The verified marker for the image currently in a slot */
+uint64_t verified_marker(APP_SLOT_ENUM slot);
+
+/**
+ * Checks if a slot was marked as verified, and hasn't been written since.
+ */
+bool check_verified_marker(APP_SLOT_ENUM slot);
+
+/** Get the address of the update request flag */
+uint32_t update_request_flag_address();
+
+/**
+ * Checks if the application has requested that the image in the backup
+ * slot be installed over the main app.
+ */
+bool check_update_requested();
+
 #endif /* STARTUP_CHECKS_H_ */
@@ -16,6 +16,7 @@ static void __inline disable_all(void) {
     HAL_RCC_DeInit();
 
     __HAL_RCC_CRC_CLK_DISABLE();
+    startup_dma_deinit();
 
     // systick should be off at boot
     SysTick->CTRL = 0;
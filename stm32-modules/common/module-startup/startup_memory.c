@@ -4,6 +4,8 @@
 #include "startup_checks.h"
 #include "startup_hal.h"
 
+#define ERASED_DOUBLEWORD (0xFFFFFFFFFFFFFFFFULL)
+
 /** STATIC FUNCTION DECLARATIONS */
 
 /**
@@ -40,7 +42,8 @@ bool memory_copy_backup_to_main() {
     return memory_copy_image(
         slot_start_address(APP_SLOT_BACKUP),
         slot_start_address(APP_SLOT_MAIN),
-        APPLICATION_MAX_SIZE);
+        // The update request flag at the end of the slot is never copied
+        APPLICATION_MAX_SIZE - UPDATE_REQUEST_FLAG_LENGTH);
 }
 
 bool memory_copy_main_to_backup() {
@@ -51,7 +54,41 @@ bool memory_copy_main_to_backup() {
     return memory_copy_image(
         slot_start_address(APP_SLOT_MAIN),
         slot_start_address(APP_SLOT_BACKUP),
-        APPLICATION_MAX_SIZE);
+        // The update request flag at the end of the slot is never copied
+        APPLICATION_MAX_SIZE - UPDATE_REQUEST_FLAG_LENGTH);
+}
+
+bool memory_clear_update_request() {
+    startup_flash_init();
+    HAL_FLASH_Unlock();
+    // A programmed doubleword can always be overwritten with zeroes, so
+    // there's no need to erase the page.
+    HAL_StatusTypeDef ret = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD,
+        update_request_flag_address(), 0);
+    HAL_FLASH_Lock();
+
+    return ret == HAL_OK;
+}
+
+bool memory_mark_verified(APP_SLOT_ENUM slot) {
+    const uint32_t address = verified_marker_address(slot);
+    // This relies on nothing but this function ever programming the marker
+    // doubleword, since one that was programmed with all ones reads the same
+    // as an erased one and programming it again is an ECC fault. DFU and
+    // debuggers only program the image's sections, which leave the gap
+    // before the application alone; the updater rejects images with data
+    // here and, like memory_copy_image, skips erased doublewords. An image
+    // that still has data here just never gets marked.
+    if(*(uint64_t *)address != ERASED_DOUBLEWORD) {
+        return false;
+    }
+    startup_flash_init();
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef ret = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD,
+        address, verified_marker(slot));
+    HAL_FLASH_Lock();
+
+    return ret == HAL_OK;
 }
 
 /** STATIC FUNCTION IMPLEMENTATIONS */
@@ -70,12 +107,19 @@ static bool erase_app(APP_SLOT_ENUM slot) {
 static bool memory_copy_image(uint32_t src, uint32_t dst, uint32_t bytes) {
     HAL_FLASH_Unlock();
 
-    HAL_StatusTypeDef ret = HAL_ERROR;
+    HAL_StatusTypeDef ret = HAL_OK;
     // All platforms support programming by doubleword, so we do that here.
     for(uint32_t offset = 0; offset < bytes; offset += 8) {
+        const uint64_t value = *(uint64_t *)(src + offset);
+        // The destination was just erased, so erased doublewords (most of
+        // a slot, past the end of the image) don't need programming. The
+        // verified marker stays clear, so the copy gets a full check.
+        if(value == ERASED_DOUBLEWORD || offset == VERIFIED_MARKER_OFFSET) {
+            continue;
+        }
         ret = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, 
             dst + offset, 
-            *(uint64_t *)(src + offset));
+            value);
 
         if(ret != HAL_OK) {
             break;
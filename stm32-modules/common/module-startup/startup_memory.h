@@ -4,11 +4,17 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "startup_checks.h"
+
 /** Lock the startup app (this application) */
 bool memory_lock_startup_region();
 /** Overwrite the main section with the backup */
 bool memory_copy_backup_to_main();
 /** Overwrite the backup with the main section */
 bool memory_copy_main_to_backup();
+/** Clear the update request flag in the backup section */
+bool memory_clear_update_request();
+/** Mark a slot as verified, if its marker is still erased */
+bool memory_mark_verified(APP_SLOT_ENUM slot);
 
 #endif /* STARTUP_MEMORY_H_ */
@@ -19,6 +19,10 @@ PID::PID(double kp, double ki, double kd, double sampletime,
       _last_iterm(0),
       _reset_threshold(0) {}
 
+auto PID::gains() const -> PIDGains {
+    return PIDGains{.kp = _kp, .ki = _ki, .kd = _kd};
+}
+
 auto PID::kp() const -> double { return _kp; }
 
 auto PID::ki() const -> double { return _ki; }
@@ -63,6 +67,16 @@ auto PID::reset() -> void {
     _reset_trigger = NONE;
 }
 
+auto PID::set_gains(const PIDGains& gains) -> void {
+    // The integral term already has ki folded in, so only the proportional
+    // term changes the output for the same error
+    _last_iterm = std::clamp(_last_iterm + ((_kp - gains.kp) * _last_error),
+                             _windup_limit_low, _windup_limit_high);
+    _kp = gains.kp;
+    _ki = gains.ki;
+    _kd = gains.kd;
+}
+
 auto PID::arm_integrator_reset(double error, double threshold) -> void {
     if (error <= 0) {
         _reset_trigger = RISING;
@@ -106,3 +106,54 @@ TEST_CASE("AT24C0XC class functionality") {
         }
     }
 }
+
+TEST_CASE("AT24C0XC multi-page writes") {
+    using namespace at24c0xc;
+    constexpr const size_t pages = 32;
+    constexpr const uint8_t address = 0b1010100;
+    GIVEN("a 32-page AT24C0xC that takes a few polls to finish each page") {
+        auto policy = TestAT24C0XCPolicy<pages>();
+        policy._busy_polls = 3;
+        auto eeprom = AT24C0xC<pages, address>();
+        std::array<uint8_t, 20> data{};
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<uint8_t>(i + 1);
+        }
+        WHEN("writing 20 bytes from page 2") {
+            REQUIRE(eeprom.write_pages(2, data.begin(), data.size(), policy));
+            THEN("the bytes span three pages") {
+                for (size_t i = 0; i < data.size(); ++i) {
+                    REQUIRE(policy._buffer[2 * PAGE_LENGTH + i] == data[i]);
+                }
+                REQUIRE(policy._buffer[2 * PAGE_LENGTH + data.size()] == 0);
+            }
+            THEN("write protection is back on") {
+                REQUIRE(policy._write_protect);
+            }
+            AND_WHEN("reading them back") {
+                std::array<uint8_t, 20> readback{};
+                REQUIRE(eeprom.read_bytes(2, readback.begin(),
+                                          readback.size(), policy));
+                THEN("they are read in one transaction") {
+                    REQUIRE(readback == data);
+                    REQUIRE(policy._reads == 1);
+                }
+            }
+        }
+        WHEN("the device never finishes a page") {
+            policy._busy_polls = WRITE_POLL_ATTEMPTS + 1;
+            THEN("the write fails") {
+                REQUIRE(!eeprom.write_pages(2, data.begin(), data.size(),
+                                            policy));
+                REQUIRE(policy._write_protect);
+            }
+        }
+        WHEN("writing past the last page") {
+            THEN("nothing is written") {
+                REQUIRE(!eeprom.write_pages(30, data.begin(), data.size(),
+                                            policy));
+                REQUIRE(policy._buffer[30 * PAGE_LENGTH] == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#include <array>
+#include <string_view>
+
+#include "catch2/catch.hpp"
+#include "core/crc32.hpp"
+
+SCENARIO("crc32 matches the standard check values") {
+    GIVEN("the standard check string") {
+        auto input = std::string_view("123456789");
+        THEN("the crc is the standard check value") {
+            REQUIRE(crc32::compute(input.begin(), input.end()) == 0xCBF43926);
+        }
+        THEN("computing it in pieces gives the same result") {
+            auto crc = crc32::update(crc32::INITIAL_VALUE, input.begin(),
+                                     input.begin() + 4);
+            crc = crc32::update(crc, input.begin() + 4, input.end());
+            REQUIRE(crc32::finalize(crc) == 0xCBF43926);
+        }
+    }
+    GIVEN("no input") {
+        auto input = std::array<uint8_t, 0>();
+        THEN("the crc is zero") {
+            REQUIRE(crc32::compute(input.begin(), input.end()) == 0);
+        }
+    }
+}
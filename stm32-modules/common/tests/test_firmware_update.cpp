@@ -0,0 +1,231 @@
+#include <string_view>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "core/crc32.hpp"
+#include "core/firmware_update.hpp"
+#include "test/test_backup_flash_policy.hpp"
+
+using namespace firmware_update;
+using backup_flash_test_policy::TestBackupFlashPolicy;
+
+static_assert(BackupFlashPolicy<TestBackupFlashPolicy>);
+
+// VERIFIED_MARKER_KEY in startup_checks.h
+static constexpr uint64_t VERIFIED_MARKER_KEY = 0x44465256;
+
+// Send every chunk of an image, returning the first result that isn't OK
+static auto stream(Updater& updater, const std::vector<uint8_t>& image,
+                   TestBackupFlashPolicy& policy) -> Result {
+    for (size_t offset = 0; offset < image.size();
+         offset += MAX_CHUNK_LENGTH) {
+        auto chunk = Chunk{};
+        auto length = std::min(MAX_CHUNK_LENGTH, image.size() - offset);
+        std::copy_n(image.begin() + offset, length, chunk.begin());
+        auto crc = crc32::compute(chunk.begin(), chunk.begin() + length);
+        auto result = updater.write(offset, chunk, length, crc, policy);
+        if (result != Result::OK) {
+            return result;
+        }
+    }
+    return Result::OK;
+}
+
+static auto image_crc(const std::vector<uint8_t>& image) -> uint32_t {
+    return crc32::compute(image.begin(), image.end());
+}
+
+SCENARIO("firmware update hex decoding") {
+    auto output = std::array<uint8_t, 4>{};
+    GIVEN("valid hex digits") {
+        auto input = std::string_view("00a1FF7e");
+        THEN("they are decoded into bytes") {
+            REQUIRE(decode_hex(input.begin(), input.end(), output.begin(),
+                               output.size()) == 4);
+            REQUIRE(output == std::array<uint8_t, 4>{0x00, 0xA1, 0xFF, 0x7E});
+        }
+    }
+    GIVEN("invalid input") {
+        auto odd = std::string_view("abc");
+        auto bad = std::string_view("zz");
+        auto too_long = std::string_view("0011223344");
+        THEN("nothing is decoded") {
+            REQUIRE(decode_hex(odd.begin(), odd.end(), output.begin(),
+                               output.size()) == 0);
+            REQUIRE(decode_hex(bad.begin(), bad.end(), output.begin(),
+                               output.size()) == 0);
+            REQUIRE(decode_hex(too_long.begin(), too_long.end(),
+                               output.begin(), output.size()) == 0);
+        }
+    }
+}
+
+SCENARIO("firmware update into the backup partition") {
+    auto policy = TestBackupFlashPolicy();
+    auto updater = Updater();
+    // Long enough to span several pages, and not a whole number of chunks
+    auto image = backup_flash_test_policy::make_image(
+        backup_flash_test_policy::TEST_LAYOUT, 5000);
+    GIVEN("no upload in progress") {
+        THEN("chunks and finishing are rejected") {
+            REQUIRE(updater.write(0, Chunk{}, 8, 0, policy) ==
+                    Result::NOT_STARTED);
+            REQUIRE(updater.finish(policy) == Result::NOT_STARTED);
+        }
+        THEN("an image too big for the partition is rejected") {
+            REQUIRE(updater.begin(policy._flash.size(), 0, policy) ==
+                    Result::BAD_LENGTH);
+            REQUIRE(!updater.in_progress());
+        }
+    }
+    GIVEN("an upload of a valid image") {
+        REQUIRE(updater.begin(image.size(), image_crc(image), policy) ==
+                Result::OK);
+        THEN("only the page holding the request flag is erased up front") {
+            REQUIRE(policy._erases == 1);
+        }
+        WHEN("every chunk is written and the upload finished") {
+            REQUIRE(stream(updater, image, policy) == Result::OK);
+            REQUIRE(updater.finish(policy) == Result::OK);
+            THEN("the image is in the backup partition") {
+                REQUIRE(std::equal(image.begin(), image.end(),
+                                   policy._flash.begin()));
+            }
+            THEN("only the pages the image covers were erased") {
+                REQUIRE(policy._erases == 1 + 3);
+            }
+            THEN("doublewords that are all ones are left erased") {
+                for (uint32_t offset = 0; offset < image.size();
+                     offset += PROGRAM_LENGTH) {
+                    if (policy.backup_read(offset) == UINT64_MAX) {
+                        REQUIRE(policy.programs(offset) == 0);
+                    }
+                }
+            }
+            THEN("the verified marker is left for the startup app") {
+                REQUIRE(policy.backup_read(VERIFIED_MARKER_OFFSET) ==
+                        UINT64_MAX);
+                REQUIRE(policy.programs(VERIFIED_MARKER_OFFSET) == 0);
+            }
+            AND_WHEN("the startup app marks the image as verified") {
+                // What memory_mark_verified does once the image is checked
+                auto crc = policy.backup_read(INTEGRITY_REGION_OFFSET) &
+                           UINT32_MAX;
+                auto marker = (VERIFIED_MARKER_KEY << 32) | crc;
+                REQUIRE(policy.backup_read(VERIFIED_MARKER_OFFSET) ==
+                        UINT64_MAX);
+                THEN("the marker is programmed once since its erase") {
+                    REQUIRE(policy.backup_program(VERIFIED_MARKER_OFFSET,
+                                                  marker));
+                    REQUIRE(policy.backup_read(VERIFIED_MARKER_OFFSET) ==
+                            marker);
+                    REQUIRE(policy.programs(VERIFIED_MARKER_OFFSET) == 1);
+                }
+            }
+            THEN("the update is requested") {
+                REQUIRE(policy.update_requested());
+                REQUIRE(!updater.in_progress());
+            }
+        }
+        WHEN("a chunk is sent again after it was written") {
+            REQUIRE(stream(updater, image, policy) == Result::OK);
+            auto chunk = Chunk{};
+            std::copy_n(image.begin(), MAX_CHUNK_LENGTH, chunk.begin());
+            auto crc = crc32::compute(chunk.begin(), chunk.end());
+            THEN("it is accepted if it matches the flash") {
+                REQUIRE(updater.write(0, chunk, MAX_CHUNK_LENGTH, crc,
+                                      policy) == Result::OK);
+            }
+            THEN("it is rejected if it doesn't") {
+                chunk[0] ^= 1;
+                crc = crc32::compute(chunk.begin(), chunk.end());
+                REQUIRE(updater.write(0, chunk, MAX_CHUNK_LENGTH, crc,
+                                      policy) == Result::BAD_OFFSET);
+            }
+        }
+        WHEN("a chunk doesn't match its crc") {
+            auto chunk = Chunk{};
+            THEN("it is rejected and nothing is written") {
+                REQUIRE(updater.write(0, chunk, MAX_CHUNK_LENGTH, 1234,
+                                      policy) == Result::BAD_CHUNK_CRC);
+                REQUIRE(updater.written() == 0);
+            }
+        }
+        WHEN("a chunk skips ahead") {
+            auto chunk = Chunk{};
+            auto crc = crc32::compute(chunk.begin(), chunk.end());
+            THEN("it is rejected") {
+                REQUIRE(updater.write(MAX_CHUNK_LENGTH, chunk,
+                                      MAX_CHUNK_LENGTH, crc,
+                                      policy) == Result::BAD_OFFSET);
+            }
+        }
+        WHEN("finishing before every chunk is written") {
+            THEN("the upload is not committed") {
+                REQUIRE(updater.finish(policy) == Result::BAD_LENGTH);
+                REQUIRE(!policy.update_requested());
+            }
+        }
+        WHEN("flash programming fails") {
+            policy._fail_flash = true;
+            THEN("the upload is abandoned") {
+                REQUIRE(stream(updater, image, policy) ==
+                        Result::FLASH_ERROR);
+                REQUIRE(!updater.in_progress());
+            }
+        }
+    }
+    GIVEN("an upload whose whole-image crc is wrong") {
+        REQUIRE(updater.begin(image.size(), image_crc(image) + 1, policy) ==
+                Result::OK);
+        REQUIRE(stream(updater, image, policy) == Result::OK);
+        THEN("finishing fails and the update isn't requested") {
+            REQUIRE(updater.finish(policy) == Result::BAD_IMAGE_CRC);
+            REQUIRE(!policy.update_requested());
+        }
+    }
+    GIVEN("an image with a bad integrity region") {
+        image[APPLICATION_OFFSET] ^= 1;
+        REQUIRE(updater.begin(image.size(), image_crc(image), policy) ==
+                Result::OK);
+        REQUIRE(stream(updater, image, policy) == Result::OK);
+        THEN("finishing fails and the update isn't requested") {
+            REQUIRE(updater.finish(policy) == Result::BAD_IMAGE);
+            REQUIRE(!policy.update_requested());
+        }
+    }
+    GIVEN("an image with data where the verified marker goes") {
+        image[VERIFIED_MARKER_OFFSET] = 0;
+        REQUIRE(updater.begin(image.size(), image_crc(image), policy) ==
+                Result::OK);
+        THEN("the chunk holding it is rejected and the upload abandoned") {
+            REQUIRE(stream(updater, image, policy) == Result::BAD_IMAGE);
+            REQUIRE(!updater.in_progress());
+            REQUIRE(policy.programs(VERIFIED_MARKER_OFFSET) == 0);
+        }
+    }
+    GIVEN("an image for a different module") {
+        auto layout = backup_flash_test_policy::TEST_LAYOUT;
+        layout.name = "other-module";
+        image = backup_flash_test_policy::make_image(layout, 1000);
+        REQUIRE(updater.begin(image.size(), image_crc(image), policy) ==
+                Result::OK);
+        REQUIRE(stream(updater, image, policy) == Result::OK);
+        THEN("finishing fails") {
+            REQUIRE(updater.finish(policy) == Result::BAD_IMAGE);
+        }
+    }
+    GIVEN("an update that was already requested") {
+        REQUIRE(updater.begin(image.size(), image_crc(image), policy) ==
+                Result::OK);
+        REQUIRE(stream(updater, image, policy) == Result::OK);
+        REQUIRE(updater.finish(policy) == Result::OK);
+        WHEN("a new upload starts") {
+            REQUIRE(updater.begin(image.size(), image_crc(image), policy) ==
+                    Result::OK);
+            THEN("the old request is cleared") {
+                REQUIRE(!policy.update_requested());
+            }
+        }
+    }
+}
@@ -0,0 +1,276 @@
+#include "catch2/catch.hpp"
+#include "core/at24c0xc.hpp"
+#include "core/kv_store.hpp"
+#include "core/m24128.hpp"
+#include "test/test_at24c0xc_policy.hpp"
+#include "test/test_m24128_policy.hpp"
+
+using namespace kv_store;
+
+static constexpr size_t PAGES = 32;
+static constexpr uint8_t ADDRESS = 0x10;
+
+// Three records of 5 keys, each taking 6 pages, from page 8 to page 25
+using SmallStore = KVStore<at24c0xc::AT24C0xC<PAGES, ADDRESS>,
+                           at24c0xc::PAGE_LENGTH, 8, 18, 5>;
+using SmallPolicy = at24c0xc_test_policy::TestAT24C0XCPolicy<PAGES>;
+
+static_assert(SmallStore::RECORD_LENGTH == 48);
+static_assert(SmallStore::SLOT_PAGES == 6);
+static_assert(SmallStore::SLOTS == 3);
+static_assert(SmallStore::slot_page(0) == 20);
+static_assert(SmallStore::slot_page(2) == 8);
+
+SCENARIO("kv store round trip") {
+    GIVEN("a blank EEPROM") {
+        auto policy = SmallPolicy();
+        auto store = SmallStore();
+        WHEN("loading the store") {
+            REQUIRE(store.load(policy));
+            THEN("it is empty and no key is set") {
+                REQUIRE(store.empty());
+                REQUIRE(!store.get<double>(0).has_value());
+            }
+        }
+        WHEN("setting values of different types and committing them") {
+            REQUIRE(store.load(policy));
+            REQUIRE(store.set(0, 1.5));
+            REQUIRE(store.set(3, int32_t(-7)));
+            REQUIRE(store.set(4, float(2.25)));
+            REQUIRE(store.commit(policy));
+            THEN("the cache holds them") {
+                REQUIRE(store.get<double>(0) == 1.5);
+                REQUIRE(store.get<int32_t>(3) == -7);
+                REQUIRE(store.get<float>(4) == 2.25F);
+                REQUIRE(!store.get<double>(1).has_value());
+            }
+            THEN("only the pages of the first slot are written") {
+                for (size_t i = 0; i < PAGES * at24c0xc::PAGE_LENGTH; ++i) {
+                    auto page = i / at24c0xc::PAGE_LENGTH;
+                    if (page < 20 || page >= 26) {
+                        REQUIRE(policy._buffer[i] == 0);
+                    }
+                }
+            }
+            AND_WHEN("a new store loads the EEPROM") {
+                auto reloaded = SmallStore();
+                REQUIRE(reloaded.load(policy));
+                THEN("it has the same values") {
+                    REQUIRE(!reloaded.empty());
+                    REQUIRE(reloaded.get<double>(0) == 1.5);
+                    REQUIRE(reloaded.get<int32_t>(3) == -7);
+                    REQUIRE(reloaded.get<float>(4) == 2.25F);
+                    REQUIRE(!reloaded.is_set(1));
+                }
+            }
+        }
+        WHEN("setting a key that doesn't exist") {
+            THEN("it is refused") {
+                REQUIRE(!store.set(5, 1.0));
+                REQUIRE(!store.get<double>(5).has_value());
+            }
+        }
+    }
+}
+
+SCENARIO("kv store reads the EEPROM only once") {
+    GIVEN("a store with a committed value") {
+        auto policy = SmallPolicy();
+        auto writer = SmallStore();
+        REQUIRE(writer.load(policy));
+        REQUIRE(writer.set(2, 42.0));
+        REQUIRE(writer.commit(policy));
+        WHEN("a new store loads and is read many times") {
+            auto store = SmallStore();
+            policy._reads = 0;
+            REQUIRE(store.load(policy));
+            auto reads = policy._reads;
+            for (int i = 0; i < 100; ++i) {
+                REQUIRE(store.load(policy));
+                REQUIRE(store.get<double>(2) == 42.0);
+            }
+            THEN("only the first load reads, once per slot") {
+                REQUIRE(reads == SmallStore::SLOTS);
+                REQUIRE(policy._reads == reads);
+            }
+            AND_WHEN("committing") {
+                REQUIRE(store.set(1, 3.0));
+                REQUIRE(store.commit(policy));
+                THEN("nothing more is read") {
+                    REQUIRE(policy._reads == reads);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("kv store wear leveling") {
+    GIVEN("a blank EEPROM") {
+        auto policy = SmallPolicy();
+        auto store = SmallStore();
+        REQUIRE(store.load(policy));
+        WHEN("committing once per slot") {
+            for (size_t i = 0; i < SmallStore::SLOTS; ++i) {
+                REQUIRE(store.set(0, static_cast<double>(i)));
+                REQUIRE(store.commit(policy));
+            }
+            THEN("every slot holds a record") {
+                for (size_t slot = 0; slot < SmallStore::SLOTS; ++slot) {
+                    auto start =
+                        SmallStore::slot_page(slot) * at24c0xc::PAGE_LENGTH;
+                    // The low byte of the sequence number
+                    REQUIRE(policy._buffer[start + 1] == slot + 1);
+                }
+            }
+            AND_WHEN("committing again") {
+                REQUIRE(store.set(0, 10.0));
+                REQUIRE(store.commit(policy));
+                THEN("the oldest slot is reused") {
+                    auto start =
+                        SmallStore::slot_page(0) * at24c0xc::PAGE_LENGTH;
+                    REQUIRE(policy._buffer[start + 1] ==
+                            SmallStore::SLOTS + 1);
+                }
+                THEN("a new store loads the newest record") {
+                    auto reloaded = SmallStore();
+                    REQUIRE(reloaded.load(policy));
+                    REQUIRE(reloaded.get<double>(0) == 10.0);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("kv store recovers from a bad record") {
+    GIVEN("two committed records") {
+        auto policy = SmallPolicy();
+        auto store = SmallStore();
+        REQUIRE(store.load(policy));
+        REQUIRE(store.set(0, 1.0));
+        REQUIRE(store.commit(policy));
+        REQUIRE(store.set(0, 2.0));
+        REQUIRE(store.set(1, 5.0));
+        REQUIRE(store.commit(policy));
+        auto newest = SmallStore::slot_page(1) * at24c0xc::PAGE_LENGTH;
+        WHEN("the newest record was cut off partway through") {
+            for (size_t i = at24c0xc::PAGE_LENGTH * 2;
+                 i < SmallStore::RECORD_LENGTH; ++i) {
+                policy._buffer[newest + i] = 0;
+            }
+            THEN("a new store loads the record before it") {
+                auto reloaded = SmallStore();
+                REQUIRE(reloaded.load(policy));
+                REQUIRE(reloaded.get<double>(0) == 1.0);
+                REQUIRE(!reloaded.is_set(1));
+            }
+        }
+        WHEN("one bit of the newest record flips") {
+            policy._buffer[newest + 10] ^= 0x4;
+            auto reloaded = SmallStore();
+            REQUIRE(reloaded.load(policy));
+            THEN("the record before it is loaded") {
+                REQUIRE(reloaded.get<double>(0) == 1.0);
+            }
+            AND_WHEN("committing") {
+                REQUIRE(reloaded.set(0, 3.0));
+                REQUIRE(reloaded.commit(policy));
+                THEN("the bad record is replaced") {
+                    auto again = SmallStore();
+                    REQUIRE(again.load(policy));
+                    REQUIRE(again.get<double>(0) == 3.0);
+                    REQUIRE(policy._buffer[newest + 1] == 2);
+                }
+            }
+        }
+        WHEN("a commit fails") {
+            policy._busy_polls = at24c0xc::WRITE_POLL_ATTEMPTS + 1;
+            REQUIRE(store.set(0, 4.0));
+            REQUIRE(!store.commit(policy));
+            policy._busy = 0;
+            THEN("the last good record is still loaded") {
+                auto reloaded = SmallStore();
+                REQUIRE(reloaded.load(policy));
+                REQUIRE(reloaded.get<double>(0) == 2.0);
+            }
+        }
+    }
+}
+
+SCENARIO("kv store keeps new values when a load is retried") {
+    GIVEN("a committed value and a store whose first load fails") {
+        auto policy = SmallPolicy();
+        auto writer = SmallStore();
+        REQUIRE(writer.load(policy));
+        REQUIRE(writer.set(0, 1.0));
+        REQUIRE(writer.set(1, 5.0));
+        REQUIRE(writer.commit(policy));
+        auto store = SmallStore();
+        // The address of the first slot read isn't acknowledged
+        policy._busy = 1;
+        REQUIRE(!store.load(policy));
+        REQUIRE(!store.loaded());
+        WHEN("setting a value and committing") {
+            REQUIRE(store.set(0, 2.0));
+            REQUIRE(store.commit(policy));
+            THEN("the cache holds the new value") {
+                REQUIRE(store.get<double>(0) == 2.0);
+                REQUIRE(store.get<double>(1) == 5.0);
+            }
+            THEN("the EEPROM holds the new value") {
+                auto reloaded = SmallStore();
+                REQUIRE(reloaded.load(policy));
+                REQUIRE(reloaded.get<double>(0) == 2.0);
+                REQUIRE(reloaded.get<double>(1) == 5.0);
+            }
+        }
+    }
+}
+
+SCENARIO("kv store sequence numbers wrap") {
+    GIVEN("records on either side of the wrap") {
+        auto policy = SmallPolicy();
+        auto store = SmallStore();
+        REQUIRE(store.load(policy));
+        // Walk the sequence number up to just before the wrap
+        for (uint32_t i = 0; i < UINT16_MAX; ++i) {
+            REQUIRE(store.set(0, static_cast<double>(i)));
+            REQUIRE(store.commit(policy));
+        }
+        REQUIRE(store.set(0, -1.0));
+        REQUIRE(store.commit(policy));
+        WHEN("loading a new store") {
+            auto reloaded = SmallStore();
+            REQUIRE(reloaded.load(policy));
+            THEN("the record after the wrap is the newest") {
+                REQUIRE(reloaded.get<double>(0) == -1.0);
+            }
+        }
+    }
+}
+
+SCENARIO("kv store on an M24128") {
+    using Store =
+        KVStore<m24128::M24128<ADDRESS>, m24128::PAGE_LENGTH, 112, 16, 3>;
+    static_assert(Store::SLOT_PAGES == 1);
+    static_assert(Store::SLOTS == 16);
+    GIVEN("a blank M24128 that takes a few polls to finish each page") {
+        auto policy = m24128_test_policy::TestM24128Policy();
+        policy._busy_polls = 2;
+        auto store = Store();
+        REQUIRE(store.load(policy));
+        WHEN("committing three values") {
+            REQUIRE(store.set(0, 1.0));
+            REQUIRE(store.set(1, 2.0));
+            REQUIRE(store.set(2, 3.0));
+            REQUIRE(store.commit(policy));
+            THEN("a new store loads them from the last page") {
+                auto reloaded = Store();
+                REQUIRE(reloaded.load(policy));
+                REQUIRE(reloaded.get<double>(0) == 1.0);
+                REQUIRE(reloaded.get<double>(1) == 2.0);
+                REQUIRE(reloaded.get<double>(2) == 3.0);
+                REQUIRE(Store::slot_page(0) == 127);
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "simulator/line_framer.hpp"
+
+using Framer = line_framer::LineFramer<16, 4>;
+
+SCENARIO("line framer") {
+    GIVEN("a line framer") {
+        auto framer = Framer();
+        auto lines = std::vector<std::string>();
+        auto feed = [&](const std::string& chunk) {
+            framer.feed(chunk.data(), chunk.data() + chunk.size(),
+                        [&](const char* begin, const char* end) {
+                            lines.emplace_back(begin, end);
+                        });
+        };
+        WHEN("several lines arrive in one chunk") {
+            feed("M105\nM115\nG28\n");
+            THEN("each line is handed on by itself") {
+                REQUIRE(lines == std::vector<std::string>{"M105\n", "M115\n",
+                                                          "G28\n"});
+            }
+        }
+        WHEN("a line arrives in pieces") {
+            feed("M1");
+            THEN("nothing is handed on until it is complete") {
+                REQUIRE(lines.empty());
+                feed("04 S7");
+                feed("0\nM10");
+                REQUIRE(lines == std::vector<std::string>{"M104 S70\n"});
+            }
+        }
+        WHEN("a line is too long") {
+            feed("M104 S70 ABCDEFGHIJKLMNOP\nM105\n");
+            THEN("only that line is dropped") {
+                REQUIRE(lines == std::vector<std::string>{"M105\n"});
+                REQUIRE(framer.dropped() == 1);
+            }
+        }
+        WHEN("a line fills the buffer exactly") {
+            feed("M104 S70 ABCDEF\n");
+            THEN("it is handed on") {
+                REQUIRE(lines == std::vector<std::string>{"M104 S70 ABCDEF\n"});
+                REQUIRE(framer.dropped() == 0);
+            }
+        }
+    }
+    GIVEN("lines that are kept by reference") {
+        auto framer = Framer();
+        auto views = std::vector<std::pair<const char*, const char*>>();
+        auto chunk = std::string("A1\nB22\nC333\nD4444\nE5\n");
+        framer.feed(chunk.data(), chunk.data() + chunk.size(),
+                    [&](const char* begin, const char* end) {
+                        views.emplace_back(begin, end);
+                    });
+        THEN("each line stays intact until every slot has been reused") {
+            REQUIRE(std::string(views[1].first, views[1].second) == "B22\n");
+            REQUIRE(std::string(views[3].first, views[3].second) ==
+                    "D4444\n");
+            REQUIRE(std::string(views[4].first, views[4].second) == "E5\n");
+        }
+    }
+}
@@ -105,3 +105,53 @@ TEST_CASE("M24128 class functionality") {
         }
     }
 }
+
+TEST_CASE("M24128 multi-page writes") {
+    using namespace m24128;
+    constexpr const uint8_t address = 0b1010100;
+    GIVEN("an M24128 that takes a few polls to finish each page") {
+        auto policy = TestM24128Policy();
+        policy._busy_polls = 3;
+        auto eeprom = M24128<address>();
+        std::array<uint8_t, 150> data{};
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<uint8_t>(i + 1);
+        }
+        WHEN("writing 150 bytes from page 5") {
+            REQUIRE(eeprom.write_pages(5, data.begin(), data.size(), policy));
+            THEN("the bytes span three pages") {
+                for (size_t i = 0; i < data.size(); ++i) {
+                    REQUIRE(policy._buffer[5 * PAGE_LENGTH + i] == data[i]);
+                }
+                REQUIRE(policy._buffer[5 * PAGE_LENGTH + data.size()] == 0);
+            }
+            THEN("write protection is back on") {
+                REQUIRE(policy._write_protect);
+            }
+            AND_WHEN("reading them back") {
+                std::array<uint8_t, 150> readback{};
+                REQUIRE(eeprom.read_bytes(5, readback.begin(),
+                                          readback.size(), policy));
+                THEN("they are read in one transaction") {
+                    REQUIRE(readback == data);
+                    REQUIRE(policy._reads == 1);
+                }
+            }
+        }
+        WHEN("the device never finishes a page") {
+            policy._busy_polls = WRITE_POLL_ATTEMPTS + 1;
+            THEN("the write fails") {
+                REQUIRE(!eeprom.write_pages(5, data.begin(), data.size(),
+                                            policy));
+                REQUIRE(policy._write_protect);
+            }
+        }
+        WHEN("writing past the last page") {
+            THEN("nothing is written") {
+                REQUIRE(!eeprom.write_pages(126, data.begin(), data.size(),
+                                            policy));
+                REQUIRE(policy._buffer[126 * PAGE_LENGTH] == 0);
+            }
+        }
+    }
+}
@@ -406,3 +406,88 @@ SCENARIO("PID controller") {
         }
     }
 }
+
+SCENARIO("PID gain changes are bumpless") {
+    GIVEN("a PID controller that has been running") {
+        auto p = PID(2.0, 0.5, 0.0, 1.0, 10.0, -10.0);
+        p.compute(1.0);
+        auto last = p.compute(1.0);
+        WHEN("changing the gains") {
+            p.set_gains(PIDGains{.kp = 0.5, .ki = 0.25, .kd = 0.0});
+            THEN("the new gains are reported") {
+                REQUIRE(p.kp() == 0.5);
+                REQUIRE(p.ki() == 0.25);
+                REQUIRE(p.kd() == 0.0);
+            }
+            THEN("the output for the same error only moves by the new iterm") {
+                auto next = p.compute(1.0);
+                REQUIRE_THAT(next, Catch::Matchers::WithinAbs(last + 0.25,
+                                                              0.0001));
+            }
+        }
+        WHEN("changing the gains past the windup limit") {
+            p.set_gains(PIDGains{.kp = -50.0, .ki = 0.5, .kd = 0.0});
+            THEN("the integrator stays within its limits") {
+                REQUIRE(p.last_iterm() == 10.0);
+            }
+        }
+    }
+    GIVEN("a PID controller that was just reset") {
+        auto p = PID(2.0, 0.5, 0.0, 1.0);
+        p.compute(3.0);
+        p.reset();
+        WHEN("changing the gains") {
+            p.set_gains(PIDGains{.kp = 1.0, .ki = 0.1, .kd = 0.0});
+            THEN("the integrator stays empty") {
+                REQUIRE(p.last_iterm() == 0.0);
+            }
+        }
+    }
+}
+
+SCENARIO("PID gain schedule") {
+    GIVEN("a schedule with separate heating and cooling gains") {
+        auto schedule =
+            PIDGainSchedule<3>(PIDGains{.kp = 1, .ki = 2, .kd = 3},
+                               PIDGains{.kp = 4, .ki = 5, .kd = 6});
+        THEN("every zone uses the gains for its direction") {
+            for (size_t zone = 0; zone < 3; ++zone) {
+                REQUIRE(schedule.get(zone, PIDDirection::HEATING).kp == 1);
+                REQUIRE(schedule.get(zone, PIDDirection::COOLING).kp == 4);
+            }
+        }
+        WHEN("setting the gains for one zone and direction") {
+            REQUIRE(schedule.set(1, PIDDirection::COOLING,
+                                 PIDGains{.kp = 7, .ki = 8, .kd = 9}));
+            THEN("only that entry changes") {
+                auto gains = schedule.get(1, PIDDirection::COOLING);
+                REQUIRE(gains.kp == 7);
+                REQUIRE(gains.ki == 8);
+                REQUIRE(gains.kd == 9);
+                REQUIRE(schedule.get(1, PIDDirection::HEATING).kp == 1);
+                REQUIRE(schedule.get(0, PIDDirection::COOLING).kp == 4);
+                REQUIRE(schedule.get(2, PIDDirection::COOLING).kp == 4);
+            }
+        }
+        WHEN("setting the gains for one zone in both directions") {
+            REQUIRE(schedule.set(2, std::nullopt,
+                                 PIDGains{.kp = 7, .ki = 8, .kd = 9}));
+            THEN("both directions in that zone change") {
+                REQUIRE(schedule.get(2, PIDDirection::HEATING).kp == 7);
+                REQUIRE(schedule.get(2, PIDDirection::COOLING).kp == 7);
+                REQUIRE(schedule.get(1, PIDDirection::HEATING).kp == 1);
+            }
+        }
+        WHEN("setting a zone that doesn't exist") {
+            auto ret = schedule.set(3, std::nullopt,
+                                    PIDGains{.kp = 7, .ki = 8, .kd = 9});
+            THEN("it is rejected") {
+                REQUIRE(!ret);
+                REQUIRE(schedule.get(2, PIDDirection::HEATING).kp == 1);
+            }
+        }
+        THEN("zones past the end use the last zone") {
+            REQUIRE(schedule.get(10, PIDDirection::COOLING).kp == 4);
+        }
+    }
+}
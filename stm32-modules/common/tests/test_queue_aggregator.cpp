@@ -205,3 +205,99 @@ TEST_CASE("queues with identical message types") {
         }
     }
 }
+
+TEST_CASE("index-based sending with many queues") {
+    using Queue4 = TestMessageQueue<std::variant<Message1, Message2>, 2>;
+    GIVEN("an aggregator with four queues") {
+        Queue1 q1("1");
+        Queue2 q2("2");
+        Queue3 q3("3");
+        Queue4 q4("4");
+        auto aggregator = queue_aggregator::QueueAggregator(q1, q2, q3, q4);
+        THEN("each address reaches only its own queue") {
+            for (size_t address = 0; address < aggregator.TaskCount;
+                 ++address) {
+                DYNAMIC_SECTION("address " << address) {
+                    REQUIRE(aggregator.send_to_address(
+                        Message2{.a = 1, .b = 2}, address));
+                    REQUIRE(q1.has_message() == (address == 0));
+                    REQUIRE(q2.has_message() == (address == 1));
+                    REQUIRE(q3.has_message() == (address == 2));
+                    REQUIRE(q4.has_message() == (address == 3));
+                }
+            }
+        }
+        THEN("only the queues that can hold a message accept it") {
+            REQUIRE(!aggregator.send_to_address(Message3{}, 0));
+            REQUIRE(aggregator.send_to_address(Message3{}, 1));
+            REQUIRE(!aggregator.send_to_address(Message3{}, 2));
+            REQUIRE(!aggregator.send_to_address(Message3{}, 3));
+            REQUIRE(!aggregator.send_to_address(Message3{}, 4));
+            REQUIRE(q2.has_message());
+        }
+    }
+}
+
+struct TestBatchLock {
+    auto acquire() -> void {
+        REQUIRE(!held);
+        held = true;
+        ++acquired;
+    }
+    auto release() -> void {
+        REQUIRE(held);
+        held = false;
+    }
+
+    bool held = false;
+    int acquired = 0;
+};
+
+TEST_CASE("queue aggregator batch sending") {
+    GIVEN("an initialized queue aggregator") {
+        Queue1 q1("1");
+        Queue2 q2("2");
+        Aggregator aggregator;
+        TestBatchLock lock;
+        REQUIRE(aggregator.register_queue(q1));
+        REQUIRE(aggregator.register_queue(q2));
+        WHEN("sending a batch of messages to both queues") {
+            REQUIRE(aggregator.send_batch(lock, Message1{.payload = 1},
+                                          Message3{.a = 2},
+                                          Queue2::Message(Message2{3, 4})));
+            THEN("the lock was held once for the whole batch") {
+                REQUIRE(lock.acquired == 1);
+                REQUIRE(!lock.held);
+            }
+            THEN("every message is received in order") {
+                Queue1::Message rcv_1;
+                REQUIRE(q1.try_recv(&rcv_1));
+                REQUIRE(std::get<Message1>(rcv_1).payload == 1);
+                Queue2::Message rcv_2;
+                REQUIRE(q2.try_recv(&rcv_2));
+                REQUIRE(std::get<Message3>(rcv_2).a == 2);
+                REQUIRE(q2.try_recv(&rcv_2));
+                REQUIRE(std::get<Message2>(rcv_2).a == 3);
+                REQUIRE(!q1.has_message());
+                REQUIRE(!q2.has_message());
+            }
+        }
+    }
+    GIVEN("a queue aggregator with one queue registered") {
+        Queue1 q1("1");
+        Queue2 q2("2");
+        Aggregator aggregator;
+        TestBatchLock lock;
+        REQUIRE(aggregator.register_queue(q2));
+        WHEN("sending a batch that includes the unregistered queue") {
+            auto sent =
+                aggregator.send_batch(lock, Message1{}, Message3{.a = 5});
+            THEN("the batch fails but the rest of it is still sent") {
+                REQUIRE(!sent);
+                REQUIRE(!q1.has_message());
+                REQUIRE(q2.has_message());
+                REQUIRE(!lock.held);
+            }
+        }
+    }
+}
@@ -0,0 +1,170 @@
+#include <cmath>
+#include <deque>
+#include <numbers>
+
+#include "catch2/catch.hpp"
+#include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
+
+using namespace relay_autotune;
+
+namespace {
+constexpr double TIMESTEP = 0.01;
+
+// An integrating plant with dead time: the input moves at GAIN units per
+// second per unit of output, applied DELAY seconds late. Under relay control
+// it oscillates with a period of 4 * DELAY and an amplitude of
+// GAIN * d * DELAY, so Ku = 4 / (pi * GAIN * DELAY) exactly.
+struct DelayedIntegrator {
+    static constexpr double GAIN = 1.0;
+    static constexpr double DELAY = 2.0;
+    double value = 0;
+    std::deque<double> pending =
+        std::deque<double>(static_cast<size_t>(DELAY / TIMESTEP), 0.0);
+
+    auto step(double output) -> double {
+        pending.push_back(output);
+        value += GAIN * pending.front() * TIMESTEP;
+        pending.pop_front();
+        return value;
+    }
+};
+
+auto default_config() -> Config {
+    return Config{.setpoint = 0,
+                  .output_high = 1,
+                  .output_low = -1,
+                  .hysteresis = 0,
+                  .cycles = 3,
+                  .timeout = 100};
+}
+}  // namespace
+
+SCENARIO("relay autotune configuration") {
+    GIVEN("an autotuner") {
+        auto tuner = RelayAutotune();
+        REQUIRE(tuner.status() == Status::IDLE);
+        THEN("it doesn't drive the output until started") {
+            REQUIRE(tuner.update(-10, TIMESTEP) == 0);
+        }
+        THEN("invalid configurations are rejected") {
+            auto inverted = default_config();
+            inverted.output_low = 2;
+            REQUIRE(!tuner.start(inverted));
+            auto no_cycles = default_config();
+            no_cycles.cycles = 0;
+            REQUIRE(!tuner.start(no_cycles));
+            auto too_many = default_config();
+            too_many.cycles = RelayAutotune::MAX_CYCLES + 1;
+            REQUIRE(!tuner.start(too_many));
+            auto negative_band = default_config();
+            negative_band.hysteresis = -1;
+            REQUIRE(!tuner.start(negative_band));
+            REQUIRE(tuner.status() == Status::IDLE);
+        }
+        WHEN("started") {
+            REQUIRE(tuner.start(default_config()));
+            THEN("the relay follows the input with hysteresis") {
+                REQUIRE(tuner.running());
+                REQUIRE(tuner.update(-1, TIMESTEP) == 1);
+                REQUIRE(tuner.update(1, TIMESTEP) == -1);
+                REQUIRE(tuner.update(0, TIMESTEP) == -1);
+                REQUIRE(tuner.update(-1, TIMESTEP) == 1);
+            }
+            AND_WHEN("stopped") {
+                tuner.stop();
+                THEN("the output is released") {
+                    REQUIRE(tuner.status() == Status::IDLE);
+                    REQUIRE(tuner.update(-1, TIMESTEP) == 0);
+                }
+            }
+            AND_WHEN("the input never oscillates") {
+                for (int i = 0; i < 20000; ++i) {
+                    static_cast<void>(tuner.update(-1, TIMESTEP));
+                }
+                THEN("tuning fails at the timeout") {
+                    REQUIRE(tuner.status() == Status::FAILED);
+                    REQUIRE(!tuner.result().has_value());
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("relay autotune against a delayed integrator") {
+    GIVEN("an autotuner driving the plant from below the setpoint") {
+        auto tuner = RelayAutotune();
+        auto plant = DelayedIntegrator{.value = -5};
+        auto config = default_config();
+        REQUIRE(tuner.start(config));
+        WHEN("running until it finishes") {
+            double output = 0;
+            while (tuner.running()) {
+                output = tuner.update(plant.step(output), TIMESTEP);
+            }
+            THEN("the ultimate gain and period match the analytic values") {
+                REQUIRE(tuner.status() == Status::DONE);
+                REQUIRE(tuner.cycles_seen() == config.cycles + 1);
+                auto result = tuner.result().value();
+                const double ku = 4.0 / (std::numbers::pi *
+                                         DelayedIntegrator::GAIN *
+                                         DelayedIntegrator::DELAY);
+                REQUIRE_THAT(result.ultimate_period,
+                             Catch::Matchers::WithinRel(
+                                 4 * DelayedIntegrator::DELAY, 0.02));
+                REQUIRE_THAT(result.ultimate_gain,
+                             Catch::Matchers::WithinRel(ku, 0.02));
+                REQUIRE_THAT(result.amplitude,
+                             Catch::Matchers::WithinRel(
+                                 DelayedIntegrator::DELAY, 0.02));
+            }
+            THEN("the PID constants follow the Ziegler-Nichols rules") {
+                auto result = tuner.result().value();
+                auto ku = result.ultimate_gain;
+                auto tu = result.ultimate_period;
+                REQUIRE_THAT(result.kp, Catch::Matchers::WithinRel(0.6 * ku));
+                REQUIRE_THAT(result.ki,
+                             Catch::Matchers::WithinRel(1.2 * ku / tu));
+                REQUIRE_THAT(result.kd,
+                             Catch::Matchers::WithinRel(0.075 * ku * tu));
+            }
+            THEN("a PID with the tuned constants settles on a new target") {
+                auto result = tuner.result().value();
+                auto pid = PID(result.kp, result.ki, result.kd, TIMESTEP, 1.0,
+                               -1.0);
+                constexpr double target = 10;
+                double value = plant.value;
+                double pid_output = 0;
+                for (int i = 0; i < 10000; ++i) {
+                    value = plant.step(pid_output);
+                    pid_output =
+                        std::clamp(pid.compute(target - value), -1.0, 1.0);
+                }
+                REQUIRE_THAT(value, Catch::Matchers::WithinAbs(target, 0.1));
+            }
+        }
+    }
+    GIVEN("an autotuner with a hysteresis band") {
+        auto tuner = RelayAutotune();
+        auto plant = DelayedIntegrator{.value = -5};
+        auto config = default_config();
+        config.hysteresis = 0.5;
+        REQUIRE(tuner.start(config));
+        WHEN("running until it finishes") {
+            double output = 0;
+            while (tuner.running()) {
+                output = tuner.update(plant.step(output), TIMESTEP);
+            }
+            THEN("the band is accounted for in the ultimate gain") {
+                REQUIRE(tuner.status() == Status::DONE);
+                auto result = tuner.result().value();
+                auto a = result.amplitude;
+                REQUIRE(a > DelayedIntegrator::DELAY);
+                REQUIRE_THAT(result.ultimate_gain,
+                             Catch::Matchers::WithinRel(
+                                 4.0 / (std::numbers::pi *
+                                        std::sqrt((a * a) - (0.5 * 0.5)))));
+            }
+        }
+    }
+}
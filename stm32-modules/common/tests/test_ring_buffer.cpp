@@ -0,0 +1,66 @@
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "core/ring_buffer.hpp"
+
+SCENARIO("ring buffer push and pop") {
+    GIVEN("an empty ring buffer") {
+        auto rb = ring_buffer::RingBuffer<int, 4>();
+        REQUIRE(rb.empty());
+        REQUIRE(!rb.full());
+        REQUIRE(rb.capacity() == 4);
+        REQUIRE(!rb.pop().has_value());
+        REQUIRE(!rb.at(0).has_value());
+        WHEN("pushing fewer elements than the capacity") {
+            rb.push(1);
+            rb.push(2);
+            rb.push(3);
+            THEN("the elements are held oldest-first") {
+                REQUIRE(rb.size() == 3);
+                REQUIRE(!rb.full());
+                REQUIRE(rb.at(0).value() == 1);
+                REQUIRE(rb.at(2).value() == 3);
+                REQUIRE(!rb.at(3).has_value());
+                REQUIRE(rb.overwritten() == 0);
+            }
+            AND_WHEN("popping an element") {
+                auto popped = rb.pop();
+                THEN("the oldest element is removed") {
+                    REQUIRE(popped.value() == 1);
+                    REQUIRE(rb.size() == 2);
+                    REQUIRE(rb.at(0).value() == 2);
+                }
+            }
+        }
+        WHEN("pushing more elements than the capacity") {
+            for (int i = 1; i <= 6; ++i) {
+                rb.push(i);
+            }
+            THEN("the oldest elements are overwritten") {
+                REQUIRE(rb.full());
+                REQUIRE(rb.size() == 4);
+                REQUIRE(rb.overwritten() == 2);
+                REQUIRE(rb.at(0).value() == 3);
+                REQUIRE(rb.at(3).value() == 6);
+            }
+            AND_WHEN("draining the buffer") {
+                std::vector<int> drained;
+                while (auto value = rb.pop()) {
+                    drained.push_back(value.value());
+                }
+                THEN("elements come out in order") {
+                    REQUIRE(drained == std::vector<int>{3, 4, 5, 6});
+                    REQUIRE(rb.empty());
+                }
+            }
+            AND_WHEN("clearing the buffer") {
+                rb.clear();
+                THEN("the buffer is empty") {
+                    REQUIRE(rb.empty());
+                    REQUIRE(rb.overwritten() == 0);
+                    REQUIRE(!rb.at(0).has_value());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "catch2/catch.hpp"
+#include "simulator/sim_farm.hpp"
+
+SCENARIO("simulator farm instance settings") {
+    GIVEN("the socket URL of the first instance") {
+        auto url = std::string("socket://127.0.0.1:9000");
+        THEN("each instance gets the next port up") {
+            REQUIRE(sim_farm::instance_url(url, 0) == url);
+            REQUIRE(sim_farm::instance_url(url, 3) ==
+                    std::string("socket://127.0.0.1:9003"));
+        }
+    }
+    GIVEN("a socket URL without a port") {
+        THEN("no instance URL is made") {
+            REQUIRE(!sim_farm::instance_url("socket://localhost", 1));
+        }
+    }
+    GIVEN("a setting name") {
+        THEN("each instance reads its own environment variable") {
+            REQUIRE(sim_farm::instance_variable("SERIAL_NUMBER", 2) ==
+                    "SERIAL_NUMBER_2");
+        }
+    }
+}
+
+SCENARIO("simulator farm scheduling") {
+    GIVEN("a farm with two threads") {
+        auto farm = sim_farm::Farm(2, false);
+        THEN("instances are spread across the schedulers in turn") {
+            auto* first = &farm.next_scheduler();
+            auto* second = &farm.next_scheduler();
+            REQUIRE(first != second);
+            REQUIRE(&farm.next_scheduler() == first);
+            REQUIRE(farm.threads() == 2);
+        }
+    }
+    GIVEN("a farm asked for no threads") {
+        auto farm = sim_farm::Farm(0, false);
+        THEN("it still has one") { REQUIRE(farm.threads() == 1); }
+    }
+    GIVEN("a farm with instances registered") {
+        auto farm = sim_farm::Farm(2, false);
+        std::atomic_int ticks_a = 0;
+        std::atomic_int ticks_b = 0;
+        auto& scheduler_a = farm.next_scheduler();
+        auto& scheduler_b = farm.next_scheduler();
+        scheduler_a.add_periodic(1, [&]() { ++ticks_a; });
+        scheduler_b.add_periodic(1, [&]() { ++ticks_b; });
+        WHEN("the farm runs and each instance gets input") {
+            std::atomic_int inputs = 0;
+            farm.start();
+            scheduler_a.post([&]() { ++inputs; });
+            scheduler_b.post([&]() { ++inputs; });
+            while (inputs < 2) {
+                std::this_thread::yield();
+            }
+            farm.stop();
+            THEN("every instance makes progress") {
+                using sim_scheduler::Scheduler;
+                REQUIRE(ticks_a == Scheduler::DEFAULT_INPUT_PERIOD);
+                REQUIRE(ticks_b == Scheduler::DEFAULT_INPUT_PERIOD);
+            }
+        }
+    }
+}
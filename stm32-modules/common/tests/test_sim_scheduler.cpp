@@ -0,0 +1,208 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "simulator/sim_scheduler.hpp"
+
+using namespace sim_scheduler;
+
+SCENARIO("simulator scheduler runs tasks deterministically") {
+    GIVEN("a scheduler with two tasks that pass work to each other") {
+        auto scheduler = Scheduler();
+        auto log = std::vector<std::string>();
+        int first_work = 0;
+        int second_work = 0;
+        scheduler.add_task([&]() { return first_work > 0; },
+                           [&]() {
+                               --first_work;
+                               ++second_work;
+                               log.push_back("first");
+                           });
+        scheduler.add_task([&]() { return second_work > 0; },
+                           [&]() {
+                               --second_work;
+                               log.push_back("second");
+                           });
+        WHEN("the first task is given work") {
+            first_work = 2;
+            auto runs = scheduler.run_until_idle();
+            THEN("both tasks run in registration order until idle") {
+                REQUIRE(runs == 4);
+                REQUIRE(log == std::vector<std::string>{"first", "second",
+                                                        "first", "second"});
+                REQUIRE(scheduler.now() == 0);
+            }
+        }
+        WHEN("no task has work") {
+            THEN("nothing runs") { REQUIRE(scheduler.run_until_idle() == 0); }
+        }
+    }
+    GIVEN("a scheduler with periodic events") {
+        auto scheduler = Scheduler();
+        auto log = std::vector<std::pair<Scheduler::Ticks, char>>();
+        scheduler.add_periodic(
+            10, [&]() { log.emplace_back(scheduler.now(), 'a'); });
+        scheduler.add_periodic(
+            4, [&]() { log.emplace_back(scheduler.now(), 'b'); });
+        WHEN("the scheduler advances") {
+            REQUIRE(scheduler.advance());
+            THEN("the clock jumps straight to the first event") {
+                REQUIRE(scheduler.now() == 4);
+                REQUIRE(log.size() == 1);
+            }
+        }
+        WHEN("the scheduler runs for a while") {
+            scheduler.run_for(20);
+            THEN("events fire in time order, then registration order") {
+                using Entry = std::pair<Scheduler::Ticks, char>;
+                REQUIRE(log == std::vector<Entry>{{4, 'b'},
+                                                  {8, 'b'},
+                                                  {10, 'a'},
+                                                  {12, 'b'},
+                                                  {16, 'b'},
+                                                  {20, 'a'},
+                                                  {20, 'b'}});
+                REQUIRE(scheduler.now() == 20);
+            }
+        }
+    }
+    GIVEN("a periodic event that gives a task work") {
+        auto scheduler = Scheduler();
+        int pending = 0;
+        auto handled = std::vector<Scheduler::Ticks>();
+        scheduler.add_task([&]() { return pending > 0; },
+                           [&]() {
+                               --pending;
+                               handled.push_back(scheduler.now());
+                           });
+        scheduler.add_periodic(100, [&]() { ++pending; });
+        WHEN("the scheduler advances") {
+            scheduler.run_for(300);
+            THEN("the task handles each event before time moves on") {
+                REQUIRE(handled ==
+                        std::vector<Scheduler::Ticks>{100, 200, 300});
+            }
+        }
+    }
+    GIVEN("a scheduler without periodic events") {
+        auto scheduler = Scheduler();
+        THEN("time can't advance") {
+            REQUIRE(!scheduler.advance());
+            scheduler.run_for(100);
+            REQUIRE(scheduler.now() == 0);
+        }
+    }
+    GIVEN("a scheduler that runs with input from the host") {
+        using namespace std::chrono_literals;
+        auto scheduler = Scheduler(100);
+        auto log = std::vector<std::pair<Scheduler::Ticks, std::string>>();
+        std::atomic_int delivered = 0;
+        scheduler.add_periodic(
+            30, [&]() { log.emplace_back(scheduler.now(), "event"); });
+        auto wait_for = [&](int count) {
+            for (int i = 0; i < 100 && delivered < count; ++i) {
+                std::this_thread::sleep_for(10ms);
+            }
+        };
+        auto post = [&](const std::string& line) {
+            scheduler.post_line(
+                line.data(), line.data() + line.size(),
+                [&](const char* begin, const char* end) {
+                    log.emplace_back(scheduler.now(), std::string(begin, end));
+                    ++delivered;
+                });
+        };
+        WHEN("no input arrives") {
+            {
+                auto runner = std::jthread(
+                    [&](std::stop_token st) { scheduler.run(st); });
+                std::this_thread::sleep_for(50ms);
+            }
+            THEN("the clock stays put rather than running ahead") {
+                REQUIRE(scheduler.now() == 0);
+                REQUIRE(log.empty());
+            }
+        }
+        WHEN("the host sends lines at irregular times") {
+            {
+                auto runner = std::jthread(
+                    [&](std::stop_token st) { scheduler.run(st); });
+                post("M104 S50");
+                std::this_thread::sleep_for(20ms);
+                post("M105");
+                post("M105");
+                wait_for(3);
+            }
+            THEN("each line arrives one input period after the last") {
+                using Entry = std::pair<Scheduler::Ticks, std::string>;
+                REQUIRE(log == std::vector<Entry>{{30, "event"},
+                                                  {60, "event"},
+                                                  {90, "event"},
+                                                  {100, "M104 S50"},
+                                                  {120, "event"},
+                                                  {150, "event"},
+                                                  {180, "event"},
+                                                  {200, "M105"},
+                                                  {210, "event"},
+                                                  {240, "event"},
+                                                  {270, "event"},
+                                                  {300, "event"},
+                                                  {300, "M105"}});
+                REQUIRE(scheduler.now() == 300);
+            }
+        }
+        WHEN("a paced scheduler gets a line") {
+            auto runner = std::jthread(
+                [&](std::stop_token st) { scheduler.run_paced(st); });
+            post("M105");
+            wait_for(1);
+            THEN("the line is delivered without waiting for an event") {
+                REQUIRE(delivered == 1);
+            }
+        }
+    }
+    GIVEN("a paced scheduler") {
+        using namespace std::chrono_literals;
+        auto scheduler = Scheduler();
+        std::atomic_int pending = 0;
+        std::atomic_int handled = 0;
+        scheduler.add_task([&]() { return pending > 0; },
+                           [&]() {
+                               --pending;
+                               ++handled;
+                           });
+        WHEN("it runs with a periodic event") {
+            std::atomic_int fired = 0;
+            scheduler.add_periodic(10, [&]() { ++fired; });
+            auto start = std::chrono::steady_clock::now();
+            {
+                auto runner = std::jthread(
+                    [&](std::stop_token st) { scheduler.run_paced(st); });
+                std::this_thread::sleep_for(100ms);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            THEN("the virtual clock keeps up with the wall clock") {
+                REQUIRE(scheduler.now() >= 50);
+                REQUIRE(std::chrono::milliseconds(scheduler.now()) <=
+                        elapsed);
+                REQUIRE(fired == static_cast<int>(scheduler.now() / 10));
+            }
+        }
+        WHEN("another thread gives a task work and notifies it") {
+            auto runner = std::jthread(
+                [&](std::stop_token st) { scheduler.run_paced(st); });
+            std::this_thread::sleep_for(10ms);
+            ++pending;
+            scheduler.notify();
+            for (int i = 0; i < 100 && handled == 0; ++i) {
+                std::this_thread::sleep_for(10ms);
+            }
+            THEN("the task runs without waiting for an event") {
+                REQUIRE(handled == 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include <chrono>
+#include <thread>
+
+#include "catch2/catch.hpp"
+#include "hal/message_queue.hpp"
+#include "simulator/simulator_queue.hpp"
+
+using Queue = SimulatorMessageQueue<int, 2>;
+static_assert(MessageQueue<Queue, int>);
+
+SCENARIO("simulator message queue") {
+    using namespace std::chrono_literals;
+    GIVEN("an empty queue") {
+        auto queue = Queue();
+        int message = 0;
+        THEN("it has no message and receiving without waiting fails") {
+            REQUIRE(!queue.has_message());
+            REQUIRE(!queue.try_recv(&message));
+        }
+        WHEN("messages are sent") {
+            REQUIRE(queue.try_send(1));
+            REQUIRE(queue.try_send_from_isr(2));
+            THEN("they are received in order") {
+                REQUIRE(queue.has_message());
+                queue.recv(&message);
+                REQUIRE(message == 1);
+                REQUIRE(queue.try_recv(&message, 10));
+                REQUIRE(message == 2);
+            }
+            THEN("the full queue rejects more") {
+                REQUIRE(!queue.try_send(3));
+                REQUIRE(!queue.try_send(3, 5));
+            }
+        }
+        WHEN("a receive waits with a timeout") {
+            auto start = std::chrono::steady_clock::now();
+            auto received = queue.try_recv(&message, 20);
+            auto waited = std::chrono::steady_clock::now() - start;
+            THEN("it gives up after the timeout") {
+                REQUIRE(!received);
+                REQUIRE(waited >= 20ms);
+            }
+        }
+        WHEN("waiting for a message until a deadline") {
+            auto start = std::chrono::steady_clock::now();
+            auto waiting = queue.wait_for_message_until(start + 20ms);
+            auto waited = std::chrono::steady_clock::now() - start;
+            THEN("it gives up at the deadline") {
+                REQUIRE(!waiting);
+                REQUIRE(waited >= 20ms);
+            }
+        }
+        WHEN("a message arrives before the deadline") {
+            auto sender = std::jthread([&queue]() {
+                std::this_thread::sleep_for(10ms);
+                static_cast<void>(queue.try_send(6));
+            });
+            auto waiting = queue.wait_for_message_until(
+                std::chrono::steady_clock::now() + 1s);
+            THEN("the wait ends without taking the message") {
+                REQUIRE(waiting);
+                REQUIRE(queue.try_recv(&message));
+                REQUIRE(message == 6);
+            }
+        }
+        WHEN("another thread sends while a receive is blocked") {
+            auto sender = std::jthread([&queue]() {
+                std::this_thread::sleep_for(10ms);
+                static_cast<void>(queue.try_send(5));
+            });
+            queue.recv(&message);
+            THEN("the receiver wakes up with the message") {
+                REQUIRE(message == 5);
+            }
+        }
+    }
+    GIVEN("a full queue") {
+        auto queue = Queue();
+        REQUIRE(queue.try_send(1));
+        REQUIRE(queue.try_send(2));
+        WHEN("another thread receives while a send is blocked") {
+            auto receiver = std::jthread([&queue]() {
+                std::this_thread::sleep_for(10ms);
+                int message = 0;
+                static_cast<void>(queue.try_recv(&message));
+            });
+            THEN("the sender gets its message in") {
+                REQUIRE(queue.try_send(3, 1000));
+            }
+        }
+    }
+    GIVEN("a queue waited on by a thread that gets stopped") {
+        auto queue = Queue();
+        auto source = std::stop_source();
+        queue.set_stop_token(source.get_token());
+        WHEN("the stop is requested during a blocking receive") {
+            auto stopper = std::jthread([&source]() {
+                std::this_thread::sleep_for(10ms);
+                source.request_stop();
+            });
+            THEN("the receive is interrupted") {
+                int message = 0;
+                REQUIRE_THROWS_AS(queue.recv(&message),
+                                  Queue::StopDuringMsgWait);
+            }
+        }
+        WHEN("the stop is requested while waiting until a deadline") {
+            auto stopper = std::jthread([&source]() {
+                std::this_thread::sleep_for(10ms);
+                source.request_stop();
+            });
+            THEN("the wait is interrupted") {
+                REQUIRE_THROWS_AS(queue.wait_for_message_until(
+                                      std::chrono::steady_clock::now() + 1s),
+                                  Queue::StopDuringMsgWait);
+            }
+        }
+        WHEN("the stop was already requested") {
+            source.request_stop();
+            int message = 0;
+            THEN("receiving without waiting does not throw") {
+                REQUIRE(!queue.try_recv(&message));
+            }
+            THEN("a message already in the queue is still received") {
+                REQUIRE(queue.try_send(7));
+                REQUIRE(queue.try_recv(&message, 10));
+                REQUIRE(message == 7);
+            }
+        }
+    }
+}
@@ -0,0 +1,220 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+
+extern "C" {
+#include "startup_boot.h"
+#include "startup_memory.h"
+}
+
+// A model of the two slots, standing in for the flash checks and writes
+// that startup_boot.c is built on
+namespace {
+
+struct FakeSlot {
+    // Which image the slot holds, or 0 if it is erased
+    int image = 0;
+    bool corrupt = false;
+    bool marked = false;
+    // An image that uses the marker doubleword can't be marked
+    bool markable = true;
+};
+
+struct FakeFlash {
+    std::array<FakeSlot, 2> slots = {};
+    bool update_requested = false;
+    std::array<int, 2> full_checks = {};
+    int compares = 0;
+    int copies_to_main = 0;
+    int copies_to_backup = 0;
+
+    auto main() -> FakeSlot& { return slots.at(APP_SLOT_MAIN); }
+    auto backup() -> FakeSlot& { return slots.at(APP_SLOT_BACKUP); }
+
+    // Writing a slot always starts by erasing its first page
+    static auto write(FakeSlot& slot, int image) -> void {
+        slot = FakeSlot{.image = image};
+    }
+
+    auto reset_counts() -> void {
+        full_checks = {};
+        compares = 0;
+        copies_to_main = 0;
+        copies_to_backup = 0;
+    }
+};
+
+FakeFlash flash;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+}  // namespace
+
+extern "C" {
+
+auto check_app_exists(APP_SLOT_ENUM slot) -> bool {
+    return flash.slots.at(slot).image != 0;
+}
+
+auto check_name(APP_SLOT_ENUM slot) -> bool {
+    return flash.slots.at(slot).image != 0;
+}
+
+auto check_slot(APP_SLOT_ENUM slot) -> bool {
+    ++flash.full_checks.at(slot);
+    auto& checked = flash.slots.at(slot);
+    return checked.image != 0 && !checked.corrupt;
+}
+
+auto check_verified_marker(APP_SLOT_ENUM slot) -> bool {
+    return flash.slots.at(slot).marked;
+}
+
+auto check_integrity_regions_match() -> bool {
+    return flash.main().image == flash.backup().image;
+}
+
+auto check_backup_matches_main() -> bool {
+    ++flash.compares;
+    return flash.main().image == flash.backup().image &&
+           flash.main().corrupt == flash.backup().corrupt;
+}
+
+auto check_update_requested() -> bool { return flash.update_requested; }
+
+auto memory_copy_backup_to_main() -> bool {
+    ++flash.copies_to_main;
+    FakeFlash::write(flash.main(), flash.backup().image);
+    flash.main().corrupt = flash.backup().corrupt;
+    return true;
+}
+
+auto memory_copy_main_to_backup() -> bool {
+    ++flash.copies_to_backup;
+    FakeFlash::write(flash.backup(), flash.main().image);
+    flash.backup().corrupt = flash.main().corrupt;
+    return true;
+}
+
+auto memory_clear_update_request() -> bool {
+    flash.update_requested = false;
+    return true;
+}
+
+auto memory_mark_verified(APP_SLOT_ENUM slot) -> bool {
+    auto& marked = flash.slots.at(slot);
+    if (!marked.markable) {
+        return false;
+    }
+    marked.marked = true;
+    return true;
+}
+}
+
+SCENARIO("startup app caches slot checks across boots") {
+    GIVEN("both slots holding the same image, never checked before") {
+        flash = FakeFlash{};
+        FakeFlash::write(flash.main(), 1);
+        FakeFlash::write(flash.backup(), 1);
+        WHEN("booting") {
+            auto ok = boot_prepare_application();
+            THEN("the app starts after every check of both slots") {
+                REQUIRE(ok);
+                REQUIRE(flash.full_checks == std::array{1, 1});
+                REQUIRE(flash.copies_to_backup == 0);
+            }
+            THEN("both slots are marked") {
+                REQUIRE(flash.main().marked);
+                REQUIRE(flash.backup().marked);
+            }
+            AND_WHEN("booting again") {
+                flash.reset_counts();
+                ok = boot_prepare_application();
+                THEN("the app starts without checking either CRC") {
+                    REQUIRE(ok);
+                    REQUIRE(flash.full_checks == std::array{0, 0});
+                    REQUIRE(flash.compares == 0);
+                }
+            }
+            AND_WHEN("a new image is written to the main slot") {
+                FakeFlash::write(flash.main(), 2);
+                flash.reset_counts();
+                ok = boot_prepare_application();
+                THEN("the main slot is checked and copied to the backup") {
+                    REQUIRE(ok);
+                    REQUIRE(flash.full_checks == std::array{1, 0});
+                    REQUIRE(flash.copies_to_backup == 1);
+                    REQUIRE(flash.backup().image == 2);
+                }
+                AND_WHEN("booting again") {
+                    flash.reset_counts();
+                    ok = boot_prepare_application();
+                    THEN("only the new copy in the backup slot is checked") {
+                        REQUIRE(ok);
+                        REQUIRE(flash.full_checks == std::array{0, 1});
+                        REQUIRE(flash.copies_to_backup == 0);
+                    }
+                }
+            }
+            AND_WHEN("the main slot is only partly rewritten") {
+                FakeFlash::write(flash.main(), 1);
+                flash.main().corrupt = true;
+                flash.reset_counts();
+                ok = boot_prepare_application();
+                THEN("the full check catches it and the backup is restored") {
+                    REQUIRE(ok);
+                    REQUIRE(flash.full_checks.at(APP_SLOT_MAIN) == 2);
+                    REQUIRE(flash.copies_to_main == 1);
+                    REQUIRE(!flash.main().corrupt);
+                    REQUIRE(flash.main().marked);
+                }
+            }
+        }
+    }
+    GIVEN("marked slots and an update staged in the backup slot") {
+        flash = FakeFlash{};
+        FakeFlash::write(flash.main(), 1);
+        flash.main().marked = true;
+        FakeFlash::write(flash.backup(), 2);
+        flash.update_requested = true;
+        WHEN("booting") {
+            auto ok = boot_prepare_application();
+            THEN("the update is installed and fully checked") {
+                REQUIRE(ok);
+                REQUIRE(flash.copies_to_main == 1);
+                REQUIRE(flash.main().image == 2);
+                REQUIRE(flash.full_checks == std::array{1, 1});
+                REQUIRE(flash.main().marked);
+                REQUIRE(!flash.update_requested);
+            }
+        }
+    }
+    GIVEN("images that can't be marked") {
+        flash = FakeFlash{};
+        FakeFlash::write(flash.main(), 1);
+        FakeFlash::write(flash.backup(), 1);
+        flash.main().markable = false;
+        flash.backup().markable = false;
+        WHEN("booting twice") {
+            static_cast<void>(boot_prepare_application());
+            flash.reset_counts();
+            auto ok = boot_prepare_application();
+            THEN("every boot runs every check") {
+                REQUIRE(ok);
+                REQUIRE(flash.full_checks == std::array{1, 1});
+                REQUIRE(flash.compares == 1);
+                REQUIRE(flash.copies_to_backup == 0);
+            }
+        }
+    }
+    GIVEN("no valid image in either slot") {
+        flash = FakeFlash{};
+        FakeFlash::write(flash.main(), 1);
+        flash.main().corrupt = true;
+        WHEN("booting") {
+            auto ok = boot_prepare_application();
+            THEN("the startup app goes to the bootloader") {
+                REQUIRE(!ok);
+                REQUIRE(!flash.main().marked);
+            }
+        }
+    }
+}
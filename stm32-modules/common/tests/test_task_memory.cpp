@@ -0,0 +1,34 @@
+#include "catch2/catch.hpp"
+#include "core/task_memory.hpp"
+
+SCENARIO("task memory registry") {
+    GIVEN("an empty registry") {
+        auto registry = task_memory::TaskRegistry<int, 2>();
+        THEN("it has no tasks") { REQUIRE(registry.count() == 0); }
+        WHEN("tasks are added") {
+            REQUIRE(registry.add(7, 256));
+            REQUIRE(registry.add(8, 2048));
+            THEN("they are kept in order with their stack sizes") {
+                REQUIRE(registry.count() == 2);
+                REQUIRE(registry.at(0).handle == 7);
+                REQUIRE(registry.at(0).stack_words == 256);
+                REQUIRE(registry.at(1).handle == 8);
+                REQUIRE(registry.at(1).stack_words == 2048);
+            }
+            THEN("the full registry rejects more") {
+                REQUIRE(!registry.add(9, 128));
+                REQUIRE(registry.count() == 2);
+            }
+        }
+    }
+}
+
+SCENARIO("stack usage") {
+    GIVEN("a stack that has come close to overflowing") {
+        auto usage = task_memory::StackUsage{
+            .name = "Task", .size_words = 256, .min_free_words = 16};
+        THEN("the peak use is what was never free") {
+            REQUIRE(usage.peak_used_words() == 240);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include "catch2/catch.hpp"
+#include "core/task_stats.hpp"
+
+struct FakeCycleClock {
+    uint32_t cycles = 0;
+    [[nodiscard]] auto now() const -> uint32_t { return cycles; }
+    [[nodiscard]] static auto ticks_per_us() -> uint32_t { return 10; }
+};
+static_assert(task_stats::CycleClock<FakeCycleClock>);
+
+SCENARIO("task stats durations") {
+    GIVEN("no recorded durations") {
+        auto durations = task_stats::Durations();
+        THEN("everything reads zero") {
+            REQUIRE(durations.count() == 0);
+            REQUIRE(durations.min() == 0);
+            REQUIRE(durations.average() == 0);
+            REQUIRE(durations.max() == 0);
+        }
+    }
+    GIVEN("some recorded durations") {
+        auto durations = task_stats::Durations();
+        durations.record(10);
+        durations.record(20);
+        durations.record(60);
+        durations.record(5000);
+        THEN("the min, average and max are kept") {
+            REQUIRE(durations.count() == 4);
+            REQUIRE(durations.min() == 10);
+            REQUIRE(durations.average() == 1272);
+            REQUIRE(durations.max() == 5000);
+        }
+        THEN("each lands in its histogram bucket") {
+            auto histogram = durations.histogram();
+            REQUIRE(histogram[0] == 1);
+            REQUIRE(histogram[1] == 2);
+            REQUIRE(histogram[5] == 1);
+        }
+    }
+    GIVEN("a duration past the top of the histogram") {
+        auto durations = task_stats::Durations();
+        durations.record(task_stats::Durations::HISTOGRAM_TOP_US);
+        THEN("it lands in the last bucket") {
+            REQUIRE(durations.histogram().back() == 1);
+        }
+    }
+}
+
+SCENARIO("task stats recording") {
+    GIVEN("a task and a clock") {
+        auto stats = task_stats::TaskStats("Task");
+        auto clock = FakeCycleClock();
+        WHEN("a pass through the handler is measured") {
+            {
+                auto measure = task_stats::Measurement(stats, clock);
+                clock.cycles += 250;
+            }
+            THEN("its time is recorded in microseconds") {
+                REQUIRE(stats.handler().count() == 1);
+                REQUIRE(stats.handler().max() == 25);
+            }
+        }
+        WHEN("the counter wraps during a pass") {
+            clock.cycles = std::numeric_limits<uint32_t>::max() - 49;
+            {
+                auto measure = task_stats::Measurement(stats, clock);
+                clock.cycles += 100;
+            }
+            THEN("the time is still right") {
+                REQUIRE(stats.handler().max() == 10);
+            }
+        }
+        WHEN("a periodic task wakes up early and late") {
+            stats.record_wakeup(100, clock);
+            clock.cycles += 1020;
+            stats.record_wakeup(100, clock);
+            clock.cycles += 960;
+            stats.record_wakeup(100, clock);
+            THEN("the jitter of each wakeup after the first is recorded") {
+                REQUIRE(stats.period_us() == 100);
+                REQUIRE(stats.jitter().count() == 2);
+                REQUIRE(stats.jitter().min() == 2);
+                REQUIRE(stats.jitter().max() == 4);
+            }
+        }
+        WHEN("queue depths are reported") {
+            stats.record_queue_depth(3);
+            stats.record_queue_depth(1);
+            THEN("the deepest is kept") {
+                REQUIRE(stats.queue_high_water() == 3);
+            }
+        }
+    }
+    GIVEN("a registry") {
+        auto registry = task_stats::Registry<2>({"First", "Second"});
+        THEN("each task has its name") {
+            REQUIRE_THAT(registry.at(0).name(),
+                         Catch::Matchers::Equals("First"));
+            REQUIRE_THAT(registry.at(1).name(),
+                         Catch::Matchers::Equals("Second"));
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#include <sstream>
+
+#include "catch2/catch.hpp"
+#include "simulator/thermal_network.hpp"
+
+using namespace thermal_network;
+
+namespace {
+// A heated block that leaks to a fixed ambient: with a power of P and a
+// conductance of G, it settles P / G above ambient.
+constexpr std::string_view HEATED_BLOCK = R"(
+# A comment line
+node ambient capacity=1 temperature=20 fixed
+node block capacity=10 temperature=20 power=5  # Trailing comment
+link block ambient 0.5
+)";
+
+// A peltier that pumps heat between a plate and a heatsink.
+constexpr std::string_view PELTIER = R"(
+node ambient capacity=1 temperature=20 fixed
+node heatsink capacity=100 temperature=20
+node plate capacity=10 temperature=20 power=10 source=heatsink
+link heatsink ambient 2
+link plate heatsink 0.05
+)";
+}  // namespace
+
+SCENARIO("thermal network parsing") {
+    GIVEN("a valid network description") {
+        auto network = parse(HEATED_BLOCK);
+        THEN("every node and link is created") {
+            REQUIRE(network.has_value());
+            REQUIRE(network->nodes().size() == 2);
+            REQUIRE(network->links().size() == 1);
+            auto block = network->find("block");
+            REQUIRE(block.has_value());
+            REQUIRE(network->nodes()[block.value()].capacity == 10);
+            REQUIRE(network->nodes()[block.value()].power == 5);
+            REQUIRE(network->nodes()[network->find("ambient").value()].fixed);
+            REQUIRE(network->temperature(block.value()) == 20);
+        }
+    }
+    GIVEN("a description read from a stream") {
+        auto stream = std::istringstream(std::string(PELTIER));
+        auto network = parse(stream);
+        THEN("pumped nodes know their source") {
+            REQUIRE(network.has_value());
+            auto plate = network->find("plate").value();
+            REQUIRE(network->nodes()[plate].source ==
+                    network->find("heatsink"));
+        }
+    }
+    GIVEN("invalid network descriptions") {
+        auto text = GENERATE(as<std::string>{},
+                             "node a capacity=1 temperature=20\n"
+                             "node a capacity=1 temperature=20\n",
+                             "node a capacity=0 temperature=20\n",
+                             "node a capacity=1 mass=20\n",
+                             "node a capacity=1 temperature=hot\n",
+                             "node a capacity=1 source=b\n",
+                             "node a capacity=1\nlink a b 1\n",
+                             "node a capacity=1\nlink a a 1\n",
+                             "node a capacity=1\nnode b capacity=1\n"
+                             "link a b -1\n",
+                             "node a capacity=1\nnode b capacity=1\n"
+                             "link a b 1 2\n",
+                             "wire a b 1\n");
+        THEN("they are rejected") { REQUIRE(!parse(text).has_value()); }
+    }
+}
+
+SCENARIO("thermal network simulation") {
+    GIVEN("a heated block") {
+        auto network = parse(HEATED_BLOCK).value();
+        auto block = network.find("block").value();
+        auto ambient = network.find("ambient").value();
+        WHEN("the heater runs at full power for a long time") {
+            network.set_drive(block, 1.0);
+            network.advance(1000);
+            THEN("the block settles at its steady state temperature") {
+                REQUIRE_THAT(network.temperature(block),
+                             Catch::Matchers::WithinAbs(20 + (5 / 0.5), 0.01));
+            }
+            THEN("the fixed ambient node does not move") {
+                REQUIRE(network.temperature(ambient) == 20);
+            }
+            THEN("the simulated time is tracked") {
+                REQUIRE_THAT(network.elapsed(),
+                             Catch::Matchers::WithinAbs(1000, 0.2));
+            }
+        }
+        WHEN("the heater is overdriven") {
+            network.set_drive(block, 5.0);
+            network.advance(1);
+            THEN("the drive is limited to full power") {
+                REQUIRE_THAT(network.temperature(block),
+                             Catch::Matchers::WithinAbs(20 + (5.0 / 10), 0.02));
+            }
+        }
+        WHEN("time is advanced in pieces smaller than the step") {
+            auto sliced = parse(HEATED_BLOCK).value();
+            network.set_drive(block, 1.0);
+            sliced.set_drive(block, 1.0);
+            network.advance(10);
+            for (int i = 0; i < 1000; ++i) {
+                sliced.advance(0.01);
+            }
+            THEN("the result matches a single large advance") {
+                REQUIRE_THAT(sliced.temperature(block),
+                             Catch::Matchers::WithinAbs(
+                                 network.temperature(block), 0.01));
+            }
+        }
+    }
+    GIVEN("a peltier plate on a heatsink") {
+        auto network = parse(PELTIER).value();
+        auto plate = network.find("plate").value();
+        auto heatsink = network.find("heatsink").value();
+        WHEN("the plate is driven cold") {
+            network.set_drive(plate, -1.0);
+            network.advance(10);
+            THEN("the heat it removes warms the heatsink") {
+                REQUIRE(network.temperature(plate) < 20);
+                REQUIRE(network.temperature(heatsink) > 20);
+            }
+        }
+        WHEN("the heatsink coupling is increased") {
+            network.set_drive(plate, -1.0);
+            auto cooled = parse(PELTIER).value();
+            cooled.set_drive(plate, -1.0);
+            REQUIRE(cooled.set_conductance(network.find("ambient").value(),
+                                           heatsink, 20));
+            network.advance(100);
+            cooled.advance(100);
+            THEN("the heatsink stays cooler") {
+                REQUIRE(cooled.temperature(heatsink) <
+                        network.temperature(heatsink));
+            }
+        }
+    }
+    GIVEN("a node with a very short time constant") {
+        auto network = parse(
+                           "node ambient capacity=1 temperature=20 fixed\n"
+                           "node foil capacity=0.01 temperature=80\n"
+                           "link foil ambient 1\n")
+                           .value();
+        THEN("the step is shortened to keep the integration stable") {
+            REQUIRE(network.step_size() <= 0.01);
+        }
+        WHEN("time passes") {
+            network.advance(1);
+            THEN("the node relaxes to ambient without oscillating") {
+                REQUIRE_THAT(network.temperature(network.find("foil").value()),
+                             Catch::Matchers::WithinAbs(20, 0.001));
+            }
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "core/windowed_filter.hpp"
+
+namespace {
+// A speed trace shaped like the ones speed_stability.py records: a short
+// ramp into a setpoint followed by steady-state ripple, with a couple of
+// single-sample glitches of the kind the hall sensor occasionally produces.
+auto speed_trace() -> std::vector<int16_t> {
+    std::vector<int16_t> trace;
+    for (int16_t rpm = 0; rpm < 1000; rpm += 100) {
+        trace.push_back(rpm);
+    }
+    for (int i = 0; i < 64; ++i) {
+        trace.push_back(static_cast<int16_t>(1000 + ((i % 4) - 2) * 5));
+    }
+    trace[30] = 4000;
+    trace[50] = -1000;
+    return trace;
+}
+}  // namespace
+
+SCENARIO("running average filter") {
+    GIVEN("a running average with a window of 4") {
+        auto filter = windowed_filter::RunningAverage<int16_t, 32>(4);
+        REQUIRE(filter.window() == 4);
+        REQUIRE(filter.max_window() == 32);
+        REQUIRE(filter.average() == 0);
+        WHEN("adding fewer samples than the window") {
+            filter.add(10);
+            filter.add(20);
+            THEN("the average covers only those samples") {
+                REQUIRE(filter.count() == 2);
+                REQUIRE(filter.average() == 15);
+            }
+        }
+        WHEN("adding more samples than the window") {
+            for (int16_t sample : {100, 200, 300, 400, 500, 600}) {
+                filter.add(sample);
+            }
+            THEN("the average covers the most recent samples") {
+                REQUIRE(filter.count() == 4);
+                REQUIRE(filter.average() == 450);
+            }
+            AND_WHEN("changing the window") {
+                REQUIRE(filter.set_window(2));
+                THEN("old samples are discarded") {
+                    REQUIRE(filter.window() == 2);
+                    REQUIRE(filter.count() == 0);
+                    REQUIRE(filter.average() == 0);
+                }
+            }
+        }
+        WHEN("setting an invalid window") {
+            filter.add(8);
+            THEN("zero and oversized windows are rejected") {
+                REQUIRE(!filter.set_window(0));
+                REQUIRE(!filter.set_window(33));
+                REQUIRE(filter.window() == 4);
+                REQUIRE(filter.average() == 8);
+            }
+        }
+    }
+    GIVEN("a running average fed with extreme values") {
+        auto filter = windowed_filter::RunningAverage<int16_t, 32>();
+        WHEN("filling the window with the maximum sample value") {
+            for (size_t i = 0; i < 100; ++i) {
+                filter.add(INT16_MAX);
+            }
+            THEN("the sum doesn't overflow") {
+                REQUIRE(filter.average() == INT16_MAX);
+            }
+        }
+    }
+    GIVEN("a speed trace") {
+        auto trace = speed_trace();
+        WHEN("filtering it with the running average") {
+            auto filter = windowed_filter::RunningAverage<int16_t, 32>(8);
+            std::vector<int16_t> out;
+            for (auto sample : trace) {
+                filter.add(sample);
+                out.push_back(filter.average());
+            }
+            THEN("every output matches a direct average of the window") {
+                for (size_t i = 0; i < trace.size(); ++i) {
+                    size_t first = i + 1 >= 8 ? i + 1 - 8 : 0;
+                    int64_t sum = 0;
+                    for (size_t j = first; j <= i; ++j) {
+                        sum += trace[j];
+                    }
+                    auto direct = static_cast<int16_t>(
+                        sum / static_cast<int64_t>(i + 1 - first));
+                    REQUIRE(out[i] == direct);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("exponential average filter") {
+    GIVEN("an exponential average with alpha of 0.5") {
+        auto filter = windowed_filter::ExponentialAverage<double>(0.5);
+        WHEN("adding the first sample") {
+            auto value = filter.add(100);
+            THEN("the average is seeded with it") {
+                REQUIRE(value == Approx(100));
+            }
+            AND_WHEN("adding another sample") {
+                filter.add(200);
+                THEN("the output moves halfway towards it") {
+                    REQUIRE(filter.value() == Approx(150));
+                }
+            }
+        }
+        WHEN("setting an invalid alpha") {
+            THEN("it is rejected") {
+                REQUIRE(!filter.set_alpha(0));
+                REQUIRE(!filter.set_alpha(1.5));
+                REQUIRE(filter.alpha() == Approx(0.5));
+            }
+        }
+    }
+}
+
+SCENARIO("median of three filter") {
+    GIVEN("a median of three filter") {
+        auto filter = windowed_filter::MedianOfThree<int16_t>();
+        WHEN("adding fewer than three samples") {
+            filter.add(5);
+            THEN("the latest sample passes through") {
+                REQUIRE(filter.value() == 5);
+            }
+        }
+        WHEN("adding a single-sample spike") {
+            filter.add(10);
+            filter.add(10);
+            auto spike = filter.add(1000);
+            auto after = filter.add(10);
+            THEN("the spike is removed") {
+                REQUIRE(spike == 10);
+                REQUIRE(after == 10);
+            }
+        }
+        WHEN("adding a step") {
+            filter.add(10);
+            filter.add(10);
+            auto first = filter.add(50);
+            auto second = filter.add(50);
+            THEN("the step passes after one sample") {
+                REQUIRE(first == 10);
+                REQUIRE(second == 50);
+            }
+        }
+    }
+    GIVEN("a speed trace with glitches") {
+        auto trace = speed_trace();
+        WHEN("despiking then averaging it") {
+            auto despike = windowed_filter::MedianOfThree<int16_t>();
+            auto average = windowed_filter::RunningAverage<int16_t, 32>(8);
+            int16_t worst = 0;
+            for (size_t i = 0; i < trace.size(); ++i) {
+                average.add(despike.add(trace[i]));
+                if (i >= 24) {
+                    auto error = static_cast<int16_t>(
+                        std::abs(average.average() - 1000));
+                    worst = std::max(worst, error);
+                }
+            }
+            THEN("the steady-state output stays near the setpoint") {
+                REQUIRE(worst <= 10);
+            }
+        }
+    }
+}
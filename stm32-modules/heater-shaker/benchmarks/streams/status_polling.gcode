@@ -0,0 +1,24 @@
+# Synthetic stream, written by hand to resemble a protocol run: the host
+# polls temperature, speed and plate lock status while heating and shaking.
+# Replace it with captured host traffic when one is available.
+M115
+M241
+M105
+M123
+M243
+M241
+M104 S60
+M105
+M123
+M3 S500
+M123
+M105
+M123
+M105
+M241
+M3 S0
+M123
+M106
+M105
+M242
+M241
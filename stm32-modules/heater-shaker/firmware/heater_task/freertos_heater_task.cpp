@@ -7,7 +7,9 @@
 #include <array>
 
 #include "FreeRTOS.h"
+#include "firmware/firmware_task_stats.hpp"
 #include "firmware/freertos_message_queue.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "heater-shaker/heater_task.hpp"
 #include "heater-shaker/tasks.hpp"
 #include "heater_policy.hpp"
@@ -90,8 +92,15 @@ void run(void *param) {
         auto &queue = _task.get_message_queue();
         static_cast<void>(queue.try_send(messages::HandleNTCSetupError{}));
     }
+    auto &stats = firmware_task_stats::stats_for(tasks::TaskIndex::HEATER);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        local_tasks->heater_main_task.run_once(local_tasks->policy);
+        _heater_queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            local_tasks->heater_main_task.run_once(local_tasks->policy);
+        }
+        stats.record_queue_depth(_heater_queue.high_water_mark());
     }
 }
 
@@ -124,10 +133,13 @@ auto start() -> tasks::Task<TaskHandle_t,
     auto *handle = xTaskCreateStatic(run, "HeaterControl", _stack.size(),
                                      &_heater_tasks, 1, _stack.data(), &_data);
     _heater_queue.provide_handle(handle);
+    freertos_task_registry::register_task(handle, _stack.size());
     auto *hardware_handle = xTaskCreateStatic(
         run_hardware_task, "HeaterHardware", _hardware_stack.size(),
         &_heater_tasks, 1, _hardware_stack.data(), &_hardware_data);
     _heater_tasks.hardware_task_handle = hardware_handle;
+    freertos_task_registry::register_task(hardware_handle,
+                                          _hardware_stack.size());
     return tasks::Task<TaskHandle_t, decltype(_heater_tasks.heater_main_task)>{
         .handle = handle, .task = &_heater_tasks.heater_main_task};
 }
@@ -403,23 +403,26 @@ void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc) {
     }
 }
 
-bool heater_hardware_set_offsets(struct writable_offsets* to_write) {
+bool heater_hardware_program_offset(size_t addr_offset, uint64_t value) {
+    uint32_t ProgramAddress = OFFSETS_PAGE_ADDRESS + addr_offset; //addr_offset in bytes
+    HAL_StatusTypeDef status = HAL_FLASH_Unlock();
+    if (status == HAL_OK) {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, ProgramAddress, value);
+        if (HAL_FLASH_Lock() != HAL_OK) {
+            status = HAL_ERROR;
+        }
+    }
+    return (status == HAL_OK);
+}
+
+bool heater_hardware_erase_offsets() {
     FLASH_EraseInitTypeDef pageToErase = {.TypeErase = FLASH_TYPEERASE_PAGES, .PageAddress = OFFSETS_PAGE_ADDRESS, .NbPages = 1};
     uint32_t pageErrorPtr = 0; //pointer to variable  that contains the configuration information on faulty page in case of error
-    uint32_t ProgramAddress1 = OFFSETS_PAGE_ADDRESS + offsetof(struct writable_offsets, const_b); //offsetof returns bytes
-    uint32_t ProgramAddress2 = OFFSETS_PAGE_ADDRESS + offsetof(struct writable_offsets, const_c);
-    uint32_t ProgramAddress3 = OFFSETS_PAGE_ADDRESS + offsetof(struct writable_offsets, const_flag);
-
     HAL_StatusTypeDef status = HAL_FLASH_Unlock();
     if (status == HAL_OK) {
         status = HAL_FLASHEx_Erase(&pageToErase, &pageErrorPtr);
-        if (status == HAL_OK) {
-            status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, ProgramAddress1, to_write->const_b);
-            status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, ProgramAddress2, to_write->const_c);
-            status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, ProgramAddress3, to_write->const_flag);
-            if (status == HAL_OK) {
-                status = HAL_FLASH_Lock();
-            }
+        if (HAL_FLASH_Lock() != HAL_OK) {
+            status = HAL_ERROR;
         }
     }
     return (status == HAL_OK);
@@ -74,12 +74,6 @@ typedef enum {
     ERROR_OVERCURRENT = 11,
 } heatpad_cs_state;
 
-struct __attribute__((packed)) writable_offsets {
-    uint64_t const_b;
-    uint64_t const_c;
-    uint64_t const_flag;
-};
-
 typedef struct {
     void (*conversions_complete)(const conversion_results* results);
     void* hardware_internal;
@@ -94,7 +88,8 @@ void heater_hardware_release_pg_latch();
 void heater_hardware_power_disable(heater_hardware* hardware);
 HEATPAD_CIRCUIT_ERROR heater_hardware_power_set(heater_hardware* hardware,
                                                 uint16_t setting);
-bool heater_hardware_set_offsets(struct writable_offsets* to_write);
+bool heater_hardware_program_offset(size_t addr_offset, uint64_t value);
+bool heater_hardware_erase_offsets();
 uint64_t heater_hardware_get_offset(size_t addr_offset);
 
 #ifdef __cplusplus
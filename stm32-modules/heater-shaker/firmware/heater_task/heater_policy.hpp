@@ -15,8 +15,9 @@ class HeaterPolicy {
     [[nodiscard]] auto try_reset_power_good() -> bool;
     auto set_power_output(double relative_power) -> HEATPAD_CIRCUIT_ERROR;
     auto disable_power_output() -> void;
-    auto set_thermal_offsets(flash::OffsetConstants* constants) -> bool;
-    auto get_thermal_offsets() -> flash::OffsetConstants;
+    [[nodiscard]] auto config_flash_read(uint32_t offset) const -> uint64_t;
+    auto config_flash_program(uint32_t offset, uint64_t value) -> bool;
+    auto config_flash_erase() -> bool;
     // The latch hardware requires some amount of time where the latch is held
     // low. That time isn't very long (it's ns, this is digital logic) but it is
     // non-zero, and this is how long we can delay without busy waiting
@@ -19,7 +19,9 @@
 #include "usbd_desc.h"
 #pragma GCC diagnostic pop
 
+#include "firmware/firmware_task_stats.hpp"
 #include "firmware/freertos_message_queue.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "hal/double_buffer.hpp"
 #include "heater-shaker/host_comms_task.hpp"
 #include "heater-shaker/messages.hpp"
@@ -137,10 +139,20 @@ void run(void *param) {  // NOLINT(misc-unused-parameters)
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
         reinterpret_cast<uint8_t *>(_local_task.committed_uart_rx_buf_ptr),
         (uint16_t)(_local_task.uart_rx_buf.committed()->size()));
+    top_task->provide_task_stats(&firmware_task_stats::registry());
+    auto &stats =
+        firmware_task_stats::stats_for(tasks::TaskIndex::HOST_COMMS);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        char *tx_end =
-            top_task->run_once(local_task->tx_buf.accessible()->begin(),
-                               local_task->tx_buf.accessible()->end());
+        _comms_queue.wait_for_message();
+        char *tx_end = nullptr;
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            tx_end =
+                top_task->run_once(local_task->tx_buf.accessible()->begin(),
+                                   local_task->tx_buf.accessible()->end());
+        }
+        stats.record_queue_depth(_comms_queue.high_water_mark());
         if (!top_task->may_connect()) {
             USBD_Stop(&_local_task.usb_handle);
             UART_DeInit(&_local_task.uart_handle);
@@ -173,6 +185,7 @@ auto start()
     auto *handle = xTaskCreateStatic(run, "HostCommsControl", stack.size(),
                                      &_tasks, 1, stack.data(), &data);
     _comms_queue.provide_handle(handle);
+    freertos_task_registry::register_task(handle, stack.size());
     return tasks::Task<TaskHandle_t, decltype(_top_task)>{.handle = handle,
                                                           .task = &_top_task};
 }
@@ -20,7 +20,9 @@ extern "C" {
 }
 #pragma GCC diagnostic pop
 
+#include "firmware/firmware_task_stats.hpp"
 #include "firmware/freertos_message_queue.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "heater-shaker/motor_task.hpp"
 #include "heater-shaker/tasks.hpp"
 #include "motor_hardware.h"
@@ -85,8 +87,19 @@ void run(void *param) {
     auto message1 = messages::ClosePlateLockMessage{.from_startup = true};
     static_cast<void>(queue.try_send(message1, 10));
 
+    auto &stats = firmware_task_stats::stats_for(tasks::TaskIndex::MOTOR);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        _task.run_once(policy);
+        // A pass that a speed profile update woke up would time the wait
+        // along with the work, so only passes started by a message count
+        if (_task.speed_profile_running()) {
+            _task.run_once(policy);
+        } else {
+            _motor_queue.wait_for_message();
+            auto measure = task_stats::Measurement(stats, clock);
+            _task.run_once(policy);
+        }
+        stats.record_queue_depth(_motor_queue.high_water_mark());
     }
 }
 
@@ -114,6 +127,9 @@ auto start()
     _local_task.control_task = control_task_handle;
     _local_task.main_task = handle;
     _motor_queue.provide_handle(handle);
+    freertos_task_registry::register_task(handle, stack.size());
+    freertos_task_registry::register_task(control_task_handle,
+                                          control_task_stack.size());
     return tasks::Task<TaskHandle_t, decltype(_task)>{.handle = handle,
                                                       .task = &_task};
 }
@@ -17,9 +17,6 @@ static void Error_Handler();
 
 motor_hardware_handles *MOTOR_HW_HANDLE = NULL;
 
-static _Atomic int16_t motor_speed_buffer[MOTOR_SPEED_BUFFER_SIZE];
-static _Atomic size_t motor_speed_buffer_itr = 0;
-
 static void MX_NVIC_Init(void)
 {
   /* TIM1_BRK_TIM15_IRQn interrupt configuration */
@@ -815,7 +812,6 @@ void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef* htim_base)
 
 void motor_hardware_setup(motor_hardware_handles* handles) {
   MOTOR_HW_HANDLE = handles;
-  memset(motor_speed_buffer, 0, sizeof(motor_speed_buffer));
   MX_GPIO_Init();
   MX_ADC1_Init(&handles->adc1);
   MX_ADC2_Init(&handles->adc2);
@@ -896,21 +892,6 @@ void motor_hardware_plate_lock_brake(TIM_HandleTypeDef* tim3) {
   HAL_TIM_PWM_Start(tim3, PLATE_LOCK_IN_2_Chan);
 }
 
-void motor_hardware_add_rpm_measurement(int16_t speed) {
-    motor_speed_buffer[motor_speed_buffer_itr++] = speed;
-    if(motor_speed_buffer_itr == MOTOR_SPEED_BUFFER_SIZE) {
-        motor_speed_buffer_itr = 0;
-    }
-}
-
-int16_t motor_hardware_get_smoothed_rpm() {
-    int64_t sum = 0;
-    for(uint8_t itr = 0; itr < MOTOR_SPEED_BUFFER_SIZE; ++itr) {
-        sum += (int64_t)motor_speed_buffer[itr];
-    }
-    return (int16_t)(sum / MOTOR_SPEED_BUFFER_SIZE);
-}
-
 /******************************************************************************/
 /*                 STM32F3xx Peripherals Interrupt Handlers                   */
 /*  Add here the Interrupt Handler for the used peripheral(s) (PPP), for the  */
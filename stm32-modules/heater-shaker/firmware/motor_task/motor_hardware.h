@@ -39,22 +39,33 @@ void HAL_TIM_MspPostInit(TIM_HandleTypeDef* htim);
 
 /**
  * @brief To be called every time the motor control library updates its speed
- * measurement. This function adds new speed values to a circular buffer,
- * which can then be averaged to get a smoothed RPM value.
+ * measurement. This function adds new speed values to a despiking filter
+ * followed by a moving average, which can then be read to get a smoothed RPM
+ * value.
  *
- * @param speed The new speed measurement to add to the buffer
+ * @param speed The new speed measurement to add to the filter
  */
 void motor_hardware_add_rpm_measurement(int16_t speed);
 
 /**
- * @brief Gets the smoothed RPM value by averaging the circular buffer
- * maintained by \ref motor_hardware_add_rpm_measurement
+ * @brief Gets the smoothed RPM value from the moving average maintained by
+ * \ref motor_hardware_add_rpm_measurement
  *
  * @return int16_t of the averaged speed value. Must be converted to
  * correct units by the caller.
  */
 int16_t motor_hardware_get_smoothed_rpm();
 
+/**
+ * @brief Sets how many speed measurements the moving average spans. This
+ * discards the measurements currently held.
+ *
+ * @param samples The new window, between 1 and MOTOR_SPEED_BUFFER_SIZE
+ * @return true if the window was valid and applied, false otherwise
+ */
+bool motor_hardware_set_rpm_filter_window(uint16_t samples);
+
+// The largest (and default) moving average window, in speed measurements
 #define MOTOR_SPEED_BUFFER_SIZE (32)
 
 #define MC_HAL_IS_USED
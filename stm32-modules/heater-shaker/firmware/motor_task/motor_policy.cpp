@@ -14,10 +14,24 @@
 #pragma GCC diagnostic pop
 
 #include "heater-shaker/errors.hpp"
+#include "heater-shaker/speed_profile.hpp"
 #include "motor_policy.hpp"
 
 using namespace errors;
 
+static_assert(speed_profile::SpeedProfile::MIN_RPM ==
+                  MIN_APPLICATION_SPEED_RPM,
+              "Speed profiles must use the motor's speed limits");
+static_assert(speed_profile::SpeedProfile::MAX_RPM ==
+                  MAX_APPLICATION_SPEED_RPM,
+              "Speed profiles must use the motor's speed limits");
+static_assert(speed_profile::SpeedProfile::MIN_RAMP_RATE_RPM_PER_S ==
+                  MotorPolicy::MIN_RAMP_RATE_RPM_PER_S,
+              "Speed profiles must use the motor's ramp rate limits");
+static_assert(speed_profile::SpeedProfile::MAX_RAMP_RATE_RPM_PER_S ==
+                  MotorPolicy::MAX_RAMP_RATE_RPM_PER_S,
+              "Speed profiles must use the motor's ramp rate limits");
+
 MotorPolicy::MotorPolicy(motor_hardware_handles* handles)
     : hw_handles(handles) {}
 
@@ -90,9 +104,23 @@ auto MotorPolicy::set_ramp_rate(int32_t rpm_per_s) -> ErrorCode {
     return ErrorCode::NO_ERROR;
 }
 
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto MotorPolicy::set_rpm_filter_window(uint16_t samples) -> ErrorCode {
+    if (!motor_hardware_set_rpm_filter_window(samples)) {
+        return ErrorCode::MOTOR_ILLEGAL_FILTER_WINDOW;
+    }
+    return ErrorCode::NO_ERROR;
+}
+
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto MotorPolicy::delay_ticks(uint16_t ticks) -> void { vTaskDelay(ticks); }
 
+// The kernel ticks at 1kHz
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto MotorPolicy::get_tick_ms() const -> uint32_t {
+    return xTaskGetTickCount();
+}
+
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto MotorPolicy::plate_lock_set_power(float power) -> void {
     motor_hardware_plate_lock_on(&hw_handles->tim3, power);
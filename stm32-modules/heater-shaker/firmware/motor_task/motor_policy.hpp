@@ -33,11 +33,13 @@ class MotorPolicy {
     [[nodiscard]] auto get_target_rpm() const -> int16_t;
     auto stop() -> void;
     auto set_ramp_rate(int32_t rpm_per_s) -> errors::ErrorCode;
+    auto set_rpm_filter_window(uint16_t samples) -> errors::ErrorCode;
 
     auto homing_solenoid_disengage() -> void;
     auto homing_solenoid_engage(uint16_t current_ma) -> void;
 
     auto delay_ticks(uint16_t ticks) -> void;
+    [[nodiscard]] auto get_tick_ms() const -> uint32_t;
 
     auto plate_lock_set_power(float power) -> void;
     auto plate_lock_disable() -> void;
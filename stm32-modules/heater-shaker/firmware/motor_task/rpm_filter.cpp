@@ -0,0 +1,68 @@
+/*
+ * Speed measurement filter for the main motor.
+ *
+ * Measurements arrive from the motor control library's medium frequency
+ * task, which runs in interrupt context, and are read from the motor task.
+ * Each measurement first goes through a median-of-3 stage to drop single
+ * glitched hall readings and then into a running-sum moving average, so both
+ * adding a measurement and reading the smoothed value are constant time.
+ */
+#include <cstdint>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wvolatile"
+#pragma GCC diagnostic ignored "-Wregister"
+#include "motor_hardware.h"
+#include "stm32f3xx_hal.h"
+#pragma GCC diagnostic pop
+
+#include "core/windowed_filter.hpp"
+
+namespace {
+
+using SpeedAverage =
+    windowed_filter::RunningAverage<int16_t, MOTOR_SPEED_BUFFER_SIZE>;
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+windowed_filter::MedianOfThree<int16_t> speed_despike;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+SpeedAverage speed_average(MOTOR_SPEED_BUFFER_SIZE);
+
+// Blocks the measurement interrupt for the lifetime of the object. The
+// previous interrupt mask is restored rather than unconditionally
+// re-enabling, so this is safe to use from any context.
+class IrqGuard {
+  public:
+    IrqGuard() : _primask(__get_PRIMASK()) { __disable_irq(); }
+    ~IrqGuard() { __set_PRIMASK(_primask); }
+    IrqGuard(const IrqGuard&) = delete;
+    IrqGuard(IrqGuard&&) = delete;
+    auto operator=(const IrqGuard&) -> IrqGuard& = delete;
+    auto operator=(IrqGuard&&) -> IrqGuard& = delete;
+
+  private:
+    uint32_t _primask;
+};
+
+}  // namespace
+
+extern "C" {
+
+void motor_hardware_add_rpm_measurement(int16_t speed) {
+    speed_average.add(speed_despike.add(speed));
+}
+
+int16_t motor_hardware_get_smoothed_rpm() {
+    auto guard = IrqGuard();
+    return speed_average.average();
+}
+
+bool motor_hardware_set_rpm_filter_window(uint16_t samples) {
+    auto guard = IrqGuard();
+    if (!speed_average.set_window(samples)) {
+        return false;
+    }
+    speed_despike.reset();
+    return true;
+}
+}
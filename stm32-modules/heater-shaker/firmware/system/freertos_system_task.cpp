@@ -7,7 +7,9 @@
 
 #include "FreeRTOS.h"
 #include "core/timer.hpp"
+#include "firmware/firmware_task_stats.hpp"
 #include "firmware/freertos_message_queue.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/freertos_timer.hpp"
 #include "heater-shaker/errors.hpp"
 #include "heater-shaker/system_task.hpp"
@@ -63,9 +65,17 @@ static void run(void *param) {
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
     auto *task = reinterpret_cast<decltype(_task) *>(param);
     auto policy = SystemPolicy();
+    freertos_task_registry::register_kernel_tasks();
     _led_timer.start();
+    auto &stats = firmware_task_stats::stats_for(tasks::TaskIndex::SYSTEM);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        task->run_once(policy);
+        _system_queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            task->run_once(policy);
+        }
+        stats.record_queue_depth(_system_queue.high_water_mark());
     }
 }
 
@@ -75,6 +85,7 @@ auto start() -> tasks::Task<TaskHandle_t,
     auto *handle = xTaskCreateStatic(run, "SystemControl", stack.size(), &_task,
                                      1, stack.data(), &data);
     _system_queue.provide_handle(handle);
+    freertos_task_registry::register_task(handle, stack.size());
     return tasks::Task<TaskHandle_t, decltype(_task)>{.handle = handle,
                                                       .task = &_task};
 }
@@ -6,6 +6,7 @@
 #include "firmware/freertos_message_queue.hpp"
 #include "firmware/freertos_motor_task.hpp"
 #include "firmware/freertos_system_task.hpp"
+#include "firmware/task_stats_hardware.h"
 #include "heater-shaker/tasks.hpp"
 #include "system_stm32f3xx.h"
 
@@ -14,6 +15,7 @@ tasks::Tasks<FreeRTOSMessageQueue> tasks_aggregator;
 
 auto main() -> int {
     HardwareInit();
+    task_stats_hardware_init();
     auto system = system_control_task::start();
     auto heater = heater_control_task::start();
     auto motor = motor_control_task::start();
@@ -3,6 +3,7 @@
 #include <ranges>
 
 #include "FreeRTOS.h"
+#include "firmware/freertos_task_registry.hpp"
 #include "task.h"
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wvolatile"
@@ -44,3 +45,19 @@ auto SystemPolicy::check_I2C_ready(void) -> bool {
 auto SystemPolicy::delay_time_ms(uint16_t time_ms) -> void {
     vTaskDelay(pdMS_TO_TICKS(time_ms));
 }
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::get_task_count() const -> size_t {
+    return freertos_task_registry::task_count();
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::get_stack_usage(size_t index) const
+    -> task_memory::StackUsage {
+    return freertos_task_registry::stack_usage(index);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::get_ram_usage() const -> task_memory::RamUsage {
+    return freertos_task_registry::ram_usage();
+}
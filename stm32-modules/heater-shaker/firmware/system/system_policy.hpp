@@ -2,6 +2,7 @@
 
 #include <array>
 
+#include "core/task_memory.hpp"
 #include "firmware/serial.hpp"
 #include "heater-shaker/errors.hpp"
 #include "systemwide.h"
@@ -31,4 +32,8 @@ class SystemPolicy {
         -> errors::ErrorCode;
     auto check_I2C_ready(void) -> bool;
     auto delay_time_ms(uint16_t time_ms) -> void;
+    [[nodiscard]] auto get_task_count() const -> size_t;
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage;
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage;
 };
@@ -0,0 +1,17 @@
+#include "firmware/task_stats_hardware.h"
+
+#include "stm32f3xx.h"
+
+#define CYCLES_PER_US_DIVIDER (1000000U)
+
+void task_stats_hardware_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t task_stats_hardware_cycles(void) { return DWT->CYCCNT; }
+
+uint32_t task_stats_hardware_cycles_per_us(void) {
+    return SystemCoreClock / CYCLES_PER_US_DIVIDER;
+}
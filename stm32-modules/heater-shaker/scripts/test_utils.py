@@ -97,6 +97,21 @@ def set_heater_pid(ser: serial.Serial,
     guard_error(ser.readline(), b'M301')
 
 
+def heater_autotune(ser: serial.Serial, target: float, cycles: int = 4):
+    print(f'Autotuning heater around {target}C over {cycles} cycles')
+    ser.write(f'M303 S{target} C{cycles}\n'.encode())
+    guard_error(ser.readline(), b'M303')
+    while True:
+        res = ser.readline()
+        if res.startswith(b'async ERR'):
+            raise RuntimeError(res)
+        if res.startswith(b'async M303 DONE'):
+            break
+    print(res)
+    values = dict(field.split(b':') for field in res.split()[3:6])
+    return float(values[b'P']), float(values[b'I']), float(values[b'D'])
+
+
 def stable(data: List[Tuple[float, float]],
            target: float,
            criterion: float,
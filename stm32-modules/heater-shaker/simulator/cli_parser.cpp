@@ -1,8 +1,14 @@
 #include "simulator/cli_parser.hpp"
 
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
 #include <boost/program_options.hpp>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
 
 #include "simulator/sim_driver.hpp"
 #include "simulator/socket_sim_driver.hpp"
@@ -40,10 +46,11 @@ using namespace cli_parser;
     exit(1);
 }
 
-std::shared_ptr<sim_driver::SimDriver> cli_parser::get_sim_driver(
-    int num_args, char* args[]) {
+RT cli_parser::get_sim_driver(int num_args, char* args[]) {
     bool use_stdin = false;
     bool use_socket = false;
+    bool log_socket = false;
+    bool realtime = false;
     bool options_specified = num_args > 1;
 
     boost::program_options::options_description desc("Allowed options");
@@ -52,7 +59,11 @@ std::shared_ptr<sim_driver::SimDriver> cli_parser::get_sim_driver(
         "Use stdin to provide G-Codes")("socket",
                                         boost::program_options::value<
                                             std::string>(),
-                                        "Use socket to provide G-Codes");
+                                        "Use socket to provide G-Codes")(
+        "log-socket", boost::program_options::bool_switch(&log_socket),
+        "Print every line sent and received over the socket")(
+        "realtime", boost::program_options::bool_switch(&realtime),
+        "Thermal and motor data should run in real time");
 
     boost::program_options::variables_map vm;
     /*
@@ -83,11 +94,86 @@ std::shared_ptr<sim_driver::SimDriver> cli_parser::get_sim_driver(
     }
 
     if (use_stdin) {
-        return std::make_shared<stdin_sim_driver::StdinSimDriver>();
+        return RT(std::make_shared<stdin_sim_driver::StdinSimDriver>(),
+                  realtime);
     } else if (use_socket) {
-        return std::make_shared<socket_sim_driver::SocketSimDriver>(
-            vm["socket"].as<std::string>());
+        return RT(std::make_shared<socket_sim_driver::SocketSimDriver>(
+                      vm["socket"].as<std::string>(), log_socket),
+                  realtime);
     } else {
         neither_driver_error(desc);
     }
-}
\ No newline at end of file
+}
+
+bool cli_parser::check_realtime_environment_variable() {
+    constexpr const char realtime_var_name[] = "USE_REALTIME_SIM";
+    constexpr const char string_true[] = "true";
+    const auto* var_value = getenv(realtime_var_name);
+
+    if (!var_value || strlen(var_value) == 0) {
+        return false;
+    }
+
+    // Convert to lowercase
+    auto var_string = std::string(var_value);
+    boost::algorithm::to_lower(var_string);
+
+    return var_string.starts_with(string_true);
+}
+
+FarmOptions cli_parser::get_farm_options(int num_args, char* args[]) {
+    auto options = FarmOptions{.socket = "",
+                               .instances = 1,
+                               .threads = 0,
+                               .realtime = false,
+                               .log_socket = false};
+
+    boost::program_options::options_description desc("Allowed options");
+    desc.add_options()("help", "Show this help message")(
+        "socket", boost::program_options::value<std::string>(),
+        "Socket of the first instance; each instance uses the next port up")(
+        "instances",
+        boost::program_options::value<size_t>(&options.instances)
+            ->default_value(1),
+        "Number of simulated Heater-Shakers")(
+        "threads", boost::program_options::value<size_t>(&options.threads),
+        "Number of threads to share between the instances (default: one "
+        "per core, up to one per instance)")(
+        "realtime", boost::program_options::bool_switch(&options.realtime),
+        "Thermal and motor data should run in real time")(
+        "log-socket", boost::program_options::bool_switch(&options.log_socket),
+        "Print every line sent and received over the sockets");
+
+    boost::program_options::variables_map vm;
+    auto parser =
+        boost::program_options::command_line_parser(num_args, args)
+            .options(desc)
+            .style(boost::program_options::command_line_style::default_style &
+                   ~boost::program_options::command_line_style::allow_guessing)
+            .run();
+    boost::program_options::store(parser, vm);
+    boost::program_options::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        exit(0);
+    }
+    if (!vm.count("socket")) {
+        std::cerr << std::endl
+                  << "ERROR: The simulator farm needs the --socket option."
+                  << std::endl
+                  << std::endl;
+        std::cerr << desc << std::endl;
+        exit(1);
+    }
+    options.socket = vm["socket"].as<std::string>();
+    options.instances = std::max(options.instances, size_t(1));
+    if (options.threads == 0) {
+        options.threads =
+            std::min<size_t>(options.instances,
+                             std::max(std::thread::hardware_concurrency(), 1U));
+    }
+    options.realtime =
+        options.realtime || check_realtime_environment_variable();
+    return options;
+}
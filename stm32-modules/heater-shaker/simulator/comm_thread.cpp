@@ -1,6 +1,7 @@
 #include "simulator/comm_thread.hpp"
 
 #include <boost/asio.hpp>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <stop_token>
@@ -10,6 +11,7 @@
 #include "heater-shaker/host_comms_task.hpp"
 #include "heater-shaker/messages.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_cycle_clock.hpp"
 #include "simulator/sim_driver.hpp"
 
 using namespace comm_thread;
@@ -22,12 +24,23 @@ struct comm_thread::TaskControlBlock {
 };
 
 auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
-         std::shared_ptr<sim_driver::SimDriver> driver) -> void {
+         std::shared_ptr<sim_driver::SimDriver> driver,
+         std::shared_ptr<tasks::TaskStatsRegistry> stats) -> void {
+    tcb->task.provide_task_stats(stats.get());
+    auto& own_stats =
+        tasks::task_stats_for(*stats, tasks::TaskIndex::HOST_COMMS);
+    auto clock = sim_cycle_clock::SteadyCycleClock();
     tcb->queue.set_stop_token(st);
     std::string buffer(1024, 'c');
     while (!st.stop_requested()) {
         try {
-            auto wrote_to = tcb->task.run_once(buffer.begin(), buffer.end());
+            tcb->queue.wait_for_message();
+            auto wrote_to = buffer.begin();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                wrote_to = tcb->task.run_once(buffer.begin(), buffer.end());
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
             driver->write(std::string(buffer.begin(), wrote_to));
         } catch (const SimCommTask::Queue::StopDuringMsgWait sdmw) {
             return;
@@ -35,14 +48,65 @@ auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
     }
 }
 
-auto comm_thread::build(std::shared_ptr<sim_driver::SimDriver>&& driver)
+auto comm_thread::build(std::shared_ptr<sim_driver::SimDriver>&& driver,
+                       std::shared_ptr<tasks::TaskStatsRegistry> stats)
     -> tasks::Task<std::unique_ptr<std::jthread>, comm_thread::SimCommTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task{std::make_unique<std::jthread>(run, tcb, driver),
-                       &tcb->task};
+    return tasks::Task{
+        std::make_unique<std::jthread>(run, tcb, driver, std::move(stats)),
+        &tcb->task};
+}
+
+auto comm_thread::build(std::shared_ptr<sim_driver::SimDriver>&& driver,
+                       std::shared_ptr<tasks::TaskStatsRegistry> stats,
+                       sim_scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, comm_thread::SimCommTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    tcb->task.provide_task_stats(stats.get());
+    auto buffer = std::make_shared<std::string>(1024, 'c');
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, buffer, driver,
+         &own_stats =
+             tasks::task_stats_for(*stats, tasks::TaskIndex::HOST_COMMS),
+         stats]() {
+            auto clock = sim_cycle_clock::SteadyCycleClock();
+            auto wrote_to = buffer->begin();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                wrote_to = tcb->task.run_once(buffer->begin(), buffer->end());
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
+            driver->write(std::string(buffer->begin(), wrote_to));
+        });
+    return tasks::Task{std::unique_ptr<std::jthread>(), &tcb->task};
 }
 
 void comm_thread::handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
                                tasks::Tasks<SimulatorMessageQueue>& tasks) {
-    driver->read(tasks);
+    static constexpr uint32_t SEND_TIMEOUT_MS = 1000;
+    // Wait for space rather than dropping commands from a fast host
+    driver->read([&tasks](messages::IncomingMessageFromHost& message) {
+        if (!tasks.comms->get_message_queue().try_send(message,
+                                                       SEND_TIMEOUT_MS)) {
+            std::cerr << "Dropped a message: comms task is not responding"
+                      << std::endl;
+        }
+    });
+}
+
+void comm_thread::handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
+                               tasks::Tasks<SimulatorMessageQueue>& tasks,
+                               sim_scheduler::Scheduler& scheduler) {
+    // The scheduler hands each line to the comms task from its own thread,
+    // so a run in simulated time doesn't depend on when lines arrive
+    driver->read([&tasks,
+                  &scheduler](messages::IncomingMessageFromHost& message) {
+        scheduler.post_line(
+            message.buffer, message.limit,
+            [&tasks](const char* begin, const char* end) {
+                static_cast<void>(tasks.comms->get_message_queue().try_send(
+                    messages::IncomingMessageFromHost(begin, end)));
+            });
+    });
 }
@@ -0,0 +1,104 @@
+/**
+ * @file farm_main.cpp
+ * @brief Runs several simulated Heater-Shakers in one process.
+ *
+ * @details Every instance gets its own tasks, socket and serial number, and
+ * its tasks are registered with one of the schedulers of a shared
+ * \ref sim_farm::Farm. Only the socket readers get a thread per instance.
+ */
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heater-shaker/task_stats_registry.hpp"
+#include "heater-shaker/tasks.hpp"
+#include "simulator/cli_parser.hpp"
+#include "simulator/comm_thread.hpp"
+#include "simulator/heater_thread.hpp"
+#include "simulator/motor_thread.hpp"
+#include "simulator/sim_driver.hpp"
+#include "simulator/sim_farm.hpp"
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/simulator_queue.hpp"
+#include "simulator/socket_sim_driver.hpp"
+#include "simulator/system_thread.hpp"
+#include "simulator/thermal_network.hpp"
+
+struct Instance {
+    std::shared_ptr<sim_driver::SimDriver> driver = nullptr;
+    sim_scheduler::Scheduler* scheduler = nullptr;
+    tasks::Tasks<SimulatorMessageQueue> tasks = {};
+};
+
+static auto build_instance(sim_scheduler::Scheduler& scheduler,
+                           thermal_network::ThermalNetwork network,
+                           std::shared_ptr<sim_driver::SimDriver> driver,
+                           const std::string& serial_var_name)
+    -> std::unique_ptr<Instance> {
+    auto stats = std::make_shared<tasks::TaskStatsRegistry>(tasks::TASK_NAMES);
+    auto system =
+        system_thread::build(stats, scheduler, serial_var_name.c_str());
+    auto heater = heater_thread::build(std::move(network), stats, scheduler);
+    auto motor = motor_thread::build(stats, scheduler);
+    auto comms = comm_thread::build(std::shared_ptr(driver), stats, scheduler);
+    // The tasks keep a pointer to their registry, so it must be filled in
+    // where it will live
+    auto instance = std::make_unique<Instance>();
+    instance->driver = std::move(driver);
+    instance->scheduler = &scheduler;
+    instance->tasks.initialize(heater.task, comms.task, motor.task,
+                               system.task);
+    return instance;
+}
+
+auto main(int argc, char* argv[]) -> int {
+    auto options = cli_parser::get_farm_options(argc, argv);
+
+    auto network = thermal_network::load_from_environment(
+        "THERMAL_NETWORK_FILE", heater_thread::DEFAULT_THERMAL_NETWORK);
+    if (!network.has_value()) {
+        return 1;
+    }
+
+    auto farm = sim_farm::Farm(options.threads, options.realtime);
+    auto instances = std::vector<std::unique_ptr<Instance>>();
+    for (size_t i = 0; i < options.instances; ++i) {
+        auto url = sim_farm::instance_url(options.socket, i);
+        if (!url.has_value()) {
+            std::cerr << "Malformed url." << std::endl;
+            return 1;
+        }
+        instances.push_back(build_instance(
+            farm.next_scheduler(), network.value(),
+            std::make_shared<socket_sim_driver::SocketSimDriver>(
+                url.value(), options.log_socket),
+            sim_farm::instance_variable("SERIAL_NUMBER", i)));
+    }
+    std::cout << "Simulating " << instances.size() << " Heater-Shakers on "
+              << farm.threads() << " threads" << std::endl;
+
+    farm.start();
+    {
+        // Each reader returns when its connection is closed, without
+        // taking the other instances down with it
+        auto readers = std::vector<std::jthread>();
+        for (size_t i = 0; i < instances.size(); ++i) {
+            readers.emplace_back([i, &instance = instances[i]]() {
+                try {
+                    comm_thread::handle_input(
+                        std::shared_ptr(instance->driver), instance->tasks,
+                        *instance->scheduler);
+                } catch (const std::exception& e) {
+                    std::cerr << "Instance " << i
+                              << " disconnected: " << e.what() << std::endl;
+                }
+            });
+        }
+    }
+    farm.stop();
+
+    return 0;
+}
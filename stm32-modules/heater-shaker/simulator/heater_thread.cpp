@@ -1,5 +1,8 @@
 #include "simulator/heater_thread.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <stop_token>
@@ -10,10 +13,13 @@
 #include "heater-shaker/heater_task.hpp"
 #include "heater-shaker/messages.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_cycle_clock.hpp"
+#include "simulator/thermal_network.hpp"
 #include "systemwide.h"
 #include "thermistor_lookups.hpp"
 
 struct SimHeaterPolicy {
+    SimHeaterPolicy() { sim_config_page.fill(flash::Flash::ERASED); }
     [[nodiscard]] auto power_good() const -> bool { return true; }
     [[nodiscard]] auto try_reset_power_good() -> bool { return true; };
     auto set_power_output(double relative_power) -> HEATPAD_CIRCUIT_ERROR {
@@ -21,17 +27,24 @@ struct SimHeaterPolicy {
         return HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_NO_ERROR;
     };
     auto disable_power_output() -> void { power = 0; }
-    auto set_thermal_offsets(flash::OffsetConstants* constants) -> bool {
-        sim_stored_offsets = *constants;
+    [[nodiscard]] auto get_power_output() const -> double { return power; }
+    [[nodiscard]] auto config_flash_read(uint32_t offset) const
+        -> uint64_t {
+        return sim_config_page.at(offset / flash::Flash::DOUBLEWORD);
+    }
+    auto config_flash_program(uint32_t offset, uint64_t value) -> bool {
+        sim_config_page.at(offset / flash::Flash::DOUBLEWORD) &= value;
         return true;
-    };
-    auto get_thermal_offsets() -> flash::OffsetConstants {
-        return sim_stored_offsets;
-    };
+    }
+    auto config_flash_erase() -> bool {
+        sim_config_page.fill(flash::Flash::ERASED);
+        return true;
+    }
 
   private:
     double power = 0;
-    flash::OffsetConstants sim_stored_offsets = {};
+    std::array<uint64_t, flash::Flash::PAGE_SIZE / flash::Flash::DOUBLEWORD>
+        sim_config_page = {};
 };
 
 struct heater_thread::TaskControlBlock {
@@ -41,44 +54,120 @@ struct heater_thread::TaskControlBlock {
     SimHeaterTask task;
 };
 
+// The heater pad and board as the task sees them: the policy's drive goes
+// into the thermal network and the network's temperatures come back as
+// thermistor readings
+class SimHeaterPlant {
+  public:
+    using SimHeaterTask = heater_thread::SimHeaterTask;
+    static constexpr double CONTROL_PERIOD_SEC =
+        static_cast<double>(SimHeaterTask::CONTROL_PERIOD_TICKS) / 1000.0F;
+
+    explicit SimHeaterPlant(thermal_network::ThermalNetwork network)
+        : _network(std::move(network)),
+          _pad(thermal_network::require(_network, "pad")),
+          _board(thermal_network::require(_network, "board")) {}
+
+    // Run the network for one control period and send the readings
+    auto step(const SimHeaterPolicy& policy, SimHeaterTask::Queue& queue)
+        -> void {
+        _network.set_drive(_pad, policy.get_power_output());
+        _network.advance(CONTROL_PERIOD_SEC);
+        auto pad_adc = _converter.backconvert(_network.temperature(_pad));
+        auto conversion_message = messages::TemperatureConversionComplete{
+            .pad_a = pad_adc,
+            .pad_b = pad_adc,
+            .board = _converter.backconvert(_network.temperature(_board))};
+        static_cast<void>(
+            queue.try_send(messages::HeaterMessage(conversion_message)));
+    }
+
+  private:
+    thermal_network::ThermalNetwork _network;
+    thermal_network::NodeIndex _pad;
+    thermal_network::NodeIndex _board;
+    thermistor_conversion::Conversion<lookups::NTCG104ED104DTDSX> _converter{
+        SimHeaterTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+        SimHeaterTask::ADC_BIT_DEPTH,
+        SimHeaterTask::HEATER_PAD_NTC_DISCONNECT_THRESHOLD_ADC};
+};
+
 auto run(std::stop_token st,
-         std::shared_ptr<heater_thread::TaskControlBlock> tcb) -> void {
+         std::shared_ptr<heater_thread::TaskControlBlock> tcb,
+         thermal_network::ThermalNetwork network,
+         std::shared_ptr<tasks::TaskStatsRegistry> stats) -> void {
+    using SimHeaterTask = heater_thread::SimHeaterTask;
     auto policy = SimHeaterPolicy();
-    auto converter = thermistor_conversion::Conversion<
-        lookups::NTCG104ED104DTDSX>(
-        heater_thread::SimHeaterTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
-        heater_thread::SimHeaterTask::ADC_BIT_DEPTH,
-        heater_thread::SimHeaterTask::HEATER_PAD_NTC_DISCONNECT_THRESHOLD_ADC);
+    auto plant = SimHeaterPlant(std::move(network));
+    // The simulator runs in real time, so readings arrive once per control
+    // period of wall time and the task sleeps on its queue in between
+    using clock = SimHeaterTask::Queue::clock;
+    static constexpr auto CONTROL_PERIOD =
+        std::chrono::milliseconds(SimHeaterTask::CONTROL_PERIOD_TICKS);
+    auto next_reading = clock::now() + CONTROL_PERIOD;
+    auto& own_stats = tasks::task_stats_for(*stats, tasks::TaskIndex::HEATER);
+    auto cycle_clock = sim_cycle_clock::SteadyCycleClock();
     tcb->queue.set_stop_token(st);
-    auto conversion_message = messages::TemperatureConversionComplete{
-        .pad_a = converter.backconvert(25.0),
-        .pad_b = converter.backconvert(25.0),
-        .board = converter.backconvert(30),
-    };
-    tcb->queue.get_backing_queue().push(
-        messages::HeaterMessage(conversion_message));
     while (!st.stop_requested()) {
-        auto last_setpoint = tcb->task.get_setpoint();
         try {
-            tcb->task.run_once(policy);
-        } catch (const heater_thread::SimHeaterTask::Queue::StopDuringMsgWait&
-                     sdmw) {
+            if (clock::now() < next_reading &&
+                !tcb->queue.wait_for_message_until(next_reading)) {
+                continue;
+            }
+        } catch (const SimHeaterTask::Queue::StopDuringMsgWait& sdmw) {
             return;
         }
-        auto new_setpoint = tcb->task.get_setpoint();
-        if (last_setpoint != new_setpoint) {
-            auto conversion_message = messages::TemperatureConversionComplete{
-                .pad_a = converter.backconvert(tcb->task.get_setpoint()),
-                .pad_b = converter.backconvert(tcb->task.get_setpoint()),
-                .board = converter.backconvert(30)};
-            tcb->queue.get_backing_queue().push(
-                messages::HeaterMessage(conversion_message));
+        if (clock::now() >= next_reading) {
+            // If the thread fell behind, skip the missed periods rather
+            // than delivering them in a burst
+            next_reading =
+                std::max(next_reading + CONTROL_PERIOD, clock::now());
+            plant.step(policy, tcb->queue);
+        }
+        try {
+            {
+                auto measure = task_stats::Measurement(own_stats, cycle_clock);
+                tcb->task.run_once(policy);
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
+        } catch (const SimHeaterTask::Queue::StopDuringMsgWait& sdmw) {
+            return;
         }
     }
 }
 
-auto heater_thread::build()
+auto heater_thread::build(thermal_network::ThermalNetwork network,
+                         std::shared_ptr<tasks::TaskStatsRegistry> stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    return tasks::Task(std::make_unique<std::jthread>(
+                           run, tcb, std::move(network), std::move(stats)),
+                       &tcb->task);
+}
+
+auto heater_thread::build(thermal_network::ThermalNetwork network,
+                         std::shared_ptr<tasks::TaskStatsRegistry> stats,
+                         sim_scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
+    auto policy = std::make_shared<SimHeaterPolicy>();
+    auto plant = std::make_shared<SimHeaterPlant>(std::move(network));
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, policy,
+         &own_stats = tasks::task_stats_for(*stats, tasks::TaskIndex::HEATER),
+         stats]() {
+            auto cycle_clock = sim_cycle_clock::SteadyCycleClock();
+            {
+                auto measure = task_stats::Measurement(own_stats, cycle_clock);
+                tcb->task.run_once(*policy);
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
+        });
+    // Readings arrive once per control period of virtual time, and the
+    // task handles each one before the clock moves on
+    scheduler.add_periodic(
+        SimHeaterTask::CONTROL_PERIOD_TICKS,
+        [tcb, policy, plant]() { plant->step(*policy, tcb->queue); });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
 }
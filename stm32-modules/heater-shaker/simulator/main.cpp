@@ -1,33 +1,73 @@
 #include <iostream>
 #include <memory>
 
+#include "heater-shaker/task_stats_registry.hpp"
 #include "heater-shaker/tasks.hpp"
 #include "simulator/cli_parser.hpp"
 #include "simulator/comm_thread.hpp"
 #include "simulator/heater_thread.hpp"
 #include "simulator/motor_thread.hpp"
 #include "simulator/sim_driver.hpp"
+#include "simulator/sim_scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "simulator/system_thread.hpp"
+#include "simulator/thermal_network.hpp"
 
 using namespace std;
 
 int main(int argc, char *argv[]) {
-    auto sim_driver = cli_parser::get_sim_driver(argc, argv);
-    auto system = system_thread::build();
-    auto heater = heater_thread::build();
-    auto motor = motor_thread::build();
-    auto comms = comm_thread::build(std::move(sim_driver));
+    auto cli_ret = cli_parser::get_sim_driver(argc, argv);
+    auto sim_driver = cli_ret.first;
+    auto realtime =
+        cli_ret.second || cli_parser::check_realtime_environment_variable();
+    auto network = thermal_network::load_from_environment(
+        "THERMAL_NETWORK_FILE", heater_thread::DEFAULT_THERMAL_NETWORK);
+    if (!network.has_value()) {
+        return 1;
+    }
+    // In simulated time every task runs from one scheduler thread on a
+    // virtual clock, rather than from its own thread
+    auto scheduler = sim_scheduler::Scheduler();
+    auto stats = std::make_shared<tasks::TaskStatsRegistry>(tasks::TASK_NAMES);
+    auto system = realtime ? system_thread::build(stats)
+                           : system_thread::build(stats, scheduler);
+    auto heater =
+        realtime
+            ? heater_thread::build(std::move(network.value()), stats)
+            : heater_thread::build(std::move(network.value()), stats,
+                                   scheduler);
+    auto motor = realtime ? motor_thread::build(stats)
+                          : motor_thread::build(stats, scheduler);
+    auto comms =
+        realtime ? comm_thread::build(std::shared_ptr(sim_driver), stats)
+                 : comm_thread::build(std::shared_ptr(sim_driver), stats,
+                                      scheduler);
     auto tasks = tasks::Tasks<SimulatorMessageQueue>(heater.task, comms.task,
                                                      motor.task, system.task);
-    comm_thread::handle_input(std::move(sim_driver), tasks);
-    system.handle->request_stop();
-    heater.handle->request_stop();
-    motor.handle->request_stop();
-    comms.handle->request_stop();
-    system.handle->join();
-    heater.handle->join();
-    motor.handle->join();
-    comms.handle->join();
+
+    auto scheduler_thread = std::unique_ptr<std::jthread>();
+    if (!realtime) {
+        scheduler_thread = std::make_unique<std::jthread>(
+            [&scheduler](std::stop_token st) { scheduler.run(st); });
+    }
+
+    if (realtime) {
+        comm_thread::handle_input(std::move(sim_driver), tasks);
+    } else {
+        comm_thread::handle_input(std::move(sim_driver), tasks, scheduler);
+    }
+
+    // Only the handles of tasks that run in their own thread are populated
+    auto stop = [](std::unique_ptr<std::jthread>& thread) {
+        if (thread) {
+            thread->request_stop();
+            thread->join();
+        }
+    };
+    stop(scheduler_thread);
+    stop(system.handle);
+    stop(heater.handle);
+    stop(motor.handle);
+    stop(comms.handle);
     return 0;
 }
@@ -1,5 +1,6 @@
 #include "simulator/motor_thread.hpp"
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <stop_token>
@@ -8,6 +9,7 @@
 #include "heater-shaker/errors.hpp"
 #include "heater-shaker/motor_task.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_cycle_clock.hpp"
 #include "systemwide.h"
 
 using namespace motor_thread;
@@ -21,9 +23,16 @@ struct SimMotorPolicy {
     errors::ErrorCode set_serial_number_return = errors::ErrorCode::NO_ERROR;
 
   public:
+    SimMotorPolicy() = default;
+    // Tell the time from a scheduler's virtual clock rather than the wall
+    // clock
+    explicit SimMotorPolicy(const sim_scheduler::Scheduler& scheduler)
+        : scheduler(&scheduler) {}
+
     static constexpr int32_t DEFAULT_RAMP_RATE_RPM_PER_S = 1000;
     static constexpr int32_t MAX_RAMP_RATE_RPM_PER_S = 20000;
     static constexpr int32_t MIN_RAMP_RATE_RPM_PER_S = 1;
+    static constexpr uint16_t MAX_RPM_FILTER_WINDOW = 32;
 
     auto set_rpm(int16_t rpm) -> errors::ErrorCode {
         rpm_setpoint = rpm;
@@ -52,6 +61,14 @@ struct SimMotorPolicy {
         return errors::ErrorCode::NO_ERROR;
     }
 
+    auto set_rpm_filter_window(uint16_t samples) -> errors::ErrorCode {
+        // The simulated speed is noiseless, so the window is only validated
+        if (samples == 0 || samples > MAX_RPM_FILTER_WINDOW) {
+            return errors::ErrorCode::MOTOR_ILLEGAL_FILTER_WINDOW;
+        }
+        return errors::ErrorCode::NO_ERROR;
+    }
+
     auto homing_solenoid_disengage() const -> void {}
 
     auto homing_solenoid_engage(uint16_t current_ma) const -> void {
@@ -60,6 +77,18 @@ struct SimMotorPolicy {
 
     auto delay_ticks(uint16_t ticks) -> void { static_cast<void>(ticks); }
 
+    // Real time, so that speed profiles play out as they would on a device,
+    // unless the policy runs from a scheduler
+    [[nodiscard]] auto get_tick_ms() const -> uint32_t {
+        if (scheduler != nullptr) {
+            return static_cast<uint32_t>(scheduler->now());
+        }
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count());
+    }
+
     auto plate_lock_set_power(float power) -> void {
         sim_plate_lock_power = power;
         sim_plate_lock_enabled = true;
@@ -116,6 +145,9 @@ struct SimMotorPolicy {
     float sim_plate_lock_power = 0;
     bool sim_plate_lock_enabled = false;
     bool sim_plate_lock_braked = false;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    const sim_scheduler::Scheduler* scheduler = nullptr;
 };
 
 struct motor_thread::TaskControlBlock {
@@ -125,20 +157,62 @@ struct motor_thread::TaskControlBlock {
     SimMotorTask task;
 };
 
-auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
+auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
+         std::shared_ptr<tasks::TaskStatsRegistry> stats) -> void {
     auto policy = SimMotorPolicy();
+    auto& own_stats = tasks::task_stats_for(*stats, tasks::TaskIndex::MOTOR);
+    auto clock = sim_cycle_clock::SteadyCycleClock();
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
-            tcb->task.run_once(policy);
+            // As on the firmware, only passes started by a message are timed
+            if (tcb->task.speed_profile_running()) {
+                tcb->task.run_once(policy);
+            } else {
+                tcb->queue.wait_for_message();
+                auto measure = task_stats::Measurement(own_stats, clock);
+                tcb->task.run_once(policy);
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
         } catch (const SimMotorTask::Queue::StopDuringMsgWait& sdmw) {
             return;
         }
     }
 }
 
-auto motor_thread::build()
+auto motor_thread::build(std::shared_ptr<tasks::TaskStatsRegistry> stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    return tasks::Task{
+        std::make_unique<std::jthread>(run, tcb, std::move(stats)),
+        &tcb->task};
+}
+
+auto motor_thread::build(std::shared_ptr<tasks::TaskStatsRegistry> stats,
+                         sim_scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task{std::make_unique<std::jthread>(run, tcb), &tcb->task};
+    auto policy = std::make_shared<SimMotorPolicy>(scheduler);
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, policy,
+         &own_stats = tasks::task_stats_for(*stats, tasks::TaskIndex::MOTOR),
+         stats]() {
+            auto clock = sim_cycle_clock::SteadyCycleClock();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                tcb->task.run_once(*policy);
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
+        });
+    // A running speed profile is updated on the virtual clock. The task only
+    // runs once an update is due, so it never waits on its queue.
+    scheduler.add_periodic(
+        SimMotorTask::SPEED_PROFILE_TICK_MS, [tcb, policy]() {
+            if (tcb->task.speed_profile_running() &&
+                tcb->task.profile_update_wait_ms(*policy) == 0) {
+                tcb->task.run_once(*policy);
+            }
+        });
+    return tasks::Task{std::unique_ptr<std::jthread>(), &tcb->task};
 }
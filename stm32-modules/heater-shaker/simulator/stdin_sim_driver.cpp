@@ -19,7 +19,7 @@ void stdin_sim_driver::StdinSimDriver::write(const std::string& message) {
     std::cout << message;
 }
 void stdin_sim_driver::StdinSimDriver::read(
-    tasks::Tasks<SimulatorMessageQueue>& tasks) {
+    sim_driver::SendToCommsFunc&& send_to_comms) {
     auto linebuf = std::make_shared<std::string>(1024, 'c');
     while (true) {
         if (!std::cin.getline(linebuf->data(), linebuf->size() - 1, '\n')) {
@@ -30,6 +30,6 @@ void stdin_sim_driver::StdinSimDriver::read(
         linebuf->at(wrote_to - 1) = '\n';
         auto message = messages::IncomingMessageFromHost(
             linebuf->data(), linebuf->data() + wrote_to);
-        static_cast<void>(tasks.comms->get_message_queue().try_send(message));
+        send_to_comms(message);
     }
 }
@@ -9,8 +9,10 @@
 #include <stop_token>
 #include <thread>
 
+#include "core/task_memory.hpp"
 #include "heater-shaker/errors.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_cycle_clock.hpp"
 #include "simulator/simulator_utils.hpp"
 #include "systemwide.h"
 
@@ -57,6 +59,19 @@ struct SimSystemPolicy {
 
     auto check_I2C_ready(void) -> bool { return true; }
 
+    // The simulator's tasks run on host threads with no fixed stacks or
+    // static RAM budget to report
+    [[nodiscard]] auto get_task_count() const -> size_t { return 0; }
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage {
+        static_cast<void>(index);
+        return task_memory::StackUsage{
+            .name = "", .size_words = 0, .min_free_words = 0};
+    }
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage {
+        return task_memory::RamUsage{};
+    }
+
     auto delay_time_ms(uint16_t time_ms) -> void { last_delay = time_ms; }
 
     auto test_get_last_delay() const -> uint16_t { return last_delay; }
@@ -69,32 +84,68 @@ struct system_thread::TaskControlBlock {
     SimSystemTask task;
 };
 
-auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
-    using namespace std::literals::chrono_literals;
-    auto policy = SimSystemPolicy();
-
-    // Populate the serial number on startup, if provided
-    constexpr const char serial_var_name[] = "SERIAL_NUMBER";
+// Populate the serial number on startup, if provided
+static auto load_serial_number(SimSystemPolicy& policy,
+                               const char* serial_var_name = "SERIAL_NUMBER")
+    -> void {
     auto ret =
         simulator_utils::get_serial_number<SYSTEM_WIDE_SERIAL_NUMBER_LENGTH>(
             serial_var_name);
     if (ret.has_value()) {
         static_cast<void>(policy.set_serial_number(ret.value()));
     }
+}
 
+auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
+         std::shared_ptr<tasks::TaskStatsRegistry> stats) -> void {
+    using namespace std::literals::chrono_literals;
+    auto policy = SimSystemPolicy();
+    load_serial_number(policy);
+
+    auto& own_stats = tasks::task_stats_for(*stats, tasks::TaskIndex::SYSTEM);
+    auto clock = sim_cycle_clock::SteadyCycleClock();
     tcb->queue.set_stop_token(st);
 
     while (!st.stop_requested()) {
         try {
-            tcb->task.run_once(policy);
+            tcb->queue.wait_for_message();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                tcb->task.run_once(policy);
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
         } catch (const SimSystemTask::Queue::StopDuringMsgWait sdmw) {
             return;
         }
     }
 }
 
-auto system_thread::build()
+auto system_thread::build(std::shared_ptr<tasks::TaskStatsRegistry> stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    return tasks::Task(
+        std::make_unique<std::jthread>(run, tcb, std::move(stats)),
+        &tcb->task);
+}
+
+auto system_thread::build(std::shared_ptr<tasks::TaskStatsRegistry> stats,
+                          sim_scheduler::Scheduler& scheduler,
+                          const char* serial_var_name)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
+    auto policy = std::make_shared<SimSystemPolicy>();
+    load_serial_number(*policy, serial_var_name);
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, policy,
+         &own_stats = tasks::task_stats_for(*stats, tasks::TaskIndex::SYSTEM),
+         stats]() {
+            auto clock = sim_cycle_clock::SteadyCycleClock();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                tcb->task.run_once(*policy);
+            }
+            own_stats.record_queue_depth(tcb->queue.high_water_mark());
+        });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
 }
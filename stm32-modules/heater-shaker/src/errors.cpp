@@ -40,6 +40,12 @@ const char* const MOTOR_HOMING =
     "ERR127:main motor:currently homing (cannot interrupt) OK\n";
 const char* const FAULTY_LATCH_SENSORS =
     "ERR128:plate lock:issue with end stop sensors (both reading high) OK\n";
+const char* const MOTOR_ILLEGAL_FILTER_WINDOW =
+    "ERR129:main motor:illegal speed filter window OK\n";
+const char* const MOTOR_PROFILE_SEGMENT_INVALID =
+    "ERR130:main motor:invalid speed profile segment OK\n";
+const char* const MOTOR_PROFILE_EMPTY =
+    "ERR131:main motor:no speed profile to run OK\n";
 const char* const HEATER_THERMISTOR_A_DISCONNECTED =
     "ERR201:heater:thermistor a disconnected OK\n";
 const char* const HEATER_THERMISTOR_A_SHORT =
@@ -70,6 +76,8 @@ const char* const HEATER_HARDWARE_OPEN_CIRCUIT =
     "ERR215:heater:heatpad circuit open OK\n";
 const char* const HEATER_HARDWARE_OVERCURRENT_CIRCUIT =
     "ERR216:heater:heatpad circuit overcurrent OK\n";
+const char* const HEATER_AUTOTUNE_FAILED =
+    "ERR217:heater:autotune did not settle into an oscillation OK\n";
 const char* const SYSTEM_SERIAL_NUMBER_INVALID =
     "ERR301:system:serial number invalid format OK\n";
 const char* const SYSTEM_SERIAL_NUMBER_HAL_ERROR =
@@ -116,6 +124,9 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(PLATE_LOCK_NOT_CLOSED);
         HANDLE_CASE(MOTOR_HOMING);
         HANDLE_CASE(FAULTY_LATCH_SENSORS);
+        HANDLE_CASE(MOTOR_ILLEGAL_FILTER_WINDOW);
+        HANDLE_CASE(MOTOR_PROFILE_SEGMENT_INVALID);
+        HANDLE_CASE(MOTOR_PROFILE_EMPTY);
         HANDLE_CASE(HEATER_THERMISTOR_A_DISCONNECTED);
         HANDLE_CASE(HEATER_THERMISTOR_A_SHORT);
         HANDLE_CASE(HEATER_THERMISTOR_A_OVERTEMP);
@@ -131,6 +142,7 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(HEATER_HARDWARE_SHORT_CIRCUIT);
         HANDLE_CASE(HEATER_HARDWARE_OPEN_CIRCUIT);
         HANDLE_CASE(HEATER_HARDWARE_OVERCURRENT_CIRCUIT);
+        HANDLE_CASE(HEATER_AUTOTUNE_FAILED);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_INVALID);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_HAL_ERROR);
         HANDLE_CASE(SYSTEM_LED_I2C_NOT_READY);
@@ -13,7 +13,10 @@ TaskBuilder::TaskBuilder()
                       &system_task),
       motor_policy(),
       heater_policy(),
-      system_policy() {}
+      system_policy(),
+      task_stats(tasks::TASK_NAMES) {
+    host_comms_task.provide_task_stats(&task_stats);
+}
 
 auto TaskBuilder::build() -> std::shared_ptr<TaskBuilder> {
     return std::shared_ptr<TaskBuilder>(new TaskBuilder());
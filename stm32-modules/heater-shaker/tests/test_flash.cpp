@@ -1,7 +1,10 @@
+#include <cstring>
+
 #include "catch2/catch.hpp"
 #include "heater-shaker/flash.hpp"
 #include "heater-shaker/heater_task.hpp"
 #include "test/task_builder.hpp"
+#include "test/test_flash_policy.hpp"
 
 using namespace flash;
 
@@ -41,7 +44,7 @@ TEST_CASE("flash reading and writing") {
     GIVEN("a FLASH and constants B = 10 and C = -12") {
         auto tasks = TaskBuilder::build();
         auto flash = Flash();
-        OffsetConstants constants = {.b = 10.0F, .c = -12.0F, .flag = 0x01};
+        OffsetConstants constants = {.b = 10.0F, .c = -12.0F};
         WHEN("writing the constants") {
             REQUIRE(flash.set_offset_constants(constants,
                                                tasks->get_heater_policy()));
@@ -58,3 +61,168 @@ TEST_CASE("flash reading and writing") {
         }
     }
 }
+
+TEST_CASE("flash records") {
+    GIVEN("a FLASH with one set of constants written") {
+        auto policy = TestFlashPolicy();
+        auto flash = Flash();
+        REQUIRE(flash.set_offset_constants({.b = 1, .c = 2}, policy));
+        WHEN("writing new constants") {
+            REQUIRE(flash.set_offset_constants({.b = 3, .c = 4}, policy));
+            THEN("the page isn't erased") {
+                REQUIRE(policy._erases == 0);
+                REQUIRE(policy._programs == 2 * 3);
+                REQUIRE(!flash.erase_pending());
+            }
+            THEN("a new FLASH reads the newest constants") {
+                auto reloaded = Flash();
+                auto constants = reloaded.get_offset_constants(policy);
+                REQUIRE(constants.b == 3);
+                REQUIRE(constants.c == 4);
+            }
+        }
+        WHEN("a newer record was cut off before its trailer") {
+            policy._page[Flash::RECORD_LENGTH / Flash::DOUBLEWORD] = 0;
+            auto reloaded = Flash();
+            auto constants = reloaded.get_offset_constants(policy);
+            THEN("the last whole record is read") {
+                REQUIRE(constants.b == 1);
+                REQUIRE(constants.c == 2);
+            }
+            AND_WHEN("writing new constants") {
+                REQUIRE(reloaded.set_offset_constants({.b = 5, .c = 6},
+                                                      policy));
+                THEN("they go after the cut off record") {
+                    auto again = Flash();
+                    constants = again.get_offset_constants(policy);
+                    REQUIRE(constants.b == 5);
+                    REQUIRE(constants.c == 6);
+                    REQUIRE(policy._page[6] != Flash::ERASED);
+                }
+            }
+        }
+        WHEN("the constants of the record are corrupted") {
+            policy._page[1] ^= 1;
+            THEN("the defaults are read") {
+                auto reloaded = Flash();
+                auto constants = reloaded.get_offset_constants(policy);
+                REQUIRE_THAT(constants.b,
+                             Catch::Matchers::WithinAbs(-0.0259, 0.01));
+                REQUIRE_THAT(constants.c,
+                             Catch::Matchers::WithinAbs(0.6755, 0.01));
+            }
+        }
+    }
+    GIVEN("a FLASH with constants in the legacy layout") {
+        auto policy = TestFlashPolicy();
+        double b = 0.5;
+        double c = -1.5;
+        std::memcpy(&policy._page[0], &b, sizeof(b));
+        std::memcpy(&policy._page[1], &c, sizeof(c));
+        policy._page[2] = 1;
+        auto flash = Flash();
+        THEN("the legacy constants are read") {
+            auto constants = flash.get_offset_constants(policy);
+            REQUIRE(constants.b == b);
+            REQUIRE(constants.c == c);
+        }
+        WHEN("writing new constants") {
+            REQUIRE(flash.set_offset_constants({.b = 7, .c = 8}, policy));
+            THEN("a new FLASH reads them instead") {
+                auto reloaded = Flash();
+                auto constants = reloaded.get_offset_constants(policy);
+                REQUIRE(constants.b == 7);
+                REQUIRE(constants.c == 8);
+                REQUIRE(policy._erases == 0);
+            }
+        }
+    }
+    GIVEN("a FLASH with a full page") {
+        auto policy = TestFlashPolicy();
+        auto flash = Flash();
+        for (uint32_t i = 0; i < Flash::RECORDS; ++i) {
+            REQUIRE(flash.set_offset_constants(
+                {.b = static_cast<double>(i), .c = 1}, policy));
+        }
+        THEN("an erase is pending but hasn't happened") {
+            REQUIRE(flash.erase_pending());
+            REQUIRE(policy._erases == 0);
+        }
+        WHEN("erasing it") {
+            REQUIRE(flash.erase_if_full(policy));
+            THEN("the newest constants are kept at the start of the page") {
+                REQUIRE(policy._erases == 1);
+                REQUIRE(!flash.erase_pending());
+                auto reloaded = Flash();
+                auto constants = reloaded.get_offset_constants(policy);
+                REQUIRE(constants.b == Flash::RECORDS - 1);
+                REQUIRE(policy._page[3] == Flash::ERASED);
+            }
+        }
+        WHEN("writing again before the erase") {
+            REQUIRE(flash.set_offset_constants({.b = -1, .c = -2}, policy));
+            THEN("the page is erased first") {
+                REQUIRE(policy._erases == 1);
+                auto reloaded = Flash();
+                auto constants = reloaded.get_offset_constants(policy);
+                REQUIRE(constants.b == -1);
+                REQUIRE(constants.c == -2);
+            }
+        }
+    }
+}
+
+TEST_CASE("heater task erases a full flash page only while idle") {
+    GIVEN("a heater task with a full page of constants") {
+        auto tasks = TaskBuilder::build();
+        auto& policy = tasks->get_heater_policy();
+        auto set_msg = messages::SetOffsetConstantsMessage{
+            .id = 1, .b_set = true, .const_b = 1.0, .c_set = false};
+        auto set_temp = messages::SetTemperatureMessage{
+            .id = 2, .target_temperature = 50, .from_system = false};
+        tasks->get_heater_queue().backing_deque.push_back(set_temp);
+        tasks->run_heater_task();
+        for (uint32_t i = 0; i < Flash::RECORDS; ++i) {
+            tasks->get_heater_queue().backing_deque.push_back(set_msg);
+            tasks->run_heater_task();
+        }
+        THEN("the page isn't erased while heating") {
+            REQUIRE(policy._erases == 0);
+        }
+        WHEN("the heater is turned off") {
+            tasks->get_heater_queue().backing_deque.push_back(
+                messages::DeactivateHeaterMessage{.id = 3});
+            tasks->run_heater_task();
+            THEN("the page is erased") { REQUIRE(policy._erases == 1); }
+            THEN("the newest constants are written straight back") {
+                auto reloaded = Flash();
+                REQUIRE(reloaded.get_offset_constants(policy).b == 1.0);
+            }
+        }
+        WHEN("the heater is turned off while the motor runs") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::PlateLockComplete{.open = false, .closed = true});
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::SetRPMMessage{
+                    .id = 4, .target_rpm = 500, .from_system = false});
+            tasks->get_motor_policy().test_set_current_rpm(500);
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            tasks->get_heater_queue().backing_deque.push_back(
+                messages::DeactivateHeaterMessage{.id = 3});
+            tasks->run_heater_task();
+            THEN("the page isn't erased") { REQUIRE(policy._erases == 0); }
+            AND_WHEN("the motor stops") {
+                tasks->get_motor_queue().backing_deque.push_back(
+                    messages::SetRPMMessage{
+                        .id = 5, .target_rpm = 0, .from_system = false});
+                tasks->get_motor_policy().test_set_current_rpm(0);
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                tasks->get_heater_queue().backing_deque.push_back(
+                    messages::GetTemperatureMessage{.id = 6});
+                tasks->run_heater_task();
+                THEN("the page is erased") { REQUIRE(policy._erases == 1); }
+            }
+        }
+    }
+}
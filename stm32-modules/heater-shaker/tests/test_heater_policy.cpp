@@ -3,7 +3,8 @@
 #include <cstddef>
 
 TestHeaterPolicy::TestHeaterPolicy(bool pgood, bool can_reset)
-    : power_good_val(pgood),
+    : TestFlashPolicy(),
+      power_good_val(pgood),
       may_reset(can_reset),
       try_reset_calls(0),
       power(0),
@@ -65,13 +66,3 @@ auto TestHeaterPolicy::disable_power_output() -> void { enabled = false; }
 auto TestHeaterPolicy::last_power_setting() const -> double { return power; }
 
 auto TestHeaterPolicy::last_enable_setting() const -> bool { return enabled; }
-
-auto TestHeaterPolicy::set_thermal_offsets(flash::OffsetConstants* constants)
-    -> bool {
-    stored_offsets = *constants;
-    return true;
-}
-
-auto TestHeaterPolicy::get_thermal_offsets() -> flash::OffsetConstants {
-    return stored_offsets;
-}
@@ -881,3 +881,136 @@ SCENARIO("heater task error handling") {
         }
     }
 }
+
+SCENARIO("heater task autotunes the heater PID constants") {
+    GIVEN("a heater task with the pad at 40ºC") {
+        auto tasks = TaskBuilder::build();
+        auto &heater_queue = tasks->get_heater_queue();
+        auto &heater_policy = tasks->get_heater_policy();
+        auto &host_queue = tasks->get_host_comms_queue();
+        auto board_adc = _converter.backconvert(25);
+        auto send_reading = [&](double temp) {
+            auto adc = _converter.backconvert(temp);
+            heater_queue.backing_deque.push_back(
+                messages::TemperatureConversionComplete{
+                    .pad_a = adc, .pad_b = adc, .board = board_adc});
+            tasks->run_heater_task();
+        };
+        send_reading(40);
+        host_queue.backing_deque.clear();
+
+        auto take_ack = [&]() {
+            REQUIRE(host_queue.has_message());
+            auto msg = host_queue.backing_deque.front();
+            host_queue.backing_deque.pop_front();
+            REQUIRE(std::holds_alternative<messages::AcknowledgePrevious>(msg));
+            return std::get<messages::AcknowledgePrevious>(msg);
+        };
+
+        WHEN("starting with an out-of-range target") {
+            heater_queue.backing_deque.push_back(
+                messages::StartAutotuneMessage{
+                    .id = 2, .target = 99, .cycles = 4});
+            tasks->run_heater_task();
+            THEN("it is rejected") {
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::HEATER_ILLEGAL_TARGET_TEMPERATURE);
+            }
+        }
+        WHEN("starting with too many cycles") {
+            heater_queue.backing_deque.push_back(
+                messages::StartAutotuneMessage{
+                    .id = 2, .target = 50, .cycles = 100});
+            tasks->run_heater_task();
+            THEN("it is rejected") {
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::HEATER_CONSTANT_OUT_OF_RANGE);
+            }
+        }
+        WHEN("starting an autotune around 50ºC over two cycles") {
+            heater_queue.backing_deque.push_back(
+                messages::StartAutotuneMessage{
+                    .id = 2, .target = 50, .cycles = 2});
+            tasks->run_heater_task();
+            THEN("it is acked") {
+                auto ack = take_ack();
+                REQUIRE(ack.responding_to_id == 2);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+            AND_WHEN("a reading below the target arrives") {
+                send_reading(40);
+                THEN("the heater is fully on") {
+                    REQUIRE(heater_policy.last_enable_setting());
+                    REQUIRE(heater_policy.last_power_setting() == 1.0);
+                }
+            }
+            AND_WHEN("a reading above the target arrives") {
+                send_reading(60);
+                THEN("the heater is off") {
+                    REQUIRE(!heater_policy.last_enable_setting());
+                }
+            }
+            AND_WHEN("the pad oscillates around the target") {
+                host_queue.backing_deque.clear();
+                for (int i = 0; i < 4; ++i) {
+                    send_reading(60);
+                    send_reading(40);
+                }
+                THEN("the new constants are applied and reported") {
+                    std::vector<messages::AutotuneEvent> events;
+                    for (auto &msg : host_queue.backing_deque) {
+                        REQUIRE(!std::holds_alternative<messages::ErrorMessage>(
+                            msg));
+                        if (std::holds_alternative<messages::AutotuneEvent>(
+                                msg)) {
+                            events.push_back(
+                                std::get<messages::AutotuneEvent>(msg));
+                        }
+                    }
+                    REQUIRE(events.size() == 1);
+                    REQUIRE(events[0].kp > 0);
+                    auto &pid = tasks->get_heater_task().get_pid();
+                    REQUIRE_THAT(pid.kp(),
+                                 Catch::Matchers::WithinAbs(events[0].kp,
+                                                            0.0001));
+                    REQUIRE_THAT(pid.ki(),
+                                 Catch::Matchers::WithinAbs(events[0].ki,
+                                                            0.0001));
+                    REQUIRE_THAT(pid.kd(),
+                                 Catch::Matchers::WithinAbs(events[0].kd,
+                                                            0.0001));
+                }
+                THEN("the heater is turned off") {
+                    REQUIRE(!heater_policy.last_enable_setting());
+                }
+            }
+            AND_WHEN("the pad never reaches the target") {
+                host_queue.backing_deque.clear();
+                // One reading every control period for the whole timeout
+                for (int i = 0; i < 18010; ++i) {
+                    send_reading(40);
+                }
+                THEN("an autotune error is sent") {
+                    REQUIRE(host_queue.has_message());
+                    auto msg = host_queue.backing_deque.front();
+                    REQUIRE(
+                        std::holds_alternative<messages::ErrorMessage>(msg));
+                    REQUIRE(std::get<messages::ErrorMessage>(msg).code ==
+                            errors::ErrorCode::HEATER_AUTOTUNE_FAILED);
+                    REQUIRE(!heater_policy.last_enable_setting());
+                }
+            }
+            AND_WHEN("deactivating the heater") {
+                heater_queue.backing_deque.push_back(
+                    messages::DeactivateHeaterMessage{.id = 4});
+                tasks->run_heater_task();
+                host_queue.backing_deque.clear();
+                send_reading(40);
+                THEN("tuning stops and the heater stays off") {
+                    REQUIRE(!heater_policy.last_enable_setting());
+                    REQUIRE(!host_queue.has_message());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("SetRPMFilterWindow (M205.D) parser works",
+         "[gcode][parse][m205.d]") {
+    GIVEN("a string with prefix only") {
+        std::string to_parse = "M205.D S\n";
+
+        WHEN("calling parse") {
+            auto result = gcode::SetRPMFilterWindow::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with a prefix matching but bad data") {
+        std::string to_parse = "M205.D Sfoo\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetRPMFilterWindow::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with good data") {
+        std::string to_parse = "M205.D S16\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetRPMFilterWindow::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+
+            THEN("the data should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().samples == 16);
+                REQUIRE(result.second == to_parse.cbegin() + 10);
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(64, 'c');
+        WHEN("writing a response") {
+            auto written = gcode::SetRPMFilterWindow::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response is written") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M205.D OK\n"));
+                REQUIRE(written == buffer.begin() + 10);
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("SetSpeedProfileSegment (M244) parser works",
+         "[gcode][parse][m244]") {
+    GIVEN("a string with all parameters") {
+        std::string to_parse = "M244 I2 S1500 A2000 H10000\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetSpeedProfileSegment::parse(
+                to_parse.cbegin(), to_parse.cend());
+            THEN("the segment should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().index == 2);
+                REQUIRE(result.first.value().rpm == 1500);
+                REQUIRE(result.first.value().ramp_rpm_per_s == 2000);
+                REQUIRE(result.first.value().hold_ms == 10000);
+                REQUIRE(result.second == to_parse.cbegin() + 26);
+            }
+        }
+    }
+
+    GIVEN("a string missing the hold time") {
+        std::string to_parse = "M244 I0 S1500 A2000\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetSpeedProfileSegment::parse(
+                to_parse.cbegin(), to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with parameters out of order") {
+        std::string to_parse = "M244 I0 A2000 S1500 H100\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetSpeedProfileSegment::parse(
+                to_parse.cbegin(), to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with a bad speed") {
+        std::string to_parse = "M244 I0 Sfast A2000 H100\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetSpeedProfileSegment::parse(
+                to_parse.cbegin(), to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("GetSpeedProfileStatus (M246) response works",
+         "[gcode][response][m246]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(256, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetSpeedProfileStatus::write_response_into(
+                buffer.begin(), buffer.end(), true, 2, 4, 1500, 12500);
+            THEN("the response should be written in full") {
+                auto response_str = "M246 R:1 I:2 N:4 T:1500 E:12500 OK\n";
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith(response_str));
+                REQUIRE(written == buffer.begin() + strlen(response_str));
+            }
+        }
+    }
+
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetSpeedProfileStatus::write_response_into(
+                buffer.begin(), buffer.begin() + 7, false, 0, 1, 0, 0);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M246 R:ccccccccc";
+                response.at(6) = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written == buffer.begin() + 7);
+            }
+        }
+    }
+}
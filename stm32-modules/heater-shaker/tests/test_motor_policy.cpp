@@ -13,6 +13,7 @@ TestMotorPolicy::TestMotorPolicy(int16_t initial_rpm,
 
 auto TestMotorPolicy::set_rpm(int16_t rpm) -> errors::ErrorCode {
     target_rpm = rpm;
+    rpm_commands.push_back(rpm);
     return set_rpm_return;
 }
 
@@ -37,6 +38,19 @@ auto TestMotorPolicy::set_ramp_rate(int32_t new_ramp_rate)
 
 auto TestMotorPolicy::test_get_ramp_rate() -> int32_t { return ramp_rate; }
 
+auto TestMotorPolicy::set_rpm_filter_window(uint16_t samples)
+    -> errors::ErrorCode {
+    if (samples == 0 || samples > MAX_RPM_FILTER_WINDOW) {
+        return errors::ErrorCode::MOTOR_ILLEGAL_FILTER_WINDOW;
+    }
+    rpm_filter_window = samples;
+    return errors::ErrorCode::NO_ERROR;
+}
+
+auto TestMotorPolicy::test_get_rpm_filter_window() const -> uint16_t {
+    return rpm_filter_window;
+}
+
 auto TestMotorPolicy::test_set_ramp_rate_return_code(errors::ErrorCode error)
     -> void {
     set_ramp_rate_return = error;
@@ -68,10 +82,21 @@ auto TestMotorPolicy::test_get_last_delay() const -> uint16_t {
     return last_delay;
 }
 
+auto TestMotorPolicy::test_clear_last_delay() -> void { last_delay = 0; }
+
+auto TestMotorPolicy::test_get_rpm_commands() const
+    -> const std::vector<int16_t>& {
+    return rpm_commands;
+}
+
 auto TestMotorPolicy::delay_ticks(uint16_t ticks) -> void {
     last_delay = ticks;
 }
 
+auto TestMotorPolicy::get_tick_ms() const -> uint32_t { return tick_ms; }
+
+auto TestMotorPolicy::test_advance_time(uint32_t ms) -> void { tick_ms += ms; }
+
 auto TestMotorPolicy::plate_lock_set_power(float power) -> void {
     plate_lock_power = power;
     plate_lock_enabled = true;
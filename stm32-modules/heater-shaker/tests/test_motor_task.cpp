@@ -523,6 +523,40 @@ SCENARIO("motor task input error handling", "[motor]") {
                         errors::ErrorCode::MOTOR_ILLEGAL_RAMP_RATE);
             }
         }
+        WHEN("a command sets the speed filter window") {
+            auto message =
+                messages::SetRPMFilterWindowMessage{.id = 123, .samples = 8};
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(message));
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("the policy window is set and the command is acked") {
+                REQUIRE(
+                    tasks->get_motor_policy().test_get_rpm_filter_window() ==
+                    8);
+                auto response =
+                    tasks->get_host_comms_queue().backing_deque.front();
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.responding_to_id == 123);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+        }
+        WHEN("a command requests an invalid speed filter window") {
+            auto message =
+                messages::SetRPMFilterWindowMessage{.id = 123, .samples = 0};
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(message));
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("the motor task should respond with an error") {
+                auto response =
+                    tasks->get_host_comms_queue().backing_deque.front();
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_ILLEGAL_FILTER_WINDOW);
+                REQUIRE(
+                    tasks->get_motor_policy().test_get_rpm_filter_window() ==
+                    TestMotorPolicy::MAX_RPM_FILTER_WINDOW);
+            }
+        }
         WHEN(
             "a command requests an invalid speed but the motor controller is "
             "already in error state") {
@@ -1577,3 +1611,318 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
         }
     }
 }
+
+SCENARIO("motor task speed profile handling", "[motor][speed-profile]") {
+    GIVEN("a motor task with the plate lock closed") {
+        auto tasks = TaskBuilder::build();
+        tasks->get_motor_queue().backing_deque.push_back(
+            messages::MotorMessage(
+                messages::PlateLockComplete{.open = false, .closed = true}));
+        tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        WHEN("starting a profile with no segments") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(
+                    messages::StartSpeedProfileMessage{.id = 5}));
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("the task responds with an error") {
+                auto response =
+                    tasks->get_host_comms_queue().backing_deque.front();
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.responding_to_id == 5);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_PROFILE_EMPTY);
+                REQUIRE(tasks->get_motor_queue().backing_deque.empty());
+            }
+        }
+        WHEN("uploading a segment out of order") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 5,
+                    .index = 1,
+                    .rpm = 1000,
+                    .ramp_rpm_per_s = 1000,
+                    .hold_ms = 0}));
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("the task responds with an error") {
+                auto response =
+                    tasks->get_host_comms_queue().backing_deque.front();
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_PROFILE_SEGMENT_INVALID);
+            }
+        }
+        WHEN("uploading a segment faster than the motor can run") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 5,
+                    .index = 0,
+                    .rpm = speed_profile::SpeedProfile::MAX_RPM + 1,
+                    .ramp_rpm_per_s = 1000,
+                    .hold_ms = 0}));
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("the task responds with an error") {
+                auto response =
+                    tasks->get_host_comms_queue().backing_deque.front();
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_PROFILE_SEGMENT_INVALID);
+            }
+        }
+        WHEN("uploading a segment that ramps faster than the motor can") {
+            static constexpr int32_t RAMP_RATE =
+                speed_profile::SpeedProfile::MAX_RAMP_RATE_RPM_PER_S + 1;
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 5,
+                    .index = 0,
+                    .rpm = 1000,
+                    .ramp_rpm_per_s = RAMP_RATE,
+                    .hold_ms = 0}));
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("the task responds with an error") {
+                auto response =
+                    tasks->get_host_comms_queue().backing_deque.front();
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_PROFILE_SEGMENT_INVALID);
+                REQUIRE(!tasks->get_motor_task().speed_profile_running());
+            }
+        }
+        WHEN("starting a slow profile from a stop") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 1,
+                    .index = 0,
+                    .rpm = 100,
+                    .ramp_rpm_per_s = 1000,
+                    .hold_ms = 1000}));
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(
+                    messages::StartSpeedProfileMessage{.id = 2}));
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            tasks->get_host_comms_queue().backing_deque.clear();
+            AND_WHEN("the motor turns") {
+                tasks->get_motor_policy().test_set_current_rpm(100);
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("it is kickstarted like a SetRPM") {
+                    auto ack = std::get<messages::AcknowledgePrevious>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                    REQUIRE(tasks->get_motor_policy().test_get_rpm_commands() ==
+                            std::vector<int16_t>{
+                                motor_task::MotorTask<
+                                    TestMessageQueue>::MOTOR_KICKSTART_RPM,
+                                100});
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 100);
+                    REQUIRE(tasks->get_motor_task().get_state() ==
+                            motor_task::State::RUNNING);
+                }
+            }
+            AND_WHEN("the motor doesn't turn") {
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("the profile stops with the same error as a SetRPM") {
+                    auto ack = std::get<messages::AcknowledgePrevious>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(ack.with_error ==
+                            errors::ErrorCode::MOTOR_UNABLE_TO_MOVE);
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 0);
+                    REQUIRE(tasks->get_motor_task().get_state() ==
+                            motor_task::State::ERROR);
+                    REQUIRE(!tasks->get_motor_task().speed_profile_running());
+                }
+            }
+        }
+        WHEN("uploading and starting a two-segment profile") {
+            // Each segment lasts 60ms: a 50ms ramp then a 10ms hold
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 1,
+                    .index = 0,
+                    .rpm = 1000,
+                    .ramp_rpm_per_s = 20000,
+                    .hold_ms = 10}));
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 2,
+                    .index = 1,
+                    .rpm = 500,
+                    .ramp_rpm_per_s = 10000,
+                    .hold_ms = 10}));
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(
+                    messages::StartSpeedProfileMessage{.id = 3}));
+            tasks->get_motor_policy().test_set_current_rpm(1000);
+            for (int i = 0; i < 3; ++i) {
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            }
+            THEN("every command is acknowledged without error") {
+                auto& responses = tasks->get_host_comms_queue().backing_deque;
+                REQUIRE(responses.size() == 3);
+                for (uint32_t id = 1; id <= 3; ++id) {
+                    auto ack =
+                        std::get<messages::AcknowledgePrevious>(responses.at(
+                            static_cast<size_t>(id - 1)));
+                    REQUIRE(ack.responding_to_id == id);
+                    REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                }
+            }
+            THEN("the first segment is applied") {
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1000);
+                REQUIRE(tasks->get_motor_policy().test_get_ramp_rate() ==
+                        20000);
+                REQUIRE(tasks->get_motor_task().get_state() ==
+                        motor_task::State::RUNNING);
+                REQUIRE(tasks->get_motor_queue().backing_deque.empty());
+            }
+            AND_WHEN("updating before a tick has passed") {
+                tasks->get_motor_policy().test_advance_time(5);
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                tasks->get_motor_queue().backing_deque.push_back(
+                    messages::MotorMessage(
+                        messages::GetSpeedProfileStatusMessage{.id = 7}));
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("the profile has not advanced") {
+                    auto response =
+                        std::get<messages::GetSpeedProfileStatusResponse>(
+                            tasks->get_host_comms_queue().backing_deque.back());
+                    REQUIRE(response.total_elapsed_ms == 0);
+                }
+            }
+            AND_WHEN("running the first six ticks") {
+                tasks->get_host_comms_queue().backing_deque.clear();
+                tasks->get_motor_policy().test_clear_last_delay();
+                for (int i = 0; i < 6; ++i) {
+                    tasks->get_motor_policy().test_advance_time(10);
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                }
+                THEN("the second segment starts without the task sleeping") {
+                    REQUIRE(tasks->get_motor_policy().test_get_last_delay() ==
+                            0);
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 500);
+                    REQUIRE(tasks->get_motor_policy().test_get_ramp_rate() ==
+                            10000);
+                }
+                AND_WHEN("querying the profile status") {
+                    tasks->get_motor_policy().test_advance_time(10);
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                    tasks->get_motor_queue().backing_deque.push_back(
+                        messages::MotorMessage(
+                            messages::GetSpeedProfileStatusMessage{.id = 7}));
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                    THEN("the progress is reported") {
+                        auto& responses =
+                            tasks->get_host_comms_queue().backing_deque;
+                        auto response = std::get<
+                            messages::GetSpeedProfileStatusResponse>(
+                            responses.front());
+                        REQUIRE(response.responding_to_id == 7);
+                        REQUIRE(response.running);
+                        REQUIRE(response.segment == 1);
+                        REQUIRE(response.segment_count == 2);
+                        REQUIRE(response.segment_elapsed_ms == 10);
+                        REQUIRE(response.total_elapsed_ms == 70);
+                    }
+                }
+                AND_WHEN("running the remaining ticks") {
+                    for (int i = 0; i < 6; ++i) {
+                        tasks->get_motor_policy().test_advance_time(10);
+                        tasks->get_motor_task().run_once(
+                            tasks->get_motor_policy());
+                    }
+                    THEN("the profile ends at the last segment's speed") {
+                        REQUIRE(tasks->get_motor_policy().get_target_rpm() ==
+                                500);
+                        auto& responses =
+                            tasks->get_host_comms_queue().backing_deque;
+                        REQUIRE(responses.empty());
+                        tasks->get_motor_queue().backing_deque.push_back(
+                            messages::MotorMessage(
+                                messages::GetSpeedProfileStatusMessage{
+                                    .id = 7}));
+                        tasks->get_motor_task().run_once(
+                            tasks->get_motor_policy());
+                        REQUIRE(!std::get<
+                                     messages::GetSpeedProfileStatusResponse>(
+                                     responses.front())
+                                     .running);
+                    }
+                }
+            }
+            AND_WHEN("an update comes late") {
+                tasks->get_motor_policy().test_advance_time(65);
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                tasks->get_motor_queue().backing_deque.push_back(
+                    messages::MotorMessage(
+                        messages::GetSpeedProfileStatusMessage{.id = 7}));
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("the profile advances by the time that passed") {
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 500);
+                    auto response =
+                        std::get<messages::GetSpeedProfileStatusResponse>(
+                            tasks->get_host_comms_queue().backing_deque.back());
+                    REQUIRE(response.segment == 1);
+                    REQUIRE(response.segment_elapsed_ms == 5);
+                    REQUIRE(response.total_elapsed_ms == 65);
+                }
+            }
+            AND_WHEN("setting a speed while the profile runs") {
+                tasks->get_motor_queue().backing_deque.push_back(
+                    messages::MotorMessage(messages::SetRPMMessage{
+                        .id = 9, .target_rpm = 2000, .from_system = false}));
+                tasks->get_motor_policy().test_set_current_rpm(2000);
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("the profile stops") {
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 2000);
+                    tasks->get_motor_policy().test_advance_time(30);
+                    tasks->get_motor_queue().backing_deque.push_back(
+                        messages::MotorMessage(
+                            messages::GetSpeedProfileStatusMessage{.id = 7}));
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                    auto response =
+                        std::get<messages::GetSpeedProfileStatusResponse>(
+                            tasks->get_host_comms_queue().backing_deque.back());
+                    REQUIRE(!response.running);
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 2000);
+                }
+            }
+        }
+        WHEN("a segment is rejected by the motor while the profile runs") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 1,
+                    .index = 0,
+                    .rpm = 1000,
+                    .ramp_rpm_per_s = 20000,
+                    .hold_ms = 0}));
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(messages::SetSpeedProfileSegmentMessage{
+                    .id = 2,
+                    .index = 1,
+                    .rpm = 2000,
+                    .ramp_rpm_per_s = 20000,
+                    .hold_ms = 0}));
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::MotorMessage(
+                    messages::StartSpeedProfileMessage{.id = 3}));
+            tasks->get_motor_policy().test_set_current_rpm(1000);
+            for (int i = 0; i < 3; ++i) {
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            }
+            tasks->get_host_comms_queue().backing_deque.clear();
+            tasks->get_motor_policy().test_set_rpm_return_code(
+                errors::ErrorCode::MOTOR_ILLEGAL_SPEED);
+            tasks->get_motor_policy().test_advance_time(50);
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("the profile stops and reports the error") {
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 0);
+                auto error = std::get<messages::ErrorMessage>(
+                    tasks->get_host_comms_queue().backing_deque.front());
+                REQUIRE(error.code == errors::ErrorCode::MOTOR_ILLEGAL_SPEED);
+            }
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include "catch2/catch.hpp"
+#include "heater-shaker/speed_profile.hpp"
+
+using namespace speed_profile;
+
+SCENARIO("speed profile segment upload", "[speed-profile]") {
+    GIVEN("an empty speed profile") {
+        auto profile = SpeedProfile();
+        THEN("it can't be started") {
+            REQUIRE(!profile.start(0).has_value());
+            REQUIRE(!profile.running());
+        }
+        WHEN("writing a segment past the end") {
+            THEN("it is rejected") {
+                REQUIRE(!profile.set_segment(
+                    1, Segment{.rpm = 100, .ramp_rpm_per_s = 100}));
+                REQUIRE(profile.segment_count() == 0);
+            }
+        }
+        WHEN("writing a segment with no ramp rate") {
+            THEN("it is rejected") {
+                REQUIRE(!profile.set_segment(
+                    0, Segment{.rpm = 100, .ramp_rpm_per_s = 0}));
+            }
+        }
+        WHEN("writing a segment outside the motor's ramp rate range") {
+            THEN("it is rejected") {
+                REQUIRE(!profile.set_segment(
+                    0, Segment{.rpm = 100,
+                               .ramp_rpm_per_s =
+                                   SpeedProfile::MAX_RAMP_RATE_RPM_PER_S + 1}));
+                REQUIRE(profile.segment_count() == 0);
+            }
+            THEN("the limits themselves are accepted") {
+                REQUIRE(profile.set_segment(
+                    0, Segment{.rpm = 100,
+                               .ramp_rpm_per_s =
+                                   SpeedProfile::MIN_RAMP_RATE_RPM_PER_S}));
+                REQUIRE(profile.set_segment(
+                    1, Segment{.rpm = 100,
+                               .ramp_rpm_per_s =
+                                   SpeedProfile::MAX_RAMP_RATE_RPM_PER_S}));
+            }
+        }
+        WHEN("writing a segment outside the motor's speed range") {
+            THEN("it is rejected") {
+                REQUIRE(!profile.set_segment(
+                    0, Segment{.rpm = SpeedProfile::MAX_RPM + 1,
+                               .ramp_rpm_per_s = 100}));
+                REQUIRE(!profile.set_segment(
+                    0, Segment{.rpm = -100, .ramp_rpm_per_s = 100}));
+                REQUIRE(profile.segment_count() == 0);
+            }
+            THEN("the limits themselves are accepted") {
+                REQUIRE(profile.set_segment(
+                    0, Segment{.rpm = SpeedProfile::MIN_RPM,
+                               .ramp_rpm_per_s = 100}));
+                REQUIRE(profile.set_segment(
+                    1, Segment{.rpm = SpeedProfile::MAX_RPM,
+                               .ramp_rpm_per_s = 100}));
+            }
+        }
+        WHEN("writing segments in order") {
+            for (size_t i = 0; i < 3; ++i) {
+                REQUIRE(profile.set_segment(
+                    i, Segment{.rpm = 100, .ramp_rpm_per_s = 100}));
+            }
+            THEN("they are all held") { REQUIRE(profile.segment_count() == 3); }
+            AND_WHEN("rewriting the first segment") {
+                REQUIRE(profile.set_segment(
+                    0, Segment{.rpm = 200, .ramp_rpm_per_s = 100}));
+                THEN("the later segments are discarded") {
+                    REQUIRE(profile.segment_count() == 1);
+                }
+            }
+        }
+        WHEN("writing more segments than fit") {
+            for (size_t i = 0; i < SpeedProfile::MAX_SEGMENTS; ++i) {
+                REQUIRE(profile.set_segment(
+                    i, Segment{.rpm = 100, .ramp_rpm_per_s = 100}));
+            }
+            THEN("the extra segment is rejected") {
+                REQUIRE(!profile.set_segment(
+                    SpeedProfile::MAX_SEGMENTS,
+                    Segment{.rpm = 100, .ramp_rpm_per_s = 100}));
+            }
+        }
+    }
+}
+
+SCENARIO("speed profile execution", "[speed-profile]") {
+    GIVEN("a two-segment profile") {
+        auto profile = SpeedProfile();
+        // 1000rpm at 1000rpm/s from a stop: 1s ramp + 500ms hold
+        REQUIRE(profile.set_segment(
+            0, Segment{.rpm = 1000, .ramp_rpm_per_s = 1000, .hold_ms = 500}));
+        // 500rpm at 250rpm/s from 1000: 2s ramp + 1s hold
+        REQUIRE(profile.set_segment(
+            1, Segment{.rpm = 500, .ramp_rpm_per_s = 250, .hold_ms = 1000}));
+        WHEN("starting it") {
+            auto first = profile.start(0);
+            THEN("the first segment is returned") {
+                REQUIRE(first.has_value());
+                REQUIRE(first.value().rpm == 1000);
+                REQUIRE(profile.running());
+                REQUIRE(profile.segment_index() == 0);
+            }
+            THEN("segments can't be changed while running") {
+                REQUIRE(!profile.set_segment(
+                    0, Segment{.rpm = 1, .ramp_rpm_per_s = 1}));
+            }
+            AND_WHEN("ticking to just before the end of the first segment") {
+                auto next = profile.tick(1499);
+                THEN("the first segment is still running") {
+                    REQUIRE(!next.has_value());
+                    REQUIRE(profile.segment_index() == 0);
+                    REQUIRE(profile.segment_elapsed_ms() == 1499);
+                }
+                AND_WHEN("ticking past the end of the first segment") {
+                    next = profile.tick(11);
+                    THEN("the second segment starts") {
+                        REQUIRE(next.has_value());
+                        REQUIRE(next.value().rpm == 500);
+                        REQUIRE(profile.segment_index() == 1);
+                        REQUIRE(profile.segment_elapsed_ms() == 10);
+                        REQUIRE(profile.total_elapsed_ms() == 1510);
+                    }
+                    AND_WHEN("ticking past the end of the profile") {
+                        next = profile.tick(3000);
+                        THEN("the profile finishes") {
+                            REQUIRE(!next.has_value());
+                            REQUIRE(!profile.running());
+                            REQUIRE(profile.segment_index() == 1);
+                            REQUIRE(profile.segment_elapsed_ms() == 3000);
+                            REQUIRE(profile.total_elapsed_ms() == 4510);
+                        }
+                    }
+                }
+            }
+            AND_WHEN("ticking past several segments at once") {
+                auto next = profile.tick(5000);
+                THEN("the last segment is returned and the profile finishes") {
+                    REQUIRE(next.has_value());
+                    REQUIRE(next.value().rpm == 500);
+                    REQUIRE(!profile.running());
+                }
+            }
+            AND_WHEN("stopping it") {
+                profile.stop();
+                THEN("ticks have no effect") {
+                    REQUIRE(!profile.tick(2000).has_value());
+                    REQUIRE(profile.segment_index() == 0);
+                }
+            }
+        }
+    }
+}
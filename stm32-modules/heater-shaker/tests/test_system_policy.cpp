@@ -55,3 +55,26 @@ auto TestSystemPolicy::delay_time_ms(uint16_t time_ms) -> void {
 auto TestSystemPolicy::test_get_last_delay() const -> uint16_t {
     return last_delay;
 }
+
+auto TestSystemPolicy::get_task_count() const -> size_t {
+    return stacks.size();
+}
+
+auto TestSystemPolicy::get_stack_usage(size_t index) const
+    -> task_memory::StackUsage {
+    return stacks.at(index);
+}
+
+auto TestSystemPolicy::get_ram_usage() const -> task_memory::RamUsage {
+    return ram;
+}
+
+auto TestSystemPolicy::test_add_task_stack(task_memory::StackUsage stack)
+    -> void {
+    stacks.push_back(stack);
+}
+
+auto TestSystemPolicy::test_set_ram_usage(task_memory::RamUsage usage)
+    -> void {
+    ram = usage;
+}
@@ -152,6 +152,71 @@ SCENARIO("system task message passing") {
             }
         }
 
+        WHEN("sending get-task-memory messages as if from the host comms") {
+            for (uint32_t i = 0; i < 3; ++i) {
+                tasks->get_system_policy().test_add_task_stack(
+                    task_memory::StackUsage{.name = "Task",
+                                            .size_words = 100 + i,
+                                            .min_free_words = 10 + i});
+            }
+            tasks->get_system_policy().test_set_ram_usage(
+                task_memory::RamUsage{.data_bytes = 1,
+                                      .bss_bytes = 2,
+                                      .heap_peak_bytes = 3,
+                                      .heap_used_bytes = 4});
+            AND_WHEN("asking for the first page") {
+                auto message =
+                    messages::GetTaskMemoryMessage{.id = 55, .start = 0};
+                tasks->get_system_queue().backing_deque.push_back(
+                    messages::SystemMessage(message));
+                tasks->get_system_task().run_once(tasks->get_system_policy());
+                THEN("the response holds one task and the RAM usage") {
+                    auto host_message =
+                        tasks->get_host_comms_queue().backing_deque.front();
+                    REQUIRE(std::holds_alternative<
+                            messages::GetTaskMemoryResponse>(host_message));
+                    auto response = std::get<messages::GetTaskMemoryResponse>(
+                        host_message);
+                    REQUIRE(response.responding_to_id == message.id);
+                    REQUIRE(response.total == 3);
+                    REQUIRE(response.start == 0);
+                    REQUIRE(response.count ==
+                            messages::GetTaskMemoryResponse::MAX_TASKS);
+                    REQUIRE(response.stacks.at(0).size_words == 100);
+                    REQUIRE(response.stacks.at(0).min_free_words == 10);
+                    REQUIRE(response.ram.bss_bytes == 2);
+                    REQUIRE(response.ram.heap_used_bytes == 4);
+                }
+            }
+            AND_WHEN("asking for the last page") {
+                auto message =
+                    messages::GetTaskMemoryMessage{.id = 56, .start = 2};
+                tasks->get_system_queue().backing_deque.push_back(
+                    messages::SystemMessage(message));
+                tasks->get_system_task().run_once(tasks->get_system_policy());
+                THEN("the response holds the last task") {
+                    auto response = std::get<messages::GetTaskMemoryResponse>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(response.start == 2);
+                    REQUIRE(response.count == 1);
+                    REQUIRE(response.stacks.at(0).size_words == 102);
+                }
+            }
+            AND_WHEN("asking for a page past the last task") {
+                auto message =
+                    messages::GetTaskMemoryMessage{.id = 57, .start = 5};
+                tasks->get_system_queue().backing_deque.push_back(
+                    messages::SystemMessage(message));
+                tasks->get_system_task().run_once(tasks->get_system_policy());
+                THEN("the response holds no tasks") {
+                    auto response = std::get<messages::GetTaskMemoryResponse>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(response.total == 3);
+                    REQUIRE(response.count == 0);
+                }
+            }
+        }
+
         WHEN("receiving a set-LED message as if from the host task") {
             auto message = messages::SetLEDMessage{
                 .id = 123, .color = LED_COLOR::AMBER, .from_host = true};
@@ -0,0 +1,144 @@
+/**
+ * @file gcode_benchmark.hpp
+ * @brief Helpers for benchmarking the path a gcode takes through a module,
+ * from the host comms task to the task that handles it and back.
+ *
+ * @details Each module's benchmark builds its tasks with test queues and
+ * provides a function that sends one line to the comms task, runs every
+ * task until none of them has work left and collects the response. The
+ * helpers here replay a gcode stream through that function and
+ * report, for each kind of gcode, how long the round trip took and how
+ * many heap allocations it made.
+ *
+ * Allocations are counted by replacement global operator new and delete,
+ * defined in common/benchmarks/allocation_counter.cpp, which every
+ * benchmark links against.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gcode_benchmark {
+
+/** The number of heap allocations made by the process so far.*/
+auto allocations() -> uint64_t;
+
+/**
+ * @brief The name of the gcode on a line, used to group results: the text
+ * up to the first space or newline, such as \c M104 or \c M105.D
+ */
+inline auto gcode_name(std::string_view line) -> std::string {
+    auto end = line.find_first_of(" \r\n");
+    return std::string(line.substr(0, end));
+}
+
+/**
+ * @brief Read a gcode stream file: one command per line. Blank lines
+ * and lines starting with \c # are skipped. Each command keeps its
+ * newline, as it would when it arrives from the host.
+ */
+inline auto load_stream(std::istream& input) -> std::vector<std::string> {
+    auto stream = std::vector<std::string>();
+    auto line = std::string();
+    while (std::getline(input, line)) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        stream.push_back(line + "\n");
+    }
+    return stream;
+}
+
+class Recorder {
+  public:
+    auto record(const std::string& gcode, std::chrono::nanoseconds latency,
+                uint64_t allocations) -> void {
+        auto& entry = _entries[gcode];
+        entry.latencies_us.push_back(
+            std::chrono::duration<double, std::micro>(latency).count());
+        entry.allocations += allocations;
+        _total += latency;
+        ++_commands;
+    }
+
+    [[nodiscard]] auto commands() const -> size_t { return _commands; }
+
+    auto report(const char* title) -> void {
+        auto total_s = std::chrono::duration<double>(_total).count();
+        printf("%s: %zu commands, %.0f commands/s\n", title, _commands,
+               total_s > 0 ? static_cast<double>(_commands) / total_s : 0.0);
+        printf("%-10s %8s %10s %10s %12s\n", "gcode", "count", "p50 (us)",
+               "p99 (us)", "allocs/cmd");
+        for (auto& [gcode, entry] : _entries) {
+            auto& latencies = entry.latencies_us;
+            std::sort(latencies.begin(), latencies.end());
+            auto count = latencies.size();
+            printf("%-10s %8zu %10.2f %10.2f %12.2f\n", gcode.c_str(), count,
+                   latencies[count / 2], latencies[(count * 99) / 100],
+                   static_cast<double>(entry.allocations) /
+                       static_cast<double>(count));
+        }
+    }
+
+  private:
+    struct Entry {
+        std::vector<double> latencies_us = {};
+        uint64_t allocations = 0;
+    };
+    std::map<std::string, Entry> _entries = {};
+    std::chrono::nanoseconds _total = {};
+    size_t _commands = 0;
+};
+
+/**
+ * @brief Replay a gcode stream through a module.
+ *
+ * @param run_command Called as run_command(line, response): sends \c line
+ * to the module, runs it until it is idle and appends everything the comms
+ * task wrote to \c response, which has room reserved so that appending
+ * doesn't allocate
+ * @return The number of commands whose response did not end in OK
+ */
+template <typename RunCommand>
+auto replay(const std::vector<std::string>& stream, size_t repetitions,
+            RunCommand&& run_command, Recorder& recorder) -> size_t {
+    static constexpr size_t RESPONSE_SPACE = 1024;
+    auto names = std::vector<std::string>();
+    for (const auto& line : stream) {
+        names.push_back(gcode_name(line));
+    }
+    auto response = std::string();
+    response.reserve(RESPONSE_SPACE);
+    size_t failures = 0;
+    for (size_t rep = 0; rep < repetitions; ++rep) {
+        for (size_t i = 0; i < stream.size(); ++i) {
+            response.clear();
+            auto allocations_before = allocations();
+            auto start = std::chrono::steady_clock::now();
+            run_command(stream[i], response);
+            auto latency = std::chrono::steady_clock::now() - start;
+            recorder.record(names[i], latency,
+                            allocations() - allocations_before);
+            auto end = response.find_last_not_of(" \r\n");
+            if (end == std::string::npos || end < 1 ||
+                response.compare(end - 1, 2, "OK") != 0) {
+                if (rep == 0) {
+                    fprintf(stderr, "Unexpected response to %s: %s\n",
+                            names[i].c_str(), response.c_str());
+                }
+                ++failures;
+            }
+        }
+    }
+    return failures;
+}
+
+}  // namespace gcode_benchmark
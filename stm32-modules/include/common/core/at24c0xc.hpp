@@ -5,8 +5,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstring>  // For memcpy
+#include <iterator>
 
 #include "core/bit_utils.hpp"
 
@@ -14,6 +16,8 @@
 namespace at24c0xc {
 
 static constexpr const size_t PAGE_LENGTH = 8;
+// How many times to poll for the end of a page write before giving up
+static constexpr const size_t WRITE_POLL_ATTEMPTS = 100;
 
 template <typename Policy>
 concept AT24C0xC_Policy = requires(Policy &policy, uint8_t addr,
@@ -133,9 +137,84 @@ class AT24C0xC {
         return RT(value);
     }
 
+    /**
+     * @brief Write a run of bytes over consecutive pages, starting at the
+     * beginning of \c page. Write protection is lifted once for the whole
+     * run, and each page write is finished before the next one starts.
+     *
+     * @param page The first page to write
+     * @param data The bytes to write
+     * @param length How many bytes to write
+     * @param policy Instance of \c Policy
+     * @return true on success, false otherwise
+     */
+    template <std::contiguous_iterator Input, AT24C0xC_Policy Policy>
+    auto write_pages(uint8_t page, Input data, size_t length, Policy &policy)
+        -> bool {
+        if (!in_bounds(page, length)) {
+            return false;
+        }
+        std::array<uint8_t, PAGE_LENGTH + 1> buffer{};
+        bool ret = true;
+
+        policy.set_write_protect(false);
+        for (size_t offset = 0; ret && offset < length;
+             offset += PAGE_LENGTH) {
+            auto count = std::min(PAGE_LENGTH, length - offset);
+            auto address = static_cast<uint8_t>(page * PAGE_LENGTH + offset);
+            buffer.at(0) = address;
+            std::copy_n(std::next(data, static_cast<ptrdiff_t>(offset)), count,
+                        std::next(buffer.begin()));
+            ret = policy.i2c_write(_address, buffer.begin(), count + 1) &&
+                  wait_for_write(address, policy);
+        }
+        policy.set_write_protect(true);
+
+        return ret;
+    }
+
+    /**
+     * @brief Read a run of bytes over consecutive pages in one transaction,
+     * starting at the beginning of \c page.
+     *
+     * @param page The first page to read
+     * @param data Where to put the bytes
+     * @param length How many bytes to read
+     * @param policy Instance of \c Policy
+     * @return true on success, false otherwise
+     */
+    template <std::contiguous_iterator Output, AT24C0xC_Policy Policy>
+    [[nodiscard]] auto read_bytes(uint8_t page, Output data, size_t length,
+                                  Policy &policy) -> bool {
+        if (!in_bounds(page, length)) {
+            return false;
+        }
+        if (!policy.i2c_write(_address,
+                              static_cast<uint8_t>(page * PAGE_LENGTH))) {
+            return false;
+        }
+        return policy.i2c_read(_address, data, length);
+    }
+
     [[nodiscard]] auto size() const -> size_t { return _size; }
 
   private:
+    static auto in_bounds(uint8_t page, size_t length) -> bool {
+        return page < PAGES && length <= (PAGES - page) * PAGE_LENGTH;
+    }
+
+    // The EEPROM doesn't acknowledge its address until it has finished
+    // writing a page
+    template <AT24C0xC_Policy Policy>
+    auto wait_for_write(uint8_t address, Policy &policy) -> bool {
+        for (size_t i = 0; i < WRITE_POLL_ATTEMPTS; ++i) {
+            if (policy.i2c_write(_address, address)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     // Total size of the EEPROM
     static constexpr const size_t _size = PAGES * PAGE_LENGTH;
     // I2C address of the EEPROM, shifted 1 bit left from the
@@ -0,0 +1,58 @@
+/**
+ * @file crc32.hpp
+ * @brief The standard CRC-32 (as used by zlib and Ethernet), computed in
+ * software.
+ *
+ * @details This gives the same result as the CRC peripheral configuration in
+ * the startup app and as scripts/calculate_checksum.py, so it can check the
+ * integrity region of a firmware image.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+
+namespace crc32 {
+
+// Reversed form of the polynomial 0x04C11DB7
+static constexpr uint32_t POLYNOMIAL = 0xEDB88320;
+static constexpr uint32_t INITIAL_VALUE = 0xFFFFFFFF;
+
+constexpr auto make_table() -> std::array<uint32_t, 256> {
+    auto table = std::array<uint32_t, 256>{};
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1) ? ((value >> 1) ^ POLYNOMIAL) : (value >> 1);
+        }
+        table.at(i) = value;
+    }
+    return table;
+}
+
+static constexpr auto TABLE = make_table();
+
+/**
+ * @brief Add bytes to a CRC that is being computed in pieces. Start from
+ * \ref INITIAL_VALUE and pass the result through \ref finalize once every
+ * byte has been added.
+ */
+template <std::input_iterator Input, std::sentinel_for<Input> Limit>
+constexpr auto update(uint32_t crc, Input begin, Limit end) -> uint32_t {
+    for (; begin != end; ++begin) {
+        auto byte = static_cast<uint8_t>(*begin);
+        crc = TABLE.at((crc ^ byte) & 0xFF) ^ (crc >> 8);
+    }
+    return crc;
+}
+
+constexpr auto finalize(uint32_t crc) -> uint32_t { return ~crc; }
+
+/** @brief Compute the CRC of a whole range of bytes.*/
+template <std::input_iterator Input, std::sentinel_for<Input> Limit>
+constexpr auto compute(Input begin, Limit end) -> uint32_t {
+    return finalize(update(INITIAL_VALUE, begin, end));
+}
+
+}  // namespace crc32
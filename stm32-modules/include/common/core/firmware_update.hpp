@@ -0,0 +1,343 @@
+/**
+ * @file firmware_update.hpp
+ * @brief Stages a new firmware image in the backup partition while the
+ * running application keeps working.
+ *
+ * @details The host sends the image in chunks over the normal serial link.
+ * Each chunk is checked against its own CRC before it is programmed, and
+ * flash pages are erased as the image reaches them. Once every chunk is in,
+ * the image is read back and checked against the CRC of the whole upload,
+ * and then the same way the startup app checks a slot: the reset vector and
+ * the integrity region (see common/module-startup/README.md).
+ *
+ * Doublewords that are all ones are left erased rather than programmed, and
+ * the startup app's verified marker must be one of them: an image with data
+ * there is rejected, since the startup app couldn't mark it afterwards.
+ *
+ * Only an image that passes every check is committed, by setting the update
+ * request flag in the last doubleword of the backup partition. On the next
+ * reset the startup app copies the backup partition over the application and
+ * clears the flag. Until then nothing changes for the startup app: a reset
+ * in the middle of an upload just copies the running application back over
+ * the backup partition.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "core/crc32.hpp"
+
+namespace firmware_update {
+
+// Offsets within an image, from the start of its vector table
+static constexpr uint32_t RESET_VECTOR_OFFSET = 0x4;
+static constexpr uint32_t INTEGRITY_REGION_OFFSET = 0x200;
+// The startup app programs this doubleword once it has checked the image,
+// so the updater never does. Must match VERIFIED_MARKER_OFFSET in
+// startup_checks.h
+static constexpr uint32_t VERIFIED_MARKER_OFFSET = 0x3F8;
+static constexpr uint32_t APPLICATION_OFFSET = 0x400;
+
+// Flash is programmed one doubleword at a time
+static constexpr uint32_t PROGRAM_LENGTH = 8;
+
+static constexpr size_t MAX_CHUNK_LENGTH = 128;
+using Chunk = std::array<uint8_t, MAX_CHUNK_LENGTH>;
+
+// "UPDATERQ" in ASCII. Must match UPDATE_REQUEST_FLAG in startup_checks.h
+static constexpr uint64_t UPDATE_REQUEST_FLAG = 0x5152455441445055;
+
+/** Where images go and what they must look like.*/
+struct Layout {
+    // Size of the backup partition. The last doubleword holds the update
+    // request flag, so images can be at most this size minus PROGRAM_LENGTH.
+    uint32_t partition_size = 0;
+    uint32_t page_size = 0;
+    // The address an image runs from, i.e. the start of the main partition
+    uint32_t link_address = 0;
+    // The module name that the integrity region of an image must start with
+    const char* name = "";
+};
+
+enum class Result {
+    OK,
+    NOT_STARTED,
+    BAD_LENGTH,
+    BAD_OFFSET,
+    BAD_CHUNK_CRC,
+    BAD_IMAGE_CRC,
+    BAD_IMAGE,
+    FLASH_ERROR,
+};
+
+template <typename Policy>
+concept BackupFlashPolicy = requires(Policy& p, uint32_t offset,
+                                     uint64_t value) {
+    { p.backup_layout() } -> std::same_as<Layout>;
+    // Erase one page, numbered from the start of the backup partition
+    { p.backup_erase_page(offset) } -> std::same_as<bool>;
+    // Program the doubleword at an offset from the start of the partition
+    { p.backup_program(offset, value) } -> std::same_as<bool>;
+    // Read the doubleword at an offset from the start of the partition
+    { p.backup_read(offset) } -> std::same_as<uint64_t>;
+};
+
+/**
+ * @brief Decode a string of hex digits into bytes.
+ * @return The number of bytes written to \c output, or 0 if the input isn't
+ * an even number of hex digits or doesn't fit
+ */
+template <std::input_iterator Input, std::sentinel_for<Input> Limit,
+          std::output_iterator<uint8_t> Output>
+constexpr auto decode_hex(Input begin, Limit end, Output output,
+                          size_t max_length) -> size_t {
+    auto digit = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    };
+    size_t length = 0;
+    while (begin != end) {
+        auto high = digit(*begin);
+        ++begin;
+        if (begin == end || high < 0 || length == max_length) {
+            return 0;
+        }
+        auto low = digit(*begin);
+        ++begin;
+        if (low < 0) {
+            return 0;
+        }
+        *output = static_cast<uint8_t>((high << 4) | low);
+        ++output;
+        ++length;
+    }
+    return length;
+}
+
+class Updater {
+  public:
+    /**
+     * @brief Start a new upload, abandoning any other in progress.
+     * @param length The length of the whole image
+     * @param crc The CRC of the whole image
+     */
+    template <BackupFlashPolicy Policy>
+    auto begin(uint32_t length, uint32_t crc, Policy& policy) -> Result {
+        _started = false;
+        _layout = policy.backup_layout();
+        if (length <= APPLICATION_OFFSET ||
+            length > _layout.partition_size - PROGRAM_LENGTH) {
+            return Result::BAD_LENGTH;
+        }
+        // Erasing the page with the flag first makes sure that an older
+        // request can't commit whatever this upload leaves behind
+        if (!policy.backup_erase_page(last_page())) {
+            return Result::FLASH_ERROR;
+        }
+        _length = length;
+        _crc = crc;
+        _written = 0;
+        _erased_pages = 0;
+        _started = true;
+        return Result::OK;
+    }
+
+    /**
+     * @brief Program one chunk of the image. Chunks must arrive in order,
+     * and every chunk but the last must be a whole number of doublewords.
+     * A chunk that was already written is accepted again if it matches
+     * what is in flash, so the host can resend one whose reply it missed.
+     */
+    template <BackupFlashPolicy Policy>
+    auto write(uint32_t offset, const Chunk& data, size_t length, uint32_t crc,
+               Policy& policy) -> Result {
+        if (!_started) {
+            return Result::NOT_STARTED;
+        }
+        if (length == 0 || length > data.size() || offset > _length ||
+            length > _length - offset) {
+            return Result::BAD_LENGTH;
+        }
+        auto data_end =
+            std::next(data.cbegin(), static_cast<ptrdiff_t>(length));
+        if (crc32::compute(data.cbegin(), data_end) != crc) {
+            return Result::BAD_CHUNK_CRC;
+        }
+        if (offset < _written) {
+            if (offset + length <= _written &&
+                matches(offset, data, length, policy)) {
+                return Result::OK;
+            }
+            return Result::BAD_OFFSET;
+        }
+        if (offset != _written || (offset % PROGRAM_LENGTH) != 0) {
+            return Result::BAD_OFFSET;
+        }
+        for (size_t index = 0; index < length; index += PROGRAM_LENGTH) {
+            auto address = static_cast<uint32_t>(offset + index);
+            // Padding past the end of the chunk stays erased
+            uint64_t value = UINT64_MAX;
+            std::memcpy(&value, &data.at(index),
+                        std::min(size_t(PROGRAM_LENGTH), length - index));
+            if (address == VERIFIED_MARKER_OFFSET && value != UINT64_MAX) {
+                _started = false;
+                return Result::BAD_IMAGE;
+            }
+            if (!erase_through(address / _layout.page_size, policy)) {
+                _started = false;
+                return Result::FLASH_ERROR;
+            }
+            // A doubleword can only be programmed once per erase, even with
+            // all ones, so erased values are left as they are
+            if (value != UINT64_MAX && !policy.backup_program(address, value)) {
+                _started = false;
+                return Result::FLASH_ERROR;
+            }
+        }
+        _written += length;
+        return Result::OK;
+    }
+
+    /**
+     * @brief Check the whole image and, if it's good, request that the
+     * startup app installs it on the next reset.
+     */
+    template <BackupFlashPolicy Policy>
+    auto finish(Policy& policy) -> Result {
+        if (!_started) {
+            return Result::NOT_STARTED;
+        }
+        if (_written != _length) {
+            return Result::BAD_LENGTH;
+        }
+        if (checksum(0, _length, policy) != _crc) {
+            return Result::BAD_IMAGE_CRC;
+        }
+        if (!image_valid(policy)) {
+            return Result::BAD_IMAGE;
+        }
+        _started = false;
+        if (!policy.backup_program(_layout.partition_size - PROGRAM_LENGTH,
+                                   UPDATE_REQUEST_FLAG)) {
+            return Result::FLASH_ERROR;
+        }
+        return Result::OK;
+    }
+
+    [[nodiscard]] auto in_progress() const -> bool { return _started; }
+    [[nodiscard]] auto written() const -> uint32_t { return _written; }
+
+  private:
+    [[nodiscard]] auto last_page() const -> uint32_t {
+        return (_layout.partition_size - 1) / _layout.page_size;
+    }
+
+    template <BackupFlashPolicy Policy>
+    auto erase_through(uint32_t page, Policy& policy) -> bool {
+        for (; _erased_pages <= page; ++_erased_pages) {
+            // The last page was erased when the upload started
+            if (_erased_pages != last_page() &&
+                !policy.backup_erase_page(_erased_pages)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <BackupFlashPolicy Policy>
+    auto read_byte(uint32_t offset, Policy& policy) -> uint8_t {
+        auto doubleword = policy.backup_read(offset - offset % PROGRAM_LENGTH);
+        return static_cast<uint8_t>(doubleword >>
+                                    (8 * (offset % PROGRAM_LENGTH)));
+    }
+
+    template <BackupFlashPolicy Policy>
+    auto read_word(uint32_t offset, Policy& policy) -> uint32_t {
+        uint32_t word = 0;
+        for (uint32_t i = 0; i < sizeof(word); ++i) {
+            word |= static_cast<uint32_t>(read_byte(offset + i, policy))
+                    << (8 * i);
+        }
+        return word;
+    }
+
+    template <BackupFlashPolicy Policy>
+    auto matches(uint32_t offset, const Chunk& data, size_t length,
+                 Policy& policy) -> bool {
+        for (size_t i = 0; i < length; ++i) {
+            if (read_byte(offset + i, policy) != data.at(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <BackupFlashPolicy Policy>
+    auto checksum(uint32_t offset, uint32_t length, Policy& policy)
+        -> uint32_t {
+        auto crc = crc32::INITIAL_VALUE;
+        auto doubleword = std::array<uint8_t, PROGRAM_LENGTH>();
+        for (auto end = offset + length; offset < end;) {
+            auto aligned = offset - offset % PROGRAM_LENGTH;
+            auto value = policy.backup_read(aligned);
+            std::memcpy(doubleword.data(), &value, doubleword.size());
+            auto first = offset - aligned;
+            auto last = std::min(PROGRAM_LENGTH, end - aligned);
+            crc = crc32::update(
+                crc,
+                std::next(doubleword.cbegin(), static_cast<ptrdiff_t>(first)),
+                std::next(doubleword.cbegin(), static_cast<ptrdiff_t>(last)));
+            offset = aligned + last;
+        }
+        return crc32::finalize(crc);
+    }
+
+    // The same checks that the startup app makes of a slot
+    template <BackupFlashPolicy Policy>
+    auto image_valid(Policy& policy) -> bool {
+        static constexpr uint32_t UNPROGRAMMED_MASK = 0xFFFFFFF0;
+        auto reset_vector = read_word(RESET_VECTOR_OFFSET, policy);
+        if ((reset_vector & UNPROGRAMMED_MASK) == UNPROGRAMMED_MASK ||
+            (reset_vector & 1) == 0) {
+            return false;
+        }
+        auto image_crc = read_word(INTEGRITY_REGION_OFFSET, policy);
+        auto app_length = read_word(INTEGRITY_REGION_OFFSET + 4, policy);
+        auto app_start = read_word(INTEGRITY_REGION_OFFSET + 8, policy);
+        if (app_start != _layout.link_address + APPLICATION_OFFSET ||
+            app_length > _length - APPLICATION_OFFSET ||
+            checksum(APPLICATION_OFFSET, app_length, policy) != image_crc) {
+            return false;
+        }
+        auto name_offset = INTEGRITY_REGION_OFFSET + 12;
+        for (const char* c = _layout.name; *c != '\0'; ++c, ++name_offset) {
+            if (read_byte(name_offset, policy) != static_cast<uint8_t>(*c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Layout _layout = {};
+    bool _started = false;
+    uint32_t _length = 0;
+    uint32_t _crc = 0;
+    uint32_t _written = 0;
+    uint32_t _erased_pages = 0;
+};
+
+}  // namespace firmware_update
@@ -0,0 +1,262 @@
+/**
+ * @file kv_store.hpp
+ * @brief A small key-value store for calibration constants, kept in a region
+ * of a paged I2C EEPROM such as the AT24C0xC or the M24128.
+ *
+ * @details Every commit writes one complete record - a sequence number, a
+ * mask of which keys are set, the value of every key and a CRC-32 of the
+ * rest - into the next of a ring of slots. A slot is a whole number of
+ * EEPROM pages, written in one run with a single change of the write
+ * protection. The slots take turns, so each page sees only a fraction of the
+ * writes, and a record that is cut off by a reset fails its CRC and leaves
+ * the previous record as the newest one.
+ *
+ * \ref kv_store::KVStore::load reads every slot once, at startup, and keeps
+ * the values of the newest valid record in RAM. Reading a value after that
+ * never touches the bus. Setting values only changes RAM, so any number of
+ * them go to the EEPROM together in the next commit. Values that were set
+ * since the last commit are kept if a failed load is retried, so a reload
+ * never replaces them with the older values on the EEPROM.
+ *
+ * Slots are placed from the end of the region downward, so the first commit
+ * to a fresh device uses the pages at the end of the region.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+
+#include "core/bit_utils.hpp"
+#include "core/crc32.hpp"
+
+namespace kv_store {
+
+/** A device that can write and read runs of bytes from a page boundary.*/
+template <typename Device, typename Policy>
+concept PagedEEPROM = requires(Device& device, Policy& policy, uint8_t page,
+                               std::array<uint8_t, 8> buffer) {
+    {
+        device.write_pages(page, buffer.begin(), buffer.size(), policy)
+        } -> std::same_as<bool>;
+    {
+        device.read_bytes(page, buffer.begin(), buffer.size(), policy)
+        } -> std::same_as<bool>;
+};
+
+/** Values are stored in a doubleword each.*/
+template <typename T>
+concept Storable =
+    std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint64_t);
+
+/**
+ * @tparam Device The EEPROM driver
+ * @tparam PageLength The length of one page of \c Device
+ * @tparam FirstPage The first page of the region that the store may use
+ * @tparam PageCount The number of pages in the region
+ * @tparam Keys The number of keys. Keys are numbered from 0.
+ */
+template <typename Device, size_t PageLength, uint8_t FirstPage,
+          uint8_t PageCount, size_t Keys>
+requires(PageLength > 0 && Keys > 0 && Keys <= 16)
+class KVStore {
+  public:
+    static constexpr size_t KEYS = Keys;
+    static constexpr size_t VALUE_LENGTH = sizeof(uint64_t);
+    // Sequence number, then the mask of keys that are set
+    static constexpr size_t HEADER_LENGTH = 2 * sizeof(uint16_t);
+    static constexpr size_t CRC_LENGTH = sizeof(uint32_t);
+    static constexpr size_t RECORD_LENGTH =
+        HEADER_LENGTH + KEYS * VALUE_LENGTH + CRC_LENGTH;
+    static constexpr size_t SLOT_PAGES =
+        (RECORD_LENGTH + PageLength - 1) / PageLength;
+    static constexpr size_t SLOTS = PageCount / SLOT_PAGES;
+
+    static_assert(SLOTS >= 2,
+                  "The region must hold at least two records, so that a "
+                  "failed write never loses the last good one");
+
+    using Record = std::array<uint8_t, RECORD_LENGTH>;
+
+    KVStore() : _device() {}
+
+    /**
+     * @brief Read every slot and cache the newest valid record. Only the
+     * first successful call touches the EEPROM.
+     *
+     * @return true if every slot could be read. If not, the values that
+     * could be read are still cached, and the next call tries again.
+     */
+    template <typename Policy>
+    requires PagedEEPROM<Device, Policy>
+    auto load(Policy& policy) -> bool {
+        if (_loaded) {
+            return true;
+        }
+        bool read_all = true;
+        bool found = false;
+        Record record{};
+        for (size_t slot = 0; slot < SLOTS; ++slot) {
+            if (!_device.read_bytes(slot_page(slot), record.begin(),
+                                    record.size(), policy)) {
+                read_all = false;
+                continue;
+            }
+            uint16_t sequence = 0;
+            if (!valid(record, sequence)) {
+                continue;
+            }
+            if (!found || newer(sequence, _sequence)) {
+                found = true;
+                _sequence = sequence;
+                _slot = slot;
+                decode(record);
+            }
+        }
+        _empty = !found;
+        _loaded = read_all;
+        return read_all;
+    }
+
+    /** @return the cached value of \c key, if it is set.*/
+    template <Storable T>
+    [[nodiscard]] auto get(size_t key) const -> std::optional<T> {
+        if (key >= KEYS || !is_set(key)) {
+            return std::nullopt;
+        }
+        T ret;
+        std::memcpy(&ret, &_values.at(key), sizeof(T));
+        return ret;
+    }
+
+    /**
+     * @brief Change the cached value of \c key. Nothing is written until
+     * the next \ref commit.
+     */
+    template <Storable T>
+    auto set(size_t key, const T& value) -> bool {
+        if (key >= KEYS) {
+            return false;
+        }
+        uint64_t stored = 0;
+        std::memcpy(&stored, &value, sizeof(T));
+        _values.at(key) = stored;
+        _present |= static_cast<uint16_t>(1U << key);
+        _dirty |= static_cast<uint16_t>(1U << key);
+        return true;
+    }
+
+    /**
+     * @brief Write every cached value to the next slot in one run.
+     *
+     * @return true if the record was written. If not, the cached values
+     * are kept and the records on the EEPROM are unchanged apart from the
+     * slot being written, which was the oldest.
+     */
+    template <typename Policy>
+    requires PagedEEPROM<Device, Policy>
+    auto commit(Policy& policy) -> bool {
+        if (!load(policy)) {
+            // Without every slot, the next sequence number isn't known
+            return false;
+        }
+        auto sequence = static_cast<uint16_t>(_sequence + 1);
+        auto slot = _empty ? 0 : (_slot + 1) % SLOTS;
+        auto record = encode(sequence);
+        if (!_device.write_pages(slot_page(slot), record.begin(),
+                                 record.size(), policy)) {
+            return false;
+        }
+        _sequence = sequence;
+        _slot = slot;
+        _empty = false;
+        _dirty = 0;
+        return true;
+    }
+
+    /** @return whether every slot has been read since startup.*/
+    [[nodiscard]] auto loaded() const -> bool { return _loaded; }
+
+    /** @return whether no slot held a valid record when loaded.*/
+    [[nodiscard]] auto empty() const -> bool { return _empty; }
+
+    [[nodiscard]] auto is_set(size_t key) const -> bool {
+        return key < KEYS && (_present & (1U << key)) != 0;
+    }
+
+    /** @return the first page of a slot.*/
+    [[nodiscard]] static constexpr auto slot_page(size_t slot) -> uint8_t {
+        return static_cast<uint8_t>(FirstPage + PageCount -
+                                    (slot + 1) * SLOT_PAGES);
+    }
+
+    /** Access to the device, for reading data kept outside the store.*/
+    [[nodiscard]] auto device() -> Device& { return _device; }
+
+  private:
+    // Sequence numbers wrap, so the newer of two is the one ahead by less
+    // than half the range
+    static auto newer(uint16_t sequence, uint16_t than) -> bool {
+        return static_cast<int16_t>(sequence - than) > 0;
+    }
+
+    static auto valid(const Record& record, uint16_t& sequence) -> bool {
+        auto crc_start = std::prev(record.cend(), CRC_LENGTH);
+        uint32_t crc = 0;
+        static_cast<void>(
+            bit_utils::bytes_to_int(crc_start, record.cend(), crc));
+        if (crc32::compute(record.cbegin(), crc_start) != crc) {
+            return false;
+        }
+        static_cast<void>(
+            bit_utils::bytes_to_int(record.cbegin(), crc_start, sequence));
+        return true;
+    }
+
+    // Keys that were set since the last commit keep their cached values
+    auto decode(const Record& record) -> void {
+        auto input = std::next(record.cbegin(), sizeof(uint16_t));
+        uint16_t present = 0;
+        input = bit_utils::bytes_to_int(input, record.cend(), present);
+        _present = static_cast<uint16_t>((present & ~_dirty) |
+                                         (_present & _dirty));
+        for (size_t key = 0; key < KEYS; ++key) {
+            uint64_t value = 0;
+            input = bit_utils::bytes_to_int(input, record.cend(), value);
+            if ((_dirty & (1U << key)) == 0) {
+                _values.at(key) = value;
+            }
+        }
+    }
+
+    [[nodiscard]] auto encode(uint16_t sequence) const -> Record {
+        Record record{};
+        auto output = record.begin();
+        output = bit_utils::int_to_bytes(sequence, output, record.end());
+        output = bit_utils::int_to_bytes(_present, output, record.end());
+        for (const auto& value : _values) {
+            output = bit_utils::int_to_bytes(value, output, record.end());
+        }
+        auto crc = crc32::compute(record.begin(), output);
+        static_cast<void>(bit_utils::int_to_bytes(crc, output, record.end()));
+        return record;
+    }
+
+    Device _device;
+    std::array<uint64_t, KEYS> _values{};
+    uint16_t _present = 0;
+    // Keys set since the last commit
+    uint16_t _dirty = 0;
+    uint16_t _sequence = 0;
+    size_t _slot = 0;
+    bool _empty = true;
+    bool _loaded = false;
+};
+
+}  // namespace kv_store
@@ -6,15 +6,19 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <concepts>
 #include <cstring>
+#include <iterator>
 
 #include "core/bit_utils.hpp"
 
 namespace m24128 {
 
 static constexpr const size_t PAGE_LENGTH = 64;
+// How many times to poll for the end of a page write before giving up
+static constexpr const size_t WRITE_POLL_ATTEMPTS = 100;
 
 template <typename Policy>
 concept M24128_Policy = requires(Policy &policy, uint8_t addr,
@@ -91,20 +95,97 @@ class M24128 {
         return RT(value);
     }
 
+    /**
+     * @brief Write a run of bytes over consecutive pages, starting at the
+     * beginning of \c page. Write protection is lifted once for the whole
+     * run, and each page write is finished before the next one starts.
+     *
+     * @param page The first page to write
+     * @param data The bytes to write
+     * @param length How many bytes to write
+     * @param policy Instance of \c Policy
+     * @return true on success, false otherwise
+     */
+    template <std::contiguous_iterator Input, M24128_Policy Policy>
+    auto write_pages(uint8_t page, Input data, size_t length, Policy &policy)
+        -> bool {
+        if (!in_bounds(page, length)) {
+            return false;
+        }
+        bool ret = true;
+
+        policy.set_write_protect(false);
+        for (size_t offset = 0; ret && offset < length;
+             offset += PAGE_LENGTH) {
+            auto count = std::min(PAGE_LENGTH, length - offset);
+            set_address(static_cast<uint16_t>(page * PAGE_LENGTH + offset));
+            std::copy_n(std::next(data, static_cast<ptrdiff_t>(offset)), count,
+                        std::next(_buffer.begin(), ADDRESS_BYTES));
+            ret = policy.i2c_write(_address, _buffer.begin(),
+                                   count + ADDRESS_BYTES) &&
+                  wait_for_write(policy);
+        }
+        policy.set_write_protect(true);
+
+        return ret;
+    }
+
+    /**
+     * @brief Read a run of bytes over consecutive pages in one transaction,
+     * starting at the beginning of \c page.
+     *
+     * @param page The first page to read
+     * @param data Where to put the bytes
+     * @param length How many bytes to read
+     * @param policy Instance of \c Policy
+     * @return true on success, false otherwise
+     */
+    template <std::contiguous_iterator Output, M24128_Policy Policy>
+    [[nodiscard]] auto read_bytes(uint8_t page, Output data, size_t length,
+                                  Policy &policy) -> bool {
+        if (!in_bounds(page, length)) {
+            return false;
+        }
+        set_address(static_cast<uint16_t>(page * PAGE_LENGTH));
+        if (!policy.i2c_write(_address, _buffer.begin(), ADDRESS_BYTES)) {
+            return false;
+        }
+        return policy.i2c_read(_address, data, length);
+    }
+
   private:
+    static auto in_bounds(uint8_t page, size_t length) -> bool {
+        return page < PAGES && length <= (PAGES - page) * PAGE_LENGTH;
+    }
+
     auto populate_address(uint8_t page) -> bool {
         if (page > PAGES) {
             return false;
         }
-        uint16_t start_addr = page * PAGE_LENGTH;
+        set_address(page * PAGE_LENGTH);
+
+        return true;
+    }
+
+    auto set_address(uint16_t start_addr) -> void {
         // MSB is first, followed by LSB
 
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
         _buffer.at(0) = static_cast<uint8_t>((start_addr & 0xFF00) >> 8);
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
         _buffer.at(1) = static_cast<uint8_t>((start_addr)&0xFF);
+    }
 
-        return true;
+    // The EEPROM doesn't acknowledge its address until it has finished
+    // writing a page. The address in the buffer is still the one written.
+    template <M24128_Policy Policy>
+    auto wait_for_write(Policy &policy) -> bool {
+        for (size_t i = 0; i < WRITE_POLL_ATTEMPTS; ++i) {
+            if (policy.i2c_write(_address, _buffer.begin(), ADDRESS_BYTES)) {
+                return true;
+            }
+        }
+        return false;
     }
 
     using Buffer = std::array<uint8_t, PAGE_LENGTH + 2>;
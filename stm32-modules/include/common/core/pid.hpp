@@ -1,5 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+
+/** The direction a thermal element is being driven in.*/
+enum class PIDDirection { HEATING, COOLING };
+
+/** One set of PID gains.*/
+struct PIDGains {
+    double kp;
+    double ki;
+    double kd;
+};
+
 /**
  * @brief Implements a starndard PID controller.
  */
@@ -48,6 +63,15 @@ class PID {
      */
     auto compute(double error, double sampletime) -> double;
     auto reset() -> void;
+    /**
+     * @brief Change the gains of the controller without resetting it.
+     * The integrator absorbs the change in the proportional term so that
+     * the output doesn't jump when the gains change mid-control.
+     *
+     * @param[in] gains The new gains
+     */
+    auto set_gains(const PIDGains& gains) -> void;
+    [[nodiscard]] auto gains() const -> PIDGains;
     [[nodiscard]] auto kp() const -> double;
     [[nodiscard]] auto ki() const -> double;
     [[nodiscard]] auto kd() const -> double;
@@ -72,3 +96,70 @@ class PID {
     // Degrees away from target where reset_trigger should be triggered
     double _reset_threshold;
 };
+
+/**
+ * @brief A table of PID gains, indexed by temperature zone and by the
+ * direction an element is being driven in.
+ *
+ * @details The gain of a thermal element changes a lot across its range
+ * and between heating and cooling, so one set of gains tends to be slow at
+ * one end and overshoot at the other. Each module defines its own zones,
+ * looks up the gains for the zone of its target and the direction it's
+ * moving in, and applies them with PID::set_gains.
+ *
+ * @tparam Zones The number of temperature zones
+ */
+template <size_t Zones>
+class PIDGainSchedule {
+  public:
+    static constexpr size_t ZONES = Zones;
+
+    /** Use the same gains for every zone and direction.*/
+    explicit PIDGainSchedule(const PIDGains& gains)
+        : PIDGainSchedule(gains, gains) {}
+
+    /** Use one set of gains for heating and one for cooling.*/
+    PIDGainSchedule(const PIDGains& heating, const PIDGains& cooling)
+        : _gains() {
+        set(std::nullopt, PIDDirection::HEATING, heating);
+        set(std::nullopt, PIDDirection::COOLING, cooling);
+    }
+
+    /**
+     * @brief Update part of the table.
+     * @param[in] zone The zone to update, or every zone if empty
+     * @param[in] direction The direction to update, or both if empty
+     * @param[in] gains The new gains
+     * @return True if the zone exists and the table was updated
+     */
+    auto set(std::optional<size_t> zone, std::optional<PIDDirection> direction,
+             const PIDGains& gains) -> bool {
+        if (zone.has_value() && zone.value() >= Zones) {
+            return false;
+        }
+        for (size_t i = 0; i < Zones; ++i) {
+            if (zone.has_value() && zone.value() != i) {
+                continue;
+            }
+            for (auto dir : {PIDDirection::HEATING, PIDDirection::COOLING}) {
+                if (!direction.has_value() || direction.value() == dir) {
+                    _gains.at(i).at(static_cast<size_t>(dir)) = gains;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the gains for a zone and direction. Zones past the end of
+     * the table use the last zone.
+     */
+    [[nodiscard]] auto get(size_t zone, PIDDirection direction) const
+        -> PIDGains {
+        return _gains.at(std::min(zone, Zones - 1))
+            .at(static_cast<size_t>(direction));
+    }
+
+  private:
+    std::array<std::array<PIDGains, 2>, Zones> _gains;
+};
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <optional>
 #include <tuple>
+#include <utility>
 #include <variant>
 
 #include "hal/message_queue.hpp"
@@ -20,55 +22,14 @@ template <typename Q, typename Message = typename Q::Message,
           typename Tag = typename Q::Tag>
 concept MsgQueue = MessageQueue<Q, Message>;
 
-// In order to provide runtime visitation on the tuple of handles,
-// we utilize this helper struct...
-template <size_t N>
-struct SendHelper {
-    /**
-     * @brief Helper function to provide runtime resolution of index-based
-     * queue send operations. The function recurses down the range of indices
-     * available for a QueueAggregator, and checks whether the runtime-
-     * provided index `idx` is a match. If that is the case, a constexpr
-     * evaluation checks wither the type `Message` can be used to construct
-     * the message type we want to send to. If yes, the message is sent;
-     * otherwise, we return `false` to indicate that the message and index
-     * were mismatched.
-     *
-     * @tparam Message The message type to send
-     * @tparam Aggregator Instantiation of the QueueAggregator class
-     * @param msg The message to send
-     * @param idx The queue index we want to send to; this should be derived
-     *            from the `get_message_idx` or `get_queue_idx` function
-     *            provided by QueueAggregator
-     * @param handle Handle to the Aggregator
-     * @return true if the messsage was succesfully sent, false otherwise
-     */
-    template <typename Message, typename Aggregator>
-    static auto send(const Message& msg, size_t idx, uint32_t timeout_ms,
-                     Aggregator* handle) -> bool {
-        using VariantType =
-            std::variant_alternative_t<N - 1,
-                                       typename Aggregator::MessageTypes>;
-        if (N - 1 == idx) {
-            if constexpr (std::is_constructible_v<VariantType, Message>) {
-                return handle->template send_to<N - 1>(msg, timeout_ms);
-            }
-            // Can't send to this queue type
-            return false;
-        }
-        return SendHelper<N - 1>::send(msg, idx, timeout_ms, handle);
-    }
-};
-
-// Specialization for cases of N=0, in which case all functions return false
-// to indicate a failure to resolve.
-template <>
-struct SendHelper<0> {
-    template <typename Message, typename Aggregator>
-    static auto send(const Message& /*unused*/, size_t /*unused*/,
-                     uint32_t /*unused*/, Aggregator* /*unused*/) -> bool {
-        return false;
-    }
+/**
+ * @brief A lock that a batch of messages can be sent under, such as a
+ * FreeRTOSSchedulerSuspend.
+ */
+template <typename Lock>
+concept BatchLock = requires(Lock& lock) {
+    {lock.acquire()};
+    {lock.release()};
 };
 
 /**
@@ -96,6 +57,9 @@ struct SendHelper<0> {
  *   passed as a runtime parameter and the QueueAggregator resolves the
  *   handle for the queue to send to & checks whether that queue can actually
  *   receive the Message type before sending it.
+ * - Batches, where several messages with automatically resolved recipients
+ *   are sent while holding a lock, so that no recipient runs until all of
+ *   them have been sent.
  *
  * One limitation of this configuration is that each message queue type
  * within MessageQueues must have a unique class definition. In the case
@@ -208,7 +172,35 @@ class QueueAggregator {
         if (!(address < TaskCount)) {
             return false;
         }
-        return SendHelper<TaskCount>::send(msg, address, timeout_ms, this);
+        return SEND_TABLE<Message>[address](this, msg, timeout_ms);
+    }
+
+    /**
+     * @brief Send several messages while holding a lock, automatically
+     * deducing the mailbox of each one like \ref send(). Holding a
+     * FreeRTOSSchedulerSuspend means that none of the recipients is
+     * switched to until every message has been sent, rather than once per
+     * message, while interrupts keep running. A FreeRTOSCriticalSection
+     * would also work, but it masks interrupts for the whole batch and
+     * should not be used for this.
+     *
+     * Nothing may block while the lock is held, so the messages are sent
+     * without a timeout. A message that can't be sent doesn't stop the rest
+     * of the batch from being sent.
+     *
+     * @tparam Lock The type of the lock to hold
+     * @tparam Messages The types of the messages to send
+     * @param lock The lock to hold while sending
+     * @param msgs The messages to send
+     * @return true if every message could be sent, false otherwise
+     */
+    template <BatchLock Lock, typename... Messages>
+    auto send_batch(Lock& lock, const Messages&... msgs) -> bool {
+        bool sent = true;
+        lock.acquire();
+        ((sent = send(msgs) && sent), ...);
+        lock.release();
+        return sent;
     }
 
   private:
@@ -245,6 +237,37 @@ class QueueAggregator {
         return std::get<Idx>(_handles)._handle->try_send(msg, timeout_ms);
     }
 
+    template <typename Message>
+    using SendThunk = bool (*)(QueueAggregator*, const Message&, uint32_t);
+
+    /**
+     * @brief Send a message to the queue at a fixed index, or fail if that
+     * queue can't hold the message. One of these is instantiated for each
+     * index so that \ref send_to_address() can look up the right one.
+     */
+    template <size_t Idx, typename Message>
+    static auto send_thunk(QueueAggregator* handle, const Message& msg,
+                           uint32_t timeout_ms) -> bool {
+        using VariantType = std::variant_alternative_t<Idx, MessageTypes>;
+        if constexpr (std::is_constructible_v<VariantType, Message>) {
+            return handle->template send_to<Idx>(msg, timeout_ms);
+        }
+        // Can't send to this queue type
+        return false;
+    }
+
+    template <typename Message, size_t... Idx>
+    static constexpr auto make_send_table(std::index_sequence<Idx...>)
+        -> std::array<SendThunk<Message>, TaskCount> {
+        return {&send_thunk<Idx, Message>...};
+    }
+
+    // The send_thunk for each index, so that sending to a runtime address is
+    // a single indirect call rather than a comparison against every index
+    template <typename Message>
+    static constexpr std::array<SendThunk<Message>, TaskCount> SEND_TABLE =
+        make_send_table<Message>(std::make_index_sequence<TaskCount>());
+
     /**
      * @brief Get the index of a queue, based on an individual message
      * definition. This deduction will ONLY work if the message is unique
@@ -282,10 +305,6 @@ class QueueAggregator {
         return std::get<get_queue_idx<Queue>()>(_handles)._handle != nullptr;
     }
 
-    // SendHelper uses the internal send_to function...
-    template <size_t N>
-    friend struct SendHelper;
-
     // Handle for each of the tasks
     std::tuple<QueueHandle<MessageQueues>...> _handles;
 };
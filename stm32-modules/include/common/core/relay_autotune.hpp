@@ -0,0 +1,205 @@
+/**
+ * @file relay_autotune.hpp
+ * @brief Relay-feedback autotuning of PID constants for a thermal element.
+ *
+ * @details While it runs, the autotuner replaces the PID controller of an
+ * element with a relay. The output is driven to \c output_high whenever the
+ * input is below the setpoint and to \c output_low whenever it is above,
+ * with a small hysteresis band so that noise doesn't cause chattering. Most
+ * thermal systems settle into a stable oscillation around the setpoint
+ * under relay control, and the period and amplitude of that oscillation
+ * give the ultimate gain and period of the system:
+ *
+ * > Ku = 4d / (pi * sqrt(a^2 - e^2))
+ *
+ * where \c d is half of the relay swing, \c a is half of the peak-to-peak
+ * amplitude of the input and \c e is the hysteresis. The PID constants are
+ * derived from Ku and Tu with the classic Ziegler-Nichols rules, in the
+ * form that \ref PID expects (the integral and derivative constants are
+ * scaled by time rather than expressed as time constants).
+ *
+ * The first oscillation is always discarded, since it includes the
+ * approach to the setpoint. The tuner is driven entirely by \ref update,
+ * which should be called at the control rate of the element with the
+ * latest input reading, so it has no timing or hardware dependencies.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <optional>
+
+namespace relay_autotune {
+
+struct Config {
+    double setpoint;     // Input value to oscillate around
+    double output_high;  // Output while the input is below the setpoint
+    double output_low;   // Output while the input is above the setpoint
+    double hysteresis;   // Distance past the setpoint before switching
+    uint8_t cycles;      // Oscillations to average, after the first
+    double timeout;      // Longest the tuning may take, in seconds
+};
+
+struct Result {
+    double ultimate_gain;    // Ku
+    double ultimate_period;  // Tu, in seconds
+    double amplitude;        // Half of the peak-to-peak input swing
+    double kp;
+    double ki;
+    double kd;
+};
+
+enum class Status {
+    IDLE,     /**< Not tuning.*/
+    RUNNING,  /**< Relay is driving the output.*/
+    DONE,     /**< Tuning finished and a result is available.*/
+    FAILED,   /**< Tuning timed out or the oscillation was too small.*/
+};
+
+class RelayAutotune {
+  public:
+    /** Ziegler-Nichols classic PID rule constants.*/
+    static constexpr double KP_PER_KU = 0.6;
+    static constexpr double TI_PER_TU = 0.5;
+    static constexpr double TD_PER_TU = 0.125;
+    /** Most oscillations that can be averaged.*/
+    static constexpr uint8_t MAX_CYCLES = 20;
+
+    /**
+     * @brief Check whether a configuration can produce a result.
+     */
+    [[nodiscard]] static constexpr auto valid(const Config& config) -> bool {
+        return (config.output_high > config.output_low) &&
+               (config.hysteresis >= 0.0F) && (config.cycles > 0) &&
+               (config.cycles <= MAX_CYCLES) && (config.timeout > 0.0F);
+    }
+
+    /**
+     * @brief Begin tuning. Any previous result is discarded.
+     * @return True if the configuration was valid and tuning has started
+     */
+    auto start(const Config& config) -> bool {
+        if (!valid(config)) {
+            return false;
+        }
+        _config = config;
+        _status = Status::RUNNING;
+        _result = std::nullopt;
+        _elapsed = 0.0F;
+        _relay_high = true;
+        _last_switch = std::nullopt;
+        _max = -std::numeric_limits<double>::infinity();
+        _min = std::numeric_limits<double>::infinity();
+        _cycles_seen = 0;
+        _period_sum = 0.0F;
+        _amplitude_sum = 0.0F;
+        return true;
+    }
+
+    /** Abort tuning. The status returns to IDLE.*/
+    auto stop() -> void {
+        if (_status == Status::RUNNING) {
+            _status = Status::IDLE;
+        }
+    }
+
+    /**
+     * @brief Feed a new input reading to the tuner.
+     * @param input The latest reading of the controlled value
+     * @param seconds The time since the last reading
+     * @return The output to drive the element with. Once tuning is no
+     * longer running this is always 0.
+     */
+    auto update(double input, double seconds) -> double {
+        if (_status != Status::RUNNING) {
+            return 0.0F;
+        }
+        _elapsed += seconds;
+        if (_elapsed > _config.timeout) {
+            _status = Status::FAILED;
+            return 0.0F;
+        }
+        _max = std::max(_max, input);
+        _min = std::min(_min, input);
+        if (_relay_high && input > _config.setpoint + _config.hysteresis) {
+            _relay_high = false;
+            rising_switch(input);
+        } else if (!_relay_high &&
+                   input < _config.setpoint - _config.hysteresis) {
+            _relay_high = true;
+        }
+        return _relay_high ? _config.output_high : _config.output_low;
+    }
+
+    [[nodiscard]] auto status() const -> Status { return _status; }
+    [[nodiscard]] auto running() const -> bool {
+        return _status == Status::RUNNING;
+    }
+    [[nodiscard]] auto result() const -> std::optional<Result> {
+        return _result;
+    }
+    [[nodiscard]] auto elapsed() const -> double { return _elapsed; }
+    /** Number of full oscillations measured so far, including the first.*/
+    [[nodiscard]] auto cycles_seen() const -> uint8_t { return _cycles_seen; }
+
+  private:
+    /**
+     * Each switch from high to low output ends one oscillation and begins
+     * the next, so the period and amplitude are measured between them.
+     */
+    auto rising_switch(double input) -> void {
+        if (_last_switch.has_value()) {
+            ++_cycles_seen;
+            // The first oscillation includes the approach, so skip it
+            if (_cycles_seen > 1) {
+                _period_sum += _elapsed - _last_switch.value();
+                _amplitude_sum += (_max - _min) / 2.0F;
+            }
+            if (_cycles_seen > _config.cycles) {
+                finish();
+            }
+        }
+        _last_switch = _elapsed;
+        _max = input;
+        _min = input;
+    }
+
+    auto finish() -> void {
+        auto period = _period_sum / _config.cycles;
+        auto amplitude = _amplitude_sum / _config.cycles;
+        if (amplitude <= _config.hysteresis || period <= 0.0F) {
+            _status = Status::FAILED;
+            return;
+        }
+        auto swing = (_config.output_high - _config.output_low) / 2.0F;
+        auto ku = (4.0F * swing) /
+                  (std::numbers::pi *
+                   std::sqrt((amplitude * amplitude) -
+                             (_config.hysteresis * _config.hysteresis)));
+        auto kp = KP_PER_KU * ku;
+        _result = Result{.ultimate_gain = ku,
+                         .ultimate_period = period,
+                         .amplitude = amplitude,
+                         .kp = kp,
+                         .ki = kp / (TI_PER_TU * period),
+                         .kd = kp * TD_PER_TU * period};
+        _status = Status::DONE;
+    }
+
+    Config _config = {};
+    Status _status = Status::IDLE;
+    std::optional<Result> _result = std::nullopt;
+    double _elapsed = 0.0F;
+    bool _relay_high = true;
+    std::optional<double> _last_switch = std::nullopt;
+    double _max = 0.0F;
+    double _min = 0.0F;
+    uint8_t _cycles_seen = 0;
+    double _period_sum = 0.0F;
+    double _amplitude_sum = 0.0F;
+};
+
+}  // namespace relay_autotune
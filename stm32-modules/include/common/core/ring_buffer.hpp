@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+namespace ring_buffer {
+/*
+** Fixed-size ring buffer.
+**
+** Storage is a std::array allocated in the class body, so the buffer never
+** touches the heap and its footprint is known at compile time. Once the
+** buffer is full, pushing a new element overwrites the oldest one, which
+** makes it suitable for keeping the most recent window of a telemetry
+** stream.
+**
+** Elements are indexed oldest-first: index 0 is the oldest element still
+** held and index size()-1 is the most recently pushed one.
+**
+** The buffer is not synchronized; it should only be accessed from a single
+** task.
+*/
+template <typename Datatype, size_t Size>
+requires(Size > 0)
+class RingBuffer {
+  public:
+    [[nodiscard]] static constexpr auto capacity() -> size_t { return Size; }
+    [[nodiscard]] auto size() const -> size_t { return _count; }
+    [[nodiscard]] auto empty() const -> bool { return _count == 0; }
+    [[nodiscard]] auto full() const -> bool { return _count == Size; }
+    // Number of elements that were overwritten since the last clear()
+    [[nodiscard]] auto overwritten() const -> size_t { return _overwritten; }
+
+    auto push(const Datatype& value) -> void {
+        _buffer[_head] = value;
+        _head = (_head + 1) % Size;
+        if (_count < Size) {
+            ++_count;
+        } else {
+            ++_overwritten;
+        }
+    }
+
+    // Removes and returns the oldest element, if there is one
+    auto pop() -> std::optional<Datatype> {
+        if (empty()) {
+            return std::nullopt;
+        }
+        auto ret = _buffer[tail()];
+        --_count;
+        return ret;
+    }
+
+    // Returns the element at `index`, counted from the oldest element
+    [[nodiscard]] auto at(size_t index) const -> std::optional<Datatype> {
+        if (index >= _count) {
+            return std::nullopt;
+        }
+        return _buffer[(tail() + index) % Size];
+    }
+
+    auto clear() -> void {
+        _head = 0;
+        _count = 0;
+        _overwritten = 0;
+    }
+
+  private:
+    [[nodiscard]] auto tail() const -> size_t {
+        return (_head + Size - _count) % Size;
+    }
+
+    std::array<Datatype, Size> _buffer = {};
+    size_t _head = 0;
+    size_t _count = 0;
+    size_t _overwritten = 0;
+};
+};  // namespace ring_buffer
@@ -0,0 +1,79 @@
+/**
+ * @file task_memory.hpp
+ * @brief Records of how much memory the tasks of a module use: how close
+ * each statically allocated task has come to the end of its stack, and how
+ * the RAM outside of the task stacks is split up.
+ *
+ * @details Stacks are measured in words of StackType_t, the same unit the
+ * stack sizes of the tasks are given in. Everything else is in bytes.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace task_memory {
+
+/** How much of one task's stack has been used.*/
+struct StackUsage {
+    const char* name;
+    // The size of the stack
+    uint32_t size_words;
+    // The least free space the stack has had since the task started
+    uint32_t min_free_words;
+
+    [[nodiscard]] auto peak_used_words() const -> uint32_t {
+        return size_words - min_free_words;
+    }
+};
+
+/** The RAM that isn't on a task stack.*/
+struct RamUsage {
+    // Initialized statics
+    uint32_t data_bytes;
+    // Zeroed statics, including the task stacks and queues
+    uint32_t bss_bytes;
+    // The most that the C heap has grown to
+    uint32_t heap_peak_bytes;
+    // The C heap that is allocated right now
+    uint32_t heap_used_bytes;
+};
+
+/**
+ * A fixed list of the statically allocated tasks in a module, along with
+ * the size of each one's stack. The task is held by whatever handle lets
+ * its stack be inspected later.
+ */
+template <typename Handle, size_t MaxTasks>
+class TaskRegistry {
+  public:
+    static constexpr size_t MAX_TASKS = MaxTasks;
+
+    struct Entry {
+        Handle handle;
+        uint32_t stack_words;
+    };
+
+    /** @return false if the registry is already full*/
+    auto add(Handle handle, uint32_t stack_words) -> bool {
+        if (_count == MaxTasks) {
+            return false;
+        }
+        _entries.at(_count) =
+            Entry{.handle = handle, .stack_words = stack_words};
+        ++_count;
+        return true;
+    }
+
+    [[nodiscard]] auto count() const -> size_t { return _count; }
+    [[nodiscard]] auto at(size_t index) const -> const Entry& {
+        return _entries.at(index);
+    }
+
+  private:
+    std::array<Entry, MaxTasks> _entries{};
+    size_t _count = 0;
+};
+
+}  // namespace task_memory
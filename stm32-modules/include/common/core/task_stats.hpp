@@ -0,0 +1,200 @@
+/**
+ * @file task_stats.hpp
+ * @brief Lightweight runtime statistics for the tasks of a module: how long
+ * each pass through a task's handler takes, how deep its queue has been and
+ * how far a periodic task's wakeups stray from its period.
+ *
+ * @details Times come from a free-running counter provided by a
+ * \ref task_stats::CycleClock - the DWT cycle counter on target, or
+ * std::chrono::steady_clock on the host. Only differences between two
+ * readings are used, so the counter may wrap, as long as nothing that is
+ * measured takes longer than one full turn of the counter.
+ *
+ * Each \ref task_stats::TaskStats is written only by its own task. Other
+ * tasks may read it at any time to report it; a report taken while the task
+ * is recording may mix values from before and after one sample, which
+ * doesn't matter for statistics.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace task_stats {
+
+template <typename Clock>
+concept CycleClock = requires(Clock& clock) {
+    // The current value of a free-running counter
+    { clock.now() } -> std::same_as<uint32_t>;
+    // How many counts of now() make a microsecond
+    { clock.ticks_per_us() } -> std::same_as<uint32_t>;
+};
+
+/**
+ * The running min, average and max of a series of durations, along with a
+ * histogram of them. Each histogram bucket covers four times the range of
+ * the previous one: under 16us, under 64us, and so on, with the last
+ * bucket holding everything over HISTOGRAM_TOP_US.
+ */
+class Durations {
+  public:
+    static constexpr size_t HISTOGRAM_BUCKETS = 8;
+    static constexpr uint32_t HISTOGRAM_FIRST_US = 16;
+    static constexpr uint32_t HISTOGRAM_TOP_US =
+        HISTOGRAM_FIRST_US << (2 * (HISTOGRAM_BUCKETS - 2));
+
+    /** @return the exclusive upper bound of a histogram bucket, in us */
+    [[nodiscard]] static constexpr auto bucket_limit(size_t bucket)
+        -> uint32_t {
+        if (bucket >= HISTOGRAM_BUCKETS - 1) {
+            return std::numeric_limits<uint32_t>::max();
+        }
+        return HISTOGRAM_FIRST_US << (2 * bucket);
+    }
+
+    auto record(uint32_t us) -> void {
+        _min = std::min(_min, us);
+        _max = std::max(_max, us);
+        _total += us;
+        ++_count;
+        size_t bucket = 0;
+        while (us >= bucket_limit(bucket)) {
+            ++bucket;
+        }
+        ++_histogram.at(bucket);
+    }
+
+    [[nodiscard]] auto count() const -> uint32_t { return _count; }
+    [[nodiscard]] auto min() const -> uint32_t {
+        return _count == 0 ? 0 : _min;
+    }
+    [[nodiscard]] auto max() const -> uint32_t { return _max; }
+    [[nodiscard]] auto average() const -> uint32_t {
+        return _count == 0 ? 0 : static_cast<uint32_t>(_total / _count);
+    }
+    [[nodiscard]] auto histogram() const
+        -> const std::array<uint32_t, HISTOGRAM_BUCKETS>& {
+        return _histogram;
+    }
+
+  private:
+    uint64_t _total = 0;
+    uint32_t _count = 0;
+    uint32_t _min = std::numeric_limits<uint32_t>::max();
+    uint32_t _max = 0;
+    std::array<uint32_t, HISTOGRAM_BUCKETS> _histogram{};
+};
+
+/** Everything recorded about one task.*/
+class TaskStats {
+  public:
+    TaskStats() = default;
+    explicit TaskStats(const char* name) : _name(name) {}
+
+    /** Time a pass through the handler. See \ref Measurement.*/
+    template <CycleClock Clock>
+    auto record_handler(uint32_t start, Clock& clock) -> void {
+        _handler.record(elapsed_us(start, clock));
+    }
+
+    /**
+     * Note that a periodic task just woke up. From the second wakeup on,
+     * the difference between the time since the last wakeup and
+     * \c period_us is recorded as jitter.
+     */
+    template <CycleClock Clock>
+    auto record_wakeup(uint32_t period_us, Clock& clock) -> void {
+        auto now = clock.now();
+        if (_woken) {
+            auto interval = (now - _last_wakeup) / clock.ticks_per_us();
+            _jitter.record(interval > period_us ? interval - period_us
+                                                : period_us - interval);
+        }
+        _period_us = period_us;
+        _last_wakeup = now;
+        _woken = true;
+    }
+
+    /** Keep the deepest that the task's queue has been.*/
+    auto record_queue_depth(size_t depth) -> void {
+        _queue_high_water = std::max(_queue_high_water, depth);
+    }
+
+    [[nodiscard]] auto name() const -> const char* { return _name; }
+    [[nodiscard]] auto handler() const -> const Durations& { return _handler; }
+    [[nodiscard]] auto jitter() const -> const Durations& { return _jitter; }
+    [[nodiscard]] auto period_us() const -> uint32_t { return _period_us; }
+    [[nodiscard]] auto queue_high_water() const -> size_t {
+        return _queue_high_water;
+    }
+
+  private:
+    template <CycleClock Clock>
+    static auto elapsed_us(uint32_t start, Clock& clock) -> uint32_t {
+        return (clock.now() - start) / clock.ticks_per_us();
+    }
+
+    const char* _name = "";
+    Durations _handler{};
+    Durations _jitter{};
+    uint32_t _period_us = 0;
+    uint32_t _last_wakeup = 0;
+    size_t _queue_high_water = 0;
+    bool _woken = false;
+};
+
+/**
+ * Times a pass through a task's handler from construction to destruction:
+ *
+ *     {
+ *         auto measure = task_stats::Measurement(stats, clock);
+ *         task.run_once(policy);
+ *     }
+ */
+template <CycleClock Clock>
+class Measurement {
+  public:
+    Measurement(TaskStats& stats, Clock& clock)
+        : _stats(stats), _clock(clock), _start(clock.now()) {}
+    Measurement(const Measurement&) = delete;
+    Measurement(Measurement&&) = delete;
+    auto operator=(const Measurement&) -> Measurement& = delete;
+    auto operator=(Measurement&&) -> Measurement& = delete;
+    ~Measurement() { _stats.record_handler(_start, _clock); }
+
+  private:
+    TaskStats& _stats;
+    Clock& _clock;
+    uint32_t _start;
+};
+
+/** The stats of every task in a module, indexed like its task list.*/
+template <size_t Tasks>
+class Registry {
+  public:
+    static constexpr size_t TASKS = Tasks;
+
+    explicit Registry(const std::array<const char*, Tasks>& names)
+        : _stats() {
+        for (size_t i = 0; i < Tasks; ++i) {
+            _stats.at(i) = TaskStats(names.at(i));
+        }
+    }
+
+    [[nodiscard]] auto at(size_t task) -> TaskStats& { return _stats.at(task); }
+    [[nodiscard]] auto at(size_t task) const -> const TaskStats& {
+        return _stats.at(task);
+    }
+
+    [[nodiscard]] auto begin() const { return _stats.cbegin(); }
+    [[nodiscard]] auto end() const { return _stats.cend(); }
+
+  private:
+    std::array<TaskStats, Tasks> _stats;
+};
+
+}  // namespace task_stats
@@ -0,0 +1,180 @@
+/**
+ * @file windowed_filter.hpp
+ * @brief Small streaming filters for smoothing noisy periodic measurements.
+ *
+ * All filters here have O(1) update and read cost and never allocate, so
+ * they can be fed from an interrupt context. They are not synchronized; if
+ * the producer and the consumer run in different contexts, the caller is
+ * responsible for guarding access.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace windowed_filter {
+
+/**
+ * @brief Moving average over the last \c window() samples, maintained as a
+ * running sum so adding a sample and reading the average are both constant
+ * time regardless of the window size.
+ *
+ * @tparam T The sample type
+ * @tparam MaxWindow The largest window that can be configured. Storage for
+ * this many samples is allocated in the class body.
+ */
+template <typename T, size_t MaxWindow>
+requires(std::is_arithmetic_v<T> && MaxWindow > 0)
+class RunningAverage {
+  public:
+    // Integral samples are summed in a wide integer so the sum is exact
+    using Accumulator =
+        std::conditional_t<std::is_integral_v<T>, int64_t, double>;
+
+    explicit RunningAverage(size_t window = MaxWindow)
+        : _window(std::clamp(window, static_cast<size_t>(1), MaxWindow)) {}
+
+    [[nodiscard]] static constexpr auto max_window() -> size_t {
+        return MaxWindow;
+    }
+    [[nodiscard]] auto window() const -> size_t { return _window; }
+    [[nodiscard]] auto count() const -> size_t { return _count; }
+
+    /**
+     * @brief Change the window size. This discards all samples, since the
+     * running sum can't be reinterpreted for a different window.
+     *
+     * @return true if the window is in [1, MaxWindow] and was applied
+     */
+    auto set_window(size_t window) -> bool {
+        if (window == 0 || window > MaxWindow) {
+            return false;
+        }
+        _window = window;
+        reset();
+        return true;
+    }
+
+    auto reset() -> void {
+        _samples.fill(T{});
+        _head = 0;
+        _count = 0;
+        _sum = 0;
+    }
+
+    auto add(T sample) -> void {
+        if (_count == _window) {
+            _sum -= static_cast<Accumulator>(_samples[_head]);
+        } else {
+            ++_count;
+        }
+        _samples[_head] = sample;
+        _sum += static_cast<Accumulator>(sample);
+        _head = (_head + 1) % _window;
+    }
+
+    /**
+     * @brief Average of the samples currently held. Before the window has
+     * filled, this averages over only the samples received so far.
+     */
+    [[nodiscard]] auto average() const -> T {
+        if (_count == 0) {
+            return T{};
+        }
+        return static_cast<T>(_sum / static_cast<Accumulator>(_count));
+    }
+
+  private:
+    std::array<T, MaxWindow> _samples = {};
+    size_t _window;
+    size_t _head = 0;
+    size_t _count = 0;
+    Accumulator _sum = 0;
+};
+
+/**
+ * @brief Exponential moving average. Each new sample contributes
+ * \c alpha of the output, so smaller values of alpha smooth more heavily.
+ * The first sample seeds the average directly so there is no ramp-up from
+ * zero.
+ */
+template <std::floating_point T>
+class ExponentialAverage {
+  public:
+    explicit ExponentialAverage(T alpha)
+        : _alpha(std::clamp(alpha, T{0}, T{1})) {}
+
+    [[nodiscard]] auto alpha() const -> T { return _alpha; }
+    auto set_alpha(T alpha) -> bool {
+        if (alpha <= T{0} || alpha > T{1}) {
+            return false;
+        }
+        _alpha = alpha;
+        return true;
+    }
+
+    auto reset() -> void { _seeded = false; }
+
+    auto add(T sample) -> T {
+        if (!_seeded) {
+            _value = sample;
+            _seeded = true;
+        } else {
+            _value += _alpha * (sample - _value);
+        }
+        return _value;
+    }
+
+    [[nodiscard]] auto value() const -> T { return _value; }
+
+  private:
+    T _alpha;
+    T _value = T{0};
+    bool _seeded = false;
+};
+
+/**
+ * @brief Median of the last three samples. This removes single-sample
+ * spikes while passing steps through with a one-sample delay, which makes
+ * it a good first stage in front of an averaging filter.
+ */
+template <typename T>
+requires std::is_arithmetic_v<T>
+class MedianOfThree {
+  public:
+    auto reset() -> void { _count = 0; }
+
+    auto add(T sample) -> T {
+        _samples[0] = _samples[1];
+        _samples[1] = _samples[2];
+        _samples[2] = sample;
+        if (_count < _samples.size()) {
+            ++_count;
+        }
+        return value();
+    }
+
+    /**
+     * @brief The median of the held samples. Until three samples have
+     * arrived, this is the most recent sample.
+     */
+    [[nodiscard]] auto value() const -> T {
+        if (_count < _samples.size()) {
+            return _samples[2];
+        }
+        const auto& a = _samples[0];
+        const auto& b = _samples[1];
+        const auto& c = _samples[2];
+        return std::max(std::min(a, b), std::min(std::max(a, b), c));
+    }
+
+  private:
+    std::array<T, 3> _samples = {};
+    size_t _count = 0;
+};
+
+}  // namespace windowed_filter
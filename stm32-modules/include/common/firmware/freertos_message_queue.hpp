@@ -29,7 +29,8 @@ class FreeRTOSMessageQueue {
           queue(xQueueCreateStatic(queue_size, sizeof(Message), backing.data(),
                                    &queue_control_structure)),
           receiver_handle(nullptr),
-          sent_bit(notification_bit) {}
+          sent_bit(notification_bit),
+          high_water(0) {}
 
     // For use with queue_aggregator
     struct Tag {};
@@ -47,12 +48,18 @@ class FreeRTOSMessageQueue {
     [[nodiscard]] auto try_send(const Message& message,
                                 const uint32_t timeout_ticks = 0) -> bool {
         auto sent = xQueueSendToBack(queue, &message, timeout_ticks) == pdTRUE;
+        if (sent) {
+            note_depth(uxQueueMessagesWaiting(queue));
+        }
         return sent;
     }
 
     [[nodiscard]] auto try_send_from_isr(const Message& message) -> bool {
         BaseType_t higher_woken = pdFALSE;
         auto sent = xQueueSendFromISR(queue, &message, &higher_woken);
+        if (sent == pdTRUE) {
+            note_depth(uxQueueMessagesWaitingFromISR(queue));
+        }
         portYIELD_FROM_ISR(  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
             higher_woken);
         return sent;
@@ -67,15 +74,33 @@ class FreeRTOSMessageQueue {
             got_message = xQueueReceive(queue, message, portMAX_DELAY);
         }
     }
+    // Block until a message is waiting, without taking it, so that the
+    // receiver can time how long it takes to handle it
+    auto wait_for_message() -> void {
+        Message peeked;
+        while (xQueuePeek(queue, &peeked, portMAX_DELAY) == pdFALSE) {
+        }
+    }
     [[nodiscard]] auto has_message() const -> bool {
         return uxQueueMessagesWaiting(queue) != 0;
     }
+    // The most messages that have been waiting in the queue at once
+    [[nodiscard]] auto high_water_mark() const -> size_t {
+        return high_water;
+    }
     void provide_handle(TaskHandle_t handle) { receiver_handle = handle; }
 
   private:
+    auto note_depth(UBaseType_t depth) -> void {
+        if (depth > high_water) {
+            high_water = depth;
+        }
+    }
+
     StaticQueue_t queue_control_structure;
     std::array<uint8_t, queue_size * sizeof(Message)> backing;
     QueueHandle_t queue;
     TaskHandle_t receiver_handle;
     uint8_t sent_bit;
+    size_t high_water;
 };
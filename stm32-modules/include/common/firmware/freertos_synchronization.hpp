@@ -2,6 +2,7 @@
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 
 namespace freertos_synchronization {
 
@@ -88,4 +89,30 @@ class FreeRTOSCriticalSection {
     void release() { taskEXIT_CRITICAL(); }
 };
 
+/**
+ * Holds off context switches without disabling interrupts, by suspending
+ * the scheduler. Tasks that become ready while it is held, such as the
+ * receivers of queued messages, are only switched to on release. Queues
+ * may be written without a timeout while it is held, but nothing may
+ * block.
+ */
+class FreeRTOSSchedulerSuspend {
+  public:
+    FreeRTOSSchedulerSuspend() = default;
+    FreeRTOSSchedulerSuspend(const FreeRTOSSchedulerSuspend &) = delete;
+    FreeRTOSSchedulerSuspend(const FreeRTOSSchedulerSuspend &&) = delete;
+    auto operator=(const FreeRTOSSchedulerSuspend &)
+        -> FreeRTOSSchedulerSuspend & = delete;
+    auto operator=(const FreeRTOSSchedulerSuspend &&)
+        -> FreeRTOSSchedulerSuspend && = delete;
+
+    ~FreeRTOSSchedulerSuspend() = default;
+
+    // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+    void acquire() { vTaskSuspendAll(); }
+
+    // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+    void release() { static_cast<void>(xTaskResumeAll()); }
+};
+
 }  // namespace freertos_synchronization
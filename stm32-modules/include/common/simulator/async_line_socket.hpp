@@ -0,0 +1,178 @@
+/**
+ * @file async_line_socket.hpp
+ * @brief The connection to the host shared by the simulators' socket
+ * drivers.
+ *
+ * @details Reads and writes run asynchronously on one io_context, driven by
+ * the thread that calls \ref sim_socket::AsyncLineSocket::run:
+ * - Incoming bytes are split into lines by a \ref line_framer::LineFramer,
+ *   and every complete line is handed on by itself, however the bytes
+ *   arrived.
+ * - Responses from any thread are added to a write queue and sent in
+ *   order, without blocking the task that wrote them.
+ *
+ * Logging every line to the console is optional, since at high command
+ * rates it costs far more than the simulation.
+ */
+#pragma once
+
+#include <array>
+#include <boost/asio.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+#include "simulator/line_framer.hpp"
+
+namespace sim_socket {
+
+struct AddressInfo {
+    std::string host;
+    int port;
+};
+
+/**
+ * @brief Parse a socket URL of the form \c scheme://host:port.
+ */
+inline auto parse_url(const std::string& url) -> std::optional<AddressInfo> {
+    std::regex url_regex(":\\/\\/([a-zA-Z0-9.-]*):(\\d*)$");
+    std::smatch url_match_result;
+    if (!std::regex_search(url, url_match_result, url_regex)) {
+        return std::nullopt;
+    }
+    return AddressInfo{url_match_result[1], std::stoi(url_match_result[2])};
+}
+
+class AsyncLineSocket {
+  public:
+    /** Lines longer than this are dropped.*/
+    static constexpr size_t MAX_LINE_LENGTH = 2048;
+    /**
+     * Each line stays valid until this many more have arrived. This must be
+     * more than the depth of the queue that the lines are sent to.
+     */
+    static constexpr size_t LINE_SLOTS = 16;
+    static constexpr size_t READ_CHUNK_SIZE = 1024;
+
+    using LineCallback = std::function<void(const char*, const char*)>;
+
+    /**
+     * @brief Connect to the host. Exits the simulator if the connection
+     * can't be made.
+     * @param log Print every line received and sent
+     */
+    AsyncLineSocket(const AddressInfo& address, bool log)
+        : _io(), _socket(_io), _log(log) {
+        boost::asio::ip::tcp::resolver resolver(_io);
+        std::string parsed_host;
+        try {
+            auto endpoints =
+                resolver.resolve(address.host, std::to_string(address.port));
+            parsed_host = endpoints.begin()->endpoint().address().to_string();
+        } catch (const boost::system::system_error& ex) {
+            std::cerr << "Failed to resolve passed host/ip: \"" << address.host
+                      << "\"" << std::endl;
+            exit(1);
+        }
+        boost::asio::ip::tcp::endpoint endpoint(
+            boost::asio::ip::address::from_string(parsed_host), address.port);
+        boost::system::error_code ec;
+        _socket.connect(endpoint, ec);
+        if (ec) {
+            std::cerr << "Failed to create socket: " << ec.category().name()
+                      << ": " << ec.value() << std::endl;
+            exit(ec.value());
+        }
+        _socket.set_option(boost::asio::ip::tcp::no_delay(true));
+    }
+
+    /**
+     * @brief Queue a message to send to the host. Thread safe; the message
+     * is sent once \ref run is running.
+     */
+    auto write(std::string message) -> void {
+        if (message.empty()) {
+            return;
+        }
+        boost::asio::post(_io, [this, message = std::move(message)]() mutable {
+            if (_log) {
+                std::cout << "Sending response: " << message << std::endl;
+            }
+            _writes.push_back(std::move(message));
+            if (_writes.size() == 1) {
+                start_write();
+            }
+        });
+    }
+
+    /**
+     * @brief Read from the host until the connection closes, calling
+     * \c on_line with every complete line. Queued writes are sent from the
+     * calling thread while this runs.
+     */
+    auto run(LineCallback on_line) -> void {
+        _on_line = std::move(on_line);
+        start_read();
+        _io.run();
+    }
+
+  private:
+    auto start_read() -> void {
+        _socket.async_read_some(
+            boost::asio::buffer(_read_buffer),
+            [this](const boost::system::error_code& ec, size_t length) {
+                if (ec) {
+                    // Once the host has gone, any queued writes are useless
+                    _io.stop();
+                    return;
+                }
+                auto dropped = _framer.dropped();
+                _framer.feed(_read_buffer.data(),
+                             std::next(_read_buffer.data(), length),
+                             [this](const char* begin, const char* end) {
+                                 if (_log) {
+                                     std::cout << "Received complete message: "
+                                               << std::string_view(begin, end)
+                                               << std::flush;
+                                 }
+                                 _on_line(begin, end);
+                             });
+                if (_framer.dropped() != dropped) {
+                    std::cerr << "Dropped a line longer than "
+                              << MAX_LINE_LENGTH << " characters" << std::endl;
+                }
+                start_read();
+            });
+    }
+
+    auto start_write() -> void {
+        boost::asio::async_write(
+            _socket, boost::asio::buffer(_writes.front()),
+            [this](const boost::system::error_code& ec, size_t) {
+                if (ec) {
+                    _io.stop();
+                    return;
+                }
+                _writes.pop_front();
+                if (!_writes.empty()) {
+                    start_write();
+                }
+            });
+    }
+
+    boost::asio::io_context _io;
+    boost::asio::ip::tcp::socket _socket;
+    bool _log;
+    std::array<char, READ_CHUNK_SIZE> _read_buffer = {};
+    line_framer::LineFramer<MAX_LINE_LENGTH, LINE_SLOTS> _framer = {};
+    std::deque<std::string> _writes = {};
+    LineCallback _on_line = {};
+};
+
+}  // namespace sim_socket
@@ -0,0 +1,75 @@
+/**
+ * @file line_framer.hpp
+ * @brief Splits a stream of bytes from the host into individual lines.
+ *
+ * @details Bytes can arrive in any size of chunk: one read may hold part of
+ * a line or several lines at once. \ref line_framer::LineFramer collects
+ * them and hands on each complete line, newline included, as soon as it is
+ * done.
+ *
+ * Messages from the host only point at their text, so each line is kept in
+ * one of a ring of slots until \c Slots more lines have arrived. As long as
+ * the comms task handles each message before it has more than \c Slots - 1
+ * others waiting, the text a message points at stays valid.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+namespace line_framer {
+
+template <size_t MaxLength, size_t Slots>
+requires(MaxLength > 1 && Slots > 1)
+class LineFramer {
+  public:
+    static constexpr size_t MAX_LENGTH = MaxLength;
+    static constexpr size_t SLOTS = Slots;
+
+    /**
+     * @brief Add a chunk of bytes to the stream.
+     * @param on_line Called with the begin and end of every line completed
+     * by this chunk, in order
+     */
+    template <typename Callback>
+    auto feed(const char* begin, const char* end, Callback&& on_line)
+        -> void {
+        for (const auto* next = begin; next != end; std::advance(next, 1)) {
+            auto& slot = _slots.at(_slot);
+            if (!_overflowed) {
+                if (_length < MaxLength) {
+                    slot.at(_length++) = *next;
+                } else {
+                    _overflowed = true;
+                }
+            }
+            if (*next != '\n') {
+                continue;
+            }
+            if (_overflowed) {
+                // The line was too long to hold, so all of it is dropped
+                ++_dropped;
+                _overflowed = false;
+            } else {
+                on_line(slot.cbegin(),
+                        std::next(slot.cbegin(),
+                                  static_cast<std::ptrdiff_t>(_length)));
+                _slot = (_slot + 1) % Slots;
+            }
+            _length = 0;
+        }
+    }
+
+    /** The number of lines dropped for being longer than MaxLength.*/
+    [[nodiscard]] auto dropped() const -> size_t { return _dropped; }
+
+  private:
+    std::array<std::array<char, MaxLength>, Slots> _slots = {};
+    size_t _slot = 0;
+    size_t _length = 0;
+    size_t _dropped = 0;
+    bool _overflowed = false;
+};
+
+}  // namespace line_framer
@@ -0,0 +1,23 @@
+/**
+ * @file sim_cycle_clock.hpp
+ * @brief A task_stats::CycleClock for the host, counting microseconds of
+ * std::chrono::steady_clock.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace sim_cycle_clock {
+
+struct SteadyCycleClock {
+    [[nodiscard]] static auto now() -> uint32_t {
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+    [[nodiscard]] static auto ticks_per_us() -> uint32_t { return 1; }
+};
+
+}  // namespace sim_cycle_clock
@@ -0,0 +1,103 @@
+/**
+ * @file sim_farm.hpp
+ * @brief Runs many simulated modules in one process on a shared pool of
+ * scheduler threads.
+ *
+ * @details Each module instance registers all of its tasks with one of the
+ * farm's \ref sim_scheduler::Scheduler, handed out in turn by
+ * \ref sim_farm::Farm::next_scheduler, so an instance's tasks always run on
+ * the same thread and in the same order as they would in a simulator of
+ * its own. The farm then runs one thread per scheduler rather than one per
+ * task. In simulated time the instances on one scheduler share its virtual
+ * clock, so input to any of them moves time on for all of them; in real
+ * time each scheduler is paced against the wall clock. Either way, input
+ * from the host must be posted to the instance's scheduler.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simulator/sim_scheduler.hpp"
+
+namespace sim_farm {
+
+class Farm {
+  public:
+    /**
+     * @param threads The number of scheduler threads to share between the
+     * instances
+     * @param realtime Whether to pace the schedulers against the wall clock
+     */
+    Farm(size_t threads, bool realtime) : _realtime(realtime) {
+        for (size_t i = 0; i < std::max(threads, size_t(1)); ++i) {
+            _schedulers.push_back(std::make_unique<sim_scheduler::Scheduler>());
+        }
+    }
+
+    /** The scheduler to register the next instance's tasks with.*/
+    auto next_scheduler() -> sim_scheduler::Scheduler& {
+        auto& scheduler = *_schedulers[_next];
+        _next = (_next + 1) % _schedulers.size();
+        return scheduler;
+    }
+
+    /** Start running the schedulers, once every instance is registered.*/
+    auto start() -> void {
+        for (auto& scheduler : _schedulers) {
+            _threads.emplace_back(
+                [this, &scheduler = *scheduler](std::stop_token st) {
+                    if (_realtime) {
+                        scheduler.run_paced(st);
+                    } else {
+                        scheduler.run(st);
+                    }
+                });
+        }
+    }
+
+    /** Stop every scheduler and wait for its thread to finish.*/
+    auto stop() -> void { _threads.clear(); }
+
+    [[nodiscard]] auto threads() const -> size_t { return _schedulers.size(); }
+
+  private:
+    bool _realtime;
+    size_t _next = 0;
+    std::vector<std::unique_ptr<sim_scheduler::Scheduler>> _schedulers = {};
+    std::vector<std::jthread> _threads = {};
+};
+
+/**
+ * @brief Get the URL of one instance's socket, given the URL of the first
+ * instance's. Each instance uses the next port up from the one before it.
+ *
+ * @return The URL, or nothing if \c url does not end in a port
+ */
+inline auto instance_url(const std::string& url, size_t index)
+    -> std::optional<std::string> {
+    auto match = std::smatch();
+    if (!std::regex_search(url, match, std::regex(":(\\d+)$"))) {
+        return std::nullopt;
+    }
+    auto port = std::stoul(match[1]) + index;
+    return match.prefix().str() + ":" + std::to_string(port);
+}
+
+/**
+ * @brief Get the name of the environment variable that holds a setting for
+ * one instance, such as \c SERIAL_NUMBER_2 for the third instance's serial
+ * number.
+ */
+inline auto instance_variable(const std::string& name, size_t index)
+    -> std::string {
+    return name + "_" + std::to_string(index);
+}
+
+}  // namespace sim_farm
@@ -0,0 +1,305 @@
+/**
+ * @file sim_scheduler.hpp
+ * @brief A discrete-event scheduler that runs simulated tasks against a
+ * virtual clock.
+ *
+ * @details In simulated time, a simulator doesn't need a thread per task.
+ * Every task is registered with a \ref sim_scheduler::Scheduler along with
+ * a check for whether it has any work waiting, and every source of periodic
+ * data (thermistor readings, for example) is registered as a periodic event
+ * on the virtual clock. Input from the host is handed to the scheduler with
+ * \ref sim_scheduler::Scheduler::post rather than sent straight to a task.
+ * The scheduler then:
+ *
+ * 1. Runs each task that has work, in the order the tasks were registered,
+ *    until none of them has any work left.
+ * 2. Sleeps until the host posts its next input.
+ * 3. Moves the virtual clock forward by one input period, firing every
+ *    periodic event due along the way in time order, and then delivers the
+ *    input.
+ *
+ * Each input arrives one input period of virtual time after the one before
+ * it, however long the host took to send it, so the same input always
+ * produces the same sequence of events. Nothing sleeps while there is work
+ * to do, and nothing spins while there is none.
+ *
+ * Tasks must only be run when they have work, since a task that blocks
+ * waiting for a message would stall the whole simulation.
+ *
+ * A scheduler can also be paced against the wall clock with
+ * \ref sim_scheduler::Scheduler::run_paced, which runs the same tasks and
+ * events in real time from a single thread and delivers posted input as
+ * soon as it arrives.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+namespace sim_scheduler {
+
+class Scheduler {
+  public:
+    /** Virtual time, in milliseconds since the simulation started.*/
+    using Ticks = uint64_t;
+    using Callback = std::function<void()>;
+    using Ready = std::function<bool()>;
+    using Deliver = std::function<void(const char*, const char*)>;
+
+    /**
+     * The virtual time between two inputs from the host in simulated time,
+     * about as often as a host polls a module for its status
+     */
+    static constexpr Ticks DEFAULT_INPUT_PERIOD = 1000;
+
+    explicit Scheduler(Ticks input_period = DEFAULT_INPUT_PERIOD)
+        : _input_period(input_period) {}
+
+    /**
+     * @brief Register a task.
+     * @param ready Returns true when the task has work waiting
+     * @param run Does one unit of the task's work
+     */
+    auto add_task(Ready ready, Callback run) -> void {
+        _tasks.push_back(
+            Task{.ready = std::move(ready), .run = std::move(run)});
+    }
+
+    /**
+     * @brief Register an event that fires every \c period ticks, starting
+     * one period from now.
+     */
+    auto add_periodic(Ticks period, Callback callback) -> void {
+        _events.push_back(Event{.period = std::max(period, Ticks(1)),
+                                .due = _now + std::max(period, Ticks(1)),
+                                .callback = std::move(callback)});
+    }
+
+    [[nodiscard]] auto now() const -> Ticks { return _now; }
+
+    /**
+     * @brief Run tasks until none of them has any work left.
+     * @return The number of times a task was run
+     */
+    auto run_until_idle() -> size_t {
+        size_t runs = 0;
+        bool any = true;
+        while (any) {
+            any = false;
+            for (auto& task : _tasks) {
+                if (task.ready()) {
+                    task.run();
+                    any = true;
+                    ++runs;
+                }
+            }
+        }
+        return runs;
+    }
+
+    /**
+     * @brief Move the virtual clock to the next periodic event, fire every
+     * event due at that time and then let the tasks handle the results.
+     * @return False if there are no periodic events to move to
+     */
+    auto advance() -> bool {
+        auto next = next_due();
+        if (!next.has_value()) {
+            return false;
+        }
+        _now = next.value();
+        for (size_t i = 0; i < _events.size(); ++i) {
+            if (_events[i].due == _now) {
+                _events[i].due += _events[i].period;
+                _events[i].callback();
+            }
+        }
+        static_cast<void>(run_until_idle());
+        return true;
+    }
+
+    /**
+     * @brief Run the simulation until the virtual clock has moved forward
+     * by at least \c duration ticks, or until there is nothing to move to.
+     */
+    auto run_for(Ticks duration) -> void {
+        auto until = _now + duration;
+        static_cast<void>(run_until_idle());
+        while (_now < until && advance()) {
+        }
+    }
+
+    /**
+     * @brief Run the simulation until a stop is requested. Whenever the
+     * tasks are idle the scheduler sleeps until the host posts an input,
+     * then moves the clock forward one input period and delivers it.
+     */
+    auto run(std::stop_token st) -> void {
+        static_cast<void>(run_until_idle());
+        while (true) {
+            auto input = wait_for_input(st);
+            if (!input.has_value()) {
+                return;
+            }
+            advance_to(_now + _input_period);
+            // The input stays alive until the tasks have handled it, since
+            // a message may point into it
+            input.value()();
+            static_cast<void>(run_until_idle());
+        }
+    }
+
+    /**
+     * @brief Run the simulation until a stop is requested, holding each
+     * periodic event back until its time comes around on the wall clock.
+     * Between events the scheduler sleeps; \ref notify and \ref post wake
+     * it early, and posted input is delivered straight away.
+     */
+    auto run_paced(std::stop_token st) -> void {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now() - std::chrono::milliseconds(_now);
+        static_cast<void>(run_until_idle());
+        while (!st.stop_requested()) {
+            auto next = next_due();
+            auto deadline =
+                start + std::chrono::milliseconds(next.value_or(_now));
+            {
+                auto lock = std::unique_lock(_wake_mutex);
+                auto notified = [this]() {
+                    return _notified || !_inbox.empty();
+                };
+                if (next.has_value()) {
+                    _wake.wait_until(lock, st, deadline, notified);
+                } else {
+                    _wake.wait(lock, st, notified);
+                }
+                _notified = false;
+            }
+            if (next.has_value() && clock::now() >= deadline) {
+                static_cast<void>(advance());
+            }
+            for (auto input = take_input(); input.has_value();
+                 input = take_input()) {
+                input.value()();
+                static_cast<void>(run_until_idle());
+            }
+            static_cast<void>(run_until_idle());
+        }
+    }
+
+    /**
+     * @brief Hand the scheduler an input from the host, such as a line of
+     * G-code, to deliver to the tasks from the scheduler's own thread. The
+     * callback is kept, and not moved, until the tasks are idle again.
+     * Thread safe.
+     */
+    auto post(Callback input) -> void {
+        {
+            auto lock = std::lock_guard(_wake_mutex);
+            _inbox.push_back(std::move(input));
+        }
+        _wake.notify_one();
+    }
+
+    /**
+     * @brief Post a line from the host. The line is copied, and \c deliver
+     * gets the copy, which stays valid until the tasks are idle again, so
+     * it can be sent to a task as a message that points into it.
+     * Thread safe.
+     */
+    auto post_line(const char* begin, const char* end, Deliver deliver)
+        -> void {
+        auto line = std::make_shared<const std::string>(begin, end);
+        post([line, deliver = std::move(deliver)]() {
+            deliver(line->data(), line->data() + line->size());
+        });
+    }
+
+    /**
+     * @brief Wake a paced scheduler so that it runs any tasks with work.
+     * Call this from other threads after giving a task work, for example
+     * when a message arrives from the host. Thread safe.
+     */
+    auto notify() -> void {
+        {
+            auto lock = std::lock_guard(_wake_mutex);
+            _notified = true;
+        }
+        _wake.notify_one();
+    }
+
+  private:
+    struct Task {
+        Ready ready;
+        Callback run;
+    };
+    struct Event {
+        Ticks period;
+        Ticks due;
+        Callback callback;
+    };
+
+    // Fire every periodic event due up to and including \c until, then
+    // leave the clock at \c until
+    auto advance_to(Ticks until) -> void {
+        for (auto next = next_due(); next.has_value() && next.value() <= until;
+             next = next_due()) {
+            static_cast<void>(advance());
+        }
+        _now = std::max(_now, until);
+    }
+
+    auto take_input() -> std::optional<Callback> {
+        auto lock = std::lock_guard(_wake_mutex);
+        if (_inbox.empty()) {
+            return std::nullopt;
+        }
+        auto input = std::move(_inbox.front());
+        _inbox.pop_front();
+        return input;
+    }
+
+    // Block until there is an input, or return nothing once a stop is
+    // requested
+    auto wait_for_input(std::stop_token st) -> std::optional<Callback> {
+        {
+            auto lock = std::unique_lock(_wake_mutex);
+            if (!_wake.wait(lock, st, [this]() { return !_inbox.empty(); })) {
+                return std::nullopt;
+            }
+        }
+        return take_input();
+    }
+
+    [[nodiscard]] auto next_due() const -> std::optional<Ticks> {
+        if (_events.empty()) {
+            return std::nullopt;
+        }
+        return std::min_element(_events.begin(), _events.end(),
+                                [](const Event& a, const Event& b) {
+                                    return a.due < b.due;
+                                })
+            ->due;
+    }
+
+    std::vector<Task> _tasks = {};
+    std::vector<Event> _events = {};
+    Ticks _now = 0;
+    Ticks _input_period;
+    std::deque<Callback> _inbox = {};
+    std::mutex _wake_mutex = {};
+    std::condition_variable_any _wake = {};
+    bool _notified = false;
+};
+
+}  // namespace sim_scheduler
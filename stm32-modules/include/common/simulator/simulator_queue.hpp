@@ -1,43 +1,72 @@
+/**
+ * @file simulator_queue.hpp
+ * @brief The message queue used by every task in the simulators.
+ *
+ * @details Threads waiting on the queue sleep on a condition variable
+ * until a message arrives, space frees up, or their timeout expires, so an
+ * idle simulator uses no CPU and a message is picked up as soon as it is
+ * sent. A receiver also wakes up when the stop token of its thread is
+ * triggered, so that tasks can be shut down while they wait.
+ */
 #pragma once
 
-#include <boost/lockfree/queue.hpp>
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <exception>
+#include <functional>
 #include <limits>
-#include <thread>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
 
 template <typename M, size_t queue_size = 8>
 class SimulatorMessageQueue {
   public:
     using clock = std::chrono::steady_clock;
     using Message = M;
-    using QueueType =
-        boost::lockfree::queue<Message, boost::lockfree::capacity<queue_size>>;
     class StopDuringMsgWait : public std::exception {};
-    SimulatorMessageQueue() : queue(queue_size), mythread_stop_token() {}
+    SimulatorMessageQueue()
+        : mutex(),
+          not_empty(),
+          not_full(),
+          queue(),
+          mythread_stop_token(),
+          send_callback(),
+          high_water(0) {}
 
     struct Tag {};
 
-    auto get_backing_queue() -> QueueType& { return queue; }
     auto set_stop_token(std::stop_token st) { mythread_stop_token = st; }
 
+    /**
+     * Set a function to call after every message sent to this queue, for
+     * example to wake a paced scheduler that runs the receiving task. Set it
+     * before any thread starts using the queue.
+     */
+    auto set_send_callback(std::function<void()> callback) {
+        send_callback = std::move(callback);
+    }
+
     [[nodiscard]] auto try_send(const Message& message,
                                 const uint32_t timeout_ticks = 0) -> bool {
-        auto at_start = clock::now();
-        bool sent_message = false;
-        while (!sent_message) {
-            using namespace std::literals::chrono_literals;
-            sent_message = queue.push(message);
-            if (sent_message) {
-                return sent_message;
-            }
-            if ((clock::now() - at_start) >
-                std::chrono::milliseconds(timeout_ticks)) {
-                return false;
-            }
-            std::this_thread::sleep_for(1ms);
+        auto lock = std::unique_lock(mutex);
+        auto has_space = [this]() { return queue.size() < queue_size; };
+        if (!not_full.wait_for(lock, std::chrono::milliseconds(timeout_ticks),
+                               has_space)) {
+            return false;
+        }
+        queue.push_back(message);
+        high_water = std::max(high_water, queue.size());
+        lock.unlock();
+        not_empty.notify_one();
+        if (send_callback) {
+            send_callback();
         }
-        return false;
+        return true;
     }
 
     [[nodiscard]] auto try_send_from_isr(const Message& message) -> bool {
@@ -49,24 +78,28 @@ class SimulatorMessageQueue {
         if (!message) {
             throw std::invalid_argument("null message pointer");
         }
-        auto at_start = clock::now();
-        bool got_message = false;
-        while (!got_message) {
-            using namespace std::literals::chrono_literals;
-            got_message = queue.pop(*message);
-            if (got_message) {
-                return got_message;
-            }
-            if ((clock::now() - at_start) >
-                std::chrono::milliseconds(timeout_ticks)) {
-                return false;
-            }
-            if (mythread_stop_token.stop_requested()) {
+        auto lock = std::unique_lock(mutex);
+        auto has_message = [this]() { return !queue.empty(); };
+        if (!has_message() && timeout_ticks > 0) {
+            auto got_message =
+                (timeout_ticks == std::numeric_limits<uint32_t>::max())
+                    ? not_empty.wait(lock, mythread_stop_token, has_message)
+                    : not_empty.wait_for(
+                          lock, mythread_stop_token,
+                          std::chrono::milliseconds(timeout_ticks),
+                          has_message);
+            if (!got_message && mythread_stop_token.stop_requested()) {
                 throw StopDuringMsgWait();
             }
-            std::this_thread::sleep_for(1ms);
         }
-        return false;
+        if (!has_message()) {
+            return false;
+        }
+        *message = queue.front();
+        queue.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
     }
 
     auto recv(Message* message) -> void {
@@ -74,9 +107,54 @@ class SimulatorMessageQueue {
             try_recv(message, std::numeric_limits<uint32_t>::max()));
     }
 
-    [[nodiscard]] auto has_message() const -> bool { return !queue.empty(); }
+    /**
+     * Block until a message is waiting, without taking it, so that the
+     * receiver can time how long it takes to handle it.
+     */
+    auto wait_for_message() -> void {
+        auto lock = std::unique_lock(mutex);
+        auto has_message = [this]() { return !queue.empty(); };
+        if (!not_empty.wait(lock, mythread_stop_token, has_message)) {
+            throw StopDuringMsgWait();
+        }
+    }
+
+    /**
+     * Like wait_for_message(), but give up at \c deadline. Lets a receiver
+     * that has periodic work of its own sleep until that work is due.
+     * @return True if a message is waiting
+     */
+    [[nodiscard]] auto wait_for_message_until(clock::time_point deadline)
+        -> bool {
+        auto lock = std::unique_lock(mutex);
+        auto has_message = [this]() { return !queue.empty(); };
+        if (!not_empty.wait_until(lock, mythread_stop_token, deadline,
+                                  has_message)) {
+            if (mythread_stop_token.stop_requested()) {
+                throw StopDuringMsgWait();
+            }
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] auto has_message() const -> bool {
+        auto lock = std::unique_lock(mutex);
+        return !queue.empty();
+    }
+
+    // The most messages that have been waiting in the queue at once
+    [[nodiscard]] auto high_water_mark() const -> size_t {
+        auto lock = std::unique_lock(mutex);
+        return high_water;
+    }
 
   private:
-    QueueType queue;
+    mutable std::mutex mutex;
+    std::condition_variable_any not_empty;
+    std::condition_variable not_full;
+    std::deque<Message> queue;
     std::stop_token mythread_stop_token;
+    std::function<void()> send_callback;
+    size_t high_water;
 };
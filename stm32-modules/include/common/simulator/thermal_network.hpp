@@ -0,0 +1,385 @@
+/**
+ * @file thermal_network.hpp
+ * @brief A lumped-element thermal network shared by the module simulators.
+ *
+ * @details Every thermal element that a simulator cares about (plate zones,
+ * heatsinks, lids, the sample itself, the air around the module) is a node
+ * with a heat capacity and a temperature. Nodes are joined by links with a
+ * thermal conductance, and a node can be driven by a heater or peltier that
+ * delivers up to a fixed number of watts. A peltier can also name a source
+ * node that it pumps its heat out of, so that driving a plate cold warms up
+ * the heatsink behind it. Nodes marked as fixed, such as the ambient air,
+ * never change temperature.
+ *
+ * The network is stepped with a fixed internal time step, which is chosen
+ * to keep the explicit integration stable. Time passed to \ref advance is
+ * accumulated and consumed in whole steps, so the same sequence of drive
+ * changes always produces the same temperatures no matter how finely the
+ * simulator slices up time. This is what lets a simulator run thousands of
+ * times faster than real time and still produce repeatable results.
+ *
+ * Networks can be described in a small text format, one entry per line:
+ *
+ *     # Comments start with a hash
+ *     node <name> capacity=<J/K> temperature=<C> [power=<W>]
+ *          [source=<node>] [fixed]
+ *     link <node> <node> <conductance in W/K>
+ *
+ * Nodes must be declared before any link or source that refers to them.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace thermal_network {
+
+using NodeIndex = size_t;
+
+struct Node {
+    std::string name = "";
+    double capacity = 1.0;      // Heat capacity, in J/K
+    double temperature = 0.0F;  // Current temperature, in ºC
+    double power = 0.0F;        // Heat delivered at full drive, in W
+    // Node that the drive pumps its heat out of, if any
+    std::optional<NodeIndex> source = std::nullopt;
+    bool fixed = false;  // Fixed nodes are boundary conditions
+};
+
+struct Link {
+    NodeIndex a;
+    NodeIndex b;
+    double conductance;  // In W/K
+};
+
+class ThermalNetwork {
+  public:
+    /**
+     * Longest internal step, in seconds, even for very slow networks. It
+     * has to be well under the fastest control loop driving a network, the
+     * thermocycler plate's 50ms, or drive changes between steps are lost.
+     */
+    static constexpr double MAX_STEP = 0.01;
+    /**
+     * Fraction of the smallest node time constant used as the step. Explicit
+     * Euler integration is stable below 1.
+     */
+    static constexpr double STABILITY_FRACTION = 0.5F;
+    /** Relative rounding error allowed when deciding if a step is due.*/
+    static constexpr double STEP_TOLERANCE = 1e-9;
+
+    /**
+     * @brief Add a node to the network.
+     * @return The index of the new node, or nothing if the name is already
+     * used or the node is not physically sensible
+     */
+    auto add_node(const Node& node) -> std::optional<NodeIndex> {
+        auto bad_source = node.source.has_value() &&
+                          (node.source.value() >= _nodes.size());
+        if (node.name.empty() || find(node.name).has_value() ||
+            !(node.capacity > 0.0F) || !std::isfinite(node.temperature) ||
+            bad_source) {
+            return std::nullopt;
+        }
+        _nodes.push_back(node);
+        _drive.push_back(0.0F);
+        _heat.push_back(0.0F);
+        update_step();
+        return _nodes.size() - 1;
+    }
+
+    /**
+     * @brief Join two nodes with a thermal conductance.
+     * @return True if the link was added
+     */
+    auto add_link(NodeIndex a, NodeIndex b, double conductance) -> bool {
+        if (a >= _nodes.size() || b >= _nodes.size() || a == b ||
+            conductance < 0.0F) {
+            return false;
+        }
+        _links.push_back(Link{.a = a, .b = b, .conductance = conductance});
+        update_step();
+        return true;
+    }
+
+    /**
+     * @brief Change the conductance of every link between two nodes, for
+     * elements such as fans that change how well two nodes are coupled.
+     * @return True if at least one link was updated
+     */
+    auto set_conductance(NodeIndex a, NodeIndex b, double conductance)
+        -> bool {
+        if (conductance < 0.0F) {
+            return false;
+        }
+        bool found = false;
+        for (auto& link : _links) {
+            if ((link.a == a && link.b == b) || (link.a == b && link.b == a)) {
+                link.conductance = conductance;
+                found = true;
+            }
+        }
+        if (found) {
+            update_step();
+        }
+        return found;
+    }
+
+    [[nodiscard]] auto find(std::string_view name) const
+        -> std::optional<NodeIndex> {
+        for (NodeIndex i = 0; i < _nodes.size(); ++i) {
+            if (_nodes[i].name == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Set the drive of a node's heater or peltier.
+     * @param drive Fraction of full power, from -1 (cooling) to 1 (heating)
+     */
+    auto set_drive(NodeIndex node, double drive) -> void {
+        if (node < _drive.size()) {
+            _drive[node] = std::clamp(drive, -1.0, 1.0);
+        }
+    }
+
+    auto set_temperature(NodeIndex node, double temperature) -> void {
+        if (node < _nodes.size()) {
+            _nodes[node].temperature = temperature;
+        }
+    }
+
+    [[nodiscard]] auto temperature(NodeIndex node) const -> double {
+        return _nodes.at(node).temperature;
+    }
+
+    [[nodiscard]] auto nodes() const -> const std::vector<Node>& {
+        return _nodes;
+    }
+
+    [[nodiscard]] auto links() const -> const std::vector<Link>& {
+        return _links;
+    }
+
+    /** The internal integration step, in seconds.*/
+    [[nodiscard]] auto step_size() const -> double { return _step; }
+
+    /** Simulated time that has been integrated so far, in seconds.*/
+    [[nodiscard]] auto elapsed() const -> double {
+        return static_cast<double>(_steps) * _step;
+    }
+
+    /**
+     * @brief Advance the network. Time is only ever integrated in whole
+     * internal steps; any remainder carries over to the next call.
+     * @param seconds Simulated time to advance by
+     */
+    auto advance(double seconds) -> void {
+        if (!(seconds > 0.0F)) {
+            return;
+        }
+        _pending += seconds;
+        // Allow for rounding, so that advancing by a whole number of steps
+        // never leaves the last one pending
+        while (_pending >= _step * (1.0F - STEP_TOLERANCE)) {
+            step();
+            _pending -= _step;
+        }
+    }
+
+  private:
+    auto step() -> void {
+        std::fill(_heat.begin(), _heat.end(), 0.0F);
+        for (const auto& link : _links) {
+            auto flow = link.conductance * (_nodes[link.b].temperature -
+                                            _nodes[link.a].temperature);
+            _heat[link.a] += flow;
+            _heat[link.b] -= flow;
+        }
+        for (NodeIndex i = 0; i < _nodes.size(); ++i) {
+            auto pumped = _drive[i] * _nodes[i].power;
+            _heat[i] += pumped;
+            if (_nodes[i].source.has_value()) {
+                _heat[_nodes[i].source.value()] -= pumped;
+            }
+        }
+        for (NodeIndex i = 0; i < _nodes.size(); ++i) {
+            if (!_nodes[i].fixed) {
+                _nodes[i].temperature +=
+                    (_heat[i] * _step) / _nodes[i].capacity;
+            }
+        }
+        ++_steps;
+    }
+
+    // The fastest node sets the step that keeps the integration stable.
+    // Changing the step after time has passed would rescale elapsed(), so
+    // the elapsed time is folded into the step count at the new size.
+    auto update_step() -> void {
+        std::vector<double> conductance(_nodes.size(), 0.0F);
+        for (const auto& link : _links) {
+            conductance[link.a] += link.conductance;
+            conductance[link.b] += link.conductance;
+        }
+        double step = MAX_STEP;
+        for (NodeIndex i = 0; i < _nodes.size(); ++i) {
+            if (!_nodes[i].fixed && conductance[i] > 0.0F) {
+                step = std::min(step, STABILITY_FRACTION *
+                                          _nodes[i].capacity / conductance[i]);
+            }
+        }
+        if (step != _step) {
+            auto elapsed_seconds = elapsed();
+            _step = step;
+            _steps = static_cast<uint64_t>(elapsed_seconds / _step);
+        }
+    }
+
+    std::vector<Node> _nodes = {};
+    std::vector<Link> _links = {};
+    std::vector<double> _drive = {};
+    std::vector<double> _heat = {};
+    double _step = MAX_STEP;
+    double _pending = 0.0F;
+    uint64_t _steps = 0;
+};
+
+/**
+ * @brief Parse a network from the text format described at the top of
+ * this file.
+ * @return The network, or nothing if any line could not be parsed
+ */
+inline auto parse(std::istream& input) -> std::optional<ThermalNetwork> {
+    auto network = ThermalNetwork();
+    std::string line;
+    while (std::getline(input, line)) {
+        auto comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream words(line);
+        std::string kind;
+        if (!(words >> kind)) {
+            continue;
+        }
+        if (kind == "node") {
+            auto node = Node();
+            if (!(words >> node.name)) {
+                return std::nullopt;
+            }
+            std::string field;
+            while (words >> field) {
+                if (field == "fixed") {
+                    node.fixed = true;
+                    continue;
+                }
+                auto equals = field.find('=');
+                if (equals == std::string::npos) {
+                    return std::nullopt;
+                }
+                auto key = field.substr(0, equals);
+                auto value = field.substr(equals + 1);
+                if (key == "source") {
+                    node.source = network.find(value);
+                    if (!node.source.has_value()) {
+                        return std::nullopt;
+                    }
+                    continue;
+                }
+                char* end = nullptr;
+                auto number = std::strtod(value.c_str(), &end);
+                if (value.empty() || *end != '\0') {
+                    return std::nullopt;
+                }
+                if (key == "capacity") {
+                    node.capacity = number;
+                } else if (key == "temperature") {
+                    node.temperature = number;
+                } else if (key == "power") {
+                    node.power = number;
+                } else {
+                    return std::nullopt;
+                }
+            }
+            if (!network.add_node(node).has_value()) {
+                return std::nullopt;
+            }
+        } else if (kind == "link") {
+            std::string a;
+            std::string b;
+            double conductance = 0.0F;
+            std::string extra;
+            if (!(words >> a >> b >> conductance) || (words >> extra)) {
+                return std::nullopt;
+            }
+            auto node_a = network.find(a);
+            auto node_b = network.find(b);
+            if (!node_a.has_value() || !node_b.has_value() ||
+                !network.add_link(node_a.value(), node_b.value(),
+                                  conductance)) {
+                return std::nullopt;
+            }
+        } else {
+            return std::nullopt;
+        }
+    }
+    return network;
+}
+
+/** Parse a network from a string, for built-in default networks.*/
+inline auto parse(std::string_view text) -> std::optional<ThermalNetwork> {
+    auto stream = std::istringstream(std::string(text));
+    return parse(stream);
+}
+
+/**
+ * @brief Load the network a simulator should use. If the environment
+ * variable \c var_name names a file, the network is loaded from it;
+ * otherwise the simulator's built-in network is used.
+ * @return The network, or nothing if the file couldn't be loaded. An error
+ * is printed in that case.
+ */
+inline auto load_from_environment(const char* var_name,
+                                  std::string_view default_network)
+    -> std::optional<ThermalNetwork> {
+    const auto* path = std::getenv(var_name);
+    if (path == nullptr || *path == '\0') {
+        return parse(default_network);
+    }
+    auto file = std::ifstream(path);
+    auto network = file ? parse(file) : std::nullopt;
+    if (!network.has_value()) {
+        std::cerr << "ERROR: Could not load thermal network from " << path
+                  << std::endl;
+    }
+    return network;
+}
+
+/**
+ * @brief Find a node that a simulator requires. The simulator can't run
+ * without it, so a missing node is reported and ends the process.
+ */
+inline auto require(const ThermalNetwork& network, std::string_view name)
+    -> NodeIndex {
+    auto node = network.find(name);
+    if (!node.has_value()) {
+        std::cerr << "ERROR: Thermal network has no node named " << name
+                  << std::endl;
+        exit(1);
+    }
+    return node.value();
+}
+
+}  // namespace thermal_network
@@ -19,7 +19,13 @@ class TestAT24C0XCPolicy {
     static constexpr const size_t PAGE_LENGTH = at24c0xc::PAGE_LENGTH;
     using Buffer = std::array<uint8_t, PAGES * PAGE_LENGTH>;
 
-    TestAT24C0XCPolicy() : _buffer(), _data_pointer(0), _write_protect(true) {
+    TestAT24C0XCPolicy()
+        : _buffer(),
+          _data_pointer(0),
+          _write_protect(true),
+          _reads(0),
+          _busy_polls(0),
+          _busy(0) {
         for (size_t i = 0; i < _buffer.size(); ++i) {
             _buffer[i] = 0;
         }
@@ -31,6 +37,14 @@ class TestAT24C0XCPolicy {
     auto i2c_write(uint8_t addr, Input data, size_t len) -> bool {
         // Ignore address for test purposes
         static_cast<void>(addr);
+        if (_busy > 0) {
+            // Still writing the last page, so the address isn't acknowledged
+            --_busy;
+            return false;
+        }
+        if (len > 1) {
+            _busy = _busy_polls;
+        }
         if (len > 0) {
             if (*data >= _buffer.size()) {
                 // Out of bounds write attempt
@@ -57,6 +71,10 @@ class TestAT24C0XCPolicy {
     auto i2c_write(uint8_t addr, uint8_t data_addr) {
         // Ignore address for test purposes
         static_cast<void>(addr);
+        if (_busy > 0) {
+            --_busy;
+            return false;
+        }
         if (data_addr < _buffer.size()) {
             _data_pointer = data_addr;
             return true;
@@ -68,6 +86,7 @@ class TestAT24C0XCPolicy {
     auto i2c_read(uint8_t addr, Input data, size_t len) -> bool {
         // Ignore address for test purposes
         static_cast<void>(addr);
+        ++_reads;
         // Data pointer is held over from the last transaction
         for (size_t i = 0; i < len; ++i, ++data) {
             *data = _buffer[_data_pointer++];
@@ -86,6 +105,11 @@ class TestAT24C0XCPolicy {
     Buffer _buffer;
     size_t _data_pointer;
     bool _write_protect;
+    // Number of read transactions
+    size_t _reads;
+    // How many times the device doesn't acknowledge after writing a page
+    size_t _busy_polls;
+    size_t _busy;
 };
 
 }  // namespace at24c0xc_test_policy
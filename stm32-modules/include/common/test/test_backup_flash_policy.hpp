@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "core/crc32.hpp"
+#include "core/firmware_update.hpp"
+
+namespace backup_flash_test_policy {
+
+using firmware_update::APPLICATION_OFFSET;
+using firmware_update::INTEGRITY_REGION_OFFSET;
+using firmware_update::Layout;
+using firmware_update::PROGRAM_LENGTH;
+
+static constexpr Layout TEST_LAYOUT{.partition_size = 8 * 2048,
+                                    .page_size = 2048,
+                                    .link_address = 0x08008000,
+                                    .name = "test-module"};
+
+/**
+ * Build an image that passes the startup app's checks, with \c length bytes
+ * of application after the integrity region. The gaps in the header are all
+ * ones, like a binary built with --gap-fill=0xFF.
+ */
+inline auto make_image(const Layout& layout, size_t length)
+    -> std::vector<uint8_t> {
+    auto image = std::vector<uint8_t>(APPLICATION_OFFSET + length, 0xFF);
+    for (size_t i = APPLICATION_OFFSET; i < image.size(); ++i) {
+        image[i] = static_cast<uint8_t>(i * 7);
+    }
+    auto put_word = [&image](size_t offset, uint32_t word) {
+        std::memcpy(&image[offset], &word, sizeof(word));
+    };
+    auto app_start = layout.link_address + APPLICATION_OFFSET;
+    // A thumb reset vector
+    put_word(firmware_update::RESET_VECTOR_OFFSET, app_start + 1);
+    put_word(INTEGRITY_REGION_OFFSET,
+             crc32::compute(image.begin() + APPLICATION_OFFSET, image.end()));
+    put_word(INTEGRITY_REGION_OFFSET + 4, length);
+    put_word(INTEGRITY_REGION_OFFSET + 8, app_start);
+    std::copy_n(layout.name, std::strlen(layout.name),
+                &image[INTEGRITY_REGION_OFFSET + 12]);
+    return image;
+}
+
+/** A backup partition in RAM that behaves like the microcontroller's flash.*/
+class TestBackupFlashPolicy {
+  public:
+    explicit TestBackupFlashPolicy(const Layout& layout = TEST_LAYOUT)
+        : _layout(layout),
+          _flash(layout.partition_size, 0xFF),
+          _programs(layout.partition_size / PROGRAM_LENGTH, 0) {}
+
+    // --- Policy fulfillment -----------
+
+    [[nodiscard]] auto backup_layout() const -> Layout { return _layout; }
+
+    auto backup_erase_page(uint32_t page) -> bool {
+        auto start = static_cast<size_t>(page) * _layout.page_size;
+        if (_fail_flash || start >= _flash.size()) {
+            return false;
+        }
+        std::fill_n(_flash.begin() + start, _layout.page_size, 0xFF);
+        std::fill_n(_programs.begin() + start / PROGRAM_LENGTH,
+                    _layout.page_size / PROGRAM_LENGTH, 0);
+        ++_erases;
+        return true;
+    }
+
+    auto backup_program(uint32_t offset, uint64_t value) -> bool {
+        if (_fail_flash || offset % PROGRAM_LENGTH != 0 ||
+            offset + PROGRAM_LENGTH > _flash.size()) {
+            return false;
+        }
+        // Like the hardware, a doubleword can only be programmed once after
+        // it's erased, even if it still reads as all ones, except with all
+        // zeroes
+        if (_programs[offset / PROGRAM_LENGTH] != 0 && value != 0) {
+            return false;
+        }
+        std::memcpy(&_flash[offset], &value, sizeof(value));
+        ++_programs[offset / PROGRAM_LENGTH];
+        return true;
+    }
+
+    [[nodiscard]] auto backup_read(uint32_t offset) const -> uint64_t {
+        uint64_t value = 0;
+        std::memcpy(&value, &_flash.at(offset), sizeof(value));
+        return value;
+    }
+
+    // --- Test helpers -----------
+
+    [[nodiscard]] auto update_requested() const -> bool {
+        return backup_read(_layout.partition_size - PROGRAM_LENGTH) ==
+               firmware_update::UPDATE_REQUEST_FLAG;
+    }
+
+    // How many times a doubleword was programmed since it was last erased
+    [[nodiscard]] auto programs(uint32_t offset) const -> size_t {
+        return _programs.at(offset / PROGRAM_LENGTH);
+    }
+
+    Layout _layout;
+    std::vector<uint8_t> _flash;
+    std::vector<size_t> _programs;
+    size_t _erases = 0;
+    bool _fail_flash = false;
+};
+
+}  // namespace backup_flash_test_policy
@@ -18,7 +18,13 @@ class TestM24128Policy {
     static constexpr const size_t PAGE_LENGTH = m24128::PAGE_LENGTH;
     using Buffer = std::array<uint8_t, 128 * PAGE_LENGTH>;
 
-    TestM24128Policy() : _buffer(), _data_pointer(0), _write_protect(true) {
+    TestM24128Policy()
+        : _buffer(),
+          _data_pointer(0),
+          _write_protect(true),
+          _reads(0),
+          _busy_polls(0),
+          _busy(0) {
         for (size_t i = 0; i < _buffer.size(); ++i) {
             _buffer[i] = 0;
         }
@@ -31,6 +37,14 @@ class TestM24128Policy {
         // Ignore address for test purposes
         static_cast<void>(addr);
 
+        if (_busy > 0) {
+            // Still writing the last page, so the address isn't acknowledged
+            --_busy;
+            return false;
+        }
+        if (len > 2) {
+            _busy = _busy_polls;
+        }
         if (len >= 2) {
             _data_pointer = (*data) << 8;
             ++data;
@@ -63,6 +77,7 @@ class TestM24128Policy {
     auto i2c_read(uint8_t addr, Input data, size_t len) -> bool {
         // Ignore address for test purposes
         static_cast<void>(addr);
+        ++_reads;
         // Data pointer is held over from the last transaction
         for (size_t i = 0; i < len; ++i, ++data) {
             *data = _buffer[_data_pointer++];
@@ -81,6 +96,11 @@ class TestM24128Policy {
     Buffer _buffer;
     size_t _data_pointer;
     bool _write_protect;
+    // Number of read transactions
+    size_t _reads;
+    // How many times the device doesn't acknowledge after writing a page
+    size_t _busy_polls;
+    size_t _busy;
 };
 
 }  // namespace m24128_test_policy
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include <stdexcept>
 
@@ -11,12 +12,13 @@ class TestMessageQueue {
     std::deque<Message> backing_deque;
     bool act_full;
     std::string name;
+    size_t high_water;
     const static size_t index = Index;
 
     struct Tag {};
 
     explicit TestMessageQueue(const std::string& name)
-        : backing_deque(), act_full(false), name(name) {}
+        : backing_deque(), act_full(false), name(name), high_water(0) {}
 
     [[nodiscard]] auto try_send(const Message& message,
                                 const uint32_t timeout_ticks = 0) -> bool {
@@ -24,6 +26,7 @@ class TestMessageQueue {
             return false;
         }
         backing_deque.push_back(message);
+        high_water = std::max(high_water, backing_deque.size());
         return true;
     }
 
@@ -56,4 +59,6 @@ class TestMessageQueue {
     [[nodiscard]] auto has_message() const -> bool {
         return !backing_deque.empty();
     }
+
+    [[nodiscard]] auto high_water_mark() const -> size_t { return high_water; }
 };
@@ -0,0 +1,33 @@
+/*
+ * Tracks the stack of every statically allocated task so that the system
+ * task can report how much of each one has been used
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "FreeRTOS.h"
+#include "core/task_memory.hpp"
+#include "task.h"
+
+namespace freertos_task_registry {
+
+// Every task created with xTaskCreateStatic, plus the kernel's idle and
+// timer tasks
+static constexpr size_t MAX_TASKS = 8;
+
+// Called by each task's start() function with the task it just created
+auto register_task(TaskHandle_t handle, uint32_t stack_words) -> void;
+
+// The idle and timer tasks only exist once the scheduler is running, so
+// this has to be called from inside a task
+auto register_kernel_tasks() -> void;
+
+auto task_count() -> size_t;
+
+auto stack_usage(size_t index) -> task_memory::StackUsage;
+
+auto ram_usage() -> task_memory::RamUsage;
+
+}  // namespace freertos_task_registry
@@ -0,0 +1,28 @@
+#ifndef TASK_STATS_HARDWARE_H__
+#define TASK_STATS_HARDWARE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+#include <stdint.h>
+
+/**
+ * @brief Start the DWT cycle counter that times the tasks.
+ */
+void task_stats_hardware_init(void);
+
+/**
+ * @brief Read the DWT cycle counter. It counts core clock cycles and wraps
+ * at 32 bits.
+ */
+uint32_t task_stats_hardware_cycles(void);
+
+/**
+ * @brief The number of core clock cycles in a microsecond.
+ */
+uint32_t task_stats_hardware_cycles_per_us(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // TASK_STATS_HARDWARE_H__
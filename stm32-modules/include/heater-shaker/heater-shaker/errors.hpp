@@ -49,6 +49,9 @@ enum class ErrorCode {
     PLATE_LOCK_NOT_CLOSED = 126,
     MOTOR_HOMING = 127,
     FAULTY_LATCH_SENSORS = 128,
+    MOTOR_ILLEGAL_FILTER_WINDOW = 129,
+    MOTOR_PROFILE_SEGMENT_INVALID = 130,
+    MOTOR_PROFILE_EMPTY = 131,
     HEATER_THERMISTOR_A_DISCONNECTED = 201,
     HEATER_THERMISTOR_A_SHORT = 202,
     HEATER_THERMISTOR_A_OVERTEMP = 203,
@@ -64,6 +67,7 @@ enum class ErrorCode {
     HEATER_HARDWARE_SHORT_CIRCUIT = 214,
     HEATER_HARDWARE_OPEN_CIRCUIT = 215,
     HEATER_HARDWARE_OVERCURRENT_CIRCUIT = 216,
+    HEATER_AUTOTUNE_FAILED = 217,
     SYSTEM_SERIAL_NUMBER_INVALID = 301,
     SYSTEM_SERIAL_NUMBER_HAL_ERROR = 302,
     SYSTEM_LED_I2C_NOT_READY = 303,
@@ -2,12 +2,34 @@
  * @file flash.hpp
  * @brief Implements a FLASH class that is specialized towards
  * holding the Thermal Offset Constants for the Heater-Shaker heat plate.
+ *
+ * @details The constants live in one page of the microcontroller's flash,
+ * as a list of records that only grows. Each record is the B constant, the
+ * C constant and a trailer holding a key and the CRC-32 of the constants,
+ * one doubleword each. The trailer is programmed last, so a record that was
+ * cut off by a reset fails its check, and the newest record that passes is
+ * the one that counts.
+ *
+ * Writing new constants just programs the next record, which takes a few
+ * microseconds. The page is only erased once every record in it is used,
+ * and \ref flash::Flash::erase_pending tells the owner when that is, so the
+ * erase can wait until it doesn't get in the way of anything.
+ *
+ * Before this layout, the page held the B and C constants followed by a
+ * flag of 1. Those three doublewords are where the first record goes, and
+ * the flag never passes as a trailer, so they are read as constants only
+ * while no record has been written.
  */
 
 #pragma once
 
+#include <array>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+
+#include "core/crc32.hpp"
 
 namespace flash {
 
@@ -22,17 +44,22 @@ namespace flash {
  * resulting temperature relationship can be summarized as follows:
  *
  * > Plate Temp = ((B + 1) * Measured Temp) + C
- *
- * One of the FLASH addresses is reserved for a flag to indicate whether
- * the values have been written. The \ref FLASHFlag enum captures the
- * valid states of this page. The page indicates what error detection,
- * if any, is included with the FLASH constant values.
- *
  */
 struct OffsetConstants {
     // The value of the constants B and C
     double b, c;
-    uint64_t flag;
+};
+
+/** Access to the page of flash that holds the constants.*/
+template <typename Policy>
+concept FlashPolicy = requires(Policy& p, uint32_t offset, uint64_t value) {
+    // Read the doubleword at an offset from the start of the page
+    { p.config_flash_read(offset) } -> std::same_as<uint64_t>;
+    // Program the doubleword at an offset from the start of the page. Only
+    // erased doublewords can be programmed.
+    { p.config_flash_program(offset, value) } -> std::same_as<bool>;
+    // Erase the whole page
+    { p.config_flash_erase() } -> std::same_as<bool>;
 };
 
 /**
@@ -41,37 +68,38 @@ struct OffsetConstants {
  */
 class Flash {
   public:
-    Flash() {}
+    static constexpr uint32_t PAGE_SIZE = 2048;
+    static constexpr uint32_t DOUBLEWORD = sizeof(uint64_t);
+    // B, C and the trailer
+    static constexpr uint32_t RECORD_LENGTH = 3 * DOUBLEWORD;
+    static constexpr uint32_t RECORDS = PAGE_SIZE / RECORD_LENGTH;
+    // "OFST" in ASCII, in the upper half of every trailer
+    static constexpr uint32_t RECORD_KEY = 0x5453464F;
+    // Erased flash reads as all ones
+    static constexpr uint64_t ERASED = UINT64_MAX;
+
+    Flash() = default;
 
     /**
-     * @brief Get the offset constants from FLASH
+     * @brief Get the offset constants. Only the first call reads the FLASH.
      *
      * @tparam Policy for reading from FLASH
      * @param policy Instance of Policy
      * @return OffsetConstants containing the B and C constants, or the
      * default values if the FLASH doesn't have programmed values.
      */
-    template <typename Policy>
+    template <FlashPolicy Policy>
     [[nodiscard]] auto get_offset_constants(Policy& policy) -> OffsetConstants {
-        OffsetConstants constants = {
-            .b = OFFSET_B_DEFAULT_CONST,
-            .c = OFFSET_C_DEFAULT_CONST,
-            .flag = static_cast<uint64_t>(
-                flash::Flash::FLASHFlag::WRITTEN_NO_CHECKSUM)};
-        OffsetConstants receive = policy.get_thermal_offsets();
-        if (receive.flag ==
-            static_cast<uint64_t>(FLASHFlag::WRITTEN_NO_CHECKSUM)) {
-            constants.b = receive.b;
-            constants.c = receive.c;
-        } else {
-            set_offset_constants(constants, policy);
+        if (!_initialized) {
+            scan(policy);
         }
-        _initialized = true;
-        return constants;
+        return _constants;
     }
 
     /**
-     * @brief Write new offset constants to the FLASH
+     * @brief Write new offset constants to the FLASH by adding a record.
+     * The page is only erased here if it is already full and the pending
+     * erase hasn't happened yet.
      *
      * @tparam Policy for writing to the FLASH
      * @param constants OffsetConstants containing the B and C constants to
@@ -79,15 +107,50 @@ class Flash {
      * @param policy Instance of Policy
      * @return True if the constants were written, false otherwise
      */
-    template <typename Policy>
+    template <FlashPolicy Policy>
     auto set_offset_constants(OffsetConstants constants, Policy& policy)
         -> bool {
-        if (!policy.set_thermal_offsets(&constants)) {
+        if (!_initialized) {
+            scan(policy);
+        }
+        if (_next == RECORDS) {
+            if (!policy.config_flash_erase()) {
+                return false;
+            }
+            _next = 0;
+        }
+        if (!append(constants, policy)) {
+            return false;
+        }
+        _constants = constants;
+        _erase_pending = (_next == RECORDS);
+        return true;
+    }
+
+    /**
+     * @brief Whether the page is full, so that it should be erased before
+     * the next write.
+     */
+    [[nodiscard]] auto erase_pending() const -> bool { return _erase_pending; }
+
+    /**
+     * @brief Erase the page and write the current constants back into it.
+     * This stalls the processor while the page erases, so call it from
+     * where that doesn't matter. It is only tried once per full page.
+     *
+     * @return True if the page was erased and rewritten
+     */
+    template <FlashPolicy Policy>
+    auto erase_if_full(Policy& policy) -> bool {
+        if (!_erase_pending) {
+            return false;
+        }
+        _erase_pending = false;
+        if (!policy.config_flash_erase()) {
             return false;
-        } else {
-            _initialized = true;
-            return true;
         }
+        _next = 0;
+        return append(_constants, policy);
     }
 
     /**
@@ -97,15 +160,80 @@ class Flash {
      */
     [[nodiscard]] auto initialized() const -> bool { return _initialized; }
 
-    // Enumeration of the FLASH_CONST_FLAG values. Default erase value of FLASH
-    // is all 1s
-    enum class FLASHFlag : uint64_t { WRITTEN_NO_CHECKSUM = 1, INVALID = 0xFF };
-
   private:
     /** Default values for constants.*/
     static constexpr double OFFSET_B_DEFAULT_CONST = -0.0259F;
     static constexpr double OFFSET_C_DEFAULT_CONST = 0.6755F;
+    /** The flag that followed the constants before records were used.*/
+    static constexpr uint64_t LEGACY_WRITTEN_FLAG = 1;
+
+    static auto to_double(uint64_t value) -> double {
+        double ret = 0;
+        std::memcpy(&ret, &value, sizeof(ret));
+        return ret;
+    }
+
+    static auto to_doubleword(double value) -> uint64_t {
+        uint64_t ret = 0;
+        std::memcpy(&ret, &value, sizeof(ret));
+        return ret;
+    }
+
+    static auto trailer(uint64_t b, uint64_t c) -> uint64_t {
+        auto bytes = std::array<uint8_t, 2 * DOUBLEWORD>{};
+        std::memcpy(bytes.data(), &b, DOUBLEWORD);
+        std::memcpy(&bytes.at(DOUBLEWORD), &c, DOUBLEWORD);
+        auto crc = crc32::compute(bytes.cbegin(), bytes.cend());
+        return (static_cast<uint64_t>(RECORD_KEY) << 32) | crc;
+    }
+
+    /** Find the newest record and where the next one goes.*/
+    template <FlashPolicy Policy>
+    auto scan(Policy& policy) -> void {
+        _constants = OffsetConstants{.b = OFFSET_B_DEFAULT_CONST,
+                                     .c = OFFSET_C_DEFAULT_CONST};
+        _next = 0;
+        if (policy.config_flash_read(2 * DOUBLEWORD) == LEGACY_WRITTEN_FLAG) {
+            _constants.b = to_double(policy.config_flash_read(0));
+            _constants.c = to_double(policy.config_flash_read(DOUBLEWORD));
+        }
+        for (uint32_t record = 0; record < RECORDS; ++record) {
+            auto offset = record * RECORD_LENGTH;
+            auto b = policy.config_flash_read(offset);
+            auto c = policy.config_flash_read(offset + DOUBLEWORD);
+            auto check = policy.config_flash_read(offset + 2 * DOUBLEWORD);
+            if (b == ERASED && c == ERASED && check == ERASED) {
+                continue;
+            }
+            // Even a record that was cut off can't be programmed again
+            _next = record + 1;
+            if (check == trailer(b, c)) {
+                _constants.b = to_double(b);
+                _constants.c = to_double(c);
+            }
+        }
+        _erase_pending = (_next == RECORDS);
+        _initialized = true;
+    }
+
+    template <FlashPolicy Policy>
+    auto append(const OffsetConstants& constants, Policy& policy) -> bool {
+        auto offset = _next * RECORD_LENGTH;
+        auto b = to_doubleword(constants.b);
+        auto c = to_doubleword(constants.c);
+        // Whatever happens, this record's space is used now
+        ++_next;
+        return policy.config_flash_program(offset, b) &&
+               policy.config_flash_program(offset + DOUBLEWORD, c) &&
+               policy.config_flash_program(offset + 2 * DOUBLEWORD,
+                                           trailer(b, c));
+    }
 
+    // The newest constants, or the defaults
+    OffsetConstants _constants = {};
+    // The index of the next record to write
+    uint32_t _next = 0;
+    bool _erase_pending = false;
     // Whether the constants have been read from the FLASH since startup.
     // Even if the FLASH is empty, this flag is set after attempting
     // to read so that the firmware doesn't try to keep making redundant
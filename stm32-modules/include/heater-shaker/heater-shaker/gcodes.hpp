@@ -16,9 +16,11 @@
 #include <cstring>
 #include <iterator>
 #include <optional>
+#include <span>
 #include <utility>
 
 #include "core/gcode_parser.hpp"
+#include "core/task_memory.hpp"
 #include "core/utility.hpp"
 #include "heater-shaker/errors.hpp"
 #include "systemwide.h"
@@ -262,6 +264,49 @@ struct SetAcceleration {
     }
 };
 
+struct SetRPMFilterWindow {
+    /*
+    ** SetRPMFilterWindow is a debug command that sets how many speed
+    ** measurements are averaged to produce the reported RPM, which is also
+    ** the RPM used to decide when the plate is slow enough to home. Larger
+    ** windows smooth more but respond more slowly to speed changes.
+    ** Format: M205.D Sxx
+    ** Example: M205.D S16
+    */
+    using ParseResult = std::optional<SetRPMFilterWindow>;
+    static constexpr auto prefix =
+        std::array{'M', '2', '0', '5', '.', 'D', ' ', 'S'};
+    static constexpr const char* response = "M205.D OK\n";
+
+    uint16_t samples;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto samples_parse = parse_value<uint16_t>(working, limit);
+        if (!samples_parse.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(
+                SetRPMFilterWindow{.samples = samples_parse.first.value()}),
+            samples_parse.second);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
 struct GetTemperatureDebug {
     /**
      * GetTemperatureDebug uses M105.D arbitrarily. It responds with
@@ -470,6 +515,88 @@ struct SetPIDConstants {
     }
 };
 
+/**
+ * StartHeaterAutotune uses M303. It runs a relay-feedback autotune of the
+ * heater PID constants around a target temperature, which takes several
+ * minutes. The heater must not be controlling a temperature.
+ *
+ * - S is the temperature to oscillate the heater pad around
+ * - C is the number of oscillations to average over, after a first one that
+ *   is discarded
+ *
+ * The new constants replace the current heater constants (see M301) as soon
+ * as tuning finishes, and are reported with an asynchronous line. If the pad
+ * does not settle into an oscillation, ERR217 is sent asynchronously
+ * instead. Setting a temperature or deactivating the heater cancels tuning.
+ *
+ * Format: M303 S<target> [C<cycles>]\n
+ * Returns: M303 OK\n
+ * and later: async M303 DONE P:<kp> I:<ki> D:<kd> OK\n
+ */
+struct StartHeaterAutotune {
+    using ParseResult = std::optional<StartHeaterAutotune>;
+    static constexpr auto prefix = std::array{'M', '3', '0', '3'};
+    static constexpr const char* response = "M303 OK\n";
+
+    struct TargetArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = true;
+        bool present = false;
+        float value = 0;
+    };
+
+    struct CyclesArg {
+        static constexpr auto prefix = std::array{'C'};
+        static constexpr bool required = false;
+        bool present = false;
+        int value = 0;
+    };
+
+    constexpr static int default_cycles = 4;
+
+    double target;
+    int cycles;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res = gcode::SingleParser<TargetArg, CyclesArg>::parse_gcode(
+            input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto [target, cycles] = res.first.value();
+        auto ret = StartHeaterAutotune{
+            .target = target.value,
+            .cycles = cycles.present ? cycles.value : default_cycles};
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InLimit, InputIt>
+    static auto write_event_into(InputIt buf, InLimit limit, double kp,
+                                 double ki, double kd) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "async M303 DONE P:%0.4f I:%0.4f D:%0.4f OK\n",
+                            static_cast<float>(kp), static_cast<float>(ki),
+                            static_cast<float>(kd));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+};
+
 struct SetHeaterPowerTest {
     /**
      * SetHeaterPowerTest is a testing command to directly command heater power
@@ -1188,4 +1315,311 @@ struct DeactivateHeater {
     }
 };
 
+/**
+ * SetSpeedProfileSegment uses M244. It uploads one segment of a speed
+ * profile to be run on the device by StartSpeedProfile. Each segment ramps
+ * to S (rpm) at A (rpm/s) and then holds that speed for H (ms).
+ *
+ * Segments must be written in order starting from I0. Writing a segment
+ * discards any segments after it, so a new profile is uploaded by writing
+ * it again from I0. A segment whose speed is outside the motor's range
+ * (0-4110rpm) is rejected here rather than when the profile reaches it.
+ *
+ * Format: M244 I<index> S<rpm> A<rpm/s> H<ms>\n
+ * Example: M244 I0 S1500 A2000 H10000\n
+ */
+struct SetSpeedProfileSegment {
+    using ParseResult = std::optional<SetSpeedProfileSegment>;
+    static constexpr auto prefix = std::array{'M', '2', '4', '4', ' ', 'I'};
+    static constexpr auto prefix_rpm = std::array{' ', 'S'};
+    static constexpr auto prefix_ramp = std::array{' ', 'A'};
+    static constexpr auto prefix_hold = std::array{' ', 'H'};
+    static constexpr const char* response = "M244 OK\n";
+
+    uint16_t index;
+    int16_t rpm;
+    int32_t ramp_rpm_per_s;
+    uint32_t hold_ms;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto index = parse_value<uint16_t>(working, limit);
+        if (!index.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        working = prefix_matches(index.second, limit, prefix_rpm);
+        if (working == index.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto rpm = parse_value<int16_t>(working, limit);
+        if (!rpm.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        working = prefix_matches(rpm.second, limit, prefix_ramp);
+        if (working == rpm.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto ramp = parse_value<int32_t>(working, limit);
+        if (!ramp.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        working = prefix_matches(ramp.second, limit, prefix_hold);
+        if (working == ramp.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto hold = parse_value<uint32_t>(working, limit);
+        if (!hold.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(SetSpeedProfileSegment{
+                .index = index.first.value(),
+                .rpm = rpm.first.value(),
+                .ramp_rpm_per_s = ramp.first.value(),
+                .hold_ms = hold.first.value()}),
+            hold.second);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+/**
+ * StartSpeedProfile uses M245. It starts running the segments uploaded with
+ * SetSpeedProfileSegment and is acknowledged as soon as the profile starts.
+ * Progress can be checked with GetSpeedProfileStatus. Any SetRPM or Home
+ * command stops a running profile.
+ *
+ * Format: M245\n
+ */
+struct StartSpeedProfile {
+    using ParseResult = std::optional<StartSpeedProfile>;
+    static constexpr auto prefix = std::array{'M', '2', '4', '5'};
+    static constexpr const char* response = "M245 OK\n";
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(StartSpeedProfile()), working);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+/**
+ * GetSpeedProfileStatus uses M246. It reports the progress of the speed
+ * profile:
+ *
+ * - whether the profile is running (R)
+ * - the index of the current segment (I)
+ * - the number of segments in the profile (N)
+ * - the time spent in the current segment, in ms (T)
+ * - the time since the profile started, in ms (E)
+ *
+ * Format: M246\n
+ * Returns: M246 R:1 I:2 N:4 T:1500 E:12500 OK\n
+ */
+struct GetSpeedProfileStatus {
+    using ParseResult = std::optional<GetSpeedProfileStatus>;
+    static constexpr auto prefix = std::array{'M', '2', '4', '6'};
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetSpeedProfileStatus()), working);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit,
+                                    bool running, uint16_t segment,
+                                    uint16_t segment_count,
+                                    uint32_t segment_elapsed_ms,
+                                    uint32_t total_elapsed_ms) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "M246 R:%d I:%u N:%u T:%lu E:%lu OK\n",
+                            running ? 1 : 0, static_cast<unsigned>(segment),
+                            static_cast<unsigned>(segment_count),
+                            static_cast<unsigned long>(segment_elapsed_ms),
+                            static_cast<unsigned long>(total_elapsed_ms));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+};
+
+/**
+ * GetTaskMemory uses M906.D. It reports how much memory the firmware is
+ * using: the static RAM and C heap, and then, a page at a time, the stack
+ * of every statically allocated task. For each task, the size of its stack
+ * and the least free space it has had are given in stack words. The host
+ * should keep requesting with an increasing start index until it has read
+ * all N tasks.
+ *
+ * Format: M906.D [S<first task index>]\n
+ * Returns: M906.D N:<total> S:<start> D:<data bytes> B:<bss bytes>
+ * H:<heap peak bytes>/<heap used bytes> <name>:<size>/<min free> ... OK\n
+ */
+struct GetTaskMemory {
+    using ParseResult = std::optional<GetTaskMemory>;
+    static constexpr auto prefix = std::array{'M', '9', '0', '6', '.', 'D'};
+
+    struct StartArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = false;
+        bool present = false;
+        uint32_t value = 0;
+    };
+
+    uint32_t start;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res =
+            gcode::SingleParser<StartArg>::parse_gcode(input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto arguments = res.first.value();
+        auto ret = GetTaskMemory{.start = 0};
+        if (std::get<0>(arguments).present) {
+            ret.start = std::get<0>(arguments).value;
+        }
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(
+        InputIt buf, InLimit limit, uint32_t total, uint32_t start,
+        const task_memory::RamUsage& ram,
+        std::span<const task_memory::StackUsage> stacks) -> InputIt {
+        // Each chunk is clamped to the space remaining so a short buffer
+        // is filled up to its limit rather than overrun
+        auto advance = [&buf, &limit](int res) -> bool {
+            if (res <= 0) {
+                return false;
+            }
+            buf += std::min(static_cast<decltype(limit - buf)>(res),
+                            (limit - buf));
+            return buf < limit;
+        };
+        if (!advance(snprintf(&*buf, (limit - buf),
+                              "M906.D N:%lu S:%lu D:%lu B:%lu H:%lu/%lu",
+                              static_cast<unsigned long>(total),
+                              static_cast<unsigned long>(start),
+                              static_cast<unsigned long>(ram.data_bytes),
+                              static_cast<unsigned long>(ram.bss_bytes),
+                              static_cast<unsigned long>(ram.heap_peak_bytes),
+                              static_cast<unsigned long>(
+                                  ram.heap_used_bytes)))) {
+            return buf;
+        }
+        for (const auto& stack : stacks) {
+            if (!advance(snprintf(
+                    &*buf, (limit - buf), " %s:%lu/%lu", stack.name,
+                    static_cast<unsigned long>(stack.size_words),
+                    static_cast<unsigned long>(stack.min_free_words)))) {
+                return buf;
+            }
+        }
+        return write_string_to_iterpair(buf, limit, " OK\n");
+    }
+};
+
+/**
+ * GetTaskStats uses M990.D. It dumps the runtime stats of every task: how
+ * many passes its handler has made, the min, average and max time of one
+ * pass, the deepest its queue has been and a histogram of the pass times.
+ * Each histogram bucket covers four times the range of the one before,
+ * starting with under 16us. All times are in microseconds.
+ *
+ * Format: M990.D\n
+ * Returns: M990.D <task>:N=<passes>,MIN=<us>,AVG=<us>,MAX=<us>,Q=<depth>,
+ * H=<bucket>/<bucket>/... ... OK\n
+ */
+struct GetTaskStats {
+    using ParseResult = std::optional<GetTaskStats>;
+    static constexpr auto prefix = std::array{'M', '9', '9', '0', '.', 'D'};
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetTaskStats()), working);
+    }
+
+    template <typename InputIt, typename InLimit, typename Registry>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit,
+                                    const Registry& registry) -> InputIt {
+        auto write = [&buf, limit](const char* format, auto... args) {
+            if (buf >= limit) {
+                return;
+            }
+            auto res = snprintf(&*buf, (limit - buf), format, args...);
+            if (res > 0) {
+                buf += std::min(static_cast<decltype(limit - buf)>(res),
+                                (limit - buf));
+            }
+        };
+        buf = write_string_to_iterpair(buf, limit, "M990.D");
+        for (const auto& task : registry) {
+            const auto& handler = task.handler();
+            write(" %s:N=%lu,MIN=%lu,AVG=%lu,MAX=%lu,Q=%lu,H=", task.name(),
+                  static_cast<unsigned long>(handler.count()),
+                  static_cast<unsigned long>(handler.min()),
+                  static_cast<unsigned long>(handler.average()),
+                  static_cast<unsigned long>(handler.max()),
+                  static_cast<unsigned long>(task.queue_high_water()));
+            const char* separator = "";
+            for (auto bucket : handler.histogram()) {
+                write("%s%lu", separator, static_cast<unsigned long>(bucket));
+                separator = "/";
+            }
+        }
+        return write_string_to_iterpair(buf, limit, " OK\n");
+    }
+};
+
 }  // namespace gcode
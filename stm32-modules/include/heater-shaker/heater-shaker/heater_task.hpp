@@ -9,6 +9,7 @@
 #include <variant>
 
 #include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
 #include "core/thermistor_conversion.hpp"
 #include "hal/message_queue.hpp"
 #include "heater-shaker/errors.hpp"
@@ -41,6 +42,8 @@ concept HeaterExecutionPolicy = requires(Policy& p, const Policy& cp) {
     // disable_power_output should fully turn off the driver (set_power_output
     // will usually turn it on at least a little bit)
     {p.disable_power_output()};
+    // Access to the page of flash that holds the offset constants
+    requires flash::FlashPolicy<Policy>;
 };
 
 struct State {
@@ -49,6 +52,7 @@ struct State {
         ERROR,
         CONTROLLING,
         POWER_TEST,
+        AUTOTUNING,
     };
     Status system_status;
     enum LEDStatus {
@@ -126,6 +130,14 @@ class HeaterTask {
     static constexpr double KD_MIN = -200;
     static constexpr double KD_MAX = 200;
     static constexpr double HOLDING_THRESHOLD = 2.5F;
+    // The pad can't cool, so the autotune relay switches it fully on and off
+    // and the pad cools passively between pulses
+    static constexpr double AUTOTUNE_RELAY_POWER = 1.0F;
+    // Band around the autotune target before the relay switches, in ºC
+    static constexpr double AUTOTUNE_HYSTERESIS = 0.5F;
+    static constexpr double AUTOTUNE_TIMEOUT_SECONDS = 1800.0F;
+    // The pad has to be above ambient to cool between pulses
+    static constexpr double AUTOTUNE_TARGET_MIN = 30.0F;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     static constexpr double CONTROL_PERIOD_S =
         static_cast<uint32_t>(CONTROL_PERIOD_TICKS) * 0.001;
@@ -176,7 +188,8 @@ class HeaterTask {
           setpoint(std::nullopt),
           _flash(),
           _offset_constants{.b = OFFSET_DEFAULT_CONST_B,
-                            .c = OFFSET_DEFAULT_CONST_C} {}
+                            .c = OFFSET_DEFAULT_CONST_C},
+          _autotune() {}
     HeaterTask(const HeaterTask& other) = delete;
     auto operator=(const HeaterTask& other) -> HeaterTask& = delete;
     HeaterTask(HeaterTask&& other) noexcept = delete;
@@ -224,6 +237,15 @@ class HeaterTask {
                 this->visit_message(msg, policy);
             },
             message);
+
+        // Erasing the full page of constants stalls everything running
+        // from flash, motor control included, so it waits until the heater
+        // is off and the motor is stopped. The newest constants are written
+        // straight back from RAM.
+        if (!setpoint.has_value() && _flash.erase_pending() &&
+            task_registry->motor->idle()) {
+            static_cast<void>(_flash.erase_if_full(policy));
+        }
     }
 
     [[nodiscard]] auto get_pid() const -> const PID& { return pid; }
@@ -264,6 +286,7 @@ class HeaterTask {
                 response.with_error =
                     errors::ErrorCode::HEATER_ILLEGAL_TARGET_TEMPERATURE;
             } else {
+                _autotune.stop();
                 setpoint = msg.target_temperature;
                 pid.arm_integrator_reset(setpoint.value() - pad_temperature());
                 state.system_status = State::CONTROLLING;
@@ -286,6 +309,7 @@ class HeaterTask {
                        Policy& policy) -> void {
         policy.disable_power_output();
         setpoint = std::nullopt;
+        _autotune.stop();
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
         if (state.system_status == State::ERROR) {
@@ -407,36 +431,55 @@ class HeaterTask {
         }
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
         if (state.system_status == State::CONTROLLING) {
-            HEATPAD_CIRCUIT_ERROR error = policy.set_power_output(
-                pid.compute(setpoint.value() - pad_temperature()));
-            if (error != HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_NO_ERROR) {
-                state.system_status = State::ERROR;
-                setpoint = std::nullopt;
-                auto error_message = messages::ErrorMessage{};
-                if (error == HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_OPEN) {
-                    error_message.code =
-                        errors::ErrorCode::HEATER_HARDWARE_OPEN_CIRCUIT;
-                    state.error_bitmap |= State::OPEN_CIRCUIT_ERROR;
-                } else if (error ==
-                           HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_SHORTED) {
-                    error_message.code =
-                        errors::ErrorCode::HEATER_HARDWARE_SHORT_CIRCUIT;
-                    state.error_bitmap |= State::SHORT_CIRCUIT_ERROR;
-                } else if (error ==
-                           HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_OVERCURRENT) {
-                    error_message.code =
-                        errors::ErrorCode::HEATER_HARDWARE_OVERCURRENT_CIRCUIT;
-                    state.error_bitmap |= State::OVERCURRENT_CIRCUIT_ERROR;
-                }
-                static_cast<void>(
-                    task_registry->comms->get_message_queue().try_send(
-                        error_message));
-            }
+            handle_circuit_error(policy.set_power_output(
+                pid.compute(setpoint.value() - pad_temperature())));
+        } else if (state.system_status == State::AUTOTUNING) {
+            update_autotune(policy);
         } else if (state.system_status != State::POWER_TEST) {
             policy.disable_power_output();
         }
     }
 
+    template <typename Policy>
+    requires HeaterExecutionPolicy<Policy>
+    auto visit_message(const messages::StartAutotuneMessage& msg,
+                       Policy& policy) -> void {
+        // Like a new target temperature, tuning replaces whatever the heater
+        // was doing before
+        try_latch_disarm(policy);
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        auto config = relay_autotune::Config{
+            .setpoint = msg.target,
+            .output_high = AUTOTUNE_RELAY_POWER,
+            .output_low = 0.0F,
+            .hysteresis = AUTOTUNE_HYSTERESIS,
+            .cycles = static_cast<uint8_t>(std::clamp(
+                msg.cycles, 0,
+                static_cast<int>(relay_autotune::RelayAutotune::MAX_CYCLES))),
+            .timeout = AUTOTUNE_TIMEOUT_SECONDS};
+        if (state.system_status == State::ERROR) {
+            response.with_error = most_relevant_error();
+        } else if (msg.target > MAX_CONTROLLABLE_TEMPERATURE ||
+                   msg.target < AUTOTUNE_TARGET_MIN) {
+            response.with_error =
+                errors::ErrorCode::HEATER_ILLEGAL_TARGET_TEMPERATURE;
+        } else if (msg.cycles != config.cycles ||
+                   !relay_autotune::RelayAutotune::valid(config)) {
+            response.with_error =
+                errors::ErrorCode::HEATER_CONSTANT_OUT_OF_RANGE;
+        } else {
+            policy.disable_power_output();
+            static_cast<void>(_autotune.start(config));
+            // Keeping a setpoint reports the target and holds off flash
+            // erases for as long as the heater is running
+            setpoint = msg.target;
+            state.system_status = State::AUTOTUNING;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
     template <typename Policy>
     requires HeaterExecutionPolicy<Policy>
     auto visit_message(const messages::SetPowerTestMessage& msg, Policy& policy)
@@ -453,6 +496,7 @@ class HeaterTask {
             } else {
                 policy.set_power_output(power);
             }
+            _autotune.stop();
             setpoint = power;
             state.system_status = State::POWER_TEST;
         }
@@ -473,9 +517,6 @@ class HeaterTask {
         if (msg.c_set) {
             _offset_constants.c = msg.const_c;
         }
-        _offset_constants.flag =
-            static_cast<uint64_t>(flash::Flash::FLASHFlag::WRITTEN_NO_CHECKSUM);
-
         if (!_flash.template set_offset_constants(_offset_constants, policy)) {
             // Could not write to the flash.
             response.with_error = errors::ErrorCode::SYSTEM_FLASH_ERROR;
@@ -600,10 +641,82 @@ class HeaterTask {
         return false;
     }
 
+    /**
+     * @brief Record a heatpad circuit error reported when setting the
+     * output power, and tell the host about it.
+     */
+    auto handle_circuit_error(HEATPAD_CIRCUIT_ERROR error) -> void {
+        if (error == HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_NO_ERROR) {
+            return;
+        }
+        state.system_status = State::ERROR;
+        setpoint = std::nullopt;
+        auto error_message = messages::ErrorMessage{};
+        if (error == HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_OPEN) {
+            error_message.code =
+                errors::ErrorCode::HEATER_HARDWARE_OPEN_CIRCUIT;
+            state.error_bitmap |= State::OPEN_CIRCUIT_ERROR;
+        } else if (error == HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_SHORTED) {
+            error_message.code =
+                errors::ErrorCode::HEATER_HARDWARE_SHORT_CIRCUIT;
+            state.error_bitmap |= State::SHORT_CIRCUIT_ERROR;
+        } else if (error ==
+                   HEATPAD_CIRCUIT_ERROR::HEATPAD_CIRCUIT_OVERCURRENT) {
+            error_message.code =
+                errors::ErrorCode::HEATER_HARDWARE_OVERCURRENT_CIRCUIT;
+            state.error_bitmap |= State::OVERCURRENT_CIRCUIT_ERROR;
+        }
+        static_cast<void>(
+            task_registry->comms->get_message_queue().try_send(error_message));
+    }
+
+    /**
+     * @brief Drive the heater from the relay autotuner with the latest pad
+     * temperature. Once the autotuner stops, the heater is turned off and
+     * the result is applied and reported.
+     */
+    template <typename Policy>
+    requires HeaterExecutionPolicy<Policy>
+    auto update_autotune(Policy& policy) -> void {
+        auto power = _autotune.update(pad_temperature(), CONTROL_PERIOD_S);
+        if (!_autotune.running()) {
+            finish_autotune(policy);
+        } else if (power == 0.0) {
+            policy.disable_power_output();
+        } else {
+            handle_circuit_error(policy.set_power_output(power));
+        }
+    }
+
+    template <typename Policy>
+    requires HeaterExecutionPolicy<Policy>
+    auto finish_autotune(Policy& policy) -> void {
+        policy.disable_power_output();
+        setpoint = std::nullopt;
+        state.system_status = State::IDLE;
+
+        auto result = _autotune.result();
+        if (!result.has_value()) {
+            auto error = messages::HostCommsMessage(messages::ErrorMessage{
+                .code = errors::ErrorCode::HEATER_AUTOTUNE_FAILED});
+            static_cast<void>(
+                task_registry->comms->get_message_queue().try_send(error));
+            return;
+        }
+        auto kp = std::clamp(result.value().kp, KP_MIN, KP_MAX);
+        auto ki = std::clamp(result.value().ki, KI_MIN, KI_MAX);
+        auto kd = std::clamp(result.value().kd, KD_MIN, KD_MAX);
+        pid = PID(kp, ki, kd, CONTROL_PERIOD_S, 1.0, -1.0);
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(
+                messages::AutotuneEvent{.kp = kp, .ki = ki, .kd = kd})));
+    }
+
     auto update_state_and_leds() -> void {
         auto old_led_status = state.led_status;
         auto message = messages::UpdateLEDStateMessage{};
-        if (state.system_status == State::CONTROLLING) {
+        if (state.system_status == State::CONTROLLING ||
+            state.system_status == State::AUTOTUNING) {
             if (pad_temperature() > HOT_TO_TOUCH_THRESHOLD) {
                 state.led_status = State::HOT_TO_TOUCH_OR_HOLDING;
                 message.mode = LED_MODE::SOLID_HOT;
@@ -719,6 +832,7 @@ class HeaterTask {
     std::optional<double> setpoint;
     flash::Flash _flash;
     flash::OffsetConstants _offset_constants;
+    relay_autotune::RelayAutotune _autotune;
 };
 
 };  // namespace heater_task
@@ -16,6 +16,7 @@
 #include "heater-shaker/errors.hpp"
 #include "heater-shaker/gcodes.hpp"
 #include "heater-shaker/messages.hpp"
+#include "heater-shaker/task_stats_registry.hpp"
 #include "heater-shaker/tasks.hpp"
 
 namespace tasks {
@@ -48,7 +49,10 @@ class HostCommsTask {
         gcode::GetPlateLockStateDebug, gcode::SetLEDDebug,
         gcode::IdentifyModuleStartLED, gcode::IdentifyModuleStopLED,
         gcode::SetOffsetConstants, gcode::GetOffsetConstants,
-        gcode::DeactivateHeater>;
+        gcode::DeactivateHeater, gcode::SetRPMFilterWindow,
+        gcode::SetSpeedProfileSegment, gcode::StartSpeedProfile,
+        gcode::GetSpeedProfileStatus, gcode::GetTaskMemory,
+        gcode::GetTaskStats, gcode::StartHeaterAutotune>;
     using AckOnlyCache =
         AckCache<8, gcode::SetRPM, gcode::SetTemperature,
                  gcode::SetAcceleration, gcode::SetPIDConstants,
@@ -57,7 +61,9 @@ class HostCommsTask {
                  gcode::OpenPlateLock, gcode::ClosePlateLock,
                  gcode::SetSerialNumber, gcode::SetLEDDebug,
                  gcode::IdentifyModuleStartLED, gcode::IdentifyModuleStopLED,
-                 gcode::SetOffsetConstants, gcode::DeactivateHeater>;
+                 gcode::SetOffsetConstants, gcode::DeactivateHeater,
+                 gcode::SetRPMFilterWindow, gcode::SetSpeedProfileSegment,
+                 gcode::StartSpeedProfile, gcode::StartHeaterAutotune>;
     using GetTempCache = AckCache<8, gcode::GetTemperature>;
     using GetTempDebugCache = AckCache<8, gcode::GetTemperatureDebug>;
     using GetRPMCache = AckCache<8, gcode::GetRPM>;
@@ -66,12 +72,16 @@ class HostCommsTask {
     using GetPlateLockStateDebugCache =
         AckCache<8, gcode::GetPlateLockStateDebug>;
     using GetOffsetConstantsCache = AckCache<8, gcode::GetOffsetConstants>;
+    using GetSpeedProfileStatusCache =
+        AckCache<8, gcode::GetSpeedProfileStatus>;
+    using GetTaskMemoryCache = AckCache<8, gcode::GetTaskMemory>;
 
   public:
     static constexpr size_t TICKS_TO_WAIT_ON_SEND = 10;
     explicit HostCommsTask(Queue& q)
         : message_queue(q),
           task_registry(nullptr),
+          task_stats(nullptr),
           // These nolints are because if you don't have these inits, host
           // builds complain NOLINTNEXTLINE(readability-redundant-member-init)
           ack_only_cache(),
@@ -88,7 +98,11 @@ class HostCommsTask {
           // NOLINTNEXTLINE(readability-redundant-member-init)
           get_plate_lock_state_debug_cache(),
           // NOLINTNEXTLINE(readability-redundant-member-init)
-          get_offset_constants_cache() {}
+          get_offset_constants_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_speed_profile_status_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_task_memory_cache() {}
     HostCommsTask(const HostCommsTask& other) = delete;
     auto operator=(const HostCommsTask& other) -> HostCommsTask& = delete;
     HostCommsTask(HostCommsTask&& other) noexcept = delete;
@@ -98,6 +112,9 @@ class HostCommsTask {
     void provide_tasks(tasks::Tasks<QueueImpl>* other_tasks) {
         task_registry = other_tasks;
     }
+    void provide_task_stats(const tasks::TaskStatsRegistry* stats) {
+        task_stats = stats;
+    }
 
     /**
      * run_once() runs one spin of the task. This means it
@@ -242,6 +259,15 @@ class HostCommsTask {
         return errors::write_into_async(tx_into, tx_limit, msg.code);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::AutotuneEvent& event, InputIt tx_into,
+                       InputLimit tx_limit) -> InputIt {
+        return gcode::StartHeaterAutotune::write_event_into(
+            tx_into, tx_limit, event.kp, event.ki, event.kd);
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -438,6 +464,54 @@ class HostCommsTask {
             cache_entry);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::GetSpeedProfileStatusResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry = get_speed_profile_status_cache.remove_if_present(
+            response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.running, response.segment,
+                        response.segment_count, response.segment_elapsed_ms,
+                        response.total_elapsed_ms);
+                }
+            },
+            cache_entry);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::GetTaskMemoryResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry =
+            get_task_memory_cache.remove_if_present(response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, &response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.total, response.start,
+                        response.ram,
+                        std::span(response.stacks.data(), response.count));
+                }
+            },
+            cache_entry);
+    }
+
     /**
      * visit_gcode() is a set of member function overloads, each of which is
      * called when we parse the appropriate gcode out of the receive buffer.
@@ -713,6 +787,29 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::SetRPMFilterWindow& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::SetRPMFilterWindowMessage{
+            .id = id, .samples = gcode.samples};
+        if (!task_registry->motor->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -1043,8 +1140,143 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::StartHeaterAutotune& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::StartAutotuneMessage{
+            .id = id, .target = gcode.target, .cycles = gcode.cycles};
+        if (!task_registry->heater->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::SetSpeedProfileSegment& gcode,
+                     InputIt tx_into, InputLimit tx_limit)
+        -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::SetSpeedProfileSegmentMessage{
+            .id = id,
+            .index = gcode.index,
+            .rpm = gcode.rpm,
+            .ramp_rpm_per_s = gcode.ramp_rpm_per_s,
+            .hold_ms = gcode.hold_ms};
+        if (!task_registry->motor->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::StartSpeedProfile& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::StartSpeedProfileMessage{.id = id};
+        if (!task_registry->motor->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetSpeedProfileStatus& gcode,
+                     InputIt tx_into, InputLimit tx_limit)
+        -> std::pair<bool, InputIt> {
+        auto id = get_speed_profile_status_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::GetSpeedProfileStatusMessage{.id = id};
+        if (!task_registry->motor->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_speed_profile_status_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetTaskMemory& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = get_task_memory_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message =
+            messages::GetTaskMemoryMessage{.id = id, .start = gcode.start};
+        if (!task_registry->system->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_task_memory_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetTaskStats& ignore, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        static_cast<void>(ignore);
+        if (task_stats == nullptr) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::UNHANDLED_GCODE));
+        }
+        return std::make_pair(true, gcode::GetTaskStats::write_response_into(
+                                        tx_into, tx_limit, *task_stats));
+    }
+
     Queue& message_queue;
     tasks::Tasks<QueueImpl>* task_registry;
+    const tasks::TaskStatsRegistry* task_stats;
     AckOnlyCache ack_only_cache;
     GetTempCache get_temp_cache;
     GetRPMCache get_rpm_cache;
@@ -1053,6 +1285,8 @@ class HostCommsTask {
     GetPlateLockStateCache get_plate_lock_state_cache;
     GetPlateLockStateDebugCache get_plate_lock_state_debug_cache;
     GetOffsetConstantsCache get_offset_constants_cache;
+    GetSpeedProfileStatusCache get_speed_profile_status_cache;
+    GetTaskMemoryCache get_task_memory_cache;
     bool may_connect_latch = true;
 };
 
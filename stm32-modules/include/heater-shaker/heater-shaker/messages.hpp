@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <variant>
 
+#include "core/task_memory.hpp"
 #include "heater-shaker/errors.hpp"
 #include "systemwide.h"
 
@@ -66,11 +67,22 @@ struct GetSystemInfoMessage {
     uint32_t id;
 };
 
+struct GetTaskMemoryMessage {
+    uint32_t id;
+    // Index of the first task to return
+    uint32_t start;
+};
+
 struct SetAccelerationMessage {
     uint32_t id;
     int32_t rpm_per_s;
 };
 
+struct SetRPMFilterWindowMessage {
+    uint32_t id;
+    uint16_t samples;
+};
+
 struct TemperatureConversionComplete {
     uint16_t pad_a;
     uint16_t pad_b;
@@ -89,6 +101,18 @@ struct SetPIDConstantsMessage {
     double kd;
 };
 
+struct StartAutotuneMessage {
+    uint32_t id;
+    double target;
+    int cycles;
+};
+
+struct AutotuneEvent {
+    double kp;
+    double ki;
+    double kd;
+};
+
 struct SetPowerTestMessage {
     uint32_t id;
     double power;
@@ -272,6 +296,48 @@ struct DeactivateHeaterMessage {
     uint32_t id;
 };
 
+struct SetSpeedProfileSegmentMessage {
+    uint32_t id;
+    uint16_t index;
+    int16_t rpm;
+    int32_t ramp_rpm_per_s;
+    uint32_t hold_ms;
+};
+
+struct StartSpeedProfileMessage {
+    uint32_t id;
+};
+
+struct GetSpeedProfileStatusMessage {
+    uint32_t id;
+};
+
+struct GetSpeedProfileStatusResponse {
+    uint32_t responding_to_id;
+    bool running;
+    uint16_t segment;
+    uint16_t segment_count;
+    uint32_t segment_elapsed_ms;
+    uint32_t total_elapsed_ms;
+};
+
+struct GetTaskMemoryResponse {
+    // Maximum number of tasks that fit in a single response. Every
+    // HostCommsMessage is as big as its largest alternative, so the
+    // response holds a single task and narrow counts to stay no bigger
+    // than the others.
+    static constexpr size_t MAX_TASKS = 1;
+    uint32_t responding_to_id;
+    // Total number of tasks that are tracked
+    uint16_t total;
+    // Number of valid entries in \c stacks
+    uint16_t count;
+    // Index of the first task in this response
+    uint32_t start;
+    task_memory::RamUsage ram;
+    std::array<task_memory::StackUsage, MAX_TASKS> stacks;
+};
+
 struct AcknowledgePrevious {
     uint32_t responding_to_id;
     errors::ErrorCode with_error = errors::ErrorCode::NO_ERROR;
@@ -287,24 +353,29 @@ using HeaterMessage =
                    TemperatureConversionComplete, GetTemperatureDebugMessage,
                    SetPIDConstantsMessage, SetPowerTestMessage,
                    HandleNTCSetupError, SetOffsetConstantsMessage,
-                   GetOffsetConstantsMessage, DeactivateHeaterMessage>;
+                   GetOffsetConstantsMessage, DeactivateHeaterMessage,
+                   StartAutotuneMessage>;
 using MotorMessage = ::std::variant<
     std::monostate, MotorSystemErrorMessage, SetRPMMessage, GetRPMMessage,
     SetAccelerationMessage, CheckHomingStatusMessage, BeginHomingMessage,
     ActuateSolenoidMessage, SetPlateLockPowerMessage, OpenPlateLockMessage,
     ClosePlateLockMessage, SetPIDConstantsMessage, PlateLockComplete,
     GetPlateLockStateMessage, GetPlateLockStateDebugMessage,
-    CheckPlateLockStatusMessage>;
+    CheckPlateLockStatusMessage, SetRPMFilterWindowMessage,
+    SetSpeedProfileSegmentMessage, StartSpeedProfileMessage,
+    GetSpeedProfileStatusMessage>;
 using SystemMessage =
     ::std::variant<std::monostate, EnterBootloaderMessage, AcknowledgePrevious,
                    SetSerialNumberMessage, GetSystemInfoMessage, SetLEDMessage,
                    IdentifyModuleStartLEDMessage, IdentifyModuleStopLEDMessage,
                    HandleLEDSetupError, UpdateLEDStateMessage,
-                   UpdateLEDMessage>;
+                   UpdateLEDMessage, GetTaskMemoryMessage>;
 using HostCommsMessage =
     ::std::variant<std::monostate, IncomingMessageFromHost, AcknowledgePrevious,
                    ErrorMessage, GetTemperatureResponse, GetRPMResponse,
                    GetTemperatureDebugResponse, ForceUSBDisconnectMessage,
                    GetPlateLockStateResponse, GetPlateLockStateDebugResponse,
-                   GetSystemInfoResponse, GetOffsetConstantsResponse>;
+                   GetSystemInfoResponse, GetOffsetConstantsResponse,
+                   GetSpeedProfileStatusResponse, GetTaskMemoryResponse,
+                   AutotuneEvent>;
 };  // namespace messages
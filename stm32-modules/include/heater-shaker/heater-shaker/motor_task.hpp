@@ -4,11 +4,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <concepts>
 #include <variant>
 
 #include "hal/message_queue.hpp"
 #include "heater-shaker/messages.hpp"
+#include "heater-shaker/speed_profile.hpp"
 #include "heater-shaker/tasks.hpp"
 #include "systemwide.h"
 namespace tasks {
@@ -46,6 +48,9 @@ concept MotorExecutionPolicy = requires(Policy& p, const Policy& cp) {
     {
         p.set_ramp_rate(static_cast<int32_t>(8))
         } -> std::same_as<errors::ErrorCode>;
+    {
+        p.set_rpm_filter_window(static_cast<uint16_t>(8))
+        } -> std::same_as<errors::ErrorCode>;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     {p.set_pid_constants(1.0, 2.0, 3.0)};
     {p.homing_solenoid_disengage()};
@@ -53,6 +58,8 @@ concept MotorExecutionPolicy = requires(Policy& p, const Policy& cp) {
     {p.homing_solenoid_engage(122)};
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     {p.delay_ticks(10)};
+    // A monotonic millisecond count, which may wrap
+    { cp.get_tick_ms() } -> std::same_as<uint32_t>;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     {p.plate_lock_set_power(0.1)};
     {p.plate_lock_disable()};
@@ -105,6 +112,9 @@ class MotorTask {
         2022113007;  // switched from old to new solenoid on 2022-11-30 7th unit
 
   public:
+    static constexpr const uint32_t SPEED_PROFILE_TICK_MS =
+        10;  // interval between speed profile updates, and so the most a
+             // segment change can lag behind its scheduled time
     static constexpr int16_t HOMING_ROTATION_LIMIT_HIGH_NEW_RPM = 325;
     static constexpr int16_t HOMING_ROTATION_LIMIT_LOW_NEW_RPM = 275;
     static constexpr int16_t HOMING_ROTATION_LIMIT_HIGH_OLD_RPM = 250;
@@ -144,6 +154,28 @@ class MotorTask {
         -> PlateLockState::PlateLockTaskStatus {
         return plate_lock_state.status;
     }
+    /**
+     * Whether the motor and plate lock are stopped, as of the last message
+     * this task handled. Other tasks read this to hold off work that would
+     * stall motor control, like erasing flash. It is cleared before each
+     * message is handled, so it is never set while a message starts the
+     * motor.
+     */
+    [[nodiscard]] auto idle() const -> bool { return _idle.load(); }
+    // While a speed profile runs, run_once() wakes up on its own to update
+    // the speed rather than only when a message arrives
+    [[nodiscard]] auto speed_profile_running() const -> bool {
+        return _speed_profile.running();
+    }
+    // How long until a running speed profile is next due an update
+    template <typename Policy>
+    [[nodiscard]] auto profile_update_wait_ms(const Policy& policy) const
+        -> uint32_t {
+        auto elapsed = policy.get_tick_ms() - _profile_updated_ms;
+        return elapsed >= SPEED_PROFILE_TICK_MS
+                   ? 0
+                   : SPEED_PROFILE_TICK_MS - elapsed;
+    }
     [[nodiscard]] auto get_homing_speed() const -> uint16_t {
         return _homing_rotation_limit_low_rpm;
     }
@@ -158,14 +190,29 @@ class MotorTask {
 
         // This is the call down to the provided queue. It will block for
         // anywhere up to the provided timeout, which drives the controller
-        // frequency.
+        // frequency. While a speed profile runs, it blocks no longer than
+        // the profile's next update is due.
 
-        static_cast<void>(message_queue.recv(&message));
+        if (_speed_profile.running()) {
+            static_cast<void>(message_queue.try_recv(
+                &message, profile_update_wait_ms(policy)));
+        } else {
+            static_cast<void>(message_queue.recv(&message));
+        }
+        _idle = false;
         std::visit(
             [this, &policy](const auto& msg) -> void {
                 this->visit_message(msg, policy);
             },
             message);
+        if (_speed_profile.running()) {
+            update_speed_profile(policy);
+        }
+        _idle = (setpoint == 0) && (policy.get_current_rpm() == 0) &&
+                (state.status != State::HOMING_MOVING_TO_HOME_SPEED) &&
+                (state.status != State::HOMING_COASTING_TO_STOP) &&
+                (plate_lock_state.status != PlateLockState::OPENING) &&
+                (plate_lock_state.status != PlateLockState::CLOSING);
     }
 
   private:
@@ -178,6 +225,7 @@ class MotorTask {
     template <typename Policy>
     auto visit_message(const messages::SetRPMMessage& msg, Policy& policy)
         -> void {
+        _speed_profile.stop();
         auto error = errors::ErrorCode::NO_ERROR;
         if (current_error !=
             errors::ErrorCode::NO_ERROR) {  // motor-control error
@@ -192,26 +240,7 @@ class MotorTask {
             error = errors::ErrorCode::MOTOR_HOMING;
         } else {
             policy.homing_solenoid_disengage();
-            if ((msg.target_rpm < MOTOR_KICKSTART_RPM) &&
-                (msg.target_rpm > 0) &&
-                (setpoint == 0)) {  // ensure motor not already moving
-                policy.set_rpm(MOTOR_KICKSTART_RPM);
-                policy.delay_ticks(MOTOR_START_WAIT_TICKS);
-            }
-            error = policy.set_rpm(msg.target_rpm);
-            if (error == errors::ErrorCode::NO_ERROR) {  // only proceed if
-                                                         // target speed legal
-                setpoint = msg.target_rpm;
-                state.status = State::RUNNING;
-                policy.delay_ticks(MOTOR_START_WAIT_TICKS);
-                if ((msg.target_rpm != 0) &&
-                    (policy.get_current_rpm() < MOTOR_START_THRESHOLD_RPM)) {
-                    error = errors::ErrorCode::MOTOR_UNABLE_TO_MOVE;
-                    policy.stop();
-                    state.status = State::ERROR;
-                    setpoint = 0;
-                }
-            }
+            error = start_rpm(msg.target_rpm, policy);
         }
         auto response = messages::AcknowledgePrevious{
             .responding_to_id = msg.id, .with_error = error};
@@ -226,6 +255,32 @@ class MotorTask {
         }
     }
 
+    // Sets a new speed and waits to see that the motor follows it, first
+    // kicking it past static friction if it's starting slowly from a stop
+    template <typename Policy>
+    auto start_rpm(int16_t target_rpm, Policy& policy) -> errors::ErrorCode {
+        if ((target_rpm < MOTOR_KICKSTART_RPM) && (target_rpm > 0) &&
+            (setpoint == 0)) {  // ensure motor not already moving
+            policy.set_rpm(MOTOR_KICKSTART_RPM);
+            policy.delay_ticks(MOTOR_START_WAIT_TICKS);
+        }
+        auto error = policy.set_rpm(target_rpm);
+        if (error == errors::ErrorCode::NO_ERROR) {  // only proceed if
+                                                     // target speed legal
+            setpoint = target_rpm;
+            state.status = State::RUNNING;
+            policy.delay_ticks(MOTOR_START_WAIT_TICKS);
+            if ((target_rpm != 0) &&
+                (policy.get_current_rpm() < MOTOR_START_THRESHOLD_RPM)) {
+                error = errors::ErrorCode::MOTOR_UNABLE_TO_MOVE;
+                policy.stop();
+                state.status = State::ERROR;
+                setpoint = 0;
+            }
+        }
+        return error;
+    }
+
     template <typename Policy>
     auto visit_message(const messages::SetPIDConstantsMessage& msg,
                        Policy& policy) -> void {
@@ -244,6 +299,133 @@ class MotorTask {
             messages::HostCommsMessage(response)));
     }
 
+    template <typename Policy>
+    auto visit_message(const messages::SetRPMFilterWindowMessage& msg,
+                       Policy& policy) -> void {
+        auto error = policy.set_rpm_filter_window(msg.samples);
+        auto response = messages::AcknowledgePrevious{
+            .responding_to_id = msg.id, .with_error = error};
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::SetSpeedProfileSegmentMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto error = errors::ErrorCode::NO_ERROR;
+        if (!_speed_profile.set_segment(
+                msg.index,
+                speed_profile::Segment{.rpm = msg.rpm,
+                                       .ramp_rpm_per_s = msg.ramp_rpm_per_s,
+                                       .hold_ms = msg.hold_ms})) {
+            error = errors::ErrorCode::MOTOR_PROFILE_SEGMENT_INVALID;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    /**
+     * While a speed profile runs, run_once waits for messages no longer
+     * than SPEED_PROFILE_TICK_MS past the last update, and then advances
+     * the profile by the time the policy's tick count says has passed.
+     * Segment timing follows the clock however long messages take to
+     * handle, and messages are never held up waiting for an update.
+     */
+    template <typename Policy>
+    auto visit_message(const messages::StartSpeedProfileMessage& msg,
+                       Policy& policy) -> void {
+        auto error = errors::ErrorCode::NO_ERROR;
+        if (current_error != errors::ErrorCode::NO_ERROR) {
+            error = current_error;
+        } else if ((!policy.plate_lock_closed_sensor_read()) &&
+                   (plate_lock_state.status != PlateLockState::IDLE_CLOSED)) {
+            error = errors::ErrorCode::PLATE_LOCK_NOT_CLOSED;
+        } else if ((state.status == State::HOMING_MOVING_TO_HOME_SPEED) ||
+                   (state.status == State::HOMING_COASTING_TO_STOP)) {
+            error = errors::ErrorCode::MOTOR_HOMING;
+        } else {
+            auto first = _speed_profile.start(setpoint);
+            if (!first.has_value()) {
+                error = errors::ErrorCode::MOTOR_PROFILE_EMPTY;
+            } else {
+                policy.homing_solenoid_disengage();
+                state.status = State::RUNNING;
+                _profile_updated_ms = policy.get_tick_ms();
+                error = apply_profile_segment(first.value(), policy);
+            }
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::GetSpeedProfileStatusMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response = messages::GetSpeedProfileStatusResponse{
+            .responding_to_id = msg.id,
+            .running = _speed_profile.running(),
+            .segment = static_cast<uint16_t>(_speed_profile.segment_index()),
+            .segment_count =
+                static_cast<uint16_t>(_speed_profile.segment_count()),
+            .segment_elapsed_ms = _speed_profile.segment_elapsed_ms(),
+            .total_elapsed_ms = _speed_profile.total_elapsed_ms()};
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
+    // Applies the ramp rate and speed of a profile segment. A segment that
+    // starts the motor from a stop goes through the same kickstart and
+    // check that it turns as a SetRPM; one that changes the speed of a
+    // turning motor is applied without blocking, so later segments stay on
+    // time. If either is rejected, the profile is abandoned and the motor
+    // stopped.
+    template <typename Policy>
+    auto apply_profile_segment(const speed_profile::Segment& segment,
+                               Policy& policy) -> errors::ErrorCode {
+        auto error = policy.set_ramp_rate(segment.ramp_rpm_per_s);
+        if (error == errors::ErrorCode::NO_ERROR) {
+            if ((setpoint == 0) && (segment.rpm != 0)) {
+                error = start_rpm(segment.rpm, policy);
+            } else {
+                error = policy.set_rpm(segment.rpm);
+            }
+        }
+        if (error != errors::ErrorCode::NO_ERROR) {
+            _speed_profile.stop();
+            policy.stop();
+            setpoint = 0;
+            return error;
+        }
+        setpoint = segment.rpm;
+        return error;
+    }
+
+    // Advances a running profile by the time since its last update, once
+    // that is at least SPEED_PROFILE_TICK_MS
+    template <typename Policy>
+    auto update_speed_profile(Policy& policy) -> void {
+        auto now = policy.get_tick_ms();
+        auto elapsed = now - _profile_updated_ms;
+        if (elapsed < SPEED_PROFILE_TICK_MS) {
+            return;
+        }
+        _profile_updated_ms = now;
+        auto next = _speed_profile.tick(elapsed);
+        if (!next.has_value()) {
+            return;
+        }
+        auto error = apply_profile_segment(next.value(), policy);
+        if (error != errors::ErrorCode::NO_ERROR) {
+            static_cast<void>(
+                task_registry->comms->get_message_queue().try_send(
+                    messages::ErrorMessage{.code = error}));
+        }
+    }
+
     template <typename Policy>
     auto visit_message(const messages::GetRPMMessage& msg, Policy& policy)
         -> void {
@@ -287,6 +469,7 @@ class MotorTask {
                 auto code = errors::from_motor_error(
                     msg.errors, static_cast<errors::MotorErrorOffset>(offset));
                 if (code != errors::ErrorCode::NO_ERROR) {
+                    _speed_profile.stop();
                     auto message = messages::UpdateLEDStateMessage{
                         .color = LED_COLOR::AMBER, .mode = LED_MODE::PULSE};
                     static_cast<void>(
@@ -340,8 +523,11 @@ class MotorTask {
                        Policy& policy) -> void {
         static_cast<void>(msg);
         if (state.status == State::HOMING_MOVING_TO_HOME_SPEED) {
-            if (policy.get_current_rpm() < _homing_rotation_limit_high_rpm &&
-                policy.get_current_rpm() > _homing_rotation_limit_low_rpm) {
+            // Read the filtered speed once so both bounds are checked against
+            // the same measurement
+            auto current_rpm = policy.get_current_rpm();
+            if (current_rpm < _homing_rotation_limit_high_rpm &&
+                current_rpm > _homing_rotation_limit_low_rpm) {
                 policy.homing_solenoid_engage(HOMING_SOLENOID_CURRENT_INITIAL);
                 state.status = State::HOMING_COASTING_TO_STOP;
                 homing_cycles_coasting = 0;
@@ -398,6 +584,7 @@ class MotorTask {
     template <typename Policy>
     auto visit_message(const messages::BeginHomingMessage& msg, Policy& policy)
         -> void {
+        _speed_profile.stop();
         if (!_serial_initialized) {
             std::array<char, SYSTEM_WIDE_SERIAL_NUMBER_LENGTH> serial_number;
             serial_number = policy.get_serial_number();
@@ -668,6 +855,9 @@ class MotorTask {
     int16_t _homing_rotation_limit_low_rpm;
     int16_t _homing_rotation_limit_high_rpm;
     bool _serial_initialized;
+    speed_profile::SpeedProfile _speed_profile = {};
+    uint32_t _profile_updated_ms = 0;
+    std::atomic_bool _idle = true;
 };
 
 };  // namespace motor_task
@@ -0,0 +1,160 @@
+/*
+** speed_profile.hpp - on-device execution of multi-segment speed profiles
+**
+** A speed profile is a list of segments. Each segment ramps the main motor
+** to a target speed at a given ramp rate and then holds that speed for a
+** fixed time. The profile is uploaded one segment at a time and then
+** executed by the motor task, which advances it by calling tick() with the
+** time elapsed since the last call. This keeps segment timing on the device
+** rather than depending on host-side timing of individual M3 commands.
+**
+** This class only tracks timing; applying the speed and ramp rate of each
+** segment to the motor is left to the caller.
+*/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+
+namespace speed_profile {
+
+struct Segment {
+    int16_t rpm;
+    int32_t ramp_rpm_per_s;
+    uint32_t hold_ms;
+};
+
+class SpeedProfile {
+  public:
+    static constexpr size_t MAX_SEGMENTS = 16;
+    static constexpr uint32_t MS_PER_S = 1000;
+    // Must match MIN_APPLICATION_SPEED_RPM and MAX_APPLICATION_SPEED_RPM in
+    // the firmware's drive_parameters.h
+    static constexpr int16_t MIN_RPM = 0;
+    static constexpr int16_t MAX_RPM = 4110;
+    // Must match MIN_RAMP_RATE_RPM_PER_S and MAX_RAMP_RATE_RPM_PER_S in the
+    // firmware's motor policy
+    static constexpr int32_t MIN_RAMP_RATE_RPM_PER_S = 1;
+    static constexpr int32_t MAX_RAMP_RATE_RPM_PER_S = 20000;
+
+    /**
+     * @brief Set the segment at \c index. Segments must be written in
+     * order: \c index may be at most the current segment count, and
+     * writing a segment discards any segments after it, so uploading a
+     * new profile starting from index 0 replaces the old one.
+     *
+     * Segments can't be changed while the profile is running, and their
+     * speed and ramp rate must be ones the motor can run at, so that a bad
+     * profile is rejected when it's uploaded rather than partway through
+     * running.
+     *
+     * @return true if the segment was stored
+     */
+    auto set_segment(size_t index, const Segment& segment) -> bool {
+        if (_running || index >= MAX_SEGMENTS || index > _count ||
+            segment.ramp_rpm_per_s < MIN_RAMP_RATE_RPM_PER_S ||
+            segment.ramp_rpm_per_s > MAX_RAMP_RATE_RPM_PER_S ||
+            segment.rpm < MIN_RPM || segment.rpm > MAX_RPM) {
+            return false;
+        }
+        _segments.at(index) = segment;
+        _count = index + 1;
+        return true;
+    }
+
+    auto clear() -> void {
+        _running = false;
+        _count = 0;
+        _index = 0;
+        _segment_elapsed_ms = 0;
+        _total_elapsed_ms = 0;
+    }
+
+    /**
+     * @brief Begin executing the profile from its first segment.
+     *
+     * @param start_rpm The speed setpoint when the profile starts, which
+     * determines how long the first ramp takes
+     * @return The first segment, which the caller should apply, or nothing
+     * if there are no segments to run
+     */
+    auto start(int16_t start_rpm) -> std::optional<Segment> {
+        if (_count == 0) {
+            return std::nullopt;
+        }
+        _running = true;
+        _index = 0;
+        _segment_elapsed_ms = 0;
+        _total_elapsed_ms = 0;
+        _segment_duration_ms = duration_of(_segments[0], start_rpm);
+        return _segments[0];
+    }
+
+    auto stop() -> void { _running = false; }
+
+    /**
+     * @brief Advance the profile by \c elapsed_ms. If this moves the profile
+     * into a new segment, that segment is returned so the caller can apply
+     * it. If several segments elapse at once, only the last one is
+     * returned, since the earlier ones have no remaining time to run.
+     *
+     * When the last segment finishes the profile stops running; the motor
+     * is left at the speed of the last segment.
+     */
+    auto tick(uint32_t elapsed_ms) -> std::optional<Segment> {
+        if (!_running) {
+            return std::nullopt;
+        }
+        _total_elapsed_ms += elapsed_ms;
+        _segment_elapsed_ms += elapsed_ms;
+        std::optional<Segment> next = std::nullopt;
+        while (_segment_elapsed_ms >= _segment_duration_ms) {
+            if (_index + 1 >= _count) {
+                _running = false;
+                _segment_elapsed_ms = _segment_duration_ms;
+                return next;
+            }
+            _segment_elapsed_ms -= _segment_duration_ms;
+            auto previous_rpm = _segments[_index].rpm;
+            ++_index;
+            _segment_duration_ms = duration_of(_segments[_index], previous_rpm);
+            next = _segments[_index];
+        }
+        return next;
+    }
+
+    [[nodiscard]] auto running() const -> bool { return _running; }
+    [[nodiscard]] auto segment_count() const -> size_t { return _count; }
+    [[nodiscard]] auto segment_index() const -> size_t { return _index; }
+    [[nodiscard]] auto segment_elapsed_ms() const -> uint32_t {
+        return _segment_elapsed_ms;
+    }
+    [[nodiscard]] auto total_elapsed_ms() const -> uint32_t {
+        return _total_elapsed_ms;
+    }
+
+  private:
+    // A segment lasts for its ramp, at its ramp rate from the previous
+    // speed, plus its hold time
+    static auto duration_of(const Segment& segment, int16_t from_rpm)
+        -> uint32_t {
+        auto delta = static_cast<uint32_t>(
+            std::abs(static_cast<int32_t>(segment.rpm) - from_rpm));
+        auto ramp_ms = (delta * MS_PER_S) /
+                       static_cast<uint32_t>(segment.ramp_rpm_per_s);
+        return ramp_ms + segment.hold_ms;
+    }
+
+    std::array<Segment, MAX_SEGMENTS> _segments = {};
+    size_t _count = 0;
+    size_t _index = 0;
+    uint32_t _segment_elapsed_ms = 0;
+    uint32_t _segment_duration_ms = 0;
+    uint32_t _total_elapsed_ms = 0;
+    bool _running = false;
+};
+
+}  // namespace speed_profile
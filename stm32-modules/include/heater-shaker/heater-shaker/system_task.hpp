@@ -7,6 +7,7 @@
 #include <variant>
 
 #include "core/ack_cache.hpp"
+#include "core/task_memory.hpp"
 #include "core/version.hpp"
 #include "hal/message_queue.hpp"
 #include "heater-shaker/messages.hpp"
@@ -33,6 +34,12 @@ concept SystemExecutionPolicy = requires(Policy& p, const Policy& cp) {
     {
         p.start_set_led(LED_COLOR::WHITE, 255)
         } -> std::same_as<errors::ErrorCode>;
+    // The number of statically allocated tasks whose stacks are tracked
+    { cp.get_task_count() } -> std::same_as<size_t>;
+    // The stack usage of one tracked task
+    { cp.get_stack_usage(0) } -> std::same_as<task_memory::StackUsage>;
+    // The static RAM and heap in use
+    { cp.get_ram_usage() } -> std::same_as<task_memory::RamUsage>;
 };
 
 struct LEDPulseState {
@@ -220,6 +227,26 @@ class SystemTask {
             messages::HostCommsMessage(response)));
     }
 
+    template <typename Policy>
+    auto visit_message(const messages::GetTaskMemoryMessage& msg,
+                       Policy& policy) -> void {
+        auto response = messages::GetTaskMemoryResponse{
+            .responding_to_id = msg.id,
+            .total = static_cast<uint16_t>(policy.get_task_count()),
+            .count = 0,
+            .start = msg.start,
+            .ram = policy.get_ram_usage(),
+            .stacks = {}};
+        while (response.count < response.stacks.size() &&
+               response.start + response.count < response.total) {
+            response.stacks.at(response.count) =
+                policy.get_stack_usage(response.start + response.count);
+            ++response.count;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
     template <typename Policy>
     auto visit_message(const messages::SetLEDMessage& msg, Policy& policy)
         -> void {
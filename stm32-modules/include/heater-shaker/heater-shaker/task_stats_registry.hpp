@@ -0,0 +1,34 @@
+/*
+ * Where each task keeps its runtime stats, so that host comms can report
+ * them with M990.D. This is kept apart from tasks.hpp because the task
+ * headers that tasks.hpp includes need it too.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "core/task_stats.hpp"
+
+namespace tasks {
+
+// Where each task keeps its runtime stats in the TaskStatsRegistry
+enum class TaskIndex : size_t {
+    HOST_COMMS,
+    SYSTEM,
+    HEATER,
+    MOTOR,
+};
+
+using TaskStatsRegistry = task_stats::Registry<4>;
+
+// Matches TaskIndex
+static constexpr std::array<const char*, TaskStatsRegistry::TASKS>
+    TASK_NAMES = {"HostComms", "System", "Heater", "Motor"};
+
+inline auto task_stats_for(TaskStatsRegistry& registry, TaskIndex task)
+    -> task_stats::TaskStats& {
+    return registry.at(static_cast<size_t>(task));
+}
+
+}  // namespace tasks
@@ -4,5 +4,34 @@
 #include "simulator/sim_driver.hpp"
 
 namespace cli_parser {
-std::shared_ptr<sim_driver::SimDriver> get_sim_driver(int, char**);
-}
\ No newline at end of file
+/**
+ * First value is the sim input driver, second input is a boolean
+ * set to true if the sim should run in realtime and false if it
+ * should run in simulated time
+ */
+using RT = std::pair<std::shared_ptr<sim_driver::SimDriver>, bool>;
+
+/**
+ * Parse the inputs and determine 1) what kind of input should be
+ * used 2) whether the simulation should be realtime or accelerated
+ */
+RT get_sim_driver(int, char**);
+
+bool check_realtime_environment_variable();
+
+/**
+ * Options for running several simulated Heater-Shakers in one process
+ */
+struct FarmOptions {
+    std::string socket;  // The socket URL of the first instance
+    size_t instances;
+    size_t threads;
+    bool realtime;
+    bool log_socket;
+};
+
+/**
+ * Parse the inputs to the simulator farm
+ */
+FarmOptions get_farm_options(int, char**);
+}  // namespace cli_parser
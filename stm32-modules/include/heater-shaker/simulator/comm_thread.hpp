@@ -3,15 +3,27 @@
 #include <thread>
 
 #include "heater-shaker/host_comms_task.hpp"
+#include "heater-shaker/task_stats_registry.hpp"
 #include "heater-shaker/tasks.hpp"
 #include "simulator/sim_driver.hpp"
+#include "simulator/sim_scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 
 namespace comm_thread {
 using SimCommTask = host_comms_task::HostCommsTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build(std::shared_ptr<sim_driver::SimDriver>&&)
+auto build(std::shared_ptr<sim_driver::SimDriver>&&,
+           std::shared_ptr<tasks::TaskStatsRegistry> stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimCommTask>;
+// Build for a scheduler. No thread is created, so the handle is empty.
+auto build(std::shared_ptr<sim_driver::SimDriver>&&,
+           std::shared_ptr<tasks::TaskStatsRegistry> stats,
+           sim_scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimCommTask>;
 void handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
                   tasks::Tasks<SimulatorMessageQueue>& tasks);
+// Read input for tasks run by a scheduler, posting each line to it
+void handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
+                  tasks::Tasks<SimulatorMessageQueue>& tasks,
+                  sim_scheduler::Scheduler& scheduler);
 };  // namespace comm_thread
@@ -1,13 +1,39 @@
 #pragma once
 #include <memory>
+#include <string_view>
 #include <thread>
 
 #include "heater-shaker/heater_task.hpp"
+#include "heater-shaker/task_stats_registry.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
+#include "simulator/thermal_network.hpp"
 
 namespace heater_thread {
 using SimHeaterTask = heater_task::HeaterTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask>;
+
+/**
+ * The thermal network used unless THERMAL_NETWORK_FILE names another one.
+ * The heater pad warms the plate, which loses heat to the air around it.
+ */
+static constexpr std::string_view DEFAULT_THERMAL_NETWORK = R"(
+node ambient capacity=1 temperature=23 fixed
+node board capacity=1 temperature=30 fixed
+node pad capacity=20 temperature=23 power=60
+node plate capacity=200 temperature=23
+link pad plate 2
+link pad ambient 0.1
+link plate ambient 0.5
+)";
+
+auto build(thermal_network::ThermalNetwork network,
+           std::shared_ptr<tasks::TaskStatsRegistry> stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask>;
+// Build for a scheduler. No thread is created, so the handle is empty.
+auto build(thermal_network::ThermalNetwork network,
+           std::shared_ptr<tasks::TaskStatsRegistry> stats,
+           sim_scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask>;
 };  // namespace heater_thread
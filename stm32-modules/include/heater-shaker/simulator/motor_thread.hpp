@@ -3,11 +3,18 @@
 #include <thread>
 
 #include "heater-shaker/motor_task.hpp"
+#include "heater-shaker/task_stats_registry.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 
 namespace motor_thread {
 using SimMotorTask = motor_task::MotorTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
+auto build(std::shared_ptr<tasks::TaskStatsRegistry> stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
+// Build for a scheduler. No thread is created, so the handle is empty.
+auto build(std::shared_ptr<tasks::TaskStatsRegistry> stats,
+           sim_scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
 };  // namespace motor_thread
@@ -1,4 +1,7 @@
 #pragma once
+
+#include <functional>
+
 #include "heater-shaker/host_comms_task.hpp"
 #include "heater-shaker/messages.hpp"
 #include "heater-shaker/tasks.hpp"
@@ -6,10 +9,12 @@
 
 namespace sim_driver {
 
+using SendToCommsFunc = std::function<void(messages::IncomingMessageFromHost&)>;
+
 class SimDriver {
   public:
     virtual const std::string& get_name() const = 0;
     virtual void write(const std::string& message) = 0;
-    virtual void read(tasks::Tasks<SimulatorMessageQueue>& tasks) = 0;
+    virtual void read(SendToCommsFunc&& send_to_comms) = 0;
 };
 }  // namespace sim_driver
\ No newline at end of file
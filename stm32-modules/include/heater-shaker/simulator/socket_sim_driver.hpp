@@ -1,31 +1,31 @@
 #pragma once
-#include <boost/asio.hpp>
+#include <memory>
+#include <string>
 
 #include "heater-shaker/host_comms_task.hpp"
 #include "heater-shaker/messages.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/async_line_socket.hpp"
 #include "simulator/sim_driver.hpp"
 #include "simulator/simulator_queue.hpp"
 
 namespace socket_sim_driver {
 
-struct AddressInfo {
-    std::string host;
-    int port;
-};
+using AddressInfo = sim_socket::AddressInfo;
 
 class SocketSimDriver : public sim_driver::SimDriver {
     static const std::string name;
     AddressInfo address_info;
-    std::unique_ptr<boost::asio::ip::tcp::socket> s;
+    std::unique_ptr<sim_socket::AsyncLineSocket> s;
 
   public:
-    SocketSimDriver(std::string);
+    // With log set, every line received and sent is printed
+    SocketSimDriver(std::string, bool log = false);
     const std::string& get_host() const;
     int get_port() const;
     const std::string& get_name() const;
 
     void write(const std::string& message);
-    void read(tasks::Tasks<SimulatorMessageQueue>& tasks);
+    void read(sim_driver::SendToCommsFunc&& send_to_comms);
 };
-}  // namespace socket_sim_driver
\ No newline at end of file
+}  // namespace socket_sim_driver
@@ -3,11 +3,20 @@
 #include <thread>
 
 #include "heater-shaker/system_task.hpp"
+#include "heater-shaker/task_stats_registry.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 
 namespace system_thread {
 using SimSystemTask = system_task::SystemTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
+auto build(std::shared_ptr<tasks::TaskStatsRegistry> stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
+// Build for a scheduler. No thread is created, so the handle is empty. The
+// serial number is read from the environment variable serial_var_name.
+auto build(std::shared_ptr<tasks::TaskStatsRegistry> stats,
+           sim_scheduler::Scheduler& scheduler,
+           const char* serial_var_name = "SERIAL_NUMBER")
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
 };  // namespace system_thread
@@ -62,6 +62,8 @@ struct TaskBuilder {
 
     auto run_system_task() -> void { system_task.run_once(system_policy); }
 
+    auto get_task_stats() -> tasks::TaskStatsRegistry& { return task_stats; }
+
   private:
     TaskBuilder();
     TestMessageQueue<host_comms_task::Message> host_comms_queue;
@@ -76,4 +78,5 @@ struct TaskBuilder {
     TestMotorPolicy motor_policy;
     TestHeaterPolicy heater_policy;
     TestSystemPolicy system_policy;
+    tasks::TaskStatsRegistry task_stats;
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "heater-shaker/flash.hpp"
+
+/** A page of flash in RAM that behaves like the microcontroller's flash.*/
+class TestFlashPolicy {
+  public:
+    static constexpr size_t DOUBLEWORDS =
+        flash::Flash::PAGE_SIZE / flash::Flash::DOUBLEWORD;
+
+    TestFlashPolicy() : _page() { _page.fill(flash::Flash::ERASED); }
+
+    // --- Policy fulfillment -----------
+
+    [[nodiscard]] auto config_flash_read(uint32_t offset) const -> uint64_t {
+        return _page.at(offset / flash::Flash::DOUBLEWORD);
+    }
+
+    auto config_flash_program(uint32_t offset, uint64_t value) -> bool {
+        auto index = offset / flash::Flash::DOUBLEWORD;
+        if (_fail_flash || offset % flash::Flash::DOUBLEWORD != 0 ||
+            index >= _page.size()) {
+            return false;
+        }
+        // Like the hardware, only erased doublewords can be programmed
+        if (_page.at(index) != flash::Flash::ERASED) {
+            return false;
+        }
+        _page.at(index) = value;
+        ++_programs;
+        return true;
+    }
+
+    auto config_flash_erase() -> bool {
+        if (_fail_flash) {
+            return false;
+        }
+        _page.fill(flash::Flash::ERASED);
+        ++_erases;
+        return true;
+    }
+
+    // --- Test helpers -----------
+
+    std::array<uint64_t, DOUBLEWORDS> _page;
+    size_t _programs = 0;
+    size_t _erases = 0;
+    bool _fail_flash = false;
+};
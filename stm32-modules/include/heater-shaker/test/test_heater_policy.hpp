@@ -1,10 +1,10 @@
 #pragma once
 #include <cstddef>
 
-#include "heater-shaker/flash.hpp"
 #include "systemwide.h"
+#include "test/test_flash_policy.hpp"
 
-class TestHeaterPolicy {
+class TestHeaterPolicy : public TestFlashPolicy {
   public:
     TestHeaterPolicy();
     explicit TestHeaterPolicy(bool pgood, bool can_reset);
@@ -22,8 +22,6 @@ class TestHeaterPolicy {
 
     auto try_reset_call_count() const -> size_t;
     auto reset_try_reset_call_count() -> void;
-    auto set_thermal_offsets(flash::OffsetConstants* constants) -> bool;
-    auto get_thermal_offsets() -> flash::OffsetConstants;
 
   private:
     bool power_good_val;
@@ -32,5 +30,4 @@ class TestHeaterPolicy {
     double power;
     bool enabled;
     bool circuit_error;
-    flash::OffsetConstants stored_offsets = {};
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <vector>
 
 #include "heater-shaker/errors.hpp"
 #include "systemwide.h"
@@ -14,6 +15,7 @@ class TestMotorPolicy {
     errors::ErrorCode set_serial_number_return = errors::ErrorCode::NO_ERROR;
 
   public:
+    static constexpr uint16_t MAX_RPM_FILTER_WINDOW = 32;
     TestMotorPolicy();
     TestMotorPolicy(int16_t initial_rpm, int16_t initial_target_rpm,
                     int32_t initial_ramp_rate);
@@ -22,12 +24,14 @@ class TestMotorPolicy {
     [[nodiscard]] auto get_current_rpm() const -> int16_t;
     [[nodiscard]] auto get_target_rpm() const -> int16_t;
     auto set_ramp_rate(int32_t new_ramp_rate) -> errors::ErrorCode;
+    auto set_rpm_filter_window(uint16_t samples) -> errors::ErrorCode;
     auto stop() -> void;
 
     auto homing_solenoid_disengage() -> void;
     auto homing_solenoid_engage(uint16_t current_ma) -> void;
 
     auto delay_ticks(uint16_t ticks) -> void;
+    [[nodiscard]] auto get_tick_ms() const -> uint32_t;
 
     auto plate_lock_set_power(float power) -> void;
     auto plate_lock_disable() -> void;
@@ -40,10 +44,16 @@ class TestMotorPolicy {
 
     auto test_set_current_rpm(int16_t current_rpm) -> void;
     [[nodiscard]] auto test_get_ramp_rate() -> int32_t;
+    [[nodiscard]] auto test_get_rpm_filter_window() const -> uint16_t;
 
     auto test_set_rpm_return_code(errors::ErrorCode code) -> void;
     auto test_set_ramp_rate_return_code(errors::ErrorCode code) -> void;
     [[nodiscard]] auto test_get_last_delay() const -> uint16_t;
+    auto test_clear_last_delay() -> void;
+    // Every speed passed to set_rpm, in order
+    [[nodiscard]] auto test_get_rpm_commands() const
+        -> const std::vector<int16_t>&;
+    auto test_advance_time(uint32_t ms) -> void;
 
     [[nodiscard]] auto test_plate_lock_get_power() const -> float;
     [[nodiscard]] auto test_plate_lock_enabled() const -> bool;
@@ -65,11 +75,14 @@ class TestMotorPolicy {
     int16_t target_rpm;
     int16_t current_rpm;
     int32_t ramp_rate;
+    std::vector<int16_t> rpm_commands = {};
+    uint16_t rpm_filter_window = MAX_RPM_FILTER_WINDOW;
     errors::ErrorCode set_rpm_return = errors::ErrorCode::NO_ERROR;
     errors::ErrorCode set_ramp_rate_return = errors::ErrorCode::NO_ERROR;
     bool solenoid_engaged = false;
     uint16_t solenoid_current = 0;
     uint16_t last_delay = 0;
+    uint32_t tick_ms = 0;
     float plate_lock_power = 0;
     bool plate_lock_enabled = false;
     double overridden_ki = 0.0;
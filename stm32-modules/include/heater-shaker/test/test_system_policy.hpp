@@ -1,6 +1,8 @@
 #pragma once
 #include <array>
+#include <vector>
 
+#include "core/task_memory.hpp"
 #include "heater-shaker/errors.hpp"
 #include "systemwide.h"
 
@@ -14,6 +16,8 @@ class TestSystemPolicy {
     errors::ErrorCode set_serial_number_return = errors::ErrorCode::NO_ERROR;
     uint16_t last_delay = 0;
     LED_COLOR passing_color = LED_COLOR::OFF;
+    std::vector<task_memory::StackUsage> stacks = {};
+    task_memory::RamUsage ram = {};
 
   public:
     auto enter_bootloader() -> void;
@@ -30,4 +34,10 @@ class TestSystemPolicy {
     auto check_I2C_ready(void) -> bool;
     auto delay_time_ms(uint16_t time_ms) -> void;
     [[nodiscard]] auto test_get_last_delay() const -> uint16_t;
+    [[nodiscard]] auto get_task_count() const -> size_t;
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage;
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage;
+    auto test_add_task_stack(task_memory::StackUsage stack) -> void;
+    auto test_set_ram_usage(task_memory::RamUsage usage) -> void;
 };
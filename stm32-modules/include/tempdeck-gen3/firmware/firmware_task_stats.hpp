@@ -0,0 +1,30 @@
+/**
+ * @file firmware_task_stats.hpp
+ * @brief The runtime stats of the firmware tasks, timed by the DWT cycle
+ * counter.
+ */
+#pragma once
+
+#include "core/task_stats.hpp"
+#include "firmware/task_stats_hardware.h"
+#include "tempdeck-gen3/tasks.hpp"
+
+namespace firmware_task_stats {
+
+struct DWTCycleClock {
+    [[nodiscard]] static auto now() -> uint32_t {
+        return task_stats_hardware_cycles();
+    }
+    [[nodiscard]] static auto ticks_per_us() -> uint32_t {
+        return task_stats_hardware_cycles_per_us();
+    }
+};
+
+/** The stats of every task, shared by the tasks that write them and the
+ * host comms task that reports them.*/
+auto registry() -> tasks::TaskStatsRegistry&;
+
+/** The stats of one task.*/
+auto stats_for(tasks::TaskIndex task) -> task_stats::TaskStats&;
+
+}  // namespace firmware_task_stats
@@ -0,0 +1,29 @@
+#ifndef __SYSTEM_BACKUP_FLASH_H_
+#define __SYSTEM_BACKUP_FLASH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The flash layout used by the startup app (see common/module-startup)
+#define BACKUP_FLASH_APPLICATION_ADDRESS (0x08008000)
+#define BACKUP_FLASH_SIZE (0x400 * 238)
+#define BACKUP_FLASH_PAGE_SIZE (2048)
+
+/** Erase one page, numbered from the start of the backup partition */
+bool system_backup_flash_erase_page(uint32_t page);
+
+/** Program one doubleword at an offset into the backup partition */
+bool system_backup_flash_program(uint32_t offset, uint64_t value);
+
+/** Read one doubleword at an offset into the backup partition */
+uint64_t system_backup_flash_read(uint32_t offset);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // __SYSTEM_BACKUP_FLASH_H_
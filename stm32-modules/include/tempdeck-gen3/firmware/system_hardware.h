@@ -11,6 +11,11 @@ extern "C" {
  */
 void system_hardware_enter_bootloader(void);
 
+/**
+ * @brief Reset the microcontroller. This function never returns.
+ */
+void system_hardware_reset(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -2,6 +2,9 @@
 
 #include <array>
 
+#include "core/firmware_update.hpp"
+#include "core/task_memory.hpp"
+#include "firmware/system_backup_flash.h"
 #include "firmware/system_hardware.h"
 #include "firmware/system_serial_number.h"
 #include "systemwide.h"
@@ -16,9 +19,24 @@ class SystemPolicy {
         SYSTEM_SERIAL_NUMBER_LENGTH / ADDRESS_LENGTH;
 
   public:
+    static constexpr firmware_update::Layout BACKUP_LAYOUT{
+        .partition_size = BACKUP_FLASH_SIZE,
+        .page_size = BACKUP_FLASH_PAGE_SIZE,
+        .link_address = BACKUP_FLASH_APPLICATION_ADDRESS,
+        .name = "tempdeck-gen3"};
+
     auto enter_bootloader() -> void;
+    auto system_reset() -> void;
     auto set_serial_number(
         std::array<char, SYSTEM_SERIAL_NUMBER_LENGTH> system_serial_number)
         -> errors::ErrorCode;
     auto get_serial_number() -> std::array<char, SYSTEM_SERIAL_NUMBER_LENGTH>;
+    [[nodiscard]] auto backup_layout() const -> firmware_update::Layout;
+    auto backup_erase_page(uint32_t page) -> bool;
+    auto backup_program(uint32_t offset, uint64_t value) -> bool;
+    auto backup_read(uint32_t offset) -> uint64_t;
+    [[nodiscard]] auto get_task_count() const -> size_t;
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage;
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage;
 };
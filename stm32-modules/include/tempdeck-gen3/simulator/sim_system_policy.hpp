@@ -1,11 +1,24 @@
 #pragma once
 
+#include "core/task_memory.hpp"
 #include "systemwide.h"
 #include "tempdeck-gen3/errors.hpp"
+#include "test/test_backup_flash_policy.hpp"
+
+// The backup partition is kept in memory, laid out like the real one
+struct SimSystemPolicy
+    : public backup_flash_test_policy::TestBackupFlashPolicy {
+    static constexpr firmware_update::Layout BACKUP_LAYOUT{
+        .partition_size = 238 * 1024,
+        .page_size = 2048,
+        .link_address = 0x08008000,
+        .name = "tempdeck-gen3"};
+
+    SimSystemPolicy() : TestBackupFlashPolicy(BACKUP_LAYOUT) {}
 
-struct SimSystemPolicy {
     using Serial = std::array<char, SYSTEM_WIDE_SERIAL_NUMBER_LENGTH>;
     void enter_bootloader(void) { ++_bootloader_count; }
+    void system_reset(void) { ++_reset_count; }
 
     errors::ErrorCode set_serial_number(Serial ser) {
         _serial = ser;
@@ -21,7 +34,21 @@ struct SimSystemPolicy {
         return empty_serial;
     }
 
+    // The simulator's tasks run on host threads with no fixed stacks or
+    // static RAM budget to report
+    [[nodiscard]] auto get_task_count() const -> size_t { return 0; }
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage {
+        static_cast<void>(index);
+        return task_memory::StackUsage{
+            .name = "", .size_words = 0, .min_free_words = 0};
+    }
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage {
+        return task_memory::RamUsage{};
+    }
+
     int _bootloader_count = 0;
+    int _reset_count = 0;
     Serial _serial = {'x'};
     bool _serial_set = false;
 };
@@ -0,0 +1,91 @@
+/**
+ * @file sim_thermal_plant.hpp
+ * @brief The simulated thermal hardware of the Temperature Deck, shared
+ * between the thermal task, which drives it, and the thermistor task,
+ * which reads it and advances its time.
+ */
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+#include "simulator/thermal_network.hpp"
+
+/**
+ * The thermal network used unless THERMAL_NETWORK_FILE names another one.
+ * The peltier pumps heat between the plate and the heatsink, and the fan
+ * cools the heatsink.
+ */
+static constexpr std::string_view DEFAULT_THERMAL_NETWORK = R"(
+node ambient capacity=1 temperature=23 fixed
+node heatsink capacity=300 temperature=23
+node plate capacity=40 temperature=23 power=40 source=heatsink
+node sample capacity=2 temperature=23
+link heatsink ambient 1.5
+link plate heatsink 0.1
+link sample plate 0.2
+)";
+
+class SimThermalPlant {
+  public:
+    /**
+     * At full speed the fan multiplies the heatsink to ambient conductance
+     * by this much more than still air.
+     */
+    static constexpr double FAN_CONDUCTANCE_BOOST = 4.0F;
+
+    explicit SimThermalPlant(thermal_network::ThermalNetwork network)
+        : _network(std::move(network)),
+          _plate(thermal_network::require(_network, "plate")),
+          _heatsink(thermal_network::require(_network, "heatsink")),
+          _ambient(thermal_network::require(_network, "ambient")),
+          _still_air_conductance(still_air_conductance()) {}
+
+    /** Power from -1 (cooling) to 1 (heating)*/
+    auto set_peltier(double power) -> void {
+        auto lock = std::lock_guard(_mutex);
+        _network.set_drive(_plate, power);
+    }
+
+    /** Fan power from 0 to 1*/
+    auto set_fan(double power) -> void {
+        auto lock = std::lock_guard(_mutex);
+        static_cast<void>(_network.set_conductance(
+            _heatsink, _ambient,
+            _still_air_conductance * (1.0F + FAN_CONDUCTANCE_BOOST * power)));
+    }
+
+    auto advance_ms(uint32_t time_ms) -> void {
+        auto lock = std::lock_guard(_mutex);
+        _network.advance(static_cast<double>(time_ms) / 1000.0F);
+    }
+
+    [[nodiscard]] auto plate_temp() -> double {
+        auto lock = std::lock_guard(_mutex);
+        return _network.temperature(_plate);
+    }
+
+    [[nodiscard]] auto heatsink_temp() -> double {
+        auto lock = std::lock_guard(_mutex);
+        return _network.temperature(_heatsink);
+    }
+
+  private:
+    [[nodiscard]] auto still_air_conductance() const -> double {
+        for (const auto& link : _network.links()) {
+            if ((link.a == _heatsink && link.b == _ambient) ||
+                (link.a == _ambient && link.b == _heatsink)) {
+                return link.conductance;
+            }
+        }
+        return 0.0F;
+    }
+
+    std::mutex _mutex{};
+    thermal_network::ThermalNetwork _network;
+    thermal_network::NodeIndex _plate;
+    thermal_network::NodeIndex _heatsink;
+    thermal_network::NodeIndex _ambient;
+    double _still_air_conductance;
+};
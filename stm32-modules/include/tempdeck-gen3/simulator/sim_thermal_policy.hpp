@@ -2,19 +2,31 @@
 
 #include <cmath>
 #include <cstdint>
+#include <memory>
 
+#include "simulator/sim_thermal_plant.hpp"
 #include "test/test_m24128_policy.hpp"
 
 struct SimThermalPolicy : public m24128_test_policy::TestM24128Policy {
-    auto enable_peltier() -> void { _enabled = true; }
+    explicit SimThermalPolicy(std::shared_ptr<SimThermalPlant> plant)
+        : _plant(std::move(plant)) {}
 
-    auto disable_peltier() -> void { _enabled = false; }
+    auto enable_peltier() -> void {
+        _enabled = true;
+        _plant->set_peltier(_power);
+    }
+
+    auto disable_peltier() -> void {
+        _enabled = false;
+        _plant->set_peltier(0.0F);
+    }
 
     auto set_peltier_heat_power(double power) -> bool {
         if (!_enabled) {
             return false;
         }
         _power = std::min(1.0, std::abs(power));
+        _plant->set_peltier(_power);
         return true;
     }
 
@@ -23,11 +35,13 @@ struct SimThermalPolicy : public m24128_test_policy::TestM24128Policy {
             return false;
         }
         _power = -std::min(1.0, std::abs(power));
+        _plant->set_peltier(_power);
         return true;
     }
 
     auto set_fan_power(double power) -> bool {
         _fan = std::clamp(power, double(0.0), double(1.0));
+        _plant->set_fan(_fan);
         return true;
     }
 
@@ -38,6 +52,7 @@ struct SimThermalPolicy : public m24128_test_policy::TestM24128Policy {
     }
 
   private:
+    std::shared_ptr<SimThermalPlant> _plant;
     bool _enabled = false;
     double _power = 0.0F;  // Positive for heat, negative for cool
     double _fan = 0.0F;
@@ -2,13 +2,26 @@
 
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <thread>
 
+#include "core/thermistor_conversion.hpp"
+#include "simulator/sim_thermal_plant.hpp"
+#include "simulator/simulator_queue.hpp"
+#include "tempdeck-gen3/thermal_task.hpp"
 #include "test/test_ads1115_policy.hpp"
+#include "thermistor_lookups.hpp"
 
 struct SimThermistorPolicy {
-    explicit SimThermistorPolicy(bool realtime = false)
-        : _realtime(realtime), _written() {}
+    using ThermalTask = thermal_task::ThermalTask<SimulatorMessageQueue>;
+
+    explicit SimThermistorPolicy(std::shared_ptr<SimThermalPlant> plant,
+                                 bool realtime = false)
+        : _realtime(realtime),
+          _written(),
+          _plant(std::move(plant)),
+          _converter(ThermalTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+                     ThermalTask::ADC_BIT_MAX, false) {}
 
     [[nodiscard]] auto get_time_ms() const -> uint32_t { return _time_ms; }
     auto sleep_ms(uint32_t time_ms) {
@@ -18,6 +31,7 @@ struct SimThermistorPolicy {
             std::this_thread::sleep_for(time);
         }
         _time_ms += time_ms;
+        _plant->advance_ms(time_ms);
     }
 
     auto ads1115_mark_initialized() -> void { _initialized = true; }
@@ -53,6 +67,9 @@ struct SimThermistorPolicy {
 
     auto ads1115_i2c_read_16(uint8_t reg) -> std::optional<uint16_t> {
         using Ret = std::optional<uint16_t>;
+        if (reg == CONVERSION_REGISTER) {
+            return Ret(read_thermistor());
+        }
         if (_written.find(reg) != _written.end()) {
             return Ret(_written.at(reg));
         }
@@ -67,10 +84,28 @@ struct SimThermistorPolicy {
     uint32_t _time_ms = 0;
 
   private:
+    static constexpr uint8_t CONVERSION_REGISTER = 0x00;
+    static constexpr uint8_t CONFIG_REGISTER = 0x01;
+    static constexpr uint16_t CONFIG_MUX_SHIFT = 12;
+    static constexpr uint16_t CONFIG_PIN_MASK = 0x3;
+    static constexpr uint16_t HEATSINK_PIN = 2;
+
+    // The pin being converted is selected in the config register. Both plate
+    // thermistors read the plate node.
+    auto read_thermistor() -> uint16_t {
+        auto pin = (_written[CONFIG_REGISTER] >> CONFIG_MUX_SHIFT) &
+                   CONFIG_PIN_MASK;
+        auto temp = (pin == HEATSINK_PIN) ? _plant->heatsink_temp()
+                                          : _plant->plate_temp();
+        return _converter.backconvert(temp);
+    }
+
     bool _realtime;
     std::atomic_bool _initialized = false;
     std::atomic_bool _locked = false;
     std::atomic_bool _read_armed = false;
     // Written registers - addr : value
     std::map<uint8_t, uint16_t> _written;
+    std::shared_ptr<SimThermalPlant> _plant;
+    thermistor_conversion::Conversion<lookups::KS103J2G> _converter;
 };
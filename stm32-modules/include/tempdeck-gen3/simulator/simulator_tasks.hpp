@@ -9,6 +9,8 @@
 #include <thread>
 
 #include "simulator/sim_driver.hpp"
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_thermal_plant.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "tempdeck-gen3/tasks.hpp"
 
@@ -16,27 +18,60 @@ namespace tasks {
 
 using SimTasks = Tasks<SimulatorMessageQueue>;
 
+// Every task records its runtime stats into a registry shared with the
+// host comms task, which reports them for M990.D
+using SharedTaskStats = std::shared_ptr<TaskStatsRegistry>;
+
 auto run_comms_task(std::stop_token st,
                     std::shared_ptr<SimTasks::HostCommsQueue> queue_ptr,
                     std::shared_ptr<SimTasks::QueueAggregator> aggregator,
-                    std::shared_ptr<sim_driver::SimDriver> driver) -> void;
+                    std::shared_ptr<sim_driver::SimDriver> driver,
+                    SharedTaskStats stats) -> void;
 
 auto run_system_task(std::stop_token st,
                      std::shared_ptr<SimTasks::SystemQueue> queue_ptr,
-                     std::shared_ptr<SimTasks::QueueAggregator> aggregator)
-    -> void;
+                     std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                     SharedTaskStats stats) -> void;
 
 auto run_ui_task(std::stop_token st,
                  std::shared_ptr<SimTasks::UIQueue> queue_ptr,
-                 std::shared_ptr<SimTasks::QueueAggregator> aggregator) -> void;
+                 std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                 SharedTaskStats stats) -> void;
 
 auto run_thermal_task(std::stop_token st,
                       std::shared_ptr<SimTasks::ThermalQueue> queue_ptr,
-                      std::shared_ptr<SimTasks::QueueAggregator> aggregator)
-    -> void;
+                      std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                      std::shared_ptr<SimThermalPlant> plant,
+                      SharedTaskStats stats) -> void;
 
 auto run_thermistor_task(std::stop_token st,
-                         std::shared_ptr<SimTasks::QueueAggregator> aggregator)
-    -> void;
+                         std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                         std::shared_ptr<SimThermalPlant> plant, bool realtime,
+                         SharedTaskStats stats) -> void;
+
+/**
+ * In simulated time, every task is registered with a scheduler instead of
+ * running in its own thread, and thermistor readings are taken on the
+ * scheduler's virtual clock. The serial number is read from the
+ * environment variable \c serial_var_name, if it is set.
+ */
+auto schedule_tasks(sim_scheduler::Scheduler& scheduler,
+                    std::shared_ptr<SimTasks::HostCommsQueue> comms_queue,
+                    std::shared_ptr<SimTasks::SystemQueue> system_queue,
+                    std::shared_ptr<SimTasks::UIQueue> ui_queue,
+                    std::shared_ptr<SimTasks::ThermalQueue> thermal_queue,
+                    std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                    std::shared_ptr<sim_driver::SimDriver> driver,
+                    std::shared_ptr<SimThermalPlant> plant,
+                    SharedTaskStats stats,
+                    const char* serial_var_name = "SERIAL_NUMBER") -> void;
+
+/**
+ * Post a line from the host to a scheduler set up by schedule_tasks, which
+ * hands it to the comms task from the scheduler's own thread.
+ */
+auto post_to_comms(sim_scheduler::Scheduler& scheduler,
+                   std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                   const messages::IncomingMessageFromHost& msg) -> void;
 
 };  // namespace tasks
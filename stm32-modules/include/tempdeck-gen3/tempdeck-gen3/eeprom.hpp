@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "core/kv_store.hpp"
 #include "core/m24128.hpp"
 
 namespace eeprom {
@@ -24,10 +25,8 @@ namespace eeprom {
  *
  * > Plate Temp = A * (heatsink temp) + ((B + 1) * Measured Temp) + C
  *
- * One of the EEPROM pages is reserved for a flag to indicate whether
- * the values have been written. The \ref EEPROMFlag enum captures the
- * valid states of this page. The page indicates what error detection,
- * if any, is included with the EEPROM constant values.
+ * Each constant is kept separately in the EEPROM, so a constant that has
+ * never been written keeps its default value.
  *
  */
 struct __attribute__((packed)) OffsetConstants {
@@ -41,13 +40,24 @@ struct __attribute__((packed)) PageContent {
 };
 
 /**
- * @brief Encapsulates interactions with the EEPROM on the Thermocycler
+ * @brief Encapsulates interactions with the EEPROM on the Temperature Deck
  * mainboard. Allows reading and writing the thermal offset constants.
+ *
+ * The constants are kept in a \ref kv_store::KVStore in the last pages of
+ * the EEPROM, and read from the EEPROM only once. Boards that were
+ * calibrated before the store existed have their constants at page 0; these
+ * are read when the store is empty and go into the store with the next
+ * write.
  */
 template <uint8_t ADDRESS>
 class Eeprom {
   public:
-    Eeprom() : _eeprom() {}
+    /** The pages at the end of the EEPROM that hold the store.*/
+    static constexpr uint8_t STORE_PAGES = 16;
+    static constexpr uint8_t STORE_FIRST_PAGE =
+        static_cast<uint8_t>(m24128::M24128<ADDRESS>::PAGES - STORE_PAGES);
+
+    Eeprom() : _store() {}
 
     /**
      * @brief Get the offset constants from the EEPROM
@@ -62,20 +72,11 @@ class Eeprom {
     template <m24128::M24128_Policy Policy>
     [[nodiscard]] auto get_offset_constants(const OffsetConstants& defaults,
                                             Policy& policy) -> OffsetConstants {
+        load(policy);
         OffsetConstants ret = defaults;
-        // Read the constants
-        auto readback = _eeprom.template read_value<PageContent>(
-            static_cast<uint8_t>(EEPROMPageMap::CONSTANTS), policy);
-
-        if (readback.has_value()) {
-            auto& values = readback.value();
-            if (values.constant_flag ==
-                static_cast<uint8_t>(EEPROMFlag::CONSTANTS_WRITTEN)) {
-                ret.a = values.constants.a;
-                ret.b = values.constants.b;
-                ret.c = values.constants.c;
-            }
-        }
+        ret.a = get(Key::CONST_A, ret.a);
+        ret.b = get(Key::CONST_B, ret.b);
+        ret.c = get(Key::CONST_C, ret.c);
 
         _initialized = true;
 
@@ -94,19 +95,11 @@ class Eeprom {
     template <m24128::M24128_Policy Policy>
     auto write_offset_constants(OffsetConstants constants, Policy& policy)
         -> bool {
-        // Write the constants
-        auto to_write = PageContent{.constant_flag = static_cast<uint8_t>(
-                                        EEPROMFlag::CONSTANTS_WRITTEN),
-                                    .constants = constants};
-        auto ret = _eeprom.template write_value(
-            static_cast<uint8_t>(EEPROMPageMap::CONSTANTS), to_write, policy);
-        if (!ret) {
-            // Attempt to flag that the constants are not valid
-            static_cast<void>(_eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONSTANTS),
-                static_cast<uint8_t>(EEPROMFlag::INVALID), policy));
-        }
-        return ret;
+        load(policy);
+        _store.set(Key::CONST_A, constants.a);
+        _store.set(Key::CONST_B, constants.b);
+        _store.set(Key::CONST_C, constants.c);
+        return _store.commit(policy);
     }
 
     /**
@@ -117,23 +110,59 @@ class Eeprom {
     [[nodiscard]] auto initialized() const -> bool { return _initialized; }
 
   private:
-    // Enumeration of memory locations to be used on the EEPROM
-    enum class EEPROMPageMap : uint8_t { CONSTANTS };
+    // Keys of the values in the store
+    struct Key {
+        static constexpr size_t CONST_A = 0;
+        static constexpr size_t CONST_B = 1;
+        static constexpr size_t CONST_C = 2;
+        static constexpr size_t COUNT = 3;
+    };
+
+    // Enumeration of memory locations used before the store
+    enum class LegacyPageMap : uint8_t { CONSTANTS };
 
-    // Enumeration of the EEPROM_CONST_FLAG values
-    enum class EEPROMFlag : uint8_t {
+    // Enumeration of the legacy constants flag values
+    enum class LegacyFlag : uint8_t {
         CONSTANTS_WRITTEN = 1,  // Values of all constants are written
         INVALID = 0xFF          // No values are written
     };
 
-    static_assert(sizeof(EEPROMPageMap) == sizeof(uint8_t),
-                  "EEPROM API requires uint8_t page address");
+    using Store =
+        kv_store::KVStore<m24128::M24128<ADDRESS>, m24128::PAGE_LENGTH,
+                          STORE_FIRST_PAGE, STORE_PAGES, Key::COUNT>;
 
-    /** Default value for all constants.*/
-    static constexpr double OFFSET_DEFAULT_CONST = 0.0F;
+    static_assert(Store::SLOT_PAGES == 1,
+                  "Each record should fit in a single page");
+
+    [[nodiscard]] auto get(size_t key, double fallback) const -> double {
+        return _store.template get<double>(key).value_or(fallback);
+    }
+
+    /**
+     * @brief Cache the store, or the legacy constants if the store is empty.
+     */
+    template <m24128::M24128_Policy Policy>
+    auto load(Policy& policy) -> void {
+        if (_store.loaded()) {
+            return;
+        }
+        if (!_store.load(policy) || !_store.empty()) {
+            return;
+        }
+        auto legacy = _store.device().template read_value<PageContent>(
+            static_cast<uint8_t>(LegacyPageMap::CONSTANTS), policy);
+        if (legacy.has_value() &&
+            legacy.value().constant_flag ==
+                static_cast<uint8_t>(LegacyFlag::CONSTANTS_WRITTEN)) {
+            auto constants = legacy.value().constants;
+            _store.set(Key::CONST_A, constants.a);
+            _store.set(Key::CONST_B, constants.b);
+            _store.set(Key::CONST_C, constants.c);
+        }
+    }
 
-    // Handle for the actual EEPROM IC
-    m24128::M24128<ADDRESS> _eeprom;
+    // The constants, kept in the EEPROM IC
+    Store _store;
     // Whether the constants have been read from the EEPROM since startup.
     // Even if the EEPROM is empty, this flag is set after attempting
     // to read so that the firmware doesn't try to keep making redundant
@@ -18,10 +18,20 @@ enum class ErrorCode {
     THERMAL_PELTIER_ERROR = 101,
     THERMAL_PELTIER_POWER_ERROR = 102,
     THERMAL_PELTIER_BUSY = 103,
+    THERMAL_AUTOTUNE_FAILED = 104,
+    THERMAL_AUTOTUNE_INVALID = 105,
+    THERMAL_PLATE_THERMISTOR_ERROR = 106,
     // 3xx - System General
     SYSTEM_SERIAL_NUMBER_INVALID = 301,
     SYSTEM_SERIAL_NUMBER_HAL_ERROR = 302,
     SYSTEM_EEPROM_ERROR = 303,
+    SYSTEM_FIRMWARE_UPDATE_NOT_STARTED = 304,
+    SYSTEM_FIRMWARE_BAD_LENGTH = 305,
+    SYSTEM_FIRMWARE_BAD_OFFSET = 306,
+    SYSTEM_FIRMWARE_BAD_CHUNK_CRC = 307,
+    SYSTEM_FIRMWARE_BAD_IMAGE_CRC = 308,
+    SYSTEM_FIRMWARE_BAD_IMAGE = 309,
+    SYSTEM_FIRMWARE_FLASH_ERROR = 310,
 };
 
 auto errorstring(ErrorCode code) -> const char*;
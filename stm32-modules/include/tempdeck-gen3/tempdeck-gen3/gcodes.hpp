@@ -6,7 +6,12 @@
 
 #pragma once
 
+#include <span>
+
+#include "core/firmware_update.hpp"
 #include "core/gcode_parser.hpp"
+#include "core/pid.hpp"
+#include "core/task_memory.hpp"
 #include "core/utility.hpp"
 #include "systemwide.h"
 
@@ -165,6 +170,162 @@ struct EnterBootloader {
     }
 };
 
+/**
+ * @brief Start uploading a firmware image into the backup partition, to be
+ * installed on the next reset. Any upload already in progress is abandoned.
+ *
+ * M980 S<image length> C<CRC-32 of the whole image>\n
+ *
+ */
+struct BeginFirmwareUpdate {
+    using ParseResult = std::optional<BeginFirmwareUpdate>;
+    static constexpr auto prefix = std::array{'M', '9', '8', '0'};
+    static constexpr const char* response = "M980 OK\n";
+
+    struct LengthArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = true;
+        bool present = false;
+        uint32_t value = 0;
+    };
+    struct CrcArg {
+        static constexpr auto prefix = std::array{'C'};
+        static constexpr bool required = true;
+        bool present = false;
+        uint32_t value = 0;
+    };
+
+    uint32_t length = 0;
+    uint32_t crc = 0;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res = gcode::SingleParser<LengthArg, CrcArg>::parse_gcode(
+            input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto arguments = res.first.value();
+        auto ret = BeginFirmwareUpdate{.length = std::get<0>(arguments).value,
+                                       .crc = std::get<1>(arguments).value};
+        return std::make_pair(ret, res.second);
+    }
+};
+
+/**
+ * @brief Write one chunk of a firmware image. Chunks must be sent in order,
+ * and every chunk but the last must hold a whole number of 8-byte
+ * doublewords. The data is hex encoded, at most
+ * firmware_update::MAX_CHUNK_LENGTH bytes.
+ *
+ * M981 A<offset in the image> C<CRC-32 of the chunk> D<data>\n
+ *
+ */
+struct WriteFirmwareChunk {
+    using ParseResult = std::optional<WriteFirmwareChunk>;
+    static constexpr auto prefix = std::array{'M', '9', '8', '1'};
+    static constexpr const char* response = "M981 OK\n";
+
+    struct OffsetArg {
+        static constexpr auto prefix = std::array{'A'};
+        static constexpr bool required = true;
+        bool present = false;
+        uint32_t value = 0;
+    };
+    struct CrcArg {
+        static constexpr auto prefix = std::array{'C'};
+        static constexpr bool required = true;
+        bool present = false;
+        uint32_t value = 0;
+    };
+    struct DataArg {
+        static constexpr auto prefix = std::array{'D'};
+        static constexpr bool required = true;
+        bool present = false;
+        std::array<char, firmware_update::MAX_CHUNK_LENGTH * 2> value = {};
+    };
+
+    uint32_t offset = 0;
+    uint32_t crc = 0;
+    firmware_update::Chunk data = {};
+    size_t length = 0;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res =
+            gcode::SingleParser<OffsetArg, CrcArg, DataArg>::parse_gcode(
+                input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto arguments = res.first.value();
+        const auto& hex = std::get<2>(arguments).value;
+        auto ret = WriteFirmwareChunk{.offset = std::get<0>(arguments).value,
+                                      .crc = std::get<1>(arguments).value};
+        ret.length = firmware_update::decode_hex(
+            hex.cbegin(),
+            std::next(hex.cbegin(), static_cast<ptrdiff_t>(
+                                        strnlen(hex.data(), hex.size()))),
+            ret.data.begin(), ret.data.size());
+        if (ret.length == 0) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ret, res.second);
+    }
+};
+
+/**
+ * @brief Check the uploaded firmware image and, if it is valid, restart to
+ * install it. No parameters.
+ *
+ * M982\n
+ *
+ */
+struct FinishFirmwareUpdate {
+    using ParseResult = std::optional<FinishFirmwareUpdate>;
+    static constexpr auto prefix = std::array{'M', '9', '8', '2'};
+    static constexpr const char* response = "M982 OK\n";
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(FinishFirmwareUpdate()), working);
+    }
+};
+
 /**
  * @brief Command to turn off the thermal system. No parameters.
  *
@@ -269,6 +430,149 @@ struct GetThermalPowerDebug {
     }
 };
 
+/**
+ * @brief Uses M990.D to dump the runtime stats of every task: how many
+ * passes its handler has made, the min, average and max time of one pass,
+ * the deepest its queue has been and a histogram of the pass times. Each
+ * histogram bucket covers four times the range of the one before, starting
+ * with under 16us. Periodic tasks also report their period and the average
+ * and max jitter of their wakeups. All times are in microseconds.
+ *
+ * Format: M990.D\n
+ * Return: M990.D <task>:N=<passes>,MIN=<us>,AVG=<us>,MAX=<us>,Q=<depth>,
+ * H=<bucket>/<bucket>/...[,P=<period>,J=<avg jitter>/<max jitter>] ... OK
+ *
+ */
+struct GetTaskStats {
+    using ParseResult = std::optional<GetTaskStats>;
+    static constexpr auto prefix = std::array{'M', '9', '9', '0', '.', 'D'};
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetTaskStats()), working);
+    }
+
+    template <typename InputIt, typename InLimit, typename Registry>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit,
+                                    const Registry& registry) -> InputIt {
+        auto write = [&buf, limit](const char* format, auto... args) {
+            if (buf >= limit) {
+                return;
+            }
+            auto res = snprintf(&*buf, (limit - buf), format, args...);
+            if (res > 0) {
+                buf += std::min(static_cast<ptrdiff_t>(res), limit - buf);
+            }
+        };
+        buf = write_string_to_iterpair(buf, limit, "M990.D");
+        for (const auto& task : registry) {
+            const auto& handler = task.handler();
+            write(" %s:N=%lu,MIN=%lu,AVG=%lu,MAX=%lu,Q=%lu,H=", task.name(),
+                  static_cast<unsigned long>(handler.count()),
+                  static_cast<unsigned long>(handler.min()),
+                  static_cast<unsigned long>(handler.average()),
+                  static_cast<unsigned long>(handler.max()),
+                  static_cast<unsigned long>(task.queue_high_water()));
+            const char* separator = "";
+            for (auto bucket : handler.histogram()) {
+                write("%s%lu", separator, static_cast<unsigned long>(bucket));
+                separator = "/";
+            }
+            if (task.period_us() != 0) {
+                write(",P=%lu,J=%lu/%lu",
+                      static_cast<unsigned long>(task.period_us()),
+                      static_cast<unsigned long>(task.jitter().average()),
+                      static_cast<unsigned long>(task.jitter().max()));
+            }
+        }
+        return write_string_to_iterpair(buf, limit, " OK\n");
+    }
+};
+
+/**
+ * @brief Uses M906.D to report how much memory the firmware is using: the
+ * static RAM and C heap, and then, a page at a time, the stack of every
+ * statically allocated task. Stacks are given as their size and the least
+ * free space they have had, in stack words. The host should keep asking with
+ * an increasing start index until it has read all N tasks.
+ *
+ * Format: M906.D [S<first task index>]\n
+ * Return: M906.D N:<total> S:<start> D:<data bytes> B:<bss bytes>
+ * H:<heap peak bytes>/<heap used bytes> <task>:<size>/<min free> ... OK
+ *
+ */
+struct GetTaskMemory {
+    using ParseResult = std::optional<GetTaskMemory>;
+    static constexpr auto prefix = std::array{'M', '9', '0', '6', '.', 'D'};
+
+    struct StartArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = false;
+        bool present = false;
+        uint32_t value = 0;
+    };
+
+    uint32_t start;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res =
+            gcode::SingleParser<StartArg>::parse_gcode(input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto arguments = res.first.value();
+        auto ret = GetTaskMemory{.start = 0};
+        if (std::get<0>(arguments).present) {
+            ret.start = std::get<0>(arguments).value;
+        }
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(
+        InputIt buf, InLimit limit, uint32_t total, uint32_t start,
+        const task_memory::RamUsage& ram,
+        std::span<const task_memory::StackUsage> stacks) -> InputIt {
+        auto write = [&buf, limit](const char* format, auto... args) {
+            if (buf >= limit) {
+                return;
+            }
+            auto res = snprintf(&*buf, (limit - buf), format, args...);
+            if (res > 0) {
+                buf += std::min(static_cast<ptrdiff_t>(res), limit - buf);
+            }
+        };
+        write("M906.D N:%lu S:%lu D:%lu B:%lu H:%lu/%lu",
+              static_cast<unsigned long>(total),
+              static_cast<unsigned long>(start),
+              static_cast<unsigned long>(ram.data_bytes),
+              static_cast<unsigned long>(ram.bss_bytes),
+              static_cast<unsigned long>(ram.heap_peak_bytes),
+              static_cast<unsigned long>(ram.heap_used_bytes));
+        for (const auto& stack : stacks) {
+            write(" %s:%lu/%lu", stack.name,
+                  static_cast<unsigned long>(stack.size_words),
+                  static_cast<unsigned long>(stack.min_free_words));
+        }
+        return write_string_to_iterpair(buf, limit, " OK\n");
+    }
+};
+
 /**
  * @brief SetTemperature is a command to set a temperature target for the
  * peltiers. There is one parameter, the target temp.
@@ -448,10 +752,17 @@ struct SetFanAutomatic {
 
 struct SetPIDConstants {
     /**
-     * SetPIDConstants uses M301. Sets the PWM of the fans as a percentage
-     * between 0 and 1.
+     * SetPIDConstants uses M301. Sets the PID constants of the peltier.
+     *
+     * M301 P[p] I[i] D[d] [Z[zone]] [H|C]\n
      *
-     * M301 P[p] I[i] D[d]\n
+     * The peltier uses a gain schedule indexed by the zone of its target
+     * and whether it is heating or cooling. Without Z, H or C the
+     * constants replace every entry and apply immediately. Otherwise they
+     * only replace the selected entries, and are used from the next
+     * target on:
+     * - Z selects one zone: 0 = cold, 1 = warm, 2 = hot
+     * - H selects only the heating gains, C only the cooling gains
      */
     using ParseResult = std::optional<SetPIDConstants>;
     static constexpr auto prefix = std::array{'M', '3', '0', '1'};
@@ -475,8 +786,109 @@ struct SetPIDConstants {
         bool present = false;
         float value = 0.0F;
     };
+    struct ArgZone {
+        static constexpr auto prefix = std::array{'Z'};
+        static constexpr bool required = false;
+        bool present = false;
+        int value = 0;
+    };
+    struct ArgHeating {
+        static constexpr auto prefix = std::array{'H'};
+        static constexpr bool required = false;
+        bool present = false;
+    };
+    struct ArgCooling {
+        static constexpr auto prefix = std::array{'C'};
+        static constexpr bool required = false;
+        bool present = false;
+    };
+
+    static constexpr int ZONE_MAX = 2;
 
     double const_p, const_i, const_d;
+    std::optional<size_t> zone = std::nullopt;
+    std::optional<PIDDirection> direction = std::nullopt;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res = gcode::SingleParser<ArgP, ArgI, ArgD, ArgZone, ArgHeating,
+                                       ArgCooling>::parse_gcode(input, limit,
+                                                                prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto [p, i, d, zone, heating, cooling] = res.first.value();
+        if ((heating.present && cooling.present) ||
+            (zone.present && (zone.value < 0 || zone.value > ZONE_MAX))) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto ret = SetPIDConstants{.const_p = p.value,
+                                   .const_i = i.value,
+                                   .const_d = d.value};
+        if (zone.present) {
+            ret.zone = static_cast<size_t>(zone.value);
+        }
+        if (heating.present) {
+            ret.direction = PIDDirection::HEATING;
+        } else if (cooling.present) {
+            ret.direction = PIDDirection::COOLING;
+        }
+        return std::make_pair(ret, res.second);
+    }
+};
+
+struct StartAutotune {
+    /**
+     * StartAutotune uses M303. Runs a relay-feedback autotune of the peltier
+     * PID constants around a target temperature, which takes several
+     * minutes. The peltier must not be holding a target.
+     *
+     * M303 S[target] [C[cycles]]\n
+     *
+     * - S is the temperature to oscillate the plate around
+     * - C is the number of oscillations to average over, after a first one
+     *   that is discarded
+     *
+     * The new constants replace every entry of the gain schedule (like M301
+     * without Z, H or C) as soon as tuning finishes, and are reported with
+     * an asynchronous line:
+     *
+     * async M303 DONE P:[p] I:[i] D:[d] OK\n
+     *
+     * If the plate does not settle into an oscillation, ERR104 is sent
+     * asynchronously instead. M104 and M18 cancel tuning.
+     */
+    using ParseResult = std::optional<StartAutotune>;
+    static constexpr auto prefix = std::array{'M', '3', '0', '3'};
+    static constexpr const char* response = "M303 OK\n";
+
+    struct ArgTarget {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = true;
+        bool present = false;
+        float value = 0.0F;
+    };
+    struct ArgCycles {
+        static constexpr auto prefix = std::array{'C'};
+        static constexpr bool required = false;
+        bool present = false;
+        int value = 0;
+    };
+
+    static constexpr int DEFAULT_CYCLES = 4;
+
+    double target;
+    int cycles;
 
     template <typename InputIt, typename InLimit>
     requires std::forward_iterator<InputIt> &&
@@ -485,20 +897,35 @@ struct SetPIDConstants {
         return write_string_to_iterpair(buf, limit, response);
     }
 
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InLimit, InputIt>
+    static auto write_event_into(InputIt buf, InLimit limit, double kp,
+                                 double ki, double kd) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "async M303 DONE P:%0.4f I:%0.4f D:%0.4f OK\n",
+                            static_cast<float>(kp), static_cast<float>(ki),
+                            static_cast<float>(kd));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+
     template <typename InputIt, typename Limit>
     requires std::contiguous_iterator<InputIt> &&
         std::sized_sentinel_for<Limit, InputIt>
     static auto parse(const InputIt& input, Limit limit)
         -> std::pair<ParseResult, InputIt> {
-        auto res = gcode::SingleParser<ArgP, ArgI, ArgD>::parse_gcode(
+        auto res = gcode::SingleParser<ArgTarget, ArgCycles>::parse_gcode(
             input, limit, prefix);
         if (!res.first.has_value()) {
             return std::make_pair(ParseResult(), input);
         }
-        auto arguments = res.first.value();
-        auto ret = SetPIDConstants{.const_p = std::get<0>(arguments).value,
-                                   .const_i = std::get<1>(arguments).value,
-                                   .const_d = std::get<2>(arguments).value};
+        auto [target, cycles] = res.first.value();
+        auto ret = StartAutotune{
+            .target = target.value,
+            .cycles = cycles.present ? cycles.value : DEFAULT_CYCLES};
         return std::make_pair(ret, res.second);
     }
 };
@@ -6,6 +6,7 @@
 #include <array>
 #include <cstring>
 #include <optional>
+#include <span>
 #include <utility>
 #include <variant>
 
@@ -36,18 +37,24 @@ class HostCommsTask {
         gcode::GetTemperatureDebug, gcode::SetTemperature, gcode::DeactivateAll,
         gcode::SetPeltierDebug, gcode::SetFanManual, gcode::SetFanAutomatic,
         gcode::SetPIDConstants, gcode::SetOffsetConstants,
-        gcode::GetOffsetConstants, gcode::GetThermalPowerDebug>;
+        gcode::GetOffsetConstants, gcode::GetThermalPowerDebug,
+        gcode::BeginFirmwareUpdate, gcode::WriteFirmwareChunk,
+        gcode::FinishFirmwareUpdate, gcode::GetTaskStats, gcode::GetTaskMemory,
+        gcode::StartAutotune>;
     using AckOnlyCache =
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
         AckCache<10, gcode::EnterBootloader, gcode::SetSerialNumber,
                  gcode::SetPeltierDebug, gcode::SetFanManual,
                  gcode::SetTemperature, gcode::DeactivateAll,
                  gcode::SetFanAutomatic, gcode::SetPIDConstants,
-                 gcode::SetOffsetConstants>;
+                 gcode::SetOffsetConstants, gcode::BeginFirmwareUpdate,
+                 gcode::WriteFirmwareChunk, gcode::FinishFirmwareUpdate,
+                 gcode::StartAutotune>;
     using GetSystemInfoCache = AckCache<4, gcode::GetSystemInfo>;
     using GetTempDebugCache = AckCache<4, gcode::GetTemperatureDebug>;
     using GetOffsetConstantsCache = AckCache<4, gcode::GetOffsetConstants>;
     using GetThermalPowerDebugCache = AckCache<4, gcode::GetThermalPowerDebug>;
+    using GetTaskMemoryCache = AckCache<4, gcode::GetTaskMemory>;
 
   public:
     static constexpr size_t TICKS_TO_WAIT_ON_SEND = 10;
@@ -64,7 +71,9 @@ class HostCommsTask {
           // NOLINTNEXTLINE(readability-redundant-member-init)
           get_offset_constants_cache(),
           // NOLINTNEXTLINE(readability-redundant-member-init)
-          get_thermal_power_debug_cache() {}
+          get_thermal_power_debug_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_task_memory_cache() {}
     HostCommsTask(const HostCommsTask& other) = delete;
     auto operator=(const HostCommsTask& other) -> HostCommsTask& = delete;
     HostCommsTask(HostCommsTask&& other) noexcept = delete;
@@ -75,6 +84,11 @@ class HostCommsTask {
         task_registry = aggregator;
     }
 
+    /** Give access to the stats that M990.D reports.*/
+    auto provide_task_stats(const tasks::TaskStatsRegistry* stats) {
+        task_stats = stats;
+    }
+
     /**
      * run_once() runs one spin of the task. This means it
      * - waits for a message to come in on its queue (either from another task,
@@ -218,6 +232,15 @@ class HostCommsTask {
         return errors::write_into_async(tx_into, tx_limit, msg.code);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::AutotuneEvent& event, InputIt tx_into,
+                       InputLimit tx_limit) -> InputIt {
+        return gcode::StartAutotune::write_event_into(
+            tx_into, tx_limit, event.kp, event.ki, event.kd);
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -337,6 +360,30 @@ class HostCommsTask {
             cache_entry);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::GetTaskMemoryResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry =
+            get_task_memory_cache.remove_if_present(response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, &response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.total, response.start,
+                        response.ram,
+                        std::span(response.stacks.data(), response.count));
+                }
+            },
+            cache_entry);
+    }
+
     /**
      * visit_gcode() is a set of member function overloads, each of which is
      * called when we parse the appropriate gcode out of the receive buffer.
@@ -419,6 +466,75 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::BeginFirmwareUpdate& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::BeginFirmwareUpdateMessage{
+            .id = id, .length = gcode.length, .crc = gcode.crc};
+        if (!task_registry->send(message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::WriteFirmwareChunk& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::WriteFirmwareChunkMessage{
+            .id = id,
+            .offset = gcode.offset,
+            .crc = gcode.crc,
+            .data = gcode.data,
+            .length = gcode.length};
+        if (!task_registry->send(message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::FinishFirmwareUpdate& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::FinishFirmwareUpdateMessage{.id = id};
+        if (!task_registry->send(message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -562,7 +678,32 @@ class HostCommsTask {
         auto message = messages::SetPIDConstantsMessage{.id = id,
                                                         .p = gcode.const_p,
                                                         .i = gcode.const_i,
-                                                        .d = gcode.const_d};
+                                                        .d = gcode.const_d,
+                                                        .zone = gcode.zone,
+                                                        .direction =
+                                                            gcode.direction};
+        if (!task_registry->send(message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::StartAutotune& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::StartAutotuneMessage{
+            .id = id, .target = gcode.target, .cycles = gcode.cycles};
         if (!task_registry->send(message, TICKS_TO_WAIT_ON_SEND)) {
             auto wrote_to = errors::write_into(
                 tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
@@ -638,6 +779,43 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetTaskMemory& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = get_task_memory_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message =
+            messages::GetTaskMemoryMessage{.id = id, .start = gcode.start};
+        if (!task_registry->send(message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_task_memory_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetTaskStats& ignore, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        static_cast<void>(ignore);
+        if (task_stats == nullptr) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::UNHANDLED_GCODE));
+        }
+        return std::make_pair(true, gcode::GetTaskStats::write_response_into(
+                                        tx_into, tx_limit, *task_stats));
+    }
+
     // Our error handler just writes an error and bails
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
@@ -657,6 +835,8 @@ class HostCommsTask {
     GetTempDebugCache get_temp_debug_cache;
     GetOffsetConstantsCache get_offset_constants_cache;
     GetThermalPowerDebugCache get_thermal_power_debug_cache;
+    GetTaskMemoryCache get_task_memory_cache;
+    const tasks::TaskStatsRegistry* task_stats = nullptr;
     bool may_connect_latch = true;
 };
 
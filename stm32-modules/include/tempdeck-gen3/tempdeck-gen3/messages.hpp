@@ -2,8 +2,12 @@
 #include <array>
 #include <concepts>
 #include <cstdint>
+#include <optional>
 #include <variant>
 
+#include "core/firmware_update.hpp"
+#include "core/pid.hpp"
+#include "core/task_memory.hpp"
 #include "systemwide.h"
 #include "tempdeck-gen3/errors.hpp"
 
@@ -77,6 +81,28 @@ struct GetSystemInfoResponse {
     const char* hw_version;
 };
 
+struct GetTaskMemoryMessage {
+    uint32_t id;
+    // Index of the first task to report
+    uint32_t start;
+};
+
+struct GetTaskMemoryResponse {
+    // Every HostCommsMessage is as big as its largest alternative, so one
+    // task per response with narrow counts keeps this no bigger than the
+    // system info response
+    static constexpr size_t MAX_TASKS = 1;
+    uint32_t responding_to_id;
+    // Total number of tracked tasks
+    uint16_t total;
+    // Number of valid entries in \c stacks
+    uint16_t count;
+    // Index of the first task in this response
+    uint32_t start;
+    task_memory::RamUsage ram;
+    std::array<task_memory::StackUsage, MAX_TASKS> stacks;
+};
+
 struct SetSerialNumberMessage {
     uint32_t id;
     static constexpr std::size_t SERIAL_NUMBER_LENGTH =
@@ -88,18 +114,39 @@ struct EnterBootloaderMessage {
     uint32_t id;
 };
 
+struct BeginFirmwareUpdateMessage {
+    uint32_t id;
+    uint32_t length;
+    uint32_t crc;
+};
+
+struct WriteFirmwareChunkMessage {
+    uint32_t id = 0;
+    uint32_t offset = 0;
+    uint32_t crc = 0;
+    firmware_update::Chunk data = {};
+    size_t length = 0;
+};
+
+struct FinishFirmwareUpdateMessage {
+    uint32_t id;
+};
+
 struct ForceUSBDisconnect {
     uint32_t id;
     size_t return_address;
 };
 
 struct ThermistorReadings {
-    uint32_t timestamp;
     uint32_t plate_1;
     uint32_t plate_2;
     uint32_t heatsink;
     // Peltier current feedback
     uint32_t imeas;
+    // The tick that each thermistor finished converting at
+    uint32_t plate_1_timestamp;
+    uint32_t plate_2_timestamp;
+    uint32_t heatsink_timestamp;
 };
 
 struct DeactivateAllMessage {
@@ -140,8 +187,21 @@ struct SetTemperatureMessage {
 };
 
 struct SetPIDConstantsMessage {
-    uint32_t id;
-    double p, i, d;
+    uint32_t id = 0;
+    double p = 0, i = 0, d = 0;
+    // Gain schedule entries to update, or all of them if empty
+    std::optional<size_t> zone = std::nullopt;
+    std::optional<PIDDirection> direction = std::nullopt;
+};
+
+struct StartAutotuneMessage {
+    uint32_t id = 0;
+    double target = 0;
+    int cycles = 0;
+};
+
+struct AutotuneEvent {
+    double kp = 0, ki = 0, kd = 0;
 };
 
 struct GetOffsetConstantsMessage {
@@ -173,10 +233,13 @@ using HostCommsMessage =
     ::std::variant<std::monostate, IncomingMessageFromHost, ForceUSBDisconnect,
                    ErrorMessage, AcknowledgePrevious, GetSystemInfoResponse,
                    GetTempDebugResponse, GetOffsetConstantsResponse,
-                   GetThermalPowerDebugResponse>;
+                   GetThermalPowerDebugResponse, GetTaskMemoryResponse,
+                   AutotuneEvent>;
 using SystemMessage =
     ::std::variant<std::monostate, AcknowledgePrevious, GetSystemInfoMessage,
-                   SetSerialNumberMessage, EnterBootloaderMessage>;
+                   SetSerialNumberMessage, EnterBootloaderMessage,
+                   BeginFirmwareUpdateMessage, WriteFirmwareChunkMessage,
+                   FinishFirmwareUpdateMessage, GetTaskMemoryMessage>;
 using UIMessage = ::std::variant<std::monostate, UpdateUIMessage>;
 using ThermalMessage =
     ::std::variant<std::monostate, ThermistorReadings, GetTempDebugMessage,
@@ -184,5 +247,5 @@ using ThermalMessage =
                    SetFanAutomaticMessage, DeactivateAllMessage,
                    SetTemperatureMessage, SetPIDConstantsMessage,
                    GetOffsetConstantsMessage, SetOffsetConstantsMessage,
-                   GetThermalPowerDebugMessage>;
+                   GetThermalPowerDebugMessage, StartAutotuneMessage>;
 };  // namespace messages
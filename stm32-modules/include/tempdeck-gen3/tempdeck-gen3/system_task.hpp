@@ -6,7 +6,9 @@
 #pragma once
 
 #include "core/ack_cache.hpp"
+#include "core/firmware_update.hpp"
 #include "core/queue_aggregator.hpp"
+#include "core/task_memory.hpp"
 #include "core/version.hpp"
 #include "hal/message_queue.hpp"
 #include "tempdeck-gen3/messages.hpp"
@@ -15,7 +17,7 @@
 namespace system_task {
 
 template <typename Policy>
-concept SystemExecutionPolicy = requires(Policy& p) {
+concept SystemExecutionPolicy = requires(Policy& p, const Policy& cp) {
     {p.enter_bootloader()};
     {
         p.set_serial_number(std::array<char, SYSTEM_WIDE_SERIAL_NUMBER_LENGTH>{
@@ -24,7 +26,16 @@ concept SystemExecutionPolicy = requires(Policy& p) {
     {
         p.get_serial_number()
         } -> std::same_as<std::array<char, SYSTEM_WIDE_SERIAL_NUMBER_LENGTH>>;
-};
+    // Reset the microcontroller, so the startup app installs a staged update
+    {p.system_reset()};
+    // The number of statically allocated tasks whose stacks are tracked
+    { cp.get_task_count() } -> std::same_as<size_t>;
+    // The stack usage of one tracked task
+    { cp.get_stack_usage(0) } -> std::same_as<task_memory::StackUsage>;
+    // The static RAM and heap in use
+    { cp.get_ram_usage() } -> std::same_as<task_memory::RamUsage>;
+}
+&&firmware_update::BackupFlashPolicy<Policy>;
 
 using Message = messages::SystemMessage;
 
@@ -38,15 +49,19 @@ class SystemTask {
 
     static constexpr size_t MY_ADDRESS = Queues::SystemAddress;
 
+    // What to do once the prep activities for leaving the app are done
+    enum class Exit { ENTER_BOOTLOADER, INSTALL_UPDATE };
     // Mark ID's for bootloader prep activities
-    using BootloaderPrepCache = AckCache<4, int>;
+    using BootloaderPrepCache = AckCache<4, Exit>;
 
   public:
     explicit SystemTask(Queue& q, Aggregator* aggregator = nullptr)
         : _message_queue(q),
           _task_registry(aggregator),
           // NOLINTNEXTLINE(readability-redundant-member-init)
-          _prep_cache() {}
+          _prep_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          _updater() {}
     SystemTask(const SystemTask& other) = delete;
     auto operator=(const SystemTask& other) -> SystemTask& = delete;
     SystemTask(SystemTask&& other) noexcept = delete;
@@ -79,6 +94,25 @@ class SystemTask {
         static_cast<void>(_task_registry->send(response));
     }
 
+    template <SystemExecutionPolicy Policy>
+    auto visit_message(const messages::GetTaskMemoryMessage& message,
+                       Policy& policy) {
+        auto response = messages::GetTaskMemoryResponse{
+            .responding_to_id = message.id,
+            .total = static_cast<uint16_t>(policy.get_task_count()),
+            .count = 0,
+            .start = message.start,
+            .ram = policy.get_ram_usage(),
+            .stacks = {}};
+        while (response.count < response.stacks.size() &&
+               response.start + response.count < response.total) {
+            response.stacks.at(response.count) =
+                policy.get_stack_usage(response.start + response.count);
+            ++response.count;
+        }
+        static_cast<void>(_task_registry->send(response));
+    }
+
     template <SystemExecutionPolicy Policy>
     auto visit_message(const messages::SetSerialNumberMessage& message,
                        Policy& policy) {
@@ -92,18 +126,7 @@ class SystemTask {
     template <SystemExecutionPolicy Policy>
     auto visit_message(const messages::EnterBootloaderMessage& message,
                        Policy& policy) {
-        // Must disconnect USB before restarting
-        auto id = _prep_cache.add(0);
-        auto usb_msg = messages::ForceUSBDisconnect{
-            .id = id, .return_address = MY_ADDRESS};
-        if (!_task_registry->send_to_address(usb_msg, Queues::HostAddress)) {
-            _prep_cache.remove_if_present(id);
-        }
-
-        if (_prep_cache.empty()) {
-            // Couldn't send any messages? Enter bootloader anyways
-            policy.enter_bootloader();
-        }
+        prepare_exit(Exit::ENTER_BOOTLOADER, policy);
 
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = message.id};
@@ -111,6 +134,32 @@ class SystemTask {
             _task_registry->send_to_address(response, Queues::HostAddress));
     }
 
+    template <SystemExecutionPolicy Policy>
+    auto visit_message(const messages::BeginFirmwareUpdateMessage& message,
+                       Policy& policy) {
+        auto result = _updater.begin(message.length, message.crc, policy);
+        acknowledge_update(message.id, result);
+    }
+
+    template <SystemExecutionPolicy Policy>
+    auto visit_message(const messages::WriteFirmwareChunkMessage& message,
+                       Policy& policy) {
+        auto result = _updater.write(message.offset, message.data,
+                                     message.length, message.crc, policy);
+        acknowledge_update(message.id, result);
+    }
+
+    template <SystemExecutionPolicy Policy>
+    auto visit_message(const messages::FinishFirmwareUpdateMessage& message,
+                       Policy& policy) {
+        auto result = _updater.finish(policy);
+        // The host hears whether the image was good before USB goes away
+        acknowledge_update(message.id, result);
+        if (result == firmware_update::Result::OK) {
+            prepare_exit(Exit::INSTALL_UPDATE, policy);
+        }
+    }
+
     // Any Ack messages should be in response to bootloader prep messages
     template <SystemExecutionPolicy Policy>
     auto visit_message(const messages::AcknowledgePrevious& message,
@@ -121,8 +170,8 @@ class SystemTask {
             return;
         }
         if (_prep_cache.empty()) {
-            // All prep activities done, enter bootloader now
-            policy.enter_bootloader();
+            // All prep activities done, leave the app now
+            leave_app(std::get<Exit>(res), policy);
         }
     }
 
@@ -132,9 +181,67 @@ class SystemTask {
         static_cast<void>(policy);
     }
 
+    // Must disconnect USB before restarting
+    template <SystemExecutionPolicy Policy>
+    auto prepare_exit(Exit exit_to, Policy& policy) -> void {
+        auto id = _prep_cache.add(exit_to);
+        auto usb_msg = messages::ForceUSBDisconnect{
+            .id = id, .return_address = MY_ADDRESS};
+        if (!_task_registry->send_to_address(usb_msg, Queues::HostAddress)) {
+            _prep_cache.remove_if_present(id);
+        }
+
+        if (_prep_cache.empty()) {
+            // Couldn't send any messages? Leave anyways
+            leave_app(exit_to, policy);
+        }
+    }
+
+    template <SystemExecutionPolicy Policy>
+    auto leave_app(Exit exit_to, Policy& policy) -> void {
+        if (exit_to == Exit::INSTALL_UPDATE) {
+            policy.system_reset();
+        } else {
+            policy.enter_bootloader();
+        }
+    }
+
+    auto acknowledge_update(uint32_t id, firmware_update::Result result)
+        -> void {
+        auto response = messages::AcknowledgePrevious{
+            .responding_to_id = id, .with_error = update_error(result)};
+        static_cast<void>(
+            _task_registry->send_to_address(response, Queues::HostAddress));
+    }
+
+    static auto update_error(firmware_update::Result result)
+        -> errors::ErrorCode {
+        using firmware_update::Result;
+        switch (result) {
+            case Result::OK:
+                return errors::ErrorCode::NO_ERROR;
+            case Result::NOT_STARTED:
+                return errors::ErrorCode::SYSTEM_FIRMWARE_UPDATE_NOT_STARTED;
+            case Result::BAD_LENGTH:
+                return errors::ErrorCode::SYSTEM_FIRMWARE_BAD_LENGTH;
+            case Result::BAD_OFFSET:
+                return errors::ErrorCode::SYSTEM_FIRMWARE_BAD_OFFSET;
+            case Result::BAD_CHUNK_CRC:
+                return errors::ErrorCode::SYSTEM_FIRMWARE_BAD_CHUNK_CRC;
+            case Result::BAD_IMAGE_CRC:
+                return errors::ErrorCode::SYSTEM_FIRMWARE_BAD_IMAGE_CRC;
+            case Result::BAD_IMAGE:
+                return errors::ErrorCode::SYSTEM_FIRMWARE_BAD_IMAGE;
+            case Result::FLASH_ERROR:
+                return errors::ErrorCode::SYSTEM_FIRMWARE_FLASH_ERROR;
+        }
+        return errors::ErrorCode::SYSTEM_FIRMWARE_FLASH_ERROR;
+    }
+
     Queue& _message_queue;
     Aggregator* _task_registry;
     BootloaderPrepCache _prep_cache;
+    firmware_update::Updater _updater;
 };
 
 };  // namespace system_task
@@ -4,11 +4,34 @@
  */
 #pragma once
 
+#include <array>
+
 #include "core/queue_aggregator.hpp"
+#include "core/task_stats.hpp"
 #include "tempdeck-gen3/messages.hpp"
 
 namespace tasks {
 
+// Where each task keeps its runtime stats in the TaskStatsRegistry
+enum class TaskIndex : size_t {
+    HOST_COMMS,
+    SYSTEM,
+    UI,
+    THERMISTOR,
+    THERMAL,
+};
+
+using TaskStatsRegistry = task_stats::Registry<5>;
+
+// Matches TaskIndex
+static constexpr std::array<const char*, TaskStatsRegistry::TASKS>
+    TASK_NAMES = {"HostComms", "System", "UI", "Thermistor", "Thermal"};
+
+inline auto task_stats_for(TaskStatsRegistry& registry, TaskIndex task)
+    -> task_stats::TaskStats& {
+    return registry.at(static_cast<size_t>(task));
+}
+
 template <template <class> class QueueImpl>
 struct Tasks {
     // Message queue for host comms
@@ -2,9 +2,10 @@
 
 #include <optional>
 
+#include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
 #include "core/thermistor_conversion.hpp"
 #include "hal/message_queue.hpp"
-#include "ot_utils/core/pid.hpp"
 #include "tempdeck-gen3/eeprom.hpp"
 #include "tempdeck-gen3/messages.hpp"
 #include "tempdeck-gen3/tasks.hpp"
@@ -35,6 +36,7 @@ struct ThermalReadings {
     std::optional<double> plate_temp_2 = 0.0F;
     double peltier_current_milliamps = 0.0F;
 
+    // The tick that the plate was last sampled at
     uint32_t last_tick = 0;
 };
 
@@ -120,6 +122,19 @@ class ThermalTask {
     static constexpr double PELTIER_K_MIN = -200.0F;
     static constexpr double PELTIER_WINDUP_LIMIT = 1.0F;
 
+    // The peltier gain schedule has a zone below COOL_THRESHOLD, one
+    // between the thresholds and one above HOT_THRESHOLD
+    static constexpr size_t PID_ZONE_COUNT = 3;
+    using GainSchedule = PIDGainSchedule<PID_ZONE_COUNT>;
+
+    // Peltier power on either side of the autotune relay
+    static constexpr double AUTOTUNE_RELAY_POWER = 0.5F;
+    // Band around the autotune target before the relay switches
+    static constexpr Celsius AUTOTUNE_HYSTERESIS = 0.25F;
+    static constexpr double AUTOTUNE_TIMEOUT_SECONDS = 1200.0F;
+    static constexpr Celsius AUTOTUNE_TARGET_MIN = 4.0F;
+    static constexpr Celsius AUTOTUNE_TARGET_MAX = 95.0F;
+
     static constexpr double MILLISECONDS_TO_SECONDS = 0.001F;
 
     static constexpr uint8_t EEPROM_ADDRESS = 0x50;
@@ -144,11 +159,19 @@ class ThermalTask {
           _pid(PELTIER_KP_HEATING_DEFAULT, PELTIER_KI_HEATING_DEFAULT,
                PELTIER_KD_DEFAULT, 1.0F, PELTIER_WINDUP_LIMIT,
                -PELTIER_WINDUP_LIMIT),
+          _gains(PIDGains{.kp = PELTIER_KP_HEATING_DEFAULT,
+                          .ki = PELTIER_KI_HEATING_DEFAULT,
+                          .kd = PELTIER_KD_DEFAULT},
+                 PIDGains{.kp = PELTIER_KP_COOLING_DEFAULT,
+                          .ki = PELTIER_KI_COOLING_DEFAULT,
+                          .kd = PELTIER_KD_DEFAULT}),
           // NOLINTNEXTLINE(readability-redundant-member-init)
           _eeprom(),
           _offset_constants{.a = OFFSET_DEFAULT_CONST_A,
                             .b = OFFSET_DEFAULT_CONST_B,
-                            .c = OFFSET_DEFAULT_CONST_C} {}
+                            .c = OFFSET_DEFAULT_CONST_C},
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          _autotune() {}
     ThermalTask(const ThermalTask& other) = delete;
     auto operator=(const ThermalTask& other) -> ThermalTask& = delete;
     ThermalTask(ThermalTask&& other) noexcept = delete;
@@ -187,7 +210,26 @@ class ThermalTask {
 
     [[nodiscard]] auto get_peltier() const -> Peltier { return _peltier; }
 
-    [[nodiscard]] auto get_pid() const -> ot_utils::pid::PID { return _pid; }
+    [[nodiscard]] auto get_pid() const -> PID { return _pid; }
+
+    [[nodiscard]] auto autotuning() const -> bool {
+        return _autotune.running();
+    }
+
+    [[nodiscard]] auto get_gain_schedule() const -> const GainSchedule& {
+        return _gains;
+    }
+
+    /** Get the gain schedule zone of a target temperature.*/
+    [[nodiscard]] static constexpr auto pid_zone(Celsius target) -> size_t {
+        if (target < COOL_THRESHOLD) {
+            return 0;
+        }
+        if (target < HOT_THRESHOLD) {
+            return 1;
+        }
+        return 2;
+    }
 
   private:
     template <ThermalPolicy Policy>
@@ -201,13 +243,21 @@ class ThermalTask {
                        Policy& policy) -> void {
         static_cast<void>(policy);
 
-        auto tick_difference = message.timestamp - _readings.last_tick;
+        // The control loop runs on the average of the plate thermistors, so
+        // it was sampled halfway between the two of them. Timing it from
+        // their own timestamps keeps retries and scheduling delays in the
+        // thermistor task out of the PID sampletime.
+        auto plate_spread = static_cast<int32_t>(message.plate_2_timestamp -
+                                                 message.plate_1_timestamp);
+        auto plate_tick = message.plate_1_timestamp +
+                          static_cast<uint32_t>(plate_spread / 2);
+        auto tick_difference = plate_tick - _readings.last_tick;
 
         _readings.heatsink_adc = message.heatsink;
         _readings.plate_adc_1 = message.plate_1;
         _readings.plate_adc_2 = message.plate_2;
         _readings.peltier_current_adc = message.imeas;
-        _readings.last_tick = message.timestamp;
+        _readings.last_tick = plate_tick;
         // Reading conversion
 
         _readings.heatsink_temp = convert_thermistor(message.heatsink, false);
@@ -237,6 +287,7 @@ class ThermalTask {
 
         _peltier.manual = false;
         _peltier.target_set = false;
+        _autotune.stop();
         policy.disable_peltier();
 
         auto response =
@@ -281,18 +332,12 @@ class ThermalTask {
         _peltier.manual = false;
         _peltier.target_set = true;
         _peltier.target = message.target;
-        if (_readings.plate_temp_1.value() < _peltier.target) {
-            _pid = ot_utils::pid::PID(
-                PELTIER_KP_HEATING_DEFAULT, PELTIER_KI_HEATING_DEFAULT,
-                PELTIER_KD_DEFAULT, 1.0, PELTIER_WINDUP_LIMIT,
-                -PELTIER_WINDUP_LIMIT);
-        } else {
-            _pid = ot_utils::pid::PID(
-                PELTIER_KP_COOLING_DEFAULT, PELTIER_KI_COOLING_DEFAULT,
-                PELTIER_KD_DEFAULT, 1.0, PELTIER_WINDUP_LIMIT,
-                -PELTIER_WINDUP_LIMIT);
-        }
+        _autotune.stop();
+        auto direction = (_readings.plate_temp_1.value() < _peltier.target)
+                             ? PIDDirection::HEATING
+                             : PIDDirection::COOLING;
         _pid.reset();
+        _pid.set_gains(_gains.get(pid_zone(_peltier.target), direction));
 
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = message.id};
@@ -305,7 +350,7 @@ class ThermalTask {
                        Policy& policy) -> void {
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = message.id};
-        if (_peltier.target_set) {
+        if (_peltier.target_set || _autotune.running()) {
             // If the thermal task is busy with a target, don't override that
             response.with_error = errors::ErrorCode::THERMAL_PELTIER_BUSY;
         } else {
@@ -375,8 +420,13 @@ class ThermalTask {
         auto i = std::clamp(message.i, PELTIER_K_MIN, PELTIER_K_MAX);
         auto d = std::clamp(message.d, PELTIER_K_MIN, PELTIER_K_MAX);
 
-        _pid = ot_utils::pid::PID(p, i, d, 1.0, PELTIER_WINDUP_LIMIT,
-                                  -PELTIER_WINDUP_LIMIT);
+        auto gains = PIDGains{.kp = p, .ki = i, .kd = d};
+        static_cast<void>(
+            _gains.set(message.zone, message.direction, gains));
+        // Without a zone or direction, the gains also apply right away
+        if (!message.zone.has_value() && !message.direction.has_value()) {
+            _pid.set_gains(gains);
+        }
 
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = message.id};
@@ -384,6 +434,39 @@ class ThermalTask {
             _task_registry->send_to_address(response, Queues::HostAddress));
     }
 
+    template <ThermalPolicy Policy>
+    auto visit_message(const messages::StartAutotuneMessage& message,
+                       Policy& policy) -> void {
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = message.id};
+        auto config = relay_autotune::Config{
+            .setpoint = message.target,
+            .output_high = AUTOTUNE_RELAY_POWER,
+            .output_low = -AUTOTUNE_RELAY_POWER,
+            .hysteresis = AUTOTUNE_HYSTERESIS,
+            .cycles = static_cast<uint8_t>(std::clamp(
+                message.cycles, 0,
+                static_cast<int>(relay_autotune::RelayAutotune::MAX_CYCLES))),
+            .timeout = AUTOTUNE_TIMEOUT_SECONDS};
+
+        if (_peltier.target_set || _autotune.running()) {
+            response.with_error = errors::ErrorCode::THERMAL_PELTIER_BUSY;
+        } else if ((message.target < AUTOTUNE_TARGET_MIN) ||
+                   (message.target > AUTOTUNE_TARGET_MAX) ||
+                   (message.cycles != config.cycles) ||
+                   !relay_autotune::RelayAutotune::valid(config)) {
+            response.with_error = errors::ErrorCode::THERMAL_AUTOTUNE_INVALID;
+        } else {
+            // Tuning takes over from a debug power setting
+            _peltier.manual = false;
+            policy.disable_peltier();
+            static_cast<void>(_autotune.start(config));
+        }
+
+        static_cast<void>(
+            _task_registry->send_to_address(response, Queues::HostAddress));
+    }
+
     template <ThermalPolicy Policy>
     auto visit_message(const messages::SetOffsetConstantsMessage& message,
                        Policy& policy) -> void {
@@ -440,7 +523,8 @@ class ThermalTask {
             .peltier_pwm = _peltier.power,
             .fan_pwm = _fan.power};
 
-        if (!_peltier.target_set && !_peltier.manual) {
+        if (!_peltier.target_set && !_peltier.manual &&
+            !_autotune.running()) {
             response.peltier_pwm = 0.0F;
         }
         response.fan_rpm = policy.get_fan_rpm();
@@ -457,6 +541,9 @@ class ThermalTask {
      */
     template <ThermalPolicy Policy>
     auto update_thermal_control(Policy& policy, double sampletime) -> void {
+        if (_autotune.running()) {
+            update_autotune(policy, sampletime);
+        }
         if (_peltier.target_set) {
             if (!_plate_avg.has_value()) {
                 _peltier.target_set = false;
@@ -489,6 +576,9 @@ class ThermalTask {
                 } else {
                     _fan.power = FAN_POWER_MEDIUM;
                 }
+            } else if (_autotune.running()) {
+                // A steady fan keeps the cooling half of the relay repeatable
+                _fan.power = FAN_POWER_MEDIUM;
             } else /* !_peltier.target_set */ {
                 if (_readings.heatsink_temp.has_value() &&
                     _readings.heatsink_temp.value() < HEATSINK_IDLE_THRESHOLD) {
@@ -501,6 +591,79 @@ class ThermalTask {
         }
     }
 
+    /**
+     * @brief Drive the peltier from the relay autotuner. Once the autotuner
+     * stops, the peltier is disabled and the result is applied and
+     * reported.
+     *
+     * @param[in] policy The hardware control policy
+     * @param[in] sampletime The number of seconds since the last temp reading
+     */
+    template <ThermalPolicy Policy>
+    auto update_autotune(Policy& policy, double sampletime) -> void {
+        if (!_plate_avg.has_value()) {
+            // Without a plate reading the relay has nothing to switch on, so
+            // abandon the run rather than leave the host waiting for M303
+            _autotune.stop();
+            policy.disable_peltier();
+            _peltier.power = 0.0F;
+            static_cast<void>(_task_registry->send_to_address(
+                messages::ErrorMessage{
+                    .code = errors::ErrorCode::THERMAL_PLATE_THERMISTOR_ERROR},
+                Queues::HostAddress));
+            return;
+        }
+        _peltier.power = _autotune.update(_plate_avg.value(), sampletime);
+        if (!_autotune.running()) {
+            finish_autotune(policy);
+            return;
+        }
+        policy.enable_peltier();
+        bool ret = false;
+        if (_peltier.power >= 0.0F) {
+            ret = policy.set_peltier_heat_power(_peltier.power);
+        } else {
+            ret = policy.set_peltier_cool_power(std::abs(_peltier.power));
+        }
+        if (!ret) {
+            _autotune.stop();
+            policy.disable_peltier();
+            static_cast<void>(_task_registry->send_to_address(
+                messages::ErrorMessage{
+                    .code = errors::ErrorCode::THERMAL_PELTIER_ERROR},
+                Queues::HostAddress));
+        }
+    }
+
+    /**
+     * @brief Turn off the peltier after autotuning and either apply the new
+     * PID constants or report the failure to the host.
+     */
+    template <ThermalPolicy Policy>
+    auto finish_autotune(Policy& policy) -> void {
+        policy.disable_peltier();
+        _peltier.power = 0.0F;
+
+        auto result = _autotune.result();
+        if (!result.has_value()) {
+            static_cast<void>(_task_registry->send_to_address(
+                messages::ErrorMessage{
+                    .code = errors::ErrorCode::THERMAL_AUTOTUNE_FAILED},
+                Queues::HostAddress));
+            return;
+        }
+        auto gains = PIDGains{
+            .kp = std::clamp(result.value().kp, PELTIER_K_MIN, PELTIER_K_MAX),
+            .ki = std::clamp(result.value().ki, PELTIER_K_MIN, PELTIER_K_MAX),
+            .kd = std::clamp(result.value().kd, PELTIER_K_MIN, PELTIER_K_MAX)};
+        static_cast<void>(_gains.set(std::nullopt, std::nullopt, gains));
+        _pid.set_gains(gains);
+        static_cast<void>(_task_registry->send_to_address(
+            messages::AutotuneEvent{
+                .kp = gains.kp, .ki = gains.ki, .kd = gains.kd},
+            Queues::HostAddress));
+    }
+
     auto set_plate_avg(std::optional<double> plate_1,
                        std::optional<double> plate_2) -> void {
         double avg = 0.0F;
@@ -544,9 +707,11 @@ class ThermalTask {
     thermistor_conversion::Conversion<lookups::KS103J2G> _converter;
     Fan _fan;
     Peltier _peltier;
-    ot_utils::pid::PID _pid;
+    PID _pid;
+    GainSchedule _gains;
     eeprom::Eeprom<EEPROM_ADDRESS> _eeprom;
     eeprom::OffsetConstants _offset_constants;
+    relay_autotune::RelayAutotune _autotune;
 };
 
 };  // namespace thermal_task
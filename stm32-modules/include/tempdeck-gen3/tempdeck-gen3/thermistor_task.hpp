@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include "core/ads1115.hpp"
 #include "hal/message_queue.hpp"
 #include "tempdeck-gen3/messages.hpp"
@@ -14,7 +16,8 @@ concept ThermistorPolicy = requires(Policy& p) {
     // millisecond increments.
     { p.get_time_ms() } -> std::same_as<uint32_t>;
     // A function to sleep the task for a configurable number of milliseconds.
-    // Used to provide a delay between thermistor read retries.
+    // Used to provide a delay before retrying the thermistors that failed
+    // to read.
     { p.sleep_ms(1) } -> std::same_as<void>;
     // A function to read the last Peltier Feedback reading
     { p.get_imeas_adc_reading() } -> std::same_as<uint32_t>;
@@ -55,37 +58,76 @@ class ThermistorTask {
             adc.initialize();
         }
 
+        auto channels = Channels();
+        read_channels(adc, channels, policy);
+
         messages::ThermistorReadings msg = {
-            .timestamp = policy.get_time_ms(),
-            .plate_1 = read_pin(adc, 0, policy),
-            .plate_2 = read_pin(adc, 1, policy),
-            .heatsink = read_pin(adc, 2, policy),
+            .plate_1 = channels.at(PLATE_1_PIN).reading,
+            .plate_2 = channels.at(PLATE_2_PIN).reading,
+            .heatsink = channels.at(HEATSINK_PIN).reading,
             .imeas = policy.get_imeas_adc_reading(),
+            .plate_1_timestamp = channels.at(PLATE_1_PIN).timestamp,
+            .plate_2_timestamp = channels.at(PLATE_2_PIN).timestamp,
+            .heatsink_timestamp = channels.at(HEATSINK_PIN).timestamp,
         };
 
         static_cast<void>(_task_registry->send(msg));
     }
 
   private:
+    static constexpr uint16_t PLATE_1_PIN = 0;
+    static constexpr uint16_t PLATE_2_PIN = 1;
+    static constexpr uint16_t HEATSINK_PIN = 2;
+    static constexpr size_t CHANNEL_COUNT = 3;
+
+    struct Channel {
+        // The ADC reading, or the error that the last try failed with
+        uint16_t reading = 0;
+        // The tick that the last try at reading this channel finished at
+        uint32_t timestamp = 0;
+        bool read = false;
+    };
+    using Channels = std::array<Channel, CHANNEL_COUNT>;
+
+    /**
+     * @brief Read every thermistor channel, retrying the ones that fail.
+     *
+     * Each pass tries every channel that hasn't been read yet once, so a
+     * channel that needs retries is read after the others rather than
+     * holding them up. Only the passes after the first wait before they
+     * start, which leaves the channels that read fine with a timestamp
+     * close to the start of the period.
+     */
     template <ThermistorPolicy Policy>
-    auto read_pin(ADS1115::ADC<Policy>& adc, uint16_t pin, Policy& policy)
-        -> uint16_t {
+    auto read_channels(ADS1115::ADC<Policy>& adc, Channels& channels,
+                       Policy& policy) -> void {
         static constexpr uint8_t MAX_TRIES = 5;
         static constexpr uint32_t RETRY_DELAY = 5;
-        uint8_t tries = 0;
-        auto result = typename ADS1115::ADC<Policy>::ReadVal();
 
-        while (true) {
-            result = adc.read(pin);
-            if (std::holds_alternative<uint16_t>(result)) {
-                return std::get<uint16_t>(result);
+        for (uint8_t tries = 1; tries <= MAX_TRIES; ++tries) {
+            bool retry = false;
+            for (uint16_t pin = 0; pin < CHANNEL_COUNT; ++pin) {
+                auto& channel = channels.at(pin);
+                if (channel.read) {
+                    continue;
+                }
+                auto result = adc.read(pin);
+                channel.timestamp = policy.get_time_ms();
+                if (std::holds_alternative<uint16_t>(result)) {
+                    channel.reading = std::get<uint16_t>(result);
+                    channel.read = true;
+                } else {
+                    channel.reading = static_cast<uint16_t>(
+                        std::get<ADS1115::Error>(result));
+                    retry = true;
+                }
+            }
+            if (!retry) {
+                return;
             }
-            if (++tries < MAX_TRIES) {
+            if (tries < MAX_TRIES) {
                 // Short delay for reliability
                 policy.sleep_ms(RETRY_DELAY);
-            } else {
-                // Retries expired
-                return static_cast<uint16_t>(std::get<ADS1115::Error>(result));
             }
         }
     }
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <vector>
+
+#include "core/task_memory.hpp"
 #include "systemwide.h"
 #include "tempdeck-gen3/errors.hpp"
+#include "test/test_backup_flash_policy.hpp"
 
-struct TestSystemPolicy {
+struct TestSystemPolicy
+    : public backup_flash_test_policy::TestBackupFlashPolicy {
     using Serial = std::array<char, SYSTEM_WIDE_SERIAL_NUMBER_LENGTH>;
     void enter_bootloader(void) { ++_bootloader_count; }
+    void system_reset(void) { ++_reset_count; }
 
     errors::ErrorCode set_serial_number(Serial ser) {
         _serial = ser;
@@ -21,7 +27,23 @@ struct TestSystemPolicy {
         return empty_serial;
     }
 
+    [[nodiscard]] auto get_task_count() const -> size_t {
+        return _stacks.size();
+    }
+
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage {
+        return _stacks.at(index);
+    }
+
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage {
+        return _ram;
+    }
+
     int _bootloader_count = 0;
+    int _reset_count = 0;
     Serial _serial = {'x'};
     bool _serial_set = false;
+    std::vector<task_memory::StackUsage> _stacks = {};
+    task_memory::RamUsage _ram = {};
 };
@@ -25,7 +25,10 @@ class TestTasks {
           _system_task(_system_queue, &_aggregator),
           _ui_task(_ui_queue, &_aggregator),
           _thermistor_task(&_aggregator),
-          _thermal_task(_thermal_queue, &_aggregator) {}
+          _thermal_task(_thermal_queue, &_aggregator),
+          _task_stats(TASK_NAMES) {
+        _comms_task.provide_task_stats(&_task_stats);
+    }
 
     Queues::HostCommsQueue _comms_queue;
     Queues::SystemQueue _system_queue;
@@ -37,6 +40,7 @@ class TestTasks {
     ui_task::UITask<TestMessageQueue> _ui_task;
     thermistor_task::ThermistorTask<TestMessageQueue> _thermistor_task;
     thermal_task::ThermalTask<TestMessageQueue> _thermal_task;
+    TaskStatsRegistry _task_stats;
 };
 
 static auto BuildTasks() -> TestTasks* { return new TestTasks(); }
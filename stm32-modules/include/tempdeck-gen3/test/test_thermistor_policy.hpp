@@ -3,10 +3,35 @@
 #include "test/test_ads1115_policy.hpp"
 
 struct TestThermistorPolicy : public ads1115_test_policy::ADS1115TestPolicy {
+    // Each conversion of the ADC takes this long, at 250 samples per second
+    static constexpr uint32_t CONVERSION_MS = 4;
+
     [[nodiscard]] auto get_time_ms() const -> uint32_t { return _time_ms; }
     auto sleep_ms(uint32_t time_ms) { _time_ms += time_ms; }
     auto get_imeas_adc_reading() -> uint32_t { return _imeas_adc_val; }
 
+    auto ads1115_wait_for_pulse(uint32_t timeout_ms) -> bool {
+        _time_ms += CONVERSION_MS;
+        return ADS1115TestPolicy::ads1115_wait_for_pulse(timeout_ms);
+    }
+
+    // Fails to read back the conversion of _failing_pin as many times as
+    // _failing_pin_reads says
+    auto ads1115_i2c_read_16(uint8_t reg) -> std::optional<uint16_t> {
+        static constexpr uint8_t CONFIG_REGISTER = 0x01;
+        static constexpr uint16_t CONFIG_MUX_SHIFT = 12;
+        static constexpr uint16_t CONFIG_PIN_MASK = 0x3;
+        auto pin =
+            (_written[CONFIG_REGISTER] >> CONFIG_MUX_SHIFT) & CONFIG_PIN_MASK;
+        if (pin == _failing_pin && _failing_pin_reads > 0) {
+            --_failing_pin_reads;
+            return std::nullopt;
+        }
+        return ADS1115TestPolicy::ads1115_i2c_read_16(reg);
+    }
+
     uint32_t _time_ms = 0;
     uint32_t _imeas_adc_val = 0;
+    uint16_t _failing_pin = 0;
+    uint32_t _failing_pin_reads = 0;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 #include "firmware/motor_hardware.h"
 #include "thermocycler-gen2/errors.hpp"
@@ -124,6 +125,17 @@ class MotorPolicy {
      * transmission failed
      */
     auto tmc2130_transmit_receive(tmc2130::MessageT& data) -> RxTxReturn;
+    /**
+     * @brief Send and receive several messages to the tmc2130 in a
+     * single DMA burst
+     *
+     * @param tx Messages to send to the TMC2130
+     * @param rx Filled with the response to each message in \c tx
+     * @return true on success, false if the transmission failed
+     */
+    auto tmc2130_transmit_receive_burst(std::span<tmc2130::MessageT> tx,
+                                        std::span<tmc2130::MessageT> rx)
+        -> bool;
     /**
      * @brief Set the enable pin for the TMC2130 to enabled or not
      *
@@ -25,9 +25,31 @@ void motor_spi_initialize(void);
  */
 bool motor_spi_sendreceive(uint8_t *in, uint8_t *out, size_t len);
 
+/**
+ * @brief Sends & receives several back-to-back frames over the SPI bus
+ * using DMA. Chip select is released and re-asserted between each frame,
+ * and the calling task only blocks once for the whole burst.
+ *
+ * @param[in] in The frames to write. Must contain \c frame_len * \c frames
+ * bytes.
+ * @param[out] out Returns the bytes read from the TMC2130, with the same
+ * layout as \c in
+ * @param[in] frame_len The length of each frame
+ * @param[in] frames The number of frames to send
+ * @return True on success, false on any error to write/read
+ */
+bool motor_spi_sendreceive_burst(uint8_t *in, uint8_t *out, size_t frame_len,
+                                 size_t frames);
+
 /** @brief This function handles SPI2 global interrupt. */
 void SPI2_IRQHandler(void);
 
+/** @brief This function handles the SPI2 RX DMA interrupt. */
+void DMA1_Channel4_IRQHandler(void);
+
+/** @brief This function handles the SPI2 TX DMA interrupt. */
+void DMA1_Channel5_IRQHandler(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
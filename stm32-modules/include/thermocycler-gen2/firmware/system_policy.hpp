@@ -2,6 +2,7 @@
 
 #include <array>
 
+#include "core/task_memory.hpp"
 #include "core/xt1511.hpp"
 #include "system_hardware.h"
 #include "system_serial_number.h"
@@ -27,6 +28,10 @@ class SystemPolicy {
     auto get_serial_number() -> std::array<char, SYSTEM_SERIAL_NUMBER_LENGTH>;
     [[nodiscard]] auto get_front_button_status() -> bool;
     auto set_front_button_led(bool set) -> void;
+    [[nodiscard]] auto get_task_count() const -> size_t;
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage;
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage;
 
     // Functions for XT1511 setting
     auto start_send(LedBuffer& buffer) -> bool;
@@ -19,4 +19,20 @@ RT get_sim_driver(int, char**);
 
 bool check_realtime_environment_variable();
 
+/**
+ * Options for running several simulated Thermocyclers in one process
+ */
+struct FarmOptions {
+    std::string socket;  // The socket URL of the first instance
+    size_t instances;
+    size_t threads;
+    bool realtime;
+    bool log_socket;
+};
+
+/**
+ * Parse the inputs to the simulator farm
+ */
+FarmOptions get_farm_options(int, char**);
+
 }  // namespace cli_parser
@@ -3,6 +3,8 @@
 #include <thread>
 
 #include "simulator/sim_driver.hpp"
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_task_stats.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "thermocycler-gen2/host_comms_task.hpp"
 #include "thermocycler-gen2/tasks.hpp"
@@ -10,8 +12,18 @@
 namespace comm_thread {
 using SimCommTask = host_comms_task::HostCommsTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build(std::shared_ptr<sim_driver::SimDriver>&&)
+auto build(std::shared_ptr<sim_driver::SimDriver>&&,
+           sim_task_stats::SharedRegistry stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimCommTask>;
+// Build for a scheduler. No thread is created, so the handle is empty.
+auto build(std::shared_ptr<sim_driver::SimDriver>&&,
+           sim_task_stats::SharedRegistry stats,
+           sim_scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimCommTask>;
 void handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
                   tasks::Tasks<SimulatorMessageQueue>& tasks);
+// Read input for tasks run by a scheduler, posting each line to it
+void handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
+                  tasks::Tasks<SimulatorMessageQueue>& tasks,
+                  sim_scheduler::Scheduler& scheduler);
 };  // namespace comm_thread
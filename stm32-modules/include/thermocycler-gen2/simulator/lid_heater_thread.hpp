@@ -3,6 +3,8 @@
 #include <thread>
 
 #include "simulator/periodic_data_thread.hpp"
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_task_stats.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "thermocycler-gen2/lid_heater_task.hpp"
 #include "thermocycler-gen2/tasks.hpp"
@@ -11,6 +13,12 @@ namespace lid_heater_thread {
 using SimLidHeaterTask = lid_heater_task::LidHeaterTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
 auto build(
-    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data)
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask>;
+// Build for a scheduler. No thread is created, so the handle is empty.
+auto build(
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats, sim_scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask>;
 };  // namespace lid_heater_thread
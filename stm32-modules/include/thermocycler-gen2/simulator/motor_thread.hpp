@@ -2,6 +2,8 @@
 #include <memory>
 #include <thread>
 
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_task_stats.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "thermocycler-gen2/motor_task.hpp"
 #include "thermocycler-gen2/tasks.hpp"
@@ -9,5 +11,10 @@
 namespace motor_thread {
 using SimMotorTask = motor_task::MotorTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
+auto build(sim_task_stats::SharedRegistry stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
+// Build for a scheduler. No thread is created, so the handle is empty.
+auto build(sim_task_stats::SharedRegistry stats,
+           sim_scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
 };  // namespace motor_thread
@@ -7,10 +7,13 @@
 
 #include <atomic>
 #include <memory>
+#include <string_view>
 #include <thread>
 #include <variant>
 
+#include "simulator/sim_scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
+#include "simulator/thermal_network.hpp"
 #include "thermocycler-gen2/tasks.hpp"
 
 namespace periodic_data_thread {
@@ -33,9 +36,36 @@ using PeriodicDataMessage = std::variant<std::monostate, HeatPadPower,
 
 using PeriodicDataQueue = SimulatorMessageQueue<PeriodicDataMessage>;
 
+/**
+ * The thermal network used unless THERMAL_NETWORK_FILE names another one.
+ * Each peltier channel matches the first-order model that the plate
+ * controller uses for feed-forward control, and pumps its heat into a
+ * shared heatsink that is cooled by the fan.
+ */
+static constexpr std::string_view DEFAULT_THERMAL_NETWORK = R"(
+node ambient capacity=1 temperature=23 fixed
+node heatsink capacity=400 temperature=23
+node plate_left capacity=10 temperature=23 power=32 source=heatsink
+node plate_center capacity=10 temperature=23 power=32 source=heatsink
+node plate_right capacity=10 temperature=23 power=32 source=heatsink
+node sample capacity=4 temperature=23
+node lid capacity=20 temperature=23 power=14.4
+link heatsink ambient 8
+link plate_left heatsink 0.015
+link plate_center heatsink 0.015
+link plate_right heatsink 0.015
+link plate_left plate_center 0.2
+link plate_center plate_right 0.2
+link sample plate_left 0.1
+link sample plate_center 0.1
+link sample plate_right 0.1
+link lid ambient 0.03
+)";
+
 class PeriodicDataThread {
   public:
-    PeriodicDataThread(bool realtime = true);
+    explicit PeriodicDataThread(thermal_network::ThermalNetwork network,
+                                bool realtime = true);
 
     // Send a message to this PeriodicDataThread
     auto send_message(PeriodicDataMessage msg) -> bool;
@@ -47,29 +77,29 @@ class PeriodicDataThread {
     // Should be initiated in its own jthread
     auto run(std::stop_token& st) -> void;
 
+    // Register with a scheduler instead of running in a thread. Temperatures
+    // are then updated on the scheduler's virtual clock.
+    auto schedule(sim_scheduler::Scheduler& scheduler) -> void;
+
     // Thread safe method to signal that lid thread processed data
     auto signal_lid_thread_ready() -> void;
     // Thread safe method to signal that lid thread processed data
     auto signal_plate_thread_ready() -> void;
 
   private:
-    // The further from room temperature an element is, the stronger
-    // the draw back to room temp will be.
-    auto ambient_temp_effect(Temperature temp, std::chrono::milliseconds delta)
-        -> double;
-    // Scale a gain constant based on the current time delta since the last
-    // reading
-    auto scaled_gain_effect(double gain, double power,
-                            std::chrono::milliseconds delta) -> double;
+    auto advance_network() -> void;
+    auto handle_messages() -> void;
     auto update_heat_pad() -> bool;
     auto update_peltiers() -> bool;
     auto run_motor() -> void;
 
     Power _heat_pad_power;
     PeltierPower _peltiers_power;
-    Temperature _lid_temp, _left_temp, _center_temp, _right_temp;
+    thermal_network::ThermalNetwork _network;
+    thermal_network::NodeIndex _lid, _left, _center, _right, _heatsink;
     uint32_t _tick_peltiers;  // Last time a peltier message was sent
     uint32_t _tick_heater;    // Last time a heater message was sent
+    uint32_t _tick_network;   // Last time the thermal network was advanced
     uint32_t _current_tick;
     PeriodicDataQueue _queue;
     tasks::Tasks<SimulatorMessageQueue>* _task_registry;
@@ -83,7 +113,14 @@ class PeriodicDataThread {
     std::atomic_bool _waiting_for_plate_thread{false};
 };
 
-auto build(bool realtime) -> std::pair<std::unique_ptr<std::jthread>,
-                                       std::shared_ptr<PeriodicDataThread>>;
+auto build(thermal_network::ThermalNetwork network, bool realtime)
+    -> std::pair<std::unique_ptr<std::jthread>,
+                 std::shared_ptr<PeriodicDataThread>>;
+
+// Build for a scheduler. No thread is created.
+auto build(thermal_network::ThermalNetwork network,
+           sim_scheduler::Scheduler& scheduler)
+    -> std::pair<std::unique_ptr<std::jthread>,
+                 std::shared_ptr<PeriodicDataThread>>;
 
 };  // namespace periodic_data_thread
@@ -0,0 +1,33 @@
+/**
+ * @file sim_task_stats.hpp
+ * @brief Times the passes of the simulated tasks, so that M990.D reports
+ * them as it does on the firmware.
+ */
+#pragma once
+
+#include <memory>
+
+#include "simulator/sim_cycle_clock.hpp"
+#include "thermocycler-gen2/task_stats_registry.hpp"
+
+namespace sim_task_stats {
+
+using SharedRegistry = std::shared_ptr<tasks::TaskStatsRegistry>;
+
+/**
+ * Run one pass of a task that has a message waiting on \c queue, timing the
+ * pass and keeping the deepest the queue has been.
+ */
+template <typename Queue, typename Pass>
+auto timed_pass(tasks::TaskStatsRegistry& registry, tasks::TaskIndex task,
+                const Queue& queue, Pass&& pass) -> void {
+    auto& stats = tasks::task_stats_for(registry, task);
+    auto clock = sim_cycle_clock::SteadyCycleClock();
+    {
+        auto measure = task_stats::Measurement(stats, clock);
+        pass();
+    }
+    stats.record_queue_depth(queue.high_water_mark());
+}
+
+}  // namespace sim_task_stats
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <map>
+#include <span>
 
 #include "core/bit_utils.hpp"
 #include "thermocycler-gen2/tmc2130.hpp"
@@ -76,6 +77,22 @@ class SimTMC2130Policy {
         return RT(ret);
     }
 
+    auto tmc2130_transmit_receive_burst(std::span<tmc2130::MessageT> tx,
+                                        std::span<tmc2130::MessageT> rx)
+        -> bool {
+        if (tx.size() != rx.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < tx.size(); ++i) {
+            auto ret = tmc2130_transmit_receive(tx[i]);
+            if (!ret.has_value()) {
+                return false;
+            }
+            rx[i] = ret.value();
+        }
+        return true;
+    }
+
     auto tmc2130_set_enable(bool enable) -> bool {
         _enable = enable;
         return true;
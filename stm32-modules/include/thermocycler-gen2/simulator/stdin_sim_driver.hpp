@@ -13,6 +13,6 @@ class StdinSimDriver : public sim_driver::SimDriver {
     StdinSimDriver();
     const std::string& get_name() const;
     void write(const std::string& message);
-    void read(tasks::Tasks<SimulatorMessageQueue>& tasks);
+    void read(sim_driver::SendToCommsFunc&& send_to_comms);
 };
 }  // namespace stdin_sim_driver
@@ -2,6 +2,8 @@
 #include <memory>
 #include <thread>
 
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_task_stats.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "thermocycler-gen2/system_task.hpp"
 #include "thermocycler-gen2/tasks.hpp"
@@ -9,5 +11,12 @@
 namespace system_thread {
 using SimSystemTask = system_task::SystemTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
+auto build(sim_task_stats::SharedRegistry stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
+// Build for a scheduler. No thread is created, so the handle is empty. The
+// serial number is read from the environment variable serial_var_name.
+auto build(sim_task_stats::SharedRegistry stats,
+           sim_scheduler::Scheduler& scheduler,
+           const char* serial_var_name = "SERIAL_NUMBER")
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
 };  // namespace system_thread
@@ -3,6 +3,8 @@
 #include <thread>
 
 #include "simulator/periodic_data_thread.hpp"
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_task_stats.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "thermocycler-gen2/tasks.hpp"
 #include "thermocycler-gen2/thermal_plate_task.hpp"
@@ -12,6 +14,12 @@ using SimThermalPlateTask =
     thermal_plate_task::ThermalPlateTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
 auto build(
-    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data)
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask>;
+// Build for a scheduler. No thread is created, so the handle is empty.
+auto build(
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats, sim_scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask>;
 };  // namespace thermal_plate_thread
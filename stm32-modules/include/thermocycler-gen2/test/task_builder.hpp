@@ -85,6 +85,8 @@ struct TaskBuilder {
 
     auto run_motor_task() -> void { motor_task.run_once(motor_policy); }
 
+    auto get_task_stats() -> tasks::TaskStatsRegistry& { return task_stats; }
+
   private:
     TaskBuilder();
     TestMessageQueue<host_comms_task::Message> host_comms_queue;
@@ -102,4 +104,5 @@ struct TaskBuilder {
     TestThermalPlatePolicy thermal_plate_policy;
     TestLidHeaterPolicy lid_heater_policy;
     TestMotorPolicy motor_policy;
+    tasks::TaskStatsRegistry task_stats;
 };
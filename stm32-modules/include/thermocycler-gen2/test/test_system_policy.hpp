@@ -1,6 +1,8 @@
 #pragma once
 #include <array>
+#include <vector>
 
+#include "core/task_memory.hpp"
 #include "systemwide.h"
 #include "test/test_xt1511_policy.hpp"
 #include "thermocycler-gen2/errors.hpp"
@@ -15,6 +17,8 @@ class TestSystemPolicy : public TestXT1511Policy<16> {
     errors::ErrorCode set_serial_number_return = errors::ErrorCode::NO_ERROR;
     bool front_button = false;
     bool front_led = false;
+    std::vector<task_memory::StackUsage> stacks = {};
+    task_memory::RamUsage ram = {};
 
   public:
     TestSystemPolicy() : TestXT1511Policy<16>(213) {}
@@ -29,8 +33,14 @@ class TestSystemPolicy : public TestXT1511Policy<16> {
     auto get_front_button_status() -> bool;
 
     auto set_front_button_led(bool set) -> void;
+    [[nodiscard]] auto get_task_count() const -> size_t;
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage;
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage;
 
     // For test integration
     auto set_front_button_status(bool set) -> void;
     auto get_front_led() -> bool;
+    auto add_task_stack(task_memory::StackUsage stack) -> void;
+    auto set_ram_usage(task_memory::RamUsage usage) -> void;
 };
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <map>
+#include <span>
 
 #include "core/bit_utils.hpp"
 #include "thermocycler-gen2/tmc2130.hpp"
@@ -74,9 +75,27 @@ class TestTMC2130Policy {
             _registers[addr] = 0x00;
         }
         _has_been_written = true;
+        ++_transactions;
         return RT(ret);
     }
 
+    auto tmc2130_transmit_receive_burst(std::span<tmc2130::MessageT> tx,
+                                        std::span<tmc2130::MessageT> rx)
+        -> bool {
+        if (tx.size() != rx.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < tx.size(); ++i) {
+            auto ret = tmc2130_transmit_receive(tx[i]);
+            if (!ret.has_value()) {
+                return false;
+            }
+            rx[i] = ret.value();
+        }
+        ++_bursts;
+        return true;
+    }
+
     auto tmc2130_set_enable(bool enable) -> bool {
         _enable = enable;
         return true;
@@ -120,6 +139,9 @@ class TestTMC2130Policy {
     auto get_tmc2130_direction() -> bool { return _direction == 1; }
     auto get_tmc2130_enabled() -> bool { return _enable; }
     auto has_been_written() -> bool { return _has_been_written; }
+    // Number of datagrams sent, including the ones in a burst
+    auto get_transaction_count() -> size_t { return _transactions; }
+    auto get_burst_count() -> size_t { return _bursts; }
 
   private:
     auto get_status() -> uint8_t { return 0x00; }
@@ -131,4 +153,6 @@ class TestTMC2130Policy {
     signed int _direction = 1;
     long _steps = 0;
     bool _has_been_written = false;
+    size_t _transactions = 0;
+    size_t _bursts = 0;
 };
@@ -10,6 +10,7 @@
 #include <cstdint>
 
 #include "core/at24c0xc.hpp"
+#include "core/kv_store.hpp"
 
 namespace eeprom {
 
@@ -25,10 +26,8 @@ namespace eeprom {
  *
  * > Plate Temp = A * (heatsink temp) + ((B + 1) * Measured Temp) + C
  *
- * One of the EEPROM pages is reserved for a flag to indicate whether
- * the values have been written. The \ref EEPROMFlag enum captures the
- * valid states of this page. The page indicates what error detection,
- * if any, is included with the EEPROM constant values.
+ * Each constant is kept separately in the EEPROM, so a constant that has
+ * never been written keeps its default value.
  *
  */
 struct OffsetConstants {
@@ -39,14 +38,32 @@ struct OffsetConstants {
     double br, cr;  // B and C for right
 };
 
+/**
+ * @brief PID constants for the peltiers, as found by autotuning. These
+ * have their own keys in the store so that they can be written
+ * independently of the offset constants.
+ */
+struct PIDConstants {
+    double kp, ki, kd;
+};
+
 /**
  * @brief Encapsulates interactions with the EEPROM on the Thermocycler
- * mainboard. Allows reading and writing the thermal offset constants.
+ * mainboard. Allows reading and writing the thermal offset constants and
+ * the peltier PID constants.
+ *
+ * The constants are kept in a \ref kv_store::KVStore at the end of the
+ * EEPROM, and read from the EEPROM only once. Boards that were calibrated
+ * before the store existed keep their offset constants one per page at the
+ * start of the EEPROM (see \ref LegacyPageMap). These are read when the
+ * store is empty and go into the store with the next write. The first record
+ * goes into the pages after the legacy ones, so the legacy constants are only
+ * overwritten once the store holds them.
  */
 template <size_t PAGES, uint8_t ADDRESS>
 class Eeprom {
   public:
-    Eeprom() : _eeprom() {}
+    Eeprom() : _store() {}
 
     /**
      * @brief Get the offset constants from the EEPROM
@@ -61,19 +78,15 @@ class Eeprom {
     template <at24c0xc::AT24C0xC_Policy Policy>
     [[nodiscard]] auto get_offset_constants(const OffsetConstants& defaults,
                                             Policy& policy) -> OffsetConstants {
+        load(policy);
         OffsetConstants ret = defaults;
-        // Read the constantsss
-        auto flag = read_const_flag(policy);
-
-        if (flag == EEPROMFlag::CONSTANTS_WRITTEN) {
-            ret.a = read_const(EEPROMPageMap::CONST_A, policy);
-            ret.bl = read_const(EEPROMPageMap::CONST_BL, policy);
-            ret.cl = read_const(EEPROMPageMap::CONST_CL, policy);
-            ret.bc = read_const(EEPROMPageMap::CONST_BC, policy);
-            ret.cc = read_const(EEPROMPageMap::CONST_CC, policy);
-            ret.br = read_const(EEPROMPageMap::CONST_BR, policy);
-            ret.cr = read_const(EEPROMPageMap::CONST_CR, policy);
-        }
+        ret.a = get(Key::CONST_A, ret.a);
+        ret.bl = get(Key::CONST_BL, ret.bl);
+        ret.cl = get(Key::CONST_CL, ret.cl);
+        ret.bc = get(Key::CONST_BC, ret.bc);
+        ret.cc = get(Key::CONST_CC, ret.cc);
+        ret.br = get(Key::CONST_BR, ret.br);
+        ret.cr = get(Key::CONST_CR, ret.cr);
         _initialized = true;
         return ret;
     }
@@ -90,54 +103,46 @@ class Eeprom {
     template <at24c0xc::AT24C0xC_Policy Policy>
     auto write_offset_constants(OffsetConstants constants, Policy& policy)
         -> bool {
-        // Write the constants
-        auto ret = _eeprom.template write_value(
-            static_cast<uint8_t>(EEPROMPageMap::CONST_A), constants.a, policy);
-        if (ret) {
-            ret = _eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_BL), constants.bl,
-                policy);
-        }
-        if (ret) {
-            ret = _eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_CL), constants.cl,
-                policy);
-        }
-        if (ret) {
-            ret = _eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_BC), constants.bc,
-                policy);
-        }
-        if (ret) {
-            ret = _eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_CC), constants.cc,
-                policy);
-        }
-        if (ret) {
-            ret = _eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_BR), constants.br,
-                policy);
-        }
-        if (ret) {
-            ret = _eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_CR), constants.cr,
-                policy);
-        }
-        if (ret) {
-            // Flag that the constants are good
-            ret = _eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_FLAG),
-                static_cast<uint32_t>(EEPROMFlag::CONSTANTS_WRITTEN), policy);
-        }
-        if (!ret) {
-            // Attempt to flag that the constants are not valid
-            static_cast<void>(_eeprom.template write_value(
-                static_cast<uint8_t>(EEPROMPageMap::CONST_FLAG),
-                static_cast<uint32_t>(EEPROMFlag::INVALID), policy));
-        }
+        load(policy);
+        set_offset_constants(constants);
+        return _store.commit(policy);
+    }
+
+    /**
+     * @brief Get the peltier PID constants from the EEPROM
+     *
+     * @tparam Policy for reading from EEPROM
+     * @param defaults PIDConstants to return if the EEPROM doesn't have
+     *                 programmed values.
+     * @param policy Instance of Policy
+     * @return PIDConstants from the EEPROM, or the defaults
+     */
+    template <at24c0xc::AT24C0xC_Policy Policy>
+    [[nodiscard]] auto get_pid_constants(const PIDConstants& defaults,
+                                         Policy& policy) -> PIDConstants {
+        load(policy);
+        PIDConstants ret = defaults;
+        ret.kp = get(Key::PID_KP, ret.kp);
+        ret.ki = get(Key::PID_KI, ret.ki);
+        ret.kd = get(Key::PID_KD, ret.kd);
         return ret;
     }
 
+    /**
+     * @brief Write new peltier PID constants to the EEPROM
+     *
+     * @tparam Policy for writing to the EEPROM
+     * @param constants PIDConstants to be written to EEPROM
+     * @param policy Instance of Policy
+     * @return True if the constants were written, false otherwise
+     */
+    template <at24c0xc::AT24C0xC_Policy Policy>
+    auto write_pid_constants(PIDConstants constants, Policy& policy) -> bool {
+        load(policy);
+        set_pid_constants(constants);
+        return _store.commit(policy);
+    }
+
     /**
      * @brief Check if the EEPROM has been read since initialization.
      *
@@ -146,34 +151,105 @@ class Eeprom {
     [[nodiscard]] auto initialized() const -> bool { return _initialized; }
 
   private:
-    // Enumeration of memory locations to be used on the EEPROM
-    enum class EEPROMPageMap : uint8_t {
+    // Keys of the values in the store
+    struct Key {
+        static constexpr size_t CONST_A = 0;
+        static constexpr size_t CONST_BL = 1;
+        static constexpr size_t CONST_CL = 2;
+        static constexpr size_t CONST_BC = 3;
+        static constexpr size_t CONST_CC = 4;
+        static constexpr size_t CONST_BR = 5;
+        static constexpr size_t CONST_CR = 6;
+        static constexpr size_t PID_KP = 7;
+        static constexpr size_t PID_KI = 8;
+        static constexpr size_t PID_KD = 9;
+        static constexpr size_t COUNT = 10;
+    };
+
+    // Enumeration of memory locations used before the store
+    enum class LegacyPageMap : uint8_t {
         CONST_BL = 0,  // Value of the B constant for the left channel
         CONST_CL = 1,  // Value of the C constant for the left channel
         // Flag indicating whether constants have been written.
-        // See \ref EEPROMFlag
+        // See \ref LegacyFlag
         CONST_FLAG = 2,
         CONST_A = 3,   // Value of the A constant
         CONST_BC = 4,  // Value of the B constant for the center channel
         CONST_CC = 5,  // Value of the C constant for the center channel
         CONST_BR = 6,  // Value of the B constant for the right channel
         CONST_CR = 7,  // Value of the C constant for the right channel
+        COUNT = 8
     };
 
-    // Enumeration of the EEPROM_CONST_FLAG values
-    enum class EEPROMFlag {
+    // Enumeration of the legacy flag values
+    enum class LegacyFlag {
         CONSTANTS_WRITTEN = 3,  // Values of all constants are written (7 total)
         INVALID = 0xFF          // No values are written
     };
 
-    static_assert(sizeof(EEPROMPageMap) == sizeof(uint8_t),
+    static_assert(sizeof(LegacyPageMap) == sizeof(uint8_t),
                   "EEPROM API requires uint8_t page address");
 
-    /** Default value for all constants.*/
-    static constexpr double OFFSET_DEFAULT_CONST = 0.0F;
+    // Two records, after the legacy offset constants
+    static constexpr uint8_t STORE_PAGES = 22;
+    static constexpr uint8_t STORE_FIRST_PAGE =
+        static_cast<uint8_t>(PAGES - STORE_PAGES);
+
+    using Store =
+        kv_store::KVStore<at24c0xc::AT24C0xC<PAGES, ADDRESS>,
+                          at24c0xc::PAGE_LENGTH, STORE_FIRST_PAGE, STORE_PAGES,
+                          Key::COUNT>;
+
+    static_assert(Store::slot_page(0) >=
+                      static_cast<uint8_t>(LegacyPageMap::COUNT),
+                  "The first record must not overwrite the legacy constants");
+
+    [[nodiscard]] auto get(size_t key, double fallback) const -> double {
+        return _store.template get<double>(key).value_or(fallback);
+    }
+
+    auto set_offset_constants(const OffsetConstants& constants) -> void {
+        _store.set(Key::CONST_A, constants.a);
+        _store.set(Key::CONST_BL, constants.bl);
+        _store.set(Key::CONST_CL, constants.cl);
+        _store.set(Key::CONST_BC, constants.bc);
+        _store.set(Key::CONST_CC, constants.cc);
+        _store.set(Key::CONST_BR, constants.br);
+        _store.set(Key::CONST_CR, constants.cr);
+    }
+
+    auto set_pid_constants(const PIDConstants& constants) -> void {
+        _store.set(Key::PID_KP, constants.kp);
+        _store.set(Key::PID_KI, constants.ki);
+        _store.set(Key::PID_KD, constants.kd);
+    }
 
     /**
-     * @brief Read one of the constants on the device
+     * @brief Cache the store, or the legacy offset constants if the store
+     * is empty.
+     */
+    template <at24c0xc::AT24C0xC_Policy Policy>
+    auto load(Policy& policy) -> void {
+        if (_store.loaded()) {
+            return;
+        }
+        if (!_store.load(policy) || !_store.empty()) {
+            return;
+        }
+        if (read_legacy_flag(LegacyPageMap::CONST_FLAG, policy)) {
+            set_offset_constants(OffsetConstants{
+                .a = read_legacy(LegacyPageMap::CONST_A, policy),
+                .bl = read_legacy(LegacyPageMap::CONST_BL, policy),
+                .cl = read_legacy(LegacyPageMap::CONST_CL, policy),
+                .bc = read_legacy(LegacyPageMap::CONST_BC, policy),
+                .cc = read_legacy(LegacyPageMap::CONST_CC, policy),
+                .br = read_legacy(LegacyPageMap::CONST_BR, policy),
+                .cr = read_legacy(LegacyPageMap::CONST_CR, policy)});
+        }
+    }
+
+    /**
+     * @brief Read one of the legacy constants on the device
      *
      * @tparam Policy class for reading from the eeprom
      * @param page Which page to read. Must be a valid page
@@ -181,42 +257,37 @@ class Eeprom {
      * @return double containing the constant
      */
     template <at24c0xc::AT24C0xC_Policy Policy>
-    [[nodiscard]] auto read_const(EEPROMPageMap page, Policy& policy)
+    [[nodiscard]] auto read_legacy(LegacyPageMap page, Policy& policy)
         -> double {
-        if (page != EEPROMPageMap::CONST_FLAG) {
-            auto val = _eeprom.template read_value<double>(
-                static_cast<uint8_t>(page), policy);
-            if (val.has_value()) {
-                return val.value();
-            }
-        }
-        return OFFSET_DEFAULT_CONST;
+        auto val = _store.device().template read_value<double>(
+            static_cast<uint8_t>(page), policy);
+        return val.value_or(OFFSET_DEFAULT_CONST);
     }
 
     /**
-     * @brief Read the Constants Flag in the EEPROM. This flag provides the
-     * validity of the constants in memory.
+     * @brief Read the legacy flag, which gives the validity of the offset
+     * constants.
      *
      * @tparam Policy class for reading from the eeprom
+     * @param page Which flag page to read
      * @param policy Instance of Policy for reading
-     * @return EEPROMFlag containing the state of the constants in EEPROM
+     * @return true if the constants were written
      */
     template <at24c0xc::AT24C0xC_Policy Policy>
-    [[nodiscard]] auto read_const_flag(Policy& policy) -> EEPROMFlag {
-        auto val = _eeprom.template read_value<uint32_t>(
-            static_cast<uint8_t>(EEPROMPageMap::CONST_FLAG), policy);
-        if (val.has_value()) {
-            auto flag = val.value();
-            if (flag == static_cast<uint32_t>(EEPROMFlag::CONSTANTS_WRITTEN)) {
-                return EEPROMFlag::CONSTANTS_WRITTEN;
-            }
-        }
-        // Default
-        return EEPROMFlag::INVALID;
+    [[nodiscard]] auto read_legacy_flag(LegacyPageMap page, Policy& policy)
+        -> bool {
+        auto val = _store.device().template read_value<uint32_t>(
+            static_cast<uint8_t>(page), policy);
+        return val.has_value() &&
+               val.value() ==
+                   static_cast<uint32_t>(LegacyFlag::CONSTANTS_WRITTEN);
     }
 
-    // Handle for the actual EEPROM IC
-    at24c0xc::AT24C0xC<PAGES, ADDRESS> _eeprom;
+    /** Default value for all constants.*/
+    static constexpr double OFFSET_DEFAULT_CONST = 0.0F;
+
+    // The constants, kept in the EEPROM IC
+    Store _store;
     // Whether the constants have been read from the EEPROM since startup.
     // Even if the EEPROM is empty, this flag is set after attempting
     // to read so that the firmware doesn't try to keep making redundant
@@ -52,6 +52,9 @@ enum class ErrorCode {
     THERMAL_CONSTANT_OUT_OF_RANGE = 406,
     THERMAL_TARGET_BAD = 407,
     THERMAL_DRIFT = 408,
+    THERMAL_PROGRAM_STEP_INVALID = 409,
+    THERMAL_PROGRAM_EMPTY = 410,
+    THERMAL_AUTOTUNE_FAILED = 411,
     // 5xx - Mechanical subsystem errors
     LID_MOTOR_BUSY = 501,
     LID_MOTOR_FAULT = 502,
@@ -16,9 +16,12 @@
 #include <cstring>
 #include <iterator>
 #include <optional>
+#include <span>
 #include <utility>
 
 #include "core/gcode_parser.hpp"
+#include "core/pid.hpp"
+#include "core/task_memory.hpp"
 #include "core/utility.hpp"
 #include "systemwide.h"
 #include "thermocycler-gen2/errors.hpp"
@@ -1203,6 +1206,265 @@ struct DeactivatePlate {
     }
 };
 
+/**
+ * @brief SetThermalProgramStep uses M170. Stores one step of a thermal
+ * program to be run on the device. Steps must be written in order starting
+ * from index 0; writing a step discards any steps after it.
+ *
+ * M170 I<index> S<temp> [H<hold>] [R<ramp>] [V<volume>] [J<index> C<count>]
+ *
+ * - I - index of this step in the program
+ * - S - target temperature in ºC
+ * - H - hold time in seconds. 0 or absent moves on as soon as the target
+ *   temperature is reached.
+ * - R - ramp rate in ºC/second. 0 or absent ramps as fast as possible.
+ * - V - sample volume in µL
+ * - J, C - after this step, jump back to step J another C times
+ *
+ * Example for a 30-cycle PCR stage: M170 I3 S72 H30 J1 C29\n
+ */
+struct SetThermalProgramStep {
+    using ParseResult = std::optional<SetThermalProgramStep>;
+    static constexpr auto prefix = std::array{'M', '1', '7', '0'};
+    static constexpr const char* response = "M170 OK\n";
+
+    struct IndexArg {
+        static constexpr auto prefix = std::array{'I'};
+        static constexpr bool required = true;
+        bool present = false;
+        uint16_t value = 0;
+    };
+    struct TempArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = true;
+        bool present = false;
+        float value = 0;
+    };
+    struct HoldArg {
+        static constexpr auto prefix = std::array{'H'};
+        static constexpr bool required = false;
+        bool present = false;
+        float value = 0;
+    };
+    struct RampArg {
+        static constexpr auto prefix = std::array{'R'};
+        static constexpr bool required = false;
+        bool present = false;
+        float value = 0;
+    };
+    struct VolumeArg {
+        static constexpr auto prefix = std::array{'V'};
+        static constexpr bool required = false;
+        bool present = false;
+        float value = 0;
+    };
+    struct LoopToArg {
+        static constexpr auto prefix = std::array{'J'};
+        static constexpr bool required = false;
+        bool present = false;
+        uint16_t value = 0;
+    };
+    struct LoopCountArg {
+        static constexpr auto prefix = std::array{'C'};
+        static constexpr bool required = false;
+        bool present = false;
+        uint16_t value = 0;
+    };
+
+    // If no volume is specified, set to a negative number and let
+    // the rest of the firmware decide a default value
+    constexpr static double default_volume = -1.0F;
+
+    uint16_t index;
+    double temperature;
+    double hold_time;
+    double ramp_rate;
+    double volume;
+    uint16_t loop_to;
+    uint16_t loop_count;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        using Parser = gcode::SingleParser<IndexArg, TempArg, HoldArg, RampArg,
+                                           VolumeArg, LoopToArg, LoopCountArg>;
+        auto res = Parser::parse_gcode(input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto [index, temp, hold, ramp, volume, loop_to, loop_count] =
+            res.first.value();
+        // A loop needs both a destination and a count
+        if (loop_to.present != loop_count.present) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto ret = SetThermalProgramStep{
+            .index = index.value,
+            .temperature = temp.value,
+            .hold_time = hold.present ? hold.value : 0.0F,
+            .ramp_rate = ramp.present ? ramp.value : 0.0F,
+            .volume = volume.present ? volume.value : default_volume,
+            .loop_to = loop_to.value,
+            .loop_count = loop_count.value};
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+/**
+ * @brief StartThermalProgram uses M171. Starts running the thermal program
+ * uploaded with M170 from its first step. The optional L parameter sets a
+ * lid temperature to start heating to along with the program. The optional
+ * F flag adds the output of the plate thermal model (see M306) to the
+ * control of every step, which helps the plate follow ramped steps.
+ *
+ * M171 [L<lid temp>] [F]\n
+ *
+ * While the program runs, the device sends an asynchronous line each time
+ * it moves to a new step:
+ *
+ * async M171 STEP I:<step index> E:<steps run> T:<target> OK\n
+ *
+ * and one more once the last step is done, after which the plate keeps
+ * holding the temperature of the last step:
+ *
+ * async M171 DONE E:<steps run> OK\n
+ *
+ * Setting a new plate temperature or deactivating the plate stops a
+ * running program.
+ */
+struct StartThermalProgram {
+    using ParseResult = std::optional<StartThermalProgram>;
+    static constexpr auto prefix = std::array{'M', '1', '7', '1'};
+    static constexpr const char* response = "M171 OK\n";
+
+    struct LidArg {
+        static constexpr auto prefix = std::array{'L'};
+        static constexpr bool required = false;
+        bool present = false;
+        float value = 0;
+    };
+
+    struct FeedForwardArg {
+        static constexpr auto prefix = std::array{'F'};
+        static constexpr bool required = false;
+        bool present = false;
+    };
+
+    // A lid target of 0 leaves the lid heater as it is
+    constexpr static double no_lid_target = 0.0F;
+
+    double lid_target;
+    bool feed_forward;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res = gcode::SingleParser<LidArg, FeedForwardArg>::parse_gcode(
+            input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto [lid, feed_forward] = res.first.value();
+        auto ret = StartThermalProgram{
+            .lid_target = lid.present ? lid.value : no_lid_target,
+            .feed_forward = feed_forward.present};
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InLimit, InputIt>
+    static auto write_event_into(InputIt buf, InLimit limit, uint32_t step,
+                                 uint32_t executed, double target,
+                                 bool finished) -> InputIt {
+        int res = 0;
+        if (finished) {
+            res = snprintf(&*buf, (limit - buf), "async M171 DONE E:%lu OK\n",
+                           static_cast<unsigned long>(executed));
+        } else {
+            res = snprintf(&*buf, (limit - buf),
+                           "async M171 STEP I:%lu E:%lu T:%0.2f OK\n",
+                           static_cast<unsigned long>(step),
+                           static_cast<unsigned long>(executed),
+                           static_cast<float>(target));
+        }
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+};
+
+/**
+ * @brief GetThermalProgramStatus uses M172. Reports the progress of the
+ * thermal program.
+ *
+ * M172\n
+ *
+ * Returns: M172 R:<running> I:<step index> N:<step count>
+ *   E:<steps run> T:<total steps> L:<lid target> OK\n
+ *
+ * E and T count every pass through a loop, so E:T is the overall progress
+ * of the program.
+ */
+struct GetThermalProgramStatus {
+    using ParseResult = std::optional<GetThermalProgramStatus>;
+    static constexpr auto prefix = std::array{'M', '1', '7', '2'};
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetThermalProgramStatus()), working);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InLimit, InputIt>
+    static auto write_response_into(InputIt buf, InLimit limit, bool running,
+                                    uint32_t step, uint32_t step_count,
+                                    uint32_t executed, uint32_t total,
+                                    double lid_target) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "M172 R:%i I:%lu N:%lu E:%lu T:%lu L:%0.2f OK\n",
+                            running ? 1 : 0, static_cast<unsigned long>(step),
+                            static_cast<unsigned long>(step_count),
+                            static_cast<unsigned long>(executed),
+                            static_cast<unsigned long>(total),
+                            static_cast<float>(lid_target));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+};
+
 struct SetPIDConstants {
     /**
      * SetPIDConstants uses M301. It has three parameters, along with
@@ -1210,6 +1472,7 @@ struct SetPIDConstants {
      * compatability).
      *
      * M301 [S<selection>] P<proportional> I<integral> D<derivative>
+     *      [Z<zone>] [H|C]
      *
      * Selection may be:
      * - H = heater
@@ -1219,6 +1482,14 @@ struct SetPIDConstants {
      * - L = left peltier
      * - C = center peltier
      * - R = right peltier
+     *
+     * The peltiers use a gain schedule, indexed by the zone of each
+     * peltier's target and whether it is heating or cooling. Without
+     * Z, H or C the constants replace every entry and apply immediately.
+     * Otherwise, they only replace the selected entries and are used from
+     * the next target on:
+     * - Z selects one zone: 0 = cold, 1 = warm, 2 = hot
+     * - H selects only the heating gains, C only the cooling gains
      */
     using ParseResult = std::optional<SetPIDConstants>;
     static constexpr auto prefix = std::array{'M', '3', '0', '1'};
@@ -1227,12 +1498,17 @@ struct SetPIDConstants {
     static constexpr auto prefix_p = std::array{' ', 'P'};
     static constexpr auto prefix_i = std::array{' ', 'I'};
     static constexpr auto prefix_d = std::array{' ', 'D'};
+    static constexpr auto prefix_zone = std::array{' ', 'Z'};
+    static constexpr auto prefix_heating = std::array{' ', 'H'};
+    static constexpr auto prefix_cooling = std::array{' ', 'C'};
     static constexpr const char* response = "M301 OK\n";
 
     PidSelection selection;
     double const_p;
     double const_i;
     double const_d;
+    std::optional<size_t> zone = std::nullopt;
+    std::optional<PIDDirection> direction = std::nullopt;
 
     template <typename InputIt, typename InLimit>
     requires std::forward_iterator<InputIt> &&
@@ -1307,15 +1583,232 @@ struct SetPIDConstants {
         }
         working = d.second;
 
+        std::optional<size_t> zone = std::nullopt;
+        old_working = working;
+        working = prefix_matches(old_working, limit, prefix_zone);
+        if (working != old_working) {
+            auto z = parse_value<int>(working, limit);
+            if (!z.first.has_value() || z.first.value() < 0) {
+                return std::make_pair(ParseResult(), input);
+            }
+            zone = static_cast<size_t>(z.first.value());
+            working = z.second;
+        }
+
+        std::optional<PIDDirection> direction = std::nullopt;
+        old_working = working;
+        working = prefix_matches(old_working, limit, prefix_heating);
+        if (working != old_working) {
+            direction = PIDDirection::HEATING;
+        } else {
+            working = prefix_matches(old_working, limit, prefix_cooling);
+            if (working != old_working) {
+                direction = PIDDirection::COOLING;
+            }
+        }
+
+        // Only the peltiers have a gain schedule
+        if ((zone.has_value() || direction.has_value()) &&
+            selection_val != PidSelection::PELTIERS) {
+            return std::make_pair(ParseResult(), input);
+        }
+
         return std::make_pair(
             ParseResult(SetPIDConstants{.selection = selection_val,
                                         .const_p = p.first.value(),
                                         .const_i = i.first.value(),
-                                        .const_d = d.first.value()}),
+                                        .const_d = d.first.value(),
+                                        .zone = zone,
+                                        .direction = direction}),
             working);
     }
 };
 
+/**
+ * @brief SetPlateModel uses M306. Sets the parameters of the first-order
+ * thermal model of a plate channel, which is used for feed-forward control
+ * of thermal programs started with M171 F.
+ *
+ * M306 G<gain> L<loss>\n
+ *
+ * - G is the rate of temperature change at full peltier power, in ºC/s
+ * - L is the inverse of the time constant of the plate relaxing to the
+ *   heatsink temperature, in 1/s
+ *
+ * scripts/step_response.py can identify both from a step response.
+ */
+struct SetPlateModel {
+    using ParseResult = std::optional<SetPlateModel>;
+    static constexpr auto prefix = std::array{'M', '3', '0', '6'};
+    static constexpr const char* response = "M306 OK\n";
+
+    struct GainArg {
+        static constexpr auto prefix = std::array{'G'};
+        static constexpr bool required = true;
+        bool present = false;
+        float value = 0;
+    };
+
+    struct LossArg {
+        static constexpr auto prefix = std::array{'L'};
+        static constexpr bool required = true;
+        bool present = false;
+        float value = 0;
+    };
+
+    double gain;
+    double loss;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res = gcode::SingleParser<GainArg, LossArg>::parse_gcode(
+            input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto [gain, loss] = res.first.value();
+        auto ret = SetPlateModel{.gain = gain.value, .loss = loss.value};
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+/**
+ * @brief StartPlateAutotune uses M303. Runs a relay-feedback autotune of the
+ * peltier PID constants around a target temperature, which takes several
+ * minutes. The plate must not be controlling a temperature.
+ *
+ * M303 S<target> [C<cycles>] [W] [H]\n
+ *
+ * - S is the temperature to oscillate the plate around
+ * - C is the number of oscillations to average over, after a first one that
+ *   is discarded
+ * - W writes the new constants to the EEPROM so they are used after a
+ *   restart
+ * - H tunes the lid heater instead of the peltiers. The lid heater
+ *   constants are not stored in the EEPROM, so H can't be used with W.
+ *
+ * The new constants replace the current peltier constants (see M301) as soon
+ * as tuning finishes, and are reported with an asynchronous line:
+ *
+ * async M303 DONE P:<kp> I:<ki> D:<kd> OK\n
+ *
+ * or, for the lid heater:
+ *
+ * async M303 H DONE P:<kp> I:<ki> D:<kd> OK\n
+ *
+ * If the element does not settle into an oscillation, ERR411 is sent
+ * asynchronously instead. Setting a temperature or deactivating the element
+ * that is being tuned cancels tuning.
+ */
+struct StartPlateAutotune {
+    using ParseResult = std::optional<StartPlateAutotune>;
+    static constexpr auto prefix = std::array{'M', '3', '0', '3'};
+    static constexpr const char* response = "M303 OK\n";
+
+    struct TargetArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = true;
+        bool present = false;
+        float value = 0;
+    };
+
+    struct CyclesArg {
+        static constexpr auto prefix = std::array{'C'};
+        static constexpr bool required = false;
+        bool present = false;
+        int value = 0;
+    };
+
+    struct SaveArg {
+        static constexpr auto prefix = std::array{'W'};
+        static constexpr bool required = false;
+        bool present = false;
+    };
+
+    struct LidArg {
+        static constexpr auto prefix = std::array{'H'};
+        static constexpr bool required = false;
+        bool present = false;
+    };
+
+    constexpr static int default_cycles = 4;
+
+    double target;
+    int cycles;
+    bool save;
+    bool lid;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        using Parser =
+            gcode::SingleParser<TargetArg, CyclesArg, SaveArg, LidArg>;
+        auto res = Parser::parse_gcode(input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto [target, cycles, save, lid] = res.first.value();
+        if (save.present && lid.present) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto ret = StartPlateAutotune{
+            .target = target.value,
+            .cycles = cycles.present ? cycles.value : default_cycles,
+            .save = save.present,
+            .lid = lid.present};
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InLimit, InputIt>
+    static auto write_event_into(InputIt buf, InLimit limit, double kp,
+                                 double ki, double kd) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "async M303 DONE P:%0.4f I:%0.4f D:%0.4f OK\n",
+                            static_cast<float>(kp), static_cast<float>(ki),
+                            static_cast<float>(kd));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InLimit, InputIt>
+    static auto write_lid_event_into(InputIt buf, InLimit limit, double kp,
+                                     double ki, double kd) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "async M303 H DONE P:%0.4f I:%0.4f D:%0.4f OK\n",
+                            static_cast<float>(kp), static_cast<float>(ki),
+                            static_cast<float>(kd));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+};
+
 /**
  * Uses M116, as defined on Gen 1 thermocyclers.
  *
@@ -1788,4 +2281,241 @@ struct SetLightsDebug {
     }
 };
 
+/**
+ * @brief GetSealStallGuardLog dumps the StallGuard telemetry captured by the
+ * motor task during the most recent seal action: a single debug movement,
+ * or every seal movement of a lid open or close, including each leg of a
+ * seal homing. The position of a sample restarts at 0 with each movement.
+ * Samples are returned oldest-first, a page at a time; the host should keep
+ * requesting with an increasing start index until it has read all N
+ * samples. The log only holds the end of a long action; O is the number of
+ * earlier samples it dropped.
+ *
+ * M905.D [S<first sample index>]\n
+ *
+ * Returns: M905.D N:<total> O:<overwritten> S:<start>
+ * <position>,<sg_result>,<cs_actual>,<sg> ... OK\n
+ */
+struct GetSealStallGuardLog {
+    using ParseResult = std::optional<GetSealStallGuardLog>;
+    static constexpr auto prefix = std::array{'M', '9', '0', '5', '.', 'D'};
+
+    struct StartArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = false;
+        bool present = false;
+        uint32_t value = 0;
+    };
+
+    uint32_t start;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res =
+            gcode::SingleParser<StartArg>::parse_gcode(input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto arguments = res.first.value();
+        auto ret = GetSealStallGuardLog{.start = 0};
+        if (std::get<0>(arguments).present) {
+            ret.start = std::get<0>(arguments).value;
+        }
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(
+        InputIt buf, InLimit limit, uint32_t total, uint32_t overwritten,
+        uint32_t start, std::span<const motor_util::StallGuardSample> samples)
+        -> InputIt {
+        // Each chunk is clamped to the space remaining so a short buffer
+        // is filled up to its limit rather than overrun
+        auto advance = [&buf, &limit](int res) -> bool {
+            if (res <= 0) {
+                return false;
+            }
+            buf += std::min(static_cast<decltype(limit - buf)>(res),
+                            (limit - buf));
+            return buf < limit;
+        };
+        if (!advance(snprintf(&*buf, (limit - buf), "M905.D N:%lu O:%lu S:%lu",
+                              static_cast<unsigned long>(total),
+                              static_cast<unsigned long>(overwritten),
+                              static_cast<unsigned long>(start)))) {
+            return buf;
+        }
+        for (const auto& sample : samples) {
+            if (!advance(snprintf(
+                    &*buf, (limit - buf), " %lu,%u,%u,%u",
+                    static_cast<unsigned long>(sample.position),
+                    static_cast<unsigned int>(sample.sg_result),
+                    static_cast<unsigned int>(sample.cs_actual),
+                    static_cast<unsigned int>(sample.stallguard)))) {
+                return buf;
+            }
+        }
+        return write_string_to_iterpair(buf, limit, " OK\n");
+    }
+};
+
+/**
+ * @brief GetTaskMemory reports how much memory the firmware is using: the
+ * static RAM and C heap, and then, a page at a time, the stack of every
+ * statically allocated task. For each task, the size of its stack and the
+ * least free space it has had are given in stack words. The host should
+ * keep requesting with an increasing start index until it has read all N
+ * tasks.
+ *
+ * M906.D [S<first task index>]\n
+ *
+ * Returns: M906.D N:<total> S:<start> D:<data bytes> B:<bss bytes>
+ * H:<heap peak bytes>/<heap used bytes> <name>:<size>/<min free> ... OK\n
+ */
+struct GetTaskMemory {
+    using ParseResult = std::optional<GetTaskMemory>;
+    static constexpr auto prefix = std::array{'M', '9', '0', '6', '.', 'D'};
+
+    struct StartArg {
+        static constexpr auto prefix = std::array{'S'};
+        static constexpr bool required = false;
+        bool present = false;
+        uint32_t value = 0;
+    };
+
+    uint32_t start;
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto res =
+            gcode::SingleParser<StartArg>::parse_gcode(input, limit, prefix);
+        if (!res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto arguments = res.first.value();
+        auto ret = GetTaskMemory{.start = 0};
+        if (std::get<0>(arguments).present) {
+            ret.start = std::get<0>(arguments).value;
+        }
+        return std::make_pair(ret, res.second);
+    }
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(
+        InputIt buf, InLimit limit, uint32_t total, uint32_t start,
+        const task_memory::RamUsage& ram,
+        std::span<const task_memory::StackUsage> stacks) -> InputIt {
+        // Each chunk is clamped to the space remaining so a short buffer
+        // is filled up to its limit rather than overrun
+        auto advance = [&buf, &limit](int res) -> bool {
+            if (res <= 0) {
+                return false;
+            }
+            buf += std::min(static_cast<decltype(limit - buf)>(res),
+                            (limit - buf));
+            return buf < limit;
+        };
+        if (!advance(snprintf(&*buf, (limit - buf),
+                              "M906.D N:%lu S:%lu D:%lu B:%lu H:%lu/%lu",
+                              static_cast<unsigned long>(total),
+                              static_cast<unsigned long>(start),
+                              static_cast<unsigned long>(ram.data_bytes),
+                              static_cast<unsigned long>(ram.bss_bytes),
+                              static_cast<unsigned long>(ram.heap_peak_bytes),
+                              static_cast<unsigned long>(
+                                  ram.heap_used_bytes)))) {
+            return buf;
+        }
+        for (const auto& stack : stacks) {
+            if (!advance(snprintf(
+                    &*buf, (limit - buf), " %s:%lu/%lu", stack.name,
+                    static_cast<unsigned long>(stack.size_words),
+                    static_cast<unsigned long>(stack.min_free_words)))) {
+                return buf;
+            }
+        }
+        return write_string_to_iterpair(buf, limit, " OK\n");
+    }
+};
+
+/**
+ * @brief GetTaskStats dumps the runtime stats of every task: how many
+ * passes its handler has made, the min, average and max time of one pass,
+ * the deepest its queue has been and a histogram of the pass times. Each
+ * histogram bucket covers four times the range of the one before, starting
+ * with under 16us. The periodic thermistor tasks also report their period
+ * and the average and max jitter of their wakeups. All times are in
+ * microseconds.
+ *
+ * M990.D\n
+ *
+ * Returns: M990.D <task>:N=<passes>,MIN=<us>,AVG=<us>,MAX=<us>,Q=<depth>,
+ * H=<bucket>/<bucket>/...[,P=<period>,J=<avg jitter>/<max jitter>] ... OK\n
+ */
+struct GetTaskStats {
+    using ParseResult = std::optional<GetTaskStats>;
+    static constexpr auto prefix = std::array{'M', '9', '9', '0', '.', 'D'};
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetTaskStats()), working);
+    }
+
+    template <typename InputIt, typename InLimit, typename Registry>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit,
+                                    const Registry& registry) -> InputIt {
+        auto write = [&buf, limit](const char* format, auto... args) {
+            if (buf >= limit) {
+                return;
+            }
+            auto res = snprintf(&*buf, (limit - buf), format, args...);
+            if (res > 0) {
+                buf += std::min(static_cast<decltype(limit - buf)>(res),
+                                (limit - buf));
+            }
+        };
+        buf = write_string_to_iterpair(buf, limit, "M990.D");
+        for (const auto& task : registry) {
+            const auto& handler = task.handler();
+            write(" %s:N=%lu,MIN=%lu,AVG=%lu,MAX=%lu,Q=%lu,H=", task.name(),
+                  static_cast<unsigned long>(handler.count()),
+                  static_cast<unsigned long>(handler.min()),
+                  static_cast<unsigned long>(handler.average()),
+                  static_cast<unsigned long>(handler.max()),
+                  static_cast<unsigned long>(task.queue_high_water()));
+            const char* separator = "";
+            for (auto bucket : handler.histogram()) {
+                write("%s%lu", separator, static_cast<unsigned long>(bucket));
+                separator = "/";
+            }
+            if (task.period_us() != 0) {
+                write(",P=%lu,J=%lu/%lu",
+                      static_cast<unsigned long>(task.period_us()),
+                      static_cast<unsigned long>(task.jitter().average()),
+                      static_cast<unsigned long>(task.jitter().max()));
+            }
+        }
+        return write_string_to_iterpair(buf, limit, " OK\n");
+    }
+};
+
 }  // namespace gcode
@@ -6,6 +6,7 @@
 #include <array>
 #include <cstring>
 #include <optional>
+#include <span>
 #include <utility>
 #include <variant>
 
@@ -17,6 +18,7 @@
 #include "thermocycler-gen2/errors.hpp"
 #include "thermocycler-gen2/gcodes.hpp"
 #include "thermocycler-gen2/messages.hpp"
+#include "thermocycler-gen2/task_stats_registry.hpp"
 #include "thermocycler-gen2/tasks.hpp"
 
 namespace tasks {
@@ -52,7 +54,10 @@ class HostCommsTask {
         gcode::GetOffsetConstants, gcode::OpenLid, gcode::CloseLid,
         gcode::LiftPlate, gcode::DeactivateAll, gcode::GetBoardRevision,
         gcode::GetLidSwitches, gcode::GetFrontButton, gcode::SetLidFans,
-        gcode::SetLightsDebug>;
+        gcode::SetLightsDebug, gcode::GetSealStallGuardLog,
+        gcode::SetThermalProgramStep, gcode::StartThermalProgram,
+        gcode::GetThermalProgramStatus, gcode::SetPlateModel,
+        gcode::StartPlateAutotune, gcode::GetTaskMemory, gcode::GetTaskStats>;
     using AckOnlyCache =
         AckCache<8, gcode::EnterBootloader, gcode::SetSerialNumber,
                  gcode::ActuateSolenoid, gcode::ActuateLidStepperDebug,
@@ -62,7 +67,9 @@ class HostCommsTask {
                  gcode::SetPlateTemperature, gcode::DeactivatePlate,
                  gcode::SetFanAutomatic, gcode::SetSealParameter,
                  gcode::SetOffsetConstants, gcode::OpenLid, gcode::CloseLid,
-                 gcode::LiftPlate, gcode::SetLidFans, gcode::SetLightsDebug>;
+                 gcode::LiftPlate, gcode::SetLidFans, gcode::SetLightsDebug,
+                 gcode::SetThermalProgramStep, gcode::StartThermalProgram,
+                 gcode::SetPlateModel, gcode::StartPlateAutotune>;
     using GetSystemInfoCache = AckCache<8, gcode::GetSystemInfo>;
     using GetLidTempDebugCache = AckCache<8, gcode::GetLidTemperatureDebug>;
     using GetPlateTempDebugCache = AckCache<8, gcode::GetPlateTemperatureDebug>;
@@ -72,6 +79,10 @@ class HostCommsTask {
     using GetLidStatusCache = AckCache<8, gcode::GetLidStatus>;
     using GetOffsetConstantsCache = AckCache<8, gcode::GetOffsetConstants>;
     using SealStepperDebugCache = AckCache<8, gcode::ActuateSealStepperDebug>;
+    using GetSealStallGuardLogCache = AckCache<8, gcode::GetSealStallGuardLog>;
+    using GetTaskMemoryCache = AckCache<8, gcode::GetTaskMemory>;
+    using GetThermalProgramStatusCache =
+        AckCache<8, gcode::GetThermalProgramStatus>;
     // This is a two-stage message since both the Plate and Lid tasks have
     // to respond.
     using GetThermalPowerCache = AckCache<8, gcode::GetThermalPowerDebug,
@@ -89,6 +100,7 @@ class HostCommsTask {
     explicit HostCommsTask(Queue& q)
         : message_queue(q),
           task_registry(nullptr),
+          task_stats(nullptr),
           // These nolints are because if you don't have these inits, host
           // builds complain NOLINTNEXTLINE(readability-redundant-member-init)
           ack_only_cache(),
@@ -115,7 +127,13 @@ class HostCommsTask {
           // NOLINTNEXTLINE(readability-redundant-member-init)
           deactivate_all_cache(),
           // NOLINTNEXTLINE(readability-redundant-member-init)
-          get_switch_cache() {}
+          get_switch_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_seal_stallguard_log_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_task_memory_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_thermal_program_status_cache() {}
     HostCommsTask(const HostCommsTask& other) = delete;
     auto operator=(const HostCommsTask& other) -> HostCommsTask& = delete;
     HostCommsTask(HostCommsTask&& other) noexcept = delete;
@@ -125,6 +143,9 @@ class HostCommsTask {
     void provide_tasks(tasks::Tasks<QueueImpl>* other_tasks) {
         task_registry = other_tasks;
     }
+    void provide_task_stats(const tasks::TaskStatsRegistry* stats) {
+        task_stats = stats;
+    }
 
     /**
      * run_once() runs one spin of the task. This means it
@@ -416,6 +437,59 @@ class HostCommsTask {
             cache_entry);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(
+        const messages::GetThermalProgramStatusResponse& response,
+        InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry = get_thermal_program_status_cache.remove_if_present(
+            response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.running, response.step,
+                        response.step_count, response.executed,
+                        response.total, response.lid_target);
+                }
+            },
+            cache_entry);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::ThermalProgramStepEvent& event,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        return gcode::StartThermalProgram::write_event_into(
+            tx_into, tx_limit, event.step, event.executed, event.target,
+            event.finished);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::PlateAutotuneEvent& event,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        return gcode::StartPlateAutotune::write_event_into(
+            tx_into, tx_limit, event.kp, event.ki, event.kd);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::LidAutotuneEvent& event,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        return gcode::StartPlateAutotune::write_lid_event_into(
+            tx_into, tx_limit, event.kp, event.ki, event.kd);
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -438,6 +512,54 @@ class HostCommsTask {
             cache_entry);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::GetSealStallGuardLogResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry = get_seal_stallguard_log_cache.remove_if_present(
+            response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, &response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.total,
+                        response.overwritten, response.start,
+                        std::span(response.samples.data(), response.count));
+                }
+            },
+            cache_entry);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::GetTaskMemoryResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry =
+            get_task_memory_cache.remove_if_present(response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, &response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.total, response.start,
+                        response.ram,
+                        std::span(response.stacks.data(), response.count));
+                }
+            },
+            cache_entry);
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -1068,7 +1190,9 @@ class HostCommsTask {
                                              .selection = gcode.selection,
                                              .p = gcode.const_p,
                                              .i = gcode.const_i,
-                                             .d = gcode.const_d};
+                                             .d = gcode.const_d,
+                                             .zone = gcode.zone,
+                                             .direction = gcode.direction};
         bool ret = false;
         if (message.selection == PidSelection::HEATER) {
             ret = task_registry->lid_heater->get_message_queue().try_send(
@@ -1187,6 +1311,68 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetSealStallGuardLog& log_gcode,
+                     InputIt tx_into, InputLimit tx_limit)
+        -> std::pair<bool, InputIt> {
+        auto id = get_seal_stallguard_log_cache.add(log_gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::GetSealStallGuardLogMessage{
+            .id = id, .start = log_gcode.start};
+        if (!task_registry->motor->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_seal_stallguard_log_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetTaskMemory& memory_gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = get_task_memory_cache.add(memory_gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::GetTaskMemoryMessage{
+            .id = id, .start = memory_gcode.start};
+        if (!task_registry->system->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_task_memory_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetTaskStats& ignore, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        static_cast<void>(ignore);
+        if (task_stats == nullptr) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::UNHANDLED_GCODE));
+        }
+        return std::make_pair(true, gcode::GetTaskStats::write_response_into(
+                                        tx_into, tx_limit, *task_stats));
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -1498,6 +1684,143 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::SetThermalProgramStep& gcode,
+                     InputIt tx_into, InputLimit tx_limit)
+        -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::SetThermalProgramStepMessage{
+            .id = id,
+            .index = gcode.index,
+            .step = thermal_program::Step{.temperature = gcode.temperature,
+                                          .hold_time = gcode.hold_time,
+                                          .ramp_rate = gcode.ramp_rate,
+                                          .volume = gcode.volume,
+                                          .loop_to = gcode.loop_to,
+                                          .loop_count = gcode.loop_count}};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::StartThermalProgram& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::StartThermalProgramMessage{
+            .id = id,
+            .lid_target = gcode.lid_target,
+            .feed_forward = gcode.feed_forward};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetThermalProgramStatus& gcode,
+                     InputIt tx_into, InputLimit tx_limit)
+        -> std::pair<bool, InputIt> {
+        auto id = get_thermal_program_status_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::GetThermalProgramStatusMessage{.id = id};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_thermal_program_status_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::SetPlateModel& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        auto message = messages::SetPlateModelMessage{
+            .id = id, .gain = gcode.gain, .loss = gcode.loss};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::StartPlateAutotune& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+        bool sent = false;
+        if (gcode.lid) {
+            auto message = messages::StartLidAutotuneMessage{
+                .id = id, .target = gcode.target, .cycles = gcode.cycles};
+            sent = task_registry->lid_heater->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND);
+        } else {
+            auto message = messages::StartPlateAutotuneMessage{
+                .id = id,
+                .target = gcode.target,
+                .cycles = gcode.cycles,
+                .save = gcode.save};
+            sent = task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND);
+        }
+        if (!sent) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+        return std::make_pair(true, tx_into);
+    }
+
     // Our error handler just writes an error and bails
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
@@ -1512,6 +1835,7 @@ class HostCommsTask {
 
     Queue& message_queue;
     tasks::Tasks<QueueImpl>* task_registry;
+    const tasks::TaskStatsRegistry* task_stats;
     AckOnlyCache ack_only_cache;
     GetSystemInfoCache get_system_info_cache;
     GetLidTempDebugCache get_lid_temp_debug_cache;
@@ -1525,6 +1849,9 @@ class HostCommsTask {
     GetThermalPowerCache get_thermal_power_cache;
     DeactivateAllCache deactivate_all_cache;
     GetSwitchCache get_switch_cache;
+    GetSealStallGuardLogCache get_seal_stallguard_log_cache;
+    GetTaskMemoryCache get_task_memory_cache;
+    GetThermalProgramStatusCache get_thermal_program_status_cache;
     bool may_connect_latch = true;
 };
 
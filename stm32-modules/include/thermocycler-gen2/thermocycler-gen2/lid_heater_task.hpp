@@ -10,6 +10,7 @@
 #include <variant>
 
 #include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
 #include "core/thermistor_conversion.hpp"
 #include "hal/message_queue.hpp"
 #include "thermistor_lookups.hpp"
@@ -47,7 +48,8 @@ struct State {
         IDLE,        /**< Not doing anything.*/
         ERROR,       /**< Experiencing an error.*/
         CONTROLLING, /**< Controlling temperature (PID).*/
-        HEATER_TEST  /**< Testing PWM output (debug command).*/
+        HEATER_TEST, /**< Testing PWM output (debug command).*/
+        AUTOTUNING   /**< Tuning the PID constants with a relay.*/
     };
     Status system_status;
     uint16_t error_bitmap;
@@ -80,6 +82,15 @@ class LidHeaterTask {
     static constexpr double KD_MIN = -200;
     static constexpr double KD_MAX = 200;
     static constexpr double OVERTEMP_LIMIT_C = 115;
+    // The heater can't cool, so the autotune relay switches it fully on and
+    // off and the lid cools passively between pulses
+    static constexpr double AUTOTUNE_RELAY_POWER = 1.0F;
+    // Band around the autotune target before the relay switches, in ºC
+    static constexpr double AUTOTUNE_HYSTERESIS = 0.5F;
+    // The lid cools slowly, so each oscillation takes a while
+    static constexpr double AUTOTUNE_TIMEOUT_SECONDS = 1800.0F;
+    static constexpr double AUTOTUNE_TARGET_MIN = 30.0F;
+    static constexpr double AUTOTUNE_TARGET_MAX = 110.0F;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     static constexpr const double CONTROL_PERIOD_SECONDS =
         CONTROL_PERIOD_TICKS * 0.001;
@@ -100,7 +111,8 @@ class LidHeaterTask {
           _pid(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, CONTROL_PERIOD_SECONDS, 1.0,
                -1.0),
           _setpoint_c(0.0F),
-          _last_update(0) {}
+          _last_update(0),
+          _autotune() {}
     LidHeaterTask(const LidHeaterTask& other) = delete;
     auto operator=(const LidHeaterTask& other) -> LidHeaterTask& = delete;
     LidHeaterTask(LidHeaterTask&& other) noexcept = delete;
@@ -168,6 +180,7 @@ class LidHeaterTask {
                 // We entered an error state. Disable power output.
                 _state.system_status = State::ERROR;
                 policy.set_heater_power(0.0F);
+                _autotune.stop();
             } else {
                 // We went from an error state to no error state... so go idle
                 _state.system_status = State::IDLE;
@@ -188,6 +201,14 @@ class LidHeaterTask {
                 _state.system_status = State::ERROR;
                 _state.error_bitmap |= State::HEATER_POWER_ERROR;
             }
+        } else if (_state.system_status == State::AUTOTUNING) {
+            auto time_delta = current_time - _last_update;
+            if (time_delta.count() < 0) {
+                time_delta += time_overflow_amount;
+            }
+            update_autotune(
+                policy,
+                std::chrono::duration_cast<Seconds>(time_delta).count());
         } else if (_state.system_status != State::HEATER_TEST) {
             policy.set_heater_power(0.0F);
         }
@@ -238,7 +259,8 @@ class LidHeaterTask {
                 _task_registry->comms->get_message_queue().try_send(response));
             return;
         }
-        if (_state.system_status == State::CONTROLLING) {
+        if (_state.system_status == State::CONTROLLING ||
+            _state.system_status == State::AUTOTUNING) {
             // Send busy error
             response.with_error = errors::ErrorCode::THERMAL_LID_BUSY;
             static_cast<void>(
@@ -264,10 +286,17 @@ class LidHeaterTask {
                        Policy& policy) -> void {
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        // A thermal program starting the lid isn't waiting on a response
+        auto acknowledge = [this, &msg, &response]() {
+            if (!msg.from_program) {
+                static_cast<void>(
+                    _task_registry->comms->get_message_queue().try_send(
+                        response));
+            }
+        };
         if (_state.system_status == State::ERROR) {
             response.with_error = most_relevant_error();
-            static_cast<void>(
-                _task_registry->comms->get_message_queue().try_send(response));
+            acknowledge();
             return;
         }
         if (_state.system_status == State::HEATER_TEST) {
@@ -276,13 +305,13 @@ class LidHeaterTask {
                 response.with_error = errors::ErrorCode::THERMAL_HEATER_ERROR;
                 _state.system_status = State::ERROR;
                 _state.error_bitmap |= State::HEATER_POWER_ERROR;
-                static_cast<void>(
-                    _task_registry->comms->get_message_queue().try_send(
-                        response));
+                acknowledge();
                 return;
             }
         }
 
+        // A manual target replaces any running autotune
+        _autotune.stop();
         if (msg.setpoint <= 0.0F) {
             _setpoint_c = 0.0F;
             _state.system_status = State::IDLE;
@@ -292,8 +321,7 @@ class LidHeaterTask {
             _pid.reset();
         }
 
-        static_cast<void>(
-            _task_registry->comms->get_message_queue().try_send(response));
+        acknowledge();
     }
 
     template <LidHeaterExecutionPolicy Policy>
@@ -312,6 +340,7 @@ class LidHeaterTask {
 
         auto ret = policy.set_heater_power(0.0F);
         _state.system_status = State::IDLE;
+        _autotune.stop();
 
         if (!ret) {
             response.with_error = errors::ErrorCode::THERMAL_HEATER_ERROR;
@@ -335,6 +364,7 @@ class LidHeaterTask {
             messages::DeactivateAllResponse{.responding_to_id = msg.id};
 
         static_cast<void>(policy.set_heater_power(0.0F));
+        _autotune.stop();
         if (_state.system_status != State::ERROR) {
             _state.system_status = State::IDLE;
         }
@@ -350,7 +380,8 @@ class LidHeaterTask {
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
 
-        if (_state.system_status == State::CONTROLLING) {
+        if (_state.system_status == State::CONTROLLING ||
+            _state.system_status == State::AUTOTUNING) {
             response.with_error = errors::ErrorCode::THERMAL_LID_BUSY;
             static_cast<void>(
                 _task_registry->comms->get_message_queue().try_send(response));
@@ -370,6 +401,45 @@ class LidHeaterTask {
             _task_registry->comms->get_message_queue().try_send(response));
     }
 
+    template <LidHeaterExecutionPolicy Policy>
+    auto visit_message(const messages::StartLidAutotuneMessage& msg,
+                       Policy& policy) -> void {
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        auto config = relay_autotune::Config{
+            .setpoint = msg.target,
+            .output_high = AUTOTUNE_RELAY_POWER,
+            .output_low = 0.0F,
+            .hysteresis = AUTOTUNE_HYSTERESIS,
+            .cycles = static_cast<uint8_t>(std::clamp(
+                msg.cycles, 0,
+                static_cast<int>(relay_autotune::RelayAutotune::MAX_CYCLES))),
+            .timeout = AUTOTUNE_TIMEOUT_SECONDS};
+
+        if (_state.system_status == State::ERROR) {
+            response.with_error = most_relevant_error();
+        } else if (_state.system_status == State::CONTROLLING ||
+                   _state.system_status == State::AUTOTUNING) {
+            response.with_error = errors::ErrorCode::THERMAL_LID_BUSY;
+        } else if ((msg.target < AUTOTUNE_TARGET_MIN) ||
+                   (msg.target > AUTOTUNE_TARGET_MAX)) {
+            response.with_error = errors::ErrorCode::THERMAL_TARGET_BAD;
+        } else if (msg.cycles != config.cycles ||
+                   !relay_autotune::RelayAutotune::valid(config)) {
+            response.with_error =
+                errors::ErrorCode::THERMAL_CONSTANT_OUT_OF_RANGE;
+        } else if (!policy.set_heater_power(0.0F)) {
+            response.with_error = errors::ErrorCode::THERMAL_HEATER_ERROR;
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::HEATER_POWER_ERROR;
+        } else {
+            static_cast<void>(_autotune.start(config));
+            _state.system_status = State::AUTOTUNING;
+        }
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
     template <LidHeaterExecutionPolicy Policy>
     auto visit_message(const messages::GetThermalPowerMessage& msg,
                        Policy& policy) -> void {
@@ -459,6 +529,53 @@ class LidHeaterTask {
         return errors::ErrorCode::NO_ERROR;
     }
 
+    /**
+     * @brief Drive the heater from the relay autotuner. Call this when the
+     * state is AUTOTUNING and a new temperature has been stored in the
+     * thermistor handle. Once the autotuner stops, the heater is turned off
+     * and the result is applied and reported.
+     */
+    template <LidHeaterExecutionPolicy Policy>
+    auto update_autotune(Policy& policy, double time_delta) -> void {
+        auto power = _autotune.update(_thermistor.temp_c, time_delta);
+        if (!_autotune.running()) {
+            finish_autotune(policy);
+            return;
+        }
+        if (!policy.set_heater_power(power)) {
+            policy.set_heater_power(0.0F);
+            _autotune.stop();
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::HEATER_POWER_ERROR;
+        }
+    }
+
+    /**
+     * @brief Turn off the heater after autotuning and either apply the new
+     * PID constants or report the failure to the host.
+     */
+    template <LidHeaterExecutionPolicy Policy>
+    auto finish_autotune(Policy& policy) -> void {
+        policy.set_heater_power(0.0F);
+        _state.system_status = State::IDLE;
+
+        auto result = _autotune.result();
+        if (!result.has_value()) {
+            auto error = messages::HostCommsMessage(messages::ErrorMessage{
+                .code = errors::ErrorCode::THERMAL_AUTOTUNE_FAILED});
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(error));
+            return;
+        }
+        auto kp = std::clamp(result.value().kp, KP_MIN, KP_MAX);
+        auto ki = std::clamp(result.value().ki, KI_MIN, KI_MAX);
+        auto kd = std::clamp(result.value().kd, KD_MIN, KD_MAX);
+        _pid = PID(kp, ki, kd, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
+        auto event = messages::LidAutotuneEvent{.kp = kp, .ki = ki, .kd = kd};
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(event));
+    }
+
     [[nodiscard]] auto update_control(double time_delta) -> double {
         auto proportional_band = 1.0;
         if (_pid.kp() != 0.0) {
@@ -483,6 +600,7 @@ class LidHeaterTask {
     PID _pid;
     double _setpoint_c;
     Milliseconds _last_update;
+    relay_autotune::RelayAutotune _autotune;
 };
 
 }  // namespace lid_heater_task
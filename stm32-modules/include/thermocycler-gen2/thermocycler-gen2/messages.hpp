@@ -2,12 +2,16 @@
 #include <array>
 #include <concepts>
 #include <cstdint>
+#include <optional>
 #include <variant>
 
+#include "core/pid.hpp"
+#include "core/task_memory.hpp"
 #include "systemwide.h"
 #include "thermocycler-gen2/colors.hpp"
 #include "thermocycler-gen2/errors.hpp"
 #include "thermocycler-gen2/motor_utils.hpp"
+#include "thermocycler-gen2/thermal_program.hpp"
 #include "thermocycler-gen2/tmc2130_registers.hpp"
 
 namespace messages {
@@ -187,6 +191,30 @@ struct GetSealDriveStatusResponse {
     tmc2130::TStep tstep;
 };
 
+struct GetSealStallGuardLogMessage {
+    uint32_t id;
+    // Index of the first sample to return, counted from the oldest sample
+    uint32_t start;
+};
+
+struct GetSealStallGuardLogResponse {
+    // Maximum number of samples that fit in a single response
+    static constexpr size_t MAX_SAMPLES = 8;
+    uint32_t responding_to_id;
+    // Total number of samples held for the most recent seal movement. The
+    // counts are narrow so the response is no bigger than the other
+    // HostCommsMessages.
+    uint16_t total;
+    // Number of valid entries in \c samples
+    uint16_t count;
+    // Index of the first sample in this response
+    uint32_t start;
+    // Number of older samples from the same movement that the log dropped
+    // to make room, so the host can tell it did not get the whole movement
+    uint32_t overwritten;
+    std::array<motor_util::StallGuardSample, MAX_SAMPLES> samples;
+};
+
 struct SetSealParameterMessage {
     uint32_t id;
     motor_util::SealStepper::Parameter param;
@@ -246,6 +274,9 @@ struct SetHeaterDebugMessage {
 struct SetLidTemperatureMessage {
     uint32_t id;
     double setpoint;
+    // Set when the plate task starts the lid as part of a thermal program;
+    // there is no host command waiting for an acknowledgement
+    bool from_program = false;
 };
 
 struct DeactivateLidHeatingMessage {
@@ -260,6 +291,41 @@ struct SetPlateTemperatureMessage {
     double volume = 0.0F;
 };
 
+struct SetThermalProgramStepMessage {
+    uint32_t id;
+    uint16_t index;
+    thermal_program::Step step;
+};
+
+struct StartThermalProgramMessage {
+    uint32_t id;
+    double lid_target;
+    bool feed_forward = false;
+};
+
+struct GetThermalProgramStatusMessage {
+    uint32_t id;
+};
+
+struct GetThermalProgramStatusResponse {
+    uint32_t responding_to_id;
+    bool running;
+    uint32_t step;
+    uint32_t step_count;
+    uint32_t executed;
+    uint32_t total;
+    double lid_target;
+};
+
+// Sent unprompted by the plate task whenever a thermal program moves to a
+// new step or finishes
+struct ThermalProgramStepEvent {
+    uint32_t step;
+    uint32_t executed;
+    double target;
+    bool finished;
+};
+
 struct SetFanAutomaticMessage {
     uint32_t id;
 };
@@ -275,6 +341,40 @@ struct SetPIDConstantsMessage {
     double p;
     double i;
     double d;
+    // Peltier gain schedule entries to update, or all of them if empty
+    std::optional<size_t> zone = std::nullopt;
+    std::optional<PIDDirection> direction = std::nullopt;
+};
+
+struct SetPlateModelMessage {
+    uint32_t id;
+    double gain;
+    double loss;
+};
+
+struct StartPlateAutotuneMessage {
+    uint32_t id;
+    double target;
+    int cycles;
+    bool save;
+};
+
+struct PlateAutotuneEvent {
+    double kp;
+    double ki;
+    double kd;
+};
+
+struct StartLidAutotuneMessage {
+    uint32_t id;
+    double target;
+    int cycles;
+};
+
+struct LidAutotuneEvent {
+    double kp;
+    double ki;
+    double kd;
 };
 
 struct SetOffsetConstantsMessage {
@@ -400,6 +500,28 @@ struct GetFrontButtonResponse {
     bool button_pressed;
 };
 
+struct GetTaskMemoryMessage {
+    uint32_t id;
+    // Index of the first task to return
+    uint32_t start;
+};
+
+struct GetTaskMemoryResponse {
+    // Maximum number of tasks that fit in a single response. Every
+    // HostCommsMessage is as big as its largest alternative, so this is
+    // kept small enough that the response is no bigger than the others.
+    static constexpr size_t MAX_TASKS = 2;
+    uint32_t responding_to_id;
+    // Total number of tasks that are tracked
+    uint32_t total;
+    // Index of the first task in this response
+    uint32_t start;
+    // Number of valid entries in \c stacks
+    uint32_t count;
+    task_memory::RamUsage ram;
+    std::array<task_memory::StackUsage, MAX_TASKS> stacks;
+};
+
 struct SetLidFansMessage {
     uint32_t id;
     bool enable;
@@ -415,7 +537,7 @@ using SystemMessage =
                    SetSerialNumberMessage, GetSystemInfoMessage,
                    UpdateUIMessage, SetLedMode, UpdateTaskErrorState,
                    UpdatePlateState, GetFrontButtonMessage, UpdateMotorState,
-                   SetLightsDebugMessage>;
+                   SetLightsDebugMessage, GetTaskMemoryMessage>;
 using HostCommsMessage = ::std::variant<
     std::monostate, IncomingMessageFromHost, AcknowledgePrevious, ErrorMessage,
     ForceUSBDisconnectMessage, GetSystemInfoResponse,
@@ -423,7 +545,10 @@ using HostCommsMessage = ::std::variant<
     GetPlateTempResponse, GetLidTempResponse, GetSealDriveStatusResponse,
     GetLidStatusResponse, GetPlatePowerResponse, GetLidPowerResponse,
     GetOffsetConstantsResponse, SealStepperDebugResponse, DeactivateAllResponse,
-    GetLidSwitchesResponse, GetFrontButtonResponse>;
+    GetLidSwitchesResponse, GetFrontButtonResponse,
+    GetSealStallGuardLogResponse, GetThermalProgramStatusResponse,
+    ThermalProgramStepEvent, PlateAutotuneEvent, LidAutotuneEvent,
+    GetTaskMemoryResponse>;
 using ThermalPlateMessage =
     ::std::variant<std::monostate, ThermalPlateTempReadComplete,
                    GetPlateTemperatureDebugMessage, SetPeltierDebugMessage,
@@ -431,16 +556,19 @@ using ThermalPlateMessage =
                    SetPlateTemperatureMessage, DeactivatePlateMessage,
                    SetPIDConstantsMessage, SetFanAutomaticMessage,
                    GetThermalPowerMessage, SetOffsetConstantsMessage,
-                   GetOffsetConstantsMessage, DeactivateAllMessage>;
+                   GetOffsetConstantsMessage, DeactivateAllMessage,
+                   SetThermalProgramStepMessage, StartThermalProgramMessage,
+                   GetThermalProgramStatusMessage, SetPlateModelMessage,
+                   StartPlateAutotuneMessage>;
 using LidHeaterMessage = ::std::variant<
     std::monostate, LidTempReadComplete, GetLidTemperatureDebugMessage,
     SetHeaterDebugMessage, GetLidTempMessage, SetLidTemperatureMessage,
     DeactivateLidHeatingMessage, SetPIDConstantsMessage, GetThermalPowerMessage,
-    DeactivateAllMessage, SetLidFansMessage>;
+    DeactivateAllMessage, SetLidFansMessage, StartLidAutotuneMessage>;
 using MotorMessage = ::std::variant<
     std::monostate, ActuateSolenoidMessage, LidStepperDebugMessage,
     LidStepperComplete, SealStepperDebugMessage, SealStepperComplete,
     GetSealDriveStatusMessage, SetSealParameterMessage, GetLidStatusMessage,
     OpenLidMessage, CloseLidMessage, PlateLiftMessage, FrontButtonPressMessage,
-    GetLidSwitchesMessage>;
+    GetLidSwitchesMessage, GetSealStallGuardLogMessage>;
 };  // namespace messages
@@ -5,11 +5,14 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <concepts>
 #include <functional>
 #include <optional>
+#include <tuple>
 #include <variant>
 
+#include "core/ring_buffer.hpp"
 #include "hal/message_queue.hpp"
 #include "thermocycler-gen2/messages.hpp"
 #include "thermocycler-gen2/motor_utils.hpp"
@@ -187,6 +190,14 @@ struct SealStepperState {
     // Stallguard min velocity value that will fully disable stallguard,
     // as a tstep value
     constexpr static uint32_t DISABLED_SG_MIN_VELOCITY = 0;
+    // Period between StallGuard telemetry samples during a movement, in
+    // RTOS ticks (milliseconds)
+    constexpr static uint32_t STALLGUARD_SAMPLE_PERIOD_TICKS = 10;
+    // Number of StallGuard telemetry samples retained. At the sample period
+    // above this covers the last 1.28 seconds of a movement.
+    constexpr static size_t STALLGUARD_LOG_LENGTH = 128;
+    static_assert(STALLGUARD_LOG_LENGTH <= UINT16_MAX,
+                  "The StallGuard log response counts samples in 16 bits");
     // Enumeration of legal stepper actions
     enum class Status { IDLE, MOVING };
     // Current status of the seal stepper. Declared atomic because
@@ -199,6 +210,50 @@ struct SealStepperState {
     // Direction of the current movement, since the steps stored in
     // the movement profile are unsigned
     bool direction;
+    // Distance covered by the current movement, copied from the movement
+    // profile by the step interrupt. The profile keeps a 64-bit count that
+    // can't be read in one access while the interrupt is updating it, so
+    // the task reads this instead.
+    std::atomic<uint32_t> position;
+};
+
+// Structure to encapsulate state of a seal homing action. Homing finds the
+// end of seal travel without relying on a slow open-loop movement: the seal
+// approaches quickly until StallGuard or the limit switch reports contact,
+// backs off until the switch releases, and then re-approaches slowly so the
+// final position is repeatable.
+struct SealHomingState {
+    // Velocity multiplier for the fast approach, relative to the configured
+    // seal velocity. The result is still limited to one step per motor tick.
+    constexpr static double FAST_VELOCITY_SCALE = 2.0;
+    // Velocity multiplier for the slow re-approach, relative to the
+    // configured seal velocity
+    constexpr static double SLOW_VELOCITY_SCALE = 0.5;
+    // The slow re-approach never runs below the StallGuard minimum velocity
+    // set in TCOOLTHRS, or a hard stop could never be detected. This margin
+    // keeps it clear of the threshold after TSTEP rounding.
+    constexpr static double STALLGUARD_VELOCITY_MARGIN = 1.1;
+    // Distance of each backoff after the fast approach makes contact
+    constexpr static double BACKOFF_MM = 0.5F;
+    constexpr static signed long BACKOFF_MICROSTEPS =
+        motor_util::SealStepper::mm_to_steps(BACKOFF_MM);
+    // The limit switch has some hysteresis, so it may still be pressed after
+    // one backoff. Backoffs repeat until it releases, up to this many.
+    constexpr static uint8_t MAX_BACKOFFS = 4;
+    enum class Status {
+        IDLE,          /**< No homing action.*/
+        FAST_APPROACH, /**< Moving quickly towards the end of travel.*/
+        BACKOFF,       /**< Moving away from the contact point.*/
+        SLOW_APPROACH, /**< Moving slowly back to the contact point.*/
+    };
+    Status status;
+    // Direction of the homing approach. Retraction is true, extension is
+    // false.
+    bool retract;
+    // Backoffs made since contact. The slow re-approach covers the distance
+    // backed off plus one more backoff and the distance it needs to reach
+    // its peak velocity, which bounds it instead of relying on a timeout.
+    uint8_t backoffs;
 };
 
 // Structure to encapsulate state of the overall lid system
@@ -268,7 +323,11 @@ class MotorTask {
               .response_id = INVALID_ID},
           _seal_stepper_state{.status = SealStepperState::Status::IDLE,
                               .response_id = INVALID_ID,
-                              .direction = true},
+                              .direction = true,
+                              .position = 0},
+          _seal_homing{.status = SealHomingState::Status::IDLE,
+                       .retract = true,
+                       .backoffs = 0},
           _tmc2130(default_tmc_config),
           // Seal movement profile is populated with mostly dummy values.
           // It is set before every movement so these are irrelevant.
@@ -278,7 +337,9 @@ class MotorTask {
           _seal_velocity(SealStepperState::DEFAULT_VELOCITY),
           _seal_acceleration(SealStepperState::DEFAULT_ACCEL),
           _nudge_degrees(0),
-          _seal_position(motor_util::SealStepper::Status::UNKNOWN) {}
+          _seal_position(motor_util::SealStepper::Status::UNKNOWN),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          _stallguard_log() {}
     MotorTask(const MotorTask& other) = delete;
     auto operator=(const MotorTask& other) -> MotorTask& = delete;
     MotorTask(MotorTask&& other) noexcept = delete;
@@ -300,10 +361,21 @@ class MotorTask {
             policy.lid_stepper_set_dac(LID_STEPPER_HOLD_CURRENT);
         }
 
-        // This is the call down to the provided queue. It will block for
-        // anywhere up to the provided timeout, which drives the controller
-        // frequency.
-        static_cast<void>(_message_queue.recv(&message));
+        if (_seal_stepper_state.status == SealStepperState::Status::MOVING) {
+            // While the seal is moving, wake up at a fixed rate to sample
+            // the driver's load telemetry. This happens at task level over
+            // SPI, so the step interrupt timing is unaffected.
+            if (!_message_queue.try_recv(
+                    &message,
+                    SealStepperState::STALLGUARD_SAMPLE_PERIOD_TICKS)) {
+                sample_stallguard(policy);
+                return;
+            }
+        } else {
+            // This is the call down to the provided queue. It will block
+            // until a message is available.
+            static_cast<void>(_message_queue.recv(&message));
+        }
         std::visit(
             [this, &policy](const auto& msg) -> void {
                 this->visit_message(msg, policy);
@@ -311,6 +383,14 @@ class MotorTask {
             message);
     }
 
+    // True while run_once() does work without waiting for a message: the
+    // first pass configures the driver, and a moving seal is sampled on a
+    // timeout
+    [[nodiscard]] auto runs_without_message() const -> bool {
+        return !_initialized ||
+               _seal_stepper_state.status == SealStepperState::Status::MOVING;
+    }
+
     // Primarily for test integration, do not use for interprocess logic!!!
     [[nodiscard]] auto get_lid_state() const -> LidState::Status {
         return _state.status;
@@ -395,6 +475,7 @@ class MotorTask {
         }
         if (error == errors::ErrorCode::NO_ERROR) {
             _seal_stepper_state.response_id = msg.id;
+            _stallguard_log.clear();
             error = start_seal_movement(msg.steps, true, policy);
         }
 
@@ -431,13 +512,22 @@ class MotorTask {
                     // TODO clear the error
                     with_error = errors::ErrorCode::SEAL_MOTOR_FAULT;
                     _seal_position = motor_util::SealStepper::Status::UNKNOWN;
+                    _seal_homing.status = SealHomingState::Status::IDLE;
                     break;
                 default:
                     break;
             }
             _seal_stepper_state.status = SealStepperState::Status::IDLE;
+            if (with_error == errors::ErrorCode::NO_ERROR &&
+                _seal_homing.status != SealHomingState::Status::IDLE) {
+                with_error = handle_seal_homing_end(msg.reason, policy);
+            }
             if (with_error == errors::ErrorCode::NO_ERROR) {
-                with_error = handle_lid_state_end(policy);
+                // The lid state machine only advances once any homing
+                // action has finished
+                if (_seal_homing.status == SealHomingState::Status::IDLE) {
+                    with_error = handle_lid_state_end(policy);
+                }
             } else {
                 // Send error response on behalf of the lid state machine
                 lid_response_send_and_clear(with_error);
@@ -481,13 +571,35 @@ class MotorTask {
                        Policy& policy) -> void {
         auto response =
             messages::GetSealDriveStatusResponse{.responding_to_id = msg.id};
-        auto status = _tmc2130.get_driver_status(policy);
-        if (status.has_value()) {
-            response.status = status.value();
+        auto registers =
+            _tmc2130.read_registers<tmc2130::DriveStatus, tmc2130::TStep>(
+                policy);
+        if (registers.has_value()) {
+            std::tie(response.status, response.tstep) = registers.value();
         }
-        auto tstep = _tmc2130.get_tstep(policy);
-        if (tstep.has_value()) {
-            response.tstep = tstep.value();
+        static_cast<void>(_task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
+    template <MotorExecutionPolicy Policy>
+    auto visit_message(const messages::GetSealStallGuardLogMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response = messages::GetSealStallGuardLogResponse{
+            .responding_to_id = msg.id,
+            .total = static_cast<uint16_t>(_stallguard_log.size()),
+            .count = 0,
+            .start = msg.start,
+            .overwritten =
+                static_cast<uint32_t>(_stallguard_log.overwritten()),
+            .samples = {}};
+        for (auto& sample : response.samples) {
+            auto logged = _stallguard_log.at(msg.start + response.count);
+            if (!logged.has_value()) {
+                break;
+            }
+            sample = logged.value();
+            ++response.count;
         }
         static_cast<void>(_task_registry->comms->get_message_queue().try_send(
             messages::HostCommsMessage(response)));
@@ -668,6 +780,8 @@ class MotorTask {
         if (ret.step) {
             policy.tmc2130_step_pulse();
         }
+        _seal_stepper_state.position =
+            static_cast<uint32_t>(_seal_profile.current_distance());
         if (ret.done) {
             policy.seal_stepper_stop();
             // Send a 'done' message to ourselves
@@ -688,13 +802,31 @@ class MotorTask {
     template <MotorExecutionPolicy Policy>
     auto start_seal_movement(long steps, bool arm_limit_switch, Policy& policy)
         -> errors::ErrorCode {
+        return start_seal_movement(steps, arm_limit_switch, _seal_velocity,
+                                   policy);
+    }
+
+    /**
+     * @brief Start a seal movement at a specific peak velocity rather than
+     * the configured seal velocity.
+     *
+     * @param[in] velocity Peak velocity for the movement, in steps/second.
+     * The step interrupt makes at most one step per tick, so anything
+     * faster than the tick frequency is limited to it.
+     */
+    template <MotorExecutionPolicy Policy>
+    auto start_seal_movement(long steps, bool arm_limit_switch,
+                             double velocity, Policy& policy)
+        -> errors::ErrorCode {
         if (_seal_stepper_state.status != SealStepperState::Status::IDLE) {
             return errors::ErrorCode::SEAL_MOTOR_BUSY;
         }
+        velocity =
+            std::min(velocity, static_cast<double>(Policy::MotorTickFrequency));
 
         // Movement profile gets constructed with default parameters
         _seal_profile = motor_util::MovementProfile(
-            policy.MotorTickFrequency, 0, _seal_velocity, _seal_acceleration,
+            policy.MotorTickFrequency, 0, velocity, _seal_acceleration,
             motor_util::MovementType::FixedDistance, std::abs(steps));
 
         _seal_stepper_state.direction = steps > 0;
@@ -746,6 +878,7 @@ class MotorTask {
             return errors::ErrorCode::SEAL_MOTOR_FAULT;
         }
 
+        _seal_stepper_state.position = 0;
         _seal_stepper_state.status = SealStepperState::Status::MOVING;
         _seal_position = motor_util::SealStepper::Status::UNKNOWN;
 
@@ -759,6 +892,164 @@ class MotorTask {
         return errors::ErrorCode::NO_ERROR;
     }
 
+    /**
+     * @brief Start a seal homing action towards one end of travel. The
+     * caller is informed that the action is complete through the usual
+     * seal completion path once the slow re-approach finishes.
+     *
+     * @param[in] steps Maximum distance for the fast approach. This is
+     * \e signed, positive values retract and negative values extend.
+     * @param[in] policy Instance of the policy for motor control.
+     */
+    template <MotorExecutionPolicy Policy>
+    auto start_seal_homing(long steps, Policy& policy) -> errors::ErrorCode {
+        _seal_homing.retract = steps > 0;
+        _seal_homing.status = SealHomingState::Status::FAST_APPROACH;
+        auto error = start_seal_movement(
+            steps, true, _seal_velocity * SealHomingState::FAST_VELOCITY_SCALE,
+            policy);
+        if (error != errors::ErrorCode::NO_ERROR) {
+            _seal_homing.status = SealHomingState::Status::IDLE;
+        }
+        return error;
+    }
+
+    /**
+     * @brief Back off one step of the seal homing action, away from the end
+     * of travel it approached.
+     */
+    template <MotorExecutionPolicy Policy>
+    auto start_seal_homing_backoff(Policy& policy) -> errors::ErrorCode {
+        ++_seal_homing.backoffs;
+        return start_seal_movement(_seal_homing.retract
+                                       ? -SealHomingState::BACKOFF_MICROSTEPS
+                                       : SealHomingState::BACKOFF_MICROSTEPS,
+                                   false, policy);
+    }
+
+    /**
+     * @brief Velocity for the slow re-approach of a seal homing action. This
+     * is a fraction of the configured seal velocity, raised to the StallGuard
+     * minimum velocity in TCOOLTHRS so a hard stop is still detected.
+     *
+     * @return Peak velocity in steps/second
+     */
+    auto seal_homing_slow_velocity() -> double {
+        auto velocity = _seal_velocity * SealHomingState::SLOW_VELOCITY_SCALE;
+        auto tcool = _tmc2130.get_register_map().tcoolthrs.threshold;
+        if (tcool != SealStepperState::DISABLED_SG_MIN_VELOCITY) {
+            velocity = std::max(
+                velocity,
+                motor_util::SealStepper::tstep_to_velocity(tcool) *
+                    SealHomingState::STALLGUARD_VELOCITY_MARGIN);
+        }
+        return velocity;
+    }
+
+    /**
+     * @brief Distance a seal movement covers while it accelerates from rest
+     * to a peak velocity.
+     *
+     * @param[in] velocity Peak velocity in steps/second
+     * @return Distance in steps
+     */
+    [[nodiscard]] auto seal_ramp_distance(double velocity) const
+        -> signed long {
+        if (_seal_acceleration <= 0) {
+            return 0;
+        }
+        return static_cast<signed long>(
+            std::ceil((velocity * velocity) / (2.0 * _seal_acceleration)));
+    }
+
+    /**
+     * @brief Advance the seal homing state machine after a seal movement
+     * completes. When this leaves the homing status at IDLE, the homing
+     * action is finished.
+     *
+     * @param[in] reason Why the last seal movement ended
+     * @param[in] policy Instance of the policy for motor control.
+     * @return errors::ErrorCode
+     */
+    template <MotorExecutionPolicy Policy>
+    auto handle_seal_homing_end(
+        messages::SealStepperComplete::CompletionReason reason, Policy& policy)
+        -> errors::ErrorCode {
+        using Reason = messages::SealStepperComplete::CompletionReason;
+        auto contact = (reason == Reason::LIMIT) || (reason == Reason::STALL);
+        auto error = errors::ErrorCode::NO_ERROR;
+        switch (_seal_homing.status) {
+            case SealHomingState::Status::FAST_APPROACH:
+                if (!contact) {
+                    // Ran the full distance without finding the end of
+                    // travel, so there is nothing to refine.
+                    _seal_homing.status = SealHomingState::Status::IDLE;
+                    break;
+                }
+                _seal_homing.status = SealHomingState::Status::BACKOFF;
+                _seal_homing.backoffs = 0;
+                error = start_seal_homing_backoff(policy);
+                break;
+            case SealHomingState::Status::BACKOFF: {
+                auto pressed = _seal_homing.retract
+                                   ? policy.seal_read_retraction_switch()
+                                   : policy.seal_read_extension_switch();
+                if (pressed) {
+                    error = (_seal_homing.backoffs <
+                             SealHomingState::MAX_BACKOFFS)
+                                ? start_seal_homing_backoff(policy)
+                                : errors::ErrorCode::SEAL_MOTOR_SWITCH;
+                    break;
+                }
+                _seal_homing.status = SealHomingState::Status::SLOW_APPROACH;
+                auto velocity = seal_homing_slow_velocity();
+                auto distance = SealHomingState::BACKOFF_MICROSTEPS *
+                                    (_seal_homing.backoffs + 1) +
+                                seal_ramp_distance(velocity);
+                error = start_seal_movement(
+                    _seal_homing.retract ? distance : -distance, true,
+                    velocity, policy);
+                break;
+            }
+            case SealHomingState::Status::SLOW_APPROACH:
+                _seal_homing.status = SealHomingState::Status::IDLE;
+                if (!contact) {
+                    // Contact was found on the fast approach but not within
+                    // the bounded re-approach window.
+                    error = errors::ErrorCode::SEAL_MOTOR_SWITCH;
+                }
+                break;
+            case SealHomingState::Status::IDLE:
+                [[fallthrough]];
+            default:
+                break;
+        }
+        if (error != errors::ErrorCode::NO_ERROR) {
+            _seal_homing.status = SealHomingState::Status::IDLE;
+            _seal_position = motor_util::SealStepper::Status::UNKNOWN;
+        }
+        return error;
+    }
+
+    /**
+     * @brief Read the TMC2130 DRV_STATUS register and record the load
+     * telemetry in the StallGuard log. A failed read is skipped rather than
+     * logged as a zeroed sample.
+     * @param policy Instance of the policy for motor control
+     */
+    template <MotorExecutionPolicy Policy>
+    auto sample_stallguard(Policy& policy) -> void {
+        auto status = _tmc2130.get_driver_status(policy);
+        if (!status.has_value()) {
+            return;
+        }
+        _stallguard_log.push(motor_util::StallGuardSample{
+            .position = _seal_stepper_state.position,
+            .sg_result = static_cast<uint16_t>(status.value().sg_result),
+            .cs_actual = static_cast<uint8_t>(status.value().cs_actual),
+            .stallguard = status.value().stallguard != 0});
+    }
+
     /**
      * @brief This function should clear the stall flag in the TMC2130.
      * Enables and then disables the StealthChop mode (which isn't used in
@@ -853,6 +1144,9 @@ class MotorTask {
                     messages::HostCommsMessage(response)));
             return error;
         }
+        // One log covers every seal movement of the action, including
+        // each leg of a seal homing
+        _stallguard_log.clear();
         if (extend_switch && retract_switch) {
             // Both switches triggered means the seal subsystem is somehow
             // broken.
@@ -905,6 +1199,9 @@ class MotorTask {
                     messages::HostCommsMessage(response)));
             return error;
         }
+        // One log covers every seal movement of the action, including
+        // each leg of a seal homing
+        _stallguard_log.clear();
         if (extend_switch && retract_switch) {
             // Both switches retracted means the seal subsystem is somehow
             // broken.
@@ -1056,9 +1353,9 @@ class MotorTask {
                     messages::UpdateMotorState::MotorState::IDLE;
                 break;
             case LidState::Status::OPENING_RETRACT_SEAL:
-                // The seal stepper is retracted to the limit switch
-                error = start_seal_movement(
-                    SealStepperState::FULL_RETRACT_MICROSTEPS, true, policy);
+                // The seal stepper is homed to the limit switch
+                error = start_seal_homing(
+                    SealStepperState::FULL_RETRACT_MICROSTEPS, policy);
                 state_for_system_task =
                     messages::UpdateMotorState::MotorState::OPENING_OR_CLOSING;
                 break;
@@ -1078,9 +1375,9 @@ class MotorTask {
                     messages::UpdateMotorState::MotorState::OPENING_OR_CLOSING;
                 break;
             case LidState::Status::CLOSING_RETRACT_SEAL:
-                // The seal stepper is retracted to a stall
-                error = start_seal_movement(
-                    SealStepperState::FULL_RETRACT_MICROSTEPS, true, policy);
+                // The seal stepper is homed to a stall
+                error = start_seal_homing(
+                    SealStepperState::FULL_RETRACT_MICROSTEPS, policy);
                 state_for_system_task =
                     messages::UpdateMotorState::MotorState::OPENING_OR_CLOSING;
                 break;
@@ -1100,9 +1397,9 @@ class MotorTask {
                     messages::UpdateMotorState::MotorState::OPENING_OR_CLOSING;
                 break;
             case LidState::Status::CLOSING_EXTEND_SEAL:
-                // The seal stepper is extended to engage with the plate
-                error = start_seal_movement(
-                    SealStepperState::FULL_EXTEND_MICROSTEPS, true, policy);
+                // The seal stepper is homed to engage with the plate
+                error = start_seal_homing(
+                    SealStepperState::FULL_EXTEND_MICROSTEPS, policy);
                 state_for_system_task =
                     messages::UpdateMotorState::MotorState::OPENING_OR_CLOSING;
                 break;
@@ -1354,6 +1651,7 @@ class MotorTask {
     LidState _state;
     LidStepperState _lid_stepper_state;
     SealStepperState _seal_stepper_state;
+    SealHomingState _seal_homing;
     tmc2130::TMC2130 _tmc2130;
     motor_util::MovementProfile _seal_profile;
     double _seal_velocity;
@@ -1373,5 +1671,13 @@ class MotorTask {
      * need a similar variable for that motor.
      */
     motor_util::SealStepper::Status _seal_position;
+    /**
+     * @brief StallGuard telemetry captured during the most recent seal
+     * action. Cleared when a seal debug movement or a lid open or close
+     * starts, so a lid action keeps the samples of all of its seal legs.
+     */
+    ring_buffer::RingBuffer<motor_util::StallGuardSample,
+                            SealStepperState::STALLGUARD_LOG_LENGTH>
+        _stallguard_log;
 };
 };  // namespace motor_task
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <concepts>
+#include <cstdint>
 
 #include "core/fixed_point.hpp"
 
@@ -181,6 +182,21 @@ class SealStepper {
     }
 };
 
+/**
+ * @brief A single StallGuard telemetry sample, captured from the TMC2130
+ * DRV_STATUS register while the seal stepper is moving.
+ */
+struct StallGuardSample {
+    // Number of motor ticks into the movement when the sample was taken
+    uint32_t position = 0;
+    // StallGuard2 load measurement (SG_RESULT)
+    uint16_t sg_result = 0;
+    // Actual motor current scaling (CS_ACTUAL)
+    uint8_t cs_actual = 0;
+    // Whether the StallGuard flag was set
+    bool stallguard = false;
+};
+
 /** The end condition for this movement.*/
 enum class MovementType {
     FixedDistance,  // This movement goes for a fixed number of steps.
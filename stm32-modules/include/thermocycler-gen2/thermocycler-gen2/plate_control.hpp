@@ -7,6 +7,7 @@
 #pragma once
 
 #include "core/pid.hpp"
+#include "thermocycler-gen2/plate_model.hpp"
 #include "thermocycler-gen2/thermal_general.hpp"
 
 namespace plate_control {
@@ -107,6 +108,11 @@ class PlateControl {
      * drift more than our normal spec BUT will not affect the samples.
      */
     static constexpr double DRIFT_CHECK_IGNORE_MAX_TEMP = 7.5;
+    /** Number of zones in the peltier gain schedule, one per
+     *  TemperatureZone.*/
+    static constexpr size_t ZONE_COUNT = 3;
+
+    using GainSchedule = PIDGainSchedule<ZONE_COUNT>;
 
     PlateControl() = delete;
     /**
@@ -120,7 +126,11 @@ class PlateControl {
                  thermal_general::Peltier &right,
                  thermal_general::Peltier &center,
                  thermal_general::HeatsinkFan &fan)
-        : _left(left), _right(right), _center(center), _fan(fan) {}
+        : _left(left),
+          _right(right),
+          _center(center),
+          _fan(fan),
+          _gains(left.pid.gains()) {}
 
     /**
      * @brief Updates the power settings for the peltiers fans. The current
@@ -145,11 +155,65 @@ class PlateControl {
      * temperature before the step is considered done, in seconds.
      * @param[in] ramp_rate The rate to drive the peltiers at, in degrees
      * celsius per second.
+     * @param[in] feed_forward If true, add the output of the thermal model
+     * to the PID output of each peltier while driving to this target.
      * @return True if the temperature target could be updated
      */
     auto set_new_target(double setpoint, double volume_ul,
                         double hold_time = HOLD_INFINITE,
-                        double ramp_rate = RAMP_INFINITE) -> bool;
+                        double ramp_rate = RAMP_INFINITE,
+                        bool feed_forward = false) -> bool;
+
+    /**
+     * @brief Update the parameters of the thermal model used for
+     * feed-forward control.
+     * @return True if the parameters were valid and have been applied
+     */
+    auto set_model(const plate_model::Parameters &params) -> bool {
+        return _model.set_parameters(params);
+    }
+
+    /** Return the thermal model used for feed-forward control.*/
+    [[nodiscard]] auto model() const -> const plate_model::PlateModel & {
+        return _model;
+    }
+
+    /**
+     * @brief Update the peltier gain schedule. The new gains are used from
+     * the next time a peltier's target changes.
+     * @param[in] zone Index of the TemperatureZone to update (see
+     * \ref zone_index), or every zone if empty
+     * @param[in] direction The direction to update, or both if empty
+     * @param[in] gains The new gains
+     * @return True if the zone exists and the schedule was updated
+     */
+    auto set_gains(std::optional<size_t> zone,
+                   std::optional<PIDDirection> direction,
+                   const PIDGains &gains) -> bool {
+        return _gains.set(zone, direction, gains);
+    }
+
+    /** Return the peltier gain schedule.*/
+    [[nodiscard]] auto gain_schedule() const -> const GainSchedule & {
+        return _gains;
+    }
+
+    /** Get the index of a TemperatureZone in the gain schedule.*/
+    [[nodiscard]] static constexpr auto zone_index(TemperatureZone zone)
+        -> size_t {
+        switch (zone) {
+            case TemperatureZone::COLD:
+                return 0;
+            case TemperatureZone::WARM:
+                return 1;
+            case TemperatureZone::HOT:
+            default:
+                return 2;
+        }
+    }
+
+    /** Return whether the current target uses feed-forward control.*/
+    [[nodiscard]] auto feed_forward() const -> bool { return _feed_forward; }
 
     /**
      * @brief This function will return the correct fan PWM to be set if
@@ -188,6 +252,14 @@ class PlateControl {
      */
     [[nodiscard]] auto temp_within_setpoint() const -> bool;
 
+    /**
+     * @brief Checks if the current target has been reached and held for
+     * its full hold time. A target with no hold time is complete as soon
+     * as the plate settles at it.
+     * @return True if the hold for the current target is over
+     */
+    [[nodiscard]] auto hold_complete() const -> bool;
+
     /**
      * @brief Check for thermistor drift.
      * @return true if the thermistors are \b within spec, false if the
@@ -257,6 +329,16 @@ class PlateControl {
      * @return The new power value for the element
      */
     auto update_pid(thermal_general::Peltier &peltier, Seconds time) -> double;
+    /**
+     * @brief Get the feed-forward power for a single peltier from the
+     * thermal model, based on its target and the heatsink temperature.
+     * @param[in] peltier The peltier to calculate the power for
+     * @param[in] target_rate The rate its target is moving at, in ºC/s
+     * @return The feed-forward power for the element
+     */
+    [[nodiscard]] auto feed_forward_power(
+        const thermal_general::Peltier &peltier, double target_rate) const
+        -> double;
     /**
      * @brief Update the control of the heatsink fan during active control
      * @param[in] time The time that has passed since the last update
@@ -279,6 +361,15 @@ class PlateControl {
      * @param[in] fan The fan to reset control for.
      */
     auto reset_control(thermal_general::HeatsinkFan &fan) -> void;
+    /**
+     * @brief Switch a peltier to the scheduled gains for the zone of its
+     * target and the direction of the current move. The PID keeps its
+     * state, so this can be called while the peltier is being controlled.
+     * @param[in] peltier The peltier to update the gains of
+     * @param[in] target The temperature the peltier is driving to
+     */
+    auto schedule_gains(thermal_general::Peltier &peltier, double target)
+        -> void;
 
     /**
      * @brief Based on the current temperature readings, check if the average
@@ -381,6 +472,14 @@ class PlateControl {
     Seconds _uniformity_error_timer = 0.0F;
     Seconds _hold_time = 0.0F;            // Total hold time
     Seconds _remaining_hold_time = 0.0F;  // Hold time left, out of _hold_time
+    // Thermal model & whether the current target uses it
+    plate_model::PlateModel _model = plate_model::PlateModel();
+    bool _feed_forward = false;
+    // Target of each peltier on the last update, to find the ramp rate
+    std::array<double, PELTIER_COUNT> _last_targets = {0.0F};
+    // Direction of the current move, used to pick scheduled gains
+    PIDDirection _direction = PIDDirection::HEATING;
+    GainSchedule _gains;
 };
 
 }  // namespace plate_control
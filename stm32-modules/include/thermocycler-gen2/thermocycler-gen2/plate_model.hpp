@@ -0,0 +1,115 @@
+/**
+ * @file plate_model.hpp
+ * @brief Defines a first-order thermal model of a peltier channel on the
+ * thermal plate, used to compute a feed-forward power term.
+ * @details The model treats each channel of the plate as a single thermal
+ * mass that is driven by its peltier and that leaks heat to the heatsink:
+ *
+ *     dT/dt = gain * power + loss * (T_heatsink - T)
+ *
+ * \c gain is the rate of temperature change at full peltier power with the
+ * plate at the heatsink temperature, and \c loss is the inverse of the time
+ * constant of the plate relaxing back to the heatsink. Both parameters can
+ * be identified from an open-loop step response, such as the data captured
+ * by \c scripts/step_response.py.
+ *
+ * Inverting the model gives the power needed to follow a target trajectory
+ * without any error, which the plate controller adds on top of the PID
+ * output so that the PID only has to correct for model error.
+ */
+#pragma once
+
+#include <algorithm>
+
+namespace plate_model {
+
+struct Parameters {
+    double gain;  // ºC per second at full power
+    double loss;  // Inverse of the heatsink coupling time constant, in 1/s
+};
+
+class PlateModel {
+  public:
+    using Seconds = double;
+
+    /**
+     * Default parameters, matching the gain and ambient coupling measured
+     * for a single peltier channel.
+     */
+    static constexpr Parameters DEFAULT_PARAMETERS{.gain = 3.2F,
+                                                   .loss = 0.0015F};
+    /** The feed-forward term is limited to the same range as the PID.*/
+    static constexpr double POWER_MAX = 1.0F;
+    static constexpr double POWER_MIN = -1.0F;
+
+    constexpr explicit PlateModel(Parameters params = DEFAULT_PARAMETERS)
+        : _params(params) {}
+
+    /**
+     * @brief Check whether a set of model parameters is usable. The gain
+     * must be positive so that the model can be inverted, and the loss
+     * can't be negative.
+     */
+    [[nodiscard]] static constexpr auto valid(const Parameters& params)
+        -> bool {
+        return params.gain > 0.0F && params.loss >= 0.0F;
+    }
+
+    /**
+     * @brief Update the model parameters.
+     * @return True if the parameters were valid and have been applied
+     */
+    auto set_parameters(const Parameters& params) -> bool {
+        if (!valid(params)) {
+            return false;
+        }
+        _params = params;
+        return true;
+    }
+
+    [[nodiscard]] constexpr auto parameters() const -> Parameters {
+        return _params;
+    }
+
+    /**
+     * @brief Get the rate of temperature change the model predicts.
+     * @param temp The current temperature of the channel
+     * @param heatsink The current temperature of the heatsink
+     * @param power The power driving the peltier, from -1 to 1
+     * @return The rate of change of temperature, in ºC/s
+     */
+    [[nodiscard]] constexpr auto rate(double temp, double heatsink,
+                                      double power) const -> double {
+        return (_params.gain * power) + (_params.loss * (heatsink - temp));
+    }
+
+    /**
+     * @brief Predict the temperature of a channel after holding a power
+     * for a period of time.
+     */
+    [[nodiscard]] constexpr auto predict(double temp, double heatsink,
+                                         double power, Seconds time) const
+        -> double {
+        return temp + (rate(temp, heatsink, power) * time);
+    }
+
+    /**
+     * @brief Calculate the power that keeps a channel on a target trajectory.
+     * @param target The target temperature
+     * @param heatsink The current temperature of the heatsink
+     * @param target_rate The rate the target is moving at, in ºC/s
+     * @return The feed-forward power, from -1 to 1
+     */
+    [[nodiscard]] constexpr auto feed_forward(double target, double heatsink,
+                                              double target_rate) const
+        -> double {
+        auto power =
+            (target_rate - (_params.loss * (heatsink - target))) / _params.gain;
+        return std::clamp(power, POWER_MIN, POWER_MAX);
+    }
+
+  private:
+    Parameters _params;
+};
+
+}  // namespace plate_model
@@ -7,6 +7,7 @@
 #include <variant>
 
 #include "core/ack_cache.hpp"
+#include "core/task_memory.hpp"
 #include "core/version.hpp"
 #include "core/xt1511.hpp"
 #include "hal/message_queue.hpp"
@@ -177,6 +178,12 @@ concept SystemExecutionPolicy = requires(Policy& p, const Policy& cp) {
     { p.get_front_button_status() } -> std::same_as<bool>;
     // A function to set the LED on the front button on or off
     { p.set_front_button_led(true) } -> std::same_as<void>;
+    // The number of statically allocated tasks whose stacks are tracked
+    { p.get_task_count() } -> std::same_as<size_t>;
+    // The stack usage of one tracked task
+    { p.get_stack_usage(0) } -> std::same_as<task_memory::StackUsage>;
+    // The static RAM and heap in use
+    { p.get_ram_usage() } -> std::same_as<task_memory::RamUsage>;
 };
 
 struct LedState {
@@ -496,6 +503,26 @@ class SystemTask {
             _task_registry->comms->get_message_queue().try_send(response));
     }
 
+    template <SystemExecutionPolicy Policy>
+    auto visit_message(const messages::GetTaskMemoryMessage& message,
+                       Policy& policy) {
+        auto response = messages::GetTaskMemoryResponse{
+            .responding_to_id = message.id,
+            .total = static_cast<uint32_t>(policy.get_task_count()),
+            .start = message.start,
+            .count = 0,
+            .ram = policy.get_ram_usage(),
+            .stacks = {}};
+        while (response.count < response.stacks.size() &&
+               response.start + response.count < response.total) {
+            response.stacks.at(response.count) =
+                policy.get_stack_usage(response.start + response.count);
+            ++response.count;
+        }
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
     template <SystemExecutionPolicy Policy>
     auto visit_message(const messages::SetLightsDebugMessage& message,
                        Policy& policy) {
@@ -0,0 +1,39 @@
+/*
+ * Where each task keeps its runtime stats, so that host comms can report
+ * them with M990.D. This is kept apart from tasks.hpp because the task
+ * headers that tasks.hpp includes need it too.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "core/task_stats.hpp"
+
+namespace tasks {
+
+// Where each task keeps its runtime stats in the TaskStatsRegistry. The
+// thermistor tasks are periodic and also record the jitter of their wakeups.
+enum class TaskIndex : size_t {
+    HOST_COMMS,
+    SYSTEM,
+    THERMAL_PLATE,
+    LID_HEATER,
+    MOTOR,
+    PLATE_THERMISTOR,
+    LID_THERMISTOR,
+};
+
+using TaskStatsRegistry = task_stats::Registry<7>;
+
+// Matches TaskIndex
+static constexpr std::array<const char*, TaskStatsRegistry::TASKS>
+    TASK_NAMES = {"HostComms", "System",          "Plate",        "Lid",
+                  "Motor",     "PlateThermistor", "LidThermistor"};
+
+inline auto task_stats_for(TaskStatsRegistry& registry, TaskIndex task)
+    -> task_stats::TaskStats& {
+    return registry.at(static_cast<size_t>(task));
+}
+
+}  // namespace tasks
@@ -12,14 +12,17 @@
 #include <variant>
 
 #include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
 #include "core/thermistor_conversion.hpp"
 #include "hal/message_queue.hpp"
 #include "thermocycler-gen2/eeprom.hpp"
 #include "thermocycler-gen2/errors.hpp"
 #include "thermocycler-gen2/messages.hpp"
 #include "thermocycler-gen2/plate_control.hpp"
+#include "thermocycler-gen2/plate_model.hpp"
 #include "thermocycler-gen2/tasks.hpp"
 #include "thermocycler-gen2/thermal_general.hpp"
+#include "thermocycler-gen2/thermal_program.hpp"
 
 /* Need a forward declaration for this because of recursive includes */
 namespace tasks {
@@ -70,7 +73,8 @@ struct State {
         IDLE,        /**< Not doing anything.*/
         ERROR,       /**< Experiencing an error*/
         CONTROLLING, /**< Controlling temperature (PID)*/
-        PWM_TEST     /**< Testing PWM output (debug command)*/
+        PWM_TEST,    /**< Testing PWM output (debug command)*/
+        AUTOTUNING   /**< Finding peltier PID constants (relay test)*/
     };
     Status system_status;
     uint16_t error_bitmap;
@@ -123,6 +127,14 @@ class ThermalPlateTask {
     static constexpr const double OFFSET_DEFAULT_CONST_A = -0.02F;
     static constexpr const double OFFSET_DEFAULT_CONST_B = 0.022F;
     static constexpr const double OFFSET_DEFAULT_CONST_C = -0.154F;
+    // Peltier power on either side of the autotune relay
+    static constexpr double AUTOTUNE_RELAY_POWER = 0.5F;
+    // Band around the autotune target before the relay switches, in ºC
+    static constexpr double AUTOTUNE_HYSTERESIS = 0.25F;
+    // Autotuning fails if it hasn't finished after this long
+    static constexpr double AUTOTUNE_TIMEOUT_SECONDS = 1200.0F;
+    static constexpr double AUTOTUNE_TARGET_MIN = 4.0F;
+    static constexpr double AUTOTUNE_TARGET_MAX = 99.0F;
 
     explicit ThermalPlateTask(Queue& q)
         : _message_queue(q),
@@ -213,7 +225,12 @@ class ThermalPlateTask {
               .br = OFFSET_DEFAULT_CONST_B,
               .cr = OFFSET_DEFAULT_CONST_C,
           },
-          _last_update(0) {}
+          _last_update(0),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          _program(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          _autotune(),
+          _autotune_save(false) {}
     ThermalPlateTask(const ThermalPlateTask& other) = delete;
     auto operator=(const ThermalPlateTask& other) -> ThermalPlateTask& = delete;
     ThermalPlateTask(ThermalPlateTask&& other) noexcept = delete;
@@ -252,6 +269,11 @@ class ThermalPlateTask {
         if (!_eeprom.initialized()) {
             _offset_constants =
                 _eeprom.get_offset_constants(_offset_constants, policy);
+            auto pid = _eeprom.get_pid_constants(
+                eeprom::PIDConstants{
+                    .kp = DEFAULT_KP, .ki = DEFAULT_KI, .kd = DEFAULT_KD},
+                policy);
+            set_peltier_pid(pid.kp, pid.ki, pid.kd);
         }
 
         // This is the call down to the provided queue. It will block for
@@ -334,8 +356,18 @@ class ThermalPlateTask {
             if (time_delta.count() < 0) {
                 time_delta += time_overflow_amount;
             }
-            update_control(policy,
-                           std::chrono::duration_cast<Seconds>(time_delta));
+            if (update_control(
+                    policy, std::chrono::duration_cast<Seconds>(time_delta))) {
+                advance_program();
+            }
+            send_current_state();
+        } else if (_state.system_status == State::AUTOTUNING) {
+            auto time_delta = current_time - _last_update;
+            if (time_delta.count() < 0) {
+                time_delta += time_overflow_amount;
+            }
+            update_autotune(policy,
+                            std::chrono::duration_cast<Seconds>(time_delta));
             send_current_state();
         } else if (_state.system_status == State::IDLE) {
             send_current_state();
@@ -351,6 +383,8 @@ class ThermalPlateTask {
         if (_state.system_status == State::ERROR) {
             policy.set_enabled(false);
             reset_peltier_filters();
+            _program.stop();
+            _autotune.stop();
         }
 
         // Cache the timestamp from this message so the time difference for
@@ -416,7 +450,8 @@ class ThermalPlateTask {
                 _task_registry->comms->get_message_queue().try_send(response));
             return;
         }
-        if (_state.system_status == State::CONTROLLING) {
+        if (_state.system_status == State::CONTROLLING ||
+            _state.system_status == State::AUTOTUNING) {
             // Send busy error
             response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
             static_cast<void>(
@@ -525,31 +560,18 @@ class ThermalPlateTask {
                 _task_registry->comms->get_message_queue().try_send(response));
             return;
         }
-        if (_state.system_status == State::PWM_TEST) {
-            // Reset all peltiers
-            auto ret = policy.set_peltier(_peltier_left.id, 0.0F,
-                                          PeltierDirection::PELTIER_HEATING);
-            if (ret) {
-                ret = policy.set_peltier(_peltier_right.id, 0.0F,
-                                         PeltierDirection::PELTIER_HEATING);
-            }
-            if (ret) {
-                ret = policy.set_peltier(_peltier_center.id, 0.0F,
-                                         PeltierDirection::PELTIER_HEATING);
-            }
-            reset_peltier_filters();
-            if (!ret) {
-                policy.set_enabled(false);
-                response.with_error = errors::ErrorCode::THERMAL_PELTIER_ERROR;
-                _state.system_status = State::ERROR;
-                _state.error_bitmap |= State::PELTIER_ERROR;
-                static_cast<void>(
-                    _task_registry->comms->get_message_queue().try_send(
-                        response));
-                return;
-            }
+        if (_state.system_status == State::PWM_TEST &&
+            !end_pwm_test(policy)) {
+            response.with_error = errors::ErrorCode::THERMAL_PELTIER_ERROR;
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
         }
 
+        // A manual target replaces any running program or autotune
+        _program.stop();
+        _autotune.stop();
+
         double volume_ul = (msg.volume < 0.0F) ? DEFAULT_VOLUME_UL : msg.volume;
 
         if (msg.setpoint <= 0.0F) {
@@ -585,6 +607,8 @@ class ThermalPlateTask {
         policy.set_enabled(false);
         reset_peltier_filters();
         _state.system_status = State::IDLE;
+        _program.stop();
+        _autotune.stop();
 
         if (msg.from_system) {
             static_cast<void>(
@@ -603,6 +627,8 @@ class ThermalPlateTask {
 
         policy.set_enabled(false);
         reset_peltier_filters();
+        _program.stop();
+        _autotune.stop();
         if (_state.system_status != State::ERROR) {
             _state.system_status = State::IDLE;
         }
@@ -610,6 +636,112 @@ class ThermalPlateTask {
             _task_registry->comms->get_message_queue().try_send(response));
     }
 
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::SetThermalProgramStepMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        if (_program.running()) {
+            response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
+        } else if (!_program.set_step(msg.index, msg.step)) {
+            response.with_error =
+                errors::ErrorCode::THERMAL_PROGRAM_STEP_INVALID;
+        }
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::StartThermalProgramMessage& msg,
+                       Policy& policy) -> void {
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        if (_state.system_status == State::ERROR) {
+            response.with_error = most_relevant_error();
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
+        if (_program.step_count() == 0) {
+            response.with_error = errors::ErrorCode::THERMAL_PROGRAM_EMPTY;
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
+        if (_state.system_status == State::PWM_TEST &&
+            !end_pwm_test(policy)) {
+            response.with_error = errors::ErrorCode::THERMAL_PELTIER_ERROR;
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
+
+        _autotune.stop();
+        _program.set_lid_target(msg.lid_target);
+        _program.set_feed_forward(msg.feed_forward);
+        auto first = _program.start();
+        if (!apply_program_step(first.value())) {
+            _program.stop();
+            response.with_error = errors::ErrorCode::THERMAL_TARGET_BAD;
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
+        _state.system_status = State::CONTROLLING;
+
+        if (msg.lid_target > thermal_program::ThermalProgram::NO_LID_TARGET) {
+            auto lid_message =
+                messages::SetLidTemperatureMessage{.id = 0,
+                                                   .setpoint = msg.lid_target,
+                                                   .from_program = true};
+            static_cast<void>(
+                _task_registry->lid_heater->get_message_queue().try_send(
+                    lid_message));
+        }
+
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+        send_program_event(first.value());
+    }
+
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::GetThermalProgramStatusMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto total = std::min(_program.total_steps(),
+                              static_cast<uint64_t>(UINT32_MAX));
+        auto response = messages::GetThermalProgramStatusResponse{
+            .responding_to_id = msg.id,
+            .running = _program.running(),
+            .step = static_cast<uint32_t>(_program.step_index()),
+            .step_count = static_cast<uint32_t>(_program.step_count()),
+            .executed = _program.steps_executed(),
+            .total = static_cast<uint32_t>(total),
+            .lid_target = _program.lid_target()};
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::SetPlateModelMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+
+        if (_state.system_status == State::CONTROLLING ||
+            _state.system_status == State::AUTOTUNING) {
+            response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
+        } else if (!_plate_control.set_model(plate_model::Parameters{
+                       .gain = msg.gain, .loss = msg.loss})) {
+            response.with_error =
+                errors::ErrorCode::THERMAL_CONSTANT_OUT_OF_RANGE;
+        }
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
     template <ThermalPlateExecutionPolicy Policy>
     auto visit_message(const messages::SetPIDConstantsMessage& msg,
                        Policy& policy) -> void {
@@ -617,7 +749,8 @@ class ThermalPlateTask {
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
 
-        if (_state.system_status == State::CONTROLLING) {
+        if (_state.system_status == State::CONTROLLING ||
+            _state.system_status == State::AUTOTUNING) {
             response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
             static_cast<void>(
                 _task_registry->comms->get_message_queue().try_send(response));
@@ -635,20 +768,59 @@ class ThermalPlateTask {
         if (msg.selection == PidSelection::FANS) {
             _fans.pid =
                 PID(msg.p, msg.i, msg.d, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
-        } else {
-            // For now, all peltiers share the same PID values...
-            _peltier_right.pid =
-                PID(msg.p, msg.i, msg.d, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
-            _peltier_left.pid =
-                PID(msg.p, msg.i, msg.d, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
-            _peltier_center.pid =
-                PID(msg.p, msg.i, msg.d, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
+        } else if (!msg.zone.has_value() && !msg.direction.has_value()) {
+            set_peltier_pid(msg.p, msg.i, msg.d);
+        } else if (!_plate_control.set_gains(
+                       msg.zone, msg.direction,
+                       PIDGains{.kp = msg.p, .ki = msg.i, .kd = msg.d})) {
+            response.with_error =
+                errors::ErrorCode::THERMAL_CONSTANT_OUT_OF_RANGE;
         }
 
         static_cast<void>(
             _task_registry->comms->get_message_queue().try_send(response));
     }
 
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::StartPlateAutotuneMessage& msg,
+                       Policy& policy) -> void {
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        auto config = relay_autotune::Config{
+            .setpoint = msg.target,
+            .output_high = AUTOTUNE_RELAY_POWER,
+            .output_low = -AUTOTUNE_RELAY_POWER,
+            .hysteresis = AUTOTUNE_HYSTERESIS,
+            .cycles = static_cast<uint8_t>(std::clamp(
+                msg.cycles, 0,
+                static_cast<int>(relay_autotune::RelayAutotune::MAX_CYCLES))),
+            .timeout = AUTOTUNE_TIMEOUT_SECONDS};
+
+        if (_state.system_status == State::ERROR) {
+            response.with_error = most_relevant_error();
+        } else if (_state.system_status == State::CONTROLLING ||
+                   _state.system_status == State::AUTOTUNING) {
+            response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
+        } else if ((msg.target < AUTOTUNE_TARGET_MIN) ||
+                   (msg.target > AUTOTUNE_TARGET_MAX)) {
+            response.with_error = errors::ErrorCode::THERMAL_TARGET_BAD;
+        } else if (msg.cycles != config.cycles ||
+                   !relay_autotune::RelayAutotune::valid(config)) {
+            response.with_error =
+                errors::ErrorCode::THERMAL_CONSTANT_OUT_OF_RANGE;
+        } else if (_state.system_status == State::PWM_TEST &&
+                   !end_pwm_test(policy)) {
+            response.with_error = errors::ErrorCode::THERMAL_PELTIER_ERROR;
+        } else {
+            static_cast<void>(_autotune.start(config));
+            _autotune_save = msg.save;
+            reset_peltier_filters();
+            _state.system_status = State::AUTOTUNING;
+        }
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
     template <ThermalPlateExecutionPolicy Policy>
     auto visit_message(const messages::GetThermalPowerMessage& msg,
                        Policy& policy) -> void {
@@ -888,6 +1060,97 @@ class ThermalPlateTask {
         return true;
     }
 
+    /**
+     * @brief Drive the peltiers from the relay autotuner. Call this when the
+     * state is AUTOTUNING and new temperatures have been stored in the
+     * thermistor handles. Once the autotuner stops, the outputs are
+     * disabled and the result is applied and reported.
+     * @param[in] policy The thermal plate policy
+     * @param[in] elapsed_time The amount of time that has passed since the
+     * last thermistor reading, in seconds
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto update_autotune(Policy& policy, Seconds elapsed_time) -> void {
+        auto power = _autotune.update(average_plate_temp(),
+                                      elapsed_time.count());
+        if (!_autotune.running()) {
+            finish_autotune(policy);
+            return;
+        }
+        policy.set_enabled(true);
+        auto ret =
+            set_peltier_power(_peltier_left, power, elapsed_time, policy);
+        if (ret) {
+            ret =
+                set_peltier_power(_peltier_right, power, elapsed_time, policy);
+        }
+        if (ret) {
+            ret =
+                set_peltier_power(_peltier_center, power, elapsed_time, policy);
+        }
+        if (!ret) {
+            policy.set_enabled(false);
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::PELTIER_ERROR;
+            return;
+        }
+        if (!_fans.manual_control &&
+            !policy.set_fan(_plate_control.fan_idle_power())) {
+            policy.set_enabled(false);
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::FAN_ERROR;
+        }
+    }
+
+    /**
+     * @brief Turn off the peltiers after autotuning and either apply the
+     * new PID constants or report the failure to the host.
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto finish_autotune(Policy& policy) -> void {
+        policy.set_enabled(false);
+        reset_peltier_filters();
+        _state.system_status = State::IDLE;
+
+        auto result = _autotune.result();
+        if (!result.has_value()) {
+            auto error = messages::HostCommsMessage(messages::ErrorMessage{
+                .code = errors::ErrorCode::THERMAL_AUTOTUNE_FAILED});
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(error));
+            return;
+        }
+        auto constants = eeprom::PIDConstants{.kp = result.value().kp,
+                                              .ki = result.value().ki,
+                                              .kd = result.value().kd};
+        set_peltier_pid(constants.kp, constants.ki, constants.kd);
+        auto event = messages::PlateAutotuneEvent{
+            .kp = constants.kp, .ki = constants.ki, .kd = constants.kd};
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(event));
+        if (_autotune_save &&
+            !_eeprom.write_pid_constants(constants, policy)) {
+            auto error = messages::HostCommsMessage(messages::ErrorMessage{
+                .code = errors::ErrorCode::SYSTEM_EEPROM_ERROR});
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(error));
+        }
+    }
+
+    /**
+     * All peltiers share the same PID constants. This replaces the whole
+     * gain schedule and applies the constants immediately.
+     */
+    auto set_peltier_pid(double kp, double ki, double kd) -> void {
+        static_cast<void>(_plate_control.set_gains(
+            std::nullopt, std::nullopt,
+            PIDGains{.kp = kp, .ki = ki, .kd = kd}));
+        _peltier_right.pid = PID(kp, ki, kd, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
+        _peltier_left.pid = PID(kp, ki, kd, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
+        _peltier_center.pid =
+            PID(kp, ki, kd, CONTROL_PERIOD_SECONDS, 1.0, -1.0);
+    }
+
     /**
      * @brief Updates the power of a peltier, and intended to be called for
      * closed-loop control. Accepts a power setting, applies a small filter,
@@ -982,6 +1245,75 @@ class ThermalPlateTask {
         return (const_a * heatsink_temp) + ((1.0F + const_b) * temp) + const_c;
     }
 
+    /**
+     * @brief Turn off every peltier to leave the PWM test mode before
+     * starting closed-loop control. On failure, the task is moved into
+     * the error state.
+     * @return True if the peltiers were all turned off
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto end_pwm_test(Policy& policy) -> bool {
+        auto ret = policy.set_peltier(_peltier_left.id, 0.0F,
+                                      PeltierDirection::PELTIER_HEATING);
+        if (ret) {
+            ret = policy.set_peltier(_peltier_right.id, 0.0F,
+                                     PeltierDirection::PELTIER_HEATING);
+        }
+        if (ret) {
+            ret = policy.set_peltier(_peltier_center.id, 0.0F,
+                                     PeltierDirection::PELTIER_HEATING);
+        }
+        reset_peltier_filters();
+        if (!ret) {
+            policy.set_enabled(false);
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::PELTIER_ERROR;
+        }
+        return ret;
+    }
+
+    auto apply_program_step(const thermal_program::Step& step) -> bool {
+        double volume_ul =
+            (step.volume < 0.0F) ? DEFAULT_VOLUME_UL : step.volume;
+        return _plate_control.set_new_target(step.temperature, volume_ul,
+                                             step.hold_time, step.ramp_rate,
+                                             _program.feed_forward());
+    }
+
+    /**
+     * @brief If a thermal program is running and the hold of its current
+     * step is over, move on to the next step and tell the host. Call this
+     * after each control update.
+     */
+    auto advance_program() -> void {
+        if (!_program.running() || !_plate_control.hold_complete()) {
+            return;
+        }
+        auto next = _program.step_complete();
+        if (next.has_value()) {
+            static_cast<void>(apply_program_step(next.value()));
+            send_program_event(next.value());
+        } else {
+            auto event = messages::ThermalProgramStepEvent{
+                .step = static_cast<uint32_t>(_program.step_index()),
+                .executed = _program.steps_executed(),
+                .target = _plate_control.setpoint(),
+                .finished = true};
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(event));
+        }
+    }
+
+    auto send_program_event(const thermal_program::Step& step) -> void {
+        auto event = messages::ThermalProgramStepEvent{
+            .step = static_cast<uint32_t>(_program.step_index()),
+            .executed = _program.steps_executed(),
+            .target = step.temperature,
+            .finished = false};
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(event));
+    }
+
     auto reset_peltier_filters() {
         _peltier_left.filter.reset();
         _peltier_right.filter.reset();
@@ -1001,6 +1333,9 @@ class ThermalPlateTask {
     eeprom::Eeprom<EEPROM_PAGES, EEPROM_ADDRESS> _eeprom;
     eeprom::OffsetConstants _offset_constants;
     Milliseconds _last_update;
+    thermal_program::ThermalProgram _program;
+    relay_autotune::RelayAutotune _autotune;
+    bool _autotune_save;
 };
 
 }  // namespace thermal_plate_task
@@ -0,0 +1,186 @@
+/**
+ * @file thermal_program.hpp
+ * @brief On-device sequencing of thermal cycling programs.
+ * @details A thermal program is a list of steps, each of which drives the
+ * plate to a temperature and then holds it there for a fixed time. Any step
+ * can also close a loop, jumping back to an earlier step a fixed number of
+ * times, which is how the repeated denature/anneal/extend stages of a PCR
+ * cycle are expressed. The program is uploaded one step at a time and then
+ * executed by the thermal plate task, so step timing doesn't depend on the
+ * host sending each target at the right moment.
+ *
+ * This class only tracks which step is active; applying each step to the
+ * plate controller and deciding when a step's hold is over are left to the
+ * caller.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace thermal_program {
+
+struct Step {
+    /** Target temperature in ºC.*/
+    double temperature;
+    /** Time to hold at the target, in seconds. A hold of 0 moves on to the
+     *  next step as soon as the target is reached.*/
+    double hold_time;
+    /** Ramp rate in ºC/second. A ramp rate of 0 drives to the target as
+     *  fast as possible.*/
+    double ramp_rate;
+    /** Sample volume in µL. A negative volume uses the default volume.*/
+    double volume;
+    /** After this step completes, jump back to this step index...*/
+    uint16_t loop_to = 0;
+    /** ...this many more times. A count of 0 means this step has no loop.*/
+    uint16_t loop_count = 0;
+};
+
+class ThermalProgram {
+  public:
+    static constexpr size_t MAX_STEPS = 32;
+    /** A lid target of 0 leaves the lid heater alone when starting.*/
+    static constexpr double NO_LID_TARGET = 0.0F;
+
+    /**
+     * @brief Set the step at \c index. Steps must be written in order:
+     * \c index may be at most the current step count, and writing a step
+     * discards any steps after it, so uploading a new program starting from
+     * index 0 replaces the old one.
+     *
+     * A loop must jump back to this step or an earlier one, and loops must
+     * nest: a loop may not jump into the middle of an earlier loop. Steps
+     * can't be changed while the program is running.
+     *
+     * @return true if the step was stored
+     */
+    auto set_step(size_t index, const Step& step) -> bool {
+        if (_running || index >= MAX_STEPS || index > _count ||
+            step.temperature <= 0.0F || step.hold_time < 0.0F ||
+            step.ramp_rate < 0.0F) {
+            return false;
+        }
+        if (step.loop_count > 0) {
+            if (step.loop_to > index) {
+                return false;
+            }
+            for (size_t i = step.loop_to; i < index; ++i) {
+                const auto& inner = _steps.at(i);
+                if (inner.loop_count > 0 && inner.loop_to < step.loop_to) {
+                    return false;
+                }
+            }
+        }
+        _steps.at(index) = step;
+        _count = index + 1;
+        return true;
+    }
+
+    auto clear() -> void {
+        _running = false;
+        _count = 0;
+        _index = 0;
+        _executed = 0;
+    }
+
+    auto set_lid_target(double lid_target) -> void { _lid_target = lid_target; }
+    [[nodiscard]] auto lid_target() const -> double { return _lid_target; }
+
+    /** Whether the steps of the program use feed-forward plate control.*/
+    auto set_feed_forward(bool feed_forward) -> void {
+        _feed_forward = feed_forward;
+    }
+    [[nodiscard]] auto feed_forward() const -> bool { return _feed_forward; }
+
+    /**
+     * @brief Begin executing the program from its first step.
+     *
+     * @return The first step, which the caller should apply, or nothing if
+     * there are no steps to run
+     */
+    auto start() -> std::optional<Step> {
+        if (_count == 0) {
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < _count; ++i) {
+            _loops_remaining.at(i) = _steps.at(i).loop_count;
+        }
+        _running = true;
+        _index = 0;
+        _executed = 1;
+        return _steps[0];
+    }
+
+    auto stop() -> void { _running = false; }
+
+    /**
+     * @brief Mark the active step as finished and move to the next one,
+     * following the active step's loop if it has any passes left.
+     *
+     * @return The next step, which the caller should apply, or nothing if
+     * the program just finished. A finished program leaves the plate at
+     * the temperature of the last step.
+     */
+    auto step_complete() -> std::optional<Step> {
+        if (!_running) {
+            return std::nullopt;
+        }
+        auto& remaining = _loops_remaining.at(_index);
+        if (remaining > 0) {
+            --remaining;
+            _index = _steps.at(_index).loop_to;
+        } else {
+            // Rearm this loop in case an enclosing loop runs it again
+            remaining = _steps.at(_index).loop_count;
+            if (_index + 1 >= _count) {
+                _running = false;
+                return std::nullopt;
+            }
+            ++_index;
+        }
+        ++_executed;
+        return _steps.at(_index);
+    }
+
+    [[nodiscard]] auto running() const -> bool { return _running; }
+    [[nodiscard]] auto step_count() const -> size_t { return _count; }
+    [[nodiscard]] auto step_index() const -> size_t { return _index; }
+    /** Number of steps started since the program began, counting every
+     *  pass through a loop.*/
+    [[nodiscard]] auto steps_executed() const -> uint32_t { return _executed; }
+
+    /**
+     * @brief The number of steps a full run of the program executes,
+     * counting every pass through a loop. Since loops nest, each step runs
+     * once for every combination of passes of the loops that enclose it.
+     */
+    [[nodiscard]] auto total_steps() const -> uint64_t {
+        uint64_t total = 0;
+        for (size_t i = 0; i < _count; ++i) {
+            uint64_t passes = 1;
+            for (size_t j = i; j < _count; ++j) {
+                const auto& step = _steps.at(j);
+                if (step.loop_count > 0 && step.loop_to <= i) {
+                    passes *= static_cast<uint64_t>(step.loop_count) + 1;
+                }
+            }
+            total += passes;
+        }
+        return total;
+    }
+
+  private:
+    std::array<Step, MAX_STEPS> _steps = {};
+    std::array<uint16_t, MAX_STEPS> _loops_remaining = {};
+    size_t _count = 0;
+    size_t _index = 0;
+    uint32_t _executed = 0;
+    double _lid_target = NO_LID_TARGET;
+    bool _feed_forward = false;
+    bool _running = false;
+};
+
+}  // namespace thermal_program
@@ -4,10 +4,14 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <concepts>
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <tuple>
+#include <utility>
 
 #include "core/bit_utils.hpp"
 #include "systemwide.h"
@@ -35,63 +39,54 @@ class TMC2130 {
 
     template <TMC2130Policy Policy>
     auto write_config(Policy& policy) -> bool {
-        if (!set_gconf(_registers.gconfig, policy)) {
-            return false;
-        }
-        if (!set_current_control(_registers.ihold_irun, policy)) {
-            return false;
-        }
-        if (!set_power_down_delay(
-                PowerDownDelay::reg_to_seconds(_registers.tpowerdown.time),
-                policy)) {
-            return false;
-        }
-        if (!set_cool_threshold(_registers.tcoolthrs, policy)) {
-            return false;
-        }
-        if (!set_thigh(_registers.thigh, policy)) {
-            return false;
-        }
-        if (!set_chop_config(_registers.chopconf, policy)) {
-            return false;
-        }
-        if (!set_cool_config(_registers.coolconf, policy)) {
-            return false;
-        }
-        _initialized = true;
-        return true;
+        return write_config(TMC2130RegisterMap(_registers), policy);
     }
 
+    /**
+     * @brief Write a full register configuration to the TMC2130. All of
+     * the registers are sent in a single batch, and any register whose
+     * value matches the last value written to the device is skipped.
+     * @param registers The configuration to write
+     * @param policy Instance of abstraction policy to use
+     * @return True if the configuration was written, false otherwise
+     */
     template <TMC2130Policy Policy>
     auto write_config(const TMC2130RegisterMap& registers, Policy& policy)
         -> bool {
-        if (!set_gconf(registers.gconfig, policy)) {
-            return false;
-        }
-        if (!set_current_control(registers.ihold_irun, policy)) {
-            return false;
-        }
-        if (!set_power_down_delay(
-                PowerDownDelay::reg_to_seconds(registers.tpowerdown.time),
-                policy)) {
-            return false;
-        }
-        if (!set_cool_threshold(registers.tcoolthrs, policy)) {
-            return false;
-        }
-        if (!set_thigh(registers.thigh, policy)) {
+        auto config = sanitize(registers);
+        TransactionBatch batch;
+        queue_write(batch, config.gconfig);
+        queue_write(batch, config.ihold_irun);
+        queue_write(batch, config.tpowerdown);
+        queue_write(batch, config.tcoolthrs);
+        queue_write(batch, config.thigh);
+        queue_write(batch, config.chopconf);
+        queue_write(batch, config.coolconf);
+        if (!_spi.execute(batch, policy)) {
+            // Some subset of the batch may have been written, so the
+            // shadow copy can't be trusted anymore
+            invalidate_shadow();
             return false;
         }
-        if (!set_chop_config(registers.chopconf, policy)) {
-            return false;
-        }
-        if (!set_cool_config(registers.coolconf, policy)) {
-            return false;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            update_shadow(batch.at(i).addr, batch.at(i).value);
         }
+        _registers = config;
         _initialized = true;
         return true;
     }
 
+    /**
+     * @brief Forget the cached copy of the device registers, so that the
+     * next write to each register is always sent. This should be called
+     * if the TMC2130 may have lost its configuration (e.g. a reset).
+     */
+    auto invalidate_shadow() -> void {
+        for (auto& entry : _shadow) {
+            entry.valid = false;
+        }
+    }
+
     /**
      * @brief Check if the TMC2130 has been initialized.
      * @return true if the registers have been written at least once,
@@ -234,6 +229,9 @@ class TMC2130 {
     [[nodiscard]] auto get_gstatus(Policy& policy) -> GStatus {
         auto ret = read_register<GStatus>(policy);
         if (ret.has_value()) {
+            if (ret.value().reset != 0) {
+                invalidate_shadow();
+            }
             return ret.value();
         }
         return GStatus{.driver_error = 1};
@@ -273,6 +271,28 @@ class TMC2130 {
         return read_register<TStep>(policy);
     }
 
+    /**
+     * @brief Read several registers in a single SPI burst.
+     * @tparam Regs The registers to read, in the order they should be
+     * returned.
+     * @return A tuple with the register contents, or nothing if the
+     * registers couldn't be read.
+     */
+    template <ReadableRegister... Regs, TMC2130Policy Policy>
+    requires(TMC2130Register<Regs>&&...)
+    [[nodiscard]] auto read_registers(Policy& policy)
+        -> std::optional<std::tuple<Regs...>> {
+        static_assert(sizeof...(Regs) <= MAX_BATCH_LEN,
+                      "Too many registers for a single batch");
+        TransactionBatch batch;
+        (static_cast<void>(batch.queue_read(Regs::address)), ...);
+        if (!_spi.execute(batch, policy)) {
+            return std::nullopt;
+        }
+        return unpack_batch<Regs...>(
+            batch, std::index_sequence_for<Regs...>{});
+    }
+
     /**
      * @brief Get the register map
      */
@@ -295,13 +315,88 @@ class TMC2130 {
     template <TMC2130Register Reg, TMC2130Policy Policy>
     requires WritableRegister<Reg>
     auto set_register(Policy& policy, Reg reg) -> bool {
+        auto value = serialize(reg);
+        if (shadow_matches(Reg::address, value)) {
+            return true;
+        }
+        if (!_spi.write(Reg::address, value, policy)) {
+            invalidate_shadow();
+            return false;
+        }
+        update_shadow(Reg::address, value);
+        return true;
+    }
+
+    /**
+     * @brief Add a register write to a batch, unless the device already
+     * holds the same value.
+     */
+    template <TMC2130Register Reg>
+    requires WritableRegister<Reg>
+    auto queue_write(TransactionBatch& batch, Reg reg) const -> void {
+        auto value = serialize(reg);
+        if (!shadow_matches(Reg::address, value)) {
+            static_cast<void>(batch.queue_write(Reg::address, value));
+        }
+    }
+
+    template <TMC2130Register Reg>
+    static auto serialize(Reg reg) -> RegisterSerializedType {
         // Ignore the typical linter warning because we're only using
         // this on __packed structures that mimic hardware registers
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
         auto value = *reinterpret_cast<RegisterSerializedTypeA*>(&reg);
-        value &= Reg::value_mask;
-        return _spi.write(Reg::address, value, policy);
+        return value & Reg::value_mask;
     }
+
+    template <TMC2130Register... Regs, size_t... Indices>
+    static auto unpack_batch(const TransactionBatch& batch,
+                             std::index_sequence<Indices...> /*unused*/)
+        -> std::tuple<Regs...> {
+        return std::tuple<Regs...>{
+            deserialize<Regs>(batch.at(Indices).value)...};
+    }
+
+    template <TMC2130Register Reg>
+    static auto deserialize(RegisterSerializedType value) -> Reg {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return *reinterpret_cast<Reg*>(&value);
+    }
+
+    /** Clear any bits that must always be written as 0.*/
+    static auto sanitize(TMC2130RegisterMap registers) -> TMC2130RegisterMap {
+        registers.gconfig.enc_commutation = 0;
+        registers.gconfig.test_mode = 0;
+        registers.ihold_irun.bit_padding_1 = 0;
+        registers.ihold_irun.bit_padding_2 = 0;
+        registers.coolconf.padding_1 = 0;
+        registers.coolconf.padding_2 = 0;
+        registers.coolconf.padding_3 = 0;
+        registers.coolconf.padding_4 = 0;
+        return registers;
+    }
+
+    [[nodiscard]] auto shadow_matches(Registers addr,
+                                      RegisterSerializedType value) const
+        -> bool {
+        return std::any_of(_shadow.cbegin(), _shadow.cend(),
+                           [addr, value](const ShadowEntry& entry) {
+                               return entry.valid && entry.addr == addr &&
+                                      entry.value == value;
+                           });
+    }
+
+    auto update_shadow(Registers addr, RegisterSerializedType value)
+        -> void {
+        for (auto& entry : _shadow) {
+            if (entry.addr == addr) {
+                entry.value = value;
+                entry.valid = true;
+                return;
+            }
+        }
+    }
+
     /**
      * @brief Read a register on the TMC2130
      *
@@ -319,13 +414,28 @@ class TMC2130 {
         if (!ret.has_value()) {
             return RT();
         }
-        // Ignore the typical linter warning because we're only using
-        // this on __packed structures that mimic hardware registers
-        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-        return RT(*reinterpret_cast<Reg*>(&ret.value()));
+        return RT(deserialize<Reg>(ret.value()));
     }
 
+    /** Cached copy of the last value written to a register.*/
+    struct ShadowEntry {
+        Registers addr;
+        RegisterSerializedType value;
+        bool valid;
+    };
+
     TMC2130RegisterMap _registers = {};
+    std::array<ShadowEntry, 7> _shadow = {
+        ShadowEntry{.addr = GConfig::address, .value = 0, .valid = false},
+        ShadowEntry{
+            .addr = CurrentControl::address, .value = 0, .valid = false},
+        ShadowEntry{
+            .addr = PowerDownDelay::address, .value = 0, .valid = false},
+        ShadowEntry{
+            .addr = TCoolThreshold::address, .value = 0, .valid = false},
+        ShadowEntry{.addr = THigh::address, .value = 0, .valid = false},
+        ShadowEntry{.addr = ChopConfig::address, .value = 0, .valid = false},
+        ShadowEntry{.addr = CoolConfig::address, .value = 0, .valid = false}};
     TMC2130Interface _spi = {};
     bool _initialized;
 };
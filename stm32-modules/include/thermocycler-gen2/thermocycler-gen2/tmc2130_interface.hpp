@@ -5,7 +5,9 @@
  */
 #pragma once
 
+#include <array>
 #include <optional>
+#include <span>
 
 #include "thermocycler-gen2/tmc2130_registers.hpp"
 
@@ -16,6 +18,9 @@ static constexpr size_t MESSAGE_LEN = 5;
 // The type of a single TMC2130 message.
 using MessageT = std::array<uint8_t, MESSAGE_LEN>;
 
+// Maximum number of register accesses that can be queued in one batch
+static constexpr size_t MAX_BATCH_LEN = 8;
+
 // Flag for whether this is a read or write
 enum class WriteFlag { READ = 0x00, WRITE = 0x80 };
 
@@ -29,6 +34,80 @@ concept TMC2130InterfacePolicy = requires(Policy& p, MessageT& data) {
         } -> std::same_as<std::optional<MessageT>>;
 };
 
+/**
+ * Optional extension to the interface policy. A policy that can clock out
+ * several datagrams back to back (toggling chip select between each one)
+ * should provide this so that batched transactions are sent as a single
+ * burst rather than one blocking transfer per register.
+ */
+template <typename Policy>
+concept TMC2130BurstPolicy =
+    TMC2130InterfacePolicy<Policy> &&
+    requires(Policy& p, std::span<MessageT> tx, std::span<MessageT> rx) {
+    { p.tmc2130_transmit_receive_burst(tx, rx) } -> std::same_as<bool>;
+};
+
+/** A single register access queued in a TransactionBatch.*/
+struct BatchEntry {
+    Registers addr = Registers::GCONF;
+    WriteFlag mode = WriteFlag::READ;
+    // For writes, the value to write. For reads, the value that was read
+    // once the batch has been executed.
+    RegisterSerializedType value = 0;
+};
+
+/**
+ * @brief Holds a list of register reads and writes that should be
+ * executed together in one SPI burst.
+ */
+class TransactionBatch {
+  public:
+    /**
+     * @brief Queue a write to a register
+     * @return True if the write was queued, false if the batch is full
+     */
+    auto queue_write(Registers addr, RegisterSerializedType value) -> bool {
+        return queue(BatchEntry{
+            .addr = addr, .mode = WriteFlag::WRITE, .value = value});
+    }
+
+    /**
+     * @brief Queue a read from a register. The result is available
+     * through \c at() once the batch has been executed.
+     * @return True if the read was queued, false if the batch is full
+     */
+    auto queue_read(Registers addr) -> bool {
+        return queue(
+            BatchEntry{.addr = addr, .mode = WriteFlag::READ, .value = 0});
+    }
+
+    [[nodiscard]] auto size() const -> size_t { return _count; }
+
+    [[nodiscard]] auto empty() const -> bool { return _count == 0; }
+
+    auto clear() -> void { _count = 0; }
+
+    [[nodiscard]] auto at(size_t index) -> BatchEntry& {
+        return _entries.at(index);
+    }
+
+    [[nodiscard]] auto at(size_t index) const -> const BatchEntry& {
+        return _entries.at(index);
+    }
+
+  private:
+    auto queue(BatchEntry entry) -> bool {
+        if (_count >= MAX_BATCH_LEN) {
+            return false;
+        }
+        _entries.at(_count++) = entry;
+        return true;
+    }
+
+    std::array<BatchEntry, MAX_BATCH_LEN> _entries = {};
+    size_t _count = 0;
+};
+
 /**
  * @brief Provides SPI access to the TMC2130
  */
@@ -102,12 +181,79 @@ class TMC2130Interface {
         if (!ret.has_value()) {
             return RT();
         }
-        auto* iter = ret.value().begin();
-        std::advance(iter, 1);
+        return RT(parse_response(ret.value()));
+    }
 
+    /**
+     * @brief Execute every access in a batch. If the policy supports
+     * bursts, all of the datagrams are sent in a single transfer.
+     *
+     * The TMC2130 returns the result of a read in the response to the
+     * datagram that \e follows it, so read results are taken from the
+     * next response and a trailing read is sent twice.
+     *
+     * @tparam Policy Type used for bus-level SPI comms
+     * @param[in,out] batch The batch to execute. Read entries are updated
+     * with the values read from the device.
+     * @param[in] policy Instance of \c Policy
+     * @return True on success, false on any error
+     */
+    template <TMC2130InterfacePolicy Policy>
+    auto execute(TransactionBatch& batch, Policy& policy) -> bool {
+        if (batch.empty()) {
+            return true;
+        }
+        std::array<MessageT, MAX_BATCH_LEN + 1> tx{};
+        std::array<MessageT, MAX_BATCH_LEN + 1> rx{};
+        size_t frames = batch.size();
+        for (size_t i = 0; i < frames; ++i) {
+            const auto& entry = batch.at(i);
+            auto msg = build_message(entry.addr, entry.mode, entry.value);
+            if (!msg.has_value()) {
+                return false;
+            }
+            tx.at(i) = msg.value();
+        }
+        if (batch.at(frames - 1).mode == WriteFlag::READ) {
+            tx.at(frames) = tx.at(frames - 1);
+            ++frames;
+        }
+
+        if constexpr (TMC2130BurstPolicy<Policy>) {
+            if (!policy.tmc2130_transmit_receive_burst(
+                    std::span(tx.begin(), frames),
+                    std::span(rx.begin(), frames))) {
+                return false;
+            }
+        } else {
+            for (size_t i = 0; i < frames; ++i) {
+                auto ret = policy.tmc2130_transmit_receive(tx.at(i));
+                if (!ret.has_value()) {
+                    return false;
+                }
+                rx.at(i) = ret.value();
+            }
+        }
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            auto& entry = batch.at(i);
+            if (entry.mode == WriteFlag::READ) {
+                entry.value = parse_response(rx.at(i + 1));
+            }
+        }
+        return true;
+    }
+
+  private:
+    /** Extract the register contents from a response datagram.*/
+    static auto parse_response(const MessageT& response)
+        -> RegisterSerializedType {
+        const auto* iter = response.begin();
+        std::advance(iter, 1);
         RegisterSerializedType retval = 0;
-        iter = bit_utils::bytes_to_int(iter, ret.value().end(), retval);
-        return RT(retval);
+        static_cast<void>(
+            bit_utils::bytes_to_int(iter, response.end(), retval));
+        return retval;
     }
 };
 
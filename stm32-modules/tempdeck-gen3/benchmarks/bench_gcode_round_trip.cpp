@@ -0,0 +1,71 @@
+/**
+ * @file bench_gcode_round_trip.cpp
+ * @brief Replays a gcode stream through the Temperature Deck's tasks
+ * and reports the round trip latency and allocations of each gcode.
+ *
+ * @details Usage: tempdeck-gen3-benchmarks [stream file] [repetitions]
+ */
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "benchmark/gcode_benchmark.hpp"
+#include "tempdeck-gen3/messages.hpp"
+#include "test/test_system_policy.hpp"
+#include "test/test_tasks.hpp"
+#include "test/test_thermal_policy.hpp"
+#include "test/test_ui_policy.hpp"
+
+static constexpr size_t DEFAULT_REPETITIONS = 1000;
+
+auto main(int argc, char* argv[]) -> int {
+    auto path = std::string(argc > 1 ? argv[1] : DEFAULT_STREAM);
+    auto repetitions = argc > 2 ? std::stoul(argv[2]) : DEFAULT_REPETITIONS;
+    auto file = std::ifstream(path);
+    if (!file) {
+        fprintf(stderr, "Could not open %s\n", path.c_str());
+        return 1;
+    }
+    auto stream = gcode_benchmark::load_stream(file);
+
+    auto tasks = std::unique_ptr<tasks::TestTasks>(tasks::BuildTasks());
+    auto system_policy = TestSystemPolicy();
+    auto ui_policy = TestUIPolicy();
+    auto thermal_policy = TestThermalPolicy();
+    auto tx_buf = std::array<char, 1024>();
+    auto run_command = [&](const std::string& line, std::string& response) {
+        static_cast<void>(tasks->_comms_queue.try_send(
+            messages::IncomingMessageFromHost(line.data(),
+                                              line.data() + line.size())));
+        bool any = true;
+        while (any) {
+            any = false;
+            if (tasks->_comms_queue.has_message()) {
+                auto* end =
+                    tasks->_comms_task.run_once(tx_buf.begin(), tx_buf.end());
+                response.append(tx_buf.begin(), end);
+                any = true;
+            }
+            if (tasks->_system_queue.has_message()) {
+                tasks->_system_task.run_once(system_policy);
+                any = true;
+            }
+            if (tasks->_ui_queue.has_message()) {
+                tasks->_ui_task.run_once(ui_policy);
+                any = true;
+            }
+            if (tasks->_thermal_queue.has_message()) {
+                tasks->_thermal_task.run_once(thermal_policy);
+                any = true;
+            }
+        }
+    };
+
+    auto recorder = gcode_benchmark::Recorder();
+    auto failures =
+        gcode_benchmark::replay(stream, repetitions, run_command, recorder);
+    recorder.report("tempdeck-gen3");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+# Synthetic stream, written by hand to resemble a protocol run: the host
+# polls temperatures while setting and clearing plate targets.
+# Replace it with captured host traffic when one is available.
+M115
+M105.D
+M104 S4
+M105.D
+M105.D
+M106 S0.5
+M105.D
+M104 S95
+M105.D
+M105.D
+M107
+M18
+M105.D
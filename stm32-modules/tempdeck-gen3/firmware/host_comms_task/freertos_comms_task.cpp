@@ -8,8 +8,10 @@
 #include <utility>
 
 #include "FreeRTOS.h"
+#include "firmware/firmware_task_stats.hpp"
 #include "firmware/firmware_tasks.hpp"
 #include "firmware/freertos_message_queue.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/usb_hardware.h"
 #include "hal/double_buffer.hpp"
 #include "task.h"
@@ -57,16 +59,27 @@ auto run(tasks::FirmwareTasks::QueueAggregator *aggregator) -> void {
     auto *handle = xTaskGetCurrentTaskHandle();
 
     _comms_queue.provide_handle(handle);
+    freertos_task_registry::register_current_task(tasks::HOST_STACK_SIZE);
     top_task->provide_aggregator(aggregator);
+    top_task->provide_task_stats(&firmware_task_stats::registry());
     aggregator->register_queue(_comms_queue);
+    auto &stats =
+        firmware_task_stats::stats_for(tasks::TaskIndex::HOST_COMMS);
+    auto clock = firmware_task_stats::DWTCycleClock();
 
     usb_hw_init(&cdc_rx_handler, &cdc_init_handler, &cdc_deinit_handler);
     usb_hw_start();
     local_task->committed_rx_buf_ptr = local_task->rx_buf.committed()->data();
     while (true) {
-        char *tx_end =
-            top_task->run_once(local_task->tx_buf.accessible()->begin(),
-                               local_task->tx_buf.accessible()->end());
+        _comms_queue.wait_for_message();
+        char *tx_end = nullptr;
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            tx_end =
+                top_task->run_once(local_task->tx_buf.accessible()->begin(),
+                                   local_task->tx_buf.accessible()->end());
+        }
+        stats.record_queue_depth(_comms_queue.high_water_mark());
         if (!top_task->may_connect()) {
             usb_hw_stop();
         } else if (tx_end != local_task->tx_buf.accessible()->data()) {
@@ -7,6 +7,7 @@
 #include "firmware/freertos_thermistor_task.hpp"
 #include "firmware/freertos_ui_task.hpp"
 #include "firmware/system_stm32g4xx.h"
+#include "firmware/task_stats_hardware.h"
 #include "ot_utils/freertos/freertos_task.hpp"
 #include "task.h"
 
@@ -49,6 +50,7 @@ static auto thermal_task =
 
 auto main() -> int {
     HardwareInit();
+    task_stats_hardware_init();
     host_task.start(tasks::HOST_TASK_PRIORITY, "HostComms", &aggregator);
     system_task.start(tasks::SYSTEM_TASK_PRIORITY, "System", &aggregator);
     ui_task.start(tasks::UI_TASK_PRIORITY, "UI", &aggregator);
@@ -0,0 +1,14 @@
+#include "firmware/firmware_task_stats.hpp"
+
+namespace firmware_task_stats {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static auto _registry = tasks::TaskStatsRegistry(tasks::TASK_NAMES);
+
+auto registry() -> tasks::TaskStatsRegistry& { return _registry; }
+
+auto stats_for(tasks::TaskIndex task) -> task_stats::TaskStats& {
+    return tasks::task_stats_for(_registry, task);
+}
+
+}  // namespace firmware_task_stats
@@ -1,5 +1,7 @@
 #include "firmware/freertos_system_task.hpp"
 
+#include "firmware/firmware_task_stats.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/system_policy.hpp"
 #include "tempdeck-gen3/system_task.hpp"
 
@@ -21,12 +23,21 @@ static auto _top_task = system_task::SystemTask(_queue, nullptr);
 auto run(tasks::FirmwareTasks::QueueAggregator* aggregator) -> void {
     auto* handle = xTaskGetCurrentTaskHandle();
     _queue.provide_handle(handle);
+    freertos_task_registry::register_current_task(tasks::SYSTEM_STACK_SIZE);
+    freertos_task_registry::register_kernel_tasks();
     aggregator->register_queue(_queue);
     _top_task.provide_aggregator(aggregator);
 
     auto policy = SystemPolicy();
+    auto& stats = firmware_task_stats::stats_for(tasks::TaskIndex::SYSTEM);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        _top_task.run_once(policy);
+        _queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            _top_task.run_once(policy);
+        }
+        stats.record_queue_depth(_queue.high_water_mark());
     }
 }
 
@@ -0,0 +1,73 @@
+#include "firmware/freertos_task_registry.hpp"
+
+#include <malloc.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+// Boundaries of the static RAM sections, from the linker script
+extern "C" {
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern uint32_t _sdata;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern uint32_t _edata;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern uint32_t _sbss;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern uint32_t _ebss;
+}
+
+namespace freertos_task_registry {
+
+using Registry = task_memory::TaskRegistry<TaskHandle_t, MAX_TASKS>;
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static auto _registry = Registry();
+
+static auto register_task(TaskHandle_t handle, uint32_t stack_words)
+    -> void {
+    configASSERT(handle != nullptr);
+    taskENTER_CRITICAL();
+    auto added = _registry.add(handle, stack_words);
+    taskEXIT_CRITICAL();
+    configASSERT(added);
+}
+
+auto register_current_task(uint32_t stack_words) -> void {
+    register_task(xTaskGetCurrentTaskHandle(), stack_words);
+}
+
+auto register_kernel_tasks() -> void {
+    // Both stacks are handed out by freertos_idle_timer_task.cpp
+    register_task(xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+    register_task(xTimerGetTimerDaemonTaskHandle(), configMINIMAL_STACK_SIZE);
+}
+
+auto task_count() -> size_t { return _registry.count(); }
+
+auto stack_usage(size_t index) -> task_memory::StackUsage {
+    const auto& entry = _registry.at(index);
+    return task_memory::StackUsage{
+        .name = pcTaskGetName(entry.handle),
+        .size_words = entry.stack_words,
+        .min_free_words = static_cast<uint32_t>(
+            uxTaskGetStackHighWaterMark(entry.handle))};
+}
+
+static auto section_bytes(const uint32_t* start, const uint32_t* end)
+    -> uint32_t {
+    return static_cast<uint32_t>(end - start) * sizeof(uint32_t);
+}
+
+auto ram_usage() -> task_memory::RamUsage {
+    // The C heap only grows, so its arena is the most it has ever needed
+    auto heap = mallinfo();
+    return task_memory::RamUsage{
+        .data_bytes = section_bytes(&_sdata, &_edata),
+        .bss_bytes = section_bytes(&_sbss, &_ebss),
+        .heap_peak_bytes = static_cast<uint32_t>(heap.arena),
+        .heap_used_bytes = static_cast<uint32_t>(heap.uordblks)};
+}
+
+}  // namespace freertos_task_registry
@@ -0,0 +1,50 @@
+#include "firmware/system_backup_flash.h"
+
+#include "stm32g4xx_hal.h"
+#include "stm32g4xx_hal_def.h"
+#include "stm32g4xx_hal_flash.h"
+#include "stm32g4xx_hal_flash_ex.h"
+
+// The backup partition directly follows the application
+static const uint32_t BACKUP_ADDRESS =
+    BACKUP_FLASH_APPLICATION_ADDRESS + BACKUP_FLASH_SIZE;
+static const uint32_t BACKUP_FIRST_PAGE =
+    (BACKUP_ADDRESS - FLASH_BASE) / BACKUP_FLASH_PAGE_SIZE;
+
+bool system_backup_flash_erase_page(uint32_t page) {
+    if (page >= BACKUP_FLASH_SIZE / BACKUP_FLASH_PAGE_SIZE) {
+        return false;
+    }
+    FLASH_EraseInitTypeDef pageToErase = {
+        .TypeErase = FLASH_TYPEERASE_PAGES,
+        .Banks = FLASH_BANK_1,
+        .Page = BACKUP_FIRST_PAGE + page,
+        .NbPages = 1};
+    uint32_t pageErrorPtr = 0;
+
+    HAL_StatusTypeDef status = HAL_FLASH_Unlock();
+    if (status == HAL_OK) {
+        status = HAL_FLASHEx_Erase(&pageToErase, &pageErrorPtr);
+        // Safe to drop status because this always succeeds
+        (void) HAL_FLASH_Lock();
+    }
+    return (status == HAL_OK);
+}
+
+bool system_backup_flash_program(uint32_t offset, uint64_t value) {
+    if (offset >= BACKUP_FLASH_SIZE || (offset % sizeof(value)) != 0) {
+        return false;
+    }
+    HAL_StatusTypeDef status = HAL_FLASH_Unlock();
+    if (status == HAL_OK) {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD,
+                                   BACKUP_ADDRESS + offset, value);
+        // Safe to drop status because this always succeeds
+        (void) HAL_FLASH_Lock();
+    }
+    return (status == HAL_OK);
+}
+
+uint64_t system_backup_flash_read(uint32_t offset) {
+    return *(uint64_t*)(BACKUP_ADDRESS + offset);
+}
@@ -58,3 +58,7 @@ void system_hardware_enter_bootloader(void) {
         : "r" (*sysmem_boot_loc)
         : "memory"  );
 }
+
+void system_hardware_reset(void) {
+    NVIC_SystemReset();
+}
@@ -4,6 +4,8 @@
 #include <iterator>
 #include <ranges>
 
+#include "firmware/freertos_task_registry.hpp"
+#include "firmware/system_backup_flash.h"
 #include "firmware/system_hardware.h"
 #include "firmware/system_serial_number.h"
 #include "tempdeck-gen3/errors.hpp"
@@ -13,6 +15,9 @@ auto SystemPolicy::enter_bootloader() -> void {
     system_hardware_enter_bootloader();
 }
 
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::system_reset() -> void { system_hardware_reset(); }
+
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto SystemPolicy::set_serial_number(
     std::array<char, SYSTEM_SERIAL_NUMBER_LENGTH> system_serial_number)
@@ -57,3 +62,39 @@ auto SystemPolicy::get_serial_number()
     }
     return serial_number_array;
 }
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::backup_layout() const -> firmware_update::Layout {
+    return BACKUP_LAYOUT;
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::backup_erase_page(uint32_t page) -> bool {
+    return system_backup_flash_erase_page(page);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::backup_program(uint32_t offset, uint64_t value) -> bool {
+    return system_backup_flash_program(offset, value);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::backup_read(uint32_t offset) -> uint64_t {
+    return system_backup_flash_read(offset);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::get_task_count() const -> size_t {
+    return freertos_task_registry::task_count();
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::get_stack_usage(size_t index) const
+    -> task_memory::StackUsage {
+    return freertos_task_registry::stack_usage(index);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto SystemPolicy::get_ram_usage() const -> task_memory::RamUsage {
+    return freertos_task_registry::ram_usage();
+}
@@ -1,5 +1,7 @@
 #include "firmware/freertos_thermal_task.hpp"
 
+#include "firmware/firmware_task_stats.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/i2c_hardware.h"
 #include "firmware/tachometer_hardware.h"
 #include "firmware/thermal_hardware.h"
@@ -24,6 +26,7 @@ static auto _top_task = thermal_task::ThermalTask(_queue, nullptr);
 auto run(tasks::FirmwareTasks::QueueAggregator* aggregator) -> void {
     auto* handle = xTaskGetCurrentTaskHandle();
     _queue.provide_handle(handle);
+    freertos_task_registry::register_current_task(tasks::THERMAL_STACK_SIZE);
     aggregator->register_queue(_queue);
     _top_task.provide_aggregator(aggregator);
 
@@ -32,8 +35,15 @@ auto run(tasks::FirmwareTasks::QueueAggregator* aggregator) -> void {
     tachometer_hardware_init();
 
     auto policy = thermal_policy::ThermalPolicy();
+    auto& stats = firmware_task_stats::stats_for(tasks::TaskIndex::THERMAL);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        _top_task.run_once(policy);
+        _queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            _top_task.run_once(policy);
+        }
+        stats.record_queue_depth(_queue.high_water_mark());
     }
 }
 
@@ -1,6 +1,8 @@
 #include "firmware/freertos_thermistor_task.hpp"
 
 #include "FreeRTOS.h"
+#include "firmware/firmware_task_stats.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/i2c_hardware.h"
 #include "firmware/internal_adc_hardware.h"
 #include "firmware/thermistor_hardware.h"
@@ -24,6 +26,8 @@ auto run(tasks::FirmwareTasks::QueueAggregator* aggregator) -> void {
     static_assert(configTICK_RATE_HZ == 1000,
                   "FreeRTOS tickrate must be at 1000 Hz");
 
+    freertos_task_registry::register_current_task(
+        tasks::THERMISTOR_STACK_SIZE);
     thermistor_hardware_init();
     i2c_hardware_init();
     internal_adc_init();
@@ -31,12 +35,20 @@ auto run(tasks::FirmwareTasks::QueueAggregator* aggregator) -> void {
     // Thermistor task has no queue, just need to provide aggregator handle
     _top_task.provide_aggregator(aggregator);
 
+    static constexpr uint32_t US_PER_MS = 1000;
+    static constexpr uint32_t PERIOD_US =
+        decltype(_top_task)::THERMISTOR_READ_PERIOD_MS * US_PER_MS;
+    auto& stats = firmware_task_stats::stats_for(tasks::TaskIndex::THERMISTOR);
+    auto clock = firmware_task_stats::DWTCycleClock();
+
     auto policy = ThermistorPolicy();
     auto last_wake_time = xTaskGetTickCount();
     while (true) {
         internal_adc_start_readings();
         vTaskDelayUntil(&last_wake_time,
                         decltype(_top_task)::THERMISTOR_READ_PERIOD_MS);
+        stats.record_wakeup(PERIOD_US, clock);
+        auto measure = task_stats::Measurement(stats, clock);
         _top_task.run_once(policy);
     }
 }
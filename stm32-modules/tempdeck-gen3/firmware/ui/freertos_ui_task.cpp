@@ -1,5 +1,7 @@
 #include "firmware/freertos_ui_task.hpp"
 
+#include "firmware/firmware_task_stats.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/i2c_hardware.h"
 #include "firmware/ui_hardware.h"
 #include "firmware/ui_policy.hpp"
@@ -33,6 +35,7 @@ static auto _ui_timer = ot_utils::freertos_timer::FreeRTOSTimer(
 auto run(tasks::FirmwareTasks::QueueAggregator* aggregator) -> void {
     auto* handle = xTaskGetCurrentTaskHandle();
     _queue.provide_handle(handle);
+    freertos_task_registry::register_current_task(tasks::UI_STACK_SIZE);
     aggregator->register_queue(_queue);
     _top_task.provide_aggregator(aggregator);
 
@@ -41,8 +44,15 @@ auto run(tasks::FirmwareTasks::QueueAggregator* aggregator) -> void {
 
     auto policy = UIPolicy();
     _ui_timer.start();
+    auto& stats = firmware_task_stats::stats_for(tasks::TaskIndex::UI);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        _top_task.run_once(policy);
+        _queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            _top_task.run_once(policy);
+        }
+        stats.record_queue_depth(_queue.high_water_mark());
     }
 }
 
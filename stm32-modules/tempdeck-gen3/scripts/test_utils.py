@@ -273,6 +273,24 @@ class Tempdeck():
         send = f'M301 P{kp} I{ki} D{kd}\n'
         self._send_and_recv(send, 'M301 OK')
 
+    _AUTOTUNE_RE = re.compile('^async M303 DONE P:(?P<kp>.+) I:(?P<ki>.+) D:(?P<kd>.+) OK\n')
+
+    def autotune(self, target: float, cycles: int = 4) -> Tuple[float, float, float]:
+        '''
+        Run a relay autotune around `target` and wait for it to finish.
+        The new constants replace every zone of the gain schedule and
+        are returned as a tuple of [kp, ki, kd]
+        '''
+        self._send_and_recv(f'M303 S{target} C{cycles}\n', 'M303 OK')
+        res = ''
+        while not res.startswith('async M303'):
+            res = self._ser.readline().decode()
+            if res.startswith('ERR'):
+                raise RuntimeError(res)
+        match = re.match(self._AUTOTUNE_RE, res)
+        return (float(match.group('kp')), float(match.group('ki')),
+                float(match.group('kd')))
+
     def set_offsets(self, a: float = None, b: float = None, c: float = None):
         '''
         Set the offset constants. If any constants are not provided (left as
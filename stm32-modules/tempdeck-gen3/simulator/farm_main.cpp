@@ -0,0 +1,113 @@
+/**
+ * @file farm_main.cpp
+ * @brief Runs several simulated Temperature Modules in one process.
+ *
+ * @details Every instance gets its own tasks, thermal plant, socket and
+ * serial number, and its tasks are registered with one of the schedulers of
+ * a shared \ref sim_farm::Farm. Only the socket readers get a thread per
+ * instance.
+ */
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simulator/cli_parser.hpp"
+#include "simulator/sim_driver.hpp"
+#include "simulator/sim_farm.hpp"
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_thermal_plant.hpp"
+#include "simulator/simulator_tasks.hpp"
+#include "simulator/socket_sim_driver.hpp"
+#include "simulator/thermal_network.hpp"
+
+struct Instance {
+    std::shared_ptr<sim_driver::SimDriver> driver;
+    sim_scheduler::Scheduler* scheduler;
+    std::shared_ptr<tasks::SimTasks::HostCommsQueue> comms_queue;
+    std::shared_ptr<tasks::SimTasks::SystemQueue> system_queue;
+    std::shared_ptr<tasks::SimTasks::UIQueue> ui_queue;
+    std::shared_ptr<tasks::SimTasks::ThermalQueue> thermal_queue;
+    std::shared_ptr<tasks::SimTasks::QueueAggregator> aggregator;
+};
+
+static auto build_instance(sim_scheduler::Scheduler& scheduler,
+                           thermal_network::ThermalNetwork network,
+                           std::shared_ptr<sim_driver::SimDriver> driver,
+                           const std::string& serial_var_name) -> Instance {
+    auto instance = Instance{
+        .driver = std::move(driver),
+        .scheduler = &scheduler,
+        .comms_queue = std::make_shared<tasks::SimTasks::HostCommsQueue>(),
+        .system_queue = std::make_shared<tasks::SimTasks::SystemQueue>(),
+        .ui_queue = std::make_shared<tasks::SimTasks::UIQueue>(),
+        .thermal_queue = std::make_shared<tasks::SimTasks::ThermalQueue>(),
+        .aggregator = nullptr};
+    instance.aggregator = std::make_shared<tasks::SimTasks::QueueAggregator>(
+        *instance.comms_queue, *instance.system_queue, *instance.ui_queue,
+        *instance.thermal_queue);
+    tasks::schedule_tasks(
+        scheduler, instance.comms_queue, instance.system_queue,
+        instance.ui_queue, instance.thermal_queue, instance.aggregator,
+        instance.driver, std::make_shared<SimThermalPlant>(std::move(network)),
+        std::make_shared<tasks::TaskStatsRegistry>(tasks::TASK_NAMES),
+        serial_var_name.c_str());
+    return instance;
+}
+
+auto main(int argc, char* argv[]) -> int {
+    auto options = cli_parser::get_farm_options(argc, argv);
+
+    auto network = thermal_network::load_from_environment(
+        "THERMAL_NETWORK_FILE", DEFAULT_THERMAL_NETWORK);
+    if (!network.has_value()) {
+        return 1;
+    }
+
+    auto farm = sim_farm::Farm(options.threads, options.realtime);
+    auto instances = std::vector<Instance>();
+    for (size_t i = 0; i < options.instances; ++i) {
+        auto url = sim_farm::instance_url(options.socket, i);
+        if (!url.has_value()) {
+            std::cerr << "Malformed url." << std::endl;
+            return 1;
+        }
+        instances.push_back(build_instance(
+            farm.next_scheduler(), network.value(),
+            std::make_shared<socket_sim_driver::SocketSimDriver>(
+                url.value(), options.log_socket),
+            sim_farm::instance_variable("SERIAL_NUMBER", i)));
+    }
+    std::cout << "Simulating " << instances.size()
+              << " Temperature Modules on " << farm.threads() << " threads"
+              << std::endl;
+
+    farm.start();
+    {
+        // Each reader returns when its connection is closed, without
+        // taking the other instances down with it
+        auto readers = std::vector<std::jthread>();
+        for (size_t i = 0; i < instances.size(); ++i) {
+            readers.emplace_back([i, &instance = instances[i]]() {
+                // The scheduler hands each line to the instance's comms
+                // task from its own thread
+                auto send_to_comms =
+                    [&instance](messages::IncomingMessageFromHost& msg) {
+                        tasks::post_to_comms(*instance.scheduler,
+                                             instance.aggregator, msg);
+                    };
+                try {
+                    instance.driver->read(std::move(send_to_comms));
+                } catch (const std::exception& e) {
+                    std::cerr << "Instance " << i
+                              << " disconnected: " << e.what() << std::endl;
+                }
+            });
+        }
+    }
+    farm.stop();
+
+    return 0;
+}
@@ -1,10 +1,25 @@
+#include <cstdint>
+#include <vector>
+
 #include "simulator/cli_parser.hpp"
 #include "simulator/sim_driver.hpp"
+#include "simulator/sim_scheduler.hpp"
+#include "simulator/sim_thermal_plant.hpp"
 #include "simulator/simulator_tasks.hpp"
+#include "simulator/thermal_network.hpp"
 
 auto main(int argc, char* argv[]) -> int {
     auto cli_ret = cli_parser::get_sim_driver(argc, argv);
     auto sim_driver = cli_ret.first;
+    auto realtime =
+        cli_ret.second || cli_parser::check_realtime_environment_variable();
+
+    auto network = thermal_network::load_from_environment(
+        "THERMAL_NETWORK_FILE", DEFAULT_THERMAL_NETWORK);
+    if (!network.has_value()) {
+        return 1;
+    }
+    auto plant = std::make_shared<SimThermalPlant>(std::move(network.value()));
 
     auto comms_queue = std::make_shared<tasks::SimTasks::HostCommsQueue>();
     auto system_queue = std::make_shared<tasks::SimTasks::SystemQueue>();
@@ -13,35 +28,54 @@ auto main(int argc, char* argv[]) -> int {
 
     auto aggregator = std::make_shared<tasks::SimTasks::QueueAggregator>(
         *comms_queue, *system_queue, *ui_queue, *thermal_queue);
+    auto stats = std::make_shared<tasks::TaskStatsRegistry>(tasks::TASK_NAMES);
+
+    auto threads = std::vector<std::unique_ptr<std::jthread>>();
+    auto scheduler = sim_scheduler::Scheduler();
+    if (realtime) {
+        threads.push_back(std::make_unique<std::jthread>(
+            tasks::run_comms_task, comms_queue, aggregator, sim_driver, stats));
+        threads.push_back(std::make_unique<std::jthread>(
+            tasks::run_system_task, system_queue, aggregator, stats));
+        threads.push_back(std::make_unique<std::jthread>(
+            tasks::run_ui_task, ui_queue, aggregator, stats));
+        threads.push_back(std::make_unique<std::jthread>(
+            tasks::run_thermal_task, thermal_queue, aggregator, plant, stats));
+        threads.push_back(std::make_unique<std::jthread>(
+            tasks::run_thermistor_task, aggregator, plant, realtime, stats));
+    } else {
+        // In simulated time every task runs from one scheduler thread on a
+        // virtual clock, rather than from its own thread
+        tasks::schedule_tasks(scheduler, comms_queue, system_queue, ui_queue,
+                              thermal_queue, aggregator, sim_driver, plant,
+                              stats);
+        threads.push_back(std::make_unique<std::jthread>(
+            [&scheduler](std::stop_token st) { scheduler.run(st); }));
+    }
 
-    auto comms = std::make_unique<std::jthread>(
-        tasks::run_comms_task, comms_queue, aggregator, sim_driver);
-    auto system = std::make_unique<std::jthread>(tasks::run_system_task,
-                                                 system_queue, aggregator);
-    auto ui = std::make_unique<std::jthread>(tasks::run_ui_task, ui_queue,
-                                             aggregator);
-    auto thermal = std::make_unique<std::jthread>(tasks::run_thermal_task,
-                                                  thermal_queue, aggregator);
-    auto thermistor =
-        std::make_unique<std::jthread>(tasks::run_thermistor_task, aggregator);
-
-    auto send_to_comms = [&aggregator](messages::IncomingMessageFromHost& msg) {
-        aggregator->send(msg);
-    };
-    sim_driver->read(std::move(send_to_comms));
+    if (realtime) {
+        // Wait for space rather than dropping commands from a fast host
+        sim_driver->read(
+            [&aggregator](messages::IncomingMessageFromHost& msg) {
+                static constexpr uint32_t SEND_TIMEOUT_MS = 1000;
+                static_cast<void>(aggregator->send(msg, SEND_TIMEOUT_MS));
+            });
+    } else {
+        // The scheduler hands each line to the comms task from its own
+        // thread, so a run doesn't depend on when lines arrive
+        sim_driver->read([&scheduler, &aggregator](
+                             messages::IncomingMessageFromHost& msg) {
+            tasks::post_to_comms(scheduler, aggregator, msg);
+        });
+    }
 
     // Previous line returns when connection is closed
-    comms->request_stop();
-    system->request_stop();
-    ui->request_stop();
-    thermal->request_stop();
-    thermistor->request_stop();
-
-    comms->join();
-    system->join();
-    ui->join();
-    thermal->join();
-    thermistor->join();
+    for (auto& thread : threads) {
+        thread->request_stop();
+    }
+    for (auto& thread : threads) {
+        thread->join();
+    }
 
     return 0;
 }
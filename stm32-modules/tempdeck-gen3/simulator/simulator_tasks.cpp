@@ -1,9 +1,11 @@
 #include "simulator/simulator_tasks.hpp"
 
+#include "simulator/sim_cycle_clock.hpp"
 #include "simulator/sim_system_policy.hpp"
 #include "simulator/sim_thermal_policy.hpp"
 #include "simulator/sim_thermistor_policy.hpp"
 #include "simulator/sim_ui_policy.hpp"
+#include "simulator/simulator_utils.hpp"
 #include "tempdeck-gen3/host_comms_task.hpp"
 #include "tempdeck-gen3/system_task.hpp"
 #include "tempdeck-gen3/thermal_task.hpp"
@@ -12,18 +14,41 @@
 
 using namespace tasks;
 
+using Clock = sim_cycle_clock::SteadyCycleClock;
+
+// Populate the serial number on startup, if provided
+static auto load_serial_number(SimSystemPolicy &policy,
+                               const char *serial_var_name) -> void {
+    auto ret =
+        simulator_utils::get_serial_number<SYSTEM_WIDE_SERIAL_NUMBER_LENGTH>(
+            serial_var_name);
+    if (ret.has_value()) {
+        static_cast<void>(policy.set_serial_number(ret.value()));
+    }
+}
+
 auto tasks::run_comms_task(
     std::stop_token st, std::shared_ptr<SimTasks::HostCommsQueue> queue_ptr,
     std::shared_ptr<SimTasks::QueueAggregator> aggregator,
-    std::shared_ptr<sim_driver::SimDriver> driver) -> void {
+    std::shared_ptr<sim_driver::SimDriver> driver, SharedTaskStats stats)
+    -> void {
     auto &queue = *queue_ptr;
     auto task = host_comms_task::HostCommsTask(queue, aggregator.get());
+    task.provide_task_stats(stats.get());
+    auto &own_stats = task_stats_for(*stats, TaskIndex::HOST_COMMS);
+    auto clock = Clock();
     std::string buffer(1024, 'c');
 
     queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
-            auto wrote_to = task.run_once(buffer.begin(), buffer.end());
+            queue.wait_for_message();
+            auto wrote_to = buffer.begin();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                wrote_to = task.run_once(buffer.begin(), buffer.end());
+            }
+            own_stats.record_queue_depth(queue.high_water_mark());
             driver->write(std::string(buffer.begin(), wrote_to));
         } catch (const SimTasks::HostCommsQueue::StopDuringMsgWait sdmw) {
             return;
@@ -33,15 +58,24 @@ auto tasks::run_comms_task(
 
 auto tasks::run_system_task(
     std::stop_token st, std::shared_ptr<SimTasks::SystemQueue> queue_ptr,
-    std::shared_ptr<SimTasks::QueueAggregator> aggregator) -> void {
+    std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+    SharedTaskStats stats) -> void {
     auto &queue = *queue_ptr;
     auto policy = SimSystemPolicy();
+    load_serial_number(policy, "SERIAL_NUMBER");
     auto task = system_task::SystemTask(queue, aggregator.get());
+    auto &own_stats = task_stats_for(*stats, TaskIndex::SYSTEM);
+    auto clock = Clock();
 
     queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
-            task.run_once(policy);
+            queue.wait_for_message();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                task.run_once(policy);
+            }
+            own_stats.record_queue_depth(queue.high_water_mark());
         } catch (const SimTasks::SystemQueue::StopDuringMsgWait sdmw) {
             return;
         }
@@ -50,16 +84,23 @@ auto tasks::run_system_task(
 
 auto tasks::run_ui_task(std::stop_token st,
                         std::shared_ptr<SimTasks::UIQueue> queue_ptr,
-                        std::shared_ptr<SimTasks::QueueAggregator> aggregator)
-    -> void {
+                        std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                        SharedTaskStats stats) -> void {
     auto &queue = *queue_ptr;
     auto policy = SimUIPolicy();
     auto task = ui_task::UITask(queue, aggregator.get());
+    auto &own_stats = task_stats_for(*stats, TaskIndex::UI);
+    auto clock = Clock();
 
     queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
-            task.run_once(policy);
+            queue.wait_for_message();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                task.run_once(policy);
+            }
+            own_stats.record_queue_depth(queue.high_water_mark());
         } catch (const SimTasks::UIQueue::StopDuringMsgWait sdmw) {
             return;
         }
@@ -68,15 +109,23 @@ auto tasks::run_ui_task(std::stop_token st,
 
 auto tasks::run_thermal_task(
     std::stop_token st, std::shared_ptr<SimTasks::ThermalQueue> queue_ptr,
-    std::shared_ptr<SimTasks::QueueAggregator> aggregator) -> void {
+    std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+    std::shared_ptr<SimThermalPlant> plant, SharedTaskStats stats) -> void {
     auto &queue = *queue_ptr;
-    auto policy = SimThermalPolicy();
+    auto policy = SimThermalPolicy(std::move(plant));
     auto task = thermal_task::ThermalTask(queue, aggregator.get());
+    auto &own_stats = task_stats_for(*stats, TaskIndex::THERMAL);
+    auto clock = Clock();
 
     queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
-            task.run_once(policy);
+            queue.wait_for_message();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                task.run_once(policy);
+            }
+            own_stats.record_queue_depth(queue.high_water_mark());
         } catch (const SimTasks::ThermalQueue::StopDuringMsgWait sdmw) {
             return;
         }
@@ -84,14 +133,130 @@ auto tasks::run_thermal_task(
 }
 
 auto tasks::run_thermistor_task(
-    std::stop_token st, std::shared_ptr<SimTasks::QueueAggregator> aggregator)
-    -> void {
-    auto policy = SimThermistorPolicy();
-    auto task = thermistor_task::ThermistorTask<SimulatorMessageQueue>(
-        aggregator.get());
+    std::stop_token st, std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+    std::shared_ptr<SimThermalPlant> plant, bool realtime,
+    SharedTaskStats stats) -> void {
+    using ThermistorTask =
+        thermistor_task::ThermistorTask<SimulatorMessageQueue>;
+    static constexpr uint32_t PERIOD_US =
+        ThermistorTask::THERMISTOR_READ_PERIOD_MS * 1000;
+    auto policy = SimThermistorPolicy(std::move(plant), realtime);
+    auto task = ThermistorTask(aggregator.get());
+    auto &own_stats = task_stats_for(*stats, TaskIndex::THERMISTOR);
+    auto clock = Clock();
 
     while (!st.stop_requested()) {
-        policy.sleep_ms(100);
+        policy.sleep_ms(ThermistorTask::THERMISTOR_READ_PERIOD_MS);
+        // Wakeups only keep to a period in real time
+        if (realtime) {
+            own_stats.record_wakeup(PERIOD_US, clock);
+        }
+        auto measure = task_stats::Measurement(own_stats, clock);
         task.run_once(policy);
     }
 }
+
+auto tasks::schedule_tasks(
+    sim_scheduler::Scheduler &scheduler,
+    std::shared_ptr<SimTasks::HostCommsQueue> comms_queue,
+    std::shared_ptr<SimTasks::SystemQueue> system_queue,
+    std::shared_ptr<SimTasks::UIQueue> ui_queue,
+    std::shared_ptr<SimTasks::ThermalQueue> thermal_queue,
+    std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+    std::shared_ptr<sim_driver::SimDriver> driver,
+    std::shared_ptr<SimThermalPlant> plant, SharedTaskStats stats,
+    const char *serial_var_name) -> void {
+    using CommsTask = host_comms_task::HostCommsTask<SimulatorMessageQueue>;
+    using SystemTask = system_task::SystemTask<SimulatorMessageQueue>;
+    using UITask = ui_task::UITask<SimulatorMessageQueue>;
+    using ThermalTask = thermal_task::ThermalTask<SimulatorMessageQueue>;
+    using ThermistorTask =
+        thermistor_task::ThermistorTask<SimulatorMessageQueue>;
+
+    // Handler times are still real time, but wakeups follow the virtual
+    // clock, so no jitter is recorded
+    auto comms = std::make_shared<CommsTask>(*comms_queue, aggregator.get());
+    comms->provide_task_stats(stats.get());
+    auto buffer = std::make_shared<std::string>(1024, 'c');
+    scheduler.add_task(
+        [comms_queue]() { return comms_queue->has_message(); },
+        [comms, buffer, driver, comms_queue,
+         &own_stats = task_stats_for(*stats, TaskIndex::HOST_COMMS), stats]() {
+            auto clock = Clock();
+            auto wrote_to = buffer->begin();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                wrote_to = comms->run_once(buffer->begin(), buffer->end());
+            }
+            own_stats.record_queue_depth(comms_queue->high_water_mark());
+            driver->write(std::string(buffer->begin(), wrote_to));
+        });
+
+    auto system = std::make_shared<SystemTask>(*system_queue, aggregator.get());
+    auto system_policy = std::make_shared<SimSystemPolicy>();
+    load_serial_number(*system_policy, serial_var_name);
+    scheduler.add_task(
+        [system_queue]() { return system_queue->has_message(); },
+        [system, system_policy, system_queue,
+         &own_stats = task_stats_for(*stats, TaskIndex::SYSTEM), stats]() {
+            auto clock = Clock();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                system->run_once(*system_policy);
+            }
+            own_stats.record_queue_depth(system_queue->high_water_mark());
+        });
+
+    auto ui = std::make_shared<UITask>(*ui_queue, aggregator.get());
+    auto ui_policy = std::make_shared<SimUIPolicy>();
+    scheduler.add_task(
+        [ui_queue]() { return ui_queue->has_message(); },
+        [ui, ui_policy, ui_queue,
+         &own_stats = task_stats_for(*stats, TaskIndex::UI), stats]() {
+            auto clock = Clock();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                ui->run_once(*ui_policy);
+            }
+            own_stats.record_queue_depth(ui_queue->high_water_mark());
+        });
+
+    auto thermal =
+        std::make_shared<ThermalTask>(*thermal_queue, aggregator.get());
+    auto thermal_policy = std::make_shared<SimThermalPolicy>(plant);
+    scheduler.add_task(
+        [thermal_queue]() { return thermal_queue->has_message(); },
+        [thermal, thermal_policy, thermal_queue,
+         &own_stats = task_stats_for(*stats, TaskIndex::THERMAL), stats]() {
+            auto clock = Clock();
+            {
+                auto measure = task_stats::Measurement(own_stats, clock);
+                thermal->run_once(*thermal_policy);
+            }
+            own_stats.record_queue_depth(thermal_queue->high_water_mark());
+        });
+
+    auto thermistor = std::make_shared<ThermistorTask>(aggregator.get());
+    auto thermistor_policy = std::make_shared<SimThermistorPolicy>(plant);
+    scheduler.add_periodic(
+        ThermistorTask::THERMISTOR_READ_PERIOD_MS,
+        [thermistor, thermistor_policy,
+         &own_stats = task_stats_for(*stats, TaskIndex::THERMISTOR), stats]() {
+            auto clock = Clock();
+            thermistor_policy->sleep_ms(
+                ThermistorTask::THERMISTOR_READ_PERIOD_MS);
+            auto measure = task_stats::Measurement(own_stats, clock);
+            thermistor->run_once(*thermistor_policy);
+        });
+}
+
+auto tasks::post_to_comms(sim_scheduler::Scheduler &scheduler,
+                          std::shared_ptr<SimTasks::QueueAggregator> aggregator,
+                          const messages::IncomingMessageFromHost &msg)
+    -> void {
+    scheduler.post_line(msg.buffer, msg.limit,
+                        [aggregator](const char *begin, const char *end) {
+                            static_cast<void>(aggregator->send(
+                                messages::IncomingMessageFromHost(begin, end)));
+                        });
+}
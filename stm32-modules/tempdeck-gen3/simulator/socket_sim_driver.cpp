@@ -1,59 +1,24 @@
 #include "simulator/socket_sim_driver.hpp"
 
-#include <algorithm>
-#include <boost/asio.hpp>
 #include <iostream>
-#include <iterator>
 #include <memory>
-#include <regex>
 
-#include "hal/double_buffer.hpp"
+#include "simulator/async_line_socket.hpp"
 #include "simulator/simulator_queue.hpp"
 
 using namespace socket_sim_driver;
 
 const std::string SOCKET_DRIVER_NAME = "Socket";
 
-std::unique_ptr<boost::asio::ip::tcp::socket> connect_to_socket(
-    std::string host, int port) {
-    boost::asio::io_service io_context;
-    boost::asio::ip::tcp::resolver resolver(io_context);
-    std::string parsed_host;
-    try {
-        auto endpoints = resolver.resolve(host, std::to_string(port));
-        parsed_host = endpoints.begin()->endpoint().address().to_string();
-    } catch (const boost::system::system_error& ex) {
-        std::cerr << "Failed to resolve passed host/ip: \"" << host << "\""
-                  << std::endl;
-        exit(1);
-    }
-
-    auto socket = std::make_unique<boost::asio::ip::tcp::socket>(io_context);
-    boost::asio::ip::tcp::endpoint endpoint(
-        boost::asio::ip::address::from_string(parsed_host), port);
-    boost::system::error_code ec;
-    socket->connect(endpoint, ec);
-    if (ec) {
-        std::cerr << "Failed to create socket: " << ec.category().name() << ": "
-                  << ec.value() << std::endl;
-        exit(ec.value());
-    }
-    return socket;
-}
-
-socket_sim_driver::SocketSimDriver::SocketSimDriver(std::string url) {
-    std::regex url_regex(":\\/\\/([a-zA-Z0-9.-]*):(\\d*)$");
-    std::smatch url_match_result;
-
-    if (std::regex_search(url, url_match_result, url_regex)) {
-        address_info = socket_sim_driver::AddressInfo{
-            url_match_result[1], std::stoi(url_match_result[2])};
-        s = connect_to_socket(address_info.host, address_info.port);
-
-    } else {
+socket_sim_driver::SocketSimDriver::SocketSimDriver(std::string url,
+                                                    bool log) {
+    auto address = sim_socket::parse_url(url);
+    if (!address.has_value()) {
         std::cerr << "Malformed url." << std::endl;
         exit(1);
     }
+    address_info = address.value();
+    s = std::make_unique<sim_socket::AsyncLineSocket>(address_info, log);
 }
 
 const std::string socket_sim_driver::SocketSimDriver::name = SOCKET_DRIVER_NAME;
@@ -71,42 +36,13 @@ const std::string& socket_sim_driver::SocketSimDriver::get_name() const {
 }
 
 void socket_sim_driver::SocketSimDriver::write(const std::string& message) {
-    std::cout << "Sending response: " << message << std::endl;
-    this->s->write_some(boost::asio::buffer(message));
-}
-
-int has_char(const char* char_array, const char* end, char value_to_find) {
-    const char* position = std::find(char_array, end, value_to_find);
-    return end != position;
+    s->write(message);
 }
 
 void socket_sim_driver::SocketSimDriver::read(
     sim_driver::SendToCommsFunc&& send_to_comms) {
-    char pBuff[30];
-    boost::asio::mutable_buffer buff(pBuff, sizeof(pBuff));
-    auto write_buffer =
-        std::make_shared<double_buffer::DoubleBuffer<char, 2048>>();
-    size_t l = this->s->read_some(buff);
-    char* end_of_input = std::begin(*write_buffer->accessible());
-    char* end_of_buffer = std::end(*write_buffer->accessible());
-
-    for (; l > 0; l = this->s->read_some(buff)) {
-        if (end_of_input + l > end_of_buffer) {
-            end_of_input = std::begin(*write_buffer->accessible());
-        }
-        char* data = write_buffer->accessible()->data();
-        end_of_input =
-            std::copy(reinterpret_cast<char*>(buff.data()),
-                      reinterpret_cast<char*>(buff.data()) + l, end_of_input);
-        if (has_char(data, end_of_input, '\n')) {
-            std::cout << "Received complete message: "
-                      << write_buffer->accessible()->data() << std::endl;
-            auto message = messages::IncomingMessageFromHost(
-                std::begin(*write_buffer->accessible()), end_of_input);
-            send_to_comms(message);
-            write_buffer->swap();
-            end_of_input = std::begin(*write_buffer->accessible());
-            end_of_buffer = std::end(*write_buffer->accessible());
-        }
-    }
+    s->run([&send_to_comms](const char* begin, const char* end) {
+        auto message = messages::IncomingMessageFromHost(begin, end);
+        send_to_comms(message);
+    });
 }
@@ -14,12 +14,32 @@ const char* const THERMAL_PELTIER_ERROR =
 const char* const THERMAL_PELTIER_POWER_ERROR =
     "ERR102:thermal:invalid power setting\n";
 const char* const THERMAL_PELTIER_BUSY = "ERR103:thermal:peltiers busy\n";
+const char* const THERMAL_AUTOTUNE_FAILED =
+    "ERR104:thermal:autotune did not settle into an oscillation\n";
+const char* const THERMAL_AUTOTUNE_INVALID =
+    "ERR105:thermal:autotune target or cycles out of range\n";
+const char* const THERMAL_PLATE_THERMISTOR_ERROR =
+    "ERR106:thermal:plate thermistor reading invalid\n";
 const char* const SYSTEM_SERIAL_NUMBER_INVALID =
     "ERR301:system:serial number invalid format\n";
 const char* const SYSTEM_SERIAL_NUMBER_HAL_ERROR =
     "ERR302:system:HAL error, busy, or timeout\n";
 const char* const SYSTEM_EEPROM_ERROR =
     "ERR303:system:EEPROM communication error\n";
+const char* const SYSTEM_FIRMWARE_UPDATE_NOT_STARTED =
+    "ERR304:system:no firmware update in progress\n";
+const char* const SYSTEM_FIRMWARE_BAD_LENGTH =
+    "ERR305:system:invalid firmware length\n";
+const char* const SYSTEM_FIRMWARE_BAD_OFFSET =
+    "ERR306:system:firmware chunk out of order\n";
+const char* const SYSTEM_FIRMWARE_BAD_CHUNK_CRC =
+    "ERR307:system:firmware chunk CRC mismatch\n";
+const char* const SYSTEM_FIRMWARE_BAD_IMAGE_CRC =
+    "ERR308:system:firmware image CRC mismatch\n";
+const char* const SYSTEM_FIRMWARE_BAD_IMAGE =
+    "ERR309:system:firmware image failed integrity check\n";
+const char* const SYSTEM_FIRMWARE_FLASH_ERROR =
+    "ERR310:system:firmware flash write failed\n";
 
 const char* const UNKNOWN_ERROR = "ERR-1:unknown error code\n";
 
@@ -39,9 +59,19 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(THERMAL_PELTIER_ERROR);
         HANDLE_CASE(THERMAL_PELTIER_POWER_ERROR);
         HANDLE_CASE(THERMAL_PELTIER_BUSY);
+        HANDLE_CASE(THERMAL_AUTOTUNE_FAILED);
+        HANDLE_CASE(THERMAL_AUTOTUNE_INVALID);
+        HANDLE_CASE(THERMAL_PLATE_THERMISTOR_ERROR);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_INVALID);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_HAL_ERROR);
         HANDLE_CASE(SYSTEM_EEPROM_ERROR);
+        HANDLE_CASE(SYSTEM_FIRMWARE_UPDATE_NOT_STARTED);
+        HANDLE_CASE(SYSTEM_FIRMWARE_BAD_LENGTH);
+        HANDLE_CASE(SYSTEM_FIRMWARE_BAD_OFFSET);
+        HANDLE_CASE(SYSTEM_FIRMWARE_BAD_CHUNK_CRC);
+        HANDLE_CASE(SYSTEM_FIRMWARE_BAD_IMAGE_CRC);
+        HANDLE_CASE(SYSTEM_FIRMWARE_BAD_IMAGE);
+        HANDLE_CASE(SYSTEM_FIRMWARE_FLASH_ERROR);
     }
     return UNKNOWN_ERROR;
 }
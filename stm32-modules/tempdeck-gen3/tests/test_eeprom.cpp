@@ -63,3 +63,43 @@ TEST_CASE("eeprom reading and writing") {
         }
     }
 }
+
+TEST_CASE("eeprom constants from before the key-value store") {
+    GIVEN("an EEPROM with constants in the legacy layout") {
+        auto policy = TestM24128Policy();
+        auto legacy = m24128::M24128<0x10>();
+        auto content = PageContent{
+            .constant_flag = 1,
+            .constants = OffsetConstants{.a = 1.5, .b = -2, .c = 3}};
+        REQUIRE(legacy.write_value(0, content, policy));
+        auto eeprom = Eeprom<0x10>();
+        WHEN("reading the constants") {
+            auto readback = eeprom.get_offset_constants(_default, policy);
+            THEN("the legacy constants are returned") {
+                REQUIRE(readback.a == 1.5);
+                REQUIRE(readback.b == -2);
+                REQUIRE(readback.c == 3);
+            }
+            AND_WHEN("reading them again") {
+                policy._reads = 0;
+                readback = eeprom.get_offset_constants(_default, policy);
+                THEN("the EEPROM isn't read again") {
+                    REQUIRE(policy._reads == 0);
+                    REQUIRE(readback.a == 1.5);
+                }
+            }
+        }
+        WHEN("the legacy page is erased after writing new constants") {
+            auto constants = OffsetConstants{.a = 7, .b = 8, .c = 9};
+            REQUIRE(eeprom.write_offset_constants(constants, policy));
+            REQUIRE(legacy.write_value(0, uint8_t(0xFF), policy));
+            THEN("a new EEPROM instance reads the new constants") {
+                auto reloaded = Eeprom<0x10>();
+                auto readback = reloaded.get_offset_constants(_default, policy);
+                REQUIRE(readback.a == 7);
+                REQUIRE(readback.b == 8);
+                REQUIRE(readback.c == 9);
+            }
+        }
+    }
+}
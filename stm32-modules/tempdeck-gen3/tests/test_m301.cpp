@@ -46,6 +46,66 @@ SCENARIO("SetPIDConstants (M301) parser works", "[gcode][parse][m301]") {
             }
         }
     }
+    GIVEN("input selecting a gain schedule zone and direction") {
+        std::string buffer = "M301 P10.0 I-4 D75 Z2 C\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("the zone and direction are parsed") {
+                REQUIRE(parsed.first.has_value());
+                auto val = parsed.first.value();
+                REQUIRE(val.const_p == 10.0F);
+                REQUIRE(val.zone == 2);
+                REQUIRE(val.direction == PIDDirection::COOLING);
+            }
+        }
+    }
+    GIVEN("input selecting only a direction") {
+        std::string buffer = "M301 P10.0 I-4 D75 H\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("every zone is selected") {
+                REQUIRE(parsed.first.has_value());
+                auto val = parsed.first.value();
+                REQUIRE(!val.zone.has_value());
+                REQUIRE(val.direction == PIDDirection::HEATING);
+            }
+        }
+    }
+    GIVEN("input without a zone or direction") {
+        std::string buffer = "M301 P10.0 I-4 D75\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("the whole schedule is selected") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(!parsed.first.value().zone.has_value());
+                REQUIRE(!parsed.first.value().direction.has_value());
+            }
+        }
+    }
+    GIVEN("input with a zone that doesn't exist") {
+        std::string buffer = "M301 P10.0 I-4 D75 Z3\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("no valid command is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("input selecting both directions") {
+        std::string buffer = "M301 P10.0 I-4 D75 H C\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("no valid command is produced") {
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+    }
     GIVEN("input missing I term") {
         std::string buffer = "M301 P10.0 D75\n";
         WHEN("parsing the command") {
@@ -0,0 +1,51 @@
+#include "catch2/catch.hpp"
+#include "tempdeck-gen3/gcodes.hpp"
+
+SCENARIO("BeginFirmwareUpdate (M980) parser works", "[gcode][parse][m980]") {
+    GIVEN("a valid string") {
+        std::string to_parse = "M980 S1024 C305419896\n";
+        WHEN("calling parse") {
+            auto result = gcode::BeginFirmwareUpdate::parse(to_parse.cbegin(),
+                                                            to_parse.cend());
+            THEN("the length and crc are parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().length == 1024);
+                REQUIRE(result.first.value().crc == 0x12345678);
+                REQUIRE(result.second == to_parse.cend() - 1);
+            }
+        }
+    }
+    GIVEN("a string without a crc") {
+        std::string to_parse = "M980 S1024\n";
+        WHEN("calling parse") {
+            auto result = gcode::BeginFirmwareUpdate::parse(to_parse.cbegin(),
+                                                            to_parse.cend());
+            THEN("nothing is parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+    GIVEN("a string with the wrong prefix") {
+        std::string to_parse = "M981 S1024 C1\n";
+        WHEN("calling parse") {
+            auto result = gcode::BeginFirmwareUpdate::parse(to_parse.cbegin(),
+                                                            to_parse.cend());
+            THEN("nothing is parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+    GIVEN("a response buffer") {
+        std::string buffer(64, 'c');
+        WHEN("writing a response") {
+            auto written = gcode::BeginFirmwareUpdate::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response is written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M980 OK\n"));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+}
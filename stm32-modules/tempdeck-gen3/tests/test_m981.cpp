@@ -0,0 +1,70 @@
+#include "catch2/catch.hpp"
+#include "tempdeck-gen3/gcodes.hpp"
+
+SCENARIO("WriteFirmwareChunk (M981) parser works", "[gcode][parse][m981]") {
+    GIVEN("a valid string") {
+        std::string to_parse = "M981 A16 C42 D00a1FF7e\n";
+        WHEN("calling parse") {
+            auto result = gcode::WriteFirmwareChunk::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("the chunk is decoded") {
+                REQUIRE(result.first.has_value());
+                auto chunk = result.first.value();
+                REQUIRE(chunk.offset == 16);
+                REQUIRE(chunk.crc == 42);
+                REQUIRE(chunk.length == 4);
+                REQUIRE(chunk.data[0] == 0x00);
+                REQUIRE(chunk.data[1] == 0xA1);
+                REQUIRE(chunk.data[2] == 0xFF);
+                REQUIRE(chunk.data[3] == 0x7E);
+                REQUIRE(result.second == to_parse.cend() - 1);
+            }
+        }
+    }
+    GIVEN("a string with the longest chunk") {
+        std::string to_parse =
+            "M981 A0 C0 D" +
+            std::string(firmware_update::MAX_CHUNK_LENGTH * 2, 'b') + "\n";
+        WHEN("calling parse") {
+            auto result = gcode::WriteFirmwareChunk::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("the whole chunk is decoded") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().length ==
+                        firmware_update::MAX_CHUNK_LENGTH);
+                REQUIRE(result.first.value().data.back() == 0xBB);
+            }
+        }
+    }
+    GIVEN("a string with an odd number of hex digits") {
+        std::string to_parse = "M981 A0 C0 D123\n";
+        WHEN("calling parse") {
+            auto result = gcode::WriteFirmwareChunk::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("nothing is parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+    GIVEN("a string with data that isn't hex") {
+        std::string to_parse = "M981 A0 C0 D12zz\n";
+        WHEN("calling parse") {
+            auto result = gcode::WriteFirmwareChunk::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("nothing is parsed") {
+                REQUIRE(!result.first.has_value());
+            }
+        }
+    }
+    GIVEN("a string without data") {
+        std::string to_parse = "M981 A0 C0\n";
+        WHEN("calling parse") {
+            auto result = gcode::WriteFirmwareChunk::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("nothing is parsed") {
+                REQUIRE(!result.first.has_value());
+            }
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#include "catch2/catch.hpp"
+#include "tempdeck-gen3/gcodes.hpp"
+
+SCENARIO("FinishFirmwareUpdate (M982) parser works", "[gcode][parse][m982]") {
+    GIVEN("a valid string") {
+        std::string to_parse = "M982\n";
+        WHEN("calling parse") {
+            auto result = gcode::FinishFirmwareUpdate::parse(to_parse.cbegin(),
+                                                             to_parse.cend());
+            THEN("a gcode is parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin() + 4);
+            }
+        }
+    }
+    GIVEN("a string with the wrong prefix") {
+        std::string to_parse = "M98\n";
+        WHEN("calling parse") {
+            auto result = gcode::FinishFirmwareUpdate::parse(to_parse.cbegin(),
+                                                             to_parse.cend());
+            THEN("nothing is parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+}
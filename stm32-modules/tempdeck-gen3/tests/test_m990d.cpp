@@ -0,0 +1,97 @@
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "tempdeck-gen3/gcodes.hpp"
+#pragma GCC diagnostic pop
+#include "test/test_tasks.hpp"
+
+struct MicrosecondClock {
+    uint32_t cycles = 0;
+    [[nodiscard]] auto now() const -> uint32_t { return cycles; }
+    [[nodiscard]] static auto ticks_per_us() -> uint32_t { return 1; }
+};
+
+SCENARIO("GetTaskStats (M990.D) parser works", "[gcode][parse][m990.d]") {
+    GIVEN("a valid string") {
+        std::string input("M990.D\n");
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetTaskStats::parse(input.begin(), input.end());
+            THEN("a valid gcode is produced") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.second != input.begin());
+            }
+        }
+    }
+    GIVEN("an invalid string") {
+        std::string input("M990\n");
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetTaskStats::parse(input.begin(), input.end());
+            THEN("no gcode is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == input.begin());
+            }
+        }
+    }
+    GIVEN("a registry with a queued task and a periodic task") {
+        auto registry = task_stats::Registry<2>({"Queued", "Periodic"});
+        registry.at(0).record_queue_depth(2);
+        auto clock = MicrosecondClock();
+        {
+            auto measure = task_stats::Measurement(registry.at(0), clock);
+            clock.cycles += 20;
+        }
+        registry.at(1).record_wakeup(1000, clock);
+        clock.cycles += 1003;
+        registry.at(1).record_wakeup(1000, clock);
+        std::string buffer(256, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::GetTaskStats::write_response_into(
+                buffer.begin(), buffer.end(), registry);
+            THEN("every task is reported") {
+                REQUIRE_THAT(
+                    buffer,
+                    Catch::Matchers::StartsWith(
+                        "M990.D Queued:N=1,MIN=20,AVG=20,MAX=20,Q=2,"
+                        "H=0/1/0/0/0/0/0/0 Periodic:N=0,MIN=0,AVG=0,MAX=0,Q=0,"
+                        "H=0/0/0/0/0/0/0/0,P=1000,J=3/3 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+        WHEN("filling a response buffer that is too small") {
+            auto written = gcode::GetTaskStats::write_response_into(
+                buffer.begin(), buffer.begin() + 10, registry);
+            THEN("nothing is written past the limit") {
+                REQUIRE(written <= buffer.begin() + 10);
+                REQUIRE(buffer.at(10) == 'c');
+            }
+        }
+    }
+}
+
+SCENARIO("host comms task reports task stats") {
+    GIVEN("a host comms task with a stats registry") {
+        auto *tasks = tasks::BuildTasks();
+        std::string tx_buf(512, 'c');
+        tasks::task_stats_for(tasks->_task_stats, tasks::TaskIndex::THERMAL)
+            .record_queue_depth(4);
+        WHEN("sending M990.D") {
+            auto message_text = std::string("M990.D\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->_comms_queue.backing_deque.push_back(message_obj);
+            auto written =
+                tasks->_comms_task.run_once(tx_buf.begin(), tx_buf.end());
+            THEN("the stats of every task are written back") {
+                auto response = std::string(tx_buf.begin(), written);
+                REQUIRE_THAT(response,
+                             Catch::Matchers::StartsWith("M990.D HostComms:"));
+                REQUIRE_THAT(response, Catch::Matchers::Contains("Thermal:"));
+                REQUIRE_THAT(response, Catch::Matchers::Contains("Q=4"));
+                REQUIRE_THAT(response, Catch::Matchers::EndsWith(" OK\n"));
+            }
+        }
+    }
+}
@@ -76,4 +76,153 @@ SCENARIO("system task system info command") {
             REQUIRE(ack.responding_to_id == msg.id);
         }
     }
+    WHEN("getting task memory") {
+        for (uint32_t i = 0; i < 3; ++i) {
+            policy._stacks.push_back(
+                task_memory::StackUsage{.name = "Task",
+                                        .size_words = 100 + i,
+                                        .min_free_words = 10 + i});
+        }
+        policy._ram = task_memory::RamUsage{.data_bytes = 1,
+                                            .bss_bytes = 2,
+                                            .heap_peak_bytes = 3,
+                                            .heap_used_bytes = 4};
+        AND_WHEN("asking for the first page") {
+            auto msg = messages::GetTaskMemoryMessage{.id = 55, .start = 0};
+            tasks->_system_queue.backing_deque.push_back(msg);
+            tasks->_system_task.run_once(policy);
+            THEN("the response holds one task and the RAM usage") {
+                REQUIRE(tasks->_comms_queue.has_message());
+                auto host_msg = tasks->_comms_queue.backing_deque.front();
+                REQUIRE(std::holds_alternative<messages::GetTaskMemoryResponse>(
+                    host_msg));
+                auto response =
+                    std::get<messages::GetTaskMemoryResponse>(host_msg);
+                REQUIRE(response.responding_to_id == msg.id);
+                REQUIRE(response.total == 3);
+                REQUIRE(response.start == 0);
+                REQUIRE(response.count ==
+                        messages::GetTaskMemoryResponse::MAX_TASKS);
+                REQUIRE(response.stacks.at(0).size_words == 100);
+                REQUIRE(response.stacks.at(0).min_free_words == 10);
+                REQUIRE(response.ram.bss_bytes == 2);
+                REQUIRE(response.ram.heap_used_bytes == 4);
+            }
+        }
+        AND_WHEN("asking for the last page") {
+            auto msg = messages::GetTaskMemoryMessage{.id = 56, .start = 2};
+            tasks->_system_queue.backing_deque.push_back(msg);
+            tasks->_system_task.run_once(policy);
+            THEN("the response holds the last task") {
+                auto response = std::get<messages::GetTaskMemoryResponse>(
+                    tasks->_comms_queue.backing_deque.front());
+                REQUIRE(response.start == 2);
+                REQUIRE(response.count == 1);
+                REQUIRE(response.stacks.at(0).size_words == 102);
+            }
+        }
+        AND_WHEN("asking for a page past the last task") {
+            auto msg = messages::GetTaskMemoryMessage{.id = 57, .start = 5};
+            tasks->_system_queue.backing_deque.push_back(msg);
+            tasks->_system_task.run_once(policy);
+            THEN("the response holds no tasks") {
+                auto response = std::get<messages::GetTaskMemoryResponse>(
+                    tasks->_comms_queue.backing_deque.front());
+                REQUIRE(response.total == 3);
+                REQUIRE(response.count == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("system task firmware update") {
+    using namespace backup_flash_test_policy;
+    auto *tasks = tasks::BuildTasks();
+    TestSystemPolicy policy;
+    auto image = make_image(TEST_LAYOUT, 1000);
+    auto image_crc = crc32::compute(image.cbegin(), image.cend());
+    auto run_and_get_ack = [&](const messages::SystemMessage &msg) {
+        tasks->_comms_queue.backing_deque.clear();
+        tasks->_system_queue.backing_deque.push_back(msg);
+        tasks->_system_task.run_once(policy);
+        REQUIRE(tasks->_comms_queue.has_message());
+        auto host_msg = tasks->_comms_queue.backing_deque.front();
+        REQUIRE(
+            std::holds_alternative<messages::AcknowledgePrevious>(host_msg));
+        return std::get<messages::AcknowledgePrevious>(host_msg);
+    };
+    auto send_image = [&]() {
+        for (size_t offset = 0; offset < image.size();
+             offset += firmware_update::MAX_CHUNK_LENGTH) {
+            auto msg = messages::WriteFirmwareChunkMessage{
+                .id = static_cast<uint32_t>(offset),
+                .offset = static_cast<uint32_t>(offset)};
+            msg.length = std::min(firmware_update::MAX_CHUNK_LENGTH,
+                                  image.size() - offset);
+            std::copy_n(&image[offset], msg.length, msg.data.begin());
+            msg.crc = crc32::compute(msg.data.cbegin(),
+                                     msg.data.cbegin() + msg.length);
+            auto ack = run_and_get_ack(msg);
+            REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+        }
+    };
+    WHEN("writing a chunk before starting an update") {
+        auto ack = run_and_get_ack(
+            messages::WriteFirmwareChunkMessage{.id = 5, .length = 8});
+        THEN("the system task reports an error") {
+            REQUIRE(ack.responding_to_id == 5);
+            REQUIRE(ack.with_error ==
+                    errors::ErrorCode::SYSTEM_FIRMWARE_UPDATE_NOT_STARTED);
+        }
+    }
+    WHEN("starting an update") {
+        auto ack = run_and_get_ack(messages::BeginFirmwareUpdateMessage{
+            .id = 1,
+            .length = static_cast<uint32_t>(image.size()),
+            .crc = image_crc});
+        THEN("the system task acks without error") {
+            REQUIRE(ack.responding_to_id == 1);
+            REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+        }
+        AND_WHEN("sending the whole image and finishing") {
+            send_image();
+            auto finish_ack = run_and_get_ack(
+                messages::FinishFirmwareUpdateMessage{.id = 99});
+            THEN("the update is requested and acked before USB disconnects") {
+                REQUIRE(finish_ack.responding_to_id == 99);
+                REQUIRE(finish_ack.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(policy.update_requested());
+                REQUIRE(tasks->_comms_queue.backing_deque.size() == 2);
+                auto host_msg = tasks->_comms_queue.backing_deque.back();
+                REQUIRE(std::holds_alternative<messages::ForceUSBDisconnect>(
+                    host_msg));
+                auto reply_id =
+                    std::get<messages::ForceUSBDisconnect>(host_msg).id;
+                REQUIRE(policy._reset_count == 0);
+                AND_WHEN("host comms acknowledges the USB disconnect") {
+                    auto ack = messages::AcknowledgePrevious{
+                        .responding_to_id = reply_id};
+                    tasks->_system_queue.backing_deque.push_back(ack);
+                    tasks->_system_task.run_once(policy);
+                    THEN("the system resets to install the update") {
+                        REQUIRE(policy._reset_count == 1);
+                        REQUIRE(policy._bootloader_count == 0);
+                    }
+                }
+            }
+        }
+        AND_WHEN("finishing with a corrupted image") {
+            image.back() ^= 0xFF;
+            send_image();
+            auto finish_ack = run_and_get_ack(
+                messages::FinishFirmwareUpdateMessage{.id = 99});
+            THEN("the system task reports an error and stays running") {
+                REQUIRE(finish_ack.with_error ==
+                        errors::ErrorCode::SYSTEM_FIRMWARE_BAD_IMAGE_CRC);
+                REQUIRE(!policy.update_requested());
+                REQUIRE(tasks->_comms_queue.backing_deque.size() == 1);
+                REQUIRE(policy._reset_count == 0);
+            }
+        }
+    }
 }
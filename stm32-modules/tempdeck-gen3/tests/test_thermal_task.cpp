@@ -2,6 +2,14 @@
 #include "test/test_tasks.hpp"
 #include "test/test_thermal_policy.hpp"
 
+// Moves every channel of a set of thermistor readings forward in time
+static auto advance_readings(messages::ThermistorReadings& readings,
+                             uint32_t ms) -> void {
+    readings.plate_1_timestamp += ms;
+    readings.plate_2_timestamp += ms;
+    readings.heatsink_timestamp += ms;
+}
+
 TEST_CASE("peltier current conversions") {
     GIVEN("some ADC readings") {
         const auto COUNT = 4;
@@ -42,11 +50,13 @@ TEST_CASE("thermal task message handling") {
         auto plate_count = converter.backconvert(25.00);
         auto hs_count = converter.backconvert(50.00);
         auto thermistors_msg = messages::ThermistorReadings{
-            .timestamp = 1000,
             .plate_1 = plate_count,
             .plate_2 = plate_count,
             .heatsink = hs_count,
             .imeas = 555,
+            .plate_1_timestamp = 1000,
+            .plate_2_timestamp = 1000,
+            .heatsink_timestamp = 1000,
         };
         tasks->_thermal_queue.backing_deque.push_back(thermistors_msg);
         tasks->_thermal_task.run_once(policy);
@@ -58,7 +68,7 @@ TEST_CASE("thermal task message handling") {
             REQUIRE(readings.heatsink_adc == thermistors_msg.heatsink);
             REQUIRE(readings.plate_adc_1 == thermistors_msg.plate_1);
             REQUIRE(readings.plate_adc_2 == thermistors_msg.plate_2);
-            REQUIRE(readings.last_tick == thermistors_msg.timestamp);
+            REQUIRE(readings.last_tick == thermistors_msg.plate_1_timestamp);
             REQUIRE(readings.peltier_current_adc == thermistors_msg.imeas);
         }
         THEN("the ADC readings are properly converted to temperatures") {
@@ -290,6 +300,92 @@ TEST_CASE("pid setting command handling") {
     }
 }
 
+TEST_CASE("pid gain scheduling") {
+    auto *tasks = tasks::BuildTasks();
+    TestThermalPolicy policy;
+    thermistor_conversion::Conversion<lookups::KS103J2G> converter(
+        decltype(tasks->_thermal_task)::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+        decltype(tasks->_thermal_task)::ADC_BIT_MAX, false);
+    auto temp_message =
+        messages::ThermistorReadings{.plate_1 = converter.backconvert(25),
+                                     .plate_2 = converter.backconvert(25),
+                                     .heatsink = converter.backconvert(25),
+                                     .plate_1_timestamp = 100,
+                                     .plate_2_timestamp = 100,
+                                     .heatsink_timestamp = 100};
+    tasks->_thermal_queue.backing_deque.push_back(temp_message);
+    tasks->_thermal_task.run_once(policy);
+    auto set_target = [&](double target) {
+        tasks->_thermal_queue.backing_deque.push_back(
+            messages::SetTemperatureMessage{.id = 1, .target = target});
+        tasks->_thermal_task.run_once(policy);
+    };
+
+    WHEN("setting a target above the plate") {
+        set_target(100);
+        THEN("the heating gains are used") {
+            REQUIRE(tasks->_thermal_task.get_pid().kp() ==
+                    tasks->_thermal_task.PELTIER_KP_HEATING_DEFAULT);
+        }
+    }
+    WHEN("setting a target below the plate") {
+        set_target(4);
+        THEN("the cooling gains are used") {
+            REQUIRE(tasks->_thermal_task.get_pid().kp() ==
+                    tasks->_thermal_task.PELTIER_KP_COOLING_DEFAULT);
+        }
+    }
+    WHEN("sending PID constants for cooling in the cold zone") {
+        auto msg = messages::SetPIDConstantsMessage{
+            .id = 2,
+            .p = 5,
+            .i = 0.5,
+            .d = 0,
+            .zone = 0,
+            .direction = PIDDirection::COOLING};
+        tasks->_thermal_queue.backing_deque.push_back(msg);
+        tasks->_thermal_task.run_once(policy);
+        THEN("the current gains are unchanged") {
+            REQUIRE(tasks->_thermal_task.get_pid().kp() ==
+                    tasks->_thermal_task.PELTIER_KP_HEATING_DEFAULT);
+        }
+        THEN("only that entry of the schedule is updated") {
+            auto &schedule = tasks->_thermal_task.get_gain_schedule();
+            REQUIRE(schedule.get(0, PIDDirection::COOLING).kp == 5);
+            REQUIRE(schedule.get(1, PIDDirection::COOLING).kp ==
+                    tasks->_thermal_task.PELTIER_KP_COOLING_DEFAULT);
+            REQUIRE(schedule.get(0, PIDDirection::HEATING).kp ==
+                    tasks->_thermal_task.PELTIER_KP_HEATING_DEFAULT);
+        }
+        AND_WHEN("cooling to a cold target") {
+            set_target(4);
+            THEN("the new gains are used") {
+                REQUIRE(tasks->_thermal_task.get_pid().kp() == 5);
+                REQUIRE(tasks->_thermal_task.get_pid().ki() == 0.5);
+            }
+        }
+        AND_WHEN("cooling to a warm target") {
+            set_target(22);
+            THEN("the default cooling gains are used") {
+                REQUIRE(tasks->_thermal_task.get_pid().kp() ==
+                        tasks->_thermal_task.PELTIER_KP_COOLING_DEFAULT);
+            }
+        }
+    }
+    WHEN("sending PID constants without a zone or direction") {
+        tasks->_thermal_queue.backing_deque.push_back(
+            messages::SetPIDConstantsMessage{
+                .id = 2, .p = 1, .i = 2, .d = 3});
+        tasks->_thermal_task.run_once(policy);
+        AND_WHEN("setting a target") {
+            set_target(4);
+            THEN("the constants are still used") {
+                REQUIRE(tasks->_thermal_task.get_pid().kp() == 1);
+            }
+        }
+    }
+}
+
 TEST_CASE("deactivation command") {
     auto *tasks = tasks::BuildTasks();
     TestThermalPolicy policy;
@@ -420,10 +516,12 @@ TEST_CASE("closed loop thermal control") {
 
     uint32_t timestamp_increment = 100;
     auto temp_message =
-        messages::ThermistorReadings{.timestamp = timestamp_increment,
-                                     .plate_1 = converter.backconvert(25),
+        messages::ThermistorReadings{.plate_1 = converter.backconvert(25),
                                      .plate_2 = converter.backconvert(25),
-                                     .heatsink = converter.backconvert(25)};
+                                     .heatsink = converter.backconvert(25),
+                                     .plate_1_timestamp = timestamp_increment,
+                                     .plate_2_timestamp = timestamp_increment,
+                                     .heatsink_timestamp = timestamp_increment};
     tasks->_thermal_queue.backing_deque.push_back(temp_message);
     tasks->_thermal_task.run_once(policy);
     GIVEN("ambient temperature") {
@@ -433,7 +531,7 @@ TEST_CASE("closed loop thermal control") {
     }
     GIVEN("high temperature when at rest") {
         temp_message.heatsink = converter.backconvert(60);
-        temp_message.timestamp += timestamp_increment;
+        advance_readings(temp_message, timestamp_increment);
         tasks->_thermal_queue.backing_deque.push_back(temp_message);
         tasks->_thermal_task.run_once(policy);
 
@@ -449,7 +547,7 @@ TEST_CASE("closed loop thermal control") {
         tasks->_thermal_queue.backing_deque.push_back(target_msg);
         tasks->_thermal_task.run_once(policy);
         AND_WHEN("temperature readings are updated") {
-            temp_message.timestamp += timestamp_increment;
+            advance_readings(temp_message, timestamp_increment);
             tasks->_thermal_queue.backing_deque.push_back(temp_message);
             tasks->_thermal_task.run_once(policy);
             THEN("the peltiers update to heat") {
@@ -467,6 +565,19 @@ TEST_CASE("closed loop thermal control") {
                              Catch::Matchers::WithinAbs(expected, 0.0001));
             }
         }
+        AND_WHEN("the plate thermistors are sampled late") {
+            temp_message.plate_1_timestamp += 130;
+            temp_message.plate_2_timestamp += 150;
+            temp_message.heatsink_timestamp += 100;
+            tasks->_thermal_queue.backing_deque.push_back(temp_message);
+            tasks->_thermal_task.run_once(policy);
+            THEN("the PID sampletime runs to halfway between the plates") {
+                REQUIRE_THAT(tasks->_thermal_task.get_pid().sampletime(),
+                             Catch::Matchers::WithinAbs(0.140, 0.0001));
+                REQUIRE(tasks->_thermal_task.get_readings().last_tick ==
+                        timestamp_increment + 140);
+            }
+        }
     }
     WHEN("setting temp target to -4ºC") {
         auto target_msg =
@@ -474,7 +585,7 @@ TEST_CASE("closed loop thermal control") {
         tasks->_thermal_queue.backing_deque.push_back(target_msg);
         tasks->_thermal_task.run_once(policy);
         AND_WHEN("temperature readings are updated") {
-            temp_message.timestamp += timestamp_increment;
+            advance_readings(temp_message, timestamp_increment);
             tasks->_thermal_queue.backing_deque.push_back(temp_message);
             tasks->_thermal_task.run_once(policy);
             THEN("the peltiers update to cool") {
@@ -597,11 +708,13 @@ TEST_CASE("thermal task offset constant compensation") {
             static constexpr double PLATE_TEMP = 25.0;
             static constexpr double HEATSINK_TEMP = 50.0;
             auto thermistors_msg = messages::ThermistorReadings{
-                .timestamp = 1000,
                 .plate_1 = converter.backconvert(PLATE_TEMP),
                 .plate_2 = converter.backconvert(PLATE_TEMP),
                 .heatsink = converter.backconvert(HEATSINK_TEMP),
                 .imeas = 555,
+                .plate_1_timestamp = 1000,
+                .plate_2_timestamp = 1000,
+                .heatsink_timestamp = 1000,
             };
             tasks->_thermal_queue.backing_deque.push_back(thermistors_msg);
             tasks->_thermal_task.run_once(policy);
@@ -640,11 +753,13 @@ TEST_CASE("thermal task power debug functionality") {
 
     GIVEN("a thermal task with valid peltier current readings") {
         auto adc_msg = messages::ThermistorReadings{
-            .timestamp = 123,
             .plate_1 = temp_adc,
             .plate_2 = temp_adc,
             .heatsink = temp_adc,
             .imeas = current_adc,
+            .plate_1_timestamp = 123,
+            .plate_2_timestamp = 123,
+            .heatsink_timestamp = 123,
         };
         REQUIRE(tasks->_thermal_queue.try_send(adc_msg));
         tasks->_thermal_task.run_once(policy);
@@ -720,3 +835,169 @@ TEST_CASE("thermal task power debug functionality") {
         }
     }
 }
+
+TEST_CASE("thermal task autotune") {
+    auto *tasks = tasks::BuildTasks();
+    TestThermalPolicy policy;
+    thermistor_conversion::Conversion<lookups::KS103J2G> converter(
+        decltype(tasks->_thermal_task)::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+        decltype(tasks->_thermal_task)::ADC_BIT_MAX, false);
+
+    uint32_t timestamp = 1000;
+    auto send_reading = [&](double temp, uint32_t delta_ms = 1000) {
+        timestamp += delta_ms;
+        auto count = converter.backconvert(temp);
+        tasks->_thermal_queue.backing_deque.push_back(
+            messages::ThermistorReadings{
+                .plate_1 = count,
+                .plate_2 = count,
+                .heatsink = converter.backconvert(25),
+                .plate_1_timestamp = timestamp,
+                .plate_2_timestamp = timestamp,
+                .heatsink_timestamp = timestamp});
+        tasks->_thermal_task.run_once(policy);
+    };
+    auto take_ack = [&]() {
+        REQUIRE(tasks->_comms_queue.has_message());
+        auto msg = tasks->_comms_queue.backing_deque.front();
+        tasks->_comms_queue.backing_deque.pop_front();
+        REQUIRE(std::holds_alternative<messages::AcknowledgePrevious>(msg));
+        return std::get<messages::AcknowledgePrevious>(msg);
+    };
+    send_reading(20.5);
+
+    WHEN("starting with an out-of-range target") {
+        tasks->_thermal_queue.backing_deque.push_back(
+            messages::StartAutotuneMessage{
+                .id = 1, .target = 120, .cycles = 4});
+        tasks->_thermal_task.run_once(policy);
+        THEN("it is rejected") {
+            REQUIRE(take_ack().with_error ==
+                    errors::ErrorCode::THERMAL_AUTOTUNE_INVALID);
+            REQUIRE(!tasks->_thermal_task.autotuning());
+        }
+    }
+    WHEN("starting while holding a target") {
+        tasks->_thermal_queue.backing_deque.push_back(
+            messages::SetTemperatureMessage{.id = 1, .target = 50});
+        tasks->_thermal_queue.backing_deque.push_back(
+            messages::StartAutotuneMessage{.id = 2, .target = 50, .cycles = 4});
+        tasks->_thermal_task.run_once(policy);
+        tasks->_thermal_task.run_once(policy);
+        THEN("it is rejected") {
+            static_cast<void>(take_ack());
+            REQUIRE(take_ack().with_error ==
+                    errors::ErrorCode::THERMAL_PELTIER_BUSY);
+        }
+    }
+    WHEN("starting an autotune around 21ºC over two cycles") {
+        tasks->_thermal_queue.backing_deque.push_back(
+            messages::StartAutotuneMessage{.id = 1, .target = 21, .cycles = 2});
+        tasks->_thermal_task.run_once(policy);
+        THEN("it is acked") {
+            auto ack = take_ack();
+            REQUIRE(ack.responding_to_id == 1);
+            REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            REQUIRE(tasks->_thermal_task.autotuning());
+        }
+        AND_WHEN("a reading below the target arrives") {
+            send_reading(20.5);
+            THEN("the peltier heats") { REQUIRE(policy.is_heating()); }
+        }
+        AND_WHEN("a reading above the target arrives") {
+            send_reading(22);
+            THEN("the peltier cools") { REQUIRE(policy.is_cooling()); }
+        }
+        AND_WHEN("setting a debug power") {
+            tasks->_comms_queue.backing_deque.clear();
+            tasks->_thermal_queue.backing_deque.push_back(
+                messages::SetPeltierDebugMessage{.id = 2, .power = 0.5});
+            tasks->_thermal_task.run_once(policy);
+            THEN("it is rejected") {
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::THERMAL_PELTIER_BUSY);
+            }
+        }
+        AND_WHEN("the plate oscillates 1ºC around the target every 2s") {
+            tasks->_comms_queue.backing_deque.clear();
+            for (int i = 0; i < 4; ++i) {
+                send_reading(22);
+                send_reading(20);
+            }
+            THEN("the new constants are applied and reported") {
+                std::vector<messages::AutotuneEvent> events;
+                for (auto &msg : tasks->_comms_queue.backing_deque) {
+                    using namespace messages;
+                    REQUIRE(!std::holds_alternative<ErrorMessage>(msg));
+                    if (std::holds_alternative<AutotuneEvent>(msg)) {
+                        events.push_back(std::get<AutotuneEvent>(msg));
+                    }
+                }
+                REQUIRE(events.size() == 1);
+                // Ku = 4 * 0.5 / (pi * sqrt(1 - 0.25^2)) and Tu = 2s
+                auto kp = 0.6 * 0.6575;
+                REQUIRE_THAT(events[0].kp,
+                             Catch::Matchers::WithinRel(kp, 0.02));
+                REQUIRE_THAT(events[0].ki,
+                             Catch::Matchers::WithinRel(kp, 0.02));
+                REQUIRE_THAT(events[0].kd,
+                             Catch::Matchers::WithinRel(kp * 0.25, 0.02));
+                auto pid = tasks->_thermal_task.get_pid();
+                REQUIRE(pid.kp() == events[0].kp);
+                auto &gains = tasks->_thermal_task.get_gain_schedule();
+                REQUIRE(gains.get(0, PIDDirection::COOLING).kp == events[0].kp);
+                REQUIRE(gains.get(2, PIDDirection::HEATING).kp == events[0].kp);
+            }
+            THEN("the peltier is turned off") {
+                REQUIRE(!policy._enabled);
+                REQUIRE(!tasks->_thermal_task.autotuning());
+            }
+        }
+        AND_WHEN("the plate never reaches the target") {
+            tasks->_comms_queue.backing_deque.clear();
+            send_reading(20.5, 1300 * 1000);
+            THEN("an autotune error is sent") {
+                REQUIRE(tasks->_comms_queue.has_message());
+                auto msg = tasks->_comms_queue.backing_deque.front();
+                REQUIRE(std::holds_alternative<messages::ErrorMessage>(msg));
+                REQUIRE(std::get<messages::ErrorMessage>(msg).code ==
+                        errors::ErrorCode::THERMAL_AUTOTUNE_FAILED);
+                REQUIRE(!policy._enabled);
+            }
+        }
+        AND_WHEN("both plate thermistors drop out") {
+            tasks->_comms_queue.backing_deque.clear();
+            timestamp += 1000;
+            tasks->_thermal_queue.backing_deque.push_back(
+                messages::ThermistorReadings{
+                    .plate_1 = 0,
+                    .plate_2 = 0,
+                    .heatsink = converter.backconvert(25),
+                    .plate_1_timestamp = timestamp,
+                    .plate_2_timestamp = timestamp,
+                    .heatsink_timestamp = timestamp});
+            tasks->_thermal_task.run_once(policy);
+            THEN("tuning stops and a thermistor error is sent") {
+                REQUIRE(!tasks->_thermal_task.autotuning());
+                REQUIRE(!policy._enabled);
+                REQUIRE(tasks->_comms_queue.has_message());
+                auto msg = tasks->_comms_queue.backing_deque.front();
+                REQUIRE(std::holds_alternative<messages::ErrorMessage>(msg));
+                REQUIRE(std::get<messages::ErrorMessage>(msg).code ==
+                        errors::ErrorCode::THERMAL_PLATE_THERMISTOR_ERROR);
+            }
+        }
+        AND_WHEN("deactivating") {
+            tasks->_thermal_queue.backing_deque.push_back(
+                messages::DeactivateAllMessage{.id = 3});
+            tasks->_thermal_task.run_once(policy);
+            tasks->_comms_queue.backing_deque.clear();
+            send_reading(20.5);
+            THEN("tuning stops and the peltier stays off") {
+                REQUIRE(!tasks->_thermal_task.autotuning());
+                REQUIRE(!policy._enabled);
+                REQUIRE(!tasks->_comms_queue.has_message());
+            }
+        }
+    }
+}
@@ -7,6 +7,8 @@ TEST_CASE("thermistor task functionality") {
     TestThermistorPolicy policy;
     policy.sleep_ms(123);
     policy._imeas_adc_val = 123;
+    static constexpr uint32_t CONVERSION_MS =
+        decltype(policy)::CONVERSION_MS;
     WHEN("thermistor task runs once") {
         tasks->_thermistor_task.run_once(policy);
         THEN("a Thermistor Message is sent to the thermal task") {
@@ -14,11 +16,15 @@ TEST_CASE("thermistor task functionality") {
             auto msg = tasks->_thermal_queue.backing_deque.front();
             REQUIRE(std::holds_alternative<messages::ThermistorReadings>(msg));
             auto therms = std::get<messages::ThermistorReadings>(msg);
-            REQUIRE(therms.timestamp == policy.get_time_ms());
             REQUIRE(therms.heatsink == decltype(policy)::READBACK_VALUE);
             REQUIRE(therms.plate_1 == decltype(policy)::READBACK_VALUE);
             REQUIRE(therms.plate_2 == decltype(policy)::READBACK_VALUE);
             REQUIRE(therms.imeas == policy._imeas_adc_val);
+            AND_THEN("each channel is stamped with when it was converted") {
+                REQUIRE(therms.plate_1_timestamp == 123 + CONVERSION_MS);
+                REQUIRE(therms.plate_2_timestamp == 123 + 2 * CONVERSION_MS);
+                REQUIRE(therms.heatsink_timestamp == 123 + 3 * CONVERSION_MS);
+            }
         }
         THEN("the adc was initialized") { REQUIRE(policy._initialized); }
         THEN("three channels of the adc were read") {
@@ -26,4 +32,44 @@ TEST_CASE("thermistor task functionality") {
             REQUIRE(policy._lock_count == 4);
         }
     }
+    WHEN("the first plate thermistor fails to read once") {
+        policy._failing_pin = 0;
+        policy._failing_pin_reads = 1;
+        tasks->_thermistor_task.run_once(policy);
+        REQUIRE(tasks->_thermal_queue.has_message());
+        auto therms = std::get<messages::ThermistorReadings>(
+            tasks->_thermal_queue.backing_deque.front());
+        THEN("the other channels are read without waiting for the retry") {
+            REQUIRE(therms.plate_2 == decltype(policy)::READBACK_VALUE);
+            REQUIRE(therms.heatsink == decltype(policy)::READBACK_VALUE);
+            REQUIRE(therms.plate_2_timestamp == 123 + 2 * CONVERSION_MS);
+            REQUIRE(therms.heatsink_timestamp == 123 + 3 * CONVERSION_MS);
+        }
+        THEN("the retry reads the failed channel") {
+            REQUIRE(therms.plate_1 == decltype(policy)::READBACK_VALUE);
+            REQUIRE(therms.plate_1_timestamp > therms.heatsink_timestamp);
+            REQUIRE(therms.plate_1_timestamp == policy.get_time_ms());
+            // Once per each channel, one retry + initialization
+            REQUIRE(policy._lock_count == 5);
+        }
+    }
+    WHEN("the heatsink thermistor never reads") {
+        policy._failing_pin = 2;
+        policy._failing_pin_reads = 100;
+        tasks->_thermistor_task.run_once(policy);
+        REQUIRE(tasks->_thermal_queue.has_message());
+        auto therms = std::get<messages::ThermistorReadings>(
+            tasks->_thermal_queue.backing_deque.front());
+        THEN("the heatsink reports the error after five tries") {
+            REQUIRE(therms.heatsink ==
+                    static_cast<uint32_t>(ADS1115::Error::I2CTimeout));
+            REQUIRE(policy._failing_pin_reads == 95);
+        }
+        THEN("the plate thermistors read normally") {
+            REQUIRE(therms.plate_1 == decltype(policy)::READBACK_VALUE);
+            REQUIRE(therms.plate_2 == decltype(policy)::READBACK_VALUE);
+            REQUIRE(therms.plate_1_timestamp == 123 + CONVERSION_MS);
+            REQUIRE(therms.plate_2_timestamp == 123 + 2 * CONVERSION_MS);
+        }
+    }
 }
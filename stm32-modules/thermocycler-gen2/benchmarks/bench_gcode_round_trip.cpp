@@ -0,0 +1,69 @@
+/**
+ * @file bench_gcode_round_trip.cpp
+ * @brief Replays a gcode stream through the Thermocycler's tasks
+ * and reports the round trip latency and allocations of each gcode.
+ *
+ * @details Usage: thermocycler-gen2-benchmarks [stream file] [repetitions]
+ */
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "benchmark/gcode_benchmark.hpp"
+#include "test/task_builder.hpp"
+#include "thermocycler-gen2/messages.hpp"
+
+static constexpr size_t DEFAULT_REPETITIONS = 1000;
+
+auto main(int argc, char* argv[]) -> int {
+    auto path = std::string(argc > 1 ? argv[1] : DEFAULT_STREAM);
+    auto repetitions = argc > 2 ? std::stoul(argv[2]) : DEFAULT_REPETITIONS;
+    auto file = std::ifstream(path);
+    if (!file) {
+        fprintf(stderr, "Could not open %s\n", path.c_str());
+        return 1;
+    }
+    auto stream = gcode_benchmark::load_stream(file);
+
+    auto tasks = TaskBuilder::build();
+    auto tx_buf = std::array<char, 1024>();
+    auto run_command = [&tasks, &tx_buf](const std::string& line,
+                                         std::string& response) {
+        static_cast<void>(tasks->get_host_comms_queue().try_send(
+            messages::IncomingMessageFromHost(line.data(),
+                                              line.data() + line.size())));
+        bool any = true;
+        while (any) {
+            any = false;
+            if (tasks->get_host_comms_queue().has_message()) {
+                auto* end = tasks->get_host_comms_task().run_once(
+                    tx_buf.begin(), tx_buf.end());
+                response.append(tx_buf.begin(), end);
+                any = true;
+            }
+            if (tasks->get_system_queue().has_message()) {
+                tasks->run_system_task();
+                any = true;
+            }
+            if (tasks->get_thermal_plate_queue().has_message()) {
+                tasks->run_thermal_plate_task();
+                any = true;
+            }
+            if (tasks->get_lid_heater_queue().has_message()) {
+                tasks->run_lid_heater_task();
+                any = true;
+            }
+            if (tasks->get_motor_queue().has_message()) {
+                tasks->run_motor_task();
+                any = true;
+            }
+        }
+    };
+
+    auto recorder = gcode_benchmark::Recorder();
+    auto failures =
+        gcode_benchmark::replay(stream, repetitions, run_command, recorder);
+    recorder.report("thermocycler-gen2");
+    return failures == 0 ? 0 : 1;
+}
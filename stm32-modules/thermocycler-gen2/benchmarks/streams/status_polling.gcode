@@ -0,0 +1,24 @@
+# Synthetic stream, written by hand to resemble a protocol run: the host
+# polls temperatures, lid and device status while setting plate and lid
+# targets. Replace it with captured host traffic when one is available.
+M115
+M119
+M105
+M141
+M104 S95 H30
+M105
+M141
+M140 S105
+M141
+M105
+M119
+M105
+M141
+M106
+M104 S4
+M105
+M141
+M108
+M105
+M141
+M18
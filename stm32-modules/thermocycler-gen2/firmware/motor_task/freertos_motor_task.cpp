@@ -6,7 +6,9 @@
 #include <array>
 
 #include "FreeRTOS.h"
+#include "firmware/firmware_task_stats.hpp"
 #include "firmware/freertos_message_queue.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/motor_hardware.h"
 #include "firmware/motor_policy.hpp"
 #include "task.h"
@@ -108,8 +110,19 @@ void run(void *param) {
         .seal_stepper_error = handle_seal_error,
         .seal_stepper_limit_switch = handle_seal_limit_switch};
     motor_hardware_setup(&callbacks);
+    auto &stats = firmware_task_stats::stats_for(tasks::TaskIndex::MOTOR);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        _task.run_once(_policy);
+        // Passes that do not start with a message would time the seal
+        // sampling wait along with the work, so only the others count
+        if (_task.runs_without_message()) {
+            _task.run_once(_policy);
+        } else {
+            _motor_queue.wait_for_message();
+            auto measure = task_stats::Measurement(stats, clock);
+            _task.run_once(_policy);
+        }
+        stats.record_queue_depth(_motor_queue.high_water_mark());
     }
 }
 
@@ -119,6 +132,7 @@ auto start()
     auto *handle = xTaskCreateStatic(run, "MotorControl", stack.size(), &_task,
                                      1, stack.data(), &main_data);
     _local_task = handle;
+    freertos_task_registry::register_task(handle, stack.size());
     _motor_queue.provide_handle(handle);
     return tasks::Task<TaskHandle_t, decltype(_task)>{.handle = handle,
                                                       .task = &_task};
@@ -97,6 +97,18 @@ auto MotorPolicy::tmc2130_transmit_receive(tmc2130::MessageT& data)
     return RxTxReturn();
 }
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto MotorPolicy::tmc2130_transmit_receive_burst(
+    std::span<tmc2130::MessageT> tx, std::span<tmc2130::MessageT> rx)
+    -> bool {
+    static_assert(sizeof(tmc2130::MessageT) == tmc2130::MESSAGE_LEN,
+                  "Burst transfers require tightly packed messages");
+    if (tx.size() != rx.size()) {
+        return false;
+    }
+    return motor_spi_sendreceive_burst(tx.front().data(), rx.front().data(),
+                                       tmc2130::MESSAGE_LEN, tx.size());
+}
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto MotorPolicy::tmc2130_set_enable(bool enable) -> bool {
     return motor_hardware_set_seal_enable(enable);
 }
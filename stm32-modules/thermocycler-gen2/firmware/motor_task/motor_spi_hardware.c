@@ -33,6 +33,10 @@
 #define MOTOR_SPI_NSS_PIN (GPIO_PIN_15)
 /** Maximum length of a SPI transaction is 5 bytes.*/
 #define MOTOR_MAX_SPI_LEN (5)
+/** Number of NOP cycles to hold NSS high between frames in a burst. The
+ *  TMC2130 latches each datagram on the rising edge of NSS, so it must
+ *  see a distinct high pulse between frames.*/
+#define MOTOR_SPI_NSS_HIGH_CYCLES (40)
 
 /** Get a single byte out of a 64 bit value. Higher values are
  *  more significant (0 = LSB, 3 = MSB)*/
@@ -41,22 +45,44 @@
  * values are more significant (0 = LSB, 3 = MSB).*/
 #define SET_BYTE(val, byte) (((uint64_t)val) << (byte * 8))
 
+struct motor_spi_burst {
+    uint8_t *in;
+    uint8_t *out;
+    size_t frame_len;
+    size_t frames_remaining;
+    bool error;
+};
+
 struct motor_spi_hardware {
     SPI_HandleTypeDef handle;
+    DMA_HandleTypeDef dma_rx;
+    DMA_HandleTypeDef dma_tx;
     TaskHandle_t task_to_notify;
+    struct motor_spi_burst burst;
     bool initialized;
 };
 
 // STATIC VARIABLES
 static struct motor_spi_hardware _spi = {
     .handle = {0},
+    .dma_rx = {0},
+    .dma_tx = {0},
     .task_to_notify =  NULL,
+    .burst = {
+        .in = NULL,
+        .out = NULL,
+        .frame_len = 0,
+        .frames_remaining = 0,
+        .error = false
+    },
     .initialized = false
 };
 
 // STATIC FUNCTION DEFINITIONS
 static void spi_interrupt_service(void);
 static void spi_set_nss(bool selected);
+static void spi_dma_init(void);
+static bool spi_start_frame(void);
 
 // PUBLIC FUNCTION IMPLEMENTATION
 
@@ -81,6 +107,8 @@ void motor_spi_initialize(void) {
         ret = HAL_SPI_Init(&_spi.handle);
         configASSERT(ret == HAL_OK);
 
+        spi_dma_init();
+
         // Initialize the GPIO
         GPIO_InitTypeDef gpio = {0};
         __HAL_RCC_GPIOD_CLK_ENABLE();
@@ -96,28 +124,40 @@ void motor_spi_initialize(void) {
 }
 
 bool motor_spi_sendreceive(uint8_t *in, uint8_t *out, size_t len) {
+    return motor_spi_sendreceive_burst(in, out, len, 1);
+}
+
+bool motor_spi_sendreceive_burst(uint8_t *in, uint8_t *out, size_t frame_len,
+                                 size_t frames) {
     const TickType_t max_block_time = pdMS_TO_TICKS(100);
-    HAL_StatusTypeDef ret;
     uint32_t notification_val = 0;
 
-    if(!_spi.initialized || (_spi.task_to_notify != NULL) || (len > MOTOR_MAX_SPI_LEN)) { 
+    if(!_spi.initialized || (_spi.task_to_notify != NULL) ||
+       (frame_len > MOTOR_MAX_SPI_LEN) || (frame_len == 0) || (frames == 0)) {
         return false;
     }
-    spi_set_nss(true);
+    _spi.burst.in = in;
+    _spi.burst.out = out;
+    _spi.burst.frame_len = frame_len;
+    _spi.burst.frames_remaining = frames;
+    _spi.burst.error = false;
     _spi.task_to_notify = xTaskGetCurrentTaskHandle();
-    ret = HAL_SPI_TransmitReceive_IT(&_spi.handle, in, out, len);
-    if(ret != HAL_OK) {
+
+    spi_set_nss(true);
+    if(!spi_start_frame()) {
+        spi_set_nss(false);
         _spi.task_to_notify = NULL;
         return false;
     }
+    // Every following frame is chained from the DMA completion interrupt,
+    // so the task only wakes up once the whole burst is done.
     notification_val = ulTaskNotifyTake(pdTRUE, max_block_time);
     spi_set_nss(false);
-    // If the task was preempted by the error handler rather than the
-    // TxRx complete callback, the remaining count should be greater
-    // than 0.
-    if((notification_val != 1) || (_spi.handle.RxXferCount > 0)) {
+    if((notification_val != 1) || _spi.burst.error ||
+       (_spi.burst.frames_remaining > 0)) {
+        (void)HAL_SPI_Abort(&_spi.handle);
         _spi.task_to_notify = NULL;
-        return true;
+        return false;
     }
     return true;
 }
@@ -127,6 +167,16 @@ void SPI2_IRQHandler(void)
   HAL_SPI_IRQHandler(&_spi.handle);
 }
 
+void DMA1_Channel4_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&_spi.dma_rx);
+}
+
+void DMA1_Channel5_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&_spi.dma_tx);
+}
+
 // STATIC FUNCTION IMPLEMENTATION
 
 static void spi_interrupt_service(void) {
@@ -144,20 +194,89 @@ static void spi_set_nss(bool selected) {
         (selected) ? GPIO_PIN_RESET : GPIO_PIN_SET);
 }
 
+/**
+ * @brief Configure DMA1 channels 4 (RX) and 5 (TX) for SPI2. Channels 1-3
+ * are already claimed by the LED and fan tachometer drivers.
+ */
+static void spi_dma_init(void) {
+    HAL_StatusTypeDef ret;
+
+    __HAL_RCC_DMAMUX1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    _spi.dma_rx.Instance = DMA1_Channel4;
+    _spi.dma_rx.Init.Request = DMA_REQUEST_SPI2_RX;
+    _spi.dma_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    _spi.dma_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    _spi.dma_rx.Init.MemInc = DMA_MINC_ENABLE;
+    _spi.dma_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    _spi.dma_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    _spi.dma_rx.Init.Mode = DMA_NORMAL;
+    _spi.dma_rx.Init.Priority = DMA_PRIORITY_MEDIUM;
+    ret = HAL_DMA_Init(&_spi.dma_rx);
+    configASSERT(ret == HAL_OK);
+    __HAL_LINKDMA(&_spi.handle, hdmarx, _spi.dma_rx);
+
+    _spi.dma_tx.Instance = DMA1_Channel5;
+    _spi.dma_tx.Init.Request = DMA_REQUEST_SPI2_TX;
+    _spi.dma_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    _spi.dma_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    _spi.dma_tx.Init.MemInc = DMA_MINC_ENABLE;
+    _spi.dma_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    _spi.dma_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    _spi.dma_tx.Init.Mode = DMA_NORMAL;
+    _spi.dma_tx.Init.Priority = DMA_PRIORITY_MEDIUM;
+    ret = HAL_DMA_Init(&_spi.dma_tx);
+    configASSERT(ret == HAL_OK);
+    __HAL_LINKDMA(&_spi.handle, hdmatx, _spi.dma_tx);
+
+    HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+}
+
+/**
+ * @brief Start the DMA transfer for the next frame of the active burst.
+ * NSS must already be asserted.
+ */
+static bool spi_start_frame(void) {
+    HAL_StatusTypeDef ret = HAL_SPI_TransmitReceive_DMA(
+        &_spi.handle, _spi.burst.in, _spi.burst.out,
+        _spi.burst.frame_len);
+    return ret == HAL_OK;
+}
+
 /**
  * @brief Overwritten HAL function for SPI TxRx Complete Callback.
- * @details If a task is blocked waiting for the SPI transaction to finish,
- * this function unblocks that task.
+ * @details If there are more frames in the active burst, NSS is pulsed
+ * to latch the finished datagram and the next frame is started. Once the
+ * burst is finished, the blocked task is unblocked.
  */
 void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+    --_spi.burst.frames_remaining;
+    if(_spi.burst.frames_remaining > 0) {
+        spi_set_nss(false);
+        for(volatile uint32_t i = 0; i < MOTOR_SPI_NSS_HIGH_CYCLES; ++i) {
+            __NOP();
+        }
+        spi_set_nss(true);
+        _spi.burst.in += _spi.burst.frame_len;
+        _spi.burst.out += _spi.burst.frame_len;
+        if(spi_start_frame()) {
+            return;
+        }
+        _spi.burst.error = true;
+    }
     spi_interrupt_service();
 }
 
 /**
  * @brief Overwritten HAL function for SPI Error Callback.
  * @details If a task is blocked waiting for the SPI transaction to finish,
- * this function unblocks that task.
+ * this function aborts the burst and unblocks that task.
  */
 void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+    _spi.burst.error = true;
     spi_interrupt_service();
 }
@@ -8,7 +8,9 @@
 
 #include "FreeRTOS.h"
 #include "core/timer.hpp"
+#include "firmware/firmware_task_stats.hpp"
 #include "firmware/freertos_message_queue.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/freertos_timer.hpp"
 #include "firmware/system_hardware.h"
 #include "firmware/system_led_hardware.h"
@@ -132,10 +134,18 @@ static void run(void *param) {
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
     auto *task = reinterpret_cast<decltype(_task) *>(param);
 
+    freertos_task_registry::register_kernel_tasks();
     _led_timer.start();
     system_set_systick_callback(systick_callback);
+    auto &stats = firmware_task_stats::stats_for(tasks::TaskIndex::SYSTEM);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        task->run_once(policy);
+        _system_queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            task->run_once(policy);
+        }
+        stats.record_queue_depth(_system_queue.high_water_mark());
     }
 }
 
@@ -145,10 +155,12 @@ auto start() -> tasks::Task<TaskHandle_t,
     auto *handle = xTaskCreateStatic(run, "SystemControl", stack.size(), &_task,
                                      1, stack.data(), &data);
     _system_queue.provide_handle(handle);
+    freertos_task_registry::register_task(handle, stack.size());
 
-    static_cast<void>(xTaskCreateStatic(run_button_task, "FrontButton",
-                                        button_stack.size(), nullptr, 1,
-                                        button_stack.data(), &button_data));
+    auto *button_handle =
+        xTaskCreateStatic(run_button_task, "FrontButton", button_stack.size(),
+                          nullptr, 1, button_stack.data(), &button_data);
+    freertos_task_registry::register_task(button_handle, button_stack.size());
     return tasks::Task<TaskHandle_t, decltype(_task)>{.handle = handle,
                                                       .task = &_task};
 }
@@ -8,6 +8,7 @@
 #include "firmware/freertos_system_task.hpp"
 #include "firmware/freertos_thermal_plate_task.hpp"
 #include "firmware/system_hardware.h"
+#include "firmware/task_stats_hardware.h"
 #include "system_stm32g4xx.h"
 #include "thermocycler-gen2/board_revision.hpp"
 #include "thermocycler-gen2/tasks.hpp"
@@ -17,6 +18,7 @@ tasks::Tasks<FreeRTOSMessageQueue> tasks_aggregator;
 
 auto main() -> int {
     HardwareInit();
+    task_stats_hardware_init();
     // Read the board revision here to make sure it's cached for the rest
     // of program execution
     auto revision = board_revision::BoardRevisionIface::get();
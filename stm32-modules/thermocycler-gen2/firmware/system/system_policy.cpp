@@ -4,6 +4,7 @@
 #include <iterator>
 #include <ranges>
 
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/system_hardware.h"
 #include "firmware/system_led_hardware.h"
 #include "system_serial_number.h"
@@ -86,3 +87,20 @@ auto SystemPolicy::wait_for_interrupt(uint32_t timeout_ms) -> bool {
 [[nodiscard]] auto SystemPolicy::get_max_pwm() -> uint16_t {
     return system_led_max_pwm();
 }
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+[[nodiscard]] auto SystemPolicy::get_task_count() const -> size_t {
+    return freertos_task_registry::task_count();
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+[[nodiscard]] auto SystemPolicy::get_stack_usage(size_t index) const
+    -> task_memory::StackUsage {
+    return freertos_task_registry::stack_usage(index);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+[[nodiscard]] auto SystemPolicy::get_ram_usage() const
+    -> task_memory::RamUsage {
+    return freertos_task_registry::ram_usage();
+}
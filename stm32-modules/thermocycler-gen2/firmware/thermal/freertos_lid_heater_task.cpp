@@ -6,6 +6,8 @@
 
 #include "FreeRTOS.h"
 #include "core/ads1115.hpp"
+#include "firmware/firmware_task_stats.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/lid_heater_policy.hpp"
 #include "firmware/thermal_adc_policy.hpp"
 #include "firmware/thermal_hardware.h"
@@ -55,8 +57,15 @@ static void run(void *param) {
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
     auto *task = reinterpret_cast<decltype(_main_task) *>(param);
     auto policy = LidHeaterPolicy();
+    auto &stats = firmware_task_stats::stats_for(tasks::TaskIndex::LID_HEATER);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        task->run_once(policy);
+        _lid_heater_queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            task->run_once(policy);
+        }
+        stats.record_queue_depth(_lid_heater_queue.high_water_mark());
     }
 }
 
@@ -72,6 +81,12 @@ static void run_thermistor_task(void *param) {
     static_cast<void>(param);
     thermal_hardware_setup();
     _adc.initialize();
+    static constexpr uint32_t US_PER_MS = 1000;
+    static constexpr uint32_t PERIOD_US =
+        decltype(_main_task)::CONTROL_PERIOD_TICKS * US_PER_MS;
+    auto &stats =
+        firmware_task_stats::stats_for(tasks::TaskIndex::LID_THERMISTOR);
+    auto clock = firmware_task_stats::DWTCycleClock();
     auto last_wake_time = xTaskGetTickCount();
     messages::LidTempReadComplete readings{};
     while (true) {
@@ -79,6 +94,8 @@ static void run_thermistor_task(void *param) {
             &last_wake_time,
             // NOLINTNEXTLINE(readability-static-accessed-through-instance)
             _main_task.CONTROL_PERIOD_TICKS);
+        stats.record_wakeup(PERIOD_US, clock);
+        auto measure = task_stats::Measurement(stats, clock);
         bool done = false;
         uint8_t retries = 0;
         auto result = _adc.read(_adc_lid_pin);
@@ -116,6 +133,9 @@ auto start()
         run_thermistor_task, "LidHeaterThermistors", _thermistor_stack.size(),
         &_main_task, 1, _thermistor_stack.data(), &_thermistor_data);
     configASSERT(thermistor_handle != nullptr);
+    freertos_task_registry::register_task(handle, _stack.size());
+    freertos_task_registry::register_task(thermistor_handle,
+                                          _thermistor_stack.size());
     return tasks::Task<TaskHandle_t, decltype(_main_task)>{.handle = handle,
                                                            .task = &_main_task};
 }
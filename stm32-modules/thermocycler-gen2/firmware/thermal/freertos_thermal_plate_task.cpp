@@ -8,6 +8,8 @@
 
 #include "FreeRTOS.h"
 #include "core/ads1115.hpp"
+#include "firmware/firmware_task_stats.hpp"
+#include "firmware/freertos_task_registry.hpp"
 #include "firmware/thermal_adc_policy.hpp"
 #include "firmware/thermal_hardware.h"
 #include "firmware/thermal_plate_policy.hpp"
@@ -106,8 +108,16 @@ static void run(void *param) {
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
     auto *task = reinterpret_cast<decltype(_main_task) *>(param);
     auto policy = plate_policy::ThermalPlatePolicy();
+    auto &stats =
+        firmware_task_stats::stats_for(tasks::TaskIndex::THERMAL_PLATE);
+    auto clock = firmware_task_stats::DWTCycleClock();
     while (true) {
-        task->run_once(policy);
+        _thermal_plate_queue.wait_for_message();
+        {
+            auto measure = task_stats::Measurement(stats, clock);
+            task->run_once(policy);
+        }
+        stats.record_queue_depth(_thermal_plate_queue.high_water_mark());
     }
 }
 
@@ -124,6 +134,12 @@ static void run_thermistor_task(void *param) {
     thermal_hardware_setup();
     _adc[ADC_FRONT].initialize();
     _adc[ADC_REAR].initialize();
+    static constexpr uint32_t US_PER_MS = 1000;
+    static constexpr uint32_t PERIOD_US =
+        decltype(_main_task)::CONTROL_PERIOD_TICKS * US_PER_MS;
+    auto &stats =
+        firmware_task_stats::stats_for(tasks::TaskIndex::PLATE_THERMISTOR);
+    auto clock = firmware_task_stats::DWTCycleClock();
     auto last_wake_time = xTaskGetTickCount();
     messages::ThermalPlateTempReadComplete readings{};
     while (true) {
@@ -131,6 +147,8 @@ static void run_thermistor_task(void *param) {
             &last_wake_time,
             // NOLINTNEXTLINE(readability-static-accessed-through-instance)
             _main_task.CONTROL_PERIOD_TICKS);
+        stats.record_wakeup(PERIOD_US, clock);
+        auto measure = task_stats::Measurement(stats, clock);
         readings.front_right = read_thermistor(
             _adc_map[thermal_general::ThermistorID::THERM_FRONT_RIGHT]);
         readings.front_left = read_thermistor(
@@ -161,9 +179,12 @@ auto start()
                                      &_main_task, 1, _stack.data(), &data);
     _thermal_plate_queue.provide_handle(handle);
     auto *thermistor_handle = xTaskCreateStatic(
-        run_thermistor_task, "LidHeaterThermistors", _thermistor_stack.size(),
+        run_thermistor_task, "PlateThermistors", _thermistor_stack.size(),
         &_main_task, 1, _thermistor_stack.data(), &_thermistor_data);
     configASSERT(thermistor_handle != nullptr);
+    freertos_task_registry::register_task(handle, _stack.size());
+    freertos_task_registry::register_task(thermistor_handle,
+                                          _thermistor_stack.size());
     return tasks::Task<TaskHandle_t, decltype(_main_task)>{.handle = handle,
                                                            .task = &_main_task};
 }
@@ -3,6 +3,7 @@
 # Script to get the step responses from the system
 import test_utils 
 import serial
+import argparse
 import datetime
 import time
 import csv
@@ -77,6 +78,45 @@ def write_csv(filename: str, data: List[Tuple[float, float, float]]):
         ['time', 'power', 'reading'])
     writer.writerows(data)
 
+def read_csv(filename: str) -> List[Tuple[float, float, float]]:
+    data = []
+    with open(filename, 'r') as input_file:
+        for row in csv.reader(input_file):
+            try:
+                data.append(tuple(float(val) for val in row))
+            except ValueError:
+                # Title and header rows
+                continue
+    return data
+
+# Fits the first-order plate model that the firmware uses for feed-forward
+# control to a step response:
+#    dT/dt = gain * power + loss * (heatsink - T)
+# The heatsink is assumed to stay at the temperature the plate started at,
+# so only the start of the step (with the fans off) should be used.
+# Returns (gain, loss), which can be sent with M306.
+def identify_plate_model(data: List[Tuple[float, float, float]]) -> Tuple[float, float]:
+    heatsink = data[0][2]
+    # Least squares over the two regressors, using the rate between each
+    # pair of samples and the conditions at the first sample of the pair
+    spp = spl = sll = spr = slr = 0.0
+    for (t0, power, temp0), (t1, _, temp1) in zip(data, data[1:]):
+        if t1 <= t0:
+            continue
+        rate = (temp1 - temp0) / (t1 - t0)
+        leak = heatsink - temp0
+        spp += power * power
+        spl += power * leak
+        sll += leak * leak
+        spr += power * rate
+        slr += leak * rate
+    det = (spp * sll) - (spl * spl)
+    if det == 0:
+        raise RuntimeError('Step response does not identify the model')
+    gain = ((spr * sll) - (slr * spl)) / det
+    loss = ((slr * spp) - (spr * spl)) / det
+    return (gain, loss)
+
 def set_whole_power(ser: serial.Serial, power: float):
     direction = 'C'
     if power > 0:
@@ -96,7 +136,23 @@ def get_lid_temp(ser: serial.Serial):
     print(f'Lid reading: {ret}')
     return ret
 
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='Capture thermocycler step responses')
+    parser.add_argument('-f', '--fit', type=str, default=None,
+        help='fit the plate model to an existing peltier capture and exit')
+    return parser.parse_args()
+
+def print_plate_model(data: List[Tuple[float, float, float]]):
+    gain, loss = identify_plate_model(data)
+    print(f'Plate model: gain {gain:.4f} loss {loss:.6f}')
+    print(f'Send to the device with: M306 G{gain:.4f} L{loss:.6f}')
+
 if __name__ == '__main__':
+    args = parse_args()
+    if args.fit:
+        print_plate_model(read_csv(args.fit))
+        exit(0)
     print('Testing peltier system')
     ser = test_utils.build_serial()
     main_tester = StepResponse(set_whole_power, get_whole_temperature, 1, 95, 100, 0.1)
@@ -106,6 +162,7 @@ if __name__ == '__main__':
     test_utils.set_fans_automatic(ser)
     print('Test done, exporting data')
     write_csv('main', main_tester.data)
+    print_plate_model(main_tester.data)
 
     print('Testing lid heater system')
     lid_tester = StepResponse(set_lid_power, get_lid_temp, 1, 80, 100, 0.1)
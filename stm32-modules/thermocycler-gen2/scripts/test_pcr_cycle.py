@@ -58,6 +58,26 @@ def cycle(ser : serial.Serial, volume: float):
     test_utils.set_plate_temperature(targets[0][0], ser, targets[0][1], volume=volume)
     plot_temp.graphTemperatures(ser, update_callback)
 
+def cycle_on_device(ser : serial.Serial, volume: float, cycles: int):
+    # Initial denature, then the same cycle as above repeated on the device,
+    # then a cold hold. Format is target temp, hold time, and optionally the
+    # step to loop back to and how many more times to do so.
+    steps = [
+        (94.0, 10.0),
+        (94.0, 10.0),
+        (70.0, 30.0),
+        (72.0, 30.0, 1, cycles - 1),
+        (4.0, 0.0) ]
+    test_utils.upload_thermal_program(steps, ser, volume=volume)
+    test_utils.start_thermal_program(ser, lid_target=105)
+    running = True
+    while running:
+        time.sleep(1)
+        running, step, executed, total = test_utils.get_thermal_program_status(ser)
+        print(f'Step {step}: {executed} of {total} steps run')
+        sys.stdout.flush()
+    print('Done cycling')
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser(description="Run a simple PCR cycle")
     parser.add_argument('-s', '--socket', type=int, required=False, 
@@ -66,6 +86,8 @@ if __name__ == '__main__':
                         metavar=('P','I','D'), 
                         help='define P, I, and D constants for control')
     parser.add_argument('-v', '--volume', type=float, required=False, default=25, help='volume in µL')
+    parser.add_argument('-d', '--on-device', type=int, required=False, metavar='CYCLES',
+                        help='run the cycle as a program on the device, repeating it CYCLES times')
     args = parser.parse_args()
     if args.socket:
         print(f"Opening socket at localhost:{args.socket}")
@@ -79,6 +101,9 @@ if __name__ == '__main__':
         test_utils.set_peltier_pid(args.constants[0], args.constants[1], args.constants[2], ser)
 
     test_utils.set_lid_temperature(105, ser)
-    cycle(ser, args.volume)
+    if args.on_device:
+        cycle_on_device(ser, args.volume, args.on_device)
+    else:
+        cycle(ser, args.volume)
     test_utils.deactivate_lid(ser)
     test_utils.deactivate_plate(ser)
@@ -169,6 +169,50 @@ def set_fans_automatic(ser: serial.Serial):
     guard_error(res, b'M107 OK')
     print(res)
 
+# Sets the plate thermal model used for feed-forward control
+def set_plate_model(ser: serial.Serial, gain: float, loss: float):
+    print(f'Setting plate model to gain {gain} loss {loss}')
+    ser.write(f'M306 G{gain} L{loss}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M306 OK')
+    print(res)
+
+# Runs a relay autotune of the peltier PID constants and waits for the
+# result, which can take several minutes. Returns (kp, ki, kd).
+def plate_autotune(ser: serial.Serial, target: float, cycles: int = 4,
+                   save: bool = False):
+    print(f'Autotuning peltiers around {target}C over {cycles} cycles')
+    save_arg = ' W' if save else ''
+    ser.write(f'M303 S{target} C{cycles}{save_arg}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M303 OK')
+    while True:
+        res = ser.readline()
+        if res.startswith(b'async ERR'):
+            raise RuntimeError(res)
+        if res.startswith(b'async M303 DONE'):
+            break
+    print(res)
+    values = dict(field.split(':') for field in res.split()[3:6])
+    return float(values[b'P']), float(values[b'I']), float(values[b'D'])
+
+# Runs a relay autotune of the lid heater PID constants and waits for the
+# result, which can take several minutes. Returns (kp, ki, kd).
+def lid_autotune(ser: serial.Serial, target: float, cycles: int = 4):
+    print(f'Autotuning lid heater around {target}C over {cycles} cycles')
+    ser.write(f'M303 S{target} C{cycles} H\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M303 OK')
+    while True:
+        res = ser.readline()
+        if res.startswith(b'async ERR'):
+            raise RuntimeError(res)
+        if res.startswith(b'async M303 H DONE'):
+            break
+    print(res)
+    values = dict(field.split(':') for field in res.split()[4:7])
+    return float(values[b'P']), float(values[b'I']), float(values[b'D'])
+
 # Sets heater PWM as a percentage.
 def set_heater_debug(power: float, ser: serial.Serial):
     if(power< 0.0 or power > 1.0):
@@ -224,6 +268,56 @@ def deactivate_plate(ser: serial.Serial):
     guard_error(res, b'M14 OK')
     print(res)
 
+# Read a response, printing any async messages that arrive before it
+def readline_skip_async(ser: serial.Serial) -> bytes:
+    res = ser.readline()
+    while res.startswith(b'async'):
+        print(res)
+        res = ser.readline()
+    return res
+
+# Upload a thermal program to run on the device. Each step is a tuple of
+# (temperature, hold time), optionally followed by (loop to, loop count) to
+# jump back to an earlier step that many more times after this one.
+def upload_thermal_program(steps: List[Tuple], ser: serial.Serial, volume: float = None):
+    print(f'Uploading a thermal program with {len(steps)} steps')
+    for index, step in enumerate(steps):
+        toWrite = f'M170 I{index} S{step[0]} H{step[1]}'
+        if(volume):
+            toWrite = toWrite + f' V{volume}'
+        if len(step) > 2:
+            toWrite = toWrite + f' J{step[2]} C{step[3]}'
+        toWrite = toWrite + '\n'
+        ser.write(toWrite.encode())
+        res = readline_skip_async(ser)
+        guard_error(res, b'M170 OK')
+
+# Start the uploaded thermal program, optionally heating the lid too
+def start_thermal_program(ser: serial.Serial, lid_target: float = None,
+                          feed_forward: bool = False):
+    print('Starting thermal program')
+    toWrite = 'M171'
+    if(lid_target):
+        toWrite = toWrite + f' L{lid_target}'
+    if(feed_forward):
+        toWrite = toWrite + ' F'
+    toWrite = toWrite + '\n'
+    ser.write(toWrite.encode())
+    res = readline_skip_async(ser)
+    guard_error(res, b'M171 OK')
+    print(res)
+
+_PROGRAM_STATUS_RE = re.compile('^M172 R:(?P<running>.+) I:(?P<step>.+) N:(?P<count>.+) E:(?P<executed>.+) T:(?P<total>.+) L:(?P<lid>.+) OK\n')
+
+# Returns (running, current step, steps run, total steps)
+def get_thermal_program_status(ser: serial.Serial) -> Tuple[bool, int, int, int]:
+    ser.write(b'M172\n')
+    res = readline_skip_async(ser)
+    guard_error(res, b'M172')
+    match = re.match(_PROGRAM_STATUS_RE, res.decode())
+    return (match.group('running') == '1', int(match.group('step')),
+            int(match.group('executed')), int(match.group('total')))
+
 # Set the peltier PID constants
 def set_peltier_pid(p: float, i: float, d: float, ser: serial.Serial):
     print(f'Setting peltier PID to P={p} I={i} D={d}')
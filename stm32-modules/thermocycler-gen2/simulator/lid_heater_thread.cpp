@@ -41,15 +41,18 @@ struct lid_heater_thread::TaskControlBlock {
 
 auto run(
     std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
-    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data)
-    -> void {
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats) -> void {
     using namespace std::literals::chrono_literals;
     auto policy = SimLidHeaterPolicy(periodic_data);
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
         auto last_update_before = tcb->task.get_last_temp_update();
         try {
-            tcb->task.run_once(policy);
+            tcb->queue.wait_for_message();
+            sim_task_stats::timed_pass(*stats, tasks::TaskIndex::LID_HEATER,
+                                       tcb->queue,
+                                       [&]() { tcb->task.run_once(policy); });
         } catch (const SimLidHeaterTask::Queue::StopDuringMsgWait sdmw) {
             return;
         }
@@ -62,9 +65,27 @@ auto run(
 }
 
 auto lid_heater_thread::build(
-    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data)
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb, periodic_data),
+    return tasks::Task(std::make_unique<std::jthread>(run, tcb, periodic_data,
+                                                      std::move(stats)),
                        &tcb->task);
 }
+
+auto lid_heater_thread::build(
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats, sim_scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    auto policy = std::make_shared<SimLidHeaterPolicy>(periodic_data);
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, policy, stats]() {
+            sim_task_stats::timed_pass(*stats, tasks::TaskIndex::LID_HEATER,
+                                       tcb->queue,
+                                       [&]() { tcb->task.run_once(*policy); });
+        });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
+}
@@ -7,8 +7,10 @@
 #include "simulator/motor_thread.hpp"
 #include "simulator/periodic_data_thread.hpp"
 #include "simulator/sim_driver.hpp"
+#include "simulator/sim_scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "simulator/system_thread.hpp"
+#include "simulator/thermal_network.hpp"
 #include "simulator/thermal_plate_thread.hpp"
 #include "thermocycler-gen2/tasks.hpp"
 
@@ -20,34 +22,70 @@ int main(int argc, char *argv[]) {
     auto realtime =
         cli_ret.second || cli_parser::check_realtime_environment_variable();
 
-    auto periodic_data = periodic_data_thread::build(realtime);
+    auto network = thermal_network::load_from_environment(
+        "THERMAL_NETWORK_FILE", periodic_data_thread::DEFAULT_THERMAL_NETWORK);
+    if (!network.has_value()) {
+        return 1;
+    }
 
-    auto system = system_thread::build();
-    auto thermal_plate = thermal_plate_thread::build(periodic_data.second);
-    auto lid_heater = lid_heater_thread::build(periodic_data.second);
-    auto motor = motor_thread::build();
-    auto comms = comm_thread::build(std::move(sim_driver));
+    // In simulated time every task runs from one scheduler thread on a
+    // virtual clock, rather than from its own thread
+    auto scheduler = sim_scheduler::Scheduler();
+    auto periodic_data =
+        realtime ? periodic_data_thread::build(std::move(network.value()),
+                                               realtime)
+                 : periodic_data_thread::build(std::move(network.value()),
+                                               scheduler);
+
+    auto stats = std::make_shared<tasks::TaskStatsRegistry>(tasks::TASK_NAMES);
+    auto system = realtime ? system_thread::build(stats)
+                           : system_thread::build(stats, scheduler);
+    auto thermal_plate =
+        realtime
+            ? thermal_plate_thread::build(periodic_data.second, stats)
+            : thermal_plate_thread::build(periodic_data.second, stats,
+                                          scheduler);
+    auto lid_heater =
+        realtime
+            ? lid_heater_thread::build(periodic_data.second, stats)
+            : lid_heater_thread::build(periodic_data.second, stats, scheduler);
+    auto motor = realtime ? motor_thread::build(stats)
+                          : motor_thread::build(stats, scheduler);
+    auto comms =
+        realtime ? comm_thread::build(std::move(sim_driver), stats)
+                 : comm_thread::build(std::move(sim_driver), stats, scheduler);
     auto tasks = tasks::Tasks<SimulatorMessageQueue>(
         comms.task, system.task, thermal_plate.task, lid_heater.task,
         motor.task);
 
     periodic_data.second->provide_tasks(&tasks);
 
-    comm_thread::handle_input(std::move(sim_driver), tasks);
-
-    system.handle->request_stop();
-    comms.handle->request_stop();
-    thermal_plate.handle->request_stop();
-    lid_heater.handle->request_stop();
-    motor.handle->request_stop();
-    periodic_data.first->request_stop();
-
-    system.handle->join();
-    comms.handle->join();
-    thermal_plate.handle->join();
-    lid_heater.handle->join();
-    motor.handle->join();
-    periodic_data.first->join();
+    auto scheduler_thread = std::unique_ptr<std::jthread>();
+    if (!realtime) {
+        scheduler_thread = std::make_unique<std::jthread>(
+            [&scheduler](std::stop_token st) { scheduler.run(st); });
+    }
+
+    if (realtime) {
+        comm_thread::handle_input(std::move(sim_driver), tasks);
+    } else {
+        comm_thread::handle_input(std::move(sim_driver), tasks, scheduler);
+    }
+
+    // Only the handles of tasks that run in their own thread are populated
+    auto stop = [](std::unique_ptr<std::jthread>& thread) {
+        if (thread) {
+            thread->request_stop();
+            thread->join();
+        }
+    };
+    stop(scheduler_thread);
+    stop(system.handle);
+    stop(comms.handle);
+    stop(thermal_plate.handle);
+    stop(lid_heater.handle);
+    stop(motor.handle);
+    stop(periodic_data.first);
 
     return 0;
 }
@@ -168,21 +168,47 @@ struct motor_thread::TaskControlBlock {
     SimMotorTask task;
 };
 
-auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
+auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
+         sim_task_stats::SharedRegistry stats) -> void {
     using namespace std::literals::chrono_literals;
     auto policy = SimMotorPolicy(tcb->queue);
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
-            tcb->task.run_once(policy);
+            // As on the firmware, only passes started by a message are timed
+            if (tcb->task.runs_without_message()) {
+                tcb->task.run_once(policy);
+            } else {
+                tcb->queue.wait_for_message();
+                sim_task_stats::timed_pass(
+                    *stats, tasks::TaskIndex::MOTOR, tcb->queue,
+                    [&]() { tcb->task.run_once(policy); });
+            }
         } catch (const SimMotorTask::Queue::StopDuringMsgWait sdmw) {
             return;
         }
     }
 }
 
-auto motor_thread::build()
+auto motor_thread::build(sim_task_stats::SharedRegistry stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    return tasks::Task(
+        std::make_unique<std::jthread>(run, tcb, std::move(stats)),
+        &tcb->task);
+}
+
+auto motor_thread::build(sim_task_stats::SharedRegistry stats,
+                         sim_scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
+    auto policy = std::make_shared<SimMotorPolicy>(tcb->queue);
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, policy, stats]() {
+            sim_task_stats::timed_pass(*stats, tasks::TaskIndex::MOTOR,
+                                       tcb->queue,
+                                       [&]() { tcb->task.run_once(*policy); });
+        });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
 }
@@ -5,7 +5,9 @@
  * @details
  * This module simulates any periodic data on the Thermocycler system.
  * Specifically, it generates periodic thermistor data for all of the
- * thermal elements and calls the Motor Step tick.
+ * thermal elements and calls the Motor Step tick. Temperatures come from a
+ * \ref thermal_network::ThermalNetwork that is advanced by the simulated
+ * time between loops, driven by the latest lid and peltier outputs.
  *
  */
 
@@ -21,35 +23,25 @@
 
 using namespace periodic_data_thread;
 
-/** Default starting temperature for all thermistors.*/
-static constexpr const double AMBIENT_TEMPERATURE = 23.0F;
-/** Gain term for peltier outputs, from experimental data.*/
-static constexpr const double PELTIER_GAIN = 3.2F;
-/** Gain term for lid heater output, from experimental data.*/
-static constexpr const double HEAT_PAD_GAIN = 0.72;
-/**
- * Gain term for bringing temperature back down to ambient. Scaled against
- * the difference between a temperature and its ambient condition. The
- * constant is derived from rough modeling against the lid heater cooling
- * from 100ºC to ambient temperature.
- */
-static constexpr const double AMBIENT_TEMPERATURE_GAIN = 0.0015;
-
 static constexpr const auto PELTIER_PERIOD =
     thermal_plate_thread::SimThermalPlateTask::CONTROL_PERIOD_TICKS;
 
 static constexpr const auto LID_PERIOD =
     lid_heater_thread::SimLidHeaterTask::CONTROL_PERIOD_TICKS;
 
-PeriodicDataThread::PeriodicDataThread(bool realtime)
+PeriodicDataThread::PeriodicDataThread(
+    thermal_network::ThermalNetwork network, bool realtime)
     : _heat_pad_power(0),
       _peltiers_power{.left = 0, .center = 0, .right = 0},
-      _lid_temp(AMBIENT_TEMPERATURE),
-      _left_temp(AMBIENT_TEMPERATURE),
-      _center_temp(AMBIENT_TEMPERATURE),
-      _right_temp(AMBIENT_TEMPERATURE),
+      _network(std::move(network)),
+      _lid(thermal_network::require(_network, "lid")),
+      _left(thermal_network::require(_network, "plate_left")),
+      _center(thermal_network::require(_network, "plate_center")),
+      _right(thermal_network::require(_network, "plate_right")),
+      _heatsink(thermal_network::require(_network, "heatsink")),
       _tick_peltiers(0),
       _tick_heater(0),
+      _tick_network(0),
       _current_tick(0),
       _queue(),
       _task_registry(nullptr),
@@ -67,8 +59,6 @@ auto PeriodicDataThread::provide_tasks(
 }
 
 auto PeriodicDataThread::run(std::stop_token& st) -> void {
-    PeriodicDataMessage msg;
-
     while (!_init_latch.load()) {
         std::this_thread::yield();
     }
@@ -96,19 +86,10 @@ auto PeriodicDataThread::run(std::stop_token& st) -> void {
         }
 
         // -------------------------------------------------------------------
-        // Check for any updated control values
-
-        while (_queue.try_recv(&msg)) {
-            if (std::holds_alternative<HeatPadPower>(msg)) {
-                // Update heat pad powers
-                _heat_pad_power = std::get<HeatPadPower>(msg).power;
-            } else if (std::holds_alternative<PeltierPower>(msg)) {
-                // Update peltier temperatures
-                _peltiers_power = std::get<PeltierPower>(msg);
-            } else if (std::holds_alternative<StartMotorMovement>(msg)) {
-                // TODO
-            }
-        }
+        // Catch the thermal network up, then check for updated control values
+
+        advance_network();
+        handle_messages();
 
         // -------------------------------------------------------------------
         // Update the heat pad & peltiers.
@@ -145,30 +126,57 @@ auto PeriodicDataThread::run(std::stop_token& st) -> void {
     }
 }
 
-auto PeriodicDataThread::signal_lid_thread_ready() -> void {
-    _waiting_for_lid_thread = false;
+auto PeriodicDataThread::schedule(sim_scheduler::Scheduler& scheduler)
+    -> void {
+    // The scheduler only moves on once every task is idle, so there is no
+    // need to wait for the lid and plate tasks to read each update
+    scheduler.add_task([this]() { return _queue.has_message(); },
+                       [this]() { handle_messages(); });
+    scheduler.add_periodic(LID_PERIOD, [this, &scheduler]() {
+        _current_tick = scheduler.now();
+        advance_network();
+        static_cast<void>(update_heat_pad());
+    });
+    scheduler.add_periodic(PELTIER_PERIOD, [this, &scheduler]() {
+        _current_tick = scheduler.now();
+        advance_network();
+        static_cast<void>(update_peltiers());
+    });
 }
 
-auto PeriodicDataThread::signal_plate_thread_ready() -> void {
-    _waiting_for_plate_thread = false;
+auto PeriodicDataThread::advance_network() -> void {
+    // Let the thermal network catch up with the outputs that were held
+    // since the last update
+    _network.advance(static_cast<double>(_current_tick - _tick_network) /
+                     1000.0F);
+    _tick_network = _current_tick;
 }
 
-auto PeriodicDataThread::ambient_temp_effect(Temperature temp,
-                                             std::chrono::milliseconds delta)
-    -> Temperature {
-    using Seconds = std::chrono::duration<double, std::chrono::seconds::period>;
-    auto seconds = std::chrono::duration_cast<Seconds>(delta);
-    return (AMBIENT_TEMPERATURE - temp) * AMBIENT_TEMPERATURE_GAIN *
-           seconds.count();
+auto PeriodicDataThread::handle_messages() -> void {
+    PeriodicDataMessage msg;
+    while (_queue.try_recv(&msg)) {
+        if (std::holds_alternative<HeatPadPower>(msg)) {
+            // Update heat pad powers
+            _heat_pad_power = std::get<HeatPadPower>(msg).power;
+            _network.set_drive(_lid, _heat_pad_power);
+        } else if (std::holds_alternative<PeltierPower>(msg)) {
+            // Update peltier temperatures
+            _peltiers_power = std::get<PeltierPower>(msg);
+            _network.set_drive(_left, _peltiers_power.left);
+            _network.set_drive(_center, _peltiers_power.center);
+            _network.set_drive(_right, _peltiers_power.right);
+        } else if (std::holds_alternative<StartMotorMovement>(msg)) {
+            // TODO
+        }
+    }
 }
 
-auto PeriodicDataThread::scaled_gain_effect(double gain, double power,
-                                            std::chrono::milliseconds delta)
-    -> Temperature {
-    using Seconds = std::chrono::duration<double, std::chrono::seconds::period>;
-    auto seconds = std::chrono::duration_cast<Seconds>(delta);
+auto PeriodicDataThread::signal_lid_thread_ready() -> void {
+    _waiting_for_lid_thread = false;
+}
 
-    return seconds.count() * gain * power;
+auto PeriodicDataThread::signal_plate_thread_ready() -> void {
+    _waiting_for_plate_thread = false;
 }
 
 auto PeriodicDataThread::update_heat_pad() -> bool {
@@ -177,12 +185,8 @@ auto PeriodicDataThread::update_heat_pad() -> bool {
             THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
         lid_heater_thread::SimLidHeaterTask::ADC_BIT_MAX, false);
 
-    auto timedelta = std::chrono::milliseconds(_current_tick - _tick_heater);
-
-    _lid_temp += scaled_gain_effect(HEAT_PAD_GAIN, _heat_pad_power, timedelta) +
-                 ambient_temp_effect(_lid_temp, timedelta);
     auto message = messages::LidTempReadComplete{
-        .lid_temp = converter.backconvert(_lid_temp),
+        .lid_temp = converter.backconvert(_network.temperature(_lid)),
         .timestamp_ms = _current_tick};
     _tick_heater = _current_tick;
 
@@ -200,26 +204,18 @@ auto PeriodicDataThread::update_peltiers() -> bool {
             THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
         thermal_plate_thread::SimThermalPlateTask::ADC_BIT_MAX, false);
 
-    auto timedelta = std::chrono::milliseconds(_current_tick - _tick_peltiers);
-
-    _left_temp +=
-        scaled_gain_effect(PELTIER_GAIN, _peltiers_power.left, timedelta) +
-        ambient_temp_effect(_left_temp, timedelta);
-    _center_temp +=
-        scaled_gain_effect(PELTIER_GAIN, _peltiers_power.center, timedelta) +
-        ambient_temp_effect(_center_temp, timedelta);
-    _right_temp +=
-        scaled_gain_effect(PELTIER_GAIN, _peltiers_power.right, timedelta) +
-        ambient_temp_effect(_right_temp, timedelta);
+    auto right = converter.backconvert(_network.temperature(_right));
+    auto center = converter.backconvert(_network.temperature(_center));
+    auto left = converter.backconvert(_network.temperature(_left));
 
     auto message = messages::ThermalPlateTempReadComplete{
-        .heat_sink = converter.backconvert(AMBIENT_TEMPERATURE),
-        .front_right = converter.backconvert(_right_temp),
-        .front_center = converter.backconvert(_center_temp),
-        .front_left = converter.backconvert(_left_temp),
-        .back_right = converter.backconvert(_right_temp),
-        .back_center = converter.backconvert(_center_temp),
-        .back_left = converter.backconvert(_left_temp),
+        .heat_sink = converter.backconvert(_network.temperature(_heatsink)),
+        .front_right = right,
+        .front_center = center,
+        .front_left = left,
+        .back_right = right,
+        .back_center = center,
+        .back_left = left,
         .timestamp_ms = _current_tick};
 
     _tick_peltiers = _current_tick;
@@ -237,10 +233,12 @@ auto PeriodicDataThread::run_motor() -> void {
     // Todo!!!
 }
 
-auto periodic_data_thread::build(bool realtime)
+auto periodic_data_thread::build(thermal_network::ThermalNetwork network,
+                                 bool realtime)
     -> std::pair<std::unique_ptr<std::jthread>,
                  std::shared_ptr<PeriodicDataThread>> {
-    auto thread = std::make_shared<PeriodicDataThread>(realtime);
+    auto thread =
+        std::make_shared<PeriodicDataThread>(std::move(network), realtime);
 
     auto lambda = [](std::stop_token st,
                      std::shared_ptr<PeriodicDataThread> _thread) {
@@ -250,3 +248,13 @@ auto periodic_data_thread::build(bool realtime)
     return std::make_pair(std::make_unique<std::jthread>(lambda, thread),
                           thread);
 }
+
+auto periodic_data_thread::build(thermal_network::ThermalNetwork network,
+                                 sim_scheduler::Scheduler& scheduler)
+    -> std::pair<std::unique_ptr<std::jthread>,
+                 std::shared_ptr<PeriodicDataThread>> {
+    auto thread =
+        std::make_shared<PeriodicDataThread>(std::move(network), false);
+    thread->schedule(scheduler);
+    return std::make_pair(nullptr, thread);
+}
@@ -8,6 +8,7 @@
 #include <stop_token>
 #include <thread>
 
+#include "core/task_memory.hpp"
 #include "core/xt1511.hpp"
 #include "simulator/simulator_utils.hpp"
 #include "systemwide.h"
@@ -64,6 +65,19 @@ struct SimSystemPolicy {
 
     auto set_front_button_led(bool set) { static_cast<void>(set); }
 
+    // The simulator's tasks run on host threads with no fixed stacks or
+    // static RAM budget to report
+    [[nodiscard]] auto get_task_count() const -> size_t { return 0; }
+    [[nodiscard]] auto get_stack_usage(size_t index) const
+        -> task_memory::StackUsage {
+        static_cast<void>(index);
+        return task_memory::StackUsage{
+            .name = "", .size_words = 0, .min_free_words = 0};
+    }
+    [[nodiscard]] auto get_ram_usage() const -> task_memory::RamUsage {
+        return task_memory::RamUsage{};
+    }
+
     // Functions for XT1511 setting
     auto start_send(LedBuffer& buffer) -> bool {
         if (_led_active) {
@@ -94,31 +108,58 @@ struct system_thread::TaskControlBlock {
     SimSystemTask task;
 };
 
-auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
-    using namespace std::literals::chrono_literals;
-    auto policy = SimSystemPolicy();
-
-    // Populate the serial number on startup, if provided
-    constexpr const char serial_var_name[] = "SERIAL_NUMBER";
+// Populate the serial number on startup, if provided
+static auto load_serial_number(SimSystemPolicy& policy,
+                               const char* serial_var_name = "SERIAL_NUMBER")
+    -> void {
     auto ret =
         simulator_utils::get_serial_number<SYSTEM_WIDE_SERIAL_NUMBER_LENGTH>(
             serial_var_name);
     if (ret.has_value()) {
         static_cast<void>(policy.set_serial_number(ret.value()));
     }
+}
+
+auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
+         sim_task_stats::SharedRegistry stats) -> void {
+    using namespace std::literals::chrono_literals;
+    auto policy = SimSystemPolicy();
+    load_serial_number(policy);
 
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
-            tcb->task.run_once(policy);
+            tcb->queue.wait_for_message();
+            sim_task_stats::timed_pass(*stats, tasks::TaskIndex::SYSTEM,
+                                       tcb->queue,
+                                       [&]() { tcb->task.run_once(policy); });
         } catch (const SimSystemTask::Queue::StopDuringMsgWait sdmw) {
             return;
         }
     }
 }
 
-auto system_thread::build()
+auto system_thread::build(sim_task_stats::SharedRegistry stats)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    return tasks::Task(
+        std::make_unique<std::jthread>(run, tcb, std::move(stats)),
+        &tcb->task);
+}
+
+auto system_thread::build(sim_task_stats::SharedRegistry stats,
+                          sim_scheduler::Scheduler& scheduler,
+                          const char* serial_var_name)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
+    auto policy = std::make_shared<SimSystemPolicy>();
+    load_serial_number(*policy, serial_var_name);
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, policy, stats]() {
+            sim_task_stats::timed_pass(*stats, tasks::TaskIndex::SYSTEM,
+                                       tcb->queue,
+                                       [&]() { tcb->task.run_once(*policy); });
+        });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
 }
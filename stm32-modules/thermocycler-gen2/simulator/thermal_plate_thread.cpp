@@ -123,15 +123,18 @@ struct thermal_plate_thread::TaskControlBlock {
 
 auto run(
     std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
-    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data)
-    -> void {
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats) -> void {
     using namespace std::literals::chrono_literals;
     auto policy = SimThermalPlatePolicy(periodic_data);
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
         auto last_update_before = tcb->task.get_last_temp_update();
         try {
-            tcb->task.run_once(policy);
+            tcb->queue.wait_for_message();
+            sim_task_stats::timed_pass(*stats, tasks::TaskIndex::THERMAL_PLATE,
+                                       tcb->queue,
+                                       [&]() { tcb->task.run_once(policy); });
             policy.send_power();
         } catch (const SimThermalPlateTask::Queue::StopDuringMsgWait sdmw) {
             return;
@@ -145,9 +148,28 @@ auto run(
 }
 
 auto thermal_plate_thread::build(
-    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data)
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb, periodic_data),
+    return tasks::Task(std::make_unique<std::jthread>(run, tcb, periodic_data,
+                                                      std::move(stats)),
                        &tcb->task);
 }
+
+auto thermal_plate_thread::build(
+    std::shared_ptr<periodic_data_thread::PeriodicDataThread> periodic_data,
+    sim_task_stats::SharedRegistry stats, sim_scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    auto policy = std::make_shared<SimThermalPlatePolicy>(periodic_data);
+    scheduler.add_task([tcb]() { return tcb->queue.has_message(); },
+                       [tcb, policy, stats]() {
+                           sim_task_stats::timed_pass(
+                               *stats, tasks::TaskIndex::THERMAL_PLATE,
+                               tcb->queue,
+                               [&]() { tcb->task.run_once(*policy); });
+                           policy->send_power();
+                       });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
+}
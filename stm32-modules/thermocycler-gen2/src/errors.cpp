@@ -76,6 +76,12 @@ const char* const THERMAL_TARGET_BAD =
     "ERR407:thermal:Invalid target temperature OK\n";
 const char* const THERMAL_DRIFT =
     "ERR408:thermal:Thermal drift of more than 4C OK\n";
+const char* const THERMAL_PROGRAM_STEP_INVALID =
+    "ERR409:thermal:Invalid thermal program step OK\n";
+const char* const THERMAL_PROGRAM_EMPTY =
+    "ERR410:thermal:No thermal program loaded OK\n";
+const char* const THERMAL_AUTOTUNE_FAILED =
+    "ERR411:thermal:Autotune did not settle into an oscillation OK\n";
 const char* const LID_MOTOR_BUSY = "ERR501:lid:Lid motor busy OK\n";
 const char* const LID_MOTOR_FAULT = "ERR502:lid:Lid motor fault OK\n";
 const char* const SEAL_MOTOR_SPI_ERROR = "ERR503:seal:SPI error OK\n";
@@ -136,6 +142,9 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(THERMAL_CONSTANT_OUT_OF_RANGE);
         HANDLE_CASE(THERMAL_TARGET_BAD);
         HANDLE_CASE(THERMAL_DRIFT);
+        HANDLE_CASE(THERMAL_PROGRAM_STEP_INVALID);
+        HANDLE_CASE(THERMAL_PROGRAM_EMPTY);
+        HANDLE_CASE(THERMAL_AUTOTUNE_FAILED);
         HANDLE_CASE(LID_MOTOR_BUSY);
         HANDLE_CASE(LID_MOTOR_FAULT);
         HANDLE_CASE(SEAL_MOTOR_SPI_ERROR);
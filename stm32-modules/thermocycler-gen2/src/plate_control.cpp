@@ -52,6 +52,9 @@ auto PlateControl::update_control(Seconds time) -> UpdateRet {
             _left.temp_target = _setpoint;
             _right.temp_target = _setpoint;
             _center.temp_target = _setpoint;
+            schedule_gains(_left, _setpoint);
+            schedule_gains(_right, _setpoint);
+            schedule_gains(_center, _setpoint);
             _status = PlateStatus::STEADY_STATE;
             _uniformity_error_timer = UNIFORMITY_CHECK_DELAY;
             break;
@@ -86,8 +89,10 @@ auto PlateControl::update_control(Seconds time) -> UpdateRet {
 }
 
 auto PlateControl::set_new_target(double setpoint, double volume_ul,
-                                  double hold_time, double ramp_rate) -> bool {
+                                  double hold_time, double ramp_rate,
+                                  bool feed_forward) -> bool {
     _ramp_rate = ramp_rate;
+    _feed_forward = feed_forward;
     _hold_time = hold_time;
     _remaining_hold_time = hold_time;
     _setpoint = setpoint;
@@ -98,6 +103,9 @@ auto PlateControl::set_new_target(double setpoint, double volume_ul,
     // have to reconsider this, see how it works for small changes.
     _status = (setpoint > current_temp) ? PlateStatus::INITIAL_HEAT
                                         : PlateStatus::INITIAL_COOL;
+    _direction = (_status == PlateStatus::INITIAL_HEAT)
+                     ? PIDDirection::HEATING
+                     : PIDDirection::COOLING;
 
     auto distance_to_target = std::abs(setpoint - current_temp);
     if (distance_to_target > UNDERSHOOT_MIN_DIFFERENCE &&
@@ -161,11 +169,15 @@ auto PlateControl::update_ramp(thermal_general::Peltier &peltier, Seconds time,
     }
 }
 
-// This function *could* be made static, but that obfuscates the intention,
-// which is to update the PID of a *member* of the class.
-// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto PlateControl::update_pid(thermal_general::Peltier &peltier, Seconds time)
     -> double {
+    auto &last_target = _last_targets.at(peltier.id);
+    double target_rate = 0.0F;
+    if (_ramp_rate != RAMP_INFINITE && time > 0.0F) {
+        target_rate = (peltier.temp_target - last_target) / time;
+    }
+    last_target = peltier.temp_target;
+
     auto current_temp = peltier.current_temp();
     if ((_status == PlateStatus::INITIAL_HEAT ||
          _status == PlateStatus::INITIAL_COOL) &&
@@ -176,7 +188,18 @@ auto PlateControl::update_pid(thermal_general::Peltier &peltier, Seconds time)
         }
     }
 
-    return peltier.pid.compute(peltier.temp_target - current_temp, time);
+    auto power = peltier.pid.compute(peltier.temp_target - current_temp, time);
+    if (_feed_forward) {
+        power += feed_forward_power(peltier, target_rate);
+    }
+    return std::clamp(power, -1.0, 1.0);
+}
+
+[[nodiscard]] auto PlateControl::feed_forward_power(
+    const thermal_general::Peltier &peltier, double target_rate) const
+    -> double {
+    return _model.feed_forward(peltier.temp_target, _fan.current_temp(),
+                               target_rate);
 }
 
 auto PlateControl::update_fan(Seconds time) -> double {
@@ -253,6 +276,17 @@ auto PlateControl::reset_control(thermal_general::Peltier &peltier,
     } else {
         peltier.temp_target = plate_temp();
     }
+    _last_targets.at(peltier.id) = peltier.temp_target;
+    schedule_gains(peltier, setpoint);
+}
+
+// This function *could* be made const, but that obfuscates the intention,
+// which is to update the gains of a *member* of the class.
+// NOLINTNEXTLINE(readability-make-member-function-const)
+auto PlateControl::schedule_gains(thermal_general::Peltier &peltier,
+                                  double target) -> void {
+    auto zone = zone_index(temperature_zone(target));
+    peltier.pid.set_gains(_gains.get(zone, _direction));
 }
 
 // This function *could* be made const, but that obfuscates the intention,
@@ -292,6 +326,11 @@ auto PlateControl::reset_control(thermal_general::HeatsinkFan &fan) -> void {
            (std::abs(_current_setpoint - plate_temp()) < SETPOINT_THRESHOLD);
 }
 
+[[nodiscard]] auto PlateControl::hold_complete() const -> bool {
+    return temp_within_setpoint() &&
+           (_remaining_hold_time <= static_cast<double>(0.0F));
+}
+
 [[nodiscard]] auto PlateControl::thermistor_drift_check() const -> bool {
     if ((_status != PlateStatus::STEADY_STATE) ||
         (_uniformity_error_timer > 0.0F)) {
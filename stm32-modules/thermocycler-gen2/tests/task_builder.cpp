@@ -16,7 +16,10 @@ TaskBuilder::TaskBuilder()
       system_policy(),
       thermal_plate_policy(),
       lid_heater_policy(),
-      motor_policy() {}
+      motor_policy(),
+      task_stats(tasks::TASK_NAMES) {
+    host_comms_task.provide_task_stats(&task_stats);
+}
 
 auto TaskBuilder::build() -> std::shared_ptr<TaskBuilder> {
     return std::shared_ptr<TaskBuilder>(new TaskBuilder());
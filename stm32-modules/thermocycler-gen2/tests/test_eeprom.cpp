@@ -86,3 +86,107 @@ TEST_CASE("eeprom reading and writing") {
         }
     }
 }
+
+TEST_CASE("eeprom PID constants") {
+    GIVEN("an EEPROM") {
+        auto policy = TestAT24C0XCPolicy<32>();
+        auto eeprom = Eeprom<32, 0x10>();
+        auto defaults = PIDConstants{.kp = 0.3, .ki = 0.05, .kd = 0.3};
+        WHEN("reading before writing anything") {
+            auto readback = eeprom.get_pid_constants(defaults, policy);
+            THEN("the resulting constants are the defaults") {
+                REQUIRE_THAT(readback.kp,
+                             Catch::Matchers::WithinAbs(defaults.kp, 0.01));
+                REQUIRE_THAT(readback.ki,
+                             Catch::Matchers::WithinAbs(defaults.ki, 0.01));
+                REQUIRE_THAT(readback.kd,
+                             Catch::Matchers::WithinAbs(defaults.kd, 0.01));
+            }
+        }
+        WHEN("writing PID constants") {
+            auto constants = PIDConstants{.kp = 0.42, .ki = 0.011, .kd = 2.5};
+            REQUIRE(eeprom.write_pid_constants(constants, policy));
+            THEN("they can be read back") {
+                auto readback = eeprom.get_pid_constants(defaults, policy);
+                REQUIRE_THAT(readback.kp,
+                             Catch::Matchers::WithinAbs(constants.kp, 0.001));
+                REQUIRE_THAT(readback.ki,
+                             Catch::Matchers::WithinAbs(constants.ki, 0.001));
+                REQUIRE_THAT(readback.kd,
+                             Catch::Matchers::WithinAbs(constants.kd, 0.001));
+            }
+            THEN("the offset constants are still unwritten") {
+                auto readback = eeprom.get_offset_constants(_default, policy);
+                REQUIRE_THAT(readback.a,
+                             Catch::Matchers::WithinAbs(_default.a, 0.01));
+            }
+        }
+        WHEN("writing offset constants") {
+            REQUIRE(eeprom.write_offset_constants(_default, policy));
+            THEN("the PID constants are still the defaults") {
+                auto readback = eeprom.get_pid_constants(defaults, policy);
+                REQUIRE_THAT(readback.kp,
+                             Catch::Matchers::WithinAbs(defaults.kp, 0.01));
+            }
+        }
+    }
+}
+
+TEST_CASE("eeprom constants from before the key-value store") {
+    GIVEN("an EEPROM with offset constants in the legacy layout") {
+        auto policy = TestAT24C0XCPolicy<32>();
+        auto legacy = at24c0xc::AT24C0xC<32, 0x10>();
+        // B and C for the left channel, the flag, then A and the rest
+        REQUIRE(legacy.write_value(0, 1.5, policy));
+        REQUIRE(legacy.write_value(1, -2.5, policy));
+        REQUIRE(legacy.write_value(2, uint32_t(3), policy));
+        REQUIRE(legacy.write_value(3, 0.5, policy));
+        REQUIRE(legacy.write_value(4, 0.25, policy));
+        REQUIRE(legacy.write_value(5, 0.125, policy));
+        REQUIRE(legacy.write_value(6, 4.0, policy));
+        REQUIRE(legacy.write_value(7, 8.0, policy));
+        auto eeprom = Eeprom<32, 0x10>();
+        auto defaults = PIDConstants{.kp = 0.3, .ki = 0.05, .kd = 0.3};
+        WHEN("reading the constants") {
+            auto offsets = eeprom.get_offset_constants(_default, policy);
+            auto pid = eeprom.get_pid_constants(defaults, policy);
+            THEN("the legacy offset constants are returned") {
+                REQUIRE(offsets.bl == 1.5);
+                REQUIRE(offsets.cl == -2.5);
+                REQUIRE(offsets.a == 0.5);
+                REQUIRE(offsets.bc == 0.25);
+                REQUIRE(offsets.cc == 0.125);
+                REQUIRE(offsets.br == 4.0);
+                REQUIRE(offsets.cr == 8.0);
+            }
+            THEN("the PID constants are the defaults") {
+                REQUIRE(pid.kp == defaults.kp);
+                REQUIRE(pid.ki == defaults.ki);
+                REQUIRE(pid.kd == defaults.kd);
+            }
+            AND_WHEN("reading them again") {
+                policy._reads = 0;
+                offsets = eeprom.get_offset_constants(_default, policy);
+                THEN("the EEPROM isn't read again") {
+                    REQUIRE(policy._reads == 0);
+                    REQUIRE(offsets.a == 0.5);
+                }
+            }
+        }
+        WHEN("writing PID constants twice") {
+            auto constants = PIDConstants{.kp = 0.42, .ki = 0.011, .kd = 2.5};
+            REQUIRE(eeprom.write_pid_constants(constants, policy));
+            REQUIRE(eeprom.write_pid_constants(constants, policy));
+            THEN("a new EEPROM instance still has the legacy offsets") {
+                auto reloaded = Eeprom<32, 0x10>();
+                auto offsets =
+                    reloaded.get_offset_constants(OffsetConstants{}, policy);
+                REQUIRE(offsets.a == 0.5);
+                REQUIRE(offsets.bl == 1.5);
+                REQUIRE(offsets.cr == 8.0);
+                auto pid = reloaded.get_pid_constants(defaults, policy);
+                REQUIRE(pid.kp == constants.kp);
+            }
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "catch2/catch.hpp"
+#include "core/thermistor_conversion.hpp"
 #include "systemwide.h"
 #include "test/task_builder.hpp"
 #include "thermocycler-gen2/errors.hpp"
@@ -11,6 +12,10 @@ constexpr int _shorted_adc = 0;
 constexpr int _disconnected_adc = 0x5DC0;
 constexpr uint32_t TIME_DELTA =
     lid_heater_task::LidHeaterTask<TestMessageQueue>::CONTROL_PERIOD_TICKS;
+using LidHeater = lid_heater_task::LidHeaterTask<TestMessageQueue>;
+static auto _converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+    LidHeater::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM, LidHeater::ADC_BIT_MAX,
+    false);
 
 SCENARIO("lid heater task message passing") {
     uint32_t timestamp = TIME_DELTA;
@@ -169,6 +174,17 @@ SCENARIO("lid heater task message passing") {
                 }
             }
         }
+        WHEN("a thermal program sends a SetLidTemperature message") {
+            auto message = messages::SetLidTemperatureMessage{
+                .id = 0, .setpoint = 105.0F, .from_program = true};
+            tasks->get_lid_heater_queue().backing_deque.push_back(
+                messages::LidHeaterMessage(message));
+            tasks->run_lid_heater_task();
+            THEN("the lid heats without acknowledging the host") {
+                REQUIRE(tasks->get_lid_heater_queue().backing_deque.empty());
+                REQUIRE(tasks->get_host_comms_queue().backing_deque.empty());
+            }
+        }
         WHEN("Sending a SetLidTemperature message to enable the lid") {
             auto message = messages::SetLidTemperatureMessage{
                 .id = 123, .setpoint = 100.0F};
@@ -606,4 +622,160 @@ TEST_CASE("lid heater error flag handling") {
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("lid heater task autotunes the heater PID constants") {
+    GIVEN("a lid heater task with the lid at 49.5ºC") {
+        uint32_t timestamp = TIME_DELTA;
+        auto tasks = TaskBuilder::build();
+        auto &lid_queue = tasks->get_lid_heater_queue();
+        auto &lid_policy = tasks->get_lid_heater_policy();
+        auto &host_queue = tasks->get_host_comms_queue();
+
+        auto send_reading = [&](double temp, uint32_t delta_ms = 1000) {
+            timestamp += delta_ms;
+            lid_queue.backing_deque.push_back(messages::LidTempReadComplete{
+                .lid_temp = _converter.backconvert(temp),
+                .timestamp_ms = timestamp});
+            tasks->run_lid_heater_task();
+        };
+        send_reading(49.5);
+        host_queue.backing_deque.clear();
+
+        auto take_ack = [&]() {
+            REQUIRE(host_queue.has_message());
+            auto msg = host_queue.backing_deque.front();
+            host_queue.backing_deque.pop_front();
+            REQUIRE(std::holds_alternative<messages::AcknowledgePrevious>(msg));
+            return std::get<messages::AcknowledgePrevious>(msg);
+        };
+
+        WHEN("starting with an out-of-range target") {
+            lid_queue.backing_deque.push_back(messages::StartLidAutotuneMessage{
+                .id = 2, .target = 120, .cycles = 4});
+            tasks->run_lid_heater_task();
+            THEN("it is rejected") {
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::THERMAL_TARGET_BAD);
+            }
+        }
+        WHEN("starting with no cycles") {
+            lid_queue.backing_deque.push_back(messages::StartLidAutotuneMessage{
+                .id = 2, .target = 50, .cycles = 0});
+            tasks->run_lid_heater_task();
+            THEN("it is rejected") {
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::THERMAL_CONSTANT_OUT_OF_RANGE);
+            }
+        }
+        WHEN("starting while controlling a temperature") {
+            lid_queue.backing_deque.push_back(
+                messages::SetLidTemperatureMessage{.id = 2, .setpoint = 50});
+            lid_queue.backing_deque.push_back(messages::StartLidAutotuneMessage{
+                .id = 3, .target = 50, .cycles = 4});
+            tasks->run_lid_heater_task();
+            tasks->run_lid_heater_task();
+            THEN("it is rejected") {
+                static_cast<void>(take_ack());
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::THERMAL_LID_BUSY);
+            }
+        }
+        WHEN("starting an autotune around 50ºC over two cycles") {
+            lid_queue.backing_deque.push_back(messages::StartLidAutotuneMessage{
+                .id = 2, .target = 50, .cycles = 2});
+            tasks->run_lid_heater_task();
+            THEN("it is acked") {
+                auto ack = take_ack();
+                REQUIRE(ack.responding_to_id == 2);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+            AND_WHEN("a reading below the target arrives") {
+                send_reading(49.5);
+                THEN("the heater is fully on") {
+                    REQUIRE(lid_policy.get_heater_power() == 1.0);
+                }
+            }
+            AND_WHEN("a reading above the target arrives") {
+                send_reading(51);
+                THEN("the heater is off") {
+                    REQUIRE(lid_policy.get_heater_power() == 0.0);
+                }
+            }
+            AND_WHEN("setting PID constants") {
+                host_queue.backing_deque.clear();
+                lid_queue.backing_deque.push_back(
+                    messages::SetPIDConstantsMessage{
+                        .id = 3,
+                        .selection = PidSelection::HEATER,
+                        .p = 1,
+                        .i = 1,
+                        .d = 1});
+                tasks->run_lid_heater_task();
+                THEN("it is rejected") {
+                    REQUIRE(take_ack().with_error ==
+                            errors::ErrorCode::THERMAL_LID_BUSY);
+                }
+            }
+            AND_WHEN("the lid oscillates 1ºC around the target every 2s") {
+                host_queue.backing_deque.clear();
+                for (int i = 0; i < 4; ++i) {
+                    send_reading(51);
+                    send_reading(49);
+                }
+                THEN("the new constants are reported") {
+                    std::vector<messages::LidAutotuneEvent> events;
+                    for (auto &msg : host_queue.backing_deque) {
+                        REQUIRE(!std::holds_alternative<messages::ErrorMessage>(
+                            msg));
+                        if (std::holds_alternative<messages::LidAutotuneEvent>(
+                                msg)) {
+                            events.push_back(
+                                std::get<messages::LidAutotuneEvent>(msg));
+                        }
+                    }
+                    REQUIRE(events.size() == 1);
+                    // Ku = 4 * 0.5 / (pi * sqrt(1 - 0.5^2)) and Tu = 2s
+                    auto kp = 0.6 * 0.7351;
+                    REQUIRE_THAT(events[0].kp,
+                                 Catch::Matchers::WithinRel(kp, 0.02));
+                    REQUIRE_THAT(events[0].ki,
+                                 Catch::Matchers::WithinRel(kp, 0.02));
+                    REQUIRE_THAT(events[0].kd,
+                                 Catch::Matchers::WithinRel(kp * 0.25, 0.02));
+                }
+                THEN("the heater is turned off") {
+                    REQUIRE(lid_policy.get_heater_power() == 0.0);
+                }
+            }
+            AND_WHEN("the lid never reaches the target") {
+                host_queue.backing_deque.clear();
+                send_reading(49.5, 1900 * 1000);
+                THEN("an autotune error is sent") {
+                    bool found = false;
+                    for (auto &msg : host_queue.backing_deque) {
+                        if (std::holds_alternative<messages::ErrorMessage>(
+                                msg)) {
+                            REQUIRE(
+                                std::get<messages::ErrorMessage>(msg).code ==
+                                errors::ErrorCode::THERMAL_AUTOTUNE_FAILED);
+                            found = true;
+                        }
+                    }
+                    REQUIRE(found);
+                    REQUIRE(lid_policy.get_heater_power() == 0.0);
+                }
+            }
+            AND_WHEN("deactivating the lid") {
+                lid_queue.backing_deque.push_back(
+                    messages::DeactivateLidHeatingMessage{.id = 4});
+                tasks->run_lid_heater_task();
+                host_queue.backing_deque.clear();
+                send_reading(49.5);
+                THEN("tuning stops and the heater stays off") {
+                    REQUIRE(lid_policy.get_heater_power() == 0.0);
+                    REQUIRE(!host_queue.has_message());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include "catch2/catch.hpp"
+#include "thermocycler-gen2/gcodes.hpp"
+
+SCENARIO("SetThermalProgramStep (M170) parser works", "[gcode][parse][m170]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::SetThermalProgramStep::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M170 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("a step with only a target") {
+        std::string buffer = "M170 I0 S95\n";
+        WHEN("parsing") {
+            auto parsed = gcode::SetThermalProgramStep::parse(buffer.begin(),
+                                                              buffer.end());
+            THEN("the optional values are defaulted") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                auto &val = parsed.first.value();
+                REQUIRE(val.index == 0);
+                REQUIRE(val.temperature == 95.0F);
+                REQUIRE(val.hold_time == 0.0F);
+                REQUIRE(val.ramp_rate == 0.0F);
+                REQUIRE(val.volume ==
+                        gcode::SetThermalProgramStep::default_volume);
+                REQUIRE(val.loop_count == 0);
+            }
+        }
+    }
+    GIVEN("a step with every parameter") {
+        std::string buffer = "M170 I3 S72.5 H30 R2.5 V50 J1 C29\n";
+        WHEN("parsing") {
+            auto parsed = gcode::SetThermalProgramStep::parse(buffer.begin(),
+                                                              buffer.end());
+            THEN("every value is parsed") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                auto &val = parsed.first.value();
+                REQUIRE(val.index == 3);
+                REQUIRE(val.temperature == 72.5F);
+                REQUIRE(val.hold_time == 30.0F);
+                REQUIRE(val.ramp_rate == 2.5F);
+                REQUIRE(val.volume == 50.0F);
+                REQUIRE(val.loop_to == 1);
+                REQUIRE(val.loop_count == 29);
+            }
+        }
+    }
+    GIVEN("invalid input") {
+        WHEN("the index is missing") {
+            std::string buffer = "M170 S95\n";
+            auto parsed = gcode::SetThermalProgramStep::parse(buffer.begin(),
+                                                              buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+        WHEN("the target is missing") {
+            std::string buffer = "M170 I0 H30\n";
+            auto parsed = gcode::SetThermalProgramStep::parse(buffer.begin(),
+                                                              buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+        WHEN("a loop has no count") {
+            std::string buffer = "M170 I2 S60 J0\n";
+            auto parsed = gcode::SetThermalProgramStep::parse(buffer.begin(),
+                                                              buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
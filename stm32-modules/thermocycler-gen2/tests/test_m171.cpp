@@ -0,0 +1,99 @@
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-gen2/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("StartThermalProgram (M171) parser works", "[gcode][parse][m171]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::StartThermalProgram::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M171 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+        WHEN("writing a step event") {
+            auto written = gcode::StartThermalProgram::write_event_into(
+                buffer.begin(), buffer.end(), 2, 7, 94.0, false);
+            THEN("the step and target are reported") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "async M171 STEP I:2 E:7 T:94.00 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+        WHEN("writing a finished event") {
+            auto written = gcode::StartThermalProgram::write_event_into(
+                buffer.begin(), buffer.end(), 5, 12, 4.0, true);
+            THEN("the step count is reported") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith(
+                                         "async M171 DONE E:12 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("a response buffer not large enough for an event") {
+        std::string buffer(16, 'c');
+        WHEN("writing a step event") {
+            auto written = gcode::StartThermalProgram::write_event_into(
+                buffer.begin(), buffer.begin() + 8, 2, 7, 94.0, false);
+            THEN("the event should write only up to the available space") {
+                REQUIRE(written == buffer.begin() + 8);
+                REQUIRE(buffer.substr(8) == "cccccccc");
+            }
+        }
+    }
+    GIVEN("input with no lid target") {
+        std::string buffer = "M171\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::StartThermalProgram::parse(buffer.begin(), buffer.end());
+            THEN("the lid is left alone") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().lid_target ==
+                        gcode::StartThermalProgram::no_lid_target);
+                REQUIRE(!parsed.first.value().feed_forward);
+            }
+        }
+    }
+    GIVEN("input with a lid target") {
+        std::string buffer = "M171 L105\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::StartThermalProgram::parse(buffer.begin(), buffer.end());
+            THEN("the lid target is parsed") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().lid_target == 105.0F);
+            }
+        }
+    }
+    GIVEN("input with a lid target and feed-forward") {
+        std::string buffer = "M171 L105 F\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::StartThermalProgram::parse(buffer.begin(), buffer.end());
+            THEN("both are parsed") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().lid_target == 105.0F);
+                REQUIRE(parsed.first.value().feed_forward);
+            }
+        }
+    }
+    GIVEN("input with an invalid lid target") {
+        std::string buffer = "M171 Lhot\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::StartThermalProgram::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-gen2/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("GetThermalProgramStatus (M172) parser works",
+         "[gcode][parse][m172]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetThermalProgramStatus::write_response_into(
+                buffer.begin(), buffer.end(), true, 3, 6, 10, 12, 105.0);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M172 R:1 I:3 N:6 E:10 T:12 L:105.00 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetThermalProgramStatus::write_response_into(
+                buffer.begin(), buffer.begin() + 8, true, 3, 6, 10, 12, 105.0);
+            THEN("the response should write only up to the available space") {
+                REQUIRE(written == buffer.begin() + 8);
+                REQUIRE(buffer.substr(8) == "cccccccc");
+            }
+        }
+    }
+    GIVEN("valid input") {
+        std::string buffer = "M172\n";
+        WHEN("parsing") {
+            auto parsed = gcode::GetThermalProgramStatus::parse(buffer.begin(),
+                                                                buffer.end());
+            THEN("the command is parsed") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+            }
+        }
+    }
+    GIVEN("input for a different gcode") {
+        std::string buffer = "M1720\n";
+        WHEN("parsing") {
+            auto parsed = gcode::GetThermalProgramStatus::parse(buffer.begin(),
+                                                                buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
@@ -95,6 +95,67 @@ SCENARIO("SetPIDConstants (M301) parser works", "[gcode][parse][m301]") {
             }
         }
     }
+    GIVEN("valid input selecting a gain schedule zone and direction") {
+        std::string buffer = "M301 SP P10.0 I-4 D75 Z0 C\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("the zone and direction are parsed") {
+                REQUIRE(parsed.first.has_value());
+                auto val = parsed.first.value();
+                REQUIRE(val.const_d == 75.0F);
+                REQUIRE(val.zone == 0);
+                REQUIRE(val.direction == PIDDirection::COOLING);
+            }
+        }
+    }
+    GIVEN("valid input selecting only a direction") {
+        std::string buffer = "M301 P10.0 I-4 D75 H\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("every zone is selected") {
+                REQUIRE(parsed.first.has_value());
+                auto val = parsed.first.value();
+                REQUIRE(!val.zone.has_value());
+                REQUIRE(val.direction == PIDDirection::HEATING);
+            }
+        }
+    }
+    GIVEN("valid input without a zone or direction") {
+        std::string buffer = "M301 P10.0 I-4 D75\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("the whole schedule is selected") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(!parsed.first.value().zone.has_value());
+                REQUIRE(!parsed.first.value().direction.has_value());
+            }
+        }
+    }
+    GIVEN("input selecting a zone for the fans") {
+        std::string buffer = "M301 SF P10.0 I-4 D75 Z1\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("no valid command is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("input with a negative zone") {
+        std::string buffer = "M301 P10.0 I-4 D75 Z-1\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::SetPIDConstants::parse(buffer.begin(), buffer.end());
+            THEN("no valid command is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
     GIVEN("input with invalid target specifier") {
         std::string buffer = "M301 SW P10.0 I-4 D75\n";
         WHEN("parsing the command") {
@@ -0,0 +1,126 @@
+#include "catch2/catch.hpp"
+#include "thermocycler-gen2/gcodes.hpp"
+
+SCENARIO("StartPlateAutotune (M303) parser works", "[gcode][parse][m303]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::StartPlateAutotune::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M303 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+        WHEN("filling an autotune result event") {
+            auto written = gcode::StartPlateAutotune::write_event_into(
+                buffer.begin(), buffer.end(), 0.5, 0.02, 1.25);
+            THEN("the event should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "async M303 DONE P:0.5000 I:0.0200 "
+                                 "D:1.2500 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+        WHEN("filling a lid autotune result event") {
+            auto written = gcode::StartPlateAutotune::write_lid_event_into(
+                buffer.begin(), buffer.end(), 0.5, 0.02, 1.25);
+            THEN("the event should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "async M303 H DONE P:0.5000 I:0.0200 "
+                                 "D:1.2500 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("a response buffer that is too small") {
+        std::string buffer(16, 'c');
+        WHEN("filling an autotune result event") {
+            auto written = gcode::StartPlateAutotune::write_event_into(
+                buffer.begin(), buffer.begin() + 7, 0.5, 0.02, 1.25);
+            THEN("the event is truncated") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("async "));
+                REQUIRE(written == buffer.begin() + 7);
+            }
+        }
+    }
+    GIVEN("input with only a target") {
+        std::string buffer = "M303 S50\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::StartPlateAutotune::parse(buffer.begin(), buffer.end());
+            THEN("the defaults are used for the other parameters") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE_THAT(parsed.first.value().target,
+                             Catch::Matchers::WithinAbs(50, 0.0001));
+                REQUIRE(parsed.first.value().cycles ==
+                        gcode::StartPlateAutotune::default_cycles);
+                REQUIRE(!parsed.first.value().save);
+                REQUIRE(!parsed.first.value().lid);
+            }
+        }
+    }
+    GIVEN("input with every parameter") {
+        std::string buffer = "M303 S72.5 C6 W\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::StartPlateAutotune::parse(buffer.begin(), buffer.end());
+            THEN("every parameter is parsed") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE_THAT(parsed.first.value().target,
+                             Catch::Matchers::WithinAbs(72.5, 0.0001));
+                REQUIRE(parsed.first.value().cycles == 6);
+                REQUIRE(parsed.first.value().save);
+            }
+        }
+    }
+    GIVEN("input selecting the lid heater") {
+        std::string buffer = "M303 S100 C3 H\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::StartPlateAutotune::parse(buffer.begin(), buffer.end());
+            THEN("the lid is selected") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE_THAT(parsed.first.value().target,
+                             Catch::Matchers::WithinAbs(100, 0.0001));
+                REQUIRE(parsed.first.value().cycles == 3);
+                REQUIRE(!parsed.first.value().save);
+                REQUIRE(parsed.first.value().lid);
+            }
+        }
+    }
+    GIVEN("invalid input") {
+        WHEN("saving lid heater constants") {
+            std::string buffer = "M303 S100 W H\n";
+            auto parsed =
+                gcode::StartPlateAutotune::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+        WHEN("the target is missing") {
+            std::string buffer = "M303 C4 W\n";
+            auto parsed =
+                gcode::StartPlateAutotune::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+        WHEN("the target is not a number") {
+            std::string buffer = "M303 Swarm\n";
+            auto parsed =
+                gcode::StartPlateAutotune::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#include "catch2/catch.hpp"
+#include "thermocycler-gen2/gcodes.hpp"
+
+SCENARIO("SetPlateModel (M306) parser works", "[gcode][parse][m306]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::SetPlateModel::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M306 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("valid input") {
+        std::string buffer = "M306 G3.2 L0.0015\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::SetPlateModel::parse(buffer.begin(), buffer.end());
+            THEN("both parameters are parsed") {
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE_THAT(parsed.first.value().gain,
+                             Catch::Matchers::WithinAbs(3.2, 0.0001));
+                REQUIRE_THAT(parsed.first.value().loss,
+                             Catch::Matchers::WithinAbs(0.0015, 0.0001));
+            }
+        }
+    }
+    GIVEN("invalid input") {
+        WHEN("the loss is missing") {
+            std::string buffer = "M306 G3.2\n";
+            auto parsed =
+                gcode::SetPlateModel::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+        WHEN("the gain is not a number") {
+            std::string buffer = "M306 Gfast L0.01\n";
+            auto parsed =
+                gcode::SetPlateModel::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
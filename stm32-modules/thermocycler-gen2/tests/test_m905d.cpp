@@ -0,0 +1,89 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-gen2/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("gcode m905.d works", "[gcode][parse][m905d]") {
+    auto samples = std::array{
+        motor_util::StallGuardSample{
+            .position = 100, .sg_result = 512, .cs_actual = 15},
+        motor_util::StallGuardSample{.position = 200,
+                                     .sg_result = 0,
+                                     .cs_actual = 31,
+                                     .stallguard = true}};
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(128, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetSealStallGuardLog::write_response_into(
+                buffer.begin(), buffer.end(), 10, 3, 4, samples);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M905.D N:10 O:3 S:4 100,512,15,0 200,0,31,1 "
+                                 "OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+        WHEN("filling response with no samples") {
+            auto written = gcode::GetSealStallGuardLog::write_response_into(
+                buffer.begin(), buffer.end(), 0, 0, 0,
+                std::span<const motor_util::StallGuardSample>());
+            THEN("only the header is written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith(
+                                         "M905.D N:0 O:0 S:0 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetSealStallGuardLog::write_response_into(
+                buffer.begin(), buffer.begin() + 8, 10, 3, 4, samples);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M905.D Ncccccccc";
+                response.at(7) = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+    GIVEN("input with no start index") {
+        std::string input("M905.D\n");
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::GetSealStallGuardLog::parse(input.begin(), input.end());
+            THEN("the command starts from the first sample") {
+                REQUIRE(parsed.second != input.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().start == 0);
+            }
+        }
+    }
+    GIVEN("input with a start index") {
+        std::string input("M905.D S16\n");
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::GetSealStallGuardLog::parse(input.begin(), input.end());
+            THEN("the start index is parsed") {
+                REQUIRE(parsed.second != input.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().start == 16);
+            }
+        }
+    }
+    GIVEN("incorrect input") {
+        std::string input = GENERATE("M905.E\n", "M905.D S\n");
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::GetSealStallGuardLog::parse(input.begin(), input.end());
+            THEN("the command should be incorrect") {
+                REQUIRE(parsed.second == input.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-gen2/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("gcode m906.d works", "[gcode][parse][m906d]") {
+    auto stacks = std::array{task_memory::StackUsage{.name = "HostCommsControl",
+                                                     .size_words = 2048,
+                                                     .min_free_words = 1500},
+                             task_memory::StackUsage{.name = "PlateThermistors",
+                                                     .size_words = 256,
+                                                     .min_free_words = 40}};
+    auto ram = task_memory::RamUsage{.data_bytes = 120,
+                                     .bss_bytes = 60000,
+                                     .heap_peak_bytes = 1024,
+                                     .heap_used_bytes = 512};
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(160, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetTaskMemory::write_response_into(
+                buffer.begin(), buffer.end(), 10, 3, ram, stacks);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M906.D N:10 S:3 D:120 B:60000 H:1024/512 "
+                                 "HostCommsControl:2048/1500 "
+                                 "PlateThermistors:256/40 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+        WHEN("filling response with no tasks") {
+            auto written = gcode::GetTaskMemory::write_response_into(
+                buffer.begin(), buffer.end(), 10, 10, ram,
+                std::span<const task_memory::StackUsage>());
+            THEN("only the header is written") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M906.D N:10 S:10 D:120 B:60000 H:1024/512 "
+                                 "OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetTaskMemory::write_response_into(
+                buffer.begin(), buffer.begin() + 8, 10, 3, ram, stacks);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M906.D Ncccccccc";
+                response.at(7) = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+    GIVEN("input with no start index") {
+        std::string input("M906.D\n");
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::GetTaskMemory::parse(input.begin(), input.end());
+            THEN("the command starts from the first task") {
+                REQUIRE(parsed.second != input.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().start == 0);
+            }
+        }
+    }
+    GIVEN("input with a start index") {
+        std::string input("M906.D S5\n");
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::GetTaskMemory::parse(input.begin(), input.end());
+            THEN("the start index is parsed") {
+                REQUIRE(parsed.second != input.begin());
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().start == 5);
+            }
+        }
+    }
+    GIVEN("incorrect input") {
+        std::string input = GENERATE("M906.E\n", "M906.D S\n");
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::GetTaskMemory::parse(input.begin(), input.end());
+            THEN("the command should be incorrect") {
+                REQUIRE(parsed.second == input.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+    }
+}
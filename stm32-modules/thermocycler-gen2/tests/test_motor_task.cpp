@@ -233,6 +233,103 @@ SCENARIO("motor task message passing") {
                             motor_util::SealStepper::Status::BETWEEN);
                 }
             }
+            AND_WHEN("running the task with no pending messages") {
+                // SG_RESULT = 0x1F, CS_ACTUAL = 0x10, stallguard flag set
+                motor_policy.write_register(tmc2130::Registers::DRVSTATUS,
+                                            0x1F | (0x10 << 16) | (1 << 24));
+                tasks->run_motor_task();
+                while (motor_policy.get_tmc2130_steps() < 2) {
+                    motor_policy.tick();
+                }
+                tasks->run_motor_task();
+                THEN("the seal keeps moving and nothing is sent") {
+                    REQUIRE(motor_policy.seal_moving());
+                    REQUIRE(
+                        tasks->get_host_comms_queue().backing_deque.empty());
+                }
+                AND_WHEN("sending a GetSealStallGuardLog message") {
+                    motor_queue.backing_deque.push_back(
+                        messages::GetSealStallGuardLogMessage{.id = 456,
+                                                              .start = 0});
+                    tasks->run_motor_task();
+                    THEN("the response contains a sample per idle wakeup") {
+                        auto msg =
+                            tasks->get_host_comms_queue().backing_deque.front();
+                        REQUIRE(std::holds_alternative<
+                                messages::GetSealStallGuardLogResponse>(msg));
+                        auto response =
+                            std::get<messages::GetSealStallGuardLogResponse>(
+                                msg);
+                        REQUIRE(response.responding_to_id == 456);
+                        REQUIRE(response.total == 2);
+                        REQUIRE(response.overwritten == 0);
+                        REQUIRE(response.start == 0);
+                        REQUIRE(response.count == 2);
+                        REQUIRE(response.samples[0].position == 0);
+                        REQUIRE(response.samples[1].position ==
+                                motor_policy.get_tmc2130_steps());
+                        REQUIRE(response.samples[1].sg_result == 0x1F);
+                        REQUIRE(response.samples[1].cs_actual == 0x10);
+                        REQUIRE(response.samples[1].stallguard);
+                    }
+                }
+                AND_WHEN("requesting samples past the end of the log") {
+                    motor_queue.backing_deque.push_back(
+                        messages::GetSealStallGuardLogMessage{.id = 456,
+                                                              .start = 2});
+                    tasks->run_motor_task();
+                    THEN("the response contains no samples") {
+                        auto msg =
+                            tasks->get_host_comms_queue().backing_deque.front();
+                        auto response =
+                            std::get<messages::GetSealStallGuardLogResponse>(
+                                msg);
+                        REQUIRE(response.total == 2);
+                        REQUIRE(response.count == 0);
+                    }
+                }
+                AND_WHEN("starting another movement") {
+                    motor_queue.backing_deque.push_back(
+                        messages::SealStepperComplete{});
+                    tasks->run_motor_task();
+                    tasks->get_host_comms_queue().backing_deque.clear();
+                    motor_queue.backing_deque.push_back(message);
+                    tasks->run_motor_task();
+                    motor_queue.backing_deque.push_back(
+                        messages::GetSealStallGuardLogMessage{.id = 456,
+                                                              .start = 0});
+                    tasks->run_motor_task();
+                    THEN("the log from the previous movement is cleared") {
+                        auto msg =
+                            tasks->get_host_comms_queue().backing_deque.front();
+                        auto response =
+                            std::get<messages::GetSealStallGuardLogResponse>(
+                                msg);
+                        REQUIRE(response.total == 0);
+                        REQUIRE(response.count == 0);
+                    }
+                }
+            }
+            AND_WHEN("sampling for longer than the log holds") {
+                static constexpr size_t LOG_LENGTH =
+                    motor_task::SealStepperState::STALLGUARD_LOG_LENGTH;
+                for (size_t i = 0; i < LOG_LENGTH + 5; ++i) {
+                    tasks->run_motor_task();
+                    motor_policy.tick();
+                }
+                motor_queue.backing_deque.push_back(
+                    messages::GetSealStallGuardLogMessage{.id = 456,
+                                                          .start = 0});
+                tasks->run_motor_task();
+                THEN("the response reports the dropped samples") {
+                    auto msg =
+                        tasks->get_host_comms_queue().backing_deque.front();
+                    auto response =
+                        std::get<messages::GetSealStallGuardLogResponse>(msg);
+                    REQUIRE(response.total == LOG_LENGTH);
+                    REQUIRE(response.overwritten == 5);
+                }
+            }
             AND_WHEN("incrementing the tick for up to a second") {
                 uint32_t i = 0;
                 for (; i < motor_policy.MotorTickFrequency; ++i) {
@@ -722,6 +819,22 @@ SCENARIO("motor task lid state machine") {
                  .seal_direction = true,
                  .seal_switch_armed = true,
                  .motor_state = MotorStep::MotorState::OPENING_OR_CLOSING},
+                // Homing makes contact and backs off
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = false,
+                 .seal_switch_armed = false},
+                // Homing re-approaches slowly
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = true},
                 // Second step extends seal switch
                 {.msg =
                      messages::SealStepperComplete{
@@ -870,6 +983,22 @@ SCENARIO("motor task lid state machine") {
                  .seal_direction = true,
                  .seal_switch_armed = true,
                  .motor_state = MotorStep::MotorState::OPENING_OR_CLOSING},
+                // Homing makes contact and backs off
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = false,
+                 .seal_switch_armed = false},
+                // Homing re-approaches slowly
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = true},
                 // Second step extends seal from switch
                 {.msg =
                      messages::SealStepperComplete{
@@ -896,6 +1025,22 @@ SCENARIO("motor task lid state machine") {
                  .seal_on = true,
                  .seal_direction = false,
                  .seal_switch_armed = true},
+                // Homing makes contact and backs off
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = false},
+                // Homing re-approaches slowly
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = false,
+                 .seal_switch_armed = true},
                 // Retract seal from switch
                 {.msg =
                      messages::SealStepperComplete{
@@ -1001,6 +1146,22 @@ SCENARIO("motor task lid state machine") {
                      .seal_on = true,
                      .seal_direction = false,
                      .seal_switch_armed = true},
+                    // Homing makes contact and backs off
+                    {.msg =
+                         messages::SealStepperComplete{
+                             .reason = messages::SealStepperComplete::
+                                 CompletionReason::LIMIT},
+                     .seal_on = true,
+                     .seal_direction = true,
+                     .seal_switch_armed = false},
+                    // Homing re-approaches slowly
+                    {.msg =
+                         messages::SealStepperComplete{
+                             .reason = messages::SealStepperComplete::
+                                 CompletionReason::DONE},
+                     .seal_on = true,
+                     .seal_direction = false,
+                     .seal_switch_armed = true},
                     // Retract seal from switch
                     {.msg =
                          messages::SealStepperComplete{
@@ -1077,6 +1238,22 @@ SCENARIO("motor task lid state machine") {
                  .seal_on = true,
                  .seal_direction = true,
                  .seal_switch_armed = true},
+                // Homing makes contact and backs off
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = false,
+                 .seal_switch_armed = false},
+                // Homing re-approaches slowly
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = true},
                 // Second step extends seeal switch
                 {.msg =
                      messages::SealStepperComplete{
@@ -1114,6 +1291,22 @@ SCENARIO("motor task lid state machine") {
                  .seal_on = true,
                  .seal_direction = true,
                  .seal_switch_armed = true},
+                // Homing makes contact and backs off
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = false,
+                 .seal_switch_armed = false},
+                // Homing re-approaches slowly
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = true},
                 // Second step extends seal from switch
                 {.msg =
                      messages::SealStepperComplete{
@@ -1140,6 +1333,22 @@ SCENARIO("motor task lid state machine") {
                  .seal_on = true,
                  .seal_direction = false,
                  .seal_switch_armed = true},
+                // Homing makes contact and backs off
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = false},
+                // Homing re-approaches slowly
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = false,
+                 .seal_switch_armed = true},
                 // Retract seal from switch
                 {.msg =
                      messages::SealStepperComplete{
@@ -1171,3 +1380,258 @@ SCENARIO("motor task lid state machine") {
         }
     }
 }
+
+SCENARIO("motor task seal homing") {
+    auto tasks = TaskBuilder::build();
+    auto &motor_policy = tasks->get_motor_policy();
+    GIVEN("lid is closed and seal lines aren't shared") {
+        motor_policy.set_lid_closed_switch(true);
+        motor_policy.set_lid_open_switch(false);
+        motor_policy.set_switch_lines_shared(false);
+        WHEN("the fast approach makes contact through StallGuard") {
+            std::vector<MotorStep> steps = {
+                // Fast approach towards the retraction end
+                {.msg = messages::OpenLidMessage{.id = 123},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = true},
+                // A stall counts as contact, so back off
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::STALL},
+                 .seal_on = true,
+                 .seal_direction = false,
+                 .seal_switch_armed = false},
+                // Slow re-approach
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = true,
+                 .seal_switch_armed = true},
+                // Contact on the re-approach finishes homing and the hinge
+                // opens
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .lid_angle_increased = true,
+                 .seal_pos = MotorStep::SealPos::RETRACTED},
+            };
+            test_motor_state_machine(tasks, steps);
+        }
+        WHEN("the StallGuard minimum velocity is above the slow velocity") {
+            using Parameter = motor_util::SealStepper::Parameter;
+            using Reason = messages::SealStepperComplete::CompletionReason;
+            static constexpr int32_t SEAL_VELOCITY = 20000;
+            static constexpr int32_t SG_MIN_VELOCITY = 100000;
+            static constexpr uint32_t TICKS_PER_SAMPLE =
+                TestMotorPolicy::MotorTickFrequency / 100;
+            auto &motor_task = tasks->get_motor_task();
+            auto &motor_queue = tasks->get_motor_queue();
+            std::vector<messages::MotorMessage> msgs = {
+                messages::SetSealParameterMessage{.id = 1,
+                                                  .param = Parameter::Velocity,
+                                                  .value = SEAL_VELOCITY},
+                messages::SetSealParameterMessage{
+                    .id = 2,
+                    .param = Parameter::StallguardMinVelocity,
+                    .value = SG_MIN_VELOCITY},
+                messages::OpenLidMessage{.id = 123},
+                // The fast approach hits a hard stop rather than the switch
+                messages::SealStepperComplete{.reason = Reason::STALL},
+                // The switch was never pressed, so one backoff releases it
+                messages::SealStepperComplete{.reason = Reason::DONE}};
+            for (auto &msg : msgs) {
+                motor_queue.backing_deque.push_back(msg);
+                tasks->run_motor_task();
+            }
+            tasks->get_host_comms_queue().backing_deque.clear();
+            REQUIRE(motor_policy.seal_moving());
+            REQUIRE(motor_policy.get_tmc2130_direction());
+            // Tick the slow re-approach until it is fast enough for
+            // StallGuard, measuring its speed over each sample period
+            auto sg_velocity = motor_util::SealStepper::tstep_to_velocity(
+                motor_util::SealStepper::velocity_to_tstep(SG_MIN_VELOCITY));
+            auto sg_steps =
+                static_cast<long>(sg_velocity * TICKS_PER_SAMPLE /
+                                  TestMotorPolicy::MotorTickFrequency);
+            long peak_steps = 0;
+            for (uint32_t i = 0;
+                 i < TestMotorPolicy::MotorTickFrequency * 10 &&
+                 motor_policy.seal_moving() && peak_steps < sg_steps;
+                 i += TICKS_PER_SAMPLE) {
+                auto before = motor_policy.get_tmc2130_steps();
+                for (uint32_t j = 0; j < TICKS_PER_SAMPLE; ++j) {
+                    motor_policy.tick();
+                }
+                peak_steps = std::max(
+                    peak_steps, motor_policy.get_tmc2130_steps() - before);
+            }
+            THEN("the re-approach reaches the StallGuard velocity in time") {
+                REQUIRE(peak_steps >= sg_steps);
+                REQUIRE(motor_policy.seal_moving());
+            }
+            AND_WHEN("StallGuard reports the hard stop") {
+                auto lid_angle_before = motor_policy.get_angle();
+                motor_queue.backing_deque.push_back(
+                    messages::SealStepperComplete{.reason = Reason::STALL});
+                tasks->run_motor_task();
+                THEN("homing finishes without an error and the hinge opens") {
+                    REQUIRE(motor_task.get_seal_position() ==
+                            motor_util::SealStepper::Status::RETRACTED);
+                    REQUIRE(motor_policy.get_angle() > lid_angle_before);
+                    REQUIRE(!tasks->get_host_comms_queue().has_message());
+                }
+            }
+        }
+        WHEN("sampling StallGuard through each leg of the homing") {
+            auto &motor_queue = tasks->get_motor_queue();
+            using Reason = messages::SealStepperComplete::CompletionReason;
+            std::vector<messages::MotorMessage> legs = {
+                messages::OpenLidMessage{.id = 123},
+                messages::SealStepperComplete{.reason = Reason::STALL},
+                messages::SealStepperComplete{.reason = Reason::DONE}};
+            for (auto &leg : legs) {
+                motor_queue.backing_deque.push_back(leg);
+                tasks->run_motor_task();
+                // No message pending, so the moving seal is sampled
+                tasks->run_motor_task();
+            }
+            motor_queue.backing_deque.push_back(
+                messages::GetSealStallGuardLogMessage{.id = 456, .start = 0});
+            tasks->run_motor_task();
+            THEN("the log holds the samples of every leg") {
+                auto &comms = tasks->get_host_comms_queue().backing_deque;
+                REQUIRE(!comms.empty());
+                REQUIRE(std::holds_alternative<
+                        messages::GetSealStallGuardLogResponse>(comms.back()));
+                auto response =
+                    std::get<messages::GetSealStallGuardLogResponse>(
+                        comms.back());
+                REQUIRE(response.total == legs.size());
+                REQUIRE(response.overwritten == 0);
+            }
+        }
+        WHEN("the slow re-approach never makes contact") {
+            std::vector<MotorStep> steps = {
+                {.msg = messages::OpenLidMessage{.id = 123},
+                 .seal_on = true,
+                 .seal_direction = true},
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = false},
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = true,
+                 .seal_direction = true},
+                // The bounded re-approach ran out, which is an error
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::DONE},
+                 .seal_on = false,
+                 .motor_state = MotorStep::MotorState::IDLE,
+                 .seal_pos = MotorStep::SealPos::UNKNOWN,
+                 .ack =
+                     messages::AcknowledgePrevious{
+                         .responding_to_id = 123,
+                         .with_error = errors::ErrorCode::SEAL_MOTOR_SWITCH}},
+            };
+            test_motor_state_machine(tasks, steps);
+        }
+        WHEN("the switch is still pressed after backing off") {
+            std::vector<MotorStep> steps = {
+                {.msg = messages::OpenLidMessage{.id = 123},
+                 .seal_on = true,
+                 .seal_direction = true},
+                {.msg =
+                     messages::SealStepperComplete{
+                         .reason = messages::SealStepperComplete::
+                             CompletionReason::LIMIT},
+                 .seal_on = true,
+                 .seal_direction = false},
+            };
+            test_motor_state_machine(tasks, steps);
+            motor_policy.set_retraction_switch_triggered(true);
+            AND_WHEN("the switch releases after another backoff") {
+                std::vector<MotorStep> release_steps = {
+                    // Still pressed, so back off again
+                    {.msg =
+                         messages::SealStepperComplete{
+                             .reason = messages::SealStepperComplete::
+                                 CompletionReason::DONE},
+                     .seal_on = true,
+                     .seal_direction = false,
+                     .seal_switch_armed = false},
+                };
+                test_motor_state_machine(tasks, release_steps);
+                motor_policy.set_retraction_switch_triggered(false);
+                std::vector<MotorStep> approach_steps = {
+                    // Released, so re-approach slowly
+                    {.msg =
+                         messages::SealStepperComplete{
+                             .reason = messages::SealStepperComplete::
+                                 CompletionReason::DONE},
+                     .seal_on = true,
+                     .seal_direction = true,
+                     .seal_switch_armed = true},
+                    {.msg =
+                         messages::SealStepperComplete{
+                             .reason = messages::SealStepperComplete::
+                                 CompletionReason::LIMIT},
+                     .lid_angle_increased = true,
+                     .seal_pos = MotorStep::SealPos::RETRACTED},
+                };
+                test_motor_state_machine(tasks, approach_steps);
+            }
+            AND_WHEN("the switch never releases") {
+                std::vector<MotorStep> error_steps = {};
+                for (uint8_t i = 1;
+                     i < motor_task::SealHomingState::MAX_BACKOFFS; ++i) {
+                    error_steps.push_back(
+                        {.msg =
+                             messages::SealStepperComplete{
+                                 .reason = messages::SealStepperComplete::
+                                     CompletionReason::DONE},
+                         .seal_on = true,
+                         .seal_direction = false});
+                }
+                error_steps.push_back(
+                    {.msg =
+                         messages::SealStepperComplete{
+                             .reason = messages::SealStepperComplete::
+                                 CompletionReason::DONE},
+                     .seal_on = false,
+                     .seal_pos = MotorStep::SealPos::UNKNOWN,
+                     .ack = messages::AcknowledgePrevious{
+                         .responding_to_id = 123,
+                         .with_error = errors::ErrorCode::SEAL_MOTOR_SWITCH}});
+                test_motor_state_machine(tasks, error_steps);
+            }
+        }
+        WHEN("the seal is retracted through the debug command") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::SealStepperDebugMessage{.id = 123, .steps = 1000});
+            tasks->run_motor_task();
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::SealStepperComplete{
+                    .reason = messages::SealStepperComplete::CompletionReason::
+                        LIMIT});
+            tasks->run_motor_task();
+            THEN("no homing action is performed") {
+                REQUIRE(!motor_policy.seal_moving());
+                auto msg = tasks->get_host_comms_queue().backing_deque.front();
+                REQUIRE(std::holds_alternative<
+                        messages::SealStepperDebugResponse>(msg));
+            }
+        }
+    }
+}
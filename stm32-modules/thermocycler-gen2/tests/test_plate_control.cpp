@@ -2,7 +2,9 @@
 #include <vector>
 
 #include "catch2/catch.hpp"
+#include "simulator/thermal_network.hpp"
 #include "thermocycler-gen2/plate_control.hpp"
+#include "thermocycler-gen2/plate_model.hpp"
 
 using namespace thermal_general;
 
@@ -624,3 +626,237 @@ SCENARIO("PlateControl active fan control works") {
         }
     }
 }
+
+/**
+ * The plant for the settling tests. It is deliberately not the model that
+ * the feed-forward term is built from: each channel has 20-30% more heat
+ * capacity and a stronger heatsink coupling than plate_model's defaults,
+ * pumps its heat into a heatsink that warms up, and is coupled to its
+ * neighbours and to a sample.
+ */
+static constexpr std::string_view SETTLE_TEST_PLANT = R"(
+node ambient capacity=1 temperature=23 fixed
+node heatsink capacity=400 temperature=23
+node plate_left capacity=12 temperature=23 power=32 source=heatsink
+node plate_center capacity=13 temperature=23 power=32 source=heatsink
+node plate_right capacity=12 temperature=23 power=32 source=heatsink
+node sample capacity=4 temperature=23
+link heatsink ambient 8
+link plate_left heatsink 0.02
+link plate_center heatsink 0.02
+link plate_right heatsink 0.02
+link plate_left plate_center 0.2
+link plate_center plate_right 0.2
+link sample plate_left 0.1
+link sample plate_center 0.1
+link sample plate_right 0.1
+)";
+
+/**
+ * Drives a PlateControl object against SETTLE_TEST_PLANT, starting with the
+ * plate and sample at \c start and the heatsink at room temperature.
+ * Returns the time after which the average plate temperature stays within
+ * SETTLE_BAND of the target.
+ */
+static auto simulated_settle_time(double start, double target,
+                                  double ramp_rate, bool feed_forward)
+    -> double {
+    static constexpr double CONTROL_PERIOD_SEC = 0.05F;
+    static constexpr double DURATION_SEC = 300.0F;
+    static constexpr double SETTLE_BAND = 0.25F;
+    // Firmware default PID constants
+    static constexpr double KP = 0.3, KI = 0.05, KD = 0.3;
+    auto plant = thermal_network::parse(SETTLE_TEST_PLANT).value();
+    auto heatsink = plant.find("heatsink").value();
+    for (const auto* name : {"plate_left", "plate_center", "plate_right",
+                             "sample"}) {
+        plant.set_temperature(plant.find(name).value(), start);
+    }
+
+    std::vector<Thermistor> thermistors;
+    for (int i = 0; i < (PeltierID::PELTIER_NUMBER * 2) + 1; ++i) {
+        thermistors.push_back(Thermistor{
+            .temp_c = ROOM_TEMP,
+            .overtemp_limit_c = 105.0,
+            .disconnected_error =
+                errors::ErrorCode::THERMISTOR_HEATSINK_DISCONNECTED,
+            .short_error = errors::ErrorCode::THERMISTOR_HEATSINK_SHORT,
+            .overtemp_error = errors::ErrorCode::THERMISTOR_HEATSINK_OVERTEMP,
+            .error_bit = (uint8_t)(1 << i)});
+    }
+    set_temp(thermistors, start, ROOM_TEMP);
+    Peltier left{.id = PeltierID::PELTIER_LEFT,
+                 .thermistors =
+                     Peltier::ThermistorPair(thermistors.at(THERM_BACK_LEFT),
+                                             thermistors.at(THERM_FRONT_LEFT)),
+                 .pid = PID(KP, KI, KD, CONTROL_PERIOD_SEC, 1.0, -1.0)};
+    Peltier right{.id = PeltierID::PELTIER_RIGHT,
+                  .thermistors = Peltier::ThermistorPair(
+                      thermistors.at(THERM_BACK_RIGHT),
+                      thermistors.at(THERM_FRONT_RIGHT)),
+                  .pid = PID(KP, KI, KD, CONTROL_PERIOD_SEC, 1.0, -1.0)};
+    Peltier center{.id = PeltierID::PELTIER_CENTER,
+                   .thermistors = Peltier::ThermistorPair(
+                       thermistors.at(THERM_BACK_CENTER),
+                       thermistors.at(THERM_FRONT_CENTER)),
+                   .pid = PID(KP, KI, KD, CONTROL_PERIOD_SEC, 1.0, -1.0)};
+    HeatsinkFan fan{.thermistor = thermistors.at(THERM_HEATSINK),
+                    .pid = PID(KP, KI, KD, CONTROL_PERIOD_SEC, 1.0, -1.0)};
+    auto plateControl = plate_control::PlateControl(left, right, center, fan);
+    auto channels = std::array{
+        std::make_pair(&left, plant.find("plate_left").value()),
+        std::make_pair(&center, plant.find("plate_center").value()),
+        std::make_pair(&right, plant.find("plate_right").value())};
+
+    REQUIRE(plateControl.set_new_target(target, 0.0F, 0.0F, ramp_rate,
+                                        feed_forward));
+    double last_unsettled = 0.0F;
+    for (double time = 0.0F; time < DURATION_SEC; time += CONTROL_PERIOD_SEC) {
+        auto ctrl = plateControl.update_control(CONTROL_PERIOD_SEC);
+        REQUIRE(ctrl.has_value());
+        plant.set_drive(channels[0].second, ctrl->left_power);
+        plant.set_drive(channels[1].second, ctrl->center_power);
+        plant.set_drive(channels[2].second, ctrl->right_power);
+        plant.advance(CONTROL_PERIOD_SEC);
+        for (auto [peltier, node] : channels) {
+            peltier->thermistors.first.temp_c = plant.temperature(node);
+            peltier->thermistors.second.temp_c = plant.temperature(node);
+        }
+        fan.thermistor.temp_c = plant.temperature(heatsink);
+        if (std::abs(plateControl.plate_temp() - target) > SETTLE_BAND) {
+            last_unsettled = time + CONTROL_PERIOD_SEC;
+        }
+    }
+    return last_unsettled;
+}
+
+SCENARIO("PlateControl feed-forward control settles faster") {
+    auto [start, target, ramp_rate] = GENERATE(table<double, double, double>(
+        {{ROOM_TEMP, HOT_TEMP, 1.0F},
+         {ROOM_TEMP, HOT_TEMP, 2.0F},
+         {HOT_TEMP, 50.0F, 1.0F},
+         {HOT_TEMP, 60.0F, 2.0F},
+         {ROOM_TEMP, COLD_TEMP, 0.5F}}));
+    // The plate can't settle before the ramp is over
+    const double ramp_time = std::abs(target - start) / ramp_rate;
+    GIVEN("a ramped step between two temperatures") {
+        WHEN("driving the simulated plate with and without feed-forward") {
+            auto pid_only =
+                simulated_settle_time(start, target, ramp_rate, false);
+            auto with_model =
+                simulated_settle_time(start, target, ramp_rate, true);
+            THEN("feed-forward settles faster") {
+                REQUIRE(with_model < pid_only);
+            }
+            // The model is off from the plant, so the PID still has some
+            // correcting to do once the ramp is over
+            THEN("feed-forward settles soon after the ramp ends") {
+                REQUIRE(with_model < ramp_time + 10.0F);
+            }
+        }
+    }
+}
+
+SCENARIO("PlateControl schedules peltier gains") {
+    GIVEN("a PlateControl object with room temperature thermistors") {
+        std::vector<Thermistor> thermistors;
+        for (int i = 0; i < (PeltierID::PELTIER_NUMBER * 2) + 1; ++i) {
+            thermistors.push_back(Thermistor{
+                .temp_c = ROOM_TEMP,
+                .overtemp_limit_c = 105.0,
+                .disconnected_error =
+                    errors::ErrorCode::THERMISTOR_HEATSINK_DISCONNECTED,
+                .short_error = errors::ErrorCode::THERMISTOR_HEATSINK_SHORT,
+                .overtemp_error =
+                    errors::ErrorCode::THERMISTOR_HEATSINK_OVERTEMP,
+                .error_bit = (uint8_t)(1 << i)});
+        }
+        Peltier left{.id = PeltierID::PELTIER_LEFT,
+                     .thermistors = Peltier::ThermistorPair(
+                         thermistors.at(THERM_BACK_LEFT),
+                         thermistors.at(THERM_FRONT_LEFT)),
+                     .pid = PID(1, 0.1, 0, UPDATE_RATE_SEC, 1.0, -1.0)};
+        Peltier right{.id = PeltierID::PELTIER_RIGHT,
+                      .thermistors = Peltier::ThermistorPair(
+                          thermistors.at(THERM_BACK_RIGHT),
+                          thermistors.at(THERM_FRONT_RIGHT)),
+                      .pid = PID(1, 0.1, 0, UPDATE_RATE_SEC, 1.0, -1.0)};
+        Peltier center{.id = PeltierID::PELTIER_CENTER,
+                       .thermistors = Peltier::ThermistorPair(
+                           thermistors.at(THERM_BACK_CENTER),
+                           thermistors.at(THERM_FRONT_CENTER)),
+                       .pid = PID(1, 0.1, 0, UPDATE_RATE_SEC, 1.0, -1.0)};
+        HeatsinkFan fan{.thermistor = thermistors.at(THERM_HEATSINK),
+                        .pid = PID(1, 0, 0, UPDATE_RATE_SEC, 1.0, -1.0)};
+        auto plateControl =
+            plate_control::PlateControl(left, right, center, fan);
+        using plate_control::PlateControl;
+        using plate_control::TemperatureZone;
+        auto hot = PlateControl::zone_index(TemperatureZone::HOT);
+        auto cold = PlateControl::zone_index(TemperatureZone::COLD);
+        REQUIRE(plateControl.set_gains(hot, PIDDirection::HEATING,
+                                       PIDGains{.kp = 2, .ki = 0.2, .kd = 0}));
+        REQUIRE(plateControl.set_gains(cold, PIDDirection::COOLING,
+                                       PIDGains{.kp = 4, .ki = 0.4, .kd = 0}));
+
+        THEN("the schedule starts from the peltier gains") {
+            auto gains = plateControl.gain_schedule().get(
+                PlateControl::zone_index(TemperatureZone::WARM),
+                PIDDirection::HEATING);
+            REQUIRE(gains.kp == 1);
+            REQUIRE(gains.ki == 0.1);
+        }
+        THEN("zones that don't exist are rejected") {
+            REQUIRE(!plateControl.set_gains(
+                PlateControl::ZONE_COUNT, std::nullopt,
+                PIDGains{.kp = 9, .ki = 9, .kd = 9}));
+        }
+        WHEN("heating to a hot target") {
+            plateControl.set_new_target(HOT_TEMP, 0);
+            THEN("every peltier uses the hot heating gains") {
+                REQUIRE(left.pid.kp() == 2);
+                REQUIRE(right.pid.kp() == 2);
+                REQUIRE(center.pid.kp() == 2);
+                REQUIRE(left.pid.ki() == 0.2);
+            }
+        }
+        WHEN("cooling to a cold target") {
+            plateControl.set_new_target(COLD_TEMP, 0);
+            THEN("every peltier uses the cold cooling gains") {
+                REQUIRE(left.pid.kp() == 4);
+                REQUIRE(right.pid.kp() == 4);
+                REQUIRE(center.pid.kp() == 4);
+            }
+        }
+        WHEN("heating to a warm target") {
+            plateControl.set_new_target(WARM_TEMP, 0);
+            THEN("the unchanged gains are used") {
+                REQUIRE(left.pid.kp() == 1);
+            }
+        }
+        WHEN("the plate is held just below the hot zone") {
+            set_temp(thermistors, 31.8);
+            plateControl.set_new_target(31.5, 0);
+            for (int i = 0; i < 10; ++i) {
+                static_cast<void>(
+                    plateControl.update_control(UPDATE_RATE_SEC));
+            }
+            auto before = plateControl.update_control(UPDATE_RATE_SEC);
+            AND_WHEN("the target moves up into the hot zone") {
+                plateControl.set_new_target(32.1, 0);
+                THEN("the gains switch without resetting the controller") {
+                    REQUIRE(left.pid.kp() == 2);
+                    REQUIRE(left.pid.last_iterm() != 0.0F);
+                    auto after = plateControl.update_control(UPDATE_RATE_SEC);
+                    REQUIRE(before.has_value());
+                    REQUIRE(after.has_value());
+                    // The target moved by 0.6º, so the power only changes
+                    // by the new proportional gain on that step
+                    REQUIRE_THAT(after.value().left_power -
+                                     before.value().left_power,
+                                 Catch::Matchers::WithinAbs(2 * 0.6, 0.01));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#include "catch2/catch.hpp"
+#include "thermocycler-gen2/plate_model.hpp"
+
+using namespace plate_model;
+
+SCENARIO("plate thermal model") {
+    GIVEN("a model with known parameters") {
+        auto model = PlateModel(Parameters{.gain = 2.0, .loss = 0.01});
+        THEN("the rate combines peltier power and heatsink loss") {
+            REQUIRE_THAT(model.rate(50, 30, 0.5),
+                         Catch::Matchers::WithinAbs(1.0 - 0.2, 0.0001));
+            REQUIRE_THAT(model.predict(50, 30, 0.5, 2.0),
+                         Catch::Matchers::WithinAbs(51.6, 0.0001));
+        }
+        THEN("holding at the heatsink temperature needs no power") {
+            REQUIRE(model.feed_forward(30, 30, 0) == 0.0);
+        }
+        THEN("the feed-forward power holds the target still") {
+            auto power = model.feed_forward(90, 30, 0);
+            REQUIRE(power > 0.0);
+            REQUIRE_THAT(model.rate(90, 30, power),
+                         Catch::Matchers::WithinAbs(0.0, 0.0001));
+        }
+        THEN("the feed-forward power follows a ramp") {
+            auto power = model.feed_forward(60, 30, -1.0);
+            REQUIRE_THAT(model.rate(60, 30, power),
+                         Catch::Matchers::WithinAbs(-1.0, 0.0001));
+        }
+        THEN("the feed-forward power is limited to full power") {
+            REQUIRE(model.feed_forward(60, 30, 10.0) == PlateModel::POWER_MAX);
+            REQUIRE(model.feed_forward(60, 30, -10.0) ==
+                    PlateModel::POWER_MIN);
+        }
+        WHEN("setting invalid parameters") {
+            REQUIRE(!model.set_parameters(Parameters{.gain = 0, .loss = 0}));
+            REQUIRE(!model.set_parameters(Parameters{.gain = 1, .loss = -1}));
+            THEN("the old parameters are kept") {
+                REQUIRE(model.parameters().gain == 2.0);
+                REQUIRE(model.parameters().loss == 0.01);
+            }
+        }
+        WHEN("setting valid parameters") {
+            REQUIRE(model.set_parameters(Parameters{.gain = 3, .loss = 0}));
+            THEN("they are applied") {
+                REQUIRE(model.parameters().gain == 3.0);
+                REQUIRE(model.parameters().loss == 0.0);
+            }
+        }
+    }
+}
@@ -45,3 +45,24 @@ auto TestSystemPolicy::set_front_button_led(bool set) -> void {
 }
 
 auto TestSystemPolicy::get_front_led() -> bool { return front_led; }
+
+auto TestSystemPolicy::get_task_count() const -> size_t {
+    return stacks.size();
+}
+
+auto TestSystemPolicy::get_stack_usage(size_t index) const
+    -> task_memory::StackUsage {
+    return stacks.at(index);
+}
+
+auto TestSystemPolicy::get_ram_usage() const -> task_memory::RamUsage {
+    return ram;
+}
+
+auto TestSystemPolicy::add_task_stack(task_memory::StackUsage stack) -> void {
+    stacks.push_back(stack);
+}
+
+auto TestSystemPolicy::set_ram_usage(task_memory::RamUsage usage) -> void {
+    ram = usage;
+}
@@ -461,6 +461,70 @@ SCENARIO("system task message passing") {
                 }
             }
         }
+        GIVEN("more tasks than fit in one response") {
+            for (uint32_t i = 0; i < 7; ++i) {
+                tasks->get_system_policy().add_task_stack(
+                    task_memory::StackUsage{.name = "Task",
+                                            .size_words = 100 + i,
+                                            .min_free_words = 10 + i});
+            }
+            tasks->get_system_policy().set_ram_usage(
+                task_memory::RamUsage{.data_bytes = 1,
+                                      .bss_bytes = 2,
+                                      .heap_peak_bytes = 3,
+                                      .heap_used_bytes = 4});
+            WHEN("sending a GetTaskMemory message for the first page") {
+                auto message =
+                    messages::GetTaskMemoryMessage{.id = 55, .start = 0};
+                tasks->get_system_queue().backing_deque.push_back(
+                    messages::SystemMessage(message));
+                tasks->run_system_task();
+                THEN("the response holds a full page and the RAM usage") {
+                    auto host_message =
+                        tasks->get_host_comms_queue().backing_deque.front();
+                    REQUIRE(std::holds_alternative<
+                            messages::GetTaskMemoryResponse>(host_message));
+                    auto response = std::get<messages::GetTaskMemoryResponse>(
+                        host_message);
+                    REQUIRE(response.responding_to_id == message.id);
+                    REQUIRE(response.total == 7);
+                    REQUIRE(response.start == 0);
+                    REQUIRE(response.count ==
+                            messages::GetTaskMemoryResponse::MAX_TASKS);
+                    REQUIRE(response.stacks.at(1).size_words == 101);
+                    REQUIRE(response.stacks.at(1).min_free_words == 11);
+                    REQUIRE(response.ram.bss_bytes == 2);
+                    REQUIRE(response.ram.heap_used_bytes == 4);
+                }
+            }
+            WHEN("sending a GetTaskMemory message for the last page") {
+                auto message =
+                    messages::GetTaskMemoryMessage{.id = 56, .start = 6};
+                tasks->get_system_queue().backing_deque.push_back(
+                    messages::SystemMessage(message));
+                tasks->run_system_task();
+                THEN("the response holds only the remaining tasks") {
+                    auto response = std::get<messages::GetTaskMemoryResponse>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(response.start == 6);
+                    REQUIRE(response.count == 1);
+                    REQUIRE(response.stacks.at(0).size_words == 106);
+                }
+            }
+            WHEN("sending a GetTaskMemory message past the last task") {
+                auto message =
+                    messages::GetTaskMemoryMessage{.id = 57, .start = 9};
+                tasks->get_system_queue().backing_deque.push_back(
+                    messages::SystemMessage(message));
+                tasks->run_system_task();
+                THEN("the response holds no tasks") {
+                    auto response = std::get<messages::GetTaskMemoryResponse>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(response.total == 7);
+                    REQUIRE(response.count == 0);
+                }
+            }
+        }
     }
 }
 
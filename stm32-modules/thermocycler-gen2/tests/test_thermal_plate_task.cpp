@@ -1,5 +1,6 @@
 #include <iterator>
 #include <list>
+#include <vector>
 
 #include "catch2/catch.hpp"
 #include "core/thermistor_conversion.hpp"
@@ -1290,4 +1291,443 @@ TEST_CASE("thermal plate tick overflow handling") {
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("thermal plate task runs thermal programs") {
+    GIVEN("a thermal plate task with the plate at 20.5ºC") {
+        uint32_t timestamp = TIME_DELTA;
+        auto tasks = TaskBuilder::build();
+        auto &plate_queue = tasks->get_thermal_plate_queue();
+        auto &plate_policy = tasks->get_thermal_plate_policy();
+        auto &host_queue = tasks->get_host_comms_queue();
+        auto &lid_queue = tasks->get_lid_heater_queue();
+
+        auto default_offset_msg = messages::SetOffsetConstantsMessage{
+            .id = 1,
+            .channel = PeltierSelection::ALL,
+            .a_set = true,
+            .const_a = 0,
+            .b_set = true,
+            .const_b = 0,
+            .c_set = true,
+            .const_c = 0,
+        };
+        plate_queue.backing_deque.push_back(default_offset_msg);
+        tasks->run_thermal_plate_task();
+        // Targets below ambient and within a degree of the plate settle
+        // immediately, so each step takes a fixed number of readings
+        auto adc = _converter.backconvert(20.5);
+        auto read_message =
+            messages::ThermalPlateTempReadComplete{.heat_sink = adc,
+                                                   .front_right = adc,
+                                                   .front_center = adc,
+                                                   .front_left = adc,
+                                                   .back_right = adc,
+                                                   .back_center = adc,
+                                                   .back_left = adc,
+                                                   .timestamp_ms = timestamp};
+        auto send_reading = [&]() {
+            timestamp += 1000;
+            read_message.timestamp_ms = timestamp;
+            plate_queue.backing_deque.push_back(read_message);
+            tasks->run_thermal_plate_task();
+        };
+        send_reading();
+        host_queue.backing_deque.clear();
+
+        auto take_events = [&]() {
+            std::vector<messages::ThermalProgramStepEvent> events;
+            for (auto &msg : host_queue.backing_deque) {
+                if (std::holds_alternative<messages::ThermalProgramStepEvent>(
+                        msg)) {
+                    events.push_back(
+                        std::get<messages::ThermalProgramStepEvent>(msg));
+                }
+            }
+            host_queue.backing_deque.clear();
+            return events;
+        };
+        auto take_ack = [&]() {
+            REQUIRE(host_queue.has_message());
+            auto msg = host_queue.backing_deque.front();
+            host_queue.backing_deque.pop_front();
+            REQUIRE(std::holds_alternative<messages::AcknowledgePrevious>(msg));
+            return std::get<messages::AcknowledgePrevious>(msg);
+        };
+
+        WHEN("starting without a program") {
+            plate_queue.backing_deque.push_back(
+                messages::StartThermalProgramMessage{.id = 5,
+                                                     .lid_target = 0});
+            tasks->run_thermal_plate_task();
+            THEN("it is acked with an error") {
+                auto ack = take_ack();
+                REQUIRE(ack.responding_to_id == 5);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::THERMAL_PROGRAM_EMPTY);
+                REQUIRE(!plate_policy._enabled);
+            }
+        }
+        WHEN("setting the plate model") {
+            plate_queue.backing_deque.push_back(messages::SetPlateModelMessage{
+                .id = 7, .gain = 3.0, .loss = 0.002});
+            plate_queue.backing_deque.push_back(messages::SetPlateModelMessage{
+                .id = 8, .gain = 0, .loss = 0.002});
+            tasks->run_thermal_plate_task();
+            tasks->run_thermal_plate_task();
+            THEN("valid parameters are accepted") {
+                auto ack = take_ack();
+                REQUIRE(ack.responding_to_id == 7);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+            THEN("invalid parameters are rejected") {
+                static_cast<void>(take_ack());
+                auto ack = take_ack();
+                REQUIRE(ack.responding_to_id == 8);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::THERMAL_CONSTANT_OUT_OF_RANGE);
+            }
+        }
+        WHEN("uploading an invalid step") {
+            plate_queue.backing_deque.push_back(
+                messages::SetThermalProgramStepMessage{
+                    .id = 6,
+                    .index = 1,
+                    .step = {.temperature = 20,
+                             .hold_time = 0,
+                             .ramp_rate = 0,
+                             .volume = -1}});
+            tasks->run_thermal_plate_task();
+            THEN("it is acked with an error") {
+                auto ack = take_ack();
+                REQUIRE(ack.responding_to_id == 6);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::THERMAL_PROGRAM_STEP_INVALID);
+            }
+        }
+        WHEN("uploading a program that alternates 20ºC and 21ºC twice") {
+            plate_queue.backing_deque.push_back(
+                messages::SetThermalProgramStepMessage{
+                    .id = 10,
+                    .index = 0,
+                    .step = {.temperature = 20,
+                             .hold_time = 1,
+                             .ramp_rate = 0,
+                             .volume = -1}});
+            plate_queue.backing_deque.push_back(
+                messages::SetThermalProgramStepMessage{
+                    .id = 11,
+                    .index = 1,
+                    .step = {.temperature = 21,
+                             .hold_time = 0,
+                             .ramp_rate = 0,
+                             .volume = -1,
+                             .loop_to = 0,
+                             .loop_count = 1}});
+            tasks->run_thermal_plate_task();
+            tasks->run_thermal_plate_task();
+            REQUIRE(take_ack().with_error == errors::ErrorCode::NO_ERROR);
+            REQUIRE(take_ack().with_error == errors::ErrorCode::NO_ERROR);
+            AND_WHEN("starting it with a lid target") {
+                plate_queue.backing_deque.push_back(
+                    messages::StartThermalProgramMessage{.id = 12,
+                                                         .lid_target = 105});
+                tasks->run_thermal_plate_task();
+                THEN("it is acked and the first step starts") {
+                    auto ack = take_ack();
+                    REQUIRE(ack.responding_to_id == 12);
+                    REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                    auto events = take_events();
+                    REQUIRE(events.size() == 1);
+                    REQUIRE(events[0].step == 0);
+                    REQUIRE(events[0].executed == 1);
+                    REQUIRE(events[0].target == 20);
+                    REQUIRE(!events[0].finished);
+                }
+                THEN("the lid heater is started without a host ack") {
+                    REQUIRE(lid_queue.has_message());
+                    auto lid_msg = lid_queue.backing_deque.front();
+                    REQUIRE(std::holds_alternative<
+                            messages::SetLidTemperatureMessage>(lid_msg));
+                    auto lid_set =
+                        std::get<messages::SetLidTemperatureMessage>(lid_msg);
+                    REQUIRE(lid_set.setpoint == 105);
+                    REQUIRE(lid_set.from_program);
+                }
+                AND_WHEN("temperature readings arrive") {
+                    host_queue.backing_deque.clear();
+                    std::vector<messages::ThermalProgramStepEvent> events;
+                    for (int i = 0; i < 10; ++i) {
+                        send_reading();
+                        for (auto event : take_events()) {
+                            events.push_back(event);
+                        }
+                    }
+                    THEN("every step and loop pass runs in order") {
+                        REQUIRE(plate_policy._enabled);
+                        REQUIRE(events.size() == 4);
+                        REQUIRE(events[0].step == 1);
+                        REQUIRE(events[0].target == 21);
+                        REQUIRE(events[1].step == 0);
+                        REQUIRE(events[1].target == 20);
+                        REQUIRE(events[2].step == 1);
+                        REQUIRE(events[2].executed == 4);
+                        REQUIRE(events[3].finished);
+                        REQUIRE(events[3].executed == 4);
+                    }
+                    AND_WHEN("querying the program status") {
+                        plate_queue.backing_deque.push_back(
+                            messages::GetThermalProgramStatusMessage{.id = 13});
+                        tasks->run_thermal_plate_task();
+                        THEN("the program is reported as finished") {
+                            REQUIRE(host_queue.has_message());
+                            auto msg = host_queue.backing_deque.front();
+                            REQUIRE(std::holds_alternative<
+                                    messages::GetThermalProgramStatusResponse>(
+                                msg));
+                            auto status = std::get<
+                                messages::GetThermalProgramStatusResponse>(msg);
+                            REQUIRE(status.responding_to_id == 13);
+                            REQUIRE(!status.running);
+                            REQUIRE(status.step_count == 2);
+                            REQUIRE(status.executed == 4);
+                            REQUIRE(status.total == 4);
+                            REQUIRE(status.lid_target == 105);
+                        }
+                    }
+                }
+                AND_WHEN("setting the plate model while it runs") {
+                    host_queue.backing_deque.clear();
+                    plate_queue.backing_deque.push_back(
+                        messages::SetPlateModelMessage{
+                            .id = 16, .gain = 3.0, .loss = 0.002});
+                    tasks->run_thermal_plate_task();
+                    THEN("it is rejected") {
+                        REQUIRE(take_ack().with_error ==
+                                errors::ErrorCode::THERMAL_PLATE_BUSY);
+                    }
+                }
+                AND_WHEN("uploading a step while it runs") {
+                    host_queue.backing_deque.clear();
+                    plate_queue.backing_deque.push_back(
+                        messages::SetThermalProgramStepMessage{
+                            .id = 14,
+                            .index = 0,
+                            .step = {.temperature = 30,
+                                     .hold_time = 0,
+                                     .ramp_rate = 0,
+                                     .volume = -1}});
+                    tasks->run_thermal_plate_task();
+                    THEN("it is rejected") {
+                        REQUIRE(take_ack().with_error ==
+                                errors::ErrorCode::THERMAL_PLATE_BUSY);
+                    }
+                }
+                AND_WHEN("deactivating the plate") {
+                    plate_queue.backing_deque.push_back(
+                        messages::DeactivatePlateMessage{.id = 15});
+                    tasks->run_thermal_plate_task();
+                    host_queue.backing_deque.clear();
+                    for (int i = 0; i < 10; ++i) {
+                        send_reading();
+                    }
+                    THEN("the program stops") {
+                        REQUIRE(take_events().empty());
+                        REQUIRE(!plate_policy._enabled);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("thermal plate task autotunes the peltier PID constants") {
+    GIVEN("a thermal plate task with the plate at 20.5ºC") {
+        uint32_t timestamp = TIME_DELTA;
+        auto tasks = TaskBuilder::build();
+        auto &plate_queue = tasks->get_thermal_plate_queue();
+        auto &plate_policy = tasks->get_thermal_plate_policy();
+        auto &host_queue = tasks->get_host_comms_queue();
+
+        auto default_offset_msg = messages::SetOffsetConstantsMessage{
+            .id = 1,
+            .channel = PeltierSelection::ALL,
+            .a_set = true,
+            .const_a = 0,
+            .b_set = true,
+            .const_b = 0,
+            .c_set = true,
+            .const_c = 0,
+        };
+        plate_queue.backing_deque.push_back(default_offset_msg);
+        tasks->run_thermal_plate_task();
+        auto heatsink_adc = _converter.backconvert(20.5);
+        auto send_reading = [&](double temp, uint32_t delta_ms = 1000) {
+            auto adc = _converter.backconvert(temp);
+            timestamp += delta_ms;
+            plate_queue.backing_deque.push_back(
+                messages::ThermalPlateTempReadComplete{
+                    .heat_sink = heatsink_adc,
+                    .front_right = adc,
+                    .front_center = adc,
+                    .front_left = adc,
+                    .back_right = adc,
+                    .back_center = adc,
+                    .back_left = adc,
+                    .timestamp_ms = timestamp});
+            tasks->run_thermal_plate_task();
+        };
+        send_reading(20.5);
+        host_queue.backing_deque.clear();
+
+        auto take_ack = [&]() {
+            REQUIRE(host_queue.has_message());
+            auto msg = host_queue.backing_deque.front();
+            host_queue.backing_deque.pop_front();
+            REQUIRE(std::holds_alternative<messages::AcknowledgePrevious>(msg));
+            return std::get<messages::AcknowledgePrevious>(msg);
+        };
+
+        WHEN("starting with an out-of-range target") {
+            plate_queue.backing_deque.push_back(
+                messages::StartPlateAutotuneMessage{
+                    .id = 2, .target = 120, .cycles = 4, .save = false});
+            tasks->run_thermal_plate_task();
+            THEN("it is rejected") {
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::THERMAL_TARGET_BAD);
+            }
+        }
+        WHEN("starting with no cycles") {
+            plate_queue.backing_deque.push_back(
+                messages::StartPlateAutotuneMessage{
+                    .id = 2, .target = 50, .cycles = 0, .save = false});
+            tasks->run_thermal_plate_task();
+            THEN("it is rejected") {
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::THERMAL_CONSTANT_OUT_OF_RANGE);
+            }
+        }
+        WHEN("starting while controlling a temperature") {
+            plate_queue.backing_deque.push_back(
+                messages::SetPlateTemperatureMessage{
+                    .id = 2, .setpoint = 50, .hold_time = 0, .volume = 10});
+            plate_queue.backing_deque.push_back(
+                messages::StartPlateAutotuneMessage{
+                    .id = 3, .target = 50, .cycles = 4, .save = false});
+            tasks->run_thermal_plate_task();
+            tasks->run_thermal_plate_task();
+            THEN("it is rejected") {
+                static_cast<void>(take_ack());
+                REQUIRE(take_ack().with_error ==
+                        errors::ErrorCode::THERMAL_PLATE_BUSY);
+            }
+        }
+        WHEN("starting an autotune around 21ºC over two cycles") {
+            plate_queue.backing_deque.push_back(
+                messages::StartPlateAutotuneMessage{
+                    .id = 2, .target = 21, .cycles = 2, .save = true});
+            tasks->run_thermal_plate_task();
+            THEN("it is acked") {
+                auto ack = take_ack();
+                REQUIRE(ack.responding_to_id == 2);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+            AND_WHEN("a reading below the target arrives") {
+                send_reading(20.5);
+                THEN("the peltiers heat") {
+                    REQUIRE(plate_policy._enabled);
+                    auto left = plate_policy.get_peltier(PELTIER_LEFT);
+                    REQUIRE(left.first == PeltierDirection::PELTIER_HEATING);
+                    REQUIRE(left.second > 0.0F);
+                }
+            }
+            AND_WHEN("a reading above the target arrives") {
+                send_reading(22);
+                THEN("the peltiers cool") {
+                    auto left = plate_policy.get_peltier(PELTIER_LEFT);
+                    REQUIRE(left.first == PeltierDirection::PELTIER_COOLING);
+                }
+            }
+            AND_WHEN("setting PID constants") {
+                host_queue.backing_deque.clear();
+                plate_queue.backing_deque.push_back(
+                    messages::SetPIDConstantsMessage{
+                        .id = 3,
+                        .selection = PidSelection::PELTIERS,
+                        .p = 1,
+                        .i = 1,
+                        .d = 1});
+                tasks->run_thermal_plate_task();
+                THEN("it is rejected") {
+                    REQUIRE(take_ack().with_error ==
+                            errors::ErrorCode::THERMAL_PLATE_BUSY);
+                }
+            }
+            AND_WHEN("the plate oscillates 1ºC around the target every 2s") {
+                host_queue.backing_deque.clear();
+                for (int i = 0; i < 4; ++i) {
+                    send_reading(22);
+                    send_reading(20);
+                }
+                THEN("the new constants are reported") {
+                    std::vector<messages::PlateAutotuneEvent> events;
+                    for (auto &msg : host_queue.backing_deque) {
+                        REQUIRE(!std::holds_alternative<messages::ErrorMessage>(
+                            msg));
+                        if (std::holds_alternative<
+                                messages::PlateAutotuneEvent>(msg)) {
+                            events.push_back(
+                                std::get<messages::PlateAutotuneEvent>(msg));
+                        }
+                    }
+                    REQUIRE(events.size() == 1);
+                    // Ku = 4 * 0.5 / (pi * sqrt(1 - 0.25^2)) and Tu = 2s
+                    auto kp = 0.6 * 0.6575;
+                    REQUIRE_THAT(events[0].kp,
+                                 Catch::Matchers::WithinRel(kp, 0.02));
+                    REQUIRE_THAT(events[0].ki,
+                                 Catch::Matchers::WithinRel(kp, 0.02));
+                    REQUIRE_THAT(events[0].kd,
+                                 Catch::Matchers::WithinRel(kp * 0.25, 0.02));
+                }
+                THEN("the peltiers are turned off") {
+                    REQUIRE(!plate_policy._enabled);
+                }
+            }
+            AND_WHEN("the plate never reaches the target") {
+                host_queue.backing_deque.clear();
+                send_reading(20.5, 1300 * 1000);
+                THEN("an autotune error is sent") {
+                    bool found = false;
+                    for (auto &msg : host_queue.backing_deque) {
+                        if (std::holds_alternative<messages::ErrorMessage>(
+                                msg)) {
+                            REQUIRE(
+                                std::get<messages::ErrorMessage>(msg).code ==
+                                errors::ErrorCode::THERMAL_AUTOTUNE_FAILED);
+                            found = true;
+                        }
+                    }
+                    REQUIRE(found);
+                    REQUIRE(!plate_policy._enabled);
+                }
+            }
+            AND_WHEN("deactivating the plate") {
+                plate_queue.backing_deque.push_back(
+                    messages::DeactivatePlateMessage{.id = 4});
+                tasks->run_thermal_plate_task();
+                host_queue.backing_deque.clear();
+                send_reading(20.5);
+                THEN("tuning stops") {
+                    REQUIRE(!plate_policy._enabled);
+                    REQUIRE(std::none_of(
+                        host_queue.backing_deque.begin(),
+                        host_queue.backing_deque.end(), [](auto &msg) {
+                            return std::holds_alternative<
+                                messages::ErrorMessage>(msg);
+                        }));
+                }
+            }
+        }
+    }
+}
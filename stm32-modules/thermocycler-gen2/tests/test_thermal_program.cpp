@@ -0,0 +1,168 @@
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "thermocycler-gen2/thermal_program.hpp"
+
+using namespace thermal_program;
+
+namespace {
+auto step(double temperature, uint16_t loop_to = 0, uint16_t loop_count = 0)
+    -> Step {
+    return Step{.temperature = temperature,
+                .hold_time = 10,
+                .ramp_rate = 0,
+                .volume = 25,
+                .loop_to = loop_to,
+                .loop_count = loop_count};
+}
+
+// Runs a program to the end and returns the target of every step it ran
+auto run_to_end(ThermalProgram& program) -> std::vector<double> {
+    std::vector<double> targets;
+    auto next = program.start();
+    while (next.has_value()) {
+        targets.push_back(next.value().temperature);
+        next = program.step_complete();
+    }
+    return targets;
+}
+}  // namespace
+
+SCENARIO("thermal program step storage") {
+    GIVEN("an empty thermal program") {
+        auto program = ThermalProgram();
+        REQUIRE(program.step_count() == 0);
+        REQUIRE(!program.running());
+        THEN("it can't be started") { REQUIRE(!program.start().has_value()); }
+        THEN("steps must be written in order") {
+            REQUIRE(!program.set_step(1, step(95)));
+            REQUIRE(program.set_step(0, step(95)));
+            REQUIRE(program.set_step(1, step(60)));
+            REQUIRE(program.step_count() == 2);
+        }
+        THEN("invalid steps are rejected") {
+            REQUIRE(!program.set_step(0, step(0)));
+            auto negative_hold = step(95);
+            negative_hold.hold_time = -1;
+            REQUIRE(!program.set_step(0, negative_hold));
+            auto negative_ramp = step(95);
+            negative_ramp.ramp_rate = -1;
+            REQUIRE(!program.set_step(0, negative_ramp));
+            REQUIRE(!program.set_step(0, step(95, 1, 3)));
+            REQUIRE(!program.set_step(ThermalProgram::MAX_STEPS, step(95)));
+            REQUIRE(program.step_count() == 0);
+        }
+        WHEN("filling the program") {
+            for (size_t i = 0; i < ThermalProgram::MAX_STEPS; ++i) {
+                REQUIRE(program.set_step(i, step(50)));
+            }
+            THEN("every step is stored") {
+                REQUIRE(program.step_count() == ThermalProgram::MAX_STEPS);
+            }
+            AND_WHEN("rewriting the first step") {
+                REQUIRE(program.set_step(0, step(95)));
+                THEN("the later steps are discarded") {
+                    REQUIRE(program.step_count() == 1);
+                }
+            }
+        }
+    }
+    GIVEN("a program with a loop over steps 1 to 3") {
+        auto program = ThermalProgram();
+        REQUIRE(program.set_step(0, step(95)));
+        REQUIRE(program.set_step(1, step(94)));
+        REQUIRE(program.set_step(2, step(60)));
+        REQUIRE(program.set_step(3, step(72, 1, 2)));
+        THEN("a loop that crosses into it is rejected") {
+            REQUIRE(!program.set_step(4, step(4, 2, 1)));
+        }
+        THEN("a loop that encloses it is accepted") {
+            REQUIRE(program.set_step(4, step(4, 0, 1)));
+        }
+        WHEN("the program is running") {
+            REQUIRE(program.start().has_value());
+            THEN("steps can't be changed") {
+                REQUIRE(!program.set_step(4, step(4)));
+                REQUIRE(!program.set_step(0, step(90)));
+            }
+        }
+    }
+}
+
+SCENARIO("thermal program execution") {
+    GIVEN("a program without loops") {
+        auto program = ThermalProgram();
+        REQUIRE(program.set_step(0, step(95)));
+        REQUIRE(program.set_step(1, step(60)));
+        REQUIRE(program.set_step(2, step(4)));
+        WHEN("starting the program") {
+            auto first = program.start();
+            THEN("the first step is returned") {
+                REQUIRE(first.has_value());
+                REQUIRE(first.value().temperature == 95);
+                REQUIRE(program.running());
+                REQUIRE(program.step_index() == 0);
+                REQUIRE(program.steps_executed() == 1);
+                REQUIRE(program.total_steps() == 3);
+            }
+            AND_WHEN("completing every step") {
+                REQUIRE(program.step_complete().value().temperature == 60);
+                REQUIRE(program.step_complete().value().temperature == 4);
+                auto after = program.step_complete();
+                THEN("the program finishes on the last step") {
+                    REQUIRE(!after.has_value());
+                    REQUIRE(!program.running());
+                    REQUIRE(program.step_index() == 2);
+                    REQUIRE(program.steps_executed() == 3);
+                }
+            }
+            AND_WHEN("stopping the program") {
+                program.stop();
+                THEN("no more steps are returned") {
+                    REQUIRE(!program.running());
+                    REQUIRE(!program.step_complete().has_value());
+                }
+            }
+        }
+    }
+    GIVEN("a PCR-style program") {
+        // Initial denature, then 3 cycles of denature/anneal/extend, then a
+        // final extension and a cold hold
+        auto program = ThermalProgram();
+        REQUIRE(program.set_step(0, step(95)));
+        REQUIRE(program.set_step(1, step(94)));
+        REQUIRE(program.set_step(2, step(60)));
+        REQUIRE(program.set_step(3, step(72, 1, 2)));
+        REQUIRE(program.set_step(4, step(72)));
+        REQUIRE(program.set_step(5, step(4)));
+        WHEN("running it to the end") {
+            auto targets = run_to_end(program);
+            THEN("the loop runs the requested number of times") {
+                REQUIRE(targets == std::vector<double>{95, 94, 60, 72, 94, 60,
+                                                       72, 94, 60, 72, 72, 4});
+                REQUIRE(program.steps_executed() == targets.size());
+                REQUIRE(program.total_steps() == targets.size());
+            }
+            AND_WHEN("running it again") {
+                auto second = run_to_end(program);
+                THEN("the loop counts start over") {
+                    REQUIRE(second == targets);
+                }
+            }
+        }
+    }
+    GIVEN("a program with nested loops") {
+        auto program = ThermalProgram();
+        REQUIRE(program.set_step(0, step(90)));
+        REQUIRE(program.set_step(1, step(60, 1, 1)));
+        REQUIRE(program.set_step(2, step(70, 0, 2)));
+        WHEN("running it to the end") {
+            auto targets = run_to_end(program);
+            THEN("the inner loop runs in full on every outer pass") {
+                REQUIRE(targets == std::vector<double>{90, 60, 60, 70, 90, 60,
+                                                       60, 70, 90, 60, 60, 70});
+                REQUIRE(program.total_steps() == targets.size());
+            }
+        }
+    }
+}
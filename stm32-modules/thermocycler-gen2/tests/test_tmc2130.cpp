@@ -357,3 +357,136 @@ SCENARIO("tmc2130 register API works") {
         }
     }
 }
+
+SCENARIO("tmc2130 transaction batches work") {
+    GIVEN("a tmc2130 interface and a blank register map") {
+        tmc2130::TMC2130Interface spi;
+        TestTMC2130Policy policy;
+        policy.write_register(tmc2130::Registers::DRVSTATUS, 0x12345678);
+        policy.write_register(tmc2130::Registers::TSTEP, 0xABCDE);
+        WHEN("executing an empty batch") {
+            tmc2130::TransactionBatch batch;
+            REQUIRE(spi.execute(batch, policy));
+            THEN("nothing is sent") {
+                REQUIRE(policy.get_transaction_count() == 0);
+                REQUIRE(policy.get_burst_count() == 0);
+            }
+        }
+        WHEN("executing a batch of writes and reads") {
+            tmc2130::TransactionBatch batch;
+            REQUIRE(batch.queue_write(tmc2130::Registers::GCONF, 0x4));
+            REQUIRE(batch.queue_read(tmc2130::Registers::DRVSTATUS));
+            REQUIRE(batch.queue_write(tmc2130::Registers::THIGH, 0x100));
+            REQUIRE(batch.queue_read(tmc2130::Registers::TSTEP));
+            REQUIRE(spi.execute(batch, policy));
+            THEN("the batch is sent as a single burst") {
+                REQUIRE(policy.get_burst_count() == 1);
+                // One extra datagram to clock out the trailing read
+                REQUIRE(policy.get_transaction_count() == 5);
+            }
+            THEN("the writes are applied") {
+                REQUIRE(policy.read_register(tmc2130::Registers::GCONF)
+                            .value() == 0x4);
+                REQUIRE(policy.read_register(tmc2130::Registers::THIGH)
+                            .value() == 0x100);
+            }
+            THEN("the read results are returned in order") {
+                REQUIRE(batch.at(1).value == 0x12345678);
+                REQUIRE(batch.at(3).value == 0xABCDE);
+            }
+        }
+        WHEN("filling a batch") {
+            tmc2130::TransactionBatch batch;
+            for (size_t i = 0; i < tmc2130::MAX_BATCH_LEN; ++i) {
+                REQUIRE(batch.queue_read(tmc2130::Registers::GSTAT));
+            }
+            THEN("no more entries can be queued") {
+                REQUIRE(!batch.queue_read(tmc2130::Registers::GSTAT));
+                REQUIRE(batch.size() == tmc2130::MAX_BATCH_LEN);
+            }
+        }
+    }
+}
+
+SCENARIO("tmc2130 shadow register map skips redundant writes") {
+    GIVEN("a tmc2130 with a register map") {
+        tmc2130::TMC2130RegisterMap registers = {
+            .gconfig = {.en_pwm_mode = 1},
+            .ihold_irun = {.hold_current = 0x1, .run_current = 0x2},
+            .coolconf = {.sgt = 6}};
+        auto tmc = tmc2130::TMC2130(registers);
+        TestTMC2130Policy policy;
+        WHEN("writing the configuration") {
+            REQUIRE(tmc.write_config(policy));
+            THEN("every register is written in one burst") {
+                REQUIRE(policy.get_burst_count() == 1);
+                REQUIRE(policy.get_transaction_count() == 7);
+            }
+            AND_WHEN("writing the same configuration again") {
+                REQUIRE(tmc.write_config(policy));
+                THEN("nothing is sent") {
+                    REQUIRE(policy.get_burst_count() == 1);
+                    REQUIRE(policy.get_transaction_count() == 7);
+                }
+            }
+            AND_WHEN("changing a single register") {
+                tmc.get_register_map().coolconf.sgt = -10;
+                REQUIRE(tmc.write_config(policy));
+                THEN("only that register is sent") {
+                    REQUIRE(policy.get_burst_count() == 2);
+                    REQUIRE(policy.get_transaction_count() == 8);
+                    auto cool = policy.read_register(
+                        tmc2130::Registers::COOLCONF);
+                    REQUIRE(cool.has_value());
+                    auto value = cool.value();
+                    REQUIRE(
+                        reinterpret_cast<tmc2130::CoolConfig*>(&value)->sgt ==
+                        -10);
+                }
+            }
+            AND_WHEN("setting an individual register to its current value") {
+                REQUIRE(tmc.set_gconf(tmc.get_register_map().gconfig, policy));
+                THEN("nothing is sent") {
+                    REQUIRE(policy.get_transaction_count() == 7);
+                }
+            }
+            AND_WHEN("the device reports a reset") {
+                tmc2130::GStatus gstat{.reset = 1};
+                policy.write_register(
+                    tmc2130::Registers::GSTAT,
+                    *reinterpret_cast<tmc2130::RegisterSerializedType*>(
+                        &gstat));
+                static_cast<void>(tmc.get_gstatus(policy));
+                auto sent = policy.get_transaction_count();
+                REQUIRE(tmc.write_config(policy));
+                THEN("the full configuration is written again") {
+                    REQUIRE(policy.get_transaction_count() == sent + 7);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("tmc2130 batched register reads work") {
+    GIVEN("a tmc2130 and a policy with status registers set") {
+        auto tmc = tmc2130::TMC2130(tmc2130::TMC2130RegisterMap());
+        TestTMC2130Policy policy;
+        policy.write_register(tmc2130::Registers::DRVSTATUS,
+                              (1 << 25) | 0x3FF);
+        policy.write_register(tmc2130::Registers::TSTEP, 0x1234);
+        WHEN("reading drive status and tstep together") {
+            auto ret =
+                tmc.read_registers<tmc2130::DriveStatus, tmc2130::TStep>(
+                    policy);
+            THEN("both registers are read in one burst") {
+                REQUIRE(ret.has_value());
+                auto [status, tstep] = ret.value();
+                REQUIRE(status.overtemp_flag == 1);
+                REQUIRE(status.sg_result == 0x3FF);
+                REQUIRE(tstep.value == 0x1234);
+                REQUIRE(policy.get_burst_count() == 1);
+                REQUIRE(policy.get_transaction_count() == 3);
+            }
+        }
+    }
+}